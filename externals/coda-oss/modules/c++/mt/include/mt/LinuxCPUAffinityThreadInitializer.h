@@ -30,6 +30,12 @@
 #include <sched.h>
 #include <sys/types.h>
 #include <linux/unistd.h>
+/* SIX LOCAL PATCH (externals/coda-oss/patches/0001-mt-gettid-unistd.patch):
+ * glibc 2.30 and later declare gettid() in <unistd.h>.  Pull it in before
+ * the gettid() macro below, or a later include of <unistd.h> expands the
+ * macro inside glibc's declaration and fails to compile.
+ */
+#include <unistd.h>
 #include <sys/syscall.h>
 #define gettid() syscall(SYS_gettid)
 
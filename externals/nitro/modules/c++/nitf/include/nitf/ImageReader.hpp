@@ -80,6 +80,23 @@ public:
     //!  Set read caching
     void setReadCaching();
 
+    // SIX LOCAL PATCH (externals/nitro/patches/0002-imageio-block-cache.patch):
+    // read block cache limits and statistics
+    /*!
+     *  Set the read block cache limits.  See
+     *  nitf_ImageReader_setBlockCacheSize for more details.
+     *  \param maxBlocks  Maximum number of blocks to cache, at least 1
+     *  \param maxBytes  Byte budget for the cache, 0 for none
+     */
+    void setBlockCacheSize(nitf::Uint32 maxBlocks, nitf::Uint64 maxBytes = 0)
+        throw (nitf::NITFException);
+
+    //!  Get the read block cache statistics (any argument may be NULL)
+    void getBlockCacheStats(nitf::Uint32* numBlocks,
+                            nitf::Uint64* numBytes,
+                            nitf::Uint64* hits,
+                            nitf::Uint64* misses);
+
 private:
     nitf_Error error;
     ImageReader() throw(nitf::NITFException){}
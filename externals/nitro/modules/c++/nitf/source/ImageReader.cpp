@@ -70,3 +70,23 @@ void ImageReader::setReadCaching()
 {
     nitf_ImageReader_setReadCaching(getNativeOrThrow());
 }
+
+// SIX LOCAL PATCH (externals/nitro/patches/0002-imageio-block-cache.patch):
+// read block cache limits and statistics
+void ImageReader::setBlockCacheSize(nitf::Uint32 maxBlocks,
+                                    nitf::Uint64 maxBytes)
+    throw (nitf::NITFException)
+{
+    if (!nitf_ImageReader_setBlockCacheSize(getNativeOrThrow(), maxBlocks,
+                                            maxBytes, &error))
+        throw nitf::NITFException(&error);
+}
+
+void ImageReader::getBlockCacheStats(nitf::Uint32* numBlocks,
+                                     nitf::Uint64* numBytes,
+                                     nitf::Uint64* hits,
+                                     nitf::Uint64* misses)
+{
+    nitf_ImageReader_getBlockCacheStats(getNativeOrThrow(), numBlocks,
+                                        numBytes, hits, misses);
+}
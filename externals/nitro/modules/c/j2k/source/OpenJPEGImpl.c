@@ -39,6 +39,12 @@
 
 #define OPENJPEG_STREAM_SIZE 1024
 
+/* SIX LOCAL PATCH (externals/nitro/patches/0001-openjpeg-header-room.patch):
+ * headroom in the compressed buffer for the codestream headers.  Not yet
+ * in upstream NITRO; re-apply after a subtree pull until it is.
+ */
+#define OPENJPEG_HEADER_ROOM 16384
+
 typedef struct _IOControl
 {
     nrt_IOInterface *io;
@@ -449,6 +455,7 @@ J2KPRIV( NRT_BOOL) OpenJPEG_initImage(OpenJPEGWriterImpl *impl,
     nrt_Uint32 nBytes;
     j2k_Component *component = NULL;
     size_t uncompressedSize;
+    size_t compressedBufSize;
     int imageType;
     opj_cparameters_t encoderParams;
     opj_image_cmptparm_t *cmptParams;
@@ -540,15 +547,21 @@ J2KPRIV( NRT_BOOL) OpenJPEG_initImage(OpenJPEGWriterImpl *impl,
     nBytes = (j2k_Container_getPrecision(impl->container, error) - 1) / 8 + 1;
     uncompressedSize = width * height * nComponents * nBytes;
 
-    /* this is not ideal, but there is really no other way */
-    if (!(impl->compressedBuf = (char*)J2K_MALLOC(uncompressedSize)))
+    /* this is not ideal, but there is really no other way.
+     * SIX LOCAL PATCH: leave room for the headers on top of the image,
+     * since a small image (or a single tile of a larger one) may not
+     * compress at all.
+     */
+    compressedBufSize = uncompressedSize + uncompressedSize / 8 +
+            OPENJPEG_HEADER_ROOM;
+    if (!(impl->compressedBuf = (char*)J2K_MALLOC(compressedBufSize)))
     {
         nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
                        NRT_ERR_MEMORY);
         goto CATCH_ERROR;
     }
     if (!(impl->compressed = nrt_BufferAdapter_construct(impl->compressedBuf,
-                                                         uncompressedSize, 1,
+                                                         compressedBufSize, 1,
                                                          error)))
     {
         goto CATCH_ERROR;
@@ -1027,8 +1040,9 @@ OpenJPEGWriter_setTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
              * nrt_IOInterface_write() failed because we didn't have enough
              * room left in the buffer that we copy to prior to flushing out
              * to disk in OpenJPEGWriter_write().  The buffer is sized to the
-             * uncompressed image size, so this only occurs if the compressed
-             * image is actually larger than the uncompressed size.
+             * uncompressed image size plus some headroom, so this only
+             * occurs if the compressed image is a good deal larger than the
+             * uncompressed size.
              * TODO: Handle resizing the buffer on the fly when this occurs
              * inside implStreamWrite().  Long-term if we're able to thread
              * per tile, we won't have to reallocate nearly as much.
@@ -865,6 +865,42 @@ NITFPROT(void) nitf_ImageIO_setReadCaching
     nitf_ImageIO * nitf      /*!< Object to modify */
 );
 
+/* SIX LOCAL PATCH (externals/nitro/patches/0002-imageio-block-cache.patch):
+ * read block cache limits and statistics
+ */
+/*!
+  \brief nitf_ImageIO_setBlockCacheSize - Set the read block cache limits
+
+  See the documentation for nitf_ImageReader_setBlockCacheSize
+
+  \return Returns FALSE on error
+*/
+
+NITFPROT(NITF_BOOL) nitf_ImageIO_setBlockCacheSize
+(
+    nitf_ImageIO * nitf,      /*!< Object to modify */
+    nitf_Uint32 maxBlocks,    /*!< Maximum number of blocks to cache */
+    nitf_Uint64 maxBytes,     /*!< Byte budget for the cache, 0 for none */
+    nitf_Error * error        /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ImageIO_getBlockCacheStats - Get read block cache statistics
+
+  Any of the output arguments may be NULL
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_getBlockCacheStats
+(
+    nitf_ImageIO * nitf,      /*!< Object to query */
+    nitf_Uint32 * numBlocks,  /*!< Returns the number of blocks cached */
+    nitf_Uint64 * numBytes,   /*!< Returns the number of bytes cached */
+    nitf_Uint64 * hits,       /*!< Returns the number of cache hits */
+    nitf_Uint64 * misses      /*!< Returns the number of cache misses */
+);
+
 /*!
   \brief nitf_BlockingInfo_print - Print blocking information
 
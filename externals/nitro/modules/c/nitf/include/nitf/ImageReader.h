@@ -84,6 +84,52 @@ NITFAPI(void) nitf_ImageReader_setReadCaching
     nitf_ImageReader * iReader  /*!< Object to modify */
 );
 
+/* SIX LOCAL PATCH (externals/nitro/patches/0002-imageio-block-cache.patch):
+ * read block cache limits and statistics
+ */
+/*!
+  \brief nitf_ImageReader_setBlockCacheSize - Set the read block cache limits
+
+  nitf_ImageReader_setBlockCacheSize sets how many blocks the cache used by
+  cached reads and direct block reads may hold.  If maxBytes is not zero,
+  the total size of the cached (decompressed) blocks is also kept under
+  maxBytes.  The least recently used blocks are freed first.  The default
+  is a cache of one block.
+
+  Windowed reads that revisit the same blocks, such as reading an image in
+  strips that are not aligned to the blocking, avoid rereading and
+  decompressing blocks when the cache holds at least a row of blocks.
+
+  This does not enable cached reads, see nitf_ImageReader_setReadCaching
+
+  \return Returns FALSE on error
+*/
+
+NITFAPI(NITF_BOOL) nitf_ImageReader_setBlockCacheSize
+(
+    nitf_ImageReader * iReader, /*!< Object to modify */
+    nitf_Uint32 maxBlocks,      /*!< Maximum number of blocks, at least 1 */
+    nitf_Uint64 maxBytes,       /*!< Byte budget for the cache, 0 for none */
+    nitf_Error * error          /*!< For error returns */
+);
+
+/*!
+  \brief nitf_ImageReader_getBlockCacheStats - Get block cache statistics
+
+  Any of the output arguments may be NULL
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_getBlockCacheStats
+(
+    nitf_ImageReader * iReader, /*!< Object to query */
+    nitf_Uint32 * numBlocks,    /*!< Returns the number of blocks cached */
+    nitf_Uint64 * numBytes,     /*!< Returns the number of bytes cached */
+    nitf_Uint64 * hits,         /*!< Returns the number of cache hits */
+    nitf_Uint64 * misses        /*!< Returns the number of cache misses */
+);
+
 NITF_CXX_ENDGUARD
 
 #endif
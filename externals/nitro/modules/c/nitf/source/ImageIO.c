@@ -449,6 +449,57 @@ typedef struct
 }
 _nitf_ImageIOBlockCacheControl;
 
+/* SIX LOCAL PATCH (externals/nitro/patches/0002-imageio-block-cache.patch):
+ * a multi-block LRU read cache in place of the single block control.  Not
+ * yet in upstream NITRO; re-apply after a subtree pull until it is.
+ */
+/*!
+  \brief _nitf_ImageIOCachedBlock - One block in the read block cache
+
+  If the block was returned by the decompression plugin, it must be
+  freed via the plugin's freeBlock function, otherwise it was allocated
+  by the system memory allocation facility
+*/
+
+typedef struct
+{
+    nitf_Uint32 number;         /*!< Block number */
+    nitf_Uint8 *block;          /*!< Block buffer */
+    nitf_Uint64 size;           /*!< Block buffer size in bytes */
+    nitf_Uint64 lastUsed;       /*!< Cache clock value at the last access */
+    NITF_BOOL decompressed;     /*!< Buffer came from the decompressor */
+}
+_nitf_ImageIOCachedBlock;
+
+/*!
+  \brief _nitf_ImageIOBlockCache - Read block cache
+
+  The _nitf_ImageIOBlockCache structure manages the block cache used by
+  the cached reader and by direct block reads.  Up to maxBlocks blocks
+  are held and, if maxBytes is not zero, the total size of the cached
+  blocks is kept under maxBytes.  When either limit would be exceeded,
+  the least recently used blocks are freed.  The block being read is
+  never freed, so at least one block is always cached.
+
+  The default is a cache of one block, which was the original behavior.
+
+  The block array is allocated on the first read and the number of
+  blocks in the cache is small so searches are linear
+*/
+
+typedef struct
+{
+    _nitf_ImageIOCachedBlock *blocks; /*!< Cached blocks (maxBlocks long) */
+    nitf_Uint32 numBlocks;      /*!< Number of blocks in the cache */
+    nitf_Uint32 maxBlocks;      /*!< Maximum number of blocks to cache */
+    nitf_Uint64 numBytes;       /*!< Total size of the cached blocks */
+    nitf_Uint64 maxBytes;       /*!< Byte budget, zero for no budget */
+    nitf_Uint64 clock;          /*!< Incremented on every access */
+    nitf_Uint64 hits;           /*!< Number of reads found in the cache */
+    nitf_Uint64 misses;         /*!< Number of reads not in the cache */
+}
+_nitf_ImageIOBlockCache;
+
 /*!
   \brief _nitf_ImageIO - Object private data structure
 
@@ -499,8 +550,9 @@ typedef struct
     nitf_Uint64 dataLength;     /*!< Length of the data including masks */
     /*!< Configuration parameters */
     _nitf_ImageIOParameters parameters;
-    /*!< Block control */
-    _nitf_ImageIOBlockCacheControl blockControl;
+    /* SIX LOCAL PATCH: replaces _nitf_ImageIOBlockCacheControl blockControl */
+    /*!< Read block cache */
+    _nitf_ImageIOBlockCache blockCache;
     /*!< Compression handler function */
     nitf_CompressionInterface *compressor;
     /*!< Decompression handler function */
@@ -2146,6 +2198,69 @@ int nitf_ImageIO_cachedWriter(_nitf_ImageIOBlock * blockIO, nitf_IOInterface* io
 /*!< The object to setup */
 void nitf_ImageIO_setDefaultParameters(_nitf_ImageIO * object);
 
+/* SIX LOCAL PATCH: block cache helpers */
+/*!
+  \brief nitf_ImageIO_getCachedBlock - Get a block via the read block cache
+
+  nitf_ImageIO_getCachedBlock returns the cache entry for the requested
+  block, reading (and possibly decompressing) the block if it is not
+  already cached.  Least recently used blocks are freed as needed to stay
+  within the cache limits.
+
+  The returned entry is valid until the next call that modifies the cache
+
+  \b Note:
+
+  This is an internal function and is not intended to be called directly by
+  the user.
+
+  \return Returns the cache entry or NULL on error
+
+On error, the error object is set. Possible errors include:
+
+Memory allocation and I/O errors
+*/
+
+NITFPRIV(_nitf_ImageIOCachedBlock *) nitf_ImageIO_getCachedBlock
+(
+    _nitf_ImageIO * nitf,           /*!< Associated ImageIO object */
+    nitf_IOInterface * io,          /*!< I/O handle */
+    nitf_Uint32 number,             /*!< Block number */
+    nitf_Uint64 imageDataOffset,    /*!< Offset of the block from pixelBase */
+    nitf_Error * error              /*!< Error object */
+);
+
+/*!
+  \brief nitf_ImageIO_trimBlockCache - Free blocks until under limits
+
+  Frees least recently used blocks until there are at most maxBlocks
+  blocks and maxBytes bytes (if maxBytes is not zero) in the cache, not
+  counting the extra block and byte count passed in, which is room for a
+  block about to be added
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_trimBlockCache
+(
+    _nitf_ImageIO * nitf,           /*!< Associated ImageIO object */
+    nitf_Uint32 extraBlocks,        /*!< Blocks to make room for */
+    nitf_Uint64 extraBytes          /*!< Bytes to make room for */
+);
+
+/*!
+  \brief nitf_ImageIO_freeBlockCache - Free all cached blocks
+
+  The block array itself is also freed
+
+  \return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_freeBlockCache
+(
+    _nitf_ImageIO * nitf            /*!< Associated ImageIO object */
+);
+
 /*!
   \brief nitf_ImageIO_unpack_P_* - Unpack functions for block mode P
 
@@ -3172,9 +3287,9 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     nitf->decompressor = decompressor;
     nitf->compressionControl = NULL;
     nitf->decompressionControl = NULL;
-    nitf->blockControl.number = NITF_IMAGE_IO_NO_BLOCK;
-    nitf->blockControl.freeFlag = 1;
-    nitf->blockControl.block = NULL;
+    /* SIX LOCAL PATCH: block cache */
+    memset(&(nitf->blockCache), 0, sizeof(_nitf_ImageIOBlockCache));
+    nitf->blockCache.maxBlocks = 1;
     nitf->cachedWriteFlag = 0;
 
     nitf_ImageIO_setDefaultParameters(nitf);
@@ -3296,8 +3411,9 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
 
     clone->blockInfoFlag = 0;
 
-    memset(&(clone->blockControl), 0,
-           sizeof(_nitf_ImageIOBlockCacheControl));
+    /* SIX LOCAL PATCH: block cache */
+    memset(&(clone->blockCache), 0, sizeof(_nitf_ImageIOBlockCache));
+    clone->blockCache.maxBlocks = 1;
 
     clone->decompressionControl = NULL;
 
@@ -3311,7 +3427,6 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
 NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
 {
     _nitf_ImageIO *nitfp;       /* Pointer to internal type */
-    nitf_Error error;           /* For decompressor free block call */
 
     if (*nitf == NULL)
         return;
@@ -3324,16 +3439,8 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
     if (nitfp->padMask != NULL)
         NITF_FREE(nitfp->padMask);
 
-    if (nitfp->blockControl.block != NULL)
-    {
-        /* No plugin */
-        if (nitfp->decompressor == NULL)
-            NITF_FREE(nitfp->blockControl.block);
-        else
-            (*(nitfp->decompressor->freeBlock)) (nitfp->decompressionControl,
-                                                 nitfp->blockControl.block,
-                                                 &error);
-    }
+    /* SIX LOCAL PATCH: block cache */
+    nitf_ImageIO_freeBlockCache(nitfp);
 
     if (nitfp->decompressionControl != NULL)
         (*(nitfp->decompressor->destroyControl))(&(nitfp->decompressionControl));
@@ -3963,6 +4070,72 @@ NITFPROT(void) nitf_ImageIO_setReadCaching(nitf_ImageIO * nitf)
     return;
 }
 
+/* SIX LOCAL PATCH: block cache */
+NITFPROT(NITF_BOOL) nitf_ImageIO_setBlockCacheSize(nitf_ImageIO * nitf,
+                                                   nitf_Uint32 maxBlocks,
+                                                   nitf_Uint64 maxBytes,
+                                                   nitf_Error * error)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+    _nitf_ImageIOCachedBlock *blocks; /* New block array */
+
+    initf = (_nitf_ImageIO *) nitf;
+
+    if (maxBlocks == 0)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "The block cache must hold at least one block");
+        return NITF_FAILURE;
+    }
+
+    /* Drop what no longer fits before shrinking the array */
+    initf->blockCache.maxBlocks = maxBlocks;
+    initf->blockCache.maxBytes = maxBytes;
+    nitf_ImageIO_trimBlockCache(initf, 0, 0);
+
+    if (initf->blockCache.blocks != NULL)
+    {
+        blocks = (_nitf_ImageIOCachedBlock *)
+            NITF_MALLOC(maxBlocks * sizeof(_nitf_ImageIOCachedBlock));
+        if (blocks == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block cache: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NITF_FAILURE;
+        }
+
+        memcpy(blocks, initf->blockCache.blocks,
+               initf->blockCache.numBlocks *
+               sizeof(_nitf_ImageIOCachedBlock));
+        NITF_FREE(initf->blockCache.blocks);
+        initf->blockCache.blocks = blocks;
+    }
+
+    return NITF_SUCCESS;
+}
+
+NITFPROT(void) nitf_ImageIO_getBlockCacheStats(nitf_ImageIO * nitf,
+                                               nitf_Uint32 * numBlocks,
+                                               nitf_Uint64 * numBytes,
+                                               nitf_Uint64 * hits,
+                                               nitf_Uint64 * misses)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    initf = (_nitf_ImageIO *) nitf;
+    if (numBlocks != NULL)
+        *numBlocks = initf->blockCache.numBlocks;
+    if (numBytes != NULL)
+        *numBytes = initf->blockCache.numBytes;
+    if (hits != NULL)
+        *hits = initf->blockCache.hits;
+    if (misses != NULL)
+        *misses = initf->blockCache.misses;
+
+    return;
+}
+
 /*=================== nitf_BlockingInfo_print ================================*/
 
 NITFPROT(void) nitf_BlockingInfo_print(nitf_BlockingInfo * info,
@@ -7358,7 +7531,8 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
 {
     _nitf_ImageIO *nitf;        /* Associated ImageIO object */
     _nitf_ImageIOControl *cntl; /* Associated control object */
-    nitf_Uint64 blockSize;
+    /* SIX LOCAL PATCH: block cache */
+    _nitf_ImageIOCachedBlock *cached; /* Block cache entry */
 
     cntl = blockIO->cntl;
     nitf = cntl->nitf;
@@ -7375,66 +7549,15 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
-        if (nitf->blockControl.number != blockIO->number)
-        {
-            if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-                  && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-                     && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
-            {
-                /* Allocate block buffer if required */
-                if (nitf->blockControl.block == NULL)
-                {
-                    nitf->blockControl.block =
-                        (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
-                    if (nitf->blockControl.block == NULL)
-                    {
-                        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                         "Error allocating block buffer: %s",
-                                         NITF_STRERROR(NITF_ERRNO));
-                        return NITF_FAILURE;
-                    }
-                }
-                /* Read the block */
-
-                if (!nitf_ImageIO_readFromFile(io,
-                                               blockIO->cntl->nitf->
-                                               pixelBase +
-                                               blockIO->imageDataOffset,
-                                               nitf->blockControl.block,
-                                               nitf->blockSize, error))
-                    return NITF_FAILURE;
-            }
-            else
-            {
-                /* Decompression interface structure */
-                nitf_DecompressionInterface *interface;
-
-                /* No plugin */
-                if (nitf->decompressor == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT,
-                                     NITF_ERR_DECOMPRESSION,
-                                     "No decompression plugin for compressed type");
-                    return NITF_FAILURE;
-                }
-
-                interface = nitf->decompressor;
-                if (nitf->blockControl.block != NULL)
-                    (*(interface->freeBlock)) (nitf->decompressionControl,
-                                               nitf->blockControl.block,
-                                               error);
-                nitf->blockControl.block =
-                    (*(interface->readBlock)) (nitf->decompressionControl,
-                                               blockIO->number, &blockSize, error);
-                if (nitf->blockControl.block == NULL)
-                    return NITF_FAILURE;
-            }
-            nitf->blockControl.number = blockIO->number;
-        }
+        /* SIX LOCAL PATCH: read through the block cache */
+        cached = nitf_ImageIO_getCachedBlock(nitf, io, blockIO->number,
+                                             blockIO->imageDataOffset, error);
+        if (cached == NULL)
+            return NITF_FAILURE;
 
         /* Get data from block */
         memcpy(blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark,
-               nitf->blockControl.block + blockIO->blockOffset.mark,
+               cached->block + blockIO->blockOffset.mark,
                blockIO->readCount);
 
         if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
@@ -7489,73 +7612,20 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
 {
     _nitf_ImageIO *nitfI;        /* Associated ImageIO object */
     nitf_Uint64 imageDataOffset;
+    /* SIX LOCAL PATCH: block cache */
+    _nitf_ImageIOCachedBlock *cached; /* Block cache entry */
 
     nitfI = (_nitf_ImageIO*) nitf;
     imageDataOffset = nitfI->blockMask[blockNumber];
 
-    if (nitfI->blockControl.number != blockNumber)
-    {
-        if ((nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-            && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-            && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION))
-        {
-            /* Allocate block buffer if required */
-            if (nitfI->blockControl.block == NULL)
-            {
-                nitfI->blockControl.block =
-                    (nitf_Uint8 *) NITF_MALLOC(nitfI->blockSize);
-                if (nitfI->blockControl.block == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                     "Error allocating block buffer: %s",
-                                     NITF_STRERROR(NITF_ERRNO));
-                    return NULL;
-                }
-            }
-            /* Read the block */
-
-            if (!nitf_ImageIO_readFromFile(io,
-                                           nitfI->pixelBase + imageDataOffset,
-                                           nitfI->blockControl.block,
-                                           nitfI->blockSize, error))
-            {
-                return NULL;
-            }
-
-            *blockSize = nitfI->blockSize;
-        }
-        else
-        {
-            /* Decompression interface structure */
-            nitf_DecompressionInterface *interface;
-
-            /* No plugin */
-            if (nitfI->decompressor == NULL)
-            {
-                nitf_Error_initf(error, NITF_CTXT,
-                                 NITF_ERR_DECOMPRESSION,
-                                 "No decompression plugin for compressed type");
-                return NULL;
-            }
-
-            interface = nitfI->decompressor;
-            if (nitfI->blockControl.block != NULL)
-                (*(interface->freeBlock)) (nitfI->decompressionControl,
-                                           nitfI->blockControl.block,
-                                           error);
-            nitfI->blockControl.block =
-                (*(interface->readBlock)) (nitfI->decompressionControl,
-                                           blockNumber, blockSize,
-                                           error);
-            if (nitfI->blockControl.block == NULL)
-            {
-                return NULL;
-            }
-        }
-        nitfI->blockControl.number = blockNumber;
-    }
+    /* SIX LOCAL PATCH: read through the block cache */
+    cached = nitf_ImageIO_getCachedBlock(nitfI, io, blockNumber,
+                                         imageDataOffset, error);
+    if (cached == NULL)
+        return NULL;
 
-    return nitfI->blockControl.block;
+    *blockSize = cached->size;
+    return cached->block;
 }
 
 /*========================= End Direct Block Reading  ================================*/
@@ -7773,6 +7843,182 @@ void nitf_ImageIO_setDefaultParameters(_nitf_ImageIO * object)
     return;
 }
 
+/* SIX LOCAL PATCH: block cache helpers */
+NITFPRIV(void) nitf_ImageIO_freeCachedBlock(_nitf_ImageIO * nitf,
+                                            _nitf_ImageIOCachedBlock * cached)
+{
+    nitf_Error error;           /* For decompressor free block call */
+
+    if (cached->block != NULL)
+    {
+        if (cached->decompressed)
+            (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                                cached->block, &error);
+        else
+            NITF_FREE(cached->block);
+    }
+    nitf->blockCache.numBytes -= cached->size;
+    cached->block = NULL;
+    cached->size = 0;
+
+    return;
+}
+
+NITFPRIV(void) nitf_ImageIO_trimBlockCache(_nitf_ImageIO * nitf,
+                                           nitf_Uint32 extraBlocks,
+                                           nitf_Uint64 extraBytes)
+{
+    _nitf_ImageIOBlockCache *cache; /* The cache */
+    nitf_Uint32 oldest;         /* Index of least recently used block */
+    nitf_Uint32 i;
+
+    cache = &(nitf->blockCache);
+    while ((cache->numBlocks > 0)
+           && ((cache->numBlocks + extraBlocks > cache->maxBlocks)
+               || ((cache->maxBytes != 0)
+                   && (cache->numBytes + extraBytes > cache->maxBytes))))
+    {
+        oldest = 0;
+        for (i = 1; i < cache->numBlocks; i++)
+        {
+            if (cache->blocks[i].lastUsed < cache->blocks[oldest].lastUsed)
+                oldest = i;
+        }
+
+        nitf_ImageIO_freeCachedBlock(nitf, &(cache->blocks[oldest]));
+
+        /* Keep the array packed */
+        cache->numBlocks -= 1;
+        cache->blocks[oldest] = cache->blocks[cache->numBlocks];
+    }
+
+    return;
+}
+
+NITFPRIV(void) nitf_ImageIO_freeBlockCache(_nitf_ImageIO * nitf)
+{
+    nitf_Uint32 i;
+
+    for (i = 0; i < nitf->blockCache.numBlocks; i++)
+        nitf_ImageIO_freeCachedBlock(nitf, &(nitf->blockCache.blocks[i]));
+
+    if (nitf->blockCache.blocks != NULL)
+        NITF_FREE(nitf->blockCache.blocks);
+
+    nitf->blockCache.blocks = NULL;
+    nitf->blockCache.numBlocks = 0;
+    nitf->blockCache.numBytes = 0;
+
+    return;
+}
+
+NITFPRIV(_nitf_ImageIOCachedBlock *) nitf_ImageIO_getCachedBlock
+    (_nitf_ImageIO * nitf, nitf_IOInterface * io, nitf_Uint32 number,
+     nitf_Uint64 imageDataOffset, nitf_Error * error)
+{
+    _nitf_ImageIOBlockCache *cache; /* The cache */
+    _nitf_ImageIOCachedBlock newBlock; /* Block being read */
+    _nitf_ImageIOCachedBlock *cached; /* Entry for the new block */
+    nitf_Uint32 i;
+
+    cache = &(nitf->blockCache);
+    cache->clock += 1;
+
+    for (i = 0; i < cache->numBlocks; i++)
+    {
+        if (cache->blocks[i].number == number)
+        {
+            cache->blocks[i].lastUsed = cache->clock;
+            cache->hits += 1;
+            return &(cache->blocks[i]);
+        }
+    }
+    cache->misses += 1;
+
+    if (cache->blocks == NULL)
+    {
+        cache->blocks = (_nitf_ImageIOCachedBlock *)
+            NITF_MALLOC(cache->maxBlocks * sizeof(_nitf_ImageIOCachedBlock));
+        if (cache->blocks == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block cache: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NULL;
+        }
+    }
+
+    newBlock.number = number;
+    newBlock.lastUsed = cache->clock;
+
+    if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
+        && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
+        && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+    {
+        /* Make room first so the peak stays within the budget */
+        nitf_ImageIO_trimBlockCache(nitf, 1, nitf->blockSize);
+
+        newBlock.decompressed = 0;
+        newBlock.size = nitf->blockSize;
+        newBlock.block = (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
+        if (newBlock.block == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NULL;
+        }
+
+        /* Read the block */
+
+        if (!nitf_ImageIO_readFromFile(io,
+                                       nitf->pixelBase + imageDataOffset,
+                                       newBlock.block,
+                                       nitf->blockSize, error))
+        {
+            NITF_FREE(newBlock.block);
+            return NULL;
+        }
+    }
+    else
+    {
+        /* Decompression interface structure */
+        nitf_DecompressionInterface *interface;
+
+        /* No plugin */
+        if (nitf->decompressor == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT,
+                             NITF_ERR_DECOMPRESSION,
+                             "No decompression plugin for compressed type");
+            return NULL;
+        }
+
+        /*
+         * The decompressed size isn't known until the block is read, so
+         * only the block count can be trimmed ahead of time
+         */
+        nitf_ImageIO_trimBlockCache(nitf, 1, 0);
+
+        interface = nitf->decompressor;
+        newBlock.decompressed = 1;
+        newBlock.block =
+            (*(interface->readBlock)) (nitf->decompressionControl,
+                                       number, &(newBlock.size), error);
+        if (newBlock.block == NULL)
+            return NULL;
+
+        nitf_ImageIO_trimBlockCache(nitf, 1, newBlock.size);
+    }
+
+    cached = &(cache->blocks[cache->numBlocks]);
+    *cached = newBlock;
+    cache->numBlocks += 1;
+    cache->numBytes += newBlock.size;
+
+    return cached;
+}
+
 
 void nitf_ImageIO_unformatExtend_1(nitf_Uint8 * buffer,
                                    size_t count,
@@ -99,3 +99,27 @@ NITFPROT(void) nitf_ImageReader_setReadCaching(nitf_ImageReader * iReader)
     nitf_ImageIO_setReadCaching(iReader->imageDeblocker);
     return;
 }
+
+/* SIX LOCAL PATCH (externals/nitro/patches/0002-imageio-block-cache.patch):
+ * read block cache limits and statistics
+ */
+NITFAPI(NITF_BOOL)
+nitf_ImageReader_setBlockCacheSize(nitf_ImageReader * iReader,
+                                   nitf_Uint32 maxBlocks,
+                                   nitf_Uint64 maxBytes,
+                                   nitf_Error * error)
+{
+    return nitf_ImageIO_setBlockCacheSize(iReader->imageDeblocker,
+                                          maxBlocks, maxBytes, error);
+}
+
+NITFAPI(void)
+nitf_ImageReader_getBlockCacheStats(nitf_ImageReader * iReader,
+                                    nitf_Uint32 * numBlocks,
+                                    nitf_Uint64 * numBytes,
+                                    nitf_Uint64 * hits,
+                                    nitf_Uint64 * misses)
+{
+    nitf_ImageIO_getBlockCacheStats(iReader->imageDeblocker, numBlocks,
+                                    numBytes, hits, misses);
+}
@@ -0,0 +1,122 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_BACKPROJECTOR_H__
+#define __CPHD_BACKPROJECTOR_H__
+
+#include <complex>
+#include <memory>
+
+#include <types/RowCol.h>
+#include <six/sicd/ComplexData.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/ImageFormer.h>
+
+namespace cphd
+{
+/*
+ *  \class Backprojector
+ *  \brief Time domain backprojection of a CPHD channel into a SICD
+ *
+ *  Pulses are streamed from the Wideband a block at a time.  Each pulse in
+ *  a block is range compressed with a zero padded FFT, upsampled so that
+ *  linear interpolation is enough, and then every pixel of the image gets
+ *  the interpolated sample at its differential range, rotated by the
+ *  carrier phase.  The image is split into tiles that stay in cache while
+ *  all of a block's pulses are added to them, and the tiles are split up
+ *  between threads.  Once all pulses are in, the image is demodulated so
+ *  its spectrum is centered on the Grid's KCtr.
+ *
+ *  Only FX domain phase history is supported.
+ */
+class Backprojector : public ImageFormer
+{
+public:
+    static const size_t DEFAULT_TILE_SIZE;
+    static const size_t DEFAULT_UPSAMPLE_FACTOR;
+
+    /*
+     *  \param reader Reader for the CPHD.  It must stay around as long as
+     *  this does.
+     *  \param channel 0 based channel to form
+     *  \param numThreads Number of threads to use
+     */
+    Backprojector(CPHDReader& reader, size_t channel, size_t numThreads);
+
+    /*
+     *  \return A ground plane grid centered on the SRP of the middle pulse.
+     *  Rows are in ground range, columns are along the ground track, and
+     *  both are sampled 1.5 times the resolution.
+     */
+    ImageGrid getDefaultGrid(const types::RowCol<size_t>& dims) const;
+
+    /*
+     *  Forms the image
+     *
+     *  \param grid Output plane
+     *  \param image Output buffer of grid.dims.area() samples
+     */
+    void form(const ImageGrid& grid, std::complex<float>* image);
+
+    /*
+     *  \return SICD metadata for an image formed on 'grid'.  The Grid is
+     *  a PLANE grid whose spatial frequency support comes from the pulses'
+     *  geometry and bandwidth.
+     */
+    std::auto_ptr<six::sicd::ComplexData>
+    createComplexData(const ImageGrid& grid) const;
+
+    size_t getTileSize() const
+    {
+        return mTileSize;
+    }
+
+    //! Tiles are 'tileSize' x 'tileSize' pixels
+    void setTileSize(size_t tileSize);
+
+    size_t getUpsampleFactor() const
+    {
+        return mUpsampleFactor;
+    }
+
+    //! Range profiles are upsampled by this much past the next power of 2
+    void setUpsampleFactor(size_t upsampleFactor);
+
+private:
+    // Spatial frequency support of the pulses along a grid's row and column
+    struct Support
+    {
+        double rowMin;
+        double rowMax;
+        double colMin;
+        double colMax;
+    };
+
+    Support getSupport(const ImageGrid& grid) const;
+
+private:
+    size_t mTileSize;
+    size_t mUpsampleFactor;
+};
+}
+
+#endif
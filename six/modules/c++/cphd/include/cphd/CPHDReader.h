@@ -29,6 +29,7 @@
 #include <cphd/Metadata.h>
 #include <cphd/FileHeader.h>
 #include <cphd/VBM.h>
+#include <cphd/VBMReader.h>
 #include <cphd/Wideband.h>
 
 namespace cphd
@@ -38,15 +39,20 @@ class CPHDReader
 public:
     //!  Constructor
     // Provides access to wideband but doesn't read it
+    // If loadVBM is false, only the header and XML are read up front.  Use
+    // getVBM(channel, firstVector, numVectors) to read VBM rows as needed;
+    // getVBM() will load the whole thing the first time it's called.
     CPHDReader(mem::SharedPtr<io::SeekableInputStream> inStream,
                size_t numThreads,
                mem::SharedPtr<logging::Logger> logger =
-                       mem::SharedPtr<logging::Logger>());
+                       mem::SharedPtr<logging::Logger>(),
+               bool loadVBM = true);
 
     CPHDReader(const std::string& fromFile,
                size_t numThreads,
                mem::SharedPtr<logging::Logger> logger =
-                       mem::SharedPtr<logging::Logger>());
+                       mem::SharedPtr<logging::Logger>(),
+               bool loadVBM = true);
 
     size_t getNumChannels() const
     {
@@ -113,9 +119,25 @@ public:
         return *mMetadata;
     }
 
-    const VBM& getVBM() const
+    const VBM& getVBM() const;
+
+    // Returns a single channel VBM holding vectors
+    // [firstVector, firstVector + numVectors) of a channel
+    // first channel is 0!
+    std::auto_ptr<VBM> getVBM(size_t channel,
+                              size_t firstVector,
+                              size_t numVectors) const;
+
+    // Returns false if the VBM hasn't been loaded in full (yet)
+    bool isVBMLoaded() const
+    {
+        return mVBM.get() != NULL;
+    }
+
+    // Controls the cache used by getVBM(channel, firstVector, numVectors)
+    VBMReader& getVBMReader()
     {
-        return *mVBM;
+        return *mVBMReader;
     }
 
     Wideband& getWideband()
@@ -127,12 +149,14 @@ private:
     // Keep info about the CPHD collection
     FileHeader mFileHeader;
     std::auto_ptr<Metadata> mMetadata;
-    std::auto_ptr<VBM> mVBM;
+    mutable std::auto_ptr<VBM> mVBM;
+    std::auto_ptr<VBMReader> mVBMReader;
     std::auto_ptr<Wideband> mWideband;
 
     void initialize(mem::SharedPtr<io::SeekableInputStream> inStream,
                     size_t numThreads,
-                    mem::SharedPtr<logging::Logger> logger);
+                    mem::SharedPtr<logging::Logger> logger,
+                    bool loadVBM);
 
 };
 }
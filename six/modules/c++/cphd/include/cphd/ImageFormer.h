@@ -0,0 +1,222 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_IMAGE_FORMER_H__
+#define __CPHD_IMAGE_FORMER_H__
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <mem/BufferView.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <types/RowCol.h>
+#include <six/sicd/ComplexData.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/Types.h>
+
+namespace cphd
+{
+/*
+ *  \struct ImageGrid
+ *  \brief An output plane for image formation
+ *
+ *  Pixel (row, col) is at
+ *  scp + (row - scpPixel.row) * rowSpacing * rowUnitVector +
+ *        (col - scpPixel.col) * colSpacing * colUnitVector
+ *  in ECEF meters.
+ */
+struct ImageGrid
+{
+    ImageGrid();
+
+    Vector3 getPosition(double row, double col) const;
+
+    //! Throws unless the grid is non-empty with orthonormal unit vectors
+    void validate() const;
+
+    Vector3 scp;
+    Vector3 rowUnitVector;
+    Vector3 colUnitVector;
+    double rowSpacing;
+    double colSpacing;
+    types::RowCol<size_t> dims;
+    types::RowCol<size_t> scpPixel;
+};
+
+/*
+ *  \class ImageFormer
+ *  \brief Base class for forming a SICD from a channel of FX domain CPHD
+ *
+ *  Loads each vector's parameters up front, and provides what the image
+ *  formation algorithms have in common: reading blocks of scaled vectors,
+ *  the aperture geometry, the SICD metadata that doesn't depend on the
+ *  algorithm, and splitting work up between threads.
+ */
+class ImageFormer
+{
+public:
+    static const size_t DEFAULT_VECTORS_PER_BLOCK;
+
+    virtual ~ImageFormer();
+
+    size_t getNumVectorsPerBlock() const
+    {
+        return mNumVectorsPerBlock;
+    }
+
+    //! Vectors are read from the Wideband this many at a time
+    void setNumVectorsPerBlock(size_t numVectorsPerBlock);
+
+protected:
+    /*
+     *  \param reader Reader for the CPHD.  It must stay around as long as
+     *  this does.
+     *  \param channel 0 based channel to form
+     *  \param numThreads Number of threads to use
+     *  \param name Name of the algorithm for error messages
+     */
+    ImageFormer(CPHDReader& reader,
+                size_t channel,
+                size_t numThreads,
+                const std::string& name);
+
+    // What image formation needs to know about each vector
+    struct Pulse
+    {
+        Vector3 txPos;
+        Vector3 rcvPos;
+        Vector3 srpPos;
+        double txTime;
+        double srpRange;
+        double fx0;
+        double fxSS;
+        double fx1;
+        double fx2;
+        double ampSF;
+    };
+
+    /*
+     *  Reads vectors [firstVector, firstVector + numVectors), scaled by
+     *  their AmpSF if there is one
+     *
+     *  \param scratch At least numVectors * mNumSamples *
+     *  getNumBytesPerSample() bytes
+     *  \param samples At least numVectors * mNumSamples samples
+     */
+    void readVectors(size_t firstVector,
+                     size_t numVectors,
+                     const mem::BufferView<sys::ubyte>& scratch,
+                     const mem::BufferView<std::complex<float> >& samples);
+
+    //! Midpoint of the transmit and receive positions
+    Vector3 getARPPos(size_t vector) const;
+
+    //! Average velocity over the aperture
+    Vector3 getARPVel() const;
+
+    //! Middle of the aperture, in seconds since the collect started
+    double getMidTime() const;
+
+    /*
+     *  Direction of spatial frequency for a vector at 'point'.  Sample
+     *  frequency f / c times this is the sample's spatial frequency.
+     */
+    Vector3 getRangeGradient(size_t vector, const Vector3& point) const;
+
+    /*
+     *  SICD metadata for an image on 'grid'.  Everything is filled in but
+     *  Grid's type and spatial frequency support, and the image formation
+     *  algorithm.
+     */
+    std::auto_ptr<six::sicd::ComplexData>
+    createComplexData(const ImageGrid& grid,
+                      const std::string& application) const;
+
+    //! Sets bandwidth, KCtr, DeltaK1/2 and IPR width for uniform weighting
+    static void setSupport(double kMin,
+                           double kMax,
+                           six::sicd::DirectionParameters& direction);
+
+    /*
+     *  Runs RunnableT(context, start, count) over [0, numItems), split up
+     *  between threads.  A single runnable is run on this thread.
+     */
+    template <typename RunnableT, typename ContextT>
+    void runInParallel(const ContextT& context, size_t numItems) const
+    {
+        std::vector<sys::Runnable*> runnables;
+        try
+        {
+            const mt::ThreadPlanner planner(numItems,
+                                            std::min(mNumThreads, numItems));
+
+            size_t threadNum(0);
+            size_t startItem(0);
+            size_t numItemsThisThread(0);
+            while (planner.getThreadInfo(threadNum++,
+                                         startItem,
+                                         numItemsThisThread))
+            {
+                runnables.push_back(
+                        new RunnableT(context, startItem, numItemsThisThread));
+            }
+        }
+        catch (...)
+        {
+            for (size_t ii = 0; ii < runnables.size(); ++ii)
+            {
+                delete runnables[ii];
+            }
+            throw;
+        }
+
+        if (runnables.size() == 1)
+        {
+            const std::auto_ptr<sys::Runnable> runnable(runnables[0]);
+            runnable->run();
+            return;
+        }
+
+        mt::ThreadGroup threads;
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            threads.createThread(runnables[ii]);
+        }
+        threads.joinAll();
+    }
+
+    CPHDReader& mReader;
+    const size_t mChannel;
+    const size_t mNumThreads;
+    size_t mNumVectors;
+    size_t mNumSamples;
+    int mPhaseSign;
+    std::vector<Pulse> mPulses;
+    size_t mNumVectorsPerBlock;
+};
+}
+
+#endif
@@ -0,0 +1,150 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_POLAR_FORMATTER_H__
+#define __CPHD_POLAR_FORMATTER_H__
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <types/RowCol.h>
+#include <six/sicd/ComplexData.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/ImageFormer.h>
+
+namespace cphd
+{
+/*
+ *  \class PolarFormatter
+ *  \brief Polar format image formation of a CPHD channel into a SICD
+ *
+ *  Each pulse's samples lie along a line in the ground plane's spatial
+ *  frequency domain at its polar angle.  They're interpolated onto the
+ *  largest rectangle inscribed in the pulses' annulus in two passes: first
+ *  along each pulse onto evenly spaced range spatial frequencies, then
+ *  across pulses onto evenly spaced azimuth spatial frequencies.  The
+ *  rectangle is then zero padded and transformed into the image with a 2D
+ *  FFT.
+ *
+ *  Pulses are streamed from the Wideband a block at a time, and the range
+ *  interpolated blocks are corner turned through tiles so the azimuth pass
+ *  can read a block of range bins for every pulse at once.  The tiles are
+ *  kept in memory unless they'd need more than getMaxMemory() bytes, in
+ *  which case they go to a scratch file.  Each pass is split up between
+ *  threads.
+ *
+ *  The SRP must be fixed over the aperture.  The image is formed in the
+ *  ground plane at the SRP, with rows in ground range away from the radar
+ *  at the middle of the aperture.
+ */
+class PolarFormatter : public ImageFormer
+{
+public:
+    static const double DEFAULT_OVERSAMPLE_RATIO;
+    static const size_t DEFAULT_MAX_MEMORY;
+
+    /*
+     *  \param reader Reader for the CPHD.  It must stay around as long as
+     *  this does.
+     *  \param channel 0 based channel to form
+     *  \param numThreads Number of threads to use
+     */
+    PolarFormatter(CPHDReader& reader, size_t channel, size_t numThreads);
+
+    //! \return The output plane, which depends on the oversample ratio
+    ImageGrid getGrid() const;
+
+    /*
+     *  Forms the image
+     *
+     *  \param image Output buffer of getGrid().dims.area() samples
+     */
+    void form(std::complex<float>* image);
+
+    /*
+     *  \return SICD metadata for the formed image.  The Grid is RGAZIM,
+     *  and the PFA parameters describe the polar angle and scale factor of
+     *  the pulses as well as the inscribed rectangle.
+     */
+    std::auto_ptr<six::sicd::ComplexData> createComplexData() const;
+
+    double getOversampleRatio() const
+    {
+        return mOversampleRatio;
+    }
+
+    //! Image samples per resolution cell.  Must be at least 1.
+    void setOversampleRatio(double oversampleRatio);
+
+    size_t getMaxMemory() const
+    {
+        return mMaxMemory;
+    }
+
+    //! Largest corner turn, in bytes, that is kept in memory
+    void setMaxMemory(size_t maxMemory)
+    {
+        mMaxMemory = maxMemory;
+    }
+
+    const std::string& getScratchDirectory() const
+    {
+        return mScratchDirectory;
+    }
+
+    //! Directory for the corner turn's scratch file
+    void setScratchDirectory(const std::string& scratchDirectory)
+    {
+        mScratchDirectory = scratchDirectory;
+    }
+
+private:
+    // Ground plane spatial frequency of 'vector's first sample, and the
+    // step between its samples
+    double getFirstK(size_t vector) const;
+    double getDeltaK(size_t vector) const;
+
+private:
+    Vector3 mSCP;
+    Vector3 mNormal;
+    Vector3 mRowUnitVector;
+    Vector3 mColUnitVector;
+
+    // Polar angle and spatial frequency scale factor of each vector
+    std::vector<double> mPolarAngles;
+    std::vector<double> mScaleFactors;
+
+    // Inscribed rectangle
+    double mKrg1;
+    double mKrg2;
+    double mKaz1;
+    double mKaz2;
+
+    double mOversampleRatio;
+    size_t mMaxMemory;
+    std::string mScratchDirectory;
+};
+}
+
+#endif
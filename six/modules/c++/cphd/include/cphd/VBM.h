@@ -130,6 +130,23 @@ public:
     void setDeltaTOA0(double value, size_t channel, size_t vector);
     void setTOASS(double value, size_t channel, size_t vector);
 
+    /*
+     *  \func copyVector
+     *  \brief Copies all the parameters of one vector from another VBM.
+     *         Both VBMs must have the same optional parameters and domain.
+     *
+     *  \param channel 0 based channel to copy into
+     *  \param vector 0 based vector to copy into
+     *  \param other VBM to copy from
+     *  \param otherChannel 0 based channel in 'other' to copy from
+     *  \param otherVector 0 based vector in 'other' to copy from
+     */
+    void copyVector(size_t channel,
+                    size_t vector,
+                    const VBM& other,
+                    size_t otherChannel,
+                    size_t otherVector);
+
     // More convenience functions
 
     /*
@@ -168,6 +185,11 @@ public:
         return mAmpSFEnabled;
     }
 
+    DomainType getDomainType() const
+    {
+        return mDomainType;
+    }
+
     /*
      *  \func updateVectorParameters
      *  \brief Updates the offset values of a vector parameter based
@@ -0,0 +1,153 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_VBM_READER_H__
+#define __CPHD_VBM_READER_H__
+
+#include <list>
+#include <memory>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <io/SeekableStreams.h>
+#include <mem/SharedPtr.h>
+#include <cphd/Data.h>
+#include <cphd/VBM.h>
+#include <cphd/VectorParameters.h>
+
+namespace cphd
+{
+/*
+ *  \class VBMReader
+ *  \brief Reads vector based metadata out of a CPHD file on demand
+ *
+ *  Rows are read in fixed size blocks of vectors, and the most recently used
+ *  blocks are kept in memory so that reading neighboring ranges doesn't go
+ *  back to the file.  Like Wideband, this isn't thread-safe.
+ */
+class VBMReader
+{
+public:
+    static const size_t DEFAULT_VECTORS_PER_BLOCK;
+    static const size_t DEFAULT_MAX_BLOCKS;
+
+    /*
+     *  \param inStream Stream for the CPHD file
+     *  \param startVBM cphd header keyword "VB_BYTE_OFFSET"
+     *  \param sizeVBM cphd header keyword "VB_DATA_SIZE"
+     *  \param data Data from the CPHD's metadata
+     *  \param vp VectorParameters from the CPHD's metadata
+     *  \param numThreads Number of threads to use for byte swapping
+     */
+    VBMReader(mem::SharedPtr<io::SeekableInputStream> inStream,
+              sys::Off_T startVBM,
+              sys::Off_T sizeVBM,
+              const Data& data,
+              const VectorParameters& vp,
+              size_t numThreads);
+
+    /*
+     *  \func read
+     *  \brief Reads a range of vectors from one channel.
+     *
+     *  \param channel 0 based channel
+     *  \param firstVector 0 based first vector to read
+     *  \param numVectors Number of vectors to read
+     *
+     *  \return A single channel VBM whose vector 0 is 'firstVector'
+     */
+    std::auto_ptr<VBM> read(size_t channel,
+                            size_t firstVector,
+                            size_t numVectors);
+
+    //! Reads the entire VBM, bypassing the cache
+    std::auto_ptr<VBM> readAll();
+
+    size_t getNumVectorsPerBlock() const
+    {
+        return mNumVectorsPerBlock;
+    }
+
+    size_t getMaxBlocks() const
+    {
+        return mMaxBlocks;
+    }
+
+    //! Clears the cache if the block size changes
+    void setNumVectorsPerBlock(size_t numVectorsPerBlock);
+
+    //! Use 0 to disable caching
+    void setMaxBlocks(size_t maxBlocks);
+
+    size_t getNumBlocksCached() const
+    {
+        return mBlocks.size();
+    }
+
+    void clearCache()
+    {
+        mBlocks.clear();
+    }
+
+private:
+    struct Block
+    {
+        size_t channel;
+        size_t firstVector;
+        mem::SharedPtr<VBM> vbm;
+    };
+
+    mem::SharedPtr<VBM> getBlock(size_t channel, size_t block);
+
+    mem::SharedPtr<VBM> readBlock(size_t channel,
+                                  size_t firstVector,
+                                  size_t numVectors);
+
+private:
+    const mem::SharedPtr<io::SeekableInputStream> mInStream;
+    const sys::Off_T mStartVBM;
+    const sys::Off_T mSizeVBM;
+    const Data mData;
+    const VectorParameters mVectorParameters;
+    const size_t mNumThreads;
+
+    bool mSRPTimeEnabled;
+    bool mTropoSRPEnabled;
+    bool mAmpSFEnabled;
+    DomainType mDomainType;
+
+    // Bytes each vector takes up in the file and in a packed VBM buffer
+    size_t mNumBytesPerVectorFile;
+    size_t mNumBytesPerVector;
+
+    // Offset of each channel from the start of the VBM
+    std::vector<sys::Off_T> mChannelOffsets;
+
+    size_t mNumVectorsPerBlock;
+    size_t mMaxBlocks;
+
+    // Most recently used first
+    std::list<Block> mBlocks;
+};
+}
+
+#endif
@@ -24,6 +24,7 @@
 #define __IMPORT_CPHD_H__
 
 #include "cphd/Antenna.h"
+#include "cphd/Backprojector.h"
 #include "cphd/Channel.h"
 #include "cphd/CPHDReader.h"
 #include "cphd/CPHDWriter.h"
@@ -32,7 +33,9 @@
 #include "cphd/Enums.h"
 #include "cphd/FileHeader.h"
 #include "cphd/Global.h"
+#include "cphd/ImageFormer.h"
 #include "cphd/Metadata.h"
+#include "cphd/PolarFormatter.h"
 #include "cphd/SRP.h"
 #include "cphd/Types.h"
 #include "cphd/Utilities.h"
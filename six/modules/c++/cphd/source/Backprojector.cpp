@@ -0,0 +1,498 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <except/Exception.h>
+#include <math/Constants.h>
+#include <mem/BufferView.h>
+#include <scene/SceneGeometry.h>
+#include <six/FFT.h>
+#include <six/Profiler.h>
+#include <cphd/Backprojector.h>
+
+namespace
+{
+struct RangeCompressContext
+{
+    const std::complex<float>* input;
+    std::complex<float>* output;
+    size_t numSamples;
+    const six::FFT* fft;
+    int fftSign;
+};
+
+// Zero pads each vector's samples out to the FFT size and transforms them
+// into a range profile
+class RangeCompressRunnable : public sys::Runnable
+{
+public:
+    RangeCompressRunnable(const RangeCompressContext& context,
+                          size_t startVector,
+                          size_t numVectors) :
+        mContext(context),
+        mStartVector(startVector),
+        mNumVectors(numVectors)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t numSamples = mContext.numSamples;
+        const size_t fftSize = mContext.fft->getSize();
+        const float scale = 1.0f / numSamples;
+
+        for (size_t ii = mStartVector; ii < mStartVector + mNumVectors; ++ii)
+        {
+            const std::complex<float>* const input =
+                    mContext.input + ii * numSamples;
+            std::complex<float>* const output = mContext.output + ii * fftSize;
+
+            for (size_t jj = 0; jj < numSamples; ++jj)
+            {
+                output[jj] = input[jj] * scale;
+            }
+            std::fill(output + numSamples, output + fftSize,
+                      std::complex<float>(0.0f, 0.0f));
+
+            mContext.fft->transform(output, mContext.fftSign);
+        }
+    }
+
+private:
+    const RangeCompressContext& mContext;
+    const size_t mStartVector;
+    const size_t mNumVectors;
+};
+
+// Hot loop copies of a vector's parameters
+struct PulseGeometry
+{
+    double tx[3];
+    double rcv[3];
+    double srpRange;
+    double fx0;
+    double samplesPerSecond;
+};
+
+struct BackprojectContext
+{
+    const cphd::ImageGrid* grid;
+    std::complex<float>* image;
+    size_t tileSize;
+    size_t numTileCols;
+    const std::complex<float>* profiles;
+    size_t fftSize;
+    const PulseGeometry* pulses;
+    size_t numPulses;
+    int phaseSign;
+};
+
+// Adds a block of range profiles to a set of tiles.  Each thread owns its
+// tiles, and a tile stays in cache while every pulse is added to it.
+class BackprojectRunnable : public sys::Runnable
+{
+public:
+    BackprojectRunnable(const BackprojectContext& context,
+                        size_t startTile,
+                        size_t numTiles) :
+        mContext(context),
+        mStartTile(startTile),
+        mNumTiles(numTiles)
+    {
+    }
+
+    virtual void run()
+    {
+        const cphd::ImageGrid& grid = *mContext.grid;
+        const size_t tileSize = mContext.tileSize;
+        std::vector<double> colOffsets(3 * tileSize);
+        std::vector<double> rowPositions(3 * tileSize);
+
+        for (size_t tile = mStartTile; tile < mStartTile + mNumTiles; ++tile)
+        {
+            const size_t row0 = (tile / mContext.numTileCols) * tileSize;
+            const size_t col0 = (tile % mContext.numTileCols) * tileSize;
+            const size_t numRows = std::min(tileSize, grid.dims.row - row0);
+            const size_t numCols = std::min(tileSize, grid.dims.col - col0);
+
+            for (size_t ii = 0; ii < numRows; ++ii)
+            {
+                const cphd::Vector3 pos =
+                        grid.getPosition(static_cast<double>(row0 + ii),
+                                         static_cast<double>(
+                                                 grid.scpPixel.col));
+                for (size_t kk = 0; kk < 3; ++kk)
+                {
+                    rowPositions[3 * ii + kk] = pos[kk];
+                }
+            }
+            for (size_t jj = 0; jj < numCols; ++jj)
+            {
+                const double colOffset =
+                        (static_cast<double>(col0 + jj) -
+                         static_cast<double>(grid.scpPixel.col)) *
+                        grid.colSpacing;
+                for (size_t kk = 0; kk < 3; ++kk)
+                {
+                    colOffsets[3 * jj + kk] =
+                            colOffset * grid.colUnitVector[kk];
+                }
+            }
+
+            for (size_t pulse = 0; pulse < mContext.numPulses; ++pulse)
+            {
+                addPulse(mContext.pulses[pulse],
+                         mContext.profiles + pulse * mContext.fftSize,
+                         row0, col0, numRows, numCols,
+                         &rowPositions[0], &colOffsets[0]);
+            }
+        }
+    }
+
+private:
+    void addPulse(const PulseGeometry& pulse,
+                  const std::complex<float>* profile,
+                  size_t row0,
+                  size_t col0,
+                  size_t numRows,
+                  size_t numCols,
+                  const double* rowPositions,
+                  const double* colOffsets) const
+    {
+        const double invC = 1.0 / math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+        const size_t mask = mContext.fftSize - 1;
+        const double twoPi = -mContext.phaseSign * 2.0 * M_PI;
+        const size_t numImageCols = mContext.grid->dims.col;
+
+        for (size_t ii = 0; ii < numRows; ++ii)
+        {
+            const double* const rowPos = rowPositions + 3 * ii;
+            std::complex<float>* const out =
+                    mContext.image + (row0 + ii) * numImageCols + col0;
+
+            for (size_t jj = 0; jj < numCols; ++jj)
+            {
+                const double* const offset = colOffsets + 3 * jj;
+                const double x = rowPos[0] + offset[0];
+                const double y = rowPos[1] + offset[1];
+                const double z = rowPos[2] + offset[2];
+
+                const double txX = x - pulse.tx[0];
+                const double txY = y - pulse.tx[1];
+                const double txZ = z - pulse.tx[2];
+                const double rcvX = x - pulse.rcv[0];
+                const double rcvY = y - pulse.rcv[1];
+                const double rcvZ = z - pulse.rcv[2];
+                const double range =
+                        std::sqrt(txX * txX + txY * txY + txZ * txZ) +
+                        std::sqrt(rcvX * rcvX + rcvY * rcvY + rcvZ * rcvZ);
+                const double deltaTOA = (range - pulse.srpRange) * invC;
+
+                // Linear interpolation into the (upsampled) range profile.
+                // Negative delays wrap around to the end.
+                const double index = deltaTOA * pulse.samplesPerSecond;
+                const double indexFloor = std::floor(index);
+                const float weight = static_cast<float>(index - indexFloor);
+                const size_t idx0 =
+                        static_cast<size_t>(
+                                static_cast<sys::SSize_T>(indexFloor)) & mask;
+                const size_t idx1 = (idx0 + 1) & mask;
+                const std::complex<float> sample =
+                        profile[idx0] * (1.0f - weight) +
+                        profile[idx1] * weight;
+
+                // Only the fractional cycles matter, and they need to be
+                // computed in double to keep their precision
+                const double cycles = pulse.fx0 * deltaTOA;
+                const float angle =
+                        static_cast<float>(twoPi * (cycles - std::floor(cycles)));
+                out[jj] += sample * std::complex<float>(std::cos(angle),
+                                                        std::sin(angle));
+            }
+        }
+    }
+
+private:
+    const BackprojectContext& mContext;
+    const size_t mStartTile;
+    const size_t mNumTiles;
+};
+
+struct DemodulateContext
+{
+    const cphd::ImageGrid* grid;
+    std::complex<float>* image;
+    double rowKCenter;
+    double colKCenter;
+    int phaseSign;
+};
+
+// Shifts the image's spectrum from (KCtrRow, KCtrCol) down to baseband
+class DemodulateRunnable : public sys::Runnable
+{
+public:
+    DemodulateRunnable(const DemodulateContext& context,
+                       size_t startRow,
+                       size_t numRows) :
+        mContext(context),
+        mStartRow(startRow),
+        mNumRows(numRows)
+    {
+    }
+
+    virtual void run()
+    {
+        const cphd::ImageGrid& grid = *mContext.grid;
+        const double twoPi = mContext.phaseSign * 2.0 * M_PI;
+
+        for (size_t row = mStartRow; row < mStartRow + mNumRows; ++row)
+        {
+            const double rowCycles = mContext.rowKCenter * grid.rowSpacing *
+                    (static_cast<double>(row) -
+                     static_cast<double>(grid.scpPixel.row));
+            std::complex<float>* const out = mContext.image + row * grid.dims.col;
+
+            for (size_t col = 0; col < grid.dims.col; ++col)
+            {
+                const double cycles = rowCycles +
+                        mContext.colKCenter * grid.colSpacing *
+                        (static_cast<double>(col) -
+                         static_cast<double>(grid.scpPixel.col));
+                const double angle = twoPi * (cycles - std::floor(cycles));
+                out[col] *= std::complex<float>(
+                        static_cast<float>(std::cos(angle)),
+                        static_cast<float>(std::sin(angle)));
+            }
+        }
+    }
+
+private:
+    const DemodulateContext& mContext;
+    const size_t mStartRow;
+    const size_t mNumRows;
+};
+}
+
+namespace cphd
+{
+const size_t Backprojector::DEFAULT_TILE_SIZE = 64;
+const size_t Backprojector::DEFAULT_UPSAMPLE_FACTOR = 4;
+
+Backprojector::Backprojector(CPHDReader& reader,
+                             size_t channel,
+                             size_t numThreads) :
+    ImageFormer(reader, channel, numThreads, "Backprojection"),
+    mTileSize(DEFAULT_TILE_SIZE),
+    mUpsampleFactor(DEFAULT_UPSAMPLE_FACTOR)
+{
+}
+
+void Backprojector::setTileSize(size_t tileSize)
+{
+    if (tileSize == 0)
+    {
+        throw except::Exception(Ctxt("Tile size must be positive"));
+    }
+    mTileSize = tileSize;
+}
+
+void Backprojector::setUpsampleFactor(size_t upsampleFactor)
+{
+    if (!six::FFT::isPowerOfTwo(upsampleFactor))
+    {
+        throw except::Exception(Ctxt(
+                "Upsample factor must be a power of 2"));
+    }
+    mUpsampleFactor = upsampleFactor;
+}
+
+Backprojector::Support
+Backprojector::getSupport(const ImageGrid& grid) const
+{
+    const double c = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+    Support support;
+    support.rowMin = support.colMin = std::numeric_limits<double>::max();
+    support.rowMax = support.colMax = -std::numeric_limits<double>::max();
+
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        const Pulse& pulse = mPulses[ii];
+        const Vector3 direction = getRangeGradient(ii, grid.scp);
+        const double rowScale = direction.dot(grid.rowUnitVector) / c;
+        const double colScale = direction.dot(grid.colUnitVector) / c;
+
+        const double frequencies[] = {
+            pulse.fx0,
+            pulse.fx0 + (mNumSamples - 1) * pulse.fxSS
+        };
+        for (size_t jj = 0; jj < 2; ++jj)
+        {
+            const double kRow = frequencies[jj] * rowScale;
+            const double kCol = frequencies[jj] * colScale;
+            support.rowMin = std::min(support.rowMin, kRow);
+            support.rowMax = std::max(support.rowMax, kRow);
+            support.colMin = std::min(support.colMin, kCol);
+            support.colMax = std::max(support.colMax, kCol);
+        }
+    }
+
+    return support;
+}
+
+ImageGrid Backprojector::getDefaultGrid(
+        const types::RowCol<size_t>& dims) const
+{
+    const size_t midVector = mNumVectors / 2;
+    const Vector3 arpPos = getARPPos(midVector);
+
+    ImageGrid grid;
+    grid.scp = mPulses[midVector].srpPos;
+
+    const scene::SceneGeometry geometry(getARPVel(), arpPos, grid.scp);
+    const Vector3 up = geometry.getGroundPlaneNormal();
+    grid.rowUnitVector = geometry.getGroundRange();
+    grid.rowUnitVector.normalize();
+
+    const Vector3 vel = getARPVel();
+    grid.colUnitVector = vel - up * vel.dot(up) -
+            grid.rowUnitVector * vel.dot(grid.rowUnitVector);
+    grid.colUnitVector.normalize();
+
+    // The spacings only need the directions
+    grid.rowSpacing = grid.colSpacing = 1.0;
+    const Support support = getSupport(grid);
+    grid.rowSpacing = 1.0 / (1.5 * (support.rowMax - support.rowMin));
+    grid.colSpacing = 1.0 / (1.5 * (support.colMax - support.colMin));
+
+    grid.dims = dims;
+    grid.scpPixel.row = dims.row / 2;
+    grid.scpPixel.col = dims.col / 2;
+    return grid;
+}
+
+void Backprojector::form(const ImageGrid& grid, std::complex<float>* image)
+{
+    SIX_PROFILE_SCOPE("Backprojector::form");
+    grid.validate();
+
+    const size_t numPixels = grid.dims.row * grid.dims.col;
+    std::fill(image, image + numPixels, std::complex<float>(0.0f, 0.0f));
+
+    const six::FFT fft(six::FFT::nextPowerOfTwo(mNumSamples) *
+                       mUpsampleFactor);
+    const size_t fftSize = fft.getSize();
+    const size_t elementSize = mReader.getNumBytesPerSample();
+    const size_t maxVectors = std::min(mNumVectorsPerBlock, mNumVectors);
+
+    std::vector<sys::ubyte> scratch(maxVectors * mNumSamples * elementSize);
+    std::vector<std::complex<float> > samples(maxVectors * mNumSamples);
+    std::vector<std::complex<float> > profiles(maxVectors * fftSize);
+    std::vector<PulseGeometry> pulses(maxVectors);
+
+    const size_t numTileRows = (grid.dims.row + mTileSize - 1) / mTileSize;
+    const size_t numTileCols = (grid.dims.col + mTileSize - 1) / mTileSize;
+
+    for (size_t firstVector = 0;
+         firstVector < mNumVectors;
+         firstVector += maxVectors)
+    {
+        const size_t numVectors =
+                std::min(maxVectors, mNumVectors - firstVector);
+
+        for (size_t ii = 0; ii < numVectors; ++ii)
+        {
+            const Pulse& pulse = mPulses[firstVector + ii];
+            PulseGeometry& geometry = pulses[ii];
+            for (size_t kk = 0; kk < 3; ++kk)
+            {
+                geometry.tx[kk] = pulse.txPos[kk];
+                geometry.rcv[kk] = pulse.rcvPos[kk];
+            }
+            geometry.srpRange = pulse.srpRange;
+            geometry.fx0 = pulse.fx0;
+            geometry.samplesPerSecond = fftSize * pulse.fxSS;
+        }
+
+        readVectors(firstVector, numVectors,
+                    mem::BufferView<sys::ubyte>(&scratch[0], scratch.size()),
+                    mem::BufferView<std::complex<float> >(&samples[0],
+                                                          samples.size()));
+
+        {
+            SIX_PROFILE_SCOPE("Backprojector::form/rangeCompress");
+            RangeCompressContext context;
+            context.input = &samples[0];
+            context.output = &profiles[0];
+            context.numSamples = mNumSamples;
+            context.fft = &fft;
+            context.fftSign = -mPhaseSign;
+            runInParallel<RangeCompressRunnable>(context, numVectors);
+        }
+
+        {
+            SIX_PROFILE_SCOPE("Backprojector::form/backproject");
+            BackprojectContext context;
+            context.grid = &grid;
+            context.image = image;
+            context.tileSize = mTileSize;
+            context.numTileCols = numTileCols;
+            context.profiles = &profiles[0];
+            context.fftSize = fftSize;
+            context.pulses = &pulses[0];
+            context.numPulses = numVectors;
+            context.phaseSign = mPhaseSign;
+            runInParallel<BackprojectRunnable>(context,
+                                               numTileRows * numTileCols);
+        }
+    }
+
+    SIX_PROFILE_SCOPE("Backprojector::form/demodulate");
+    const Support support = getSupport(grid);
+    DemodulateContext context;
+    context.grid = &grid;
+    context.image = image;
+    context.rowKCenter = (support.rowMin + support.rowMax) / 2.0;
+    context.colKCenter = (support.colMin + support.colMax) / 2.0;
+    context.phaseSign = mPhaseSign;
+    runInParallel<DemodulateRunnable>(context, grid.dims.row);
+}
+
+std::auto_ptr<six::sicd::ComplexData>
+Backprojector::createComplexData(const ImageGrid& grid) const
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            ImageFormer::createComplexData(grid, "cphd::Backprojector");
+
+    const Support support = getSupport(grid);
+    data->grid->type = six::ComplexImageGridType::PLANE;
+    setSupport(support.rowMin, support.rowMax, *data->grid->row);
+    setSupport(support.colMin, support.colMax, *data->grid->col);
+    data->imageFormation->imageFormationAlgorithm =
+            six::ImageFormationType::OTHER;
+
+    return data;
+}
+}
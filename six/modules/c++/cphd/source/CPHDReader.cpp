@@ -28,6 +28,7 @@
 #include <mem/ScopedArray.h>
 #include <mem/SharedPtr.h>
 #include <xml/lite/MinidomParser.h>
+#include <six/Profiler.h>
 #include <cphd/CPHDReader.h>
 #include <cphd/CPHDXMLControl.h>
 
@@ -35,24 +36,32 @@ namespace cphd
 {
 CPHDReader::CPHDReader(mem::SharedPtr<io::SeekableInputStream> inStream,
                        size_t numThreads,
-                       mem::SharedPtr<logging::Logger> logger)
+                       mem::SharedPtr<logging::Logger> logger,
+                       bool loadVBM)
 {
-    initialize(inStream, numThreads, logger);
+    initialize(inStream, numThreads, logger, loadVBM);
 }
 
 CPHDReader::CPHDReader(const std::string& fromFile,
                        size_t numThreads,
-                       mem::SharedPtr<logging::Logger> logger)
+                       mem::SharedPtr<logging::Logger> logger,
+                       bool loadVBM)
 {
     initialize(mem::SharedPtr<io::SeekableInputStream>(
-        new io::FileInputStream(fromFile)), numThreads, logger);
+        new io::FileInputStream(fromFile)), numThreads, logger, loadVBM);
 }
 
 void CPHDReader::initialize(mem::SharedPtr<io::SeekableInputStream> inStream,
                             size_t numThreads,
-                            mem::SharedPtr<logging::Logger> logger)
+                            mem::SharedPtr<logging::Logger> logger,
+                            bool loadVBM)
 {
-    mFileHeader.read(*inStream);
+    SIX_PROFILE_SCOPE("CPHDReader::load");
+
+    {
+        SIX_PROFILE_SCOPE("CPHDReader::load/readHeader");
+        mFileHeader.read(*inStream);
+    }
 
     // Read in the XML string
     const int xmlSize = static_cast<int>(mFileHeader.getXMLsize());
@@ -60,25 +69,83 @@ void CPHDReader::initialize(mem::SharedPtr<io::SeekableInputStream> inStream,
 
     xml::lite::MinidomParser xmlParser;
     xmlParser.preserveCharacterData(true);
-    xmlParser.parse(*inStream, xmlSize);
+    {
+        SIX_PROFILE_SCOPE("CPHDReader::load/parseXML");
+        SIX_PROFILE_BYTES("CPHDReader::load/parseXML", xmlSize);
+        xmlParser.parse(*inStream, xmlSize);
+    }
 
     if (logger.get() == NULL)
     {
         logger.reset(new logging::NullLogger());
     }
 
-    mMetadata = CPHDXMLControl(logger.get()).fromXML(xmlParser.getDocument());
+    {
+        SIX_PROFILE_SCOPE("CPHDReader::load/fromXML");
+        mMetadata =
+                CPHDXMLControl(logger.get()).fromXML(xmlParser.getDocument());
+    }
+
+    mVBMReader.reset(new VBMReader(inStream,
+                                   mFileHeader.getVBMoffset(),
+                                   mFileHeader.getVBMsize(),
+                                   mMetadata->data,
+                                   mMetadata->vectorParameters,
+                                   numThreads));
 
     // Load the VBP into memory
-    mVBM.reset(new VBM(mMetadata->data, mMetadata->vectorParameters));
-    mVBM->load(*inStream,
-               mFileHeader.getVBMoffset(),
-               mFileHeader.getVBMsize(),
-               numThreads);
+    if (loadVBM)
+    {
+        SIX_PROFILE_SCOPE("CPHDReader::load/loadVBM");
+        SIX_PROFILE_BYTES("CPHDReader::load/loadVBM",
+                          mFileHeader.getVBMsize());
+        mVBM = mVBMReader->readAll();
+    }
 
     // Setup for wideband reading
     mWideband.reset(new Wideband(inStream, mMetadata->data,
                                  mFileHeader.getCPHDoffset(),
                                  mFileHeader.getCPHDsize()));
 }
+
+const VBM& CPHDReader::getVBM() const
+{
+    if (mVBM.get() == NULL)
+    {
+        SIX_PROFILE_SCOPE("CPHDReader::load/loadVBM");
+        SIX_PROFILE_BYTES("CPHDReader::load/loadVBM",
+                          mFileHeader.getVBMsize());
+        mVBM = mVBMReader->readAll();
+    }
+    return *mVBM;
+}
+
+std::auto_ptr<VBM> CPHDReader::getVBM(size_t channel,
+                                      size_t firstVector,
+                                      size_t numVectors) const
+{
+    // If we already have everything, there's no need to go back to the file
+    if (mVBM.get() != NULL)
+    {
+        if (channel >= mVBM->getNumChannels() ||
+            firstVector > getNumVectors(channel) ||
+            numVectors > getNumVectors(channel) - firstVector)
+        {
+            throw except::Exception(Ctxt("Invalid VBM range"));
+        }
+
+        std::auto_ptr<VBM> vbm(new VBM(1, std::vector<size_t>(1, numVectors),
+                                       mVBM->haveSRPTime(),
+                                       mVBM->haveTropoSRP(),
+                                       mVBM->haveAmpSF(),
+                                       mVBM->getDomainType()));
+        for (size_t ii = 0; ii < numVectors; ++ii)
+        {
+            vbm->copyVector(0, ii, *mVBM, channel, firstVector + ii);
+        }
+        return vbm;
+    }
+
+    return mVBMReader->read(channel, firstVector, numVectors);
+}
 }
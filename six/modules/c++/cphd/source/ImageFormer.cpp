@@ -0,0 +1,375 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <math/Constants.h>
+#include <math/linear/Vector.h>
+#include <math/poly/Fit.h>
+#include <scene/SceneGeometry.h>
+#include <scene/Utilities.h>
+#include <six/Init.h>
+#include <six/Profiler.h>
+#include <cphd/ImageFormer.h>
+
+namespace
+{
+cphd::Vector3 unit(const cphd::Vector3& vec)
+{
+    const double norm = vec.norm();
+    return norm > 0.0 ? vec / norm : vec;
+}
+}
+
+namespace cphd
+{
+const size_t ImageFormer::DEFAULT_VECTORS_PER_BLOCK = 128;
+
+ImageGrid::ImageGrid() :
+    scp(0.0),
+    rowUnitVector(0.0),
+    colUnitVector(0.0),
+    rowSpacing(six::Init::undefined<double>()),
+    colSpacing(six::Init::undefined<double>()),
+    dims(0, 0),
+    scpPixel(0, 0)
+{
+}
+
+Vector3 ImageGrid::getPosition(double row, double col) const
+{
+    return scp +
+            rowUnitVector *
+                    ((row - static_cast<double>(scpPixel.row)) * rowSpacing) +
+            colUnitVector *
+                    ((col - static_cast<double>(scpPixel.col)) * colSpacing);
+}
+
+void ImageGrid::validate() const
+{
+    if (dims.row == 0 || dims.col == 0)
+    {
+        throw except::Exception(Ctxt("Image grid is empty"));
+    }
+
+    if (!(rowSpacing > 0.0) || !(colSpacing > 0.0))
+    {
+        throw except::Exception(Ctxt(
+                "Image grid sample spacings must be positive"));
+    }
+
+    if (std::abs(rowUnitVector.norm() - 1.0) > 1e-6 ||
+        std::abs(colUnitVector.norm() - 1.0) > 1e-6 ||
+        std::abs(rowUnitVector.dot(colUnitVector)) > 1e-6)
+    {
+        throw except::Exception(Ctxt(
+                "Image grid unit vectors must be orthonormal"));
+    }
+}
+
+ImageFormer::ImageFormer(CPHDReader& reader,
+                         size_t channel,
+                         size_t numThreads,
+                         const std::string& name) :
+    mReader(reader),
+    mChannel(channel),
+    mNumThreads(std::max<size_t>(numThreads, 1)),
+    mNumVectors(0),
+    mNumSamples(0),
+    mPhaseSign(0),
+    mNumVectorsPerBlock(DEFAULT_VECTORS_PER_BLOCK)
+{
+    if (!mReader.isFX())
+    {
+        throw except::Exception(Ctxt(
+                name + " requires FX domain phase history but got " +
+                mReader.getDomainTypeString()));
+    }
+
+    if (mChannel >= mReader.getNumChannels())
+    {
+        std::ostringstream oss;
+        oss << "Invalid channel number: " << mChannel;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    mNumVectors = mReader.getNumVectors(mChannel);
+    mNumSamples = mReader.getNumSamples(mChannel);
+    if (mNumVectors < 2 || mNumSamples == 0)
+    {
+        throw except::Exception(Ctxt(
+                name + " requires at least two vectors with samples"));
+    }
+
+    switch (mReader.getMetadata().global.phaseSGN)
+    {
+    case PhaseSGN::MINUS_1:
+        mPhaseSign = -1;
+        break;
+    case PhaseSGN::PLUS_1:
+        mPhaseSign = 1;
+        break;
+    default:
+        throw except::Exception(Ctxt("Global PhaseSGN is not set"));
+    }
+
+    const std::auto_ptr<VBM> vbm = mReader.getVBM(mChannel, 0, mNumVectors);
+    mPulses.resize(mNumVectors);
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        Pulse& pulse = mPulses[ii];
+        pulse.txPos = vbm->getTxPos(0, ii);
+        pulse.rcvPos = vbm->getRcvPos(0, ii);
+        pulse.srpPos = vbm->getSRPPos(0, ii);
+        pulse.txTime = vbm->getTxTime(0, ii);
+        pulse.srpRange = (pulse.srpPos - pulse.txPos).norm() +
+                (pulse.srpPos - pulse.rcvPos).norm();
+        pulse.fx0 = vbm->getFx0(0, ii);
+        pulse.fxSS = vbm->getFxSS(0, ii);
+        pulse.fx1 = vbm->getFx1(0, ii);
+        pulse.fx2 = vbm->getFx2(0, ii);
+        pulse.ampSF = vbm->haveAmpSF() ? vbm->getAmpSF(0, ii) : 1.0;
+    }
+}
+
+ImageFormer::~ImageFormer()
+{
+}
+
+void ImageFormer::setNumVectorsPerBlock(size_t numVectorsPerBlock)
+{
+    if (numVectorsPerBlock == 0)
+    {
+        throw except::Exception(Ctxt("Need at least one vector per block"));
+    }
+    mNumVectorsPerBlock = numVectorsPerBlock;
+}
+
+void ImageFormer::readVectors(
+        size_t firstVector,
+        size_t numVectors,
+        const mem::BufferView<sys::ubyte>& scratch,
+        const mem::BufferView<std::complex<float> >& samples)
+{
+    SIX_PROFILE_SCOPE("ImageFormer::readVectors");
+
+    std::vector<double> scaleFactors(numVectors);
+    for (size_t ii = 0; ii < numVectors; ++ii)
+    {
+        scaleFactors[ii] = mPulses[firstVector + ii].ampSF;
+    }
+
+    mReader.getWideband().read(mChannel, firstVector,
+                               firstVector + numVectors - 1,
+                               0, Wideband::ALL, scaleFactors, mNumThreads,
+                               scratch, samples);
+}
+
+Vector3 ImageFormer::getARPPos(size_t vector) const
+{
+    return (mPulses[vector].txPos + mPulses[vector].rcvPos) * 0.5;
+}
+
+Vector3 ImageFormer::getARPVel() const
+{
+    return (getARPPos(mNumVectors - 1) - getARPPos(0)) /
+            (mPulses.back().txTime - mPulses.front().txTime);
+}
+
+double ImageFormer::getMidTime() const
+{
+    return (mPulses.front().txTime + mPulses.back().txTime) / 2.0;
+}
+
+Vector3 ImageFormer::getRangeGradient(size_t vector,
+                                      const Vector3& point) const
+{
+    return unit(point - mPulses[vector].txPos) +
+            unit(point - mPulses[vector].rcvPos);
+}
+
+void ImageFormer::setSupport(double kMin,
+                             double kMax,
+                             six::sicd::DirectionParameters& direction)
+{
+    direction.kCenter = (kMin + kMax) / 2.0;
+    direction.deltaK1 = kMin - direction.kCenter;
+    direction.deltaK2 = kMax - direction.kCenter;
+    direction.impulseResponseBandwidth = kMax - kMin;
+    direction.impulseResponseWidth =
+            0.886 / direction.impulseResponseBandwidth;
+}
+
+std::auto_ptr<six::sicd::ComplexData>
+ImageFormer::createComplexData(const ImageGrid& grid,
+                               const std::string& application) const
+{
+    grid.validate();
+
+    const Metadata& metadata = mReader.getMetadata();
+    const double midTime = getMidTime();
+
+    std::auto_ptr<six::sicd::ComplexData> data(new six::sicd::ComplexData());
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    data->setNumRows(grid.dims.row);
+    data->setNumCols(grid.dims.col);
+
+    *data->collectionInformation = metadata.collectionInformation;
+
+    data->imageCreation.reset(new six::sicd::ImageCreation());
+    data->imageCreation->application = application;
+    data->imageCreation->dateTime = six::DateTime();
+
+    six::sicd::ImageData& imageData = *data->imageData;
+    imageData.firstRow = 0;
+    imageData.firstCol = 0;
+    imageData.fullImage.row = static_cast<ptrdiff_t>(grid.dims.row);
+    imageData.fullImage.col = static_cast<ptrdiff_t>(grid.dims.col);
+    imageData.scpPixel.row = static_cast<ptrdiff_t>(grid.scpPixel.row);
+    imageData.scpPixel.col = static_cast<ptrdiff_t>(grid.scpPixel.col);
+
+    six::sicd::GeoData& geoData = *data->geoData;
+    geoData.scp.ecf = grid.scp;
+    geoData.scp.llh = scene::Utilities::ecefToLatLon(grid.scp);
+    const double lastRow = static_cast<double>(grid.dims.row - 1);
+    const double lastCol = static_cast<double>(grid.dims.col - 1);
+    const Vector3 corners[] = {
+        grid.getPosition(0.0, 0.0),
+        grid.getPosition(0.0, lastCol),
+        grid.getPosition(lastRow, lastCol),
+        grid.getPosition(lastRow, 0.0)
+    };
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        const six::LatLonAlt corner = scene::Utilities::ecefToLatLon(
+                corners[ii]);
+        geoData.imageCorners.getCorner(ii).setLat(corner.getLat());
+        geoData.imageCorners.getCorner(ii).setLon(corner.getLon());
+    }
+
+    // Grid
+    const scene::SceneGeometry geometry(getARPVel(),
+                                        getARPPos(mNumVectors / 2),
+                                        grid.scp);
+    const Vector3 normal = unit(math::linear::cross(grid.rowUnitVector,
+                                                    grid.colUnitVector));
+    six::sicd::Grid& sicdGrid = *data->grid;
+    if (std::abs(normal.dot(geometry.getGroundPlaneNormal())) > 1.0 - 1e-6)
+    {
+        sicdGrid.imagePlane = six::ComplexImagePlaneType::GROUND;
+    }
+    else if (std::abs(normal.dot(geometry.getSlantPlaneZ())) > 1.0 - 1e-6)
+    {
+        sicdGrid.imagePlane = six::ComplexImagePlaneType::SLANT;
+    }
+    else
+    {
+        sicdGrid.imagePlane = six::ComplexImagePlaneType::OTHER;
+    }
+    sicdGrid.timeCOAPoly = six::Poly2D(0, 0);
+    sicdGrid.timeCOAPoly[0][0] = midTime;
+
+    six::sicd::DirectionParameters* const directions[] = {
+        sicdGrid.row.get(), sicdGrid.col.get()
+    };
+    const Vector3 unitVectors[] = {grid.rowUnitVector, grid.colUnitVector};
+    const double spacings[] = {grid.rowSpacing, grid.colSpacing};
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        six::sicd::DirectionParameters& direction = *directions[ii];
+        direction.unitVector = unitVectors[ii];
+        direction.sampleSpacing = spacings[ii];
+        direction.sign = six::FFTSign(mPhaseSign);
+        direction.deltaKCOAPoly = six::Poly2D(0, 0);
+        direction.deltaKCOAPoly[0][0] = 0.0;
+        direction.weightType.reset(new six::sicd::WeightType());
+        direction.weightType->windowName = "UNIFORM";
+    }
+
+    // Timeline
+    data->timeline->collectStart = metadata.global.collectStart;
+    data->timeline->collectDuration = metadata.global.collectDuration;
+
+    // Position
+    math::linear::Vector<double> times(mNumVectors);
+    math::linear::Vector<double> arpX(mNumVectors);
+    math::linear::Vector<double> arpY(mNumVectors);
+    math::linear::Vector<double> arpZ(mNumVectors);
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        const Vector3 arpPos = getARPPos(ii);
+        times[ii] = mPulses[ii].txTime;
+        arpX[ii] = arpPos[0];
+        arpY[ii] = arpPos[1];
+        arpZ[ii] = arpPos[2];
+    }
+    data->position->arpPoly = math::poly::fit(
+            times, arpX, arpY, arpZ, std::min<size_t>(5, mNumVectors - 1));
+
+    // RadarCollection
+    double fxMin = std::numeric_limits<double>::max();
+    double fxMax = -std::numeric_limits<double>::max();
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        fxMin = std::min(fxMin, mPulses[ii].fx1);
+        fxMax = std::max(fxMax, mPulses[ii].fx2);
+    }
+    six::sicd::RadarCollection& radarCollection = *data->radarCollection;
+    radarCollection.txFrequencyMin = fxMin;
+    radarCollection.txFrequencyMax = fxMax;
+    radarCollection.txPolarization = six::PolarizationSequenceType::OTHER;
+    radarCollection.rcvChannels.resize(1);
+    radarCollection.rcvChannels[0].reset(
+            new six::sicd::ChannelParameters());
+    radarCollection.rcvChannels[0]->txRcvPolarization =
+            six::DualPolarizationType::OTHER;
+
+    // ImageFormation
+    six::sicd::ImageFormation& imageFormation = *data->imageFormation;
+    imageFormation.rcvChannelProcessed.reset(
+            new six::sicd::RcvChannelProcessed());
+    imageFormation.rcvChannelProcessed->numChannelsProcessed = 1;
+    imageFormation.rcvChannelProcessed->prfScaleFactor = 1.0;
+    imageFormation.rcvChannelProcessed->channelIndex.push_back(
+            static_cast<int>(mChannel + 1));
+    imageFormation.txRcvPolarizationProc = six::DualPolarizationType::OTHER;
+    imageFormation.tStartProc = mPulses.front().txTime;
+    imageFormation.tEndProc = mPulses.back().txTime;
+    imageFormation.txFrequencyProcMin = fxMin;
+    imageFormation.txFrequencyProcMax = fxMax;
+    imageFormation.slowTimeBeamCompensation =
+            six::SlowTimeBeamCompensationType::NO;
+    imageFormation.imageBeamCompensation = six::ImageBeamCompensationType::NO;
+    imageFormation.azimuthAutofocus = six::AutofocusType::NO;
+    imageFormation.rangeAutofocus = six::AutofocusType::NO;
+
+    // SCPCOA
+    data->scpcoa->scpTime = midTime;
+    data->scpcoa->fillDerivedFields(geoData, sicdGrid, *data->position);
+
+    return data;
+}
+}
@@ -0,0 +1,820 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <except/Exception.h>
+#include <io/TempFile.h>
+#include <math/Constants.h>
+#include <math/linear/Vector.h>
+#include <math/poly/Fit.h>
+#include <mem/BufferView.h>
+#include <scene/SceneGeometry.h>
+#include <sys/File.h>
+#include <six/FFT.h>
+#include <six/Profiler.h>
+#include <cphd/PolarFormatter.h>
+
+namespace
+{
+// Range bins in each corner turn tile
+const size_t BINS_PER_TILE = 64;
+
+// Columns that are gathered together for the range FFTs
+const size_t COLUMNS_PER_GATHER = 16;
+
+// Windowed sinc interpolation from a table of weights at fractional offsets
+class Interpolator
+{
+public:
+    static const size_t NUM_TAPS = 8;
+    static const size_t NUM_PHASES = 512;
+
+    Interpolator() :
+        mWeights((NUM_PHASES + 1) * NUM_TAPS)
+    {
+        const double halfWidth = NUM_TAPS / 2;
+        for (size_t phase = 0; phase <= NUM_PHASES; ++phase)
+        {
+            const double offset = static_cast<double>(phase) / NUM_PHASES;
+            float* const weights = &mWeights[phase * NUM_TAPS];
+
+            double sum(0.0);
+            for (size_t tap = 0; tap < NUM_TAPS; ++tap)
+            {
+                const double x = tap - (halfWidth - 1.0) - offset;
+                const double sinc = (x == 0.0) ?
+                        1.0 : std::sin(M_PI * x) / (M_PI * x);
+                const double window = 0.5 * (1.0 + std::cos(M_PI * x /
+                                                            halfWidth));
+                weights[tap] = static_cast<float>(sinc * window);
+                sum += weights[tap];
+            }
+
+            for (size_t tap = 0; tap < NUM_TAPS; ++tap)
+            {
+                weights[tap] = static_cast<float>(weights[tap] / sum);
+            }
+        }
+    }
+
+    // Samples 'input' at fractional index 'position'.  Taps past either end
+    // are zero.
+    std::complex<float> operator()(const std::complex<float>* input,
+                                   size_t size,
+                                   double position) const
+    {
+        const double index = std::floor(position);
+        const ptrdiff_t first = static_cast<ptrdiff_t>(index) -
+                static_cast<ptrdiff_t>(NUM_TAPS / 2 - 1);
+        const size_t phase = static_cast<size_t>(
+                (position - index) * NUM_PHASES + 0.5);
+        const float* const weights = &mWeights[phase * NUM_TAPS];
+
+        std::complex<float> sum(0.0f, 0.0f);
+        if (first >= 0 &&
+            first + static_cast<ptrdiff_t>(NUM_TAPS) <=
+                    static_cast<ptrdiff_t>(size))
+        {
+            const std::complex<float>* const taps = input + first;
+            for (size_t tap = 0; tap < NUM_TAPS; ++tap)
+            {
+                sum += taps[tap] * weights[tap];
+            }
+        }
+        else
+        {
+            for (size_t tap = 0; tap < NUM_TAPS; ++tap)
+            {
+                const ptrdiff_t ii = first + static_cast<ptrdiff_t>(tap);
+                if (ii >= 0 && ii < static_cast<ptrdiff_t>(size))
+                {
+                    sum += input[ii] * weights[tap];
+                }
+            }
+        }
+        return sum;
+    }
+
+private:
+    std::vector<float> mWeights;
+};
+
+/*
+ *  exp(sign * j * 2 * pi * (ii - origin) * offset / size) for ii < count.
+ *  Scaling a zero padded FFT's input and output by these centers the
+ *  spectrum's samples on 'offset' and puts the transform's origin at
+ *  'origin'.
+ */
+std::vector<std::complex<float> > makeTwiddles(size_t count,
+                                               double origin,
+                                               double offset,
+                                               size_t size,
+                                               int sign)
+{
+    std::vector<std::complex<float> > twiddles(count);
+    for (size_t ii = 0; ii < count; ++ii)
+    {
+        const double cycles = std::fmod(
+                (static_cast<double>(ii) - origin) * offset / size, 1.0);
+        const double phase = sign * 2.0 * M_PI * cycles;
+        twiddles[ii] = std::complex<float>(static_cast<float>(std::cos(phase)),
+                                           static_cast<float>(std::sin(phase)));
+    }
+    return twiddles;
+}
+
+/*
+ *  Turns range interpolated vectors into range bins by way of tiles of
+ *  vectorsPerTile x BINS_PER_TILE samples.  The tiles for a block of range
+ *  bins are stored next to each other, so reading them back for every
+ *  vector is one contiguous read.  If they're too big to keep in memory,
+ *  they go to a scratch file.
+ */
+class CornerTurn
+{
+public:
+    CornerTurn(size_t numVectors,
+               size_t numBins,
+               size_t vectorsPerTile,
+               size_t maxMemory,
+               const std::string& scratchDirectory) :
+        mNumVectors(numVectors),
+        mNumBins(numBins),
+        mVectorsPerTile(vectorsPerTile),
+        mNumVectorTiles((numVectors + vectorsPerTile - 1) / vectorsPerTile),
+        mNumBinTiles((numBins + BINS_PER_TILE - 1) / BINS_PER_TILE),
+        mTileSize(vectorsPerTile * BINS_PER_TILE)
+    {
+        const size_t numSamples = mNumVectorTiles * mNumBinTiles * mTileSize;
+        if (numSamples * sizeof(std::complex<float>) <= maxMemory)
+        {
+            mMemory.resize(numSamples);
+        }
+        else
+        {
+            mTempFile.reset(new io::TempFile(scratchDirectory));
+            mFile.reset(new sys::File(
+                    mTempFile->pathname(), sys::File::READ_AND_WRITE,
+                    sys::File::CREATE | sys::File::TRUNCATE));
+            mTile.resize(mTileSize);
+            mRow.resize(mNumVectorTiles * mTileSize);
+        }
+    }
+
+    size_t getNumBinTiles() const
+    {
+        return mNumBinTiles;
+    }
+
+    // Stores 'vectorTile' from 'bins', which is
+    // [numVectorsInTile][mNumBins]
+    void write(size_t vectorTile, const std::complex<float>* bins)
+    {
+        const size_t firstVector = vectorTile * mVectorsPerTile;
+        const size_t numVectors =
+                std::min(mVectorsPerTile, mNumVectors - firstVector);
+
+        for (size_t binTile = 0; binTile < mNumBinTiles; ++binTile)
+        {
+            const size_t offset =
+                    (binTile * mNumVectorTiles + vectorTile) * mTileSize;
+            std::complex<float>* const tile =
+                    mMemory.empty() ? &mTile[0] : &mMemory[offset];
+
+            const size_t firstBin = binTile * BINS_PER_TILE;
+            const size_t numBins = std::min(BINS_PER_TILE,
+                                            mNumBins - firstBin);
+            for (size_t ii = 0; ii < numVectors; ++ii)
+            {
+                std::copy(bins + ii * mNumBins + firstBin,
+                          bins + ii * mNumBins + firstBin + numBins,
+                          tile + ii * BINS_PER_TILE);
+            }
+
+            if (mFile.get())
+            {
+                const size_t numBytes = mTileSize * sizeof(std::complex<float>);
+                SIX_PROFILE_BYTES("PolarFormatter::cornerTurn/write",
+                                  numBytes);
+                mFile->seekTo(static_cast<sys::Off_T>(offset) *
+                                      sizeof(std::complex<float>),
+                              sys::File::FROM_START);
+                mFile->writeFrom(reinterpret_cast<const char*>(tile),
+                                 numBytes);
+            }
+        }
+    }
+
+    // Fills 'bins', which is [numBinsInTile][mNumVectors], with 'binTile'
+    void read(size_t binTile, std::complex<float>* bins)
+    {
+        const size_t offset = binTile * mNumVectorTiles * mTileSize;
+        const std::complex<float>* row;
+        if (mFile.get())
+        {
+            const size_t numBytes = mRow.size() * sizeof(std::complex<float>);
+            SIX_PROFILE_BYTES("PolarFormatter::cornerTurn/read", numBytes);
+            mFile->seekTo(static_cast<sys::Off_T>(offset) *
+                                  sizeof(std::complex<float>),
+                          sys::File::FROM_START);
+            mFile->readInto(reinterpret_cast<char*>(&mRow[0]), numBytes);
+            row = &mRow[0];
+        }
+        else
+        {
+            row = &mMemory[offset];
+        }
+
+        const size_t numBins =
+                std::min(BINS_PER_TILE, mNumBins - binTile * BINS_PER_TILE);
+        for (size_t vector = 0; vector < mNumVectors; ++vector)
+        {
+            const std::complex<float>* const input =
+                    row + vector * BINS_PER_TILE;
+            for (size_t bin = 0; bin < numBins; ++bin)
+            {
+                bins[bin * mNumVectors + vector] = input[bin];
+            }
+        }
+    }
+
+private:
+    const size_t mNumVectors;
+    const size_t mNumBins;
+    const size_t mVectorsPerTile;
+    const size_t mNumVectorTiles;
+    const size_t mNumBinTiles;
+    const size_t mTileSize;
+
+    std::vector<std::complex<float> > mMemory;
+
+    // The file has to close before the temp file removes it
+    std::auto_ptr<io::TempFile> mTempFile;
+    std::auto_ptr<sys::File> mFile;
+    std::vector<std::complex<float> > mTile;
+    std::vector<std::complex<float> > mRow;
+};
+
+// Where a vector's samples are along the range spatial frequency axis
+struct VectorSupport
+{
+    double firstK;
+    double deltaK;
+    double cosine;
+};
+
+struct RangeContext
+{
+    const std::complex<float>* samples;
+    std::complex<float>* bins;
+    const VectorSupport* vectors;
+    size_t numSamples;
+    size_t numBins;
+    double krg1;
+    double deltaKrg;
+    float scale;
+    const Interpolator* interpolator;
+};
+
+// Interpolates each vector onto the evenly spaced range spatial frequencies
+// of the inscribed rectangle
+class RangeRunnable : public sys::Runnable
+{
+public:
+    RangeRunnable(const RangeContext& context,
+                  size_t startVector,
+                  size_t numVectors) :
+        mContext(context),
+        mStartVector(startVector),
+        mNumVectors(numVectors)
+    {
+    }
+
+    virtual void run()
+    {
+        const Interpolator& interpolator = *mContext.interpolator;
+        for (size_t ii = mStartVector; ii < mStartVector + mNumVectors; ++ii)
+        {
+            const VectorSupport& vector = mContext.vectors[ii];
+            const std::complex<float>* const input =
+                    mContext.samples + ii * mContext.numSamples;
+            std::complex<float>* const output =
+                    mContext.bins + ii * mContext.numBins;
+
+            for (size_t bin = 0; bin < mContext.numBins; ++bin)
+            {
+                const double k = (mContext.krg1 + bin * mContext.deltaKrg) /
+                        vector.cosine;
+                output[bin] = interpolator(input, mContext.numSamples,
+                                           (k - vector.firstK) /
+                                                   vector.deltaK) *
+                        mContext.scale;
+            }
+        }
+    }
+
+private:
+    const RangeContext& mContext;
+    const size_t mStartVector;
+    const size_t mNumVectors;
+};
+
+struct AzimuthContext
+{
+    const std::complex<float>* bins;
+    size_t firstBin;
+    size_t numVectors;
+    const double* tangents;
+    double tangentSign;
+    double krg1;
+    double deltaKrg;
+    double kaz1;
+    double deltaKaz;
+    size_t numAzimuth;
+    const Interpolator* interpolator;
+    const six::FFT* fft;
+    const std::complex<float>* preTwiddles;
+    const std::complex<float>* postTwiddles;
+    int fftSign;
+    std::complex<float>* image;
+};
+
+// Interpolates each range bin across vectors onto the evenly spaced azimuth
+// spatial frequencies of the inscribed rectangle, and transforms it into a
+// row of the image
+class AzimuthRunnable : public sys::Runnable
+{
+public:
+    AzimuthRunnable(const AzimuthContext& context,
+                    size_t startBin,
+                    size_t numBins) :
+        mContext(context),
+        mStartBin(startBin),
+        mNumBins(numBins)
+    {
+    }
+
+    virtual void run()
+    {
+        const Interpolator& interpolator = *mContext.interpolator;
+        const size_t numVectors = mContext.numVectors;
+        const double* const tangents = mContext.tangents;
+        const size_t numCols = mContext.fft->getSize();
+
+        for (size_t ii = mStartBin; ii < mStartBin + mNumBins; ++ii)
+        {
+            const size_t bin = mContext.firstBin + ii;
+            const double krg = mContext.krg1 + bin * mContext.deltaKrg;
+            const std::complex<float>* const input =
+                    mContext.bins + ii * numVectors;
+            std::complex<float>* const output = mContext.image + bin * numCols;
+
+            for (size_t az = 0; az < mContext.numAzimuth; ++az)
+            {
+                // Tangents go up with the vector index, so the vector
+                // at this spatial frequency is between the last one that's
+                // <= it and the next one
+                const double tangent = mContext.tangentSign *
+                        (mContext.kaz1 + az * mContext.deltaKaz) / krg;
+                const size_t upper = std::min<size_t>(
+                        std::upper_bound(tangents, tangents + numVectors,
+                                         tangent) - tangents,
+                        numVectors - 1);
+                const size_t lower = std::max<size_t>(upper, 1) - 1;
+                const double position = lower +
+                        (tangent - tangents[lower]) /
+                                (tangents[lower + 1] - tangents[lower]);
+
+                output[az] = interpolator(input, numVectors, position) *
+                        mContext.preTwiddles[az];
+            }
+            std::fill(output + mContext.numAzimuth, output + numCols,
+                      std::complex<float>(0.0f, 0.0f));
+
+            mContext.fft->transform(output, mContext.fftSign);
+            for (size_t col = 0; col < numCols; ++col)
+            {
+                output[col] *= mContext.postTwiddles[col];
+            }
+        }
+    }
+
+private:
+    const AzimuthContext& mContext;
+    const size_t mStartBin;
+    const size_t mNumBins;
+};
+
+struct TransformContext
+{
+    std::complex<float>* image;
+    size_t numCols;
+    size_t numBins;
+    const six::FFT* fft;
+    const std::complex<float>* preTwiddles;
+    const std::complex<float>* postTwiddles;
+    int fftSign;
+};
+
+// Transforms columns of range bins into image columns.  A few columns at a
+// time are gathered so each row is read a cache line at a time.
+class TransformRunnable : public sys::Runnable
+{
+public:
+    TransformRunnable(const TransformContext& context,
+                      size_t startCol,
+                      size_t numCols) :
+        mContext(context),
+        mStartCol(startCol),
+        mNumCols(numCols)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t numRows = mContext.fft->getSize();
+        const size_t numBins = mContext.numBins;
+        const size_t stride = mContext.numCols;
+        std::complex<float>* const image = mContext.image;
+        std::vector<std::complex<float> > columns(COLUMNS_PER_GATHER *
+                                                  numRows);
+
+        for (size_t startCol = mStartCol;
+             startCol < mStartCol + mNumCols;
+             startCol += COLUMNS_PER_GATHER)
+        {
+            const size_t numCols = std::min(COLUMNS_PER_GATHER,
+                                            mStartCol + mNumCols - startCol);
+
+            for (size_t bin = 0; bin < numBins; ++bin)
+            {
+                const std::complex<float>* const input =
+                        image + bin * stride + startCol;
+                for (size_t ii = 0; ii < numCols; ++ii)
+                {
+                    columns[ii * numRows + bin] =
+                            input[ii] * mContext.preTwiddles[bin];
+                }
+            }
+
+            for (size_t ii = 0; ii < numCols; ++ii)
+            {
+                std::complex<float>* const column = &columns[ii * numRows];
+                std::fill(column + numBins, column + numRows,
+                          std::complex<float>(0.0f, 0.0f));
+                mContext.fft->transform(column, mContext.fftSign);
+            }
+
+            for (size_t row = 0; row < numRows; ++row)
+            {
+                std::complex<float>* const output =
+                        image + row * stride + startCol;
+                for (size_t ii = 0; ii < numCols; ++ii)
+                {
+                    output[ii] = columns[ii * numRows + row] *
+                            mContext.postTwiddles[row];
+                }
+            }
+        }
+    }
+
+private:
+    const TransformContext& mContext;
+    const size_t mStartCol;
+    const size_t mNumCols;
+};
+}
+
+namespace cphd
+{
+const double PolarFormatter::DEFAULT_OVERSAMPLE_RATIO = 1.5;
+const size_t PolarFormatter::DEFAULT_MAX_MEMORY = 1024 * 1024 * 1024;
+
+PolarFormatter::PolarFormatter(CPHDReader& reader,
+                               size_t channel,
+                               size_t numThreads) :
+    ImageFormer(reader, channel, numThreads, "Polar format"),
+    mKrg1(-std::numeric_limits<double>::max()),
+    mKrg2(std::numeric_limits<double>::max()),
+    mKaz1(0.0),
+    mKaz2(0.0),
+    mOversampleRatio(DEFAULT_OVERSAMPLE_RATIO),
+    mMaxMemory(DEFAULT_MAX_MEMORY),
+    mScratchDirectory(".")
+{
+    if (mNumSamples < 2)
+    {
+        throw except::Exception(Ctxt(
+                "Polar format requires at least two samples per vector"));
+    }
+
+    const size_t midVector = mNumVectors / 2;
+    mSCP = mPulses[midVector].srpPos;
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        if ((mPulses[ii].srpPos - mSCP).norm() > 1e-3)
+        {
+            throw except::Exception(Ctxt(
+                    "Polar format requires a fixed SRP"));
+        }
+    }
+
+    const scene::SceneGeometry geometry(getARPVel(), getARPPos(midVector),
+                                        mSCP);
+    mNormal = geometry.getGroundPlaneNormal();
+
+    std::vector<Vector3> gradients(mNumVectors);
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        const Vector3 gradient = getRangeGradient(ii, mSCP);
+        gradients[ii] = gradient - mNormal * gradient.dot(mNormal);
+    }
+
+    // The polar angle is 0 in the middle of the aperture, which is between
+    // two vectors
+    const double midTime = getMidTime();
+    size_t lower = 0;
+    while (lower + 2 < mNumVectors && mPulses[lower + 1].txTime <= midTime)
+    {
+        ++lower;
+    }
+    const double weight = (midTime - mPulses[lower].txTime) /
+            (mPulses[lower + 1].txTime - mPulses[lower].txTime);
+    mRowUnitVector = gradients[lower] * (1.0 - weight) +
+            gradients[lower + 1] * weight;
+    mRowUnitVector.normalize();
+    mColUnitVector = math::linear::cross(mNormal, mRowUnitVector);
+    mColUnitVector.normalize();
+
+    mPolarAngles.resize(mNumVectors);
+    mScaleFactors.resize(mNumVectors);
+    double tanMin = std::numeric_limits<double>::max();
+    double tanMax = -std::numeric_limits<double>::max();
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        mPolarAngles[ii] = std::atan2(gradients[ii].dot(mColUnitVector),
+                                      gradients[ii].dot(mRowUnitVector));
+        mScaleFactors[ii] = gradients[ii].norm() / 2.0;
+
+        const double cosine = std::cos(mPolarAngles[ii]);
+        const double kFirst = getFirstK(ii) * cosine;
+        const double kLast =
+                (getFirstK(ii) + (mNumSamples - 1) * getDeltaK(ii)) * cosine;
+        mKrg1 = std::max(mKrg1, std::min(kFirst, kLast));
+        mKrg2 = std::min(mKrg2, std::max(kFirst, kLast));
+
+        const double tangent = std::tan(mPolarAngles[ii]);
+        tanMin = std::min(tanMin, tangent);
+        tanMax = std::max(tanMax, tangent);
+    }
+
+    for (size_t ii = 1; ii < mNumVectors; ++ii)
+    {
+        if ((mPolarAngles[ii] - mPolarAngles[ii - 1]) *
+                    (mPolarAngles.back() - mPolarAngles.front()) <= 0.0)
+        {
+            throw except::Exception(Ctxt(
+                    "Polar format requires the polar angle to be strictly "
+                    "monotonic"));
+        }
+    }
+
+    mKaz1 = std::max(mKrg1 * tanMin, mKrg2 * tanMin);
+    mKaz2 = std::min(mKrg1 * tanMax, mKrg2 * tanMax);
+    if (!(mKrg1 > 0.0) || !(mKrg2 > mKrg1) || !(mKaz2 > mKaz1))
+    {
+        throw except::Exception(Ctxt(
+                "Polar format found no rectangle inscribed in the vectors' "
+                "spatial frequency support"));
+    }
+}
+
+double PolarFormatter::getFirstK(size_t vector) const
+{
+    return 2.0 * mPulses[vector].fx0 * mScaleFactors[vector] /
+            math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+}
+
+double PolarFormatter::getDeltaK(size_t vector) const
+{
+    return 2.0 * mPulses[vector].fxSS * mScaleFactors[vector] /
+            math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+}
+
+void PolarFormatter::setOversampleRatio(double oversampleRatio)
+{
+    if (!(oversampleRatio >= 1.0))
+    {
+        throw except::Exception(Ctxt(
+                "Oversample ratio must be at least 1"));
+    }
+    mOversampleRatio = oversampleRatio;
+}
+
+ImageGrid PolarFormatter::getGrid() const
+{
+    ImageGrid grid;
+    grid.scp = mSCP;
+    grid.rowUnitVector = mRowUnitVector;
+    grid.colUnitVector = mColUnitVector;
+
+    // The rectangle has as many samples as the vectors do
+    grid.dims.row = static_cast<size_t>(
+            std::ceil(mNumSamples * mOversampleRatio));
+    grid.dims.col = static_cast<size_t>(
+            std::ceil(mNumVectors * mOversampleRatio));
+    grid.rowSpacing = (mNumSamples - 1) / (grid.dims.row * (mKrg2 - mKrg1));
+    grid.colSpacing = (mNumVectors - 1) / (grid.dims.col * (mKaz2 - mKaz1));
+    grid.scpPixel.row = grid.dims.row / 2;
+    grid.scpPixel.col = grid.dims.col / 2;
+    return grid;
+}
+
+void PolarFormatter::form(std::complex<float>* image)
+{
+    SIX_PROFILE_SCOPE("PolarFormatter::form");
+
+    const ImageGrid grid = getGrid();
+    const size_t numBins = mNumSamples;
+    const size_t numAzimuth = mNumVectors;
+    const double deltaKrg = (mKrg2 - mKrg1) / (numBins - 1);
+    const double deltaKaz = (mKaz2 - mKaz1) / (numAzimuth - 1);
+    const Interpolator interpolator;
+
+    const size_t maxVectors = std::min(mNumVectorsPerBlock, mNumVectors);
+    CornerTurn cornerTurn(mNumVectors, numBins, maxVectors, mMaxMemory,
+                          mScratchDirectory);
+
+    {
+        SIX_PROFILE_SCOPE("PolarFormatter::form/interpolateRange");
+        const size_t elementSize = mReader.getNumBytesPerSample();
+        std::vector<sys::ubyte> scratch(maxVectors * mNumSamples *
+                                        elementSize);
+        std::vector<std::complex<float> > samples(maxVectors * mNumSamples);
+        std::vector<std::complex<float> > bins(maxVectors * numBins);
+        std::vector<VectorSupport> vectors(maxVectors);
+
+        // Scaled so a unit point target peaks at the number of vectors,
+        // the same as backprojection
+        RangeContext context;
+        context.samples = &samples[0];
+        context.bins = &bins[0];
+        context.vectors = &vectors[0];
+        context.numSamples = mNumSamples;
+        context.numBins = numBins;
+        context.krg1 = mKrg1;
+        context.deltaKrg = deltaKrg;
+        context.scale = 1.0f / numBins;
+        context.interpolator = &interpolator;
+
+        for (size_t firstVector = 0, tile = 0;
+             firstVector < mNumVectors;
+             firstVector += maxVectors, ++tile)
+        {
+            const size_t numVectors =
+                    std::min(maxVectors, mNumVectors - firstVector);
+            for (size_t ii = 0; ii < numVectors; ++ii)
+            {
+                vectors[ii].firstK = getFirstK(firstVector + ii);
+                vectors[ii].deltaK = getDeltaK(firstVector + ii);
+                vectors[ii].cosine = std::cos(mPolarAngles[firstVector + ii]);
+            }
+
+            readVectors(firstVector, numVectors,
+                        mem::BufferView<sys::ubyte>(&scratch[0],
+                                                    scratch.size()),
+                        mem::BufferView<std::complex<float> >(
+                                &samples[0], samples.size()));
+            runInParallel<RangeRunnable>(context, numVectors);
+            cornerTurn.write(tile, &bins[0]);
+        }
+    }
+
+    {
+        SIX_PROFILE_SCOPE("PolarFormatter::form/interpolateAzimuth");
+        const double tangentSign =
+                (mPolarAngles.back() > mPolarAngles.front()) ? 1.0 : -1.0;
+        std::vector<double> tangents(mNumVectors);
+        for (size_t ii = 0; ii < mNumVectors; ++ii)
+        {
+            tangents[ii] = tangentSign * std::tan(mPolarAngles[ii]);
+        }
+
+        const six::FFT fft(grid.dims.col);
+        const std::vector<std::complex<float> > preTwiddles = makeTwiddles(
+                numAzimuth, 0.0, grid.scpPixel.col, grid.dims.col,
+                mPhaseSign);
+        const std::vector<std::complex<float> > postTwiddles = makeTwiddles(
+                grid.dims.col, grid.scpPixel.col, (numAzimuth - 1) / 2.0,
+                grid.dims.col, mPhaseSign);
+        std::vector<std::complex<float> > bins(BINS_PER_TILE * mNumVectors);
+
+        AzimuthContext context;
+        context.bins = &bins[0];
+        context.numVectors = mNumVectors;
+        context.tangents = &tangents[0];
+        context.tangentSign = tangentSign;
+        context.krg1 = mKrg1;
+        context.deltaKrg = deltaKrg;
+        context.kaz1 = mKaz1;
+        context.deltaKaz = deltaKaz;
+        context.numAzimuth = numAzimuth;
+        context.interpolator = &interpolator;
+        context.fft = &fft;
+        context.preTwiddles = &preTwiddles[0];
+        context.postTwiddles = &postTwiddles[0];
+        context.fftSign = -mPhaseSign;
+        context.image = image;
+
+        for (size_t tile = 0; tile < cornerTurn.getNumBinTiles(); ++tile)
+        {
+            context.firstBin = tile * BINS_PER_TILE;
+            cornerTurn.read(tile, &bins[0]);
+            runInParallel<AzimuthRunnable>(
+                    context, std::min(BINS_PER_TILE,
+                                      numBins - context.firstBin));
+        }
+    }
+
+    SIX_PROFILE_SCOPE("PolarFormatter::form/transformRange");
+    const six::FFT fft(grid.dims.row);
+    const std::vector<std::complex<float> > preTwiddles = makeTwiddles(
+            numBins, 0.0, grid.scpPixel.row, grid.dims.row, mPhaseSign);
+    const std::vector<std::complex<float> > postTwiddles = makeTwiddles(
+            grid.dims.row, grid.scpPixel.row, (numBins - 1) / 2.0,
+            grid.dims.row, mPhaseSign);
+
+    TransformContext context;
+    context.image = image;
+    context.numCols = grid.dims.col;
+    context.numBins = numBins;
+    context.fft = &fft;
+    context.preTwiddles = &preTwiddles[0];
+    context.postTwiddles = &postTwiddles[0];
+    context.fftSign = -mPhaseSign;
+    runInParallel<TransformRunnable>(context, grid.dims.col);
+}
+
+std::auto_ptr<six::sicd::ComplexData>
+PolarFormatter::createComplexData() const
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            ImageFormer::createComplexData(getGrid(), "cphd::PolarFormatter");
+
+    data->grid->type = six::ComplexImageGridType::RGAZIM;
+    setSupport(mKrg1, mKrg2, *data->grid->row);
+    setSupport(mKaz1, mKaz2, *data->grid->col);
+    data->imageFormation->imageFormationAlgorithm =
+            six::ImageFormationType::PFA;
+
+    math::linear::Vector<double> times(mNumVectors);
+    math::linear::Vector<double> angles(mNumVectors);
+    math::linear::Vector<double> scaleFactors(mNumVectors);
+    for (size_t ii = 0; ii < mNumVectors; ++ii)
+    {
+        times[ii] = mPulses[ii].txTime;
+        angles[ii] = mPolarAngles[ii];
+        scaleFactors[ii] = mScaleFactors[ii];
+    }
+
+    data->pfa.reset(new six::sicd::PFA());
+    six::sicd::PFA& pfa = *data->pfa;
+    pfa.focusPlaneNormal = mNormal;
+    pfa.imagePlaneNormal = mNormal;
+    pfa.polarAngleRefTime = getMidTime();
+    pfa.polarAnglePoly = math::poly::fit(
+            times, angles, std::min<size_t>(5, mNumVectors - 1));
+    pfa.spatialFrequencyScaleFactorPoly = math::poly::fit(
+            angles, scaleFactors, std::min<size_t>(2, mNumVectors - 1));
+    pfa.krg1 = mKrg1;
+    pfa.krg2 = mKrg2;
+    pfa.kaz1 = mKaz1;
+    pfa.kaz2 = mKaz2;
+    pfa.slowTimeDeskew.reset(new six::sicd::SlowTimeDeskew());
+    pfa.slowTimeDeskew->applied = six::BooleanType::IS_FALSE;
+
+    return data;
+}
+}
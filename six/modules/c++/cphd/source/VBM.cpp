@@ -633,6 +633,27 @@ void VBM::setTOASS(double value, size_t channel, size_t vector)
     mData[channel][vector].toaParameters->toaSS = value;
 }
 
+void VBM::copyVector(size_t channel,
+                     size_t vector,
+                     const VBM& other,
+                     size_t otherChannel,
+                     size_t otherVector)
+{
+    verifyChannelVector(channel, vector);
+    other.verifyChannelVector(otherChannel, otherVector);
+
+    if (mSRPTimeEnabled != other.mSRPTimeEnabled ||
+        mTropoSRPEnabled != other.mTropoSRPEnabled ||
+        mAmpSFEnabled != other.mAmpSFEnabled ||
+        mDomainType != other.mDomainType)
+    {
+        throw except::Exception(Ctxt(
+                "Can't copy between VBMs with different parameters"));
+    }
+
+    mData[channel][vector] = other.mData[otherChannel][otherVector];
+}
+
 void VBM::clearAmpSF()
 {
     if (mAmpSFEnabled)
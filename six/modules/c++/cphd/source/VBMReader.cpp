@@ -0,0 +1,262 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <six/Init.h>
+#include <six/Profiler.h>
+#include <cphd/ByteSwap.h>
+#include <cphd/VBMReader.h>
+
+namespace cphd
+{
+const size_t VBMReader::DEFAULT_VECTORS_PER_BLOCK = 1024;
+const size_t VBMReader::DEFAULT_MAX_BLOCKS = 16;
+
+VBMReader::VBMReader(mem::SharedPtr<io::SeekableInputStream> inStream,
+                     sys::Off_T startVBM,
+                     sys::Off_T sizeVBM,
+                     const Data& data,
+                     const VectorParameters& vp,
+                     size_t numThreads) :
+    mInStream(inStream),
+    mStartVBM(startVBM),
+    mSizeVBM(sizeVBM),
+    mData(data),
+    mVectorParameters(vp),
+    mNumThreads(numThreads),
+    mNumVectorsPerBlock(DEFAULT_VECTORS_PER_BLOCK),
+    mMaxBlocks(DEFAULT_MAX_BLOCKS)
+{
+    // Lay things out the same way VBM does when it loads the whole thing
+    mSRPTimeEnabled = vp.srpTimeOffset() > 0;
+    mTropoSRPEnabled = vp.tropoSRPOffset() > 0;
+    mAmpSFEnabled = vp.ampSFOffset() > 0;
+    mDomainType = vp.fxParameters.get() ? DomainType::FX :
+            vp.toaParameters.get() ? DomainType::TOA : DomainType::NOT_SET;
+
+    const VBM packed(1, std::vector<size_t>(1, 1), mSRPTimeEnabled,
+                     mTropoSRPEnabled, mAmpSFEnabled, mDomainType);
+    mNumBytesPerVector = packed.getNumBytesVBP();
+
+    mNumBytesPerVectorFile = data.getNumBytesVBP();
+    if (six::Init::isUndefined<size_t>(mNumBytesPerVectorFile) ||
+        mNumBytesPerVector > mNumBytesPerVectorFile)
+    {
+        mNumBytesPerVectorFile = mNumBytesPerVector;
+    }
+
+    sys::Off_T offset(0);
+    for (size_t ii = 0; ii < data.getNumChannels(); ++ii)
+    {
+        mChannelOffsets.push_back(offset);
+        offset += static_cast<sys::Off_T>(data.getNumVectors(ii)) *
+                mNumBytesPerVectorFile;
+    }
+
+    if (offset != sizeVBM)
+    {
+        std::ostringstream oss;
+        oss << "VBMReader: calculated VBM size(" << offset
+            << ") != header VB_DATA_SIZE(" << sizeVBM << ")";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+}
+
+void VBMReader::setNumVectorsPerBlock(size_t numVectorsPerBlock)
+{
+    if (numVectorsPerBlock == 0)
+    {
+        throw except::Exception(Ctxt("Need at least one vector per block"));
+    }
+
+    if (numVectorsPerBlock != mNumVectorsPerBlock)
+    {
+        mNumVectorsPerBlock = numVectorsPerBlock;
+        mBlocks.clear();
+    }
+}
+
+void VBMReader::setMaxBlocks(size_t maxBlocks)
+{
+    mMaxBlocks = maxBlocks;
+    if (mBlocks.size() > mMaxBlocks)
+    {
+        std::list<Block>::iterator iter = mBlocks.begin();
+        std::advance(iter, mMaxBlocks);
+        mBlocks.erase(iter, mBlocks.end());
+    }
+}
+
+mem::SharedPtr<VBM> VBMReader::readBlock(size_t channel,
+                                         size_t firstVector,
+                                         size_t numVectors)
+{
+    SIX_PROFILE_SCOPE("VBMReader::readBlock");
+
+    const size_t numBytes = numVectors * mNumBytesPerVectorFile;
+    SIX_PROFILE_BYTES("VBMReader::readBlock", numBytes);
+    std::vector<sys::ubyte> buffer(numBytes);
+    if (numBytes > 0)
+    {
+        mInStream->seek(mStartVBM + mChannelOffsets[channel] +
+                                static_cast<sys::Off_T>(firstVector) *
+                                        mNumBytesPerVectorFile,
+                        io::Seekable::START);
+
+        sys::byte* const buf = reinterpret_cast<sys::byte*>(&buffer[0]);
+        size_t numBytesRead(0);
+        while (numBytesRead < numBytes)
+        {
+            const sys::SSize_T bytesThisRead =
+                    mInStream->read(buf + numBytesRead,
+                                    numBytes - numBytesRead);
+            if (bytesThisRead == io::InputStream::IS_EOF ||
+                bytesThisRead <= 0)
+            {
+                std::ostringstream oss;
+                oss << "EOF reached during VBM read for channel " << channel;
+                throw except::Exception(Ctxt(oss.str()));
+            }
+            numBytesRead += bytesThisRead;
+        }
+
+        // Input CPHD is always Big Endian
+        if (!sys::isBigEndianSystem())
+        {
+            byteSwap(buf, sizeof(double), numBytes / sizeof(double),
+                     mNumThreads);
+        }
+
+        // The file may pad each vector out past the parameters we know about
+        if (mNumBytesPerVectorFile != mNumBytesPerVector)
+        {
+            for (size_t ii = 1; ii < numVectors; ++ii)
+            {
+                ::memmove(&buffer[ii * mNumBytesPerVector],
+                          &buffer[ii * mNumBytesPerVectorFile],
+                          mNumBytesPerVector);
+            }
+        }
+    }
+
+    return mem::SharedPtr<VBM>(new VBM(
+            1, std::vector<size_t>(1, numVectors), mSRPTimeEnabled,
+            mTropoSRPEnabled, mAmpSFEnabled, mDomainType,
+            std::vector<const void*>(1, buffer.empty() ? NULL : &buffer[0])));
+}
+
+mem::SharedPtr<VBM> VBMReader::getBlock(size_t channel, size_t block)
+{
+    const size_t firstVector = block * mNumVectorsPerBlock;
+
+    for (std::list<Block>::iterator iter = mBlocks.begin();
+         iter != mBlocks.end();
+         ++iter)
+    {
+        if (iter->channel == channel && iter->firstVector == firstVector)
+        {
+            // Move it to the front
+            mBlocks.splice(mBlocks.begin(), mBlocks, iter);
+            return mBlocks.front().vbm;
+        }
+    }
+
+    const size_t numVectors =
+            std::min(mNumVectorsPerBlock,
+                     mData.getNumVectors(channel) - firstVector);
+    const mem::SharedPtr<VBM> vbm = readBlock(channel, firstVector,
+                                              numVectors);
+
+    if (mMaxBlocks > 0)
+    {
+        if (mBlocks.size() >= mMaxBlocks)
+        {
+            mBlocks.pop_back();
+        }
+
+        Block newBlock;
+        newBlock.channel = channel;
+        newBlock.firstVector = firstVector;
+        newBlock.vbm = vbm;
+        mBlocks.push_front(newBlock);
+    }
+
+    return vbm;
+}
+
+std::auto_ptr<VBM> VBMReader::read(size_t channel,
+                                   size_t firstVector,
+                                   size_t numVectors)
+{
+    if (channel >= mData.getNumChannels())
+    {
+        std::ostringstream oss;
+        oss << "Invalid channel number: " << channel;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    const size_t numVectorsTotal = mData.getNumVectors(channel);
+    if (firstVector > numVectorsTotal ||
+        numVectors > numVectorsTotal - firstVector)
+    {
+        std::ostringstream oss;
+        oss << "Invalid vector range [" << firstVector << ", "
+            << firstVector + numVectors << ") for channel " << channel
+            << " with " << numVectorsTotal << " vectors";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    std::auto_ptr<VBM> vbm(new VBM(1, std::vector<size_t>(1, numVectors),
+                                   mSRPTimeEnabled, mTropoSRPEnabled,
+                                   mAmpSFEnabled, mDomainType));
+
+    size_t vector = firstVector;
+    while (vector < firstVector + numVectors)
+    {
+        const size_t block = vector / mNumVectorsPerBlock;
+        const size_t blockStart = block * mNumVectorsPerBlock;
+        const mem::SharedPtr<VBM> blockVBM = getBlock(channel, block);
+
+        const size_t blockEnd = std::min(
+                blockStart + mNumVectorsPerBlock, firstVector + numVectors);
+        for (; vector < blockEnd; ++vector)
+        {
+            vbm->copyVector(0, vector - firstVector,
+                            *blockVBM, 0, vector - blockStart);
+        }
+    }
+
+    return vbm;
+}
+
+std::auto_ptr<VBM> VBMReader::readAll()
+{
+    std::auto_ptr<VBM> vbm(new VBM(mData, mVectorParameters));
+    vbm->load(*mInStream, mStartVBM, mSizeVBM, mNumThreads);
+    return vbm;
+}
+}
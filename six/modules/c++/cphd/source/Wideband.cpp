@@ -28,6 +28,7 @@
 #include <mt/ThreadPlanner.h>
 #include <except/Exception.h>
 #include <io/FileInputStream.h>
+#include <six/Profiler.h>
 #include <cphd/ByteSwap.h>
 #include <cphd/Utilities.h>
 #include <cphd/Wideband.h>
@@ -351,9 +352,12 @@ void Wideband::readImpl(size_t channel,
                         size_t lastSample,
                         void* data)
 {
+    SIX_PROFILE_SCOPE("Wideband::read/readFile");
+
     types::RowCol<size_t> dims;
     checkReadInputs(channel, firstVector, lastVector, firstSample, lastSample,
                     dims);
+    SIX_PROFILE_BYTES("Wideband::read/readFile", dims.area() * mElementSize);
 
     // Compute the byte offset into this channel's wideband in the CPHD file
     // First to the start of the first pulse we're going to read
@@ -392,6 +396,8 @@ void Wideband::read(size_t channel,
                     size_t numThreads,
                     const mem::BufferView<sys::ubyte>& data)
 {
+    SIX_PROFILE_SCOPE("Wideband::read");
+
     // Sanity checks
     types::RowCol<size_t> dims;
     checkReadInputs(channel, firstVector, lastVector, firstSample, lastSample,
@@ -415,6 +421,7 @@ void Wideband::read(size_t channel,
     // Element size is half mElementSize because it's complex
     if (!sys::isBigEndianSystem() && mElementSize > 2)
     {
+        SIX_PROFILE_SCOPE("Wideband::read/byteSwap");
         byteSwap(data.data, mElementSize / 2, numPixels * 2, numThreads);
     }
 }
@@ -461,6 +468,8 @@ void Wideband::read(size_t channel,
                     const mem::BufferView<sys::ubyte>& scratch,
                     const mem::BufferView<std::complex<float> >& data)
 {
+    SIX_PROFILE_SCOPE("Wideband::read");
+
     // Sanity checks
     types::RowCol<size_t> dims;
     checkReadInputs(channel, firstVector, lastVector, firstSample, lastSample,
@@ -512,6 +521,7 @@ void Wideband::read(size_t channel,
                  scratch.data);
 
         // Byte swap to little endian if necessary
+        SIX_PROFILE_SCOPE("Wideband::read/convert");
         if (!sys::isBigEndianSystem() && mElementSize > 2)
         {
             // Need to endian swap and then scale
@@ -532,6 +542,7 @@ void Wideband::read(size_t channel,
         readImpl(channel, firstVector, lastVector, firstSample, lastSample,
                  scratch.data);
 
+        SIX_PROFILE_SCOPE("Wideband::read/convert");
         if (!sys::isBigEndianSystem() && mElementSize > 2)
         {
             byteSwapAndPromote(scratch.data, mElementSize, dims, numThreads,
@@ -552,6 +563,7 @@ void Wideband::read(size_t channel,
         // Element size is half mElementSize because it's complex
         if (!sys::isBigEndianSystem() && mElementSize > 2)
         {
+            SIX_PROFILE_SCOPE("Wideband::read/byteSwap");
             byteSwap(data.data, mElementSize / 2, numPixels * 2, numThreads);
         }
     }
@@ -0,0 +1,368 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include <logging/NullLogger.h>
+#include <math/Constants.h>
+#include <sys/OS.h>
+#include <cphd/Backprojector.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/CPHDWriter.h>
+
+#include "TestCase.h"
+
+namespace
+{
+static const std::string FILE_NAME("test_backprojection.cphd");
+static const size_t NUM_VECTORS(128);
+static const size_t NUM_SAMPLES(128);
+static const double FX0(9.85e9);
+static const double BANDWIDTH(3.0e8);
+static const double PRI(1.0e-3);
+static const types::RowCol<size_t> DIMS(64, 64);
+
+// Point targets, as pixels of the default grid
+static const types::RowCol<size_t> TARGETS[] = {
+    types::RowCol<size_t>(20, 40),
+    types::RowCol<size_t>(45, 12)
+};
+static const size_t NUM_TARGETS(2);
+
+cphd::Vector3 getSRP()
+{
+    cphd::Vector3 srp(0.0);
+    srp[0] = 6378137.0;
+    return srp;
+}
+
+// Straight and level at 10 km up and 15 km out, moving 3.5 m between pulses
+cphd::Vector3 getARP(size_t vector)
+{
+    cphd::Vector3 arp = getSRP();
+    arp[0] += 10000.0;
+    arp[1] -= 15000.0;
+    arp[2] = 3.5 * (static_cast<double>(vector) -
+            static_cast<double>(NUM_VECTORS) / 2.0);
+    return arp;
+}
+
+double getFxSS()
+{
+    return BANDWIDTH / NUM_SAMPLES;
+}
+
+cphd::Metadata buildMetadata()
+{
+    cphd::Metadata metadata;
+    metadata.data.numCPHDChannels = 1;
+    metadata.data.arraySize.push_back(
+            cphd::ArraySize(NUM_VECTORS, NUM_SAMPLES));
+    metadata.data.sampleType = cphd::SampleType::RE32F_IM32F;
+    metadata.collectionInformation.collectorName = "Synthetic";
+    metadata.collectionInformation.coreName = "Backprojection";
+    metadata.collectionInformation.collectType =
+            cphd::CollectType::MONOSTATIC;
+    metadata.collectionInformation.radarMode =
+            cphd::RadarModeType::SPOTLIGHT;
+    metadata.collectionInformation.classification.level = "UNCLASSIFIED";
+    for (size_t ii = 0; ii < six::LatLonAltCorners::NUM_CORNERS; ++ii)
+    {
+        metadata.global.imageArea.acpCorners.getCorner(ii).setLat(0.0);
+        metadata.global.imageArea.acpCorners.getCorner(ii).setLon(0.0);
+        metadata.global.imageArea.acpCorners.getCorner(ii).setAlt(0.0);
+    }
+    metadata.global.phaseSGN = cphd::PhaseSGN::MINUS_1;
+    metadata.global.collectStart = cphd::DateTime(1.0e9);
+    metadata.global.collectDuration = NUM_VECTORS * PRI;
+    metadata.global.txTime1 = 0.0;
+    metadata.global.txTime2 = (NUM_VECTORS - 1) * PRI;
+    metadata.channel.parameters.resize(1);
+    metadata.srp.srpType = cphd::SRPType::STEPPED;
+    metadata.global.domainType = cphd::DomainType::FX;
+    metadata.vectorParameters.fxParameters.reset(new cphd::FxParameters());
+    return metadata;
+}
+
+// Writes phase history for point targets at 'targets', motion compensated
+// to the SRP
+void writeCPHD(const std::vector<cphd::Vector3>& targets)
+{
+    const cphd::Metadata metadata = buildMetadata();
+    const double c = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+    cphd::VBM vbm(1, std::vector<size_t>(1, NUM_VECTORS), false, false, false,
+                  cphd::DomainType::FX);
+    std::vector<std::complex<float> > data(NUM_VECTORS * NUM_SAMPLES);
+    for (size_t vector = 0; vector < NUM_VECTORS; ++vector)
+    {
+        const cphd::Vector3 arp = getARP(vector);
+        vbm.setTxTime(vector * PRI, 0, vector);
+        vbm.setTxPos(arp, 0, vector);
+        vbm.setRcvTime(vector * PRI + 1.2e-4, 0, vector);
+        vbm.setRcvPos(arp, 0, vector);
+        vbm.setSRPPos(getSRP(), 0, vector);
+        vbm.setFx0(FX0, 0, vector);
+        vbm.setFxSS(getFxSS(), 0, vector);
+        vbm.setFx1(FX0, 0, vector);
+        vbm.setFx2(FX0 + BANDWIDTH, 0, vector);
+
+        const double srpRange = 2.0 * (getSRP() - arp).norm();
+        for (size_t target = 0; target < targets.size(); ++target)
+        {
+            const double deltaTOA =
+                    (2.0 * (targets[target] - arp).norm() - srpRange) / c;
+            for (size_t sample = 0; sample < NUM_SAMPLES; ++sample)
+            {
+                const double cycles =
+                        (FX0 + sample * getFxSS()) * deltaTOA;
+                const double angle =
+                        -2.0 * M_PI * (cycles - std::floor(cycles));
+                data[vector * NUM_SAMPLES + sample] += std::complex<float>(
+                        static_cast<float>(std::cos(angle)),
+                        static_cast<float>(std::sin(angle)));
+            }
+        }
+    }
+
+    cphd::CPHDWriter writer(metadata, 1);
+    writer.writeMetadata(FILE_NAME, vbm);
+    writer.writeCPHDData(&data[0], data.size());
+    writer.close();
+}
+
+cphd::ImageGrid getGrid()
+{
+    // The default grid only depends on the geometry
+    writeCPHD(std::vector<cphd::Vector3>());
+    cphd::CPHDReader reader(FILE_NAME, 1);
+    return cphd::Backprojector(reader, 0, 1).getDefaultGrid(DIMS);
+}
+
+void writeTargets(const cphd::ImageGrid& grid)
+{
+    std::vector<cphd::Vector3> targets;
+    for (size_t ii = 0; ii < NUM_TARGETS; ++ii)
+    {
+        targets.push_back(grid.getPosition(
+                static_cast<double>(TARGETS[ii].row),
+                static_cast<double>(TARGETS[ii].col)));
+    }
+    writeCPHD(targets);
+}
+
+TEST_CASE(testDefaultGrid)
+{
+    const cphd::ImageGrid grid = getGrid();
+    const double c = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+    TEST_ASSERT_EQ(grid.dims.row, DIMS.row);
+    TEST_ASSERT_EQ(grid.dims.col, DIMS.col);
+    TEST_ASSERT_EQ(grid.scpPixel.row, 32);
+    TEST_ASSERT_EQ(grid.scpPixel.col, 32);
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(grid.scp[ii], getSRP()[ii], 1e-6);
+    }
+    TEST_ASSERT_ALMOST_EQ_EPS(grid.rowUnitVector.norm(), 1.0, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(grid.colUnitVector.norm(), 1.0, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(grid.rowUnitVector.dot(grid.colUnitVector),
+                              0.0, 1e-9);
+
+    // Ground range points away from the radar, along track follows it, and
+    // both are level
+    TEST_ASSERT_ALMOST_EQ_EPS(grid.rowUnitVector[1], 1.0, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(grid.colUnitVector[2], 1.0, 1e-6);
+
+    // Range resolution is c / 2B projected to the ground
+    const cphd::Vector3 los = getSRP() - getARP(NUM_VECTORS / 2);
+    const double cosGraze = std::sqrt(los[1] * los[1] + los[2] * los[2]) /
+            los.norm();
+    const double rowBandwidth = 2.0 * BANDWIDTH * cosGraze / c;
+    TEST_ASSERT(std::abs(grid.rowSpacing * 1.5 * rowBandwidth - 1.0) < 0.01);
+    TEST_ASSERT(grid.colSpacing > 0.0 && grid.colSpacing < 1.0);
+}
+
+TEST_CASE(testPointTargets)
+{
+    const cphd::ImageGrid grid = getGrid();
+    writeTargets(grid);
+
+    cphd::CPHDReader reader(FILE_NAME, 1);
+    cphd::Backprojector backprojector(reader, 0, 1);
+    std::vector<std::complex<float> > image(grid.dims.area());
+    backprojector.form(grid, &image[0]);
+
+    for (size_t target = 0; target < NUM_TARGETS; ++target)
+    {
+        // Each target is the brightest thing within a few pixels of it
+        const size_t row = TARGETS[target].row;
+        const size_t col = TARGETS[target].col;
+        const std::complex<float> peak = image[row * grid.dims.col + col];
+        for (size_t ii = row - 4; ii <= row + 4; ++ii)
+        {
+            for (size_t jj = col - 4; jj <= col + 4; ++jj)
+            {
+                if (ii != row || jj != col)
+                {
+                    TEST_ASSERT(std::abs(image[ii * grid.dims.col + jj]) <
+                                std::abs(peak));
+                }
+            }
+        }
+
+        // All samples add up coherently at the target
+        TEST_ASSERT(std::abs(peak) > 0.8 * NUM_VECTORS);
+
+        // Demodulation leaves the spectrum at baseband, so the phase barely
+        // changes across the mainlobe
+        const std::complex<float> right = image[row * grid.dims.col + col + 1];
+        const std::complex<float> down =
+                image[(row + 1) * grid.dims.col + col];
+        TEST_ASSERT(std::abs(std::arg(right * std::conj(peak))) < 0.3);
+        TEST_ASSERT(std::abs(std::arg(down * std::conj(peak))) < 0.3);
+    }
+
+    sys::OS().remove(FILE_NAME);
+}
+
+TEST_CASE(testThreadsAndBlocking)
+{
+    const cphd::ImageGrid grid = getGrid();
+    writeTargets(grid);
+
+    cphd::CPHDReader reader(FILE_NAME, 1);
+    cphd::Backprojector serial(reader, 0, 1);
+    std::vector<std::complex<float> > expected(grid.dims.area());
+    serial.form(grid, &expected[0]);
+
+    // Pixels always see pulses in the same order, so how the work is split
+    // up shouldn't change anything
+    cphd::Backprojector threaded(reader, 0, 3);
+    threaded.setNumVectorsPerBlock(20);
+    threaded.setTileSize(24);
+    std::vector<std::complex<float> > actual(grid.dims.area());
+    threaded.form(grid, &actual[0]);
+
+    for (size_t ii = 0; ii < expected.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(actual[ii], expected[ii]);
+    }
+
+    sys::OS().remove(FILE_NAME);
+}
+
+TEST_CASE(testComplexData)
+{
+    const cphd::ImageGrid grid = getGrid();
+    cphd::CPHDReader reader(FILE_NAME, 1);
+    const cphd::Backprojector backprojector(reader, 0, 1);
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            backprojector.createComplexData(grid);
+    const double c = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+    TEST_ASSERT_EQ(data->getNumRows(), DIMS.row);
+    TEST_ASSERT_EQ(data->getNumCols(), DIMS.col);
+    TEST_ASSERT_EQ(data->getPixelType(), six::PixelType::RE32F_IM32F);
+    TEST_ASSERT_EQ(data->collectionInformation->coreName, "Backprojection");
+    TEST_ASSERT_EQ(data->imageData->scpPixel.row, 32);
+    TEST_ASSERT_EQ(data->geoData->scp.ecf, grid.scp);
+
+    TEST_ASSERT_EQ(data->grid->type, six::ComplexImageGridType::PLANE);
+    TEST_ASSERT_EQ(data->grid->imagePlane, six::ComplexImagePlaneType::GROUND);
+    TEST_ASSERT_EQ(data->grid->row->sign, six::FFTSign::NEG);
+    TEST_ASSERT_EQ(data->grid->row->sampleSpacing, grid.rowSpacing);
+    TEST_ASSERT_EQ(data->grid->col->unitVector, grid.colUnitVector);
+    TEST_ASSERT_ALMOST_EQ_EPS(data->grid->row->deltaK1,
+                              -data->grid->row->deltaK2, 1e-6);
+    TEST_ASSERT(data->grid->row->impulseResponseBandwidth *
+                grid.rowSpacing < 1.0);
+    TEST_ASSERT(data->grid->col->impulseResponseBandwidth *
+                grid.colSpacing < 1.0);
+
+    // Column support straddles zero, and the row support is around the
+    // center frequency projected to the ground
+    const cphd::Vector3 los = getSRP() - getARP(NUM_VECTORS / 2);
+    const double cosGraze = std::sqrt(los[1] * los[1] + los[2] * los[2]) /
+            los.norm();
+    TEST_ASSERT(std::abs(data->grid->col->kCenter) <
+                data->grid->col->impulseResponseBandwidth);
+    TEST_ASSERT_ALMOST_EQ_EPS(data->grid->row->kCenter,
+                              2.0 * (FX0 + BANDWIDTH / 2.0) * cosGraze / c,
+                              1.0);
+
+    TEST_ASSERT_EQ(data->imageFormation->tStartProc, 0.0);
+    TEST_ASSERT_ALMOST_EQ(data->imageFormation->tEndProc,
+                          (NUM_VECTORS - 1) * PRI);
+    TEST_ASSERT_EQ(data->imageFormation->txFrequencyProcMin, FX0);
+    TEST_ASSERT_EQ(data->radarCollection->txFrequencyMax, FX0 + BANDWIDTH);
+
+    const cphd::Vector3 arp =
+            data->position->arpPoly(data->scpcoa->scpTime);
+    const cphd::Vector3 midARP =
+            (getARP(NUM_VECTORS / 2 - 1) + getARP(NUM_VECTORS / 2)) * 0.5;
+    TEST_ASSERT((arp - midARP).norm() < 1.0e-3);
+    TEST_ASSERT_EQ(data->scpcoa->sideOfTrack, six::SideOfTrackType::RIGHT);
+
+    logging::NullLogger logger;
+    // The CPHD doesn't describe the waveform, so leave RadarCollection out
+    TEST_ASSERT(data->grid->validate(*data->collectionInformation,
+                                     *data->imageData, logger));
+    TEST_ASSERT(data->position->validate(logger));
+    TEST_ASSERT(data->scpcoa->validate(*data->geoData, *data->grid,
+                                       *data->position, logger));
+    TEST_ASSERT(data->imageData->validate(*data->geoData, logger));
+    TEST_ASSERT(data->geoData->validate(logger));
+
+    sys::OS().remove(FILE_NAME);
+}
+
+TEST_CASE(testThrows)
+{
+    writeCPHD(std::vector<cphd::Vector3>());
+    cphd::CPHDReader reader(FILE_NAME, 1);
+    TEST_EXCEPTION(cphd::Backprojector(reader, 1, 1));
+
+    cphd::Backprojector backprojector(reader, 0, 1);
+    TEST_EXCEPTION(backprojector.setUpsampleFactor(3));
+    TEST_EXCEPTION(backprojector.setTileSize(0));
+
+    cphd::ImageGrid grid = backprojector.getDefaultGrid(DIMS);
+    grid.colUnitVector = grid.rowUnitVector;
+    std::vector<std::complex<float> > image(grid.dims.area());
+    TEST_EXCEPTION(backprojector.form(grid, &image[0]));
+
+    sys::OS().remove(FILE_NAME);
+}
+}
+
+int main(int , char** )
+{
+    TEST_CHECK(testDefaultGrid);
+    TEST_CHECK(testPointTargets);
+    TEST_CHECK(testThreadsAndBlocking);
+    TEST_CHECK(testComplexData);
+    TEST_CHECK(testThrows);
+    return 0;
+}
@@ -385,6 +385,49 @@ void runCPHDTest(const std::string& testName,
 
     writer.close();
 
+    // Only read the VBM rows we ask for, through a cache small enough that
+    // blocks have to be evicted
+    {
+        cphd::CPHDReader lazyReader(FILE_NAME, NUM_THREADS,
+                                    mem::SharedPtr<logging::Logger>(), false);
+        TEST_ASSERT(!lazyReader.isVBMLoaded());
+        TEST_ASSERT_EQ(metadata, lazyReader.getMetadata());
+
+        cphd::VBMReader& vbmReader(lazyReader.getVBMReader());
+        vbmReader.setNumVectorsPerBlock(50);
+        vbmReader.setMaxBlocks(2);
+
+        for (size_t ii = 0; ii < NUM_IMAGES; ++ii)
+        {
+            const size_t numVectors = metadata.getNumVectors(ii);
+            const size_t firstVectors[] = {0, 37, numVectors - 120};
+            for (size_t jj = 0; jj < 3; ++jj)
+            {
+                const std::auto_ptr<cphd::VBM> rows =
+                        lazyReader.getVBM(ii, firstVectors[jj], 120);
+                TEST_ASSERT_EQ(rows->getNumChannels(), 1);
+                for (size_t kk = 0; kk < 120; ++kk)
+                {
+                    const size_t vector = firstVectors[jj] + kk;
+                    TEST_ASSERT_EQ(rows->getTxTime(0, kk),
+                                   vbm.getTxTime(ii, vector));
+                    TEST_ASSERT_EQ(rows->getRcvPos(0, kk),
+                                   vbm.getRcvPos(ii, vector));
+                    TEST_ASSERT_EQ(rows->getSRPPos(0, kk),
+                                   vbm.getSRPPos(ii, vector));
+                }
+            }
+            TEST_ASSERT(vbmReader.getNumBlocksCached() <= 2);
+        }
+        TEST_ASSERT(!lazyReader.isVBMLoaded());
+
+        // Full-load behavior is still there on request
+        TEST_ASSERT_EQ(vbm, lazyReader.getVBM());
+        TEST_ASSERT(lazyReader.isVBMLoaded());
+        TEST_ASSERT(lazyReader.getVBM(0, 0, 10)->getTxTime(0, 9) ==
+                    vbm.getTxTime(0, 9));
+    }
+
     cphd::CPHDReader reader(FILE_NAME, NUM_THREADS);
     cphd::Wideband& wideband = reader.getWideband();
 
@@ -20,8 +20,21 @@
  *
  */
 
+#include <ctype.h>
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <set>
+
 #include <import/cli.h>
 #include <io/FileInputStream.h>
+#include <logging/Handler.h>
+#include <mt/CriticalSection.h>
+#include <mt/ThreadGroup.h>
+#include <sys/Mutex.h>
+#include <sys/Runnable.h>
 #include <import/six.h>
 #include <import/six/sicd.h>
 #include <import/six/sidd.h>
@@ -76,7 +89,8 @@ private:
     const bool mIgnoreCase;
 };
 
-std::vector<std::string> getPathnames(const std::string& dirname)
+std::vector<std::string> getPathnames(const std::string& dirname,
+                                      bool recursive)
 {
     std::vector<std::string> extensions;
     extensions.push_back(".nitf");
@@ -85,30 +99,375 @@ std::vector<std::string> getPathnames(const std::string& dirname)
 
     return sys::FileFinder::search(ExtensionsPredicate(extensions),
                                    std::vector<std::string>(1, dirname),
-                                   false);
+                                   recursive);
+}
+
+std::string toJSONString(const std::string& value)
+{
+    std::string json("\"");
+    for (size_t ii = 0; ii < value.size(); ++ii)
+    {
+        const char ch = value[ii];
+        switch (ch)
+        {
+        case '"':
+            json += "\\\"";
+            break;
+        case '\\':
+            json += "\\\\";
+            break;
+        case '\n':
+            json += "\\n";
+            break;
+        case '\r':
+            json += "\\r";
+            break;
+        case '\t':
+            json += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20)
+            {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x",
+                         static_cast<unsigned int>(ch));
+                json += escaped;
+            }
+            else
+            {
+                json += ch;
+            }
+        }
+    }
+    return json + "\"";
 }
 
-bool runValidation(const std::auto_ptr<six::Data>& data,
-        std::auto_ptr<logging::Logger>& log)
+/*
+ *  Pulls the pathname back out of a line written by Result::toJSON(), so a
+ *  run can pick up where an earlier one left off.  Returns false for lines
+ *  that were cut off before the pathname ended.
+ */
+bool getResultPathname(const std::string& line, std::string& pathname)
 {
-    if (data->getDataType() == six::DataType::COMPLEX)
+    const std::string prefix("{\"path\": \"");
+    if (!str::startsWith(line, prefix))
     {
-        six::sicd::ComplexData* complexData =
-                reinterpret_cast<six::sicd::ComplexData*>(
-                        data.get());
+        return false;
+    }
 
-        if (complexData->validate(*log))
+    pathname.clear();
+    for (size_t ii = prefix.size(); ii < line.size(); ++ii)
+    {
+        char ch = line[ii];
+        if (ch == '"')
         {
-            log->info(Ctxt("Successful: No Errors Found!"));
             return true;
         }
-        return false;
+        if (ch == '\\')
+        {
+            if (++ii == line.size())
+            {
+                return false;
+            }
+            ch = line[ii];
+            if (ch == 'n')
+            {
+                ch = '\n';
+            }
+            else if (ch == 'r')
+            {
+                ch = '\r';
+            }
+            else if (ch == 't')
+            {
+                ch = '\t';
+            }
+            else if (ch == 'u')
+            {
+                if (ii + 4 >= line.size())
+                {
+                    return false;
+                }
+                ch = static_cast<char>(
+                        strtol(line.substr(ii + 1, 4).c_str(), NULL, 16));
+                ii += 4;
+            }
+        }
+        pathname += ch;
+    }
+    return false;
+}
+
+//! The outcome of checking one file, written as a line of JSON
+struct Result
+{
+    Result() :
+        valid(false),
+        seconds(0.0)
+    {
     }
-    else
+
+    std::string toJSON() const
     {
-        // Nothing to validate
+        std::ostringstream ostr;
+        ostr << "{\"path\": " << toJSONString(pathname)
+             << ", \"valid\": " << (valid ? "true" : "false")
+             << ", \"products\": [";
+        for (size_t ii = 0; ii < products.size(); ++ii)
+        {
+            ostr << (ii == 0 ? "" : ", ") << toJSONString(products[ii]);
+        }
+        ostr << "], \"messages\": [";
+        for (size_t ii = 0; ii < messages.size(); ++ii)
+        {
+            ostr << (ii == 0 ? "" : ", ") << toJSONString(messages[ii]);
+        }
+        ostr << "], \"seconds\": " << seconds << "}";
+        return ostr.str();
+    }
+
+    std::string pathname;
+    bool valid;
+
+    //! Type and version of each product, e.g. "SICD 1.1.0"
+    std::vector<std::string> products;
+
+    //! Everything logged at warning level or above while checking the file
+    std::vector<std::string> messages;
+
+    double seconds;
+};
+
+//! Keeps the messages logged while checking a file
+class MessageHandler : public logging::Handler
+{
+public:
+    MessageHandler() :
+        logging::Handler(logging::LogLevel::LOG_WARNING)
+    {
+    }
+
+    std::vector<std::string> takeMessages()
+    {
+        std::vector<std::string> messages;
+        messages.swap(mMessages);
+        return messages;
+    }
+
+protected:
+    virtual void write(const std::string& str)
+    {
+        mMessages.push_back(str);
+    }
+
+    virtual void emitRecord(const logging::LogRecord* record)
+    {
+        mMessages.push_back(record->getMessage());
+    }
+
+private:
+    std::vector<std::string> mMessages;
+};
+
+/*
+ *  Hands out the files still to be checked and collects the results.
+ *  Results are appended to the output as soon as they come in, so it
+ *  doubles as the checkpoint to resume from.
+ */
+class ValidationContext
+{
+public:
+    ValidationContext(const std::vector<std::string>& pathnames,
+                      const std::vector<std::string>& schemaPaths,
+                      std::ostream& output,
+                      logging::Logger& log) :
+        mPathnames(pathnames),
+        mSchemaPaths(schemaPaths),
+        mOutput(output),
+        mLog(log),
+        mNextPathname(0),
+        mNumInvalid(0)
+    {
+    }
+
+    const std::vector<std::string>& getSchemaPaths() const
+    {
+        return mSchemaPaths;
+    }
+
+    bool next(std::string& pathname)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        if (mNextPathname == mPathnames.size())
+        {
+            return false;
+        }
+        pathname = mPathnames[mNextPathname++];
         return true;
     }
+
+    void report(const Result& result)
+    {
+        const std::string json = result.toJSON();
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mOutput << json << std::endl;
+
+        if (result.valid)
+        {
+            mLog.info(Ctxt("Successful: No Errors Found in " +
+                           result.pathname));
+        }
+        else
+        {
+            ++mNumInvalid;
+            for (size_t ii = 0; ii < result.messages.size(); ++ii)
+            {
+                mLog.error(Ctxt(result.messages[ii]));
+            }
+            mLog.error(Ctxt("Unsuccessful: " + result.pathname));
+        }
+    }
+
+    size_t getNumInvalid() const
+    {
+        return mNumInvalid;
+    }
+
+private:
+    const std::vector<std::string>& mPathnames;
+    const std::vector<std::string>& mSchemaPaths;
+    std::ostream& mOutput;
+    logging::Logger& mLog;
+    size_t mNextPathname;
+    size_t mNumInvalid;
+    sys::Mutex mMutex;
+};
+
+/*
+ *  Checks files until there are none left.  Each worker keeps its own
+ *  reader and registry across files.  Loading a NITF only reads its
+ *  headers and DES, never the pixels.
+ */
+class ValidateRunnable : public sys::Runnable
+{
+public:
+    ValidateRunnable(ValidationContext& context) :
+        mContext(context)
+    {
+        // The registry avoids adding XMLControlCreators to the
+        // XMLControlFactory singleton, which isn't safe across threads
+        mXMLRegistry.addCreator(six::DataType::COMPLEX,
+                                new six::XMLControlCreatorT<
+                                        six::sicd::ComplexXMLControl>());
+        mXMLRegistry.addCreator(six::DataType::DERIVED,
+                                new six::XMLControlCreatorT<
+                                        six::sidd::DerivedXMLControl>());
+
+        mMessages = new MessageHandler;
+        mLog.addHandler(mMessages, true);
+        mReader.setLogger(&mLog);
+        mReader.setXMLControlRegistry(&mXMLRegistry);
+    }
+
+    virtual void run()
+    {
+        Result result;
+        while (mContext.next(result.pathname))
+        {
+            check(result);
+            mContext.report(result);
+        }
+    }
+
+private:
+    void check(Result& result)
+    {
+        sys::RealTimeStopWatch stopWatch;
+        stopWatch.start();
+
+        result.valid = true;
+        result.products.clear();
+        try
+        {
+            if (nitf::Reader::getNITFVersion(result.pathname) ==
+                    NITF_VER_UNKNOWN)
+            {
+                std::auto_ptr<six::Data> data(six::parseDataFromFile(
+                        mXMLRegistry, result.pathname,
+                        mContext.getSchemaPaths(), mLog));
+                validate(*data, result);
+            }
+            else
+            {
+                mReader.load(result.pathname, mContext.getSchemaPaths());
+                const mem::SharedPtr<six::Container> container =
+                        mReader.getContainer();
+                for (size_t ii = 0; ii < container->getNumData(); ++ii)
+                {
+                    validate(*container->getData(ii), result);
+                }
+            }
+        }
+        catch (const except::Exception& ex)
+        {
+            mLog.error(ex);
+            result.valid = false;
+        }
+        catch (const std::exception& ex)
+        {
+            mLog.error(Ctxt(ex.what()));
+            result.valid = false;
+        }
+
+        result.messages = mMessages->takeMessages();
+        result.seconds = stopWatch.stop() / 1000.0;
+    }
+
+    void validate(const six::Data& data, Result& result)
+    {
+        result.products.push_back(six::XMLControl::dataTypeToString(
+                data.getDataType(), false) + " " + data.getVersion());
+
+        if (data.getDataType() == six::DataType::COMPLEX &&
+            !static_cast<const six::sicd::ComplexData&>(data).validate(mLog))
+        {
+            result.valid = false;
+        }
+    }
+
+    ValidationContext& mContext;
+    six::XMLControlRegistry mXMLRegistry;
+    logging::Logger mLog;
+    MessageHandler* mMessages;
+    six::NITFReadControl mReader;
+};
+
+/*
+ *  Reads the pathnames already in an earlier run's output.  If that run
+ *  was killed partway through writing a line, a newline is owed before
+ *  appending to it.
+ */
+std::set<std::string> readCheckpoint(const std::string& outputPathname,
+                                     bool& needNewline)
+{
+    std::set<std::string> done;
+    needNewline = false;
+
+    std::ifstream ifs(outputPathname.c_str());
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        std::string pathname;
+        if (getResultPathname(line, pathname) &&
+            str::endsWith(line, "}") &&
+            !ifs.eof())
+        {
+            done.insert(pathname);
+        }
+        needNewline = ifs.eof() && !line.empty();
+    }
+    return done;
 }
 }
 
@@ -120,7 +479,9 @@ int main(int argc, char** argv)
         cli::ArgumentParser parser;
         parser.setDescription("This program reads a SIDD/SICD along with a "\
                               "directory of schemas, and returns any error messages "\
-                              "that may be contained in the DES XML");
+                              "that may be contained in the DES XML.  Given a "\
+                              "directory, it checks every file in it in parallel "\
+                              "and can write a line of JSON per file.");
         parser.addArgument("-f --log", "Specify a log file", cli::STORE, "log",
                            "FILE")->setDefault("console");
         parser.addArgument("-l --level", "Specify log level", cli::STORE,
@@ -130,6 +491,17 @@ int main(int argc, char** argv)
         parser.addArgument("-s --schema",
                            "Specify a schema or directory of schemas",
                            cli::STORE, "schema", "FILE");
+        parser.addArgument("-t --threads", "Number of files to check at once",
+                           cli::STORE, "threads", "NUM")->setDefault(
+                                   sys::OS().getNumCPUs());
+        parser.addArgument("-r --recursive", "Search directories recursively",
+                           cli::STORE_TRUE, "recursive");
+        parser.addArgument("-o --output",
+                           "Write the result for each file to FILE as a line "
+                           "of JSON", cli::STORE, "output", "FILE");
+        parser.addArgument("--resume",
+                           "Skip the files already in the output and append "
+                           "to it", cli::STORE_TRUE, "resume");
         parser.addArgument("input", "Input SICD/SIDD file or directory of files", cli::STORE, "input",
                            "INPUT", 1, 1);
 
@@ -137,78 +509,91 @@ int main(int argc, char** argv)
             options(parser.parse(argc, (const char**) argv));
 
         const std::string inputPath(options->get<std::string>("input"));
-        std::vector<std::string> inputPathnames = getPathnames(inputPath);
+        std::vector<std::string> inputPathnames =
+                getPathnames(inputPath, options->get<bool>("recursive"));
         const std::string logFile(options->get<std::string>("log"));
         std::string level(options->get<std::string>("level"));
         std::vector<std::string> schemaPaths;
         getSchemaPaths(*options, "--schema", "schema", schemaPaths);
-
-        // create an XML registry
-        // The reason to do this is to avoid adding XMLControlCreators to the
-        // XMLControlFactory singleton - this way has more fine-grained control
-        six::XMLControlRegistry xmlRegistry;
-        xmlRegistry.addCreator(six::DataType::COMPLEX,
-                               new six::XMLControlCreatorT<
-                                       six::sicd::ComplexXMLControl>());
-        xmlRegistry.addCreator(six::DataType::DERIVED,
-                               new six::XMLControlCreatorT<
-                                       six::sidd::DerivedXMLControl>());
+        const size_t numThreads =
+                std::max<size_t>(options->get<size_t>("threads"), 1);
+        const bool resume = options->get<bool>("resume");
 
         str::upper(level);
         str::trim(level);
         std::auto_ptr<logging::Logger> log =
             logging::setupLogger(sys::Path::basename(argv[0]), level, logFile);
 
-        // this validates the DES of the input against the
-        // best available schema
-        six::NITFReadControl reader;
-        reader.setLogger(log.get());
-        reader.setXMLControlRegistry(&xmlRegistry);
-        bool allValid = true;
-        for (size_t ii = 0; ii < inputPathnames.size(); ++ii)
-        {
-            const std::string& inputPathname(inputPathnames[ii]);
-            log->info(Ctxt("Reading " + inputPathname));
-            std::auto_ptr<six::Data> data;
-            try
-            {
-                if (nitf::Reader::getNITFVersion(inputPathname) ==
-                        NITF_VER_UNKNOWN)
-                {
-                    data = six::parseDataFromFile(xmlRegistry,
-                                                  inputPathname,
-                                                  schemaPaths,
-                                                  *log);
-                    allValid = allValid && runValidation(data, log);
-                }
-                else
+        std::ofstream ofs;
+        if (options->hasValue("output"))
+        {
+            const std::string outputPathname =
+                    options->get<std::string>("output");
+            bool needNewline(false);
+            if (resume)
+            {
+                const std::set<std::string> done =
+                        readCheckpoint(outputPathname, needNewline);
+
+                std::vector<std::string> remaining;
+                for (size_t ii = 0; ii < inputPathnames.size(); ++ii)
                 {
-                    reader.load(inputPathname, schemaPaths);
-                    mem::SharedPtr<six::Container> container =
-                            reader.getContainer();
-                    for (size_t jj = 0; jj < container->getNumData(); ++jj)
+                    if (done.find(inputPathnames[ii]) == done.end())
                     {
-                        data.reset(container->getData(jj)->clone());
-                        allValid = allValid && runValidation(data, log);
+                        remaining.push_back(inputPathnames[ii]);
                     }
                 }
+                log->info(Ctxt("Resuming with " +
+                               str::toString(remaining.size()) + " of " +
+                               str::toString(inputPathnames.size()) +
+                               " files left"));
+                inputPathnames.swap(remaining);
+            }
 
+            ofs.open(outputPathname.c_str(), resume ?
+                    std::ios::out | std::ios::app : std::ios::out);
+            if (!ofs)
+            {
+                throw except::Exception(Ctxt("Unable to open " +
+                                             outputPathname));
             }
-            catch (const six::DESValidationException& ex)
+            if (needNewline)
             {
-                log->error(ex);
-                log->error(Ctxt("Unsuccessful: Please contact your product "
-                               "vendor with these details!"));
-                allValid = false;
+                ofs << std::endl;
             }
-            catch (const except::Exception& ex)
+        }
+        else if (resume)
+        {
+            throw except::Exception(Ctxt("--resume requires --output"));
+        }
+
+        // Without an output file the results just go to the log
+        std::ostringstream discard;
+        std::ostream& output = ofs.is_open() ?
+                static_cast<std::ostream&>(ofs) : discard;
+        ValidationContext context(inputPathnames, schemaPaths, output, *log);
+
+        if (numThreads == 1 || inputPathnames.size() <= 1)
+        {
+            ValidateRunnable(context).run();
+        }
+        else
+        {
+            mt::ThreadGroup threads;
+            const size_t numWorkers =
+                    std::min(numThreads, inputPathnames.size());
+            for (size_t ii = 0; ii < numWorkers; ++ii)
             {
-                log->error(ex);
-                allValid = false;
+                threads.createThread(new ValidateRunnable(context));
             }
+            threads.joinAll();
         }
 
-        return allValid ? 0 : 1;
+        log->info(Ctxt(str::toString(inputPathnames.size() -
+                                     context.getNumInvalid()) + " of " +
+                       str::toString(inputPathnames.size()) +
+                       " files are valid"));
+        return (context.getNumInvalid() == 0) ? 0 : 1;
     }
     catch (const std::exception& ex)
     {
@@ -0,0 +1,1571 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <complex>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+#include <import/cli.h>
+#include <import/six.h>
+#include <import/six/sicd.h>
+#include <import/six/sidd.h>
+#include <six/sicd/SICDWriteControl.h>
+#include <six/J2KWriteHandler.h>
+#include <logging/NullLogger.h>
+#include <sys/FileFinder.h>
+#include <sys/StopWatch.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <cphd/Backprojector.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/CPHDWriter.h>
+#include <scene/ProjectionPolynomialFitter.h>
+#include <import/six/ortho.h>
+
+/*!
+ *  Benchmarks the hot paths in SIX I/O, XML, and geometry.  Large inputs are
+ *  synthesized from the metadata of a template SICD so that runs are
+ *  reproducible without shipping big files around.  Results are written as
+ *  JSON so they can be tracked from build to build.
+ */
+namespace
+{
+struct Settings
+{
+    types::RowCol<size_t> dims;
+    size_t window;
+    size_t numWindows;
+    size_t iterations;
+    size_t warmup;
+    size_t numThreads;
+    size_t numPoints;
+    size_t numCPHDChannels;
+    size_t backprojectionSize;
+    std::vector<std::string> schemaPaths;
+    std::string scratchDir;
+};
+
+struct Result
+{
+    Result(const std::string& name_) :
+        name(name_),
+        bytesPerOp(0.0),
+        itemsPerOp(0.0)
+    {
+    }
+
+    std::string name;
+
+    //! Seconds per operation
+    std::vector<double> latencies;
+
+    double bytesPerOp;
+    double itemsPerOp;
+};
+
+/*!
+ *  The high-water mark of the whole process.  It never goes back down, so
+ *  it can't be attributed to any one scenario, and is only reported once
+ *  for the run.
+ */
+size_t getPeakRSS()
+{
+#if defined(WIN32) || defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                             sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    // Linux and Solaris report kilobytes
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+//! Times one call of an operation in seconds
+class Timer
+{
+public:
+    Timer()
+    {
+        mStopWatch.start();
+    }
+
+    double elapsed()
+    {
+        return mStopWatch.stop() / 1000.0;
+    }
+
+private:
+    sys::RealTimeStopWatch mStopWatch;
+};
+
+//! Minimal LCG so window positions are the same from run to run
+class Random
+{
+public:
+    Random() :
+        mState(12345)
+    {
+    }
+
+    size_t next(size_t max)
+    {
+        mState = mState * 6364136223846793005ULL + 1442695040888963407ULL;
+        return (max == 0) ? 0 : static_cast<size_t>((mState >> 33) % max);
+    }
+
+private:
+    sys::Uint64_T mState;
+};
+
+double percentile(const std::vector<double>& sorted, double percent)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+
+    // Nearest rank
+    const size_t rank = static_cast<size_t>(
+            std::ceil(percent / 100.0 * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+std::string toJSON(const std::vector<Result>& results,
+                   const Settings& settings)
+{
+    std::ostringstream ostr;
+    ostr << std::setprecision(9);
+    ostr << "{\n"
+         << "  \"rows\": " << settings.dims.row << ",\n"
+         << "  \"cols\": " << settings.dims.col << ",\n"
+         << "  \"iterations\": " << settings.iterations << ",\n"
+         << "  \"threads\": " << settings.numThreads << ",\n"
+         << "  \"points\": " << settings.numPoints << ",\n"
+         << "  \"process_peak_rss_bytes\": " << getPeakRSS() << ",\n"
+         << "  \"scenarios\": [";
+
+    for (size_t ii = 0; ii < results.size(); ++ii)
+    {
+        const Result& result(results[ii]);
+        std::vector<double> sorted(result.latencies);
+        std::sort(sorted.begin(), sorted.end());
+
+        double total(0.0);
+        for (size_t jj = 0; jj < sorted.size(); ++jj)
+        {
+            total += sorted[jj];
+        }
+        const double numOps = static_cast<double>(sorted.size());
+        const double mean = sorted.empty() ? 0.0 : total / numOps;
+
+        ostr << (ii == 0 ? "\n" : ",\n")
+             << "    {\n"
+             << "      \"name\": \"" << result.name << "\",\n"
+             << "      \"operations\": " << sorted.size() << ",\n"
+             << "      \"total_sec\": " << total << ",\n";
+        if (result.bytesPerOp > 0.0)
+        {
+            ostr << "      \"bytes_per_op\": " << result.bytesPerOp << ",\n"
+                 << "      \"throughput_mb_per_sec\": "
+                 << (total > 0.0 ?
+                         result.bytesPerOp * numOps / total / 1.0e6 : 0.0)
+                 << ",\n";
+        }
+        if (result.itemsPerOp > 0.0)
+        {
+            ostr << "      \"items_per_op\": " << result.itemsPerOp << ",\n"
+                 << "      \"items_per_sec\": "
+                 << (total > 0.0 ? result.itemsPerOp * numOps / total : 0.0)
+                 << ",\n";
+        }
+        ostr << "      \"latency_sec\": {"
+             << "\"min\": " << (sorted.empty() ? 0.0 : sorted.front())
+             << ", \"mean\": " << mean
+             << ", \"p50\": " << percentile(sorted, 50.0)
+             << ", \"p90\": " << percentile(sorted, 90.0)
+             << ", \"p99\": " << percentile(sorted, 99.0)
+             << ", \"max\": " << (sorted.empty() ? 0.0 : sorted.back())
+             << "}\n"
+             << "    }";
+    }
+
+    ostr << "\n  ]\n}\n";
+    return ostr.str();
+}
+
+std::vector<std::string> getPathnames(const std::string& input)
+{
+    if (sys::Path(input).isFile())
+    {
+        return std::vector<std::string>(1, input);
+    }
+
+    sys::LogicalPredicate predicate(true);
+    predicate.addPredicate(new sys::ExtensionPredicate(".nitf"), true);
+    predicate.addPredicate(new sys::ExtensionPredicate(".ntf"), true);
+    std::vector<std::string> pathnames = sys::FileFinder::search(
+            predicate, std::vector<std::string>(1, input), true);
+    std::sort(pathnames.begin(), pathnames.end());
+    return pathnames;
+}
+
+class Bench
+{
+public:
+    Bench(const Settings& settings) :
+        mSettings(settings),
+        mSICDPathname(sys::Path::joinPaths(settings.scratchDir,
+                                           "six_bench.nitf")),
+        mSICDInt16Pathname(sys::Path::joinPaths(settings.scratchDir,
+                                                "six_bench_int16.nitf")),
+        mStreamingPathname(sys::Path::joinPaths(settings.scratchDir,
+                                                "six_bench_stream.nitf")),
+        mCPHDPathname(sys::Path::joinPaths(settings.scratchDir,
+                                           "six_bench.cphd")),
+        mSIDDPathname(sys::Path::joinPaths(settings.scratchDir,
+                                           "six_bench_j2k.nitf")),
+        mChipPathname(sys::Path::joinPaths(settings.scratchDir,
+                                           "six_bench_chip.nitf"))
+    {
+        mXMLRegistry.addCreator(six::DataType::COMPLEX,
+                new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+        mXMLRegistry.addCreator(six::DataType::DERIVED,
+                new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
+
+        // The crop utilities write with the default registry
+        six::XMLControlFactory::getInstance().addCreator(
+                six::DataType::COMPLEX,
+                new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+    }
+
+    ~Bench()
+    {
+        const std::string pathnames[] = {mSICDPathname, mSICDInt16Pathname,
+                                         mStreamingPathname, mCPHDPathname,
+                                         mSIDDPathname, mChipPathname};
+        sys::OS os;
+        for (size_t ii = 0; ii < 6; ++ii)
+        {
+            try
+            {
+                if (os.exists(pathnames[ii]))
+                {
+                    os.remove(pathnames[ii]);
+                }
+            }
+            catch (...)
+            {
+            }
+        }
+    }
+
+    //! Pulls the XML out of each input and picks a template SICD
+    void loadInputs(const std::vector<std::string>& pathnames)
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&mXMLRegistry);
+        for (size_t ii = 0; ii < pathnames.size(); ++ii)
+        {
+            reader.load(pathnames[ii]);
+            mem::SharedPtr<six::Container> container = reader.getContainer();
+            for (size_t jj = 0; jj < container->getNumData(); ++jj)
+            {
+                const six::Data* const data = container->getData(jj);
+                mXMLStrings.push_back(six::toXMLString(data, &mXMLRegistry));
+
+                if (!mTemplate.get() &&
+                    data->getDataType() == six::DataType::COMPLEX)
+                {
+                    mTemplate.reset(reinterpret_cast<six::sicd::ComplexData*>(
+                            data->clone()));
+                }
+            }
+            mInputPathnames.push_back(pathnames[ii]);
+        }
+
+        if (!mTemplate.get())
+        {
+            throw except::Exception(Ctxt(
+                    "Need at least one SICD to use as a template"));
+        }
+    }
+
+    void run(std::vector<Result>& results)
+    {
+        // The writes produce the files that the reads use
+        results.push_back(benchWrite(false));
+        results.push_back(benchWrite(true));
+        results.push_back(benchStreamingWrite());
+
+        // The plugin path against the tiled one.  Neither is there if NITRO
+        // was built without J2K.
+        if (six::J2KWriteHandler::isAvailable())
+        {
+            results.push_back(benchJ2KWrite(1));
+            results.push_back(benchJ2KWrite(mSettings.numThreads));
+        }
+        writeSICD(six::PixelType::RE16I_IM16I, mSICDInt16Pathname);
+
+        results.push_back(benchRead(false));
+        results.push_back(benchRead(true));
+        const char* const readOptions[] = {
+            "", six::NITFReadControl::OPT_MEMORY_MAP,
+            six::NITFReadControl::OPT_DIRECT_IO};
+        for (size_t ii = 0; ii < 3; ++ii)
+        {
+            results.push_back(benchWideband(mSICDPathname, "wideband_float",
+                                            readOptions[ii]));
+            results.push_back(benchWideband(mSICDInt16Pathname,
+                                            "wideband_int16",
+                                            readOptions[ii]));
+        }
+        results.push_back(benchChips());
+
+        results.push_back(benchLoad());
+        results.push_back(benchXML(false));
+        if (!mSettings.schemaPaths.empty())
+        {
+            results.push_back(benchXML(true));
+        }
+
+        writeCPHD();
+        results.push_back(benchCPHDRead());
+        results.push_back(benchCPHDMetadata());
+        results.push_back(benchBackprojection());
+
+        results.push_back(benchProjection(true));
+        results.push_back(benchProjection(false));
+        results.push_back(benchPolynomialFit());
+        results.push_back(benchOrtho());
+    }
+
+private:
+    template <typename OpT>
+    Result time(const std::string& name, OpT& op, size_t opsPerIteration = 1)
+    {
+        Result result(name);
+        for (size_t ii = 0; ii < mSettings.warmup; ++ii)
+        {
+            for (size_t jj = 0; jj < opsPerIteration; ++jj)
+            {
+                op(jj);
+            }
+        }
+
+        for (size_t ii = 0; ii < mSettings.iterations; ++ii)
+        {
+            for (size_t jj = 0; jj < opsPerIteration; ++jj)
+            {
+                Timer timer;
+                op(jj);
+                result.latencies.push_back(timer.elapsed());
+            }
+        }
+
+        result.bytesPerOp = op.getBytesPerOp();
+        result.itemsPerOp = op.getItemsPerOp();
+        return result;
+    }
+
+    std::auto_ptr<six::sicd::ComplexData>
+    makeData(six::PixelType pixelType) const
+    {
+        std::auto_ptr<six::sicd::ComplexData> data(
+                reinterpret_cast<six::sicd::ComplexData*>(
+                        mTemplate->clone()));
+        data->setPixelType(pixelType);
+        data->setNumRows(mSettings.dims.row);
+        data->setNumCols(mSettings.dims.col);
+        data->imageData->firstRow = 0;
+        data->imageData->firstCol = 0;
+        data->imageData->fullImage = mSettings.dims;
+        data->imageData->scpPixel = six::RowColInt(mSettings.dims.row / 2,
+                                                   mSettings.dims.col / 2);
+        data->imageData->validData.clear();
+        return data;
+    }
+
+    template <typename T>
+    static void makeImage(const types::RowCol<size_t>& dims,
+                          std::vector<std::complex<T> >& image)
+    {
+        image.resize(dims.area());
+        for (size_t row = 0, idx = 0; row < dims.row; ++row)
+        {
+            for (size_t col = 0; col < dims.col; ++col, ++idx)
+            {
+                image[idx] = std::complex<T>(
+                        static_cast<T>((row * 31 + col) % 251),
+                        static_cast<T>((col * 17 + row) % 241));
+            }
+        }
+    }
+
+    void writeSICD(six::PixelType pixelType, const std::string& pathname,
+                   bool directIO = false)
+    {
+        std::auto_ptr<six::Data> data(makeData(pixelType).release());
+        mem::SharedPtr<six::Container> container(
+                new six::Container(six::DataType::COMPLEX));
+        container->addData(data);
+
+        std::vector<std::complex<float> > floatImage;
+        std::vector<std::complex<short> > shortImage;
+        six::BufferList buffers;
+        if (pixelType == six::PixelType::RE16I_IM16I)
+        {
+            makeImage(mSettings.dims, shortImage);
+            buffers.push_back(reinterpret_cast<const six::UByte*>(
+                    &shortImage[0]));
+        }
+        else
+        {
+            makeImage(mSettings.dims, floatImage);
+            buffers.push_back(reinterpret_cast<const six::UByte*>(
+                    &floatImage[0]));
+        }
+
+        six::NITFWriteControl writer;
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_DIRECT_IO, directIO ? 1 : 0);
+        writer.setXMLControlRegistry(&mXMLRegistry);
+        writer.initialize(container);
+        writer.save(buffers, pathname, mSettings.schemaPaths);
+    }
+
+    class WriteOp
+    {
+    public:
+        WriteOp(Bench& bench, bool directIO) :
+            mBench(bench),
+            mDirectIO(directIO)
+        {
+        }
+
+        void operator()(size_t )
+        {
+            mBench.writeSICD(six::PixelType::RE32F_IM32F,
+                             mBench.mSICDPathname, mDirectIO);
+        }
+
+        double getBytesPerOp() const
+        {
+            return mBench.mSettings.dims.area() * 8.0;
+        }
+
+        double getItemsPerOp() const
+        {
+            return 0.0;
+        }
+
+    private:
+        Bench& mBench;
+        const bool mDirectIO;
+    };
+
+    Result benchWrite(bool directIO)
+    {
+        WriteOp op(*this, directIO);
+        return time(directIO ? "nitf_write_control_save_direct" :
+                               "nitf_write_control_save", op);
+    }
+
+    class StreamingWriteOp
+    {
+    public:
+        StreamingWriteOp(Bench& bench) :
+            mBench(bench),
+            mData(bench.makeData(six::PixelType::RE32F_IM32F))
+        {
+            makeImage(bench.mSettings.dims, mImage);
+        }
+
+        void operator()(size_t )
+        {
+            // Write in strips the way a streaming producer would
+            static const size_t STRIP_ROWS = 256;
+            const types::RowCol<size_t>& dims(mBench.mSettings.dims);
+
+            six::sicd::SICDWriteControl writer(mBench.mStreamingPathname,
+                                               mBench.mSettings.schemaPaths);
+            writer.setXMLControlRegistry(&mBench.mXMLRegistry);
+            writer.initialize(*mData);
+            for (size_t row = 0; row < dims.row; row += STRIP_ROWS)
+            {
+                const size_t numRows = std::min(STRIP_ROWS, dims.row - row);
+                writer.save(&mImage[row * dims.col],
+                            types::RowCol<size_t>(row, 0),
+                            types::RowCol<size_t>(numRows, dims.col));
+            }
+            writer.close();
+        }
+
+        double getBytesPerOp() const
+        {
+            return mBench.mSettings.dims.area() * 8.0;
+        }
+
+        double getItemsPerOp() const
+        {
+            return 0.0;
+        }
+
+    private:
+        Bench& mBench;
+        const std::auto_ptr<six::sicd::ComplexData> mData;
+        std::vector<std::complex<float> > mImage;
+    };
+
+    Result benchStreamingWrite()
+    {
+        StreamingWriteOp op(*this);
+        return time("sicd_write_control_save", op);
+    }
+
+    std::auto_ptr<six::Data> makeDerivedData() const
+    {
+        six::sidd::DerivedDataBuilder builder;
+        builder.addDisplay(six::PixelType::MONO8I);
+        builder.addGeographicAndTarget(six::RegionType::GEOGRAPHIC_INFO);
+        builder.addMeasurement(six::ProjectionType::PLANE).
+                addExploitationFeatures(1);
+        std::auto_ptr<six::sidd::DerivedData> data(builder.steal());
+
+        data->setNumRows(mSettings.dims.row);
+        data->setNumCols(mSettings.dims.col);
+
+        six::LatLonCorners corners;
+        corners.upperLeft = six::LatLon(42.3, -83.8);
+        corners.upperRight = six::LatLon(42.3, -83.7);
+        corners.lowerRight = six::LatLon(42.2, -83.7);
+        corners.lowerLeft = six::LatLon(42.2, -83.8);
+        data->setImageCorners(corners);
+
+        data->productCreation->productName = "six_bench";
+        data->productCreation->productClass = "Benchmark";
+        data->productCreation->classification.classification = "U";
+        data->productCreation->processorInformation->application =
+                "six_bench";
+        data->productCreation->processorInformation->profile = "Profile";
+        data->productCreation->processorInformation->site = "Site";
+        data->display->decimationMethod =
+                six::DecimationMethod::BRIGHTEST_PIXEL;
+        data->display->magnificationMethod =
+                six::MagnificationMethod::NEAREST_NEIGHBOR;
+
+        // We know this is PGD so this is safe
+        six::sidd::PlaneProjection* const projection =
+                reinterpret_cast<six::sidd::PlaneProjection*>(
+                        data->measurement->projection.get());
+        projection->timeCOAPoly = six::Poly2D(0, 0);
+        projection->timeCOAPoly[0][0] = 1;
+        projection->productPlane.rowUnitVector = six::Vector3(0.0);
+        projection->productPlane.colUnitVector = six::Vector3(0.0);
+        data->measurement->arpPoly = six::PolyXYZ(0);
+        data->measurement->arpPoly[0] = six::Vector3(0.0);
+
+        six::sidd::Collection* const collection =
+                data->exploitationFeatures->collections[0].get();
+        collection->information->resolution.rg = 0;
+        collection->information->resolution.az = 0;
+        collection->information->collectionDuration = 0;
+        collection->information->collectionDateTime = six::DateTime();
+        collection->information->radarMode = six::RadarModeType::SPOTLIGHT;
+        data->exploitationFeatures->product.resolution.row = 0;
+        data->exploitationFeatures->product.resolution.col = 0;
+
+        return std::auto_ptr<six::Data>(data.release());
+    }
+
+    class J2KWriteOp
+    {
+    public:
+        J2KWriteOp(Bench& bench, size_t numThreads) :
+            mBench(bench),
+            mNumThreads(numThreads),
+            mContainer(new six::Container(six::DataType::DERIVED))
+        {
+            mContainer->addData(bench.makeDerivedData());
+
+            // Smooth enough to compress but not trivially
+            const types::RowCol<size_t>& dims(bench.mSettings.dims);
+            mImage.resize(dims.area());
+            for (size_t row = 0, idx = 0; row < dims.row; ++row)
+            {
+                for (size_t col = 0; col < dims.col; ++col, ++idx)
+                {
+                    mImage[idx] = static_cast<six::UByte>(
+                            (row / 4 + col / 8 + (row * col) % 7) % 256);
+                }
+            }
+        }
+
+        void operator()(size_t )
+        {
+            static const size_t BLOCK_SIZE = 1024;
+
+            six::NITFWriteControl writer;
+            six::Options& options(writer.getOptions());
+            options.setParameter(six::NITFWriteControl::OPT_J2K_COMPRESSION,
+                                 1.0);
+            options.setParameter(
+                    six::NITFWriteControl::OPT_NUM_ROWS_PER_BLOCK,
+                    BLOCK_SIZE);
+            options.setParameter(
+                    six::NITFWriteControl::OPT_NUM_COLS_PER_BLOCK,
+                    BLOCK_SIZE);
+            options.setParameter(six::NITFWriteControl::OPT_NUM_J2K_THREADS,
+                                 mNumThreads);
+            writer.setXMLControlRegistry(&mBench.mXMLRegistry);
+            writer.initialize(mContainer);
+
+            six::BufferList buffers(1, &mImage[0]);
+            writer.save(buffers, mBench.mSIDDPathname,
+                        mBench.mSettings.schemaPaths);
+        }
+
+        double getBytesPerOp() const
+        {
+            return static_cast<double>(mImage.size());
+        }
+
+        double getItemsPerOp() const
+        {
+            return 0.0;
+        }
+
+    private:
+        Bench& mBench;
+        const size_t mNumThreads;
+        mem::SharedPtr<six::Container> mContainer;
+        std::vector<six::UByte> mImage;
+    };
+
+    Result benchJ2KWrite(size_t numThreads)
+    {
+        J2KWriteOp op(*this, numThreads);
+        return time(numThreads > 1 ? "j2k_write_tiled" : "j2k_write_serial",
+                    op);
+    }
+
+    class ReadOp
+    {
+    public:
+        ReadOp(Bench& bench, bool windowed) :
+            mBench(bench),
+            mWindowed(windowed)
+        {
+            mReader.setXMLControlRegistry(&bench.mXMLRegistry);
+            mReader.load(bench.mSICDPathname);
+
+            const types::RowCol<size_t>& dims(bench.mSettings.dims);
+            mExtent = windowed ?
+                    types::RowCol<size_t>(
+                            std::min(bench.mSettings.window, dims.row),
+                            std::min(bench.mSettings.window, dims.col)) :
+                    dims;
+            mBuffer.resize(mExtent.area() * 8);
+
+            Random random;
+            for (size_t ii = 0; ii < bench.mSettings.numWindows; ++ii)
+            {
+                mOffsets.push_back(types::RowCol<size_t>(
+                        random.next(dims.row - mExtent.row + 1),
+                        random.next(dims.col - mExtent.col + 1)));
+            }
+        }
+
+        void operator()(size_t op)
+        {
+            const types::RowCol<size_t> offset = mWindowed ?
+                    mOffsets[op % mOffsets.size()] :
+                    types::RowCol<size_t>(0, 0);
+
+            six::Region region;
+            region.setStartRow(offset.row);
+            region.setStartCol(offset.col);
+            region.setNumRows(mExtent.row);
+            region.setNumCols(mExtent.col);
+            region.setBuffer(&mBuffer[0]);
+            mReader.interleaved(region, 0);
+        }
+
+        double getBytesPerOp() const
+        {
+            return static_cast<double>(mBuffer.size());
+        }
+
+        double getItemsPerOp() const
+        {
+            return 0.0;
+        }
+
+    private:
+        Bench& mBench;
+        const bool mWindowed;
+        six::NITFReadControl mReader;
+        types::RowCol<size_t> mExtent;
+        std::vector<types::RowCol<size_t> > mOffsets;
+        std::vector<six::UByte> mBuffer;
+    };
+
+    Result benchRead(bool windowed)
+    {
+        ReadOp op(*this, windowed);
+        return windowed ?
+                time("interleaved_windowed", op, mSettings.numWindows) :
+                time("interleaved_full", op);
+    }
+
+    class WidebandOp
+    {
+    public:
+        // 'option' is a boolean read control option to turn on, if any
+        WidebandOp(Bench& bench, const std::string& pathname,
+                   const std::string& option)
+        {
+            mReader.setXMLControlRegistry(&bench.mXMLRegistry);
+            if (!option.empty())
+            {
+                mReader.getOptions().setParameter(option, 1);
+            }
+            mReader.load(pathname);
+            mData = six::sicd::Utilities::getComplexData(mReader);
+            mBuffer.resize(mData->getNumRows() * mData->getNumCols());
+        }
+
+        void operator()(size_t )
+        {
+            six::sicd::Utilities::getWidebandData(mReader, *mData,
+                                                  &mBuffer[0]);
+        }
+
+        double getBytesPerOp() const
+        {
+            return mBuffer.size() * mData->getNumBytesPerPixel();
+        }
+
+        double getItemsPerOp() const
+        {
+            return 0.0;
+        }
+
+    private:
+        six::NITFReadControl mReader;
+        std::auto_ptr<six::sicd::ComplexData> mData;
+        std::vector<std::complex<float> > mBuffer;
+    };
+
+    Result benchWideband(const std::string& pathname,
+                         const std::string& name,
+                         const std::string& option)
+    {
+        WidebandOp op(*this, pathname, option);
+        if (option == six::NITFReadControl::OPT_MEMORY_MAP)
+        {
+            return time(name + "_mapped", op);
+        }
+        if (option == six::NITFReadControl::OPT_DIRECT_IO)
+        {
+            return time(name + "_direct", op);
+        }
+        return time(name, op);
+    }
+
+    //! Cuts window-sized chip products out of one parent SICD
+    class ChipOp
+    {
+    public:
+        ChipOp(Bench& bench) :
+            mBench(bench)
+        {
+            mReader.setXMLControlRegistry(&bench.mXMLRegistry);
+            mReader.load(bench.mSICDPathname);
+
+            const types::RowCol<size_t>& dims(bench.mSettings.dims);
+            mExtent = types::RowCol<size_t>(
+                    std::min(bench.mSettings.window, dims.row),
+                    std::min(bench.mSettings.window, dims.col));
+
+            Random random;
+            for (size_t ii = 0; ii < bench.mSettings.numWindows; ++ii)
+            {
+                mOffsets.push_back(types::RowCol<size_t>(
+                        random.next(dims.row - mExtent.row + 1),
+                        random.next(dims.col - mExtent.col + 1)));
+            }
+        }
+
+        void operator()(size_t op)
+        {
+            six::sicd::cropSICD(mReader, mBench.mSettings.schemaPaths,
+                                mOffsets[op % mOffsets.size()], mExtent,
+                                mBench.mChipPathname);
+        }
+
+        double getBytesPerOp() const
+        {
+            return static_cast<double>(mExtent.area() * 8);
+        }
+
+        double getItemsPerOp() const
+        {
+            return 1.0;
+        }
+
+    private:
+        Bench& mBench;
+        six::NITFReadControl mReader;
+        types::RowCol<size_t> mExtent;
+        std::vector<types::RowCol<size_t> > mOffsets;
+    };
+
+    Result benchChips()
+    {
+        ChipOp op(*this);
+        return time("chip_products", op, mSettings.numWindows);
+    }
+
+    class LoadOp
+    {
+    public:
+        LoadOp(Bench& bench) :
+            mBench(bench)
+        {
+            mReader.setXMLControlRegistry(&bench.mXMLRegistry);
+        }
+
+        void operator()(size_t op)
+        {
+            mReader.load(mBench.mInputPathnames[op],
+                         mBench.mSettings.schemaPaths);
+        }
+
+        double getBytesPerOp() const
+        {
+            return 0.0;
+        }
+
+        double getItemsPerOp() const
+        {
+            return 1.0;
+        }
+
+    private:
+        Bench& mBench;
+        six::NITFReadControl mReader;
+    };
+
+    Result benchLoad()
+    {
+        LoadOp op(*this);
+        return time("nitf_read_control_load", op, mInputPathnames.size());
+    }
+
+    class XMLOp
+    {
+    public:
+        XMLOp(Bench& bench, bool validate) :
+            mBench(bench),
+            mValidate(validate),
+            mNumBytes(0)
+        {
+            for (size_t ii = 0; ii < bench.mXMLStrings.size(); ++ii)
+            {
+                mNumBytes += bench.mXMLStrings[ii].length();
+            }
+        }
+
+        void operator()(size_t op)
+        {
+            six::parseDataFromString(
+                    mBench.mXMLRegistry,
+                    mBench.mXMLStrings[op],
+                    mValidate ? mBench.mSettings.schemaPaths :
+                                std::vector<std::string>(),
+                    mLogger);
+        }
+
+        double getBytesPerOp() const
+        {
+            return mBench.mXMLStrings.empty() ?
+                    0.0 : static_cast<double>(mNumBytes) /
+                            mBench.mXMLStrings.size();
+        }
+
+        double getItemsPerOp() const
+        {
+            return 1.0;
+        }
+
+    private:
+        Bench& mBench;
+        const bool mValidate;
+        size_t mNumBytes;
+        logging::NullLogger mLogger;
+    };
+
+    Result benchXML(bool validate)
+    {
+        XMLOp op(*this, validate);
+        return time(validate ? "xml_parse_validate" : "xml_parse",
+                    op, mXMLStrings.size());
+    }
+
+    void writeCPHD()
+    {
+        const size_t numChannels = mSettings.numCPHDChannels;
+        const types::RowCol<size_t>& dims(mSettings.dims);
+
+        cphd::Metadata metadata;
+        metadata.data.numCPHDChannels = numChannels;
+        for (size_t ii = 0; ii < numChannels; ++ii)
+        {
+            metadata.data.arraySize.push_back(
+                    cphd::ArraySize(dims.row, dims.col));
+        }
+        metadata.data.sampleType = cphd::SampleType::RE32F_IM32F;
+        metadata.collectionInformation.radarMode =
+                cphd::RadarModeType::SPOTLIGHT;
+        for (size_t ii = 0; ii < six::LatLonAltCorners::NUM_CORNERS; ++ii)
+        {
+            metadata.global.imageArea.acpCorners.getCorner(ii).setLat(0.0);
+            metadata.global.imageArea.acpCorners.getCorner(ii).setLon(0.0);
+            metadata.global.imageArea.acpCorners.getCorner(ii).setAlt(0.0);
+        }
+        metadata.channel.parameters.resize(numChannels);
+        metadata.srp.srpType = cphd::SRPType::STEPPED;
+        metadata.global.domainType = cphd::DomainType::FX;
+        metadata.global.phaseSGN = cphd::PhaseSGN::MINUS_1;
+        metadata.vectorParameters.fxParameters.reset(
+                new cphd::FxParameters());
+
+        // Give every vector distinct parameters so the VBM isn't trivial
+        const std::vector<size_t> numVectors(numChannels, dims.row);
+        cphd::VBM vbm(numChannels, numVectors, false, false, false,
+                      cphd::DomainType::FX);
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            for (size_t vector = 0; vector < dims.row; ++vector)
+            {
+                const double time = vector * 1.0e-3;
+                cphd::Vector3 pos;
+                pos[0] = 7.0e6;
+                pos[1] = vector * 7.5;
+                pos[2] = 0.0;
+                vbm.setTxTime(time, channel, vector);
+                vbm.setTxPos(pos, channel, vector);
+                vbm.setRcvTime(time + 1.0e-4, channel, vector);
+                vbm.setRcvPos(pos, channel, vector);
+                vbm.setSRPPos(cphd::Vector3(0.0), channel, vector);
+                vbm.setFx0(9.0e9, channel, vector);
+                vbm.setFxSS(1.0e5, channel, vector);
+                vbm.setFx1(9.0e9, channel, vector);
+                vbm.setFx2(9.0e9 + 1.0e5 * dims.col, channel, vector);
+            }
+        }
+
+        std::vector<std::complex<float> > image;
+        makeImage(dims, image);
+
+        cphd::CPHDWriter writer(metadata, mSettings.numThreads);
+        writer.writeMetadata(mCPHDPathname, vbm);
+        for (size_t ii = 0; ii < numChannels; ++ii)
+        {
+            writer.writeCPHDData(&image[0], image.size());
+        }
+        writer.close();
+    }
+
+    class CPHDReadOp
+    {
+    public:
+        CPHDReadOp(Bench& bench) :
+            mBench(bench),
+            mReader(bench.mCPHDPathname, bench.mSettings.numThreads),
+            mBuffer(bench.mSettings.dims.area() *
+                    mReader.getNumBytesPerSample())
+        {
+        }
+
+        void operator()(size_t op)
+        {
+            const types::RowCol<size_t>& dims(mBench.mSettings.dims);
+            mReader.getWideband().read(op, 0, cphd::Wideband::ALL,
+                                       0, cphd::Wideband::ALL,
+                                       mBench.mSettings.numThreads,
+                                       dims, &mBuffer[0]);
+        }
+
+        double getBytesPerOp() const
+        {
+            return static_cast<double>(mBuffer.size());
+        }
+
+        double getItemsPerOp() const
+        {
+            return 0.0;
+        }
+
+    private:
+        Bench& mBench;
+        cphd::CPHDReader mReader;
+        std::vector<sys::ubyte> mBuffer;
+    };
+
+    Result benchCPHDRead()
+    {
+        CPHDReadOp op(*this);
+        return time("cphd_wideband_read", op, mSettings.numCPHDChannels);
+    }
+
+    class CPHDMetadataOp
+    {
+    public:
+        CPHDMetadataOp(Bench& bench) :
+            mBench(bench)
+        {
+        }
+
+        void operator()(size_t )
+        {
+            // Opening the reader parses the XML and loads the whole VBM
+            const cphd::CPHDReader reader(mBench.mCPHDPathname,
+                                          mBench.mSettings.numThreads);
+        }
+
+        double getBytesPerOp() const
+        {
+            return 0.0;
+        }
+
+        double getItemsPerOp() const
+        {
+            return static_cast<double>(mBench.mSettings.dims.row *
+                                       mBench.mSettings.numCPHDChannels);
+        }
+
+    private:
+        Bench& mBench;
+    };
+
+    Result benchCPHDMetadata()
+    {
+        CPHDMetadataOp op(*this);
+        return time("cphd_vbm_load", op);
+    }
+
+    class BackprojectionOp
+    {
+    public:
+        BackprojectionOp(Bench& bench) :
+            mBench(bench),
+            mReader(bench.mCPHDPathname, bench.mSettings.numThreads),
+            mBackprojector(mReader, 0, bench.mSettings.numThreads)
+        {
+            // The synthetic CPHD's SRP is at the origin with the radar out
+            // along X, so image a patch in the plane facing it
+            const size_t size = bench.mSettings.backprojectionSize;
+            mGrid.scp = cphd::Vector3(0.0);
+            mGrid.rowUnitVector[0] = 1.0;
+            mGrid.colUnitVector[1] = 1.0;
+            mGrid.rowSpacing = 0.5;
+            mGrid.colSpacing = 0.5;
+            mGrid.dims = types::RowCol<size_t>(size, size);
+            mGrid.scpPixel = types::RowCol<size_t>(size / 2, size / 2);
+            mImage.resize(mGrid.dims.area());
+        }
+
+        void operator()(size_t )
+        {
+            mBackprojector.form(mGrid, &mImage[0]);
+        }
+
+        double getBytesPerOp() const
+        {
+            return static_cast<double>(mBench.mSettings.dims.area() *
+                                       mReader.getNumBytesPerSample());
+        }
+
+        //! Pixels times pulses
+        double getItemsPerOp() const
+        {
+            return static_cast<double>(mGrid.dims.area()) *
+                    static_cast<double>(mBench.mSettings.dims.row);
+        }
+
+    private:
+        Bench& mBench;
+        cphd::CPHDReader mReader;
+        cphd::Backprojector mBackprojector;
+        cphd::ImageGrid mGrid;
+        std::vector<std::complex<float> > mImage;
+    };
+
+    Result benchBackprojection()
+    {
+        BackprojectionOp op(*this);
+        return time("cphd_backprojection", op);
+    }
+
+    class ProjectionRunnable : public sys::Runnable
+    {
+    public:
+        ProjectionRunnable(const scene::ProjectionModel& model,
+                           bool imageToScene,
+                           double height,
+                           const six::RowColDouble* imagePts,
+                           six::Vector3* scenePts,
+                           size_t numPoints) :
+            mModel(model),
+            mImageToScene(imageToScene),
+            mHeight(height),
+            mImagePts(imagePts),
+            mScenePts(scenePts),
+            mNumPoints(numPoints)
+        {
+        }
+
+        virtual void run()
+        {
+            if (mImageToScene)
+            {
+                for (size_t ii = 0; ii < mNumPoints; ++ii)
+                {
+                    mScenePts[ii] = mModel.imageToScene(mImagePts[ii],
+                                                        mHeight);
+                }
+            }
+            else
+            {
+                for (size_t ii = 0; ii < mNumPoints; ++ii)
+                {
+                    mModel.sceneToImage(mScenePts[ii]);
+                }
+            }
+        }
+
+    private:
+        const scene::ProjectionModel& mModel;
+        const bool mImageToScene;
+        const double mHeight;
+        const six::RowColDouble* const mImagePts;
+        six::Vector3* const mScenePts;
+        const size_t mNumPoints;
+    };
+
+    class ProjectionOp
+    {
+    public:
+        ProjectionOp(Bench& bench, bool imageToScene) :
+            mBench(bench),
+            mImageToScene(imageToScene),
+            mData(bench.makeData(six::PixelType::RE32F_IM32F)),
+            mGeometry(six::sicd::Utilities::getSceneGeometry(mData.get())),
+            mModel(six::sicd::Utilities::getProjectionModel(
+                    mData.get(), mGeometry.get())),
+            mHeight(mData->geoData->scp.llh.getAlt()),
+            mImagePts(bench.mSettings.numPoints),
+            mScenePts(bench.mSettings.numPoints)
+        {
+            // Spread the points over the image, in meters from the SCP
+            const types::RowCol<size_t>& dims(bench.mSettings.dims);
+            const six::RowColInt& scpPixel(mData->imageData->scpPixel);
+            Random random;
+            for (size_t ii = 0; ii < mImagePts.size(); ++ii)
+            {
+                const double row = static_cast<double>(random.next(dims.row));
+                const double col = static_cast<double>(random.next(dims.col));
+                mImagePts[ii] = six::RowColDouble(
+                        (row - scpPixel.row) *
+                                mData->grid->row->sampleSpacing,
+                        (col - scpPixel.col) *
+                                mData->grid->col->sampleSpacing);
+            }
+
+            // sceneToImage() needs scene points to start from
+            if (!mImageToScene)
+            {
+                project(true);
+            }
+        }
+
+        void operator()(size_t )
+        {
+            project(mImageToScene);
+        }
+
+        double getBytesPerOp() const
+        {
+            return 0.0;
+        }
+
+        double getItemsPerOp() const
+        {
+            return static_cast<double>(mImagePts.size());
+        }
+
+    private:
+        void project(bool imageToScene)
+        {
+            const size_t numThreads = mBench.mSettings.numThreads;
+            if (numThreads <= 1)
+            {
+                ProjectionRunnable(*mModel, imageToScene, mHeight,
+                                   &mImagePts[0], &mScenePts[0],
+                                   mImagePts.size()).run();
+                return;
+            }
+
+            mt::ThreadGroup threads;
+            const mt::ThreadPlanner planner(mImagePts.size(), numThreads);
+            size_t threadNum(0);
+            size_t startPoint(0);
+            size_t numPoints(0);
+            while (planner.getThreadInfo(threadNum++, startPoint, numPoints))
+            {
+                std::auto_ptr<sys::Runnable> runnable(new ProjectionRunnable(
+                        *mModel, imageToScene, mHeight,
+                        &mImagePts[startPoint], &mScenePts[startPoint],
+                        numPoints));
+                threads.createThread(runnable);
+            }
+            threads.joinAll();
+        }
+
+    private:
+        Bench& mBench;
+        const bool mImageToScene;
+        const std::auto_ptr<six::sicd::ComplexData> mData;
+        const std::auto_ptr<scene::SceneGeometry> mGeometry;
+        const std::auto_ptr<scene::ProjectionModel> mModel;
+        const double mHeight;
+        std::vector<six::RowColDouble> mImagePts;
+        std::vector<six::Vector3> mScenePts;
+    };
+
+    Result benchProjection(bool imageToScene)
+    {
+        ProjectionOp op(*this, imageToScene);
+        return time(imageToScene ? "image_to_scene" : "scene_to_image", op);
+    }
+
+    // Samples a dense grid and fits all of the projection polynomials, the
+    // way product builders do.  The output plane is the slant plane itself.
+    class PolynomialFitOp
+    {
+    public:
+        PolynomialFitOp(Bench& bench) :
+            mBench(bench),
+            mData(bench.makeData(six::PixelType::RE32F_IM32F)),
+            mGeometry(six::sicd::Utilities::getSceneGeometry(mData.get())),
+            mModel(six::sicd::Utilities::getProjectionModel(
+                    mData.get(), mGeometry.get())),
+            mSampleSpacing(mData->grid->row->sampleSpacing,
+                           mData->grid->col->sampleSpacing),
+            mSceneCenter(mData->imageData->scpPixel.row,
+                         mData->imageData->scpPixel.col),
+            mGridTransform(mSampleSpacing, mSceneCenter,
+                           mData->grid->row->unitVector,
+                           mData->grid->col->unitVector,
+                           mData->geoData->scp.ecf)
+        {
+        }
+
+        void operator()(size_t )
+        {
+            const scene::ProjectionPolynomialFitter fitter(
+                    *mModel, mGridTransform,
+                    types::RowCol<double>(0.0, 0.0),
+                    mBench.mSettings.dims, NUM_POINTS_1D,
+                    mBench.mSettings.numThreads);
+
+            math::poly::TwoD<double> rowPoly;
+            math::poly::TwoD<double> colPoly;
+            math::poly::TwoD<double> timeCOAPoly;
+            fitter.fitOutputToSlantPolynomials(
+                    types::RowCol<size_t>(0, 0), mSceneCenter, mSceneCenter,
+                    mSampleSpacing, POLY_ORDER, POLY_ORDER,
+                    rowPoly, colPoly);
+            fitter.fitSlantToOutputPolynomials(
+                    types::RowCol<size_t>(0, 0), mSceneCenter, mSceneCenter,
+                    mSampleSpacing, POLY_ORDER, POLY_ORDER,
+                    rowPoly, colPoly);
+            fitter.fitTimeCOAPolynomial(mSceneCenter, mSampleSpacing,
+                                        POLY_ORDER, POLY_ORDER,
+                                        timeCOAPoly);
+            fitter.fitPixelBasedTimeCOAPolynomial(
+                    types::RowCol<double>(0.0, 0.0),
+                    POLY_ORDER, POLY_ORDER, timeCOAPoly);
+        }
+
+        double getBytesPerOp() const
+        {
+            return 0.0;
+        }
+
+        double getItemsPerOp() const
+        {
+            return NUM_POINTS_1D * NUM_POINTS_1D;
+        }
+
+    private:
+        static const size_t NUM_POINTS_1D = 50;
+        static const size_t POLY_ORDER = 5;
+
+        Bench& mBench;
+        const std::auto_ptr<six::sicd::ComplexData> mData;
+        const std::auto_ptr<scene::SceneGeometry> mGeometry;
+        const std::auto_ptr<scene::ProjectionModel> mModel;
+        const types::RowCol<double> mSampleSpacing;
+        const types::RowCol<double> mSceneCenter;
+        const scene::PlanarGridECEFTransform mGridTransform;
+    };
+
+    Result benchPolynomialFit()
+    {
+        PolynomialFitOp op(*this);
+        return time("projection_polynomial_fit", op);
+    }
+
+    // Orthorectifies the synthetic SICD onto a ground plane covering it,
+    // with per-tile polynomial projections and bilinear interpolation
+    class OrthoOp
+    {
+    public:
+        OrthoOp(Bench& bench) :
+            mKernel(six::ortho::InterpolationKernel::BILINEAR)
+        {
+            mReader.setXMLControlRegistry(&bench.mXMLRegistry);
+            mReader.load(bench.mSICDPathname);
+            const six::sicd::ComplexData& data =
+                    static_cast<const six::sicd::ComplexData&>(
+                            *mReader.getContainer()->getData(0));
+
+            const double height = data.geoData->scp.llh.getAlt();
+            mHeightModel.reset(new six::ortho::ConstantHeightModel(height));
+            const double spacing = std::max(data.grid->row->sampleSpacing,
+                                            data.grid->col->sampleSpacing);
+            const six::ortho::OutputGrid grid(
+                    six::ortho::OutputGrid::planar(
+                            six::ortho::OrthoResampler::getInputFootprint(
+                                    data, *mHeightModel),
+                            height,
+                            types::RowCol<double>(spacing, spacing)));
+
+            mInputImage.reset(new six::ortho::NITFInputImage(mReader));
+            mResampler.reset(new six::ortho::OrthoResampler(
+                    data, *mInputImage, grid, mKernel, *mHeightModel,
+                    bench.mSettings.numThreads));
+            mOutput.resize(grid.getDims().area());
+        }
+
+        void operator()(size_t )
+        {
+            mResampler->resample(0, mResampler->getOutputGrid().getDims().row,
+                                 &mOutput[0]);
+        }
+
+        double getBytesPerOp() const
+        {
+            return static_cast<double>(mOutput.size() * sizeof(float));
+        }
+
+        double getItemsPerOp() const
+        {
+            return static_cast<double>(mOutput.size());
+        }
+
+    private:
+        six::NITFReadControl mReader;
+        std::auto_ptr<const six::ortho::HeightModel> mHeightModel;
+        const six::ortho::InterpolationKernel mKernel;
+        std::auto_ptr<six::ortho::NITFInputImage> mInputImage;
+        std::auto_ptr<six::ortho::OrthoResampler> mResampler;
+        std::vector<float> mOutput;
+    };
+
+    Result benchOrtho()
+    {
+        OrthoOp op(*this);
+        return time("ortho_resample", op);
+    }
+
+private:
+    const Settings& mSettings;
+    const std::string mSICDPathname;
+    const std::string mSICDInt16Pathname;
+    const std::string mStreamingPathname;
+    const std::string mCPHDPathname;
+    const std::string mSIDDPathname;
+    const std::string mChipPathname;
+    six::XMLControlRegistry mXMLRegistry;
+    std::vector<std::string> mInputPathnames;
+    std::vector<std::string> mXMLStrings;
+    std::auto_ptr<six::sicd::ComplexData> mTemplate;
+};
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        // create a parser and add our options to it
+        cli::ArgumentParser parser;
+        parser.setDescription(
+                "Benchmarks SIX reads, writes, chipping, XML parsing, CPHD "
+                "reads, backprojection, projections, and orthorectification.  "
+                "Large SICDs and CPHDs are synthesized from the metadata of "
+                "the first SICD found in the input.  Results are written as "
+                "JSON.");
+        parser.addArgument("--rows", "Rows in the synthetic images",
+                           cli::STORE, "rows", "ROWS")->setDefault(2048);
+        parser.addArgument("--cols", "Columns in the synthetic images",
+                           cli::STORE, "cols", "COLS")->setDefault(2048);
+        parser.addArgument("--window", "Size of windowed reads",
+                           cli::STORE, "window", "PIXELS")->setDefault(512);
+        parser.addArgument("--windows", "Windowed reads per iteration",
+                           cli::STORE, "windows", "NUM")->setDefault(16);
+        parser.addArgument("-i --iterations", "Timed iterations per scenario",
+                           cli::STORE, "iterations", "NUM")->setDefault(5);
+        parser.addArgument("--warmup", "Untimed iterations per scenario",
+                           cli::STORE, "warmup", "NUM")->setDefault(1);
+        parser.addArgument("-t --threads", "Number of threads to use",
+                           cli::STORE, "threads", "NUM")->setDefault(
+                                   sys::OS().getNumCPUs());
+        parser.addArgument("-p --points", "Points per projection batch",
+                           cli::STORE, "points", "NUM")->setDefault(100000);
+        parser.addArgument("--channels", "Channels in the synthetic CPHD",
+                           cli::STORE, "channels", "NUM")->setDefault(2);
+        parser.addArgument("--bp-size",
+                           "Rows and columns formed by the backprojection "
+                           "scenario", cli::STORE, "bpSize", "PIXELS")->
+                setDefault(256);
+        parser.addArgument("--scratch", "Directory for temporary files",
+                           cli::STORE, "scratch", "DIR")->setDefault(".");
+        parser.addArgument("-s --schema",
+                           "Specify a schema or directory of schemas.  "
+                           "Enables the validation scenario.",
+                           cli::STORE, "schema", "FILE");
+        parser.addArgument("-o --output", "JSON output file (default stdout)",
+                           cli::STORE, "output", "FILE");
+        parser.addArgument("input",
+                           "SICD/SIDD file or directory of them, e.g. "
+                           "croppedNitfs", cli::STORE, "input", "INPUT", 1, 1);
+
+        const std::auto_ptr<cli::Results>
+            options(parser.parse(argc, (const char**) argv));
+
+        Settings settings;
+        settings.dims.row = options->get<size_t>("rows");
+        settings.dims.col = options->get<size_t>("cols");
+        settings.window = options->get<size_t>("window");
+        settings.numWindows = std::max<size_t>(
+                options->get<size_t>("windows"), 1);
+        settings.iterations = std::max<size_t>(
+                options->get<size_t>("iterations"), 1);
+        settings.warmup = options->get<size_t>("warmup");
+        settings.numThreads = std::max<size_t>(
+                options->get<size_t>("threads"), 1);
+        settings.numPoints = std::max<size_t>(
+                options->get<size_t>("points"), 1);
+        settings.numCPHDChannels = std::max<size_t>(
+                options->get<size_t>("channels"), 1);
+        settings.backprojectionSize = std::max<size_t>(
+                options->get<size_t>("bpSize"), 1);
+        settings.scratchDir = options->get<std::string>("scratch");
+        if (options->hasValue("schema"))
+        {
+            settings.schemaPaths.push_back(
+                    options->get<std::string>("schema"));
+        }
+
+        const std::vector<std::string> pathnames =
+                getPathnames(options->get<std::string>("input"));
+        if (pathnames.empty())
+        {
+            throw except::Exception(Ctxt("No NITFs found in input"));
+        }
+
+        std::vector<Result> results;
+        {
+            Bench bench(settings);
+            bench.loadInputs(pathnames);
+            bench.run(results);
+        }
+
+        const std::string json = toJSON(results, settings);
+        if (options->hasValue("output"))
+        {
+            std::ofstream ofs(options->get<std::string>("output").c_str());
+            ofs << json;
+        }
+        else
+        {
+            std::cout << json;
+        }
+
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
@@ -36,6 +36,8 @@
 #include <scene/Types.h>
 #include <scene/Utilities.h>
 #include <scene/ProjectionModel.h>
+#include <scene/PolyFitSolver.h>
 #include <scene/ProjectionPolynomialFitter.h>
+#include <scene/PolyLatticeEvaluator.h>
 
 #endif
@@ -0,0 +1,127 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SCENE_POLY_FIT_SOLVER_H__
+#define __SCENE_POLY_FIT_SOLVER_H__
+
+#include <vector>
+
+#include <types/RowCol.h>
+#include <math/linear/Matrix2D.h>
+#include <math/poly/TwoD.h>
+
+namespace scene
+{
+/*!
+ * \class PolyFitSolver
+ * \brief Least squares fits 2D polynomials to values observed at a fixed
+ * set of sample locations
+ *
+ * This produces the same polynomials as math::poly::fit(), but the
+ * Vandermonde matrix of the sample locations is built and QR factored once
+ * in the constructor.  Each call to fit() then only costs a pass over the
+ * observations, so fitting several quantities observed at the same
+ * locations is much cheaper than calling math::poly::fit() for each one.
+ *
+ * As in math::poly::fit(), the sample locations are centered on their mean
+ * and scaled by their RMS before the matrix is built.  A polynomial of the
+ * same orders in scaled and shifted locations is still a polynomial in the
+ * normalized ones, so one factorization can also produce fits against any
+ * such affine transform of the locations.
+ */
+class PolyFitSolver
+{
+public:
+    /*!
+     * \param x Sample x locations
+     * \param y Sample y locations.  Must be the same size as x.
+     * \param orderX Order in x of the polynomials to fit
+     * \param orderY Order in y of the polynomials to fit
+     *
+     * \throw except::Exception if the sizes don't match, there are too few
+     * samples for the orders, or the samples don't determine a unique fit
+     */
+    PolyFitSolver(const math::linear::Matrix2D<double>& x,
+                  const math::linear::Matrix2D<double>& y,
+                  size_t orderX,
+                  size_t orderY);
+
+    size_t getOrderX() const
+    {
+        return mOrderX;
+    }
+
+    size_t getOrderY() const
+    {
+        return mOrderY;
+    }
+
+    /*!
+     * Fits a polynomial f such that f(x, y) = z
+     *
+     * \param z Observed values, the same size as x and y
+     *
+     * \return The fitted polynomial
+     */
+    math::poly::TwoD<double> fit(const math::linear::Matrix2D<double>& z) const
+    {
+        return fit(z, types::RowCol<double>(1.0, 1.0),
+                   types::RowCol<double>(0.0, 0.0));
+    }
+
+    /*!
+     * Fits a polynomial f such that
+     * f(x * scale.row + offset.row, y * scale.col + offset.col) = z
+     * This is the same as calling math::poly::fit() with the transformed
+     * locations, but reuses this factorization.
+     *
+     * \param z Observed values, the same size as x and y
+     * \param scale Non-zero scale applied to the x and y locations
+     * \param offset Offset applied to the x and y locations after scaling
+     *
+     * \return The fitted polynomial
+     */
+    math::poly::TwoD<double> fit(const math::linear::Matrix2D<double>& z,
+                                 const types::RowCol<double>& scale,
+                                 const types::RowCol<double>& offset) const;
+
+private:
+    const size_t mOrderX;
+    const size_t mOrderY;
+    const size_t mNumRows;
+    const size_t mNumCols;
+    const size_t mNumSamples;
+    const size_t mNumCoeffs;
+
+    // Mean and reciprocal RMS of the sample locations
+    types::RowCol<double> mMean;
+    types::RowCol<double> mScale;
+
+    // Householder QR factorization of the normalized Vandermonde matrix,
+    // stored column-major.  Below the diagonal are the Householder vectors
+    // (which start with an implicit 1), and mR holds the diagonal of R.
+    std::vector<double> mQR;
+    std::vector<double> mR;
+    std::vector<double> mBeta;
+};
+}
+
+#endif
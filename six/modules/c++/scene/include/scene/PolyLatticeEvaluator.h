@@ -0,0 +1,283 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SCENE_POLY_LATTICE_EVALUATOR_H__
+#define __SCENE_POLY_LATTICE_EVALUATOR_H__
+
+#include <vector>
+#include <memory>
+
+#include <sys/Runnable.h>
+#include <except/Exception.h>
+#include <types/RowCol.h>
+#include <math/poly/OneD.h>
+#include <math/poly/TwoD.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+
+namespace scene
+{
+/*!
+ * \class PolyLatticeEvaluator
+ * \brief Evaluates a 2D polynomial over a regular row/col lattice
+ *
+ * The lattice is defined by a start point, a spacing, and a number of
+ * samples in each direction, so sample (ii, jj) is located at
+ * (start.row + ii * spacing.row, start.col + jj * spacing.col).  As with
+ * math::poly::TwoD, the row corresponds to X and the col to Y.
+ *
+ * Rather than expanding every point independently, each lattice row first
+ * collapses the polynomial to a 1D polynomial in col (via Horner's method in
+ * X), and then evaluates that 1D polynomial across the whole row with
+ * Horner's method in Y.  The inner loop runs over contiguous columns so the
+ * compiler can vectorize it.  Note that forward differencing is
+ * intentionally not used as its error grows with the number of columns.
+ */
+template <typename T>
+class PolyLatticeEvaluator
+{
+public:
+    /*!
+     * \param poly Polynomial to evaluate
+     * \param start Location of sample (0, 0) in the polynomial's units
+     * \param spacing Distance between adjacent samples in the polynomial's
+     * units
+     * \param dims Number of lattice samples in each direction
+     */
+    PolyLatticeEvaluator(const math::poly::TwoD<T>& poly,
+                         const types::RowCol<double>& start,
+                         const types::RowCol<double>& spacing,
+                         const types::RowCol<size_t>& dims) :
+        mOrderX(poly.orderX()),
+        mOrderY(poly.orderY()),
+        mStart(start),
+        mSpacing(spacing),
+        mDims(dims),
+        mCoeffs((mOrderX + 1) * (mOrderY + 1)),
+        mColValues(dims.col)
+    {
+        for (size_t ii = 0; ii <= mOrderX; ++ii)
+        {
+            const math::poly::OneD<T> polyY(poly[ii]);
+            for (size_t jj = 0; jj <= mOrderY; ++jj)
+            {
+                mCoeffs[ii * (mOrderY + 1) + jj] = polyY[jj];
+            }
+        }
+
+        for (size_t col = 0; col < mDims.col; ++col)
+        {
+            mColValues[col] = mStart.col + col * mSpacing.col;
+        }
+    }
+
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
+    /*!
+     * Evaluates the lattice rows [startRow, startRow + numRows).  This lets
+     * callers process the lattice in strips.
+     *
+     * \param startRow First lattice row to evaluate
+     * \param numRows Number of lattice rows to evaluate
+     * \param output [output] Row-major numRows x getDims().col buffer
+     */
+    void evaluateRows(size_t startRow, size_t numRows, T* output) const
+    {
+        if (startRow + numRows > mDims.row)
+        {
+            throw except::Exception(Ctxt(
+                    "Requested rows extend past the lattice"));
+        }
+
+        std::vector<T> colCoeffs(mOrderY + 1);
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            const double rowValue =
+                    mStart.row + (startRow + row) * mSpacing.row;
+
+            // Collapse the X dimension via Horner's method in X
+            for (size_t jj = 0; jj <= mOrderY; ++jj)
+            {
+                T value(mCoeffs[mOrderX * (mOrderY + 1) + jj]);
+                for (size_t ii = mOrderX; ii > 0; --ii)
+                {
+                    value = value * rowValue +
+                            mCoeffs[(ii - 1) * (mOrderY + 1) + jj];
+                }
+                colCoeffs[jj] = value;
+            }
+
+            // Now Horner's method in Y across the whole row
+            T* const rowOutput = output + row * mDims.col;
+            const double* const colValues = &mColValues[0];
+            const T highest(colCoeffs[mOrderY]);
+            for (size_t col = 0; col < mDims.col; ++col)
+            {
+                rowOutput[col] = highest;
+            }
+            for (size_t jj = mOrderY; jj > 0; --jj)
+            {
+                const T coeff(colCoeffs[jj - 1]);
+                for (size_t col = 0; col < mDims.col; ++col)
+                {
+                    rowOutput[col] = rowOutput[col] * colValues[col] + coeff;
+                }
+            }
+        }
+    }
+
+    /*!
+     * Evaluates the entire lattice
+     *
+     * \param output [output] Row-major getDims().row x getDims().col buffer
+     * \param numThreads Number of threads to use.  Rows are divided evenly
+     * among threads.
+     */
+    void evaluate(T* output, size_t numThreads = 1) const
+    {
+        if (numThreads <= 1)
+        {
+            evaluateRows(0, mDims.row, output);
+        }
+        else
+        {
+            mt::ThreadGroup threads;
+            const mt::ThreadPlanner planner(mDims.row, numThreads);
+
+            size_t threadNum(0);
+            size_t startRow(0);
+            size_t numRowsThisThread(0);
+            while (planner.getThreadInfo(threadNum++,
+                                         startRow,
+                                         numRowsThisThread))
+            {
+                std::auto_ptr<sys::Runnable> runnable(new EvaluateRunnable(
+                        *this,
+                        startRow,
+                        numRowsThisThread,
+                        output + startRow * mDims.col));
+                threads.createThread(runnable);
+            }
+
+            threads.joinAll();
+        }
+    }
+
+private:
+    class EvaluateRunnable : public sys::Runnable
+    {
+    public:
+        EvaluateRunnable(const PolyLatticeEvaluator& evaluator,
+                         size_t startRow,
+                         size_t numRows,
+                         T* output) :
+            mEvaluator(evaluator),
+            mStartRow(startRow),
+            mNumRows(numRows),
+            mOutput(output)
+        {
+        }
+
+        virtual void run()
+        {
+            mEvaluator.evaluateRows(mStartRow, mNumRows, mOutput);
+        }
+
+    private:
+        const PolyLatticeEvaluator& mEvaluator;
+        const size_t mStartRow;
+        const size_t mNumRows;
+        T* const mOutput;
+    };
+
+private:
+    const size_t mOrderX;
+    const size_t mOrderY;
+    const types::RowCol<double> mStart;
+    const types::RowCol<double> mSpacing;
+    const types::RowCol<size_t> mDims;
+    std::vector<T> mCoeffs;
+    std::vector<double> mColValues;
+};
+
+/*!
+ * Evaluates 'poly' over a regular lattice.  See PolyLatticeEvaluator.
+ *
+ * \param poly Polynomial to evaluate
+ * \param start Location of sample (0, 0) in the polynomial's units
+ * \param spacing Distance between adjacent samples
+ * \param dims Number of lattice samples in each direction
+ * \param output [output] Row-major dims.row x dims.col buffer
+ * \param numThreads Number of threads to use
+ */
+template <typename T>
+void evaluateLattice(const math::poly::TwoD<T>& poly,
+                     const types::RowCol<double>& start,
+                     const types::RowCol<double>& spacing,
+                     const types::RowCol<size_t>& dims,
+                     T* output,
+                     size_t numThreads = 1)
+{
+    PolyLatticeEvaluator<T>(poly, start, spacing, dims).evaluate(output,
+                                                                 numThreads);
+}
+
+/*!
+ * Evaluates 'poly' at start + ii * spacing for ii in [0, numSamples).  This
+ * handles both scalar polynomials and vector-valued ones such as PolyXYZ.
+ *
+ * \param poly Polynomial to evaluate
+ * \param start Location of the first sample
+ * \param spacing Distance between adjacent samples
+ * \param numSamples Number of samples
+ * \param output [output] Buffer of numSamples values
+ */
+template <typename T>
+void evaluateLattice(const math::poly::OneD<T>& poly,
+                     double start,
+                     double spacing,
+                     size_t numSamples,
+                     T* output)
+{
+    const size_t order = poly.order();
+
+    std::vector<double> values(numSamples);
+    for (size_t ii = 0; ii < numSamples; ++ii)
+    {
+        values[ii] = start + ii * spacing;
+        output[ii] = poly[order];
+    }
+
+    for (size_t jj = order; jj > 0; --jj)
+    {
+        const T coeff(poly[jj - 1]);
+        for (size_t ii = 0; ii < numSamples; ++ii)
+        {
+            output[ii] = output[ii] * values[ii] + coeff;
+        }
+    }
+}
+}
+
+#endif
@@ -22,8 +22,14 @@
 #ifndef __SCENE_PROJECTION_POLYNOMIAL_FITTER_H__
 #define __SCENE_PROJECTION_POLYNOMIAL_FITTER_H__
 
+#include <map>
+#include <utility>
+
 #include <math/poly/Fit.h>
+#include <mem/SharedPtr.h>
+#include <sys/Mutex.h>
 #include <scene/GridECEFTransform.h>
+#include <scene/PolyFitSolver.h>
 #include <scene/ProjectionModel.h>
 #include <math/linear/Matrix2D.h>
 
@@ -34,6 +40,12 @@ namespace scene
  * \brief Used to fit output --> slant and/or time COA polynomials based on
  * sampling sceneToImage() across the output plane
  * versa
+ *
+ * The least squares factorization for each set of sample locations and
+ * polynomial orders is computed the first time it's needed and then shared
+ * by every fit that uses them.  For example, fitting the output --> slant
+ * row and col polynomials and then a time COA polynomial of the same orders
+ * only factors the output plane samples once.
  */
 class ProjectionPolynomialFitter
 {
@@ -55,13 +67,50 @@ public:
      * \param outExtent Output extent in pixels
      * \param numPoints1D Number of points to use in each direction when
      * sampling the grid.  Defaults to 10.
+     * \param numThreads Number of threads to sample the grid with.  Rows of
+     * the grid are divided evenly among threads.
+     */
+    ProjectionPolynomialFitter(
+            const ProjectionModel& projModel,
+            const GridECEFTransform& gridTransform,
+            const types::RowCol<double>& outPixelStart,
+            const types::RowCol<size_t>& outExtent,
+            size_t numPoints1D = DEFAULTS_POINTS_1D,
+            size_t numThreads = 1);
+
+    /* Same as above, but picks the number of points to sample rather than
+     * taking it as a parameter.  Starting from DEFAULTS_POINTS_1D points in
+     * each direction, the grid is repeatedly refined by sampling halfway
+     * between the existing points.  Each time, the scene coordinates are
+     * fit with polynomials of the given order over the coarser grid, and
+     * refinement stops once those polynomials predict the samples of the
+     * finer grid to within residualTolerance.
+     *
+     * \param polyOrderX Order in x of the polynomials that will be fit
+     * \param polyOrderY Order in y of the polynomials that will be fit
+     * \param residualTolerance Largest acceptable mean residual error
+     * (mean of the squares of the differences) in each of the scene
+     * coordinates, in square meters in the slant plane
+     * \param maxPoints1D Most points to sample in each direction.  The grid
+     * stops being refined once it reaches this, whether or not the
+     * tolerance has been met.
      */
     ProjectionPolynomialFitter(
             const ProjectionModel& projModel,
             const GridECEFTransform& gridTransform,
             const types::RowCol<double>& outPixelStart,
             const types::RowCol<size_t>& outExtent,
-            size_t numPoints1D = DEFAULTS_POINTS_1D);
+            size_t polyOrderX,
+            size_t polyOrderY,
+            double residualTolerance,
+            size_t maxPoints1D,
+            size_t numThreads = 1);
+
+    // Returns the number of points sampled in each direction
+    size_t getNumPoints1D() const
+    {
+        return mNumPoints1D;
+    }
 
     // Returns the output plane rows used during sampling in case you want to
     // do your own polynomial fitting
@@ -291,6 +340,37 @@ public:
     }
 
 private:
+    typedef std::map<std::pair<size_t, size_t>,
+                     mem::SharedPtr<const PolyFitSolver> > SolverMap;
+
+    // Factorizations keyed by polynomial order.  Copies of a fitter have
+    // the same samples, so they share this.
+    struct SolverCache
+    {
+        sys::Mutex mutex;
+        SolverMap outputPlane;
+        SolverMap scene;
+    };
+
+    // Samples a numPoints1D x numPoints1D grid.  If keepEvenSamples is set,
+    // the current grid is assumed to be every other point of the new one
+    // and isn't sampled again.
+    void sampleGrid(const ProjectionModel& projModel,
+                    const GridECEFTransform& gridTransform,
+                    const types::RowCol<double>& outPixelStart,
+                    const types::RowCol<size_t>& outExtent,
+                    size_t numPoints1D,
+                    size_t numThreads,
+                    bool keepEvenSamples);
+
+    // Solver for fits over the output plane samples
+    const PolyFitSolver& getOutputPlaneSolver(size_t polyOrderX,
+                                              size_t polyOrderY) const;
+
+    // Solver for fits over the scene coordinates
+    const PolyFitSolver& getSceneSolver(size_t polyOrderX,
+                                        size_t polyOrderY) const;
+
     void getSlantPlaneSamples(
             const types::RowCol<size_t>& inPixelStart,
             const types::RowCol<double>& inSceneCenter,
@@ -300,11 +380,17 @@ private:
             math::linear::Matrix2D<double>& slantPlaneCols) const;
 
 private:
-    const size_t mNumPoints1D;
+    size_t mNumPoints1D;
+
+    // Spacing in pixels between output plane samples.  The samples form a
+    // regular lattice starting at (0, 0) with this spacing.
+    types::RowCol<double> mSampleSpacing;
     math::linear::Matrix2D<double> mOutputPlaneRows;
     math::linear::Matrix2D<double> mOutputPlaneCols;
     math::linear::Matrix2D<types::RowCol<double> > mSceneCoordinates;
     math::linear::Matrix2D<double> mTimeCOA;
+
+    mem::SharedPtr<SolverCache> mSolvers;
 };
 }
 
@@ -0,0 +1,248 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <scene/PolyFitSolver.h>
+
+namespace
+{
+// Returns the reciprocal RMS of the values about their mean.  If the values
+// are all equal, there's nothing to scale and a constant fit is all they
+// can support.
+double getReciprocalRMS(const double* values,
+                        size_t numValues,
+                        double mean,
+                        size_t order)
+{
+    double sumSq(0.0);
+    for (size_t ii = 0; ii < numValues; ++ii)
+    {
+        const double diff = values[ii] - mean;
+        sumSq += diff * diff;
+    }
+
+    if (sumSq == 0.0)
+    {
+        if (order > 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Sample locations must vary to fit a non-constant "
+                    "polynomial"));
+        }
+        return 1.0;
+    }
+    return 1.0 / std::sqrt(sumSq / numValues);
+}
+
+double getMean(const double* values, size_t numValues)
+{
+    double sum(0.0);
+    for (size_t ii = 0; ii < numValues; ++ii)
+    {
+        sum += values[ii];
+    }
+    return sum / numValues;
+}
+}
+
+namespace scene
+{
+PolyFitSolver::PolyFitSolver(const math::linear::Matrix2D<double>& x,
+                             const math::linear::Matrix2D<double>& y,
+                             size_t orderX,
+                             size_t orderY) :
+    mOrderX(orderX),
+    mOrderY(orderY),
+    mNumRows(x.rows()),
+    mNumCols(x.cols()),
+    mNumSamples(x.size()),
+    mNumCoeffs((orderX + 1) * (orderY + 1)),
+    mR(mNumCoeffs),
+    mBeta(mNumCoeffs)
+{
+    if (y.rows() != mNumRows || y.cols() != mNumCols)
+    {
+        throw except::Exception(Ctxt("Matrices must be equally sized"));
+    }
+
+    if (mNumSamples < mNumCoeffs)
+    {
+        std::ostringstream ostr;
+        ostr << "Not enough points for a unique fit solution ("
+             << mNumSamples << " points for a " << mNumCoeffs
+             << "-coefficient fit)!";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    mMean.row = getMean(x.get(), mNumSamples);
+    mMean.col = getMean(y.get(), mNumSamples);
+    mScale.row = getReciprocalRMS(x.get(), mNumSamples, mMean.row, orderX);
+    mScale.col = getReciprocalRMS(y.get(), mNumSamples, mMean.col, orderY);
+
+    // Build the Vandermonde matrix column-major so that the factorization
+    // below works down contiguous columns.  Column k * (orderY + 1) + l
+    // holds x^k * y^l, matching math::poly::fit().
+    mQR.resize(mNumSamples * mNumCoeffs);
+    for (size_t sample = 0; sample < mNumSamples; ++sample)
+    {
+        const double xx = (x.get()[sample] - mMean.row) * mScale.row;
+        const double yy = (y.get()[sample] - mMean.col) * mScale.col;
+
+        double xPower(1.0);
+        for (size_t kk = 0, coeff = 0; kk <= orderX; ++kk)
+        {
+            double power(xPower);
+            for (size_t ll = 0; ll <= orderY; ++ll, ++coeff)
+            {
+                mQR[coeff * mNumSamples + sample] = power;
+                power *= yy;
+            }
+            xPower *= xx;
+        }
+    }
+
+    // Householder QR
+    for (size_t kk = 0; kk < mNumCoeffs; ++kk)
+    {
+        double* const column = &mQR[kk * mNumSamples];
+
+        double normSq(0.0);
+        for (size_t ii = kk; ii < mNumSamples; ++ii)
+        {
+            normSq += column[ii] * column[ii];
+        }
+
+        // The normalized columns all have norms on the order of
+        // sqrt(mNumSamples), so anything this small has lost all of its
+        // independent information
+        const double norm = std::sqrt(normSq);
+        if (norm <= 1e-10 * std::sqrt(static_cast<double>(mNumSamples)))
+        {
+            throw except::Exception(Ctxt(
+                    "Sample locations don't determine a unique fit"));
+        }
+
+        const double alpha = (column[kk] > 0.0) ? -norm : norm;
+        const double pivot = column[kk] - alpha;
+        for (size_t ii = kk + 1; ii < mNumSamples; ++ii)
+        {
+            column[ii] /= pivot;
+        }
+        mR[kk] = alpha;
+        mBeta[kk] = -pivot / alpha;
+
+        for (size_t jj = kk + 1; jj < mNumCoeffs; ++jj)
+        {
+            double* const other = &mQR[jj * mNumSamples];
+            double dot(other[kk]);
+            for (size_t ii = kk + 1; ii < mNumSamples; ++ii)
+            {
+                dot += column[ii] * other[ii];
+            }
+            dot *= mBeta[kk];
+
+            other[kk] -= dot;
+            for (size_t ii = kk + 1; ii < mNumSamples; ++ii)
+            {
+                other[ii] -= dot * column[ii];
+            }
+        }
+    }
+}
+
+math::poly::TwoD<double>
+PolyFitSolver::fit(const math::linear::Matrix2D<double>& z,
+                   const types::RowCol<double>& scale,
+                   const types::RowCol<double>& offset) const
+{
+    if (z.rows() != mNumRows || z.cols() != mNumCols)
+    {
+        throw except::Exception(Ctxt("Matrices must be equally sized"));
+    }
+    if (scale.row == 0.0 || scale.col == 0.0)
+    {
+        throw except::Exception(Ctxt("Scale must be non-zero"));
+    }
+
+    // Apply Q^T to the observations
+    std::vector<double> rhs(z.get(), z.get() + mNumSamples);
+    for (size_t kk = 0; kk < mNumCoeffs; ++kk)
+    {
+        const double* const column = &mQR[kk * mNumSamples];
+        double dot(rhs[kk]);
+        for (size_t ii = kk + 1; ii < mNumSamples; ++ii)
+        {
+            dot += column[ii] * rhs[ii];
+        }
+        dot *= mBeta[kk];
+
+        rhs[kk] -= dot;
+        for (size_t ii = kk + 1; ii < mNumSamples; ++ii)
+        {
+            rhs[ii] -= dot * column[ii];
+        }
+    }
+
+    // Then back substitute through R
+    std::vector<double> coeffs(mNumCoeffs);
+    for (size_t kk = mNumCoeffs; kk > 0; --kk)
+    {
+        const size_t row = kk - 1;
+        double value(rhs[row]);
+        for (size_t jj = kk; jj < mNumCoeffs; ++jj)
+        {
+            value -= mQR[jj * mNumSamples + row] * coeffs[jj];
+        }
+        coeffs[row] = value / mR[row];
+    }
+
+    // The coefficients are in terms of the normalized locations.  Undo the
+    // scaling, taking the caller's scale into account...
+    const types::RowCol<double> normScale(mScale.row / scale.row,
+                                          mScale.col / scale.col);
+    math::poly::TwoD<double> poly(mOrderX, mOrderY);
+    double xPower(1.0);
+    for (size_t ii = 0, coeff = 0; ii <= mOrderX; ++ii)
+    {
+        double power(xPower);
+        for (size_t jj = 0; jj <= mOrderY; ++jj, ++coeff)
+        {
+            poly[ii][jj] = coeffs[coeff] * power;
+            power *= normScale.col;
+        }
+        xPower *= normScale.row;
+    }
+
+    // ...and then shift back to where the transformed mean is
+    math::poly::TwoD<double> xShift(1, 1);
+    math::poly::TwoD<double> yShift(1, 1);
+    xShift[0][0] = -(mMean.row * scale.row + offset.row);
+    xShift[1][0] = 1;
+    yShift[0][0] = -(mMean.col * scale.col + offset.col);
+    yShift[0][1] = 1;
+
+    return poly.transformInput(xShift, yShift);
+}
+}
@@ -20,26 +20,164 @@
  *
  */
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <sys/Runnable.h>
 #include <scene/ProjectionPolynomialFitter.h>
+#include <scene/PolyLatticeEvaluator.h>
 
 namespace
 {
-class Shift
+// What a thread needs to sample a strip of the output grid
+struct SampleContext
+{
+    SampleContext(const scene::ProjectionModel& projModel,
+                  const scene::GridECEFTransform& gridTransform,
+                  const types::RowCol<double>& outPixelStart,
+                  const types::RowCol<double>& sampleSpacing,
+                  bool keepEvenSamples,
+                  math::linear::Matrix2D<double>& outputPlaneRows,
+                  math::linear::Matrix2D<double>& outputPlaneCols,
+                  math::linear::Matrix2D<types::RowCol<double> >&
+                          sceneCoordinates,
+                  math::linear::Matrix2D<double>& timeCOA) :
+        projModel(projModel),
+        gridTransform(gridTransform),
+        outPixelStart(outPixelStart),
+        sampleSpacing(sampleSpacing),
+        keepEvenSamples(keepEvenSamples),
+        outputPlaneRows(outputPlaneRows),
+        outputPlaneCols(outputPlaneCols),
+        sceneCoordinates(sceneCoordinates),
+        timeCOA(timeCOA)
+    {
+    }
+
+    const scene::ProjectionModel& projModel;
+    const scene::GridECEFTransform& gridTransform;
+    const types::RowCol<double> outPixelStart;
+    const types::RowCol<double> sampleSpacing;
+    const bool keepEvenSamples;
+    math::linear::Matrix2D<double>& outputPlaneRows;
+    math::linear::Matrix2D<double>& outputPlaneCols;
+    math::linear::Matrix2D<types::RowCol<double> >& sceneCoordinates;
+    math::linear::Matrix2D<double>& timeCOA;
+};
+
+void sampleRows(const SampleContext& context, size_t startRow, size_t numRows)
+{
+    const size_t numCols = context.outputPlaneRows.cols();
+    for (size_t ii = startRow; ii < startRow + numRows; ++ii)
+    {
+        for (size_t jj = 0; jj < numCols; ++jj)
+        {
+            if (context.keepEvenSamples && ii % 2 == 0 && jj % 2 == 0)
+            {
+                continue;
+            }
+
+            // We want (outPixelStart.row, outPixelStart.col) to correspond
+            // to (0, 0) in our grid.  In the case of multi-segment SICDs,
+            // we'll only sample our part of the global output grid.
+            const types::RowCol<double> offset(
+                    ii * context.sampleSpacing.row,
+                    jj * context.sampleSpacing.col);
+            context.outputPlaneRows(ii, jj) = offset.row;
+            context.outputPlaneCols(ii, jj) = offset.col;
+
+            // Find ECEF location of this output plane pixel
+            const scene::Vector3 sPos = context.gridTransform.rowColToECEF(
+                    context.outPixelStart + offset);
+
+            // Call sceneToImage() to get meters from the slant plane SCP
+            double timeCOA(0.0);
+            context.sceneCoordinates(ii, jj) =
+                    context.projModel.sceneToImage(sPos, &timeCOA);
+            context.timeCOA(ii, jj) = timeCOA;
+        }
+    }
+}
+
+class SampleRunnable : public sys::Runnable
 {
 public:
-    Shift(double shift) :
-        mShift(shift)
+    SampleRunnable(const SampleContext& context,
+                   size_t startRow,
+                   size_t numRows) :
+        mContext(context),
+        mStartRow(startRow),
+        mNumRows(numRows)
     {
     }
 
-    inline double operator()(double input) const
+    virtual void run()
     {
-        return (input - mShift);
+        sampleRows(mContext, mStartRow, mNumRows);
     }
 
 private:
-    const double mShift;
+    const SampleContext& mContext;
+    const size_t mStartRow;
+    const size_t mNumRows;
 };
+
+void splitSceneCoordinates(
+        const math::linear::Matrix2D<types::RowCol<double> >& coordinates,
+        math::linear::Matrix2D<double>& rows,
+        math::linear::Matrix2D<double>& cols)
+{
+    rows = math::linear::Matrix2D<double>(coordinates.rows(),
+                                          coordinates.cols());
+    cols = math::linear::Matrix2D<double>(coordinates.rows(),
+                                          coordinates.cols());
+    for (size_t ii = 0; ii < coordinates.rows(); ++ii)
+    {
+        for (size_t jj = 0; jj < coordinates.cols(); ++jj)
+        {
+            rows(ii, jj) = coordinates(ii, jj).row;
+            cols(ii, jj) = coordinates(ii, jj).col;
+        }
+    }
+}
+
+double getMeanResidualError(const math::linear::Matrix2D<double>& values,
+                            const std::vector<double>& fitValues)
+{
+    double errorSum(0.0);
+    for (size_t ii = 0; ii < fitValues.size(); ++ii)
+    {
+        const double diff = values.get()[ii] - fitValues[ii];
+        errorSum += diff * diff;
+    }
+    return errorSum / fitValues.size();
+}
+
+const scene::PolyFitSolver& getSolver(
+        sys::Mutex& mutex,
+        std::map<std::pair<size_t, size_t>,
+                 mem::SharedPtr<const scene::PolyFitSolver> >& solvers,
+        const math::linear::Matrix2D<double>& x,
+        const math::linear::Matrix2D<double>& y,
+        size_t polyOrderX,
+        size_t polyOrderY)
+{
+    // The lock is held while factoring so that the same one isn't computed
+    // twice.  Entries are never removed, so the reference stays good.
+    mt::CriticalSection<sys::Mutex> lock(&mutex);
+    mem::SharedPtr<const scene::PolyFitSolver>& solver =
+            solvers[std::make_pair(polyOrderX, polyOrderY)];
+    if (!solver.get())
+    {
+        solver.reset(new scene::PolyFitSolver(x, y, polyOrderX, polyOrderY));
+    }
+    return *solver;
+}
 }
 
 namespace scene
@@ -51,55 +189,164 @@ ProjectionPolynomialFitter::ProjectionPolynomialFitter(
         const GridECEFTransform& gridTransform,
         const types::RowCol<double>& outPixelStart,
         const types::RowCol<size_t>& outExtent,
-        size_t numPoints1D) :
-    mNumPoints1D(numPoints1D),
-    mOutputPlaneRows(numPoints1D, numPoints1D),
-    mOutputPlaneCols(numPoints1D, numPoints1D),
-    mSceneCoordinates(numPoints1D,
-                      numPoints1D,
-                      types::RowCol<double>(0.0, 0.0)),
-    mTimeCOA(numPoints1D, numPoints1D)
+        size_t numPoints1D,
+        size_t numThreads) :
+    mNumPoints1D(0),
+    mSolvers(new SolverCache())
+{
+    sampleGrid(projModel, gridTransform, outPixelStart, outExtent,
+               numPoints1D, numThreads, false);
+}
+
+ProjectionPolynomialFitter::ProjectionPolynomialFitter(
+        const ProjectionModel& projModel,
+        const GridECEFTransform& gridTransform,
+        const types::RowCol<double>& outPixelStart,
+        const types::RowCol<size_t>& outExtent,
+        size_t polyOrderX,
+        size_t polyOrderY,
+        double residualTolerance,
+        size_t maxPoints1D,
+        size_t numThreads) :
+    mNumPoints1D(0),
+    mSolvers(new SolverCache())
 {
-    // Want to sample [outPixelStart, outPixelStart + outExtent) in the loop
-    // below.  That is, we are marching through the portion of interest of the
-    // output grid in pixel space.  In the case of multi-segment SICDs, we'll
-    // only sample our part of the grid defined by outPixelStart and
-    // outExtent.
-    const types::RowCol<double> skip(
-        static_cast<double>(outExtent.row - 1) / (mNumPoints1D - 1),
-        static_cast<double>(outExtent.col - 1) / (mNumPoints1D - 1));
-
-    types::RowCol<double> currentOffset(outPixelStart);
-
-    for (size_t ii = 0;
-         ii < mNumPoints1D;
-         ++ii, currentOffset.row += skip.row)
+    if (maxPoints1D < 2)
     {
-        currentOffset.col = outPixelStart.col;
+        throw except::Exception(Ctxt(
+                "Need at least two points in each direction"));
+    }
+
+    sampleGrid(projModel, gridTransform, outPixelStart, outExtent,
+               std::min(DEFAULTS_POINTS_1D, maxPoints1D), numThreads, false);
 
-        for (size_t jj = 0;
-             jj < mNumPoints1D;
-             ++jj, currentOffset.col += skip.col)
+    while (mNumPoints1D < maxPoints1D)
+    {
+        // Fit the scene coordinates over the current grid...
+        math::linear::Matrix2D<double> sceneRows;
+        math::linear::Matrix2D<double> sceneCols;
+        splitSceneCoordinates(mSceneCoordinates, sceneRows, sceneCols);
+        const PolyFitSolver solver(mOutputPlaneRows, mOutputPlaneCols,
+                                   polyOrderX, polyOrderY);
+        const math::poly::TwoD<double> rowPoly(solver.fit(sceneRows));
+        const math::poly::TwoD<double> colPoly(solver.fit(sceneCols));
+
+        // ...refine it, reusing the current samples if they're part of the
+        // finer grid...
+        const size_t numPoints1D =
+                std::min(mNumPoints1D * 2 - 1, maxPoints1D);
+        sampleGrid(projModel, gridTransform, outPixelStart, outExtent,
+                   numPoints1D, numThreads,
+                   numPoints1D == mNumPoints1D * 2 - 1);
+
+        // ...and see how well the coarse fit predicts the finer samples
+        splitSceneCoordinates(mSceneCoordinates, sceneRows, sceneCols);
+        const types::RowCol<size_t> dims(mNumPoints1D, mNumPoints1D);
+        const types::RowCol<double> start(0.0, 0.0);
+        std::vector<double> fitRows(dims.area());
+        std::vector<double> fitCols(dims.area());
+        evaluateLattice(rowPoly, start, mSampleSpacing, dims, &fitRows[0]);
+        evaluateLattice(colPoly, start, mSampleSpacing, dims, &fitCols[0]);
+
+        if (getMeanResidualError(sceneRows, fitRows) <= residualTolerance &&
+            getMeanResidualError(sceneCols, fitCols) <= residualTolerance)
         {
-            // currentOffset refers to the spot in the global output grid, so
-            // we want to offset by outPixelStart so that we are in units of
-            // pixels in terms of our portion of this output grid
-            // That is, we want (outPixelStart.row, outPixelStart.col) to
-            // correspond to (0, 0) in our grid.
-            mOutputPlaneRows(ii, jj) = currentOffset.row - outPixelStart.row;
-            mOutputPlaneCols(ii, jj) = currentOffset.col - outPixelStart.col;
+            break;
+        }
+    }
+}
 
-            // Find ECEF location of this output plane pixel
-            const scene::Vector3 sPos =
-                    gridTransform.rowColToECEF(currentOffset);
+void ProjectionPolynomialFitter::sampleGrid(
+        const ProjectionModel& projModel,
+        const GridECEFTransform& gridTransform,
+        const types::RowCol<double>& outPixelStart,
+        const types::RowCol<size_t>& outExtent,
+        size_t numPoints1D,
+        size_t numThreads,
+        bool keepEvenSamples)
+{
+    // Want to sample [outPixelStart, outPixelStart + outExtent).  That is,
+    // we are marching through the portion of interest of the output grid in
+    // pixel space.
+    const types::RowCol<double> sampleSpacing(
+        static_cast<double>(outExtent.row - 1) / (numPoints1D - 1),
+        static_cast<double>(outExtent.col - 1) / (numPoints1D - 1));
+
+    math::linear::Matrix2D<double> outputPlaneRows(numPoints1D, numPoints1D);
+    math::linear::Matrix2D<double> outputPlaneCols(numPoints1D, numPoints1D);
+    math::linear::Matrix2D<types::RowCol<double> > sceneCoordinates(
+            numPoints1D, numPoints1D, types::RowCol<double>(0.0, 0.0));
+    math::linear::Matrix2D<double> timeCOA(numPoints1D, numPoints1D);
+
+    if (keepEvenSamples)
+    {
+        for (size_t ii = 0; ii < mNumPoints1D; ++ii)
+        {
+            for (size_t jj = 0; jj < mNumPoints1D; ++jj)
+            {
+                outputPlaneRows(ii * 2, jj * 2) = mOutputPlaneRows(ii, jj);
+                outputPlaneCols(ii * 2, jj * 2) = mOutputPlaneCols(ii, jj);
+                sceneCoordinates(ii * 2, jj * 2) = mSceneCoordinates(ii, jj);
+                timeCOA(ii * 2, jj * 2) = mTimeCOA(ii, jj);
+            }
+        }
+    }
 
-            // Call sceneToImage() to get meters from the slant plane SCP
-            double timeCOA(0.0);
-            mSceneCoordinates(ii, jj) =
-                    projModel.sceneToImage(sPos, &timeCOA);
-            mTimeCOA(ii, jj) = timeCOA;
+    const SampleContext context(projModel, gridTransform, outPixelStart,
+                                sampleSpacing, keepEvenSamples,
+                                outputPlaneRows, outputPlaneCols,
+                                sceneCoordinates, timeCOA);
+    numThreads = std::min(numThreads, numPoints1D);
+    if (numThreads <= 1)
+    {
+        sampleRows(context, 0, numPoints1D);
+    }
+    else
+    {
+        mt::ThreadGroup threads;
+        const mt::ThreadPlanner planner(numPoints1D, numThreads);
+
+        size_t threadNum(0);
+        size_t startRow(0);
+        size_t numRowsThisThread(0);
+        while (planner.getThreadInfo(threadNum++,
+                                     startRow,
+                                     numRowsThisThread))
+        {
+            std::auto_ptr<sys::Runnable> runnable(new SampleRunnable(
+                    context, startRow, numRowsThisThread));
+            threads.createThread(runnable);
         }
+
+        threads.joinAll();
     }
+
+    mNumPoints1D = numPoints1D;
+    mSampleSpacing = sampleSpacing;
+    mOutputPlaneRows = outputPlaneRows;
+    mOutputPlaneCols = outputPlaneCols;
+    mSceneCoordinates = sceneCoordinates;
+    mTimeCOA = timeCOA;
+}
+
+const PolyFitSolver& ProjectionPolynomialFitter::getOutputPlaneSolver(
+        size_t polyOrderX,
+        size_t polyOrderY) const
+{
+    return getSolver(mSolvers->mutex, mSolvers->outputPlane,
+                     mOutputPlaneRows, mOutputPlaneCols,
+                     polyOrderX, polyOrderY);
+}
+
+const PolyFitSolver& ProjectionPolynomialFitter::getSceneSolver(
+        size_t polyOrderX,
+        size_t polyOrderY) const
+{
+    math::linear::Matrix2D<double> sceneRows;
+    math::linear::Matrix2D<double> sceneCols;
+    splitSceneCoordinates(mSceneCoordinates, sceneRows, sceneCols);
+    return getSolver(mSolvers->mutex, mSolvers->scene, sceneRows, sceneCols,
+                     polyOrderX, polyOrderY);
 }
 
 void ProjectionPolynomialFitter::getSlantPlaneSamples(
@@ -160,34 +407,35 @@ void ProjectionPolynomialFitter::fitOutputToSlantPolynomials(
                          slantPlaneCols);
 
     // Now fit the polynomials
-    outputToSlantRow = math::poly::fit(mOutputPlaneRows,
-                                       mOutputPlaneCols,
-                                       slantPlaneRows,
-                                       polyOrderX, polyOrderY);
-
-    outputToSlantCol = math::poly::fit(mOutputPlaneRows,
-                                       mOutputPlaneCols,
-                                       slantPlaneCols,
-                                       polyOrderX, polyOrderY);
+    const PolyFitSolver& solver(getOutputPlaneSolver(polyOrderX, polyOrderY));
+    outputToSlantRow = solver.fit(slantPlaneRows);
+    outputToSlantCol = solver.fit(slantPlaneCols);
 
     // Optionally report the residual error
     if (meanResidualErrorRow || meanResidualErrorCol)
     {
+        // The output plane samples form a regular lattice, so evaluate the
+        // fitted polynomials over the whole lattice at once
+        const types::RowCol<size_t> dims(mNumPoints1D, mNumPoints1D);
+        const types::RowCol<double> start(0.0, 0.0);
+        std::vector<double> fitRows(mNumPoints1D * mNumPoints1D);
+        std::vector<double> fitCols(mNumPoints1D * mNumPoints1D);
+        evaluateLattice(outputToSlantRow, start, mSampleSpacing, dims,
+                        &fitRows[0]);
+        evaluateLattice(outputToSlantCol, start, mSampleSpacing, dims,
+                        &fitCols[0]);
+
         double errorSumRow(0.0);
         double errorSumCol(0.0);
 
-        for (size_t ii = 0; ii < mNumPoints1D; ++ii)
+        for (size_t ii = 0, idx = 0; ii < mNumPoints1D; ++ii)
         {
-            for (size_t jj = 0; jj < mNumPoints1D; ++jj)
+            for (size_t jj = 0; jj < mNumPoints1D; ++jj, ++idx)
             {
-                const double row(mOutputPlaneRows(ii, jj));
-                const double col(mOutputPlaneCols(ii, jj));
-
-                double diff =
-                        slantPlaneRows(ii, jj) - outputToSlantRow(row, col);
+                double diff = slantPlaneRows(ii, jj) - fitRows[idx];
                 errorSumRow += diff * diff;
 
-                diff = slantPlaneCols(ii, jj) - outputToSlantCol(row, col);
+                diff = slantPlaneCols(ii, jj) - fitCols[idx];
                 errorSumCol += diff * diff;
             }
         }
@@ -227,16 +475,17 @@ void ProjectionPolynomialFitter::fitSlantToOutputPolynomials(
                          slantPlaneRows,
                          slantPlaneCols);
 
-    // Now fit the polynomials
-    slantToOutputRow = math::poly::fit(slantPlaneRows,
-                                       slantPlaneCols,
-                                       mOutputPlaneRows,
-                                       polyOrderX, polyOrderY);
-
-    slantToOutputCol = math::poly::fit(slantPlaneRows,
-                                       slantPlaneCols,
-                                       mOutputPlaneCols,
-                                       polyOrderX, polyOrderY);
+    // Now fit the polynomials.  The slant plane samples are just the scene
+    // coordinates scaled and shifted, so fit against those.
+    const types::RowCol<double> ratio(interimSceneCenter / inSceneCenter);
+    const types::RowCol<double> scale(1.0 / interimSampleSpacing.row,
+                                      1.0 / interimSampleSpacing.col);
+    const types::RowCol<double> offset(
+            interimSceneCenter.row - inPixelStart.row * ratio.row,
+            interimSceneCenter.col - inPixelStart.col * ratio.col);
+    const PolyFitSolver& solver(getSceneSolver(polyOrderX, polyOrderY));
+    slantToOutputRow = solver.fit(mOutputPlaneRows, scale, offset);
+    slantToOutputCol = solver.fit(mOutputPlaneCols, scale, offset);
 
     // Optionally report the residual error
     if (meanResidualErrorRow || meanResidualErrorCol)
@@ -280,42 +529,36 @@ void ProjectionPolynomialFitter::fitTimeCOAPolynomial(
         math::poly::TwoD<double>& timeCOAPoly,
         double* meanResidualError) const
 {
-    math::linear::Matrix2D<double> rowMapping(mNumPoints1D, mNumPoints1D);
-    math::linear::Matrix2D<double> colMapping(mNumPoints1D, mNumPoints1D);
-
-    for (size_t ii = 0; ii < mNumPoints1D; ++ii)
-    {
-        for (size_t jj = 0; jj < mNumPoints1D; ++jj)
-        {
-            // Need to map output plane pixels to meters from the output
-            // plane SCP
-            rowMapping(ii, jj) =
-                    (mOutputPlaneRows(ii,jj) - outSceneCenter.row) *
-                    outSampleSpacing.row;
-
-            colMapping(ii, jj) =
-                    (mOutputPlaneCols(ii,jj) - outSceneCenter.col) *
-                    outSampleSpacing.col;
-        }
-    }
-
-    // Now fit the polynomial
-    timeCOAPoly = math::poly::fit(rowMapping, colMapping, mTimeCOA,
-                                  polyOrderX, polyOrderY);
+    // Need to map output plane pixels to meters from the output plane SCP.
+    // That's an affine function of the output plane samples, so the fit
+    // can reuse their factorization.
+    const types::RowCol<double> start(
+            -outSceneCenter.row * outSampleSpacing.row,
+            -outSceneCenter.col * outSampleSpacing.col);
+    timeCOAPoly = getOutputPlaneSolver(polyOrderX, polyOrderY).fit(
+            mTimeCOA, outSampleSpacing, start);
 
     // Optionally report the residual error
     if (meanResidualError)
     {
+        // The row/col mapping is itself a lattice
+        const types::RowCol<double> spacing(
+                mSampleSpacing.row * outSampleSpacing.row,
+                mSampleSpacing.col * outSampleSpacing.col);
+        std::vector<double> fitTimeCOA(mNumPoints1D * mNumPoints1D);
+        evaluateLattice(timeCOAPoly,
+                        start,
+                        spacing,
+                        types::RowCol<size_t>(mNumPoints1D, mNumPoints1D),
+                        &fitTimeCOA[0]);
+
         double errorSum(0.0);
 
-        for (size_t ii = 0; ii < mNumPoints1D; ++ii)
+        for (size_t ii = 0, idx = 0; ii < mNumPoints1D; ++ii)
         {
-            for (size_t jj = 0; jj < mNumPoints1D; ++jj)
+            for (size_t jj = 0; jj < mNumPoints1D; ++jj, ++idx)
             {
-                const double row(rowMapping(ii, jj));
-                const double col(colMapping(ii, jj));
-
-                const double diff = mTimeCOA(ii, jj) - timeCOAPoly(row, col);
+                const double diff = mTimeCOA(ii, jj) - fitTimeCOA[idx];
                 errorSum += diff * diff;
             }
         }
@@ -331,11 +574,22 @@ void ProjectionPolynomialFitter::fitPixelBasedTimeCOAPolynomial(
         math::poly::TwoD<double>& timeCOAPoly,
         double* meanResidualError) const
 {
-    fitPixelBasedTimeCOAPolynomial<Shift, Shift>(Shift(outPixelShift.row),
-                                                 Shift(outPixelShift.col),
-                                                 polyOrderX,
-                                                 polyOrderY,
-                                                 timeCOAPoly,
-                                                 meanResidualError);
+    // Shifting the output plane samples doesn't change their factorization
+    const types::RowCol<double> start(-outPixelShift.row,
+                                      -outPixelShift.col);
+    timeCOAPoly = getOutputPlaneSolver(polyOrderX, polyOrderY).fit(
+            mTimeCOA, types::RowCol<double>(1.0, 1.0), start);
+
+    // Optionally report the residual error
+    if (meanResidualError)
+    {
+        std::vector<double> fitTimeCOA(mNumPoints1D * mNumPoints1D);
+        evaluateLattice(timeCOAPoly,
+                        start,
+                        mSampleSpacing,
+                        types::RowCol<size_t>(mNumPoints1D, mNumPoints1D),
+                        &fitTimeCOA[0]);
+        *meanResidualError = getMeanResidualError(mTimeCOA, fitTimeCOA);
+    }
 }
 }
@@ -0,0 +1,160 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+
+#include <math/poly/Fit.h>
+#include <scene/PolyFitSolver.h>
+#include "TestCase.h"
+
+namespace
+{
+// Irregularly spaced samples of a smooth, non-polynomial surface
+struct Samples
+{
+    Samples() :
+        x(9, 7),
+        y(9, 7),
+        z(9, 7),
+        z2(9, 7)
+    {
+        for (size_t ii = 0; ii < x.rows(); ++ii)
+        {
+            for (size_t jj = 0; jj < x.cols(); ++jj)
+            {
+                x(ii, jj) = 1000.0 + ii * 10.0 + std::sin(0.3 * jj);
+                y(ii, jj) = -50.0 + jj * 7.5 + 0.1 * ii * jj;
+                z(ii, jj) = std::cos(0.01 * x(ii, jj)) * y(ii, jj);
+                z2(ii, jj) = 1e-3 * x(ii, jj) * x(ii, jj) - y(ii, jj);
+            }
+        }
+    }
+
+    math::linear::Matrix2D<double> x;
+    math::linear::Matrix2D<double> y;
+    math::linear::Matrix2D<double> z;
+    math::linear::Matrix2D<double> z2;
+};
+
+// The two polynomials agree at every sample
+bool matches(const math::poly::TwoD<double>& poly,
+             const math::poly::TwoD<double>& expected,
+             const math::linear::Matrix2D<double>& x,
+             const math::linear::Matrix2D<double>& y)
+{
+    for (size_t ii = 0; ii < x.rows(); ++ii)
+    {
+        for (size_t jj = 0; jj < x.cols(); ++jj)
+        {
+            const double value = expected(x(ii, jj), y(ii, jj));
+            if (std::abs(poly(x(ii, jj), y(ii, jj)) - value) >
+                    1e-8 * std::max(1.0, std::abs(value)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testMatchesFit)
+{
+    const Samples samples;
+    const scene::PolyFitSolver solver(samples.x, samples.y, 3, 2);
+
+    // The same factorization serves both sets of observations
+    TEST_ASSERT(matches(solver.fit(samples.z),
+                        math::poly::fit(samples.x, samples.y, samples.z,
+                                        3, 2),
+                        samples.x, samples.y));
+    TEST_ASSERT(matches(solver.fit(samples.z2),
+                        math::poly::fit(samples.x, samples.y, samples.z2,
+                                        3, 2),
+                        samples.x, samples.y));
+
+    // An exact polynomial should come back out
+    const math::poly::TwoD<double> poly(solver.fit(samples.z2));
+    TEST_ASSERT_EQ(poly.orderX(), 3);
+    TEST_ASSERT_EQ(poly.orderY(), 2);
+    TEST_ASSERT_ALMOST_EQ_EPS(poly[2][0], 1e-3, 1e-12);
+    TEST_ASSERT_ALMOST_EQ_EPS(poly[0][1], -1.0, 1e-9);
+}
+
+TEST_CASE(testTransformedFit)
+{
+    const Samples samples;
+    const scene::PolyFitSolver solver(samples.x, samples.y, 2, 3);
+
+    // Fit against the locations scaled and shifted, including a flip
+    const types::RowCol<double> scale(0.25, -3.0);
+    const types::RowCol<double> offset(-100.0, 42.0);
+    math::linear::Matrix2D<double> x(samples.x);
+    math::linear::Matrix2D<double> y(samples.y);
+    for (size_t ii = 0; ii < x.rows(); ++ii)
+    {
+        for (size_t jj = 0; jj < x.cols(); ++jj)
+        {
+            x(ii, jj) = x(ii, jj) * scale.row + offset.row;
+            y(ii, jj) = y(ii, jj) * scale.col + offset.col;
+        }
+    }
+
+    TEST_ASSERT(matches(solver.fit(samples.z, scale, offset),
+                        math::poly::fit(x, y, samples.z, 2, 3),
+                        x, y));
+    TEST_EXCEPTION(solver.fit(samples.z, types::RowCol<double>(0.0, 1.0),
+                              offset));
+}
+
+TEST_CASE(testBadSamples)
+{
+    const Samples samples;
+
+    // Too few samples for the orders
+    TEST_EXCEPTION(scene::PolyFitSolver(samples.x, samples.y, 8, 8));
+
+    // Mismatched sizes
+    const math::linear::Matrix2D<double> small(3, 3, 1.0);
+    TEST_EXCEPTION(scene::PolyFitSolver(samples.x, small, 1, 1));
+    const scene::PolyFitSolver solver(samples.x, samples.y, 1, 1);
+    TEST_EXCEPTION(solver.fit(small));
+
+    // Locations that are all the same only support a constant
+    const math::linear::Matrix2D<double> constant(9, 7, 5.0);
+    TEST_EXCEPTION(scene::PolyFitSolver(samples.x, constant, 1, 1));
+    const scene::PolyFitSolver constantSolver(samples.x, constant, 1, 0);
+    TEST_ASSERT_EQ(constantSolver.getOrderY(), 0);
+
+    // y depends on x, so x * y can't be told apart from x^2
+    math::linear::Matrix2D<double> dependent(samples.x);
+    dependent.scale(2.0);
+    TEST_EXCEPTION(scene::PolyFitSolver(samples.x, dependent, 2, 1));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMatchesFit);
+    TEST_CHECK(testTransformedFit);
+    TEST_CHECK(testBadSamples);
+    return 0;
+}
@@ -0,0 +1,134 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+#include <scene/PolyLatticeEvaluator.h>
+#include <scene/Types.h>
+#include "TestCase.h"
+
+namespace
+{
+math::poly::TwoD<double> createPoly()
+{
+    math::poly::TwoD<double> poly(3, 2);
+    for (size_t ii = 0; ii <= poly.orderX(); ++ii)
+    {
+        for (size_t jj = 0; jj <= poly.orderY(); ++jj)
+        {
+            poly[ii][jj] = 0.5 * ii - 0.25 * jj + 0.1 * ii * jj + 1.0;
+        }
+    }
+    return poly;
+}
+
+bool compareLattice(const math::poly::TwoD<double>& poly,
+                    const types::RowCol<double>& start,
+                    const types::RowCol<double>& spacing,
+                    const types::RowCol<size_t>& dims,
+                    const std::vector<double>& values)
+{
+    for (size_t row = 0, idx = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col, ++idx)
+        {
+            const double expected = poly(start.row + row * spacing.row,
+                                         start.col + col * spacing.col);
+            if (std::abs(expected - values[idx]) >
+                    1e-12 * std::max(1.0, std::abs(expected)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+}
+
+TEST_CASE(testTwoDLattice)
+{
+    const math::poly::TwoD<double> poly(createPoly());
+    const types::RowCol<double> start(-1.5, 2.0);
+    const types::RowCol<double> spacing(0.25, -0.125);
+    const types::RowCol<size_t> dims(17, 33);
+
+    std::vector<double> values(dims.area());
+    scene::evaluateLattice(poly, start, spacing, dims, &values[0]);
+    TEST_ASSERT(compareLattice(poly, start, spacing, dims, values));
+
+    // Threaded evaluation should match exactly
+    std::vector<double> threadedValues(dims.area());
+    scene::evaluateLattice(poly, start, spacing, dims,
+                           &threadedValues[0], 4);
+    TEST_ASSERT(values == threadedValues);
+}
+
+TEST_CASE(testTwoDLatticeStrips)
+{
+    const math::poly::TwoD<double> poly(createPoly());
+    const types::RowCol<double> start(0.0, 0.0);
+    const types::RowCol<double> spacing(1.0, 1.0);
+    const types::RowCol<size_t> dims(10, 7);
+    const scene::PolyLatticeEvaluator<double> evaluator(poly, start,
+                                                        spacing, dims);
+
+    std::vector<double> values(dims.area());
+    evaluator.evaluateRows(0, 4, &values[0]);
+    evaluator.evaluateRows(4, 6, &values[4 * dims.col]);
+    TEST_ASSERT(compareLattice(poly, start, spacing, dims, values));
+
+    TEST_EXCEPTION(evaluator.evaluateRows(8, 3, &values[0]));
+}
+
+TEST_CASE(testOneDLattice)
+{
+    math::poly::OneD<scene::Vector3> poly(2);
+    for (size_t ii = 0; ii <= poly.order(); ++ii)
+    {
+        poly[ii][0] = 1.0 + ii;
+        poly[ii][1] = -2.0 * ii;
+        poly[ii][2] = 0.5;
+    }
+
+    const size_t numSamples = 11;
+    std::vector<scene::Vector3> values(numSamples);
+    scene::evaluateLattice(poly, -3.0, 0.75, numSamples, &values[0]);
+
+    for (size_t ii = 0; ii < numSamples; ++ii)
+    {
+        const scene::Vector3 expected = poly(-3.0 + ii * 0.75);
+        for (size_t dim = 0; dim < 3; ++dim)
+        {
+            TEST_ASSERT_ALMOST_EQ(values[ii][dim], expected[dim]);
+        }
+    }
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testTwoDLattice);
+    TEST_CHECK(testTwoDLatticeStrips);
+    TEST_CHECK(testOneDLattice);
+    return 0;
+}
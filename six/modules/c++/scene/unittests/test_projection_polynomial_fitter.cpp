@@ -0,0 +1,290 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <memory>
+
+#include <math/linear/VectorN.h>
+#include <math/poly/Fit.h>
+#include <scene/GridECEFTransform.h>
+#include <scene/LLAToECEFTransform.h>
+#include <scene/ProjectionModel.h>
+#include <scene/ProjectionPolynomialFitter.h>
+#include "TestCase.h"
+
+namespace
+{
+scene::Vector3 normalize(const scene::Vector3& vec)
+{
+    return vec / vec.norm();
+}
+
+// An airborne collect looking broadside at a 1000 x 800 pixel ground plane
+// output grid with 0.5 meter pixels
+struct Geometry
+{
+    Geometry() :
+        outExtent(1000, 800)
+    {
+        const scene::Vector3 scp = scene::LLAToECEFTransform().transform(
+                scene::LatLonAlt(35.0, -110.0, 0.0));
+        const scene::Vector3 up = normalize(scp);
+        std::vector<double> zAxis(3, 0.0);
+        zAxis[2] = 1.0;
+        const scene::Vector3 east =
+                normalize(math::linear::cross(scene::Vector3(zAxis), up));
+        const scene::Vector3 north = math::linear::cross(up, east);
+
+        // Flying north at 150 m/s, 10 km west of the scene and 8 km up
+        math::poly::OneD<scene::Vector3> arpPoly(1);
+        arpPoly[0] = scp + up * 8000.0 - east * 10000.0;
+        arpPoly[1] = north * 150.0;
+
+        // Time COA is in meters from the SCP along the col direction
+        math::poly::TwoD<double> timeCOAPoly(1, 1);
+        timeCOAPoly[0][0] = 2.0;
+        timeCOAPoly[0][1] = 1.0 / 150.0;
+
+        const scene::Vector3 rowVec = normalize(scp - arpPoly[0]);
+        const scene::Vector3 colVec = north;
+        projModel.reset(new scene::PlaneProjectionModel(
+                math::linear::cross(rowVec, colVec),
+                rowVec, colVec, scp, arpPoly, timeCOAPoly, -1));
+
+        gridTransform.reset(new scene::PlanarGridECEFTransform(
+                types::RowCol<double>(0.5, 0.5),
+                types::RowCol<double>(outExtent.row / 2.0,
+                                      outExtent.col / 2.0),
+                east, north, scp));
+    }
+
+    const types::RowCol<size_t> outExtent;
+    std::auto_ptr<const scene::ProjectionModel> projModel;
+    std::auto_ptr<const scene::GridECEFTransform> gridTransform;
+};
+
+// The two polynomials agree at every sample
+bool matches(const math::poly::TwoD<double>& poly,
+             const math::poly::TwoD<double>& expected,
+             const math::linear::Matrix2D<double>& x,
+             const math::linear::Matrix2D<double>& y)
+{
+    for (size_t ii = 0; ii < x.rows(); ++ii)
+    {
+        for (size_t jj = 0; jj < x.cols(); ++jj)
+        {
+            const double value = expected(x(ii, jj), y(ii, jj));
+            if (std::abs(poly(x(ii, jj), y(ii, jj)) - value) >
+                    1e-6 * std::max(1.0, std::abs(value)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool operator==(const math::linear::Matrix2D<types::RowCol<double> >& lhs,
+                const math::linear::Matrix2D<types::RowCol<double> >& rhs)
+{
+    if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+    {
+        return false;
+    }
+    for (size_t ii = 0; ii < lhs.rows(); ++ii)
+    {
+        for (size_t jj = 0; jj < lhs.cols(); ++jj)
+        {
+            if (lhs(ii, jj) != rhs(ii, jj))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testThreadedSampling)
+{
+    const Geometry geometry;
+    const types::RowCol<double> start(100.0, 50.0);
+    const scene::ProjectionPolynomialFitter fitter(
+            *geometry.projModel, *geometry.gridTransform, start,
+            geometry.outExtent, 13);
+    const scene::ProjectionPolynomialFitter threadedFitter(
+            *geometry.projModel, *geometry.gridTransform, start,
+            geometry.outExtent, 13, 4);
+
+    TEST_ASSERT_EQ(threadedFitter.getNumPoints1D(), 13);
+    TEST_ASSERT(fitter.getOutputPlaneRows() ==
+                threadedFitter.getOutputPlaneRows());
+    TEST_ASSERT(fitter.getOutputPlaneCols() ==
+                threadedFitter.getOutputPlaneCols());
+    TEST_ASSERT(fitter.getSceneCoordinates() ==
+                threadedFitter.getSceneCoordinates());
+    TEST_ASSERT(fitter.getTimeCOA() == threadedFitter.getTimeCOA());
+
+    // The grid spans the output extent
+    TEST_ASSERT_EQ(fitter.getOutputPlaneRows()(12, 0),
+                   geometry.outExtent.row - 1.0);
+    TEST_ASSERT_EQ(fitter.getOutputPlaneCols()(0, 12),
+                   geometry.outExtent.col - 1.0);
+}
+
+TEST_CASE(testFitsMatch)
+{
+    const Geometry geometry;
+    const scene::ProjectionPolynomialFitter fitter(
+            *geometry.projModel, *geometry.gridTransform,
+            types::RowCol<double>(0.0, 0.0), geometry.outExtent, 12, 3);
+    const math::linear::Matrix2D<double>& outRows(
+            fitter.getOutputPlaneRows());
+    const math::linear::Matrix2D<double>& outCols(
+            fitter.getOutputPlaneCols());
+
+    // Slant plane pixels, as the fitter computes them
+    const types::RowCol<size_t> inPixelStart(10, 20);
+    const types::RowCol<double> inSceneCenter(600.0, 500.0);
+    const types::RowCol<double> interimSpacing(0.4, 0.45);
+    math::linear::Matrix2D<double> slantRows(12, 12);
+    math::linear::Matrix2D<double> slantCols(12, 12);
+    for (size_t ii = 0; ii < 12; ++ii)
+    {
+        for (size_t jj = 0; jj < 12; ++jj)
+        {
+            const types::RowCol<double> coord(
+                    fitter.getSceneCoordinates()(ii, jj));
+            slantRows(ii, jj) = coord.row / interimSpacing.row +
+                    inSceneCenter.row - inPixelStart.row;
+            slantCols(ii, jj) = coord.col / interimSpacing.col +
+                    inSceneCenter.col - inPixelStart.col;
+        }
+    }
+
+    math::poly::TwoD<double> rowPoly;
+    math::poly::TwoD<double> colPoly;
+    double rowError(-1.0);
+    double colError(-1.0);
+    fitter.fitOutputToSlantPolynomials(inPixelStart, inSceneCenter,
+                                       inSceneCenter, interimSpacing, 3, 3,
+                                       rowPoly, colPoly,
+                                       &rowError, &colError);
+    TEST_ASSERT(matches(rowPoly,
+                        math::poly::fit(outRows, outCols, slantRows, 3, 3),
+                        outRows, outCols));
+    TEST_ASSERT(matches(colPoly,
+                        math::poly::fit(outRows, outCols, slantCols, 3, 3),
+                        outRows, outCols));
+    TEST_ASSERT(rowError >= 0.0 && rowError < 1e-2);
+    TEST_ASSERT(colError >= 0.0 && colError < 1e-2);
+
+    fitter.fitSlantToOutputPolynomials(inPixelStart, inSceneCenter,
+                                       inSceneCenter, interimSpacing, 3, 3,
+                                       rowPoly, colPoly,
+                                       &rowError, &colError);
+    TEST_ASSERT(matches(rowPoly,
+                        math::poly::fit(slantRows, slantCols, outRows, 3, 3),
+                        slantRows, slantCols));
+    TEST_ASSERT(matches(colPoly,
+                        math::poly::fit(slantRows, slantCols, outCols, 3, 3),
+                        slantRows, slantCols));
+    TEST_ASSERT(rowError >= 0.0 && rowError < 1e-2);
+    TEST_ASSERT(colError >= 0.0 && colError < 1e-2);
+
+    // Time COA in meters from the output scene center, and in 1-based
+    // pixels.  Both reuse the output --> slant factorization.
+    const types::RowCol<double> outSceneCenter(500.0, 400.0);
+    const types::RowCol<double> outSpacing(0.5, 0.5);
+    math::linear::Matrix2D<double> meterRows(outRows);
+    math::linear::Matrix2D<double> meterCols(outCols);
+    math::linear::Matrix2D<double> pixelRows(outRows);
+    math::linear::Matrix2D<double> pixelCols(outCols);
+    for (size_t ii = 0; ii < 12; ++ii)
+    {
+        for (size_t jj = 0; jj < 12; ++jj)
+        {
+            meterRows(ii, jj) =
+                    (outRows(ii, jj) - outSceneCenter.row) * outSpacing.row;
+            meterCols(ii, jj) =
+                    (outCols(ii, jj) - outSceneCenter.col) * outSpacing.col;
+            pixelRows(ii, jj) += 1.0;
+            pixelCols(ii, jj) += 1.0;
+        }
+    }
+
+    math::poly::TwoD<double> timeCOAPoly;
+    double timeError(-1.0);
+    fitter.fitTimeCOAPolynomial(outSceneCenter, outSpacing, 3, 3,
+                                timeCOAPoly, &timeError);
+    TEST_ASSERT(matches(timeCOAPoly,
+                        math::poly::fit(meterRows, meterCols,
+                                        fitter.getTimeCOA(), 3, 3),
+                        meterRows, meterCols));
+    TEST_ASSERT(timeError >= 0.0 && timeError < 1e-6);
+
+    fitter.fitPixelBasedTimeCOAPolynomial(types::RowCol<double>(-1.0, -1.0),
+                                          3, 3, timeCOAPoly, &timeError);
+    TEST_ASSERT(matches(timeCOAPoly,
+                        math::poly::fit(pixelRows, pixelCols,
+                                        fitter.getTimeCOA(), 3, 3),
+                        pixelRows, pixelCols));
+    TEST_ASSERT(timeError >= 0.0 && timeError < 1e-6);
+}
+
+TEST_CASE(testAdaptiveSampling)
+{
+    const Geometry geometry;
+    const types::RowCol<double> start(0.0, 0.0);
+
+    // A loose tolerance is met by the first refinement
+    const scene::ProjectionPolynomialFitter looseFitter(
+            *geometry.projModel, *geometry.gridTransform, start,
+            geometry.outExtent, 3, 3, 1.0, 100, 2);
+    TEST_ASSERT_EQ(looseFitter.getNumPoints1D(), 19);
+
+    // An impossible one stops at the limit
+    const scene::ProjectionPolynomialFitter tightFitter(
+            *geometry.projModel, *geometry.gridTransform, start,
+            geometry.outExtent, 1, 1, 0.0, 50, 2);
+    TEST_ASSERT_EQ(tightFitter.getNumPoints1D(), 50);
+
+    // The refined samples are the same as sampling that density directly
+    const scene::ProjectionPolynomialFitter fitter(
+            *geometry.projModel, *geometry.gridTransform, start,
+            geometry.outExtent, 19);
+    TEST_ASSERT(looseFitter.getSceneCoordinates() ==
+                fitter.getSceneCoordinates());
+    TEST_ASSERT(looseFitter.getTimeCOA() == fitter.getTimeCOA());
+
+    TEST_EXCEPTION(scene::ProjectionPolynomialFitter(
+            *geometry.projModel, *geometry.gridTransform, start,
+            geometry.outExtent, 1, 1, 0.0, 1));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testThreadedSampling);
+    TEST_CHECK(testFitsMatch);
+    TEST_CHECK(testAdaptiveSampling);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_INDEX_ENTRY_H__
+#define __SIX_INDEX_ENTRY_H__
+
+#include <string>
+
+#include <sys/Conf.h>
+#include <six/Types.h>
+
+namespace six
+{
+namespace index
+{
+/*!
+ *  \struct Entry
+ *  \brief What the index knows about one product
+ *
+ *  Everything needed to answer a query without opening the product again.
+ *  Times are in seconds since the Unix epoch.
+ */
+struct Entry
+{
+    Entry();
+
+    //! Whether the footprint contains 'point'
+    bool contains(const LatLon& point) const;
+
+    /*!
+     *  Gets the footprint's corners with the longitudes unwrapped past 180
+     *  degrees if it crosses the antimeridian, so that it's a simple
+     *  quadrilateral
+     */
+    void getUnwrappedFootprint(double lat[4], double lon[4]) const;
+
+    /*!
+     *  Whether the quadrilateral with corners (lat[ii], lon[ii]) contains
+     *  (pointLat, pointLon).  The longitudes are compared as they are, with
+     *  no wrapping.
+     */
+    static
+    bool contains(const double lat[4],
+                  const double lon[4],
+                  double pointLat,
+                  double pointLon);
+
+    //! Whether the collection overlaps [startTime, endTime]
+    bool overlaps(double startTime, double endTime) const
+    {
+        return this->startTime <= endTime && this->endTime >= startTime;
+    }
+
+    bool operator==(const Entry& rhs) const;
+
+    bool operator!=(const Entry& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    std::string pathname;
+
+    //! Last modification time of the file when it was indexed
+    sys::Off_T modified;
+
+    //! "SICD", "SIDD" or "CPHD"
+    std::string productType;
+
+    //! Collector or sensor name
+    std::string sensor;
+
+    //! Radar mode (e.g. "SPOTLIGHT")
+    std::string mode;
+
+    //! Pixel type for SICDs and SIDDs, sample type for CPHDs
+    std::string pixelType;
+
+    //! Image corners for SICDs and CPHDs, footprint for SIDDs
+    LatLonCorners footprint;
+
+    double startTime;
+    double endTime;
+};
+}
+}
+
+#endif
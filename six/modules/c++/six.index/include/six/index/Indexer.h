@@ -0,0 +1,111 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_INDEX_INDEXER_H__
+#define __SIX_INDEX_INDEXER_H__
+
+#include <string>
+#include <vector>
+
+#include <logging/Logger.h>
+#include <sys/Conf.h>
+#include <six/index/Entry.h>
+
+namespace six
+{
+namespace index
+{
+/*!
+ *  \class Indexer
+ *  \brief Builds the entries for a MetadataIndex from SICD, SIDD and CPHD
+ *  files
+ *
+ *  Only the headers and XML of each file are read, never the image or
+ *  phase history data.  Files are read in parallel, and an earlier index's
+ *  entries are reused for files that haven't been modified since.
+ *
+ *  SICDs and SIDDs are loaded through NITFReadControl, so their XML is
+ *  validated against SIX_SCHEMA_PATH if it's set.
+ */
+class Indexer
+{
+public:
+    /*!
+     *  \param numThreads Number of files to read at once
+     *  \param log Where to report files that couldn't be read.  If NULL,
+     *  they're only returned.
+     */
+    Indexer(size_t numThreads = 1, logging::Logger* log = NULL);
+
+    virtual ~Indexer()
+    {
+    }
+
+    /*!
+     *  Builds the entries for 'pathnames'
+     *
+     *  \param pathnames Files to index
+     *  \param previous Entries from an earlier index.  Those whose files
+     *  are in 'pathnames' with the same modification time are reused
+     *  as is, and the rest are dropped.
+     *  \param[out] entries An entry for each file that could be read, in
+     *  the order of 'pathnames'
+     *  \param[out] failed Files that couldn't be read
+     *
+     *  \return The number of files that had to be read
+     */
+    size_t index(const std::vector<std::string>& pathnames,
+                 const std::vector<Entry>& previous,
+                 std::vector<Entry>& entries,
+                 std::vector<std::string>& failed) const;
+
+    /*!
+     *  Brings the index at 'indexPathname' up to date with 'pathnames',
+     *  creating it if it doesn't exist yet
+     *
+     *  \return The number of files that had to be read
+     */
+    size_t update(const std::string& indexPathname,
+                  const std::vector<std::string>& pathnames,
+                  std::vector<std::string>& failed) const;
+
+    //! Reads the entry for a single SICD, SIDD or CPHD
+    virtual Entry read(const std::string& pathname) const;
+
+    //! \return The modification time of 'pathname'
+    virtual sys::Off_T getModifiedTime(const std::string& pathname) const;
+
+    /*!
+     *  Finds the products (.nitf, .ntf and .cphd files) in 'paths', which
+     *  may be files or directories
+     */
+    static
+    std::vector<std::string>
+    findProducts(const std::vector<std::string>& paths, bool recursive);
+
+private:
+    const size_t mNumThreads;
+    logging::Logger* const mLog;
+};
+}
+}
+
+#endif
@@ -0,0 +1,144 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_INDEX_METADATA_INDEX_H__
+#define __SIX_INDEX_METADATA_INDEX_H__
+
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <six/MappedFile.h>
+#include <six/Types.h>
+#include <six/index/Entry.h>
+
+namespace six
+{
+namespace index
+{
+/*!
+ *  \class MetadataIndex
+ *  \brief Read-only, memory-mapped index over a collection of products
+ *
+ *  The file holds a fixed-size record per product, a packed R-tree over
+ *  their footprints' bounding boxes and the records' indices sorted by
+ *  collection start time, all laid out so that queries work directly off
+ *  the mapping with no parsing up front.  Strings live in a table at the
+ *  end and are only copied out by getEntry().
+ *
+ *  Footprints that cross the antimeridian are stored with their
+ *  longitudes unwrapped past 180 degrees, and points are looked up at both
+ *  lon and lon + 360.
+ *
+ *  Indices are written by write() (see Indexer for building one from
+ *  files) in the byte order of the machine that wrote them, and refuse to
+ *  load on a machine of the other byte order.
+ */
+class MetadataIndex
+{
+public:
+    //! Maps the index in 'pathname'
+    explicit MetadataIndex(const std::string& pathname);
+
+    size_t getNumEntries() const
+    {
+        return mNumEntries;
+    }
+
+    //! \return Entry 'index', copied out of the mapping
+    Entry getEntry(size_t index) const;
+
+    //! \return All the entries
+    std::vector<Entry> getEntries() const;
+
+    //! \return The pathname of entry 'index'
+    std::string getPathname(size_t index) const;
+
+    /*!
+     *  Finds the entries whose footprints contain 'point'
+     *
+     *  \param point Latitude and longitude in degrees
+     *  \param[out] indices Indices of the matching entries, in
+     *  increasing order
+     */
+    void findPoint(const LatLon& point, std::vector<size_t>& indices) const;
+
+    /*!
+     *  Finds the entries collected during [startTime, endTime]
+     *
+     *  \param startTime Start of the window, in seconds since the epoch
+     *  \param endTime End of the window, in seconds since the epoch
+     *  \param[out] indices Indices of the matching entries, in
+     *  increasing order
+     */
+    void findTime(double startTime,
+                  double endTime,
+                  std::vector<size_t>& indices) const;
+
+    //! Finds the entries that satisfy both findPoint() and findTime()
+    void find(const LatLon& point,
+              double startTime,
+              double endTime,
+              std::vector<size_t>& indices) const;
+
+    /*!
+     *  Writes an index of 'entries' to 'pathname'.  The entries are stored
+     *  in R-tree order rather than the order they're given in.  The file is
+     *  written beside 'pathname' and then renamed over it, so readers never
+     *  see a partial index.
+     */
+    static
+    void write(const std::vector<Entry>& entries,
+               const std::string& pathname);
+
+    //! Number of children of each R-tree node
+    static const size_t NODE_SIZE;
+
+    struct FileHeader;
+    struct Record;
+    struct Node;
+    struct TimeKey;
+
+private:
+    MetadataIndex(const MetadataIndex& );
+    MetadataIndex& operator=(const MetadataIndex& );
+
+    std::string getString(sys::Uint64_T offset) const;
+
+    void findPoint(double lat, double lon, std::vector<size_t>& indices) const;
+
+    const MappedFile mFile;
+    const sys::ubyte* const mData;
+    const size_t mSize;
+
+    size_t mNumEntries;
+    size_t mNumNodes;
+    double mMaxDuration;
+    const Record* mRecords;
+    const Node* mNodes;
+    const TimeKey* mTimes;
+    const char* mStrings;
+    size_t mStringsSize;
+};
+}
+}
+
+#endif
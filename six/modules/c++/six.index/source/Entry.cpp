@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+
+#include <six/index/Entry.h>
+
+namespace six
+{
+namespace index
+{
+Entry::Entry() :
+    modified(0),
+    startTime(0.0),
+    endTime(0.0)
+{
+}
+
+void Entry::getUnwrappedFootprint(double lat[4], double lon[4]) const
+{
+    double minLon(0.0);
+    double maxLon(0.0);
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const LatLon& corner(footprint.getCorner(ii));
+        lat[ii] = corner.getLat();
+        lon[ii] = corner.getLon();
+        minLon = (ii == 0) ? lon[ii] : std::min(minLon, lon[ii]);
+        maxLon = (ii == 0) ? lon[ii] : std::max(maxLon, lon[ii]);
+    }
+
+    // Nothing real spans more than half the globe in longitude, so this
+    // must wrap around the other way
+    if (maxLon - minLon > 180.0)
+    {
+        for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+        {
+            if (lon[ii] < 0.0)
+            {
+                lon[ii] += 360.0;
+            }
+        }
+    }
+}
+
+bool Entry::contains(const double lat[4],
+                     const double lon[4],
+                     double pointLat,
+                     double pointLon)
+{
+    // Count crossings of a ray heading east from the point
+    bool inside = false;
+    for (size_t ii = 0, jj = 3; ii < 4; jj = ii++)
+    {
+        if ((lat[ii] > pointLat) != (lat[jj] > pointLat))
+        {
+            const double crossingLon = lon[ii] + (pointLat - lat[ii]) *
+                    (lon[jj] - lon[ii]) / (lat[jj] - lat[ii]);
+            if (pointLon < crossingLon)
+            {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+bool Entry::contains(const LatLon& point) const
+{
+    double lat[4];
+    double lon[4];
+    getUnwrappedFootprint(lat, lon);
+    return contains(lat, lon, point.getLat(), point.getLon()) ||
+            contains(lat, lon, point.getLat(), point.getLon() + 360.0);
+}
+
+bool Entry::operator==(const Entry& rhs) const
+{
+    return pathname == rhs.pathname &&
+            modified == rhs.modified &&
+            productType == rhs.productType &&
+            sensor == rhs.sensor &&
+            mode == rhs.mode &&
+            pixelType == rhs.pixelType &&
+            footprint == rhs.footprint &&
+            startTime == rhs.startTime &&
+            endTime == rhs.endTime;
+}
+}
+}
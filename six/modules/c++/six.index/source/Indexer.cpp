@@ -0,0 +1,382 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <map>
+
+#include <except/Exception.h>
+#include <io/FileInputStream.h>
+#include <mt/CriticalSection.h>
+#include <mt/ThreadGroup.h>
+#include <sys/FileFinder.h>
+#include <sys/Mutex.h>
+#include <sys/OS.h>
+#include <sys/Runnable.h>
+#include <six/Init.h>
+#include <six/NITFReadControl.h>
+#include <six/XMLControlFactory.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/DerivedXMLControl.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/FileHeader.h>
+#include <six/index/Indexer.h>
+#include <six/index/MetadataIndex.h>
+
+namespace
+{
+double toSeconds(const six::DateTime& dateTime)
+{
+    return dateTime.getTimeInMillis() / 1000.0;
+}
+
+void readCPHD(const std::string& pathname, six::index::Entry& entry)
+{
+    const cphd::CPHDReader reader(pathname, 1,
+                                  mem::SharedPtr<logging::Logger>(), false);
+    const cphd::Metadata& metadata(reader.getMetadata());
+
+    entry.productType = "CPHD";
+    entry.sensor = metadata.collectionInformation.collectorName;
+    entry.mode = metadata.collectionInformation.radarMode.toString();
+    entry.pixelType = metadata.data.sampleType.toString();
+
+    const six::LatLonAltCorners& corners(
+            metadata.global.imageArea.acpCorners);
+    for (size_t ii = 0; ii < six::LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const six::LatLonAlt& corner(corners.getCorner(ii));
+        entry.footprint.getCorner(ii) =
+                six::LatLon(corner.getLat(), corner.getLon());
+    }
+
+    entry.startTime = toSeconds(metadata.global.collectStart);
+    entry.endTime = entry.startTime + metadata.global.collectDuration;
+}
+
+void readSICD(const six::sicd::ComplexData& data, six::index::Entry& entry)
+{
+    entry.productType = "SICD";
+    entry.sensor = data.collectionInformation->collectorName;
+    entry.mode = data.collectionInformation->radarMode.toString();
+    entry.startTime = toSeconds(data.timeline->collectStart);
+    entry.endTime = entry.startTime + data.timeline->collectDuration;
+}
+
+void readSIDD(const six::sidd::DerivedData& data, six::index::Entry& entry)
+{
+    // The first collection is the one the product's dated by.  Without it
+    // there's no time to index the product under, so it's reported as a
+    // file that couldn't be read.
+    if (!data.exploitationFeatures.get() ||
+        data.exploitationFeatures->collections.empty() ||
+        !data.exploitationFeatures->collections[0].get() ||
+        !data.exploitationFeatures->collections[0]->information.get())
+    {
+        throw except::Exception(Ctxt(
+                "SIDD has no ExploitationFeatures collection information"));
+    }
+    const six::sidd::Information& information(
+            *data.exploitationFeatures->collections[0]->information);
+
+    entry.productType = "SIDD";
+    entry.startTime = toSeconds(information.collectionDateTime);
+    entry.endTime = entry.startTime;
+    entry.sensor = information.sensorName;
+    entry.mode = information.radarMode.toString();
+    if (!six::Init::isUndefined(information.collectionDuration))
+    {
+        entry.endTime += information.collectionDuration;
+    }
+}
+
+void readNITF(const std::string& pathname, six::index::Entry& entry)
+{
+    six::XMLControlRegistry xmlRegistry;
+    xmlRegistry.addCreator(six::DataType::COMPLEX,
+                           new six::XMLControlCreatorT<
+                                   six::sicd::ComplexXMLControl>());
+    xmlRegistry.addCreator(six::DataType::DERIVED,
+                           new six::XMLControlCreatorT<
+                                   six::sidd::DerivedXMLControl>());
+
+    six::NITFReadControl reader;
+    reader.setXMLControlRegistry(&xmlRegistry);
+    reader.load(pathname);
+
+    const mem::SharedPtr<six::Container> container = reader.getContainer();
+    if (container->getNumData() == 0)
+    {
+        throw except::Exception(Ctxt(pathname + " has no SICD or SIDD"));
+    }
+
+    const six::Data& data(*container->getData(0));
+    entry.pixelType = data.getPixelType().toString();
+    entry.footprint = data.getImageCorners();
+    if (data.getDataType() == six::DataType::COMPLEX)
+    {
+        readSICD(static_cast<const six::sicd::ComplexData&>(data), entry);
+    }
+    else
+    {
+        readSIDD(static_cast<const six::sidd::DerivedData&>(data), entry);
+    }
+}
+
+// Files still to be read, handed out one at a time
+struct IndexContext
+{
+    IndexContext(const six::index::Indexer& indexer,
+                 const std::vector<std::string>& pathnames,
+                 const std::vector<size_t>& toRead,
+                 std::vector<six::index::Entry>& entries,
+                 std::vector<std::string>& errors) :
+        indexer(indexer),
+        pathnames(pathnames),
+        toRead(toRead),
+        entries(entries),
+        errors(errors),
+        next(0)
+    {
+    }
+
+    bool getNext(size_t& index)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mutex);
+        if (next == toRead.size())
+        {
+            return false;
+        }
+        index = toRead[next++];
+        return true;
+    }
+
+    const six::index::Indexer& indexer;
+    const std::vector<std::string>& pathnames;
+    const std::vector<size_t>& toRead;
+    std::vector<six::index::Entry>& entries;
+    std::vector<std::string>& errors;
+    size_t next;
+    sys::Mutex mutex;
+};
+
+class IndexRunnable : public sys::Runnable
+{
+public:
+    IndexRunnable(IndexContext& context) :
+        mContext(context)
+    {
+    }
+
+    virtual void run()
+    {
+        size_t index;
+        while (mContext.getNext(index))
+        {
+            // Each file gets its own slot, so there's nothing to lock
+            try
+            {
+                mContext.entries[index] =
+                        mContext.indexer.read(mContext.pathnames[index]);
+            }
+            catch (const except::Exception& ex)
+            {
+                mContext.errors[index] = ex.getMessage();
+            }
+            catch (const std::exception& ex)
+            {
+                mContext.errors[index] = ex.what();
+            }
+
+            if (mContext.errors[index].empty() &&
+                mContext.entries[index].pathname.empty())
+            {
+                mContext.errors[index] = "Unknown error";
+            }
+        }
+    }
+
+private:
+    IndexContext& mContext;
+};
+}
+
+namespace six
+{
+namespace index
+{
+Indexer::Indexer(size_t numThreads, logging::Logger* log) :
+    mNumThreads(std::max<size_t>(numThreads, 1)),
+    mLog(log)
+{
+}
+
+sys::Off_T Indexer::getModifiedTime(const std::string& pathname) const
+{
+    return sys::OS().getLastModifiedTime(pathname);
+}
+
+Entry Indexer::read(const std::string& pathname) const
+{
+    Entry entry;
+    entry.modified = getModifiedTime(pathname);
+
+    bool isCPHD;
+    {
+        io::FileInputStream inStream(pathname);
+        isCPHD = cphd::FileHeader::isCPHD(inStream);
+    }
+
+    if (isCPHD)
+    {
+        readCPHD(pathname, entry);
+    }
+    else
+    {
+        readNITF(pathname, entry);
+    }
+
+    // Set last so that a half-read entry is never mistaken for a good one
+    entry.pathname = pathname;
+    return entry;
+}
+
+size_t Indexer::index(const std::vector<std::string>& pathnames,
+                      const std::vector<Entry>& previous,
+                      std::vector<Entry>& entries,
+                      std::vector<std::string>& failed) const
+{
+    std::map<std::string, const Entry*> previousEntries;
+    for (size_t ii = 0; ii < previous.size(); ++ii)
+    {
+        previousEntries[previous[ii].pathname] = &previous[ii];
+    }
+
+    std::vector<Entry> allEntries(pathnames.size());
+    std::vector<size_t> toRead;
+    for (size_t ii = 0; ii < pathnames.size(); ++ii)
+    {
+        const std::map<std::string, const Entry*>::const_iterator iter =
+                previousEntries.find(pathnames[ii]);
+        if (iter != previousEntries.end() &&
+            iter->second->modified == getModifiedTime(pathnames[ii]))
+        {
+            allEntries[ii] = *iter->second;
+        }
+        else
+        {
+            toRead.push_back(ii);
+        }
+    }
+
+    std::vector<std::string> errors(pathnames.size());
+    IndexContext context(*this, pathnames, toRead, allEntries, errors);
+    const size_t numThreads = std::min(mNumThreads, toRead.size());
+    if (numThreads <= 1)
+    {
+        IndexRunnable(context).run();
+    }
+    else
+    {
+        mt::ThreadGroup threads;
+        for (size_t ii = 0; ii < numThreads; ++ii)
+        {
+            threads.createThread(new IndexRunnable(context));
+        }
+        threads.joinAll();
+    }
+
+    entries.clear();
+    failed.clear();
+    for (size_t ii = 0; ii < pathnames.size(); ++ii)
+    {
+        if (errors[ii].empty())
+        {
+            entries.push_back(allEntries[ii]);
+        }
+        else
+        {
+            failed.push_back(pathnames[ii]);
+            if (mLog)
+            {
+                mLog->warn(Ctxt("Unable to index " + pathnames[ii] + ": " +
+                                errors[ii]));
+            }
+        }
+    }
+
+    return toRead.size();
+}
+
+size_t Indexer::update(const std::string& indexPathname,
+                       const std::vector<std::string>& pathnames,
+                       std::vector<std::string>& failed) const
+{
+    std::vector<Entry> previous;
+    if (sys::OS().exists(indexPathname))
+    {
+        previous = MetadataIndex(indexPathname).getEntries();
+    }
+
+    std::vector<Entry> entries;
+    const size_t numRead = index(pathnames, previous, entries, failed);
+    MetadataIndex::write(entries, indexPathname);
+    return numRead;
+}
+
+std::vector<std::string>
+Indexer::findProducts(const std::vector<std::string>& paths, bool recursive)
+{
+    sys::LogicalPredicate predicate;
+    predicate.addPredicate(new sys::ExtensionPredicate(".nitf"), true);
+    predicate.addPredicate(new sys::ExtensionPredicate(".ntf"), true);
+    predicate.addPredicate(new sys::ExtensionPredicate(".cphd"), true);
+
+    std::vector<std::string> pathnames;
+    std::vector<std::string> directories;
+    sys::OS os;
+    for (size_t ii = 0; ii < paths.size(); ++ii)
+    {
+        if (os.isFile(paths[ii]))
+        {
+            pathnames.push_back(paths[ii]);
+        }
+        else
+        {
+            directories.push_back(paths[ii]);
+        }
+    }
+
+    if (!directories.empty())
+    {
+        const std::vector<std::string> found =
+                sys::FileFinder::search(predicate, directories, recursive);
+        pathnames.insert(pathnames.end(), found.begin(), found.end());
+    }
+
+    std::sort(pathnames.begin(), pathnames.end());
+    pathnames.erase(std::unique(pathnames.begin(), pathnames.end()),
+                    pathnames.end());
+    return pathnames;
+}
+}
+}
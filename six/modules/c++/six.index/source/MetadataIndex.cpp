@@ -0,0 +1,615 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <io/FileOutputStream.h>
+#include <sys/OS.h>
+#include <six/index/MetadataIndex.h>
+
+namespace six
+{
+namespace index
+{
+const size_t MetadataIndex::NODE_SIZE = 16;
+
+/*
+ *  The file is a FileHeader followed by the sections it points to, each
+ *  8-byte aligned.  Everything is in the writer's byte order.
+ */
+struct MetadataIndex::FileHeader
+{
+    char magic[8];
+    sys::Uint32_T version;
+    sys::Uint32_T byteOrder;
+    sys::Uint64_T numEntries;
+    sys::Uint64_T numNodes;
+    sys::Uint64_T recordsOffset;
+    sys::Uint64_T nodesOffset;
+    sys::Uint64_T timesOffset;
+    sys::Uint64_T stringsOffset;
+    sys::Uint64_T stringsSize;
+
+    //! Longest collection, which bounds how far back findTime() looks
+    double maxDuration;
+};
+
+//! An Entry, with its strings as offsets into the string table
+struct MetadataIndex::Record
+{
+    double lat[4];
+    double lon[4];
+    double minLat;
+    double maxLat;
+    double minLon;
+    double maxLon;
+    double startTime;
+    double endTime;
+    sys::Int64_T modified;
+    sys::Uint64_T pathname;
+    sys::Uint64_T productType;
+    sys::Uint64_T sensor;
+    sys::Uint64_T mode;
+    sys::Uint64_T pixelType;
+};
+
+/*
+ *  An R-tree node.  Leaves cover records [first, first + count), and the
+ *  other nodes cover nodes [first, first + count).  The root is node 0.
+ */
+struct MetadataIndex::Node
+{
+    double minLat;
+    double maxLat;
+    double minLon;
+    double maxLon;
+    sys::Uint64_T first;
+    sys::Uint32_T count;
+    sys::Uint32_T isLeaf;
+};
+
+struct MetadataIndex::TimeKey
+{
+    double startTime;
+    sys::Uint64_T index;
+};
+
+namespace
+{
+const char MAGIC[] = "SIXINDEX";
+const sys::Uint32_T FORMAT_VERSION = 1;
+const sys::Uint32_T BYTE_ORDER_MARK = 0x01020304;
+
+struct Box
+{
+    Box() :
+        minLat(std::numeric_limits<double>::max()),
+        maxLat(-std::numeric_limits<double>::max()),
+        minLon(std::numeric_limits<double>::max()),
+        maxLon(-std::numeric_limits<double>::max())
+    {
+    }
+
+    template <typename T>
+    void add(const T& rhs)
+    {
+        minLat = std::min(minLat, rhs.minLat);
+        maxLat = std::max(maxLat, rhs.maxLat);
+        minLon = std::min(minLon, rhs.minLon);
+        maxLon = std::max(maxLon, rhs.maxLon);
+    }
+
+    double centerLat() const
+    {
+        return (minLat + maxLat) / 2;
+    }
+
+    double centerLon() const
+    {
+        return (minLon + maxLon) / 2;
+    }
+
+    double minLat;
+    double maxLat;
+    double minLon;
+    double maxLon;
+};
+
+template <typename T>
+bool contains(const T& box, double lat, double lon)
+{
+    return lat >= box.minLat && lat <= box.maxLat &&
+            lon >= box.minLon && lon <= box.maxLon;
+}
+
+// Something to be packed into the R-tree, and where it came from
+struct Item
+{
+    Box box;
+    size_t index;
+};
+
+bool lessLon(const Item& lhs, const Item& rhs)
+{
+    return lhs.box.centerLon() < rhs.box.centerLon();
+}
+
+bool lessLat(const Item& lhs, const Item& rhs)
+{
+    return lhs.box.centerLat() < rhs.box.centerLat();
+}
+
+bool lessTime(const MetadataIndex::TimeKey& lhs,
+              const MetadataIndex::TimeKey& rhs)
+{
+    return lhs.startTime < rhs.startTime;
+}
+
+/*
+ *  Sort-Tile-Recursive ordering: sort by longitude, cut into vertical
+ *  slices of about sqrt(number of nodes) nodes each, and sort each slice
+ *  by latitude.  Runs of 'nodeSize' items are then packed into one node.
+ */
+void sortTileRecursive(std::vector<Item>& items, size_t nodeSize)
+{
+    const size_t numNodes = (items.size() + nodeSize - 1) / nodeSize;
+    const size_t numSlices = static_cast<size_t>(
+            std::ceil(std::sqrt(static_cast<double>(numNodes))));
+    const size_t sliceSize = numSlices * nodeSize;
+
+    std::sort(items.begin(), items.end(), lessLon);
+    for (size_t start = 0; start < items.size(); start += sliceSize)
+    {
+        std::sort(items.begin() + start,
+                  items.begin() + std::min(start + sliceSize, items.size()),
+                  lessLat);
+    }
+}
+
+// Packs runs of 'nodeSize' items into nodes
+std::vector<MetadataIndex::Node> pack(const std::vector<Item>& items,
+                                      size_t nodeSize,
+                                      bool isLeaf)
+{
+    std::vector<MetadataIndex::Node> nodes;
+    for (size_t start = 0; start < items.size(); start += nodeSize)
+    {
+        const size_t end = std::min(start + nodeSize, items.size());
+        Box box;
+        for (size_t ii = start; ii < end; ++ii)
+        {
+            box.add(items[ii].box);
+        }
+
+        MetadataIndex::Node node;
+        node.minLat = box.minLat;
+        node.maxLat = box.maxLat;
+        node.minLon = box.minLon;
+        node.maxLon = box.maxLon;
+        node.first = start;
+        node.count = static_cast<sys::Uint32_T>(end - start);
+        node.isLeaf = isLeaf ? 1 : 0;
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+size_t align(size_t offset)
+{
+    return (offset + 7) & ~static_cast<size_t>(7);
+}
+
+class StringTable
+{
+public:
+    sys::Uint64_T add(const std::string& str)
+    {
+        const sys::Uint64_T offset = mStrings.size();
+        mStrings.insert(mStrings.end(), str.begin(), str.end());
+        mStrings.push_back('\0');
+        return offset;
+    }
+
+    const std::vector<char>& get() const
+    {
+        return mStrings;
+    }
+
+private:
+    std::vector<char> mStrings;
+};
+}
+
+MetadataIndex::MetadataIndex(const std::string& pathname) :
+    mFile(pathname),
+    mData(mFile.getData()),
+    mSize(mFile.getNumBytes())
+{
+    FileHeader header;
+    if (mSize < sizeof(header))
+    {
+        throw except::Exception(Ctxt(pathname + " is too small to be "
+                                     "a metadata index"));
+    }
+    memcpy(&header, mData, sizeof(header));
+
+    if (memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw except::Exception(Ctxt(pathname +
+                                     " is not a metadata index"));
+    }
+    if (header.byteOrder != BYTE_ORDER_MARK)
+    {
+        throw except::Exception(Ctxt(pathname + " was written on a "
+                                     "machine of the other byte order"));
+    }
+    if (header.version != FORMAT_VERSION)
+    {
+        std::ostringstream ostr;
+        ostr << pathname << " is version " << header.version
+             << " of the metadata index format, not " << FORMAT_VERSION;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    const sys::Uint64_T size = mSize;
+    if (header.recordsOffset + header.numEntries * sizeof(Record) > size ||
+        header.nodesOffset + header.numNodes * sizeof(Node) > size ||
+        header.timesOffset + header.numEntries * sizeof(TimeKey) > size ||
+        header.stringsOffset + header.stringsSize > size ||
+        (header.numEntries > 0 && header.numNodes == 0))
+    {
+        throw except::Exception(Ctxt(pathname + " is truncated"));
+    }
+
+    mNumEntries = static_cast<size_t>(header.numEntries);
+    mNumNodes = static_cast<size_t>(header.numNodes);
+    mMaxDuration = header.maxDuration;
+    mRecords = reinterpret_cast<const Record*>(
+            mData + header.recordsOffset);
+    mNodes = reinterpret_cast<const Node*>(mData + header.nodesOffset);
+    mTimes = reinterpret_cast<const TimeKey*>(
+            mData + header.timesOffset);
+    mStrings = reinterpret_cast<const char*>(
+            mData + header.stringsOffset);
+    mStringsSize = static_cast<size_t>(header.stringsSize);
+}
+
+std::string MetadataIndex::getString(sys::Uint64_T offset) const
+{
+    if (offset >= mStringsSize)
+    {
+        throw except::Exception(Ctxt("Invalid string in metadata index"));
+    }
+
+    const char* const str = mStrings + offset;
+    const void* const end = memchr(str, '\0', mStringsSize - offset);
+    if (!end)
+    {
+        throw except::Exception(Ctxt("Invalid string in metadata index"));
+    }
+    return std::string(str, static_cast<const char*>(end));
+}
+
+std::string MetadataIndex::getPathname(size_t index) const
+{
+    if (index >= mNumEntries)
+    {
+        throw except::Exception(Ctxt("Invalid entry index"));
+    }
+    return getString(mRecords[index].pathname);
+}
+
+Entry MetadataIndex::getEntry(size_t index) const
+{
+    if (index >= mNumEntries)
+    {
+        throw except::Exception(Ctxt("Invalid entry index"));
+    }
+
+    const Record& record(mRecords[index]);
+    Entry entry;
+    entry.pathname = getString(record.pathname);
+    entry.modified = record.modified;
+    entry.productType = getString(record.productType);
+    entry.sensor = getString(record.sensor);
+    entry.mode = getString(record.mode);
+    entry.pixelType = getString(record.pixelType);
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        // Undo the unwrapping
+        const double lon = record.lon[ii];
+        entry.footprint.getCorner(ii) =
+                LatLon(record.lat[ii], lon > 180.0 ? lon - 360.0 : lon);
+    }
+    entry.startTime = record.startTime;
+    entry.endTime = record.endTime;
+    return entry;
+}
+
+std::vector<Entry> MetadataIndex::getEntries() const
+{
+    std::vector<Entry> entries(mNumEntries);
+    for (size_t ii = 0; ii < mNumEntries; ++ii)
+    {
+        entries[ii] = getEntry(ii);
+    }
+    return entries;
+}
+
+void MetadataIndex::findPoint(double lat,
+                              double lon,
+                              std::vector<size_t>& indices) const
+{
+    if (mNumNodes == 0)
+    {
+        return;
+    }
+
+    std::vector<size_t> stack(1, 0);
+    while (!stack.empty())
+    {
+        const Node& node(mNodes[stack.back()]);
+        stack.pop_back();
+        if (!contains(node, lat, lon))
+        {
+            continue;
+        }
+
+        const size_t end = static_cast<size_t>(node.first) + node.count;
+        for (size_t ii = static_cast<size_t>(node.first); ii < end; ++ii)
+        {
+            if (!node.isLeaf)
+            {
+                if (ii < mNumNodes)
+                {
+                    stack.push_back(ii);
+                }
+            }
+            else if (ii < mNumEntries && contains(mRecords[ii], lat, lon) &&
+                     Entry::contains(mRecords[ii].lat, mRecords[ii].lon,
+                                     lat, lon))
+            {
+                indices.push_back(ii);
+            }
+        }
+    }
+}
+
+void MetadataIndex::findPoint(const LatLon& point,
+                              std::vector<size_t>& indices) const
+{
+    indices.clear();
+    findPoint(point.getLat(), point.getLon(), indices);
+    findPoint(point.getLat(), point.getLon() + 360.0, indices);
+
+    // A footprint can only be unwrapped one way, but be sure
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()),
+                  indices.end());
+}
+
+void MetadataIndex::findTime(double startTime,
+                             double endTime,
+                             std::vector<size_t>& indices) const
+{
+    indices.clear();
+
+    // Nothing that started more than the longest collection before the
+    // window can reach into it
+    TimeKey key;
+    key.startTime = startTime - mMaxDuration;
+    const TimeKey* const begin = std::lower_bound(
+            mTimes, mTimes + mNumEntries, key, lessTime);
+    key.startTime = endTime;
+    const TimeKey* const end = std::upper_bound(
+            begin, mTimes + mNumEntries, key, lessTime);
+
+    for (const TimeKey* iter = begin; iter != end; ++iter)
+    {
+        const size_t index = static_cast<size_t>(iter->index);
+        if (index < mNumEntries && mRecords[index].endTime >= startTime)
+        {
+            indices.push_back(index);
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+}
+
+void MetadataIndex::find(const LatLon& point,
+                         double startTime,
+                         double endTime,
+                         std::vector<size_t>& indices) const
+{
+    findPoint(point, indices);
+
+    size_t numMatches(0);
+    for (size_t ii = 0; ii < indices.size(); ++ii)
+    {
+        const Record& record(mRecords[indices[ii]]);
+        if (record.startTime <= endTime && record.endTime >= startTime)
+        {
+            indices[numMatches++] = indices[ii];
+        }
+    }
+    indices.resize(numMatches);
+}
+
+void MetadataIndex::write(const std::vector<Entry>& entries,
+                          const std::string& pathname)
+{
+    StringTable strings;
+
+    // Pack the records into leaves, which puts them in their final order
+    std::vector<Item> items(entries.size());
+    std::vector<Record> unordered(entries.size());
+    for (size_t ii = 0; ii < entries.size(); ++ii)
+    {
+        const Entry& entry(entries[ii]);
+        Record& record(unordered[ii]);
+        entry.getUnwrappedFootprint(record.lat, record.lon);
+
+        Box box;
+        for (size_t jj = 0; jj < LatLonCorners::NUM_CORNERS; ++jj)
+        {
+            box.minLat = std::min(box.minLat, record.lat[jj]);
+            box.maxLat = std::max(box.maxLat, record.lat[jj]);
+            box.minLon = std::min(box.minLon, record.lon[jj]);
+            box.maxLon = std::max(box.maxLon, record.lon[jj]);
+        }
+        record.minLat = box.minLat;
+        record.maxLat = box.maxLat;
+        record.minLon = box.minLon;
+        record.maxLon = box.maxLon;
+        record.startTime = entry.startTime;
+        record.endTime = entry.endTime;
+        record.modified = entry.modified;
+        record.pathname = strings.add(entry.pathname);
+        record.productType = strings.add(entry.productType);
+        record.sensor = strings.add(entry.sensor);
+        record.mode = strings.add(entry.mode);
+        record.pixelType = strings.add(entry.pixelType);
+
+        items[ii].box = box;
+        items[ii].index = ii;
+    }
+
+    sortTileRecursive(items, NODE_SIZE);
+    std::vector<Record> records(entries.size());
+    for (size_t ii = 0; ii < items.size(); ++ii)
+    {
+        records[ii] = unordered[items[ii].index];
+    }
+
+    // Build the levels bottom up, each one pointing into the one below
+    std::vector<std::vector<Node> > levels;
+    if (!items.empty())
+    {
+        levels.push_back(pack(items, NODE_SIZE, true));
+    }
+    while (!levels.empty() && levels.back().size() > 1)
+    {
+        const std::vector<Node> children(levels.back());
+        std::vector<Item> childItems(children.size());
+        for (size_t ii = 0; ii < children.size(); ++ii)
+        {
+            childItems[ii].box.add(children[ii]);
+            childItems[ii].index = ii;
+        }
+        sortTileRecursive(childItems, NODE_SIZE);
+
+        // Put the children in the order their parents will see them
+        for (size_t ii = 0; ii < childItems.size(); ++ii)
+        {
+            levels.back()[ii] = children[childItems[ii].index];
+        }
+        levels.push_back(pack(childItems, NODE_SIZE, false));
+    }
+
+    // Then lay them out root first
+    std::vector<Node> nodes;
+    std::vector<size_t> levelOffsets(levels.size());
+    for (size_t level = levels.size(); level > 0; --level)
+    {
+        levelOffsets[level - 1] = nodes.size();
+        nodes.insert(nodes.end(), levels[level - 1].begin(),
+                     levels[level - 1].end());
+    }
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        for (size_t ii = 0; ii < levels[level].size(); ++ii)
+        {
+            nodes[levelOffsets[level] + ii].first += levelOffsets[level - 1];
+        }
+    }
+
+    std::vector<TimeKey> times(records.size());
+    double maxDuration(0.0);
+    for (size_t ii = 0; ii < records.size(); ++ii)
+    {
+        times[ii].startTime = records[ii].startTime;
+        times[ii].index = ii;
+        maxDuration = std::max(maxDuration,
+                               records[ii].endTime - records[ii].startTime);
+    }
+    std::stable_sort(times.begin(), times.end(), lessTime);
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.numEntries = records.size();
+    header.numNodes = nodes.size();
+    header.recordsOffset = align(sizeof(header));
+    header.nodesOffset =
+            align(header.recordsOffset + records.size() * sizeof(Record));
+    header.timesOffset =
+            align(header.nodesOffset + nodes.size() * sizeof(Node));
+    header.stringsOffset =
+            align(header.timesOffset + times.size() * sizeof(TimeKey));
+    header.stringsSize = strings.get().size();
+    header.maxDuration = maxDuration;
+
+    std::vector<sys::ubyte> buffer(static_cast<size_t>(
+            header.stringsOffset + header.stringsSize));
+    memcpy(&buffer[0], &header, sizeof(header));
+    if (!records.empty())
+    {
+        memcpy(&buffer[header.recordsOffset], &records[0],
+               records.size() * sizeof(Record));
+        memcpy(&buffer[header.nodesOffset], &nodes[0],
+               nodes.size() * sizeof(Node));
+        memcpy(&buffer[header.timesOffset], &times[0],
+               times.size() * sizeof(TimeKey));
+        memcpy(&buffer[header.stringsOffset], &strings.get()[0],
+               strings.get().size());
+    }
+
+    const std::string tempPathname = pathname + ".tmp";
+    {
+        io::FileOutputStream outStream(tempPathname);
+        outStream.write(reinterpret_cast<const sys::byte*>(&buffer[0]),
+                        buffer.size());
+        outStream.close();
+    }
+
+    sys::OS os;
+#if defined(WIN32) || defined(_WIN32)
+    // Windows won't rename over an existing file
+    if (os.exists(pathname))
+    {
+        os.remove(pathname);
+    }
+#endif
+    if (!os.move(tempPathname, pathname))
+    {
+        throw except::Exception(Ctxt("Unable to move " + tempPathname +
+                                     " to " + pathname));
+    }
+}
+}
+}
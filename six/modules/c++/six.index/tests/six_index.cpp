@@ -0,0 +1,171 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <memory>
+
+#include <cli/ArgumentParser.h>
+#include <except/Exception.h>
+#include <logging/Setup.h>
+#include <str/Convert.h>
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <six/Utilities.h>
+#include <import/six/index.h>
+
+namespace
+{
+double parseTime(const std::string& value)
+{
+    return six::toType<six::DateTime>(value).getTimeInMillis() / 1000.0;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        cli::ArgumentParser parser;
+        parser.setDescription(
+                "Builds or updates an index of the SICDs, SIDDs and CPHDs in "
+                "PATHS, then prints the files in the index that contain the "
+                "given point and overlap the given time window.  With no "
+                "PATHS, only queries the index.");
+        parser.addArgument("-r --recursive", "Search directories recursively",
+                           cli::STORE_TRUE, "recursive");
+        parser.addArgument("-t --threads", "Number of files to read at once",
+                           cli::STORE, "threads", "NUM")->setDefault(
+                                   sys::OS().getNumCPUs());
+        parser.addArgument("--lat", "Latitude of the point, in degrees",
+                           cli::STORE, "lat", "DEG");
+        parser.addArgument("--lon", "Longitude of the point, in degrees",
+                           cli::STORE, "lon", "DEG");
+        parser.addArgument("--start",
+                           "Start of the time window (e.g. "
+                           "2014-01-01T00:00:00Z)", cli::STORE, "start",
+                           "TIME");
+        parser.addArgument("--end", "End of the time window", cli::STORE,
+                           "end", "TIME");
+        parser.addArgument("index", "Index file", cli::STORE, "index",
+                           "INDEX", 1, 1);
+        parser.addArgument("paths", "Products or directories to index",
+                           cli::STORE, "paths", "PATHS", 0,
+                           std::numeric_limits<int>::max());
+
+        const std::auto_ptr<cli::Results>
+            options(parser.parse(argc, (const char**) argv));
+
+        const std::string indexPathname(options->get<std::string>("index"));
+        std::auto_ptr<logging::Logger> log =
+                logging::setupLogger(sys::Path::basename(argv[0]), "WARNING",
+                                     "console");
+
+        if (options->hasValue("paths"))
+        {
+            const cli::Value& value(*options->getValue("paths"));
+            std::vector<std::string> paths;
+            for (size_t ii = 0; ii < value.size(); ++ii)
+            {
+                paths.push_back(value.get<std::string>(ii));
+            }
+
+            const std::vector<std::string> pathnames =
+                    six::index::Indexer::findProducts(
+                            paths, options->get<bool>("recursive"));
+
+            const six::index::Indexer indexer(
+                    std::max<size_t>(options->get<size_t>("threads"), 1),
+                    log.get());
+            std::vector<std::string> failed;
+            const size_t numRead =
+                    indexer.update(indexPathname, pathnames, failed);
+            std::cerr << "Read " << numRead << " of " << pathnames.size()
+                      << " files (" << failed.size() << " failed)"
+                      << std::endl;
+        }
+
+        const six::index::MetadataIndex index(indexPathname);
+
+        const bool hasPoint = options->hasValue("lat");
+        if (hasPoint != options->hasValue("lon"))
+        {
+            throw except::Exception(Ctxt("--lat and --lon go together"));
+        }
+        const six::LatLon point(
+                hasPoint ? options->get<double>("lat") : 0.0,
+                hasPoint ? options->get<double>("lon") : 0.0);
+
+        const bool hasTime =
+                options->hasValue("start") || options->hasValue("end");
+        const double startTime = options->hasValue("start") ?
+                parseTime(options->get<std::string>("start")) :
+                -std::numeric_limits<double>::max();
+        const double endTime = options->hasValue("end") ?
+                parseTime(options->get<std::string>("end")) :
+                std::numeric_limits<double>::max();
+
+        std::vector<size_t> indices;
+        if (hasPoint && hasTime)
+        {
+            index.find(point, startTime, endTime, indices);
+        }
+        else if (hasPoint)
+        {
+            index.findPoint(point, indices);
+        }
+        else if (hasTime)
+        {
+            index.findTime(startTime, endTime, indices);
+        }
+        else
+        {
+            for (size_t ii = 0; ii < index.getNumEntries(); ++ii)
+            {
+                indices.push_back(ii);
+            }
+        }
+
+        for (size_t ii = 0; ii < indices.size(); ++ii)
+        {
+            std::cout << index.getPathname(indices[ii]) << "\n";
+        }
+
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
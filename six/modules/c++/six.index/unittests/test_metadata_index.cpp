@@ -0,0 +1,418 @@
+/* =========================================================================
+ * This file is part of six.index-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.index-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+#include <io/TempFile.h>
+#include <mt/CriticalSection.h>
+#include <str/Convert.h>
+#include <sys/Mutex.h>
+#include <sys/OS.h>
+#include <import/six/index.h>
+#include "TestCase.h"
+
+namespace
+{
+// A square footprint 'size' degrees on a side centered at (lat, lon),
+// with longitudes normalized to [-180, 180)
+six::LatLonCorners makeFootprint(double lat, double lon, double size)
+{
+    six::LatLonCorners corners;
+    const double half = size / 2;
+    const double lats[] = {lat + half, lat + half, lat - half, lat - half};
+    const double lons[] = {lon - half, lon + half, lon + half, lon - half};
+    for (size_t ii = 0; ii < six::LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        double cornerLon = lons[ii];
+        if (cornerLon >= 180.0)
+        {
+            cornerLon -= 360.0;
+        }
+        else if (cornerLon < -180.0)
+        {
+            cornerLon += 360.0;
+        }
+        corners.getCorner(ii) = six::LatLon(lats[ii], cornerLon);
+    }
+    return corners;
+}
+
+six::index::Entry makeEntry(size_t index)
+{
+    six::index::Entry entry;
+    entry.pathname = "/data/product" + str::toString(index) + ".nitf";
+    entry.modified = 1000 + index;
+    entry.productType = (index % 3 == 0) ? "CPHD" :
+            (index % 3 == 1) ? "SICD" : "SIDD";
+    entry.sensor = "Sensor" + str::toString(index % 5);
+    entry.mode = "SPOTLIGHT";
+    entry.pixelType = "RE32F_IM32F";
+
+    // Spread them over a grid with some overlapping
+    const double lat = -60.0 + static_cast<double>(index % 13) * 9.0;
+    const double lon = -175.0 + static_cast<double>(index % 29) * 12.5;
+    entry.footprint = makeFootprint(lat, lon, 3.0 + (index % 4) * 2.0);
+
+    entry.startTime = 1.4e9 + static_cast<double>(index) * 600.0;
+    entry.endTime = entry.startTime + 10.0 + (index % 7) * 100.0;
+    return entry;
+}
+
+std::vector<six::index::Entry> makeEntries(size_t numEntries)
+{
+    std::vector<six::index::Entry> entries;
+    for (size_t ii = 0; ii < numEntries; ++ii)
+    {
+        entries.push_back(makeEntry(ii));
+    }
+    return entries;
+}
+
+std::vector<std::string> toPathnames(const six::index::MetadataIndex& index,
+                                     const std::vector<size_t>& indices)
+{
+    std::vector<std::string> pathnames;
+    for (size_t ii = 0; ii < indices.size(); ++ii)
+    {
+        pathnames.push_back(index.getPathname(indices[ii]));
+    }
+    return pathnames;
+}
+
+// Index order isn't entry order, so compare by pathname
+template <typename PredicateT>
+std::vector<std::string> bruteForce(const six::index::MetadataIndex& index,
+                                    const PredicateT& predicate)
+{
+    std::vector<size_t> indices;
+    for (size_t ii = 0; ii < index.getNumEntries(); ++ii)
+    {
+        if (predicate(index.getEntry(ii)))
+        {
+            indices.push_back(ii);
+        }
+    }
+    return toPathnames(index, indices);
+}
+
+struct ContainsPoint
+{
+    ContainsPoint(const six::LatLon& point) :
+        point(point)
+    {
+    }
+
+    bool operator()(const six::index::Entry& entry) const
+    {
+        return entry.contains(point);
+    }
+
+    const six::LatLon point;
+};
+
+struct OverlapsTime
+{
+    OverlapsTime(double startTime, double endTime) :
+        startTime(startTime),
+        endTime(endTime)
+    {
+    }
+
+    bool operator()(const six::index::Entry& entry) const
+    {
+        return entry.overlaps(startTime, endTime);
+    }
+
+    const double startTime;
+    const double endTime;
+};
+
+// Hands out entries without touching the filesystem, counting reads
+class FakeIndexer : public six::index::Indexer
+{
+public:
+    FakeIndexer() :
+        six::index::Indexer(3),
+        numReads(0)
+    {
+    }
+
+    virtual six::index::Entry read(const std::string& pathname) const
+    {
+        const std::map<std::string, six::index::Entry>::const_iterator iter =
+                entries.find(pathname);
+        if (iter == entries.end())
+        {
+            throw except::Exception(Ctxt("No such product " + pathname));
+        }
+
+        mt::CriticalSection<sys::Mutex> crit(&mutex);
+        ++numReads;
+        return iter->second;
+    }
+
+    virtual sys::Off_T getModifiedTime(const std::string& pathname) const
+    {
+        const std::map<std::string, six::index::Entry>::const_iterator iter =
+                entries.find(pathname);
+        return (iter == entries.end()) ? 0 : iter->second.modified;
+    }
+
+    std::map<std::string, six::index::Entry> entries;
+    mutable size_t numReads;
+    mutable sys::Mutex mutex;
+};
+
+TEST_CASE(testRoundTrip)
+{
+    const std::vector<six::index::Entry> entries = makeEntries(100);
+    io::TempFile tempFile;
+    six::index::MetadataIndex::write(entries, tempFile.pathname());
+
+    const six::index::MetadataIndex index(tempFile.pathname());
+    TEST_ASSERT_EQ(index.getNumEntries(), entries.size());
+
+    std::map<std::string, six::index::Entry> expected;
+    for (size_t ii = 0; ii < entries.size(); ++ii)
+    {
+        expected[entries[ii].pathname] = entries[ii];
+    }
+    for (size_t ii = 0; ii < index.getNumEntries(); ++ii)
+    {
+        const six::index::Entry entry = index.getEntry(ii);
+        TEST_ASSERT(entry == expected[entry.pathname]);
+        TEST_ASSERT_EQ(index.getPathname(ii), entry.pathname);
+    }
+}
+
+TEST_CASE(testEmpty)
+{
+    io::TempFile tempFile;
+    six::index::MetadataIndex::write(std::vector<six::index::Entry>(),
+                                     tempFile.pathname());
+
+    const six::index::MetadataIndex index(tempFile.pathname());
+    TEST_ASSERT_EQ(index.getNumEntries(), static_cast<size_t>(0));
+
+    std::vector<size_t> indices;
+    index.findPoint(six::LatLon(0.0, 0.0), indices);
+    TEST_ASSERT(indices.empty());
+    index.findTime(0.0, 1e10, indices);
+    TEST_ASSERT(indices.empty());
+}
+
+TEST_CASE(testFindPoint)
+{
+    io::TempFile tempFile;
+    six::index::MetadataIndex::write(makeEntries(1000), tempFile.pathname());
+    const six::index::MetadataIndex index(tempFile.pathname());
+
+    size_t numFound(0);
+    for (double lat = -70.0; lat <= 70.0; lat += 3.7)
+    {
+        for (double lon = -180.0; lon < 180.0; lon += 4.3)
+        {
+            const six::LatLon point(lat, lon);
+            std::vector<size_t> indices;
+            index.findPoint(point, indices);
+
+            TEST_ASSERT(toPathnames(index, indices) ==
+                        bruteForce(index, ContainsPoint(point)));
+            numFound += indices.size();
+        }
+    }
+
+    // Make sure we actually exercised something
+    TEST_ASSERT(numFound > 0);
+}
+
+TEST_CASE(testAntimeridian)
+{
+    std::vector<six::index::Entry> entries = makeEntries(50);
+    six::index::Entry crossing = makeEntry(50);
+    crossing.pathname = "/data/crossing.nitf";
+    crossing.footprint = makeFootprint(10.0, 180.0, 4.0);
+    entries.push_back(crossing);
+
+    io::TempFile tempFile;
+    six::index::MetadataIndex::write(entries, tempFile.pathname());
+    const six::index::MetadataIndex index(tempFile.pathname());
+
+    const double lons[] = {179.0, -179.0, 180.0, -180.0};
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        std::vector<size_t> indices;
+        index.findPoint(six::LatLon(10.0, lons[ii]), indices);
+        const std::vector<std::string> pathnames =
+                toPathnames(index, indices);
+        TEST_ASSERT(std::find(pathnames.begin(), pathnames.end(),
+                              crossing.pathname) != pathnames.end());
+    }
+
+    // Nowhere near the other side of the world
+    std::vector<size_t> indices;
+    index.findPoint(six::LatLon(10.0, 0.0), indices);
+    const std::vector<std::string> pathnames = toPathnames(index, indices);
+    TEST_ASSERT(std::find(pathnames.begin(), pathnames.end(),
+                          crossing.pathname) == pathnames.end());
+}
+
+TEST_CASE(testFindTime)
+{
+    io::TempFile tempFile;
+    six::index::MetadataIndex::write(makeEntries(500), tempFile.pathname());
+    const six::index::MetadataIndex index(tempFile.pathname());
+
+    for (double start = 1.4e9 - 1000.0; start < 1.4e9 + 310000.0;
+         start += 7777.0)
+    {
+        const double windows[] = {0.0, 50.0, 2000.0, 60000.0};
+        for (size_t ii = 0; ii < 4; ++ii)
+        {
+            const double end = start + windows[ii];
+            std::vector<size_t> indices;
+            index.findTime(start, end, indices);
+            TEST_ASSERT(toPathnames(index, indices) ==
+                        bruteForce(index, OverlapsTime(start, end)));
+        }
+    }
+}
+
+TEST_CASE(testFind)
+{
+    io::TempFile tempFile;
+    six::index::MetadataIndex::write(makeEntries(1000), tempFile.pathname());
+    const six::index::MetadataIndex index(tempFile.pathname());
+
+    const six::LatLon point(-60.0 + 9.0 * 4, -175.0 + 12.5 * 7);
+    const double start = 1.4e9;
+    const double end = 1.4e9 + 300000.0;
+
+    std::vector<size_t> pointIndices;
+    index.findPoint(point, pointIndices);
+    std::vector<size_t> timeIndices;
+    index.findTime(start, end, timeIndices);
+
+    std::vector<size_t> expected;
+    std::set_intersection(pointIndices.begin(), pointIndices.end(),
+                          timeIndices.begin(), timeIndices.end(),
+                          std::back_inserter(expected));
+    TEST_ASSERT(!expected.empty());
+    TEST_ASSERT(expected.size() < pointIndices.size());
+
+    std::vector<size_t> indices;
+    index.find(point, start, end, indices);
+    TEST_ASSERT(indices == expected);
+}
+
+TEST_CASE(testIncrementalUpdate)
+{
+    FakeIndexer indexer;
+    std::vector<std::string> pathnames;
+    for (size_t ii = 0; ii < 40; ++ii)
+    {
+        const six::index::Entry entry = makeEntry(ii);
+        indexer.entries[entry.pathname] = entry;
+        pathnames.push_back(entry.pathname);
+    }
+
+    // Start without an index so that update() has to create it
+    io::TempFile tempFile;
+    sys::OS().remove(tempFile.pathname());
+
+    std::vector<std::string> failed;
+    TEST_ASSERT_EQ(indexer.update(tempFile.pathname(), pathnames, failed),
+                   pathnames.size());
+    TEST_ASSERT(failed.empty());
+    TEST_ASSERT_EQ(indexer.numReads, pathnames.size());
+
+    // Nothing changed, so nothing should be read
+    indexer.numReads = 0;
+    TEST_ASSERT_EQ(indexer.update(tempFile.pathname(), pathnames, failed),
+                   static_cast<size_t>(0));
+    TEST_ASSERT_EQ(indexer.numReads, static_cast<size_t>(0));
+
+    // Touch one, drop one and add one that can't be read
+    indexer.entries[pathnames[3]].modified += 1;
+    indexer.entries[pathnames[3]].sensor = "Updated";
+    pathnames.erase(pathnames.begin() + 7);
+    pathnames.push_back("/data/missing.nitf");
+
+    TEST_ASSERT_EQ(indexer.update(tempFile.pathname(), pathnames, failed),
+                   static_cast<size_t>(2));
+    TEST_ASSERT_EQ(indexer.numReads, static_cast<size_t>(1));
+    TEST_ASSERT_EQ(failed.size(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(failed[0], std::string("/data/missing.nitf"));
+
+    const six::index::MetadataIndex index(tempFile.pathname());
+    TEST_ASSERT_EQ(index.getNumEntries(), pathnames.size() - 1);
+    for (size_t ii = 0; ii < index.getNumEntries(); ++ii)
+    {
+        const six::index::Entry entry = index.getEntry(ii);
+        TEST_ASSERT(entry == indexer.entries[entry.pathname]);
+    }
+}
+
+TEST_CASE(testBadFile)
+{
+    io::TempFile tempFile;
+    {
+        std::ofstream ofs(tempFile.pathname().c_str(), std::ios::binary);
+        ofs << "This is not an index";
+    }
+    TEST_EXCEPTION(six::index::MetadataIndex(tempFile.pathname()));
+
+    // A real index with its tail cut off
+    io::TempFile goodFile;
+    six::index::MetadataIndex::write(makeEntries(20), goodFile.pathname());
+    std::vector<char> contents;
+    {
+        std::ifstream ifs(goodFile.pathname().c_str(), std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(ifs),
+                        std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream ofs(tempFile.pathname().c_str(), std::ios::binary);
+        ofs.write(&contents[0], contents.size() / 2);
+    }
+    TEST_EXCEPTION(six::index::MetadataIndex(tempFile.pathname()));
+
+    TEST_EXCEPTION(six::index::MetadataIndex("/no/such/index"));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testRoundTrip);
+    TEST_CHECK(testEmpty);
+    TEST_CHECK(testFindPoint);
+    TEST_CHECK(testAntimeridian);
+    TEST_CHECK(testFindTime);
+    TEST_CHECK(testFind);
+    TEST_CHECK(testIncrementalUpdate);
+    TEST_CHECK(testBadFile);
+    return 0;
+}
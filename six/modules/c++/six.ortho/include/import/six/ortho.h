@@ -0,0 +1,31 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __IMPORT_SIX_ORTHO_H__
+#define __IMPORT_SIX_ORTHO_H__
+
+#include "six/ortho/HeightModel.h"
+#include "six/ortho/InputImage.h"
+#include "six/ortho/InterpolationKernel.h"
+#include "six/ortho/OrthoResampler.h"
+#include "six/ortho/OutputGrid.h"
+
+#endif
@@ -0,0 +1,115 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_ORTHO_HEIGHT_MODEL_H__
+#define __SIX_ORTHO_HEIGHT_MODEL_H__
+
+#include <scene/GridECEFTransform.h>
+#include <scene/Types.h>
+
+namespace six
+{
+namespace ortho
+{
+/*!
+ *  \class HeightModel
+ *  \brief Supplies the surface that output pixels are projected onto
+ *
+ *  Derive from this to orthorectify against a DEM.  getHeight() is called
+ *  from every thread the resampler runs, so it must be safe to call
+ *  concurrently.
+ */
+class HeightModel
+{
+public:
+    virtual ~HeightModel()
+    {
+    }
+
+    /*!
+     *  \param lat Latitude in degrees
+     *  \param lon Longitude in degrees
+     *
+     *  \return Height in meters above the WGS-84 ellipsoid
+     */
+    virtual double getHeight(double lat, double lon) const = 0;
+};
+
+/*!
+ *  \class ConstantHeightModel
+ *  \brief The same height everywhere
+ */
+class ConstantHeightModel : public HeightModel
+{
+public:
+    ConstantHeightModel(double height = 0.0) :
+        mHeight(height)
+    {
+    }
+
+    virtual double getHeight(double /*lat*/, double /*lon*/) const
+    {
+        return mHeight;
+    }
+
+private:
+    const double mHeight;
+};
+
+/*!
+ *  \class HeightModelGridTransform
+ *  \brief Moves the points of a grid onto a HeightModel's surface
+ *
+ *  rowColToECEF() keeps the latitude and longitude of the grid's point and
+ *  replaces its altitude with the model's height there.  ecefToRowCol()
+ *  is the grid's, so it only inverts rowColToECEF() to the extent that the
+ *  grid ignores altitude.
+ */
+class HeightModelGridTransform : public scene::GridECEFTransform
+{
+public:
+    //! Both must outlive this
+    HeightModelGridTransform(const scene::GridECEFTransform& gridTransform,
+                             const HeightModel& heightModel) :
+        mGridTransform(gridTransform),
+        mHeightModel(heightModel)
+    {
+    }
+
+    using scene::GridECEFTransform::rowColToECEF;
+
+    virtual scene::Vector3
+    rowColToECEF(const types::RowCol<double>& pixel) const;
+
+    virtual types::RowCol<double>
+    ecefToRowCol(const scene::Vector3& p3) const
+    {
+        return mGridTransform.ecefToRowCol(p3);
+    }
+
+private:
+    const scene::GridECEFTransform& mGridTransform;
+    const HeightModel& mHeightModel;
+};
+}
+}
+
+#endif
@@ -0,0 +1,118 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_ORTHO_INPUT_IMAGE_H__
+#define __SIX_ORTHO_INPUT_IMAGE_H__
+
+#include <types/RowCol.h>
+#include <six/NITFReadControl.h>
+
+namespace six
+{
+namespace ortho
+{
+/*!
+ *  \class InputImage
+ *  \brief Where the resampler gets the pixels of the image being
+ *  orthorectified
+ *
+ *  Pixels are read as detected floats, one rectangle at a time.  read() is
+ *  only ever called from one thread at a time.
+ */
+class InputImage
+{
+public:
+    virtual ~InputImage()
+    {
+    }
+
+    virtual types::RowCol<size_t> getDims() const = 0;
+
+    /*!
+     *  \param offset First row and col to read
+     *  \param dims Number of rows and cols to read
+     *  \param[out] buffer Receives dims.area() pixels, row-major
+     */
+    virtual void read(const types::RowCol<size_t>& offset,
+                      const types::RowCol<size_t>& dims,
+                      float* buffer) = 0;
+};
+
+/*!
+ *  \class BufferInputImage
+ *  \brief An image that's already in memory
+ */
+class BufferInputImage : public InputImage
+{
+public:
+    //! 'pixels' is row-major and must outlive this
+    BufferInputImage(const float* pixels, const types::RowCol<size_t>& dims) :
+        mPixels(pixels),
+        mDims(dims)
+    {
+    }
+
+    virtual types::RowCol<size_t> getDims() const
+    {
+        return mDims;
+    }
+
+    virtual void read(const types::RowCol<size_t>& offset,
+                      const types::RowCol<size_t>& dims,
+                      float* buffer);
+
+private:
+    const float* const mPixels;
+    const types::RowCol<size_t> mDims;
+};
+
+/*!
+ *  \class NITFInputImage
+ *  \brief An image in a SICD or SIDD
+ *
+ *  SICD pixels (RE32F_IM32F or RE16I_IM16I) are read as their magnitude.
+ *  SIDD pixels (MONO8I or MONO16I) are read as is.
+ */
+class NITFInputImage : public InputImage
+{
+public:
+    //! 'reader' must be loaded and outlive this
+    NITFInputImage(NITFReadControl& reader, size_t imageNumber = 0);
+
+    virtual types::RowCol<size_t> getDims() const
+    {
+        return mDims;
+    }
+
+    virtual void read(const types::RowCol<size_t>& offset,
+                      const types::RowCol<size_t>& dims,
+                      float* buffer);
+
+private:
+    NITFReadControl& mReader;
+    const size_t mImageNumber;
+    PixelType mPixelType;
+    types::RowCol<size_t> mDims;
+};
+}
+}
+
+#endif
@@ -0,0 +1,127 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_ORTHO_INTERPOLATION_KERNEL_H__
+#define __SIX_ORTHO_INTERPOLATION_KERNEL_H__
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+
+namespace six
+{
+namespace ortho
+{
+/*!
+ *  \class InterpolationKernel
+ *  \brief Separable 1D interpolation weights, tabulated ahead of time
+ *
+ *  The weights for a fractional position depend only on how far it is past
+ *  the sample before it, so they're computed once for numPhases evenly
+ *  spaced offsets and looked up from then on.  Each set of weights is
+ *  normalized to sum to 1 so that flat regions stay flat.
+ */
+class InterpolationKernel
+{
+public:
+    enum Type
+    {
+        //! Closest sample (1 tap)
+        NEAREST,
+
+        //! Linear between the two surrounding samples (2 taps)
+        BILINEAR,
+
+        //! Lanczos windowed sinc (an even number of taps)
+        SINC
+    };
+
+    static const size_t DEFAULT_SINC_TAPS;
+    static const size_t DEFAULT_NUM_PHASES;
+
+    /*!
+     *  \param type Kernel to tabulate
+     *  \param numTaps Number of taps for SINC.  Must be even and at
+     *  least 2.  Ignored for the others.
+     *  \param numPhases Number of offsets between samples to tabulate
+     */
+    InterpolationKernel(Type type,
+                        size_t numTaps = DEFAULT_SINC_TAPS,
+                        size_t numPhases = DEFAULT_NUM_PHASES);
+
+    //! Parses "NEAREST", "BILINEAR" or "SINC"
+    static Type toType(const std::string& name);
+
+    Type getType() const
+    {
+        return mType;
+    }
+
+    size_t getNumTaps() const
+    {
+        return mNumTaps;
+    }
+
+    //! \return How many samples past a position the kernel reaches
+    size_t getMargin() const
+    {
+        return mNumTaps / 2;
+    }
+
+    /*!
+     *  Looks up the weights for interpolating at 'position'
+     *
+     *  \param position Position to interpolate at, in samples
+     *  \param[out] first Sample the first weight applies to.  Weight ii
+     *  applies to sample first + ii.
+     *
+     *  \return getNumTaps() weights
+     */
+    const float* getWeights(double position, sys::SSize_T& first) const
+    {
+        // Even kernels start at the sample before the position and odd ones
+        // are centered on the closest sample
+        const double base = std::floor(position + mBias);
+        first = static_cast<sys::SSize_T>(base) - mHalfTaps;
+        const size_t phase = static_cast<size_t>(
+                (position - base + mBias) * mNumPhases + 0.5);
+        return &mWeights[phase * mNumTaps];
+    }
+
+private:
+    double computeWeight(double distance) const;
+
+private:
+    const Type mType;
+    const size_t mNumTaps;
+    const size_t mNumPhases;
+    const sys::SSize_T mHalfTaps;
+    const double mBias;
+
+    // (numPhases + 1) x numTaps
+    std::vector<float> mWeights;
+};
+}
+}
+
+#endif
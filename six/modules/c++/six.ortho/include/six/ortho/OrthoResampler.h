@@ -0,0 +1,223 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_ORTHO_ORTHO_RESAMPLER_H__
+#define __SIX_ORTHO_ORTHO_RESAMPLER_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <scene/GridECEFTransform.h>
+#include <scene/ProjectionModel.h>
+#include <six/Data.h>
+#include <six/NITFWriteControl.h>
+#include <six/sidd/DerivedData.h>
+#include <six/ortho/HeightModel.h>
+#include <six/ortho/InputImage.h>
+#include <six/ortho/InterpolationKernel.h>
+#include <six/ortho/OutputGrid.h>
+
+namespace six
+{
+namespace ortho
+{
+/*!
+ *  \class OrthoResampler
+ *  \brief Orthorectifies a SICD or SIDD onto an OutputGrid
+ *
+ *  Each output pixel is placed on the HeightModel's surface, projected into
+ *  the input image with the input's projection model, and interpolated
+ *  there with an InterpolationKernel.  Output pixels that land outside the
+ *  input image are 0.
+ *
+ *  The output is processed a strip of tiles at a time.  The tiles of a strip
+ *  are projected in parallel, the part of the input image the whole strip
+ *  needs is read in one go, and then the tiles are interpolated in
+ *  parallel.  Only a strip's worth of input and output is ever held in
+ *  memory, so save() streams arbitrarily large products.
+ *
+ *  The input may be a SICD, or a SIDD with a PLANE or GEOGRAPHIC
+ *  projection.
+ */
+class OrthoResampler
+{
+public:
+    /*!
+     *  How output pixels are projected into the input image.  EXACT calls
+     *  sceneToImage() for every pixel.  POLYNOMIAL samples each tile with
+     *  ProjectionPolynomialFitter, fits polynomials from output to input
+     *  pixels, and evaluates those instead, which is much faster and
+     *  accurate to a small fraction of a pixel as long as the surface is
+     *  smooth across a tile.
+     */
+    enum ProjectionMethod
+    {
+        EXACT,
+        POLYNOMIAL
+    };
+
+    static const size_t DEFAULT_TILE_SIZE;
+    static const size_t DEFAULT_POLY_ORDER;
+
+    /*!
+     *  Projects the corners of a SICD or SIDD onto a HeightModel's surface.
+     *  Unlike the input's own image corners, these are consistent with how
+     *  the resampler projects pixels, so they're the footprint to build an
+     *  OutputGrid from.
+     */
+    static LatLonCorners getInputFootprint(const Data& inputData,
+                                           const HeightModel& heightModel);
+
+    //! Height above the ellipsoid of a SICD's SCP or a SIDD's reference point
+    static double getReferenceHeight(const Data& inputData);
+
+    /*!
+     *  \param inputData The SICD or SIDD being orthorectified
+     *  \param inputImage Its pixels.  Must outlive this.
+     *  \param outputGrid Grid to orthorectify onto
+     *  \param kernel Kernel to interpolate the input with
+     *  \param heightModel Surface to project onto.  Must outlive this.
+     *  \param numThreads Number of threads to project and interpolate with
+     */
+    OrthoResampler(const Data& inputData,
+                   InputImage& inputImage,
+                   const OutputGrid& outputGrid,
+                   const InterpolationKernel& kernel,
+                   const HeightModel& heightModel,
+                   size_t numThreads = 1);
+
+    /*!
+     *  Defaults to POLYNOMIAL with DEFAULT_POLY_ORDER
+     *
+     *  \param method How to project output pixels into the input
+     *  \param polyOrder Order of the polynomials fit to each tile for
+     *  POLYNOMIAL.  Also the order of the output's time COA polynomial.
+     */
+    void setProjectionMethod(ProjectionMethod method,
+                             size_t polyOrder = DEFAULT_POLY_ORDER);
+
+    //! Sets the number of rows and cols in a tile.  Must be at least 2.
+    void setTileSize(size_t tileSize);
+
+    const OutputGrid& getOutputGrid() const
+    {
+        return mOutputGrid;
+    }
+
+
+    /*!
+     *  Finds where a block of output pixels lands in the input image
+     *
+     *  \param start First output row and col
+     *  \param dims Number of output rows and cols
+     *  \param[out] inputPixels Receives dims.area() input pixel locations,
+     *  row-major.  These are 0-based within the input image.
+     */
+    void mapToInput(const types::RowCol<size_t>& start,
+                    const types::RowCol<size_t>& dims,
+                    types::RowCol<double>* inputPixels) const;
+
+    /*!
+     *  Orthorectifies a block of output rows
+     *
+     *  \param startRow First output row
+     *  \param numRows Number of output rows
+     *  \param[out] output Receives numRows full output rows
+     */
+    void resample(size_t startRow, size_t numRows, float* output);
+
+    /*!
+     *  Builds the SIDD metadata for the output: its Measurement (projection,
+     *  time COA polynomial, ARP polynomial and footprint) and
+     *  GeographicAndTarget footprint from the output grid, and its
+     *  ExploitationFeatures and ProductCreation from the input.  Callers
+     *  are free to fill in more before passing it to save().
+     *
+     *  \param pixelType MONO8I or MONO16I
+     */
+    std::auto_ptr<sidd::DerivedData> createDerivedData(
+            PixelType pixelType) const;
+
+    /*!
+     *  Orthorectifies the whole output grid, streaming it through 'writer'
+     *  a strip at a time.  Pixels are multiplied by 'scale', rounded, and
+     *  clamped to the range of the pixel type.
+     *
+     *  \param data Metadata for the output, typically from
+     *  createDerivedData()
+     *  \param scale Amount to multiply pixels by
+     *  \param writer Writer to save with.  Its XML registry must know how
+     *  to write SIDDs.  Any options should be set beforehand.
+     *  \param pathname File to write
+     *  \param schemaPaths Schemas to validate the XML against
+     */
+    void save(std::auto_ptr<sidd::DerivedData> data,
+              double scale,
+              NITFWriteControl& writer,
+              const std::string& pathname,
+              const std::vector<std::string>& schemaPaths =
+                      std::vector<std::string>());
+
+private:
+    // Converts meters (or arc seconds) in the input's image grid to 0-based
+    // input pixels
+    types::RowCol<double> toInputPixel(
+            const types::RowCol<double>& imageGridPoint) const
+    {
+        return types::RowCol<double>(
+                imageGridPoint.row / mInputSpacing.row + mInputReference.row,
+                imageGridPoint.col / mInputSpacing.col + mInputReference.col);
+    }
+
+    void mapExact(const types::RowCol<size_t>& start,
+                  const types::RowCol<size_t>& dims,
+                  types::RowCol<double>* inputPixels) const;
+
+    void mapPolynomial(const types::RowCol<size_t>& start,
+                       const types::RowCol<size_t>& dims,
+                       types::RowCol<double>* inputPixels) const;
+
+    void resampleStrip(size_t startRow, size_t numRows, float* output);
+
+private:
+    const std::auto_ptr<const Data> mInputData;
+    InputImage& mInputImage;
+    const types::RowCol<size_t> mInputDims;
+    std::auto_ptr<const scene::ProjectionModel> mProjModel;
+    types::RowCol<double> mInputSpacing;
+    types::RowCol<double> mInputReference;
+    PolyXYZ mArpPoly;
+
+    const OutputGrid mOutputGrid;
+    const std::auto_ptr<const scene::GridECEFTransform> mGridTransform;
+    const HeightModelGridTransform mSurfaceTransform;
+    const InterpolationKernel mKernel;
+    const size_t mNumThreads;
+
+    ProjectionMethod mProjectionMethod;
+    size_t mPolyOrder;
+    size_t mTileSize;
+};
+}
+}
+
+#endif
@@ -0,0 +1,167 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_ORTHO_OUTPUT_GRID_H__
+#define __SIX_ORTHO_OUTPUT_GRID_H__
+
+#include <memory>
+
+#include <scene/GridECEFTransform.h>
+#include <six/Enums.h>
+#include <six/Types.h>
+
+namespace six
+{
+namespace ortho
+{
+/*!
+ *  \class OutputGrid
+ *  \brief The grid an image is orthorectified onto
+ *
+ *  This is either a plane (a SIDD PGD) or a grid of latitudes and
+ *  longitudes (a SIDD GGD).  Either way, the reference pixel is where the
+ *  grid touches its reference point, and rows and cols increase away from
+ *  it by the sample spacing.
+ */
+class OutputGrid
+{
+public:
+    /*!
+     *  A planar grid
+     *
+     *  \param dims Number of rows and cols
+     *  \param sampleSpacing Meters between rows and between cols
+     *  \param referencePixel Pixel at the reference point
+     *  \param referencePoint ECEF point the plane passes through
+     *  \param rowUnitVector Direction rows increase in
+     *  \param colUnitVector Direction cols increase in
+     */
+    OutputGrid(const types::RowCol<size_t>& dims,
+               const types::RowCol<double>& sampleSpacing,
+               const types::RowCol<double>& referencePixel,
+               const Vector3& referencePoint,
+               const Vector3& rowUnitVector,
+               const Vector3& colUnitVector);
+
+    /*!
+     *  A geographic grid.  Rows run south and cols run east.  Every pixel
+     *  has the reference point's altitude.
+     *
+     *  \param dims Number of rows and cols
+     *  \param sampleSpacing Arc seconds of latitude between rows and of
+     *  longitude between cols
+     *  \param referencePixel Pixel at the reference point
+     *  \param referencePoint Reference point
+     */
+    OutputGrid(const types::RowCol<size_t>& dims,
+               const types::RowCol<double>& sampleSpacing,
+               const types::RowCol<double>& referencePixel,
+               const LatLonAlt& referencePoint);
+
+    /*!
+     *  A north-up planar grid tangent to the ellipsoid at the center of
+     *  'footprint', just big enough to hold it
+     *
+     *  \param footprint Area to cover, such as a SICD's image corners
+     *  \param height Height of the plane in meters above the ellipsoid
+     *  \param sampleSpacing Meters between rows and between cols
+     */
+    static OutputGrid planar(const LatLonCorners& footprint,
+                             double height,
+                             const types::RowCol<double>& sampleSpacing);
+
+    /*!
+     *  A geographic grid just big enough to hold 'footprint'
+     *
+     *  \param footprint Area to cover, such as a SICD's image corners
+     *  \param height Altitude of the grid in meters above the ellipsoid
+     *  \param sampleSpacing Arc seconds of latitude between rows and of
+     *  longitude between cols
+     */
+    static OutputGrid geographic(const LatLonCorners& footprint,
+                                 double height,
+                                 const types::RowCol<double>& sampleSpacing);
+
+    //! \return PLANE or GEOGRAPHIC
+    ProjectionType getProjectionType() const
+    {
+        return mProjectionType;
+    }
+
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
+    //! \return Meters for planar grids, arc seconds for geographic ones
+    const types::RowCol<double>& getSampleSpacing() const
+    {
+        return mSampleSpacing;
+    }
+
+    const types::RowCol<double>& getReferencePixel() const
+    {
+        return mReferencePixel;
+    }
+
+    //! \return The reference point in ECEF
+    const Vector3& getReferencePoint() const
+    {
+        return mReferencePoint;
+    }
+
+    /*!
+     *  \return The direction rows increase in at the reference point.  For
+     *  geographic grids this is south.
+     */
+    const Vector3& getRowUnitVector() const
+    {
+        return mRowUnitVector;
+    }
+
+    /*!
+     *  \return The direction cols increase in at the reference point.  For
+     *  geographic grids this is east.
+     */
+    const Vector3& getColUnitVector() const
+    {
+        return mColUnitVector;
+    }
+
+    //! \return A transform between the grid's pixels and ECEF
+    std::auto_ptr<scene::GridECEFTransform> getGridTransform() const;
+
+    //! \return The latitudes and longitudes of the corner pixels
+    LatLonCorners getCorners() const;
+
+private:
+    ProjectionType mProjectionType;
+    types::RowCol<size_t> mDims;
+    types::RowCol<double> mSampleSpacing;
+    types::RowCol<double> mReferencePixel;
+    Vector3 mReferencePoint;
+    Vector3 mRowUnitVector;
+    Vector3 mColUnitVector;
+};
+}
+}
+
+#endif
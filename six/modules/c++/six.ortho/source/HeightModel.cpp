@@ -0,0 +1,38 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <scene/Utilities.h>
+#include <six/ortho/HeightModel.h>
+
+namespace six
+{
+namespace ortho
+{
+scene::Vector3 HeightModelGridTransform::rowColToECEF(
+        const types::RowCol<double>& pixel) const
+{
+    scene::LatLonAlt lla = scene::Utilities::ecefToLatLon(
+            mGridTransform.rowColToECEF(pixel));
+    lla.setAlt(mHeightModel.getHeight(lla.getLat(), lla.getLon()));
+    return scene::Utilities::latLonToECEF(lla);
+}
+}
+}
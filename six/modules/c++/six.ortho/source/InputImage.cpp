@@ -0,0 +1,127 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include <except/Exception.h>
+#include <sys/Conf.h>
+#include <six/Region.h>
+#include <six/ortho/InputImage.h>
+
+namespace
+{
+void checkRegion(const types::RowCol<size_t>& offset,
+                 const types::RowCol<size_t>& dims,
+                 const types::RowCol<size_t>& imageDims)
+{
+    if (offset.row + dims.row > imageDims.row ||
+        offset.col + dims.col > imageDims.col)
+    {
+        throw except::Exception(Ctxt("Region extends past the image"));
+    }
+}
+
+six::Region buildRegion(const types::RowCol<size_t>& offset,
+                        const types::RowCol<size_t>& dims,
+                        void* buffer)
+{
+    six::Region region;
+    region.setStartRow(offset.row);
+    region.setStartCol(offset.col);
+    region.setNumRows(dims.row);
+    region.setNumCols(dims.col);
+    region.setBuffer(static_cast<six::UByte*>(buffer));
+    return region;
+}
+}
+
+namespace six
+{
+namespace ortho
+{
+void BufferInputImage::read(const types::RowCol<size_t>& offset,
+                            const types::RowCol<size_t>& dims,
+                            float* buffer)
+{
+    checkRegion(offset, dims, mDims);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        const float* const input =
+                mPixels + (offset.row + row) * mDims.col + offset.col;
+        std::copy(input, input + dims.col, buffer + row * dims.col);
+    }
+}
+
+NITFInputImage::NITFInputImage(NITFReadControl& reader, size_t imageNumber) :
+    mReader(reader),
+    mImageNumber(imageNumber)
+{
+    const Data& data(*mReader.getContainer()->getData(mImageNumber));
+    mPixelType = data.getPixelType();
+    mDims.row = data.getNumRows();
+    mDims.col = data.getNumCols();
+
+    if (mPixelType != PixelType::RE32F_IM32F &&
+        mPixelType != PixelType::RE16I_IM16I &&
+        mPixelType != PixelType::MONO8I &&
+        mPixelType != PixelType::MONO16I)
+    {
+        throw except::Exception(Ctxt(
+                "Can't orthorectify " + mPixelType.toString() + " pixels"));
+    }
+}
+
+void NITFInputImage::read(const types::RowCol<size_t>& offset,
+                          const types::RowCol<size_t>& dims,
+                          float* buffer)
+{
+    checkRegion(offset, dims, mDims);
+    const size_t numPixels = dims.area();
+
+    if (mPixelType == PixelType::MONO8I)
+    {
+        std::vector<sys::ubyte> pixels(numPixels);
+        Region region = buildRegion(offset, dims, &pixels[0]);
+        mReader.interleaved(region, mImageNumber);
+        std::copy(pixels.begin(), pixels.end(), buffer);
+    }
+    else if (mPixelType == PixelType::MONO16I)
+    {
+        std::vector<sys::Uint16_T> pixels(numPixels);
+        Region region = buildRegion(offset, dims, &pixels[0]);
+        mReader.interleaved(region, mImageNumber);
+        std::copy(pixels.begin(), pixels.end(), buffer);
+    }
+    else
+    {
+        std::vector<std::complex<float> > pixels(numPixels);
+        Region region = buildRegion(offset, dims, NULL);
+        mReader.interleavedComplex(region, mImageNumber, &pixels[0]);
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            buffer[ii] = std::abs(pixels[ii]);
+        }
+    }
+}
+}
+}
@@ -0,0 +1,152 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <str/Manip.h>
+#include <six/ortho/InterpolationKernel.h>
+
+namespace
+{
+size_t getNumTaps(six::ortho::InterpolationKernel::Type type, size_t numTaps)
+{
+    switch (type)
+    {
+    case six::ortho::InterpolationKernel::NEAREST:
+        return 1;
+    case six::ortho::InterpolationKernel::BILINEAR:
+        return 2;
+    case six::ortho::InterpolationKernel::SINC:
+        if (numTaps < 2 || numTaps % 2 != 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Sinc kernels need an even number of taps, not " +
+                    str::toString(numTaps)));
+        }
+        return numTaps;
+    default:
+        throw except::Exception(Ctxt("Invalid interpolation kernel"));
+    }
+}
+
+double sinc(double x)
+{
+    if (x == 0.0)
+    {
+        return 1.0;
+    }
+    const double piX = M_PI * x;
+    return std::sin(piX) / piX;
+}
+}
+
+namespace six
+{
+namespace ortho
+{
+const size_t InterpolationKernel::DEFAULT_SINC_TAPS = 8;
+const size_t InterpolationKernel::DEFAULT_NUM_PHASES = 1024;
+
+InterpolationKernel::InterpolationKernel(Type type,
+                                         size_t numTaps,
+                                         size_t numPhases) :
+    mType(type),
+    mNumTaps(::getNumTaps(type, numTaps)),
+    mNumPhases(numPhases),
+    mHalfTaps(static_cast<sys::SSize_T>((mNumTaps - 1) / 2)),
+    mBias(mNumTaps % 2 == 0 ? 0.0 : 0.5),
+    mWeights((numPhases + 1) * mNumTaps)
+{
+    if (mNumPhases == 0)
+    {
+        throw except::Exception(Ctxt("Need at least one phase"));
+    }
+
+    for (size_t phase = 0; phase <= mNumPhases; ++phase)
+    {
+        // How far the position is past the sample the kernel is built
+        // around
+        const double offset =
+                static_cast<double>(phase) / mNumPhases - mBias;
+
+        float* const weights = &mWeights[phase * mNumTaps];
+        double sum(0.0);
+        for (size_t tap = 0; tap < mNumTaps; ++tap)
+        {
+            const double distance =
+                    static_cast<double>(tap) - mHalfTaps - offset;
+            const double weight = computeWeight(distance);
+            weights[tap] = static_cast<float>(weight);
+            sum += weight;
+        }
+
+        for (size_t tap = 0; tap < mNumTaps; ++tap)
+        {
+            weights[tap] = static_cast<float>(weights[tap] / sum);
+        }
+    }
+}
+
+double InterpolationKernel::computeWeight(double distance) const
+{
+    switch (mType)
+    {
+    case NEAREST:
+        return 1.0;
+    case BILINEAR:
+        return std::max(1.0 - std::abs(distance), 0.0);
+    case SINC:
+    {
+        const double halfWidth = static_cast<double>(mNumTaps / 2);
+        if (std::abs(distance) >= halfWidth)
+        {
+            return 0.0;
+        }
+        return sinc(distance) * sinc(distance / halfWidth);
+    }
+    default:
+        throw except::Exception(Ctxt("Invalid interpolation kernel"));
+    }
+}
+
+InterpolationKernel::Type InterpolationKernel::toType(const std::string& name)
+{
+    std::string upper(name);
+    str::upper(upper);
+    if (upper == "NEAREST")
+    {
+        return NEAREST;
+    }
+    if (upper == "BILINEAR")
+    {
+        return BILINEAR;
+    }
+    if (upper == "SINC")
+    {
+        return SINC;
+    }
+    throw except::Exception(Ctxt("Unknown interpolation kernel " + name));
+}
+}
+}
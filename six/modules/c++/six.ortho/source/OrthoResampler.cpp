@@ -0,0 +1,886 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <except/Exception.h>
+#include <io/InputStream.h>
+#include <math/linear/Matrix2D.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <str/Convert.h>
+#include <sys/Runnable.h>
+#include <scene/PolyFitSolver.h>
+#include <scene/PolyLatticeEvaluator.h>
+#include <scene/ProjectionPolynomialFitter.h>
+#include <scene/Utilities.h>
+#include <six/Container.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/Utilities.h>
+#include <six/sidd/DerivedDataBuilder.h>
+#include <six/sidd/Utilities.h>
+#include <six/ortho/OrthoResampler.h>
+
+namespace
+{
+// SIDDs abbreviate the classification levels that SICDs spell out
+std::string toDerivedClassification(const std::string& level)
+{
+    std::string upper(level);
+    str::upper(upper);
+    if (upper.empty() || upper.size() <= 2)
+    {
+        return upper;
+    }
+    if (upper.find("TOP") == 0)
+    {
+        return "TS";
+    }
+    return upper.substr(0, 1);
+}
+
+six::sidd::Information* createInformation(
+        const six::sicd::ComplexData& sicd)
+{
+    std::auto_ptr<six::sidd::Information> information(
+            new six::sidd::Information());
+    information->sensorName = sicd.collectionInformation->collectorName;
+    information->radarMode = sicd.collectionInformation->radarMode;
+    information->radarModeID = sicd.collectionInformation->radarModeID;
+    information->collectionDateTime = sicd.timeline->collectStart;
+    information->collectionDuration = sicd.timeline->collectDuration;
+    information->resolution.rg = sicd.grid->row->impulseResponseWidth;
+    information->resolution.az = sicd.grid->col->impulseResponseWidth;
+
+    const six::DualPolarizationType polarization =
+            sicd.imageFormation->txRcvPolarizationProc;
+    if (polarization != six::DualPolarizationType::NOT_SET)
+    {
+        const std::pair<six::PolarizationType, six::PolarizationType>
+                txRcv(six::sidd::Utilities::convertDualPolarization(
+                        polarization));
+        information->polarization.push_back(
+                mem::ScopedCloneablePtr<six::sidd::TxRcvPolarization>(
+                        new six::sidd::TxRcvPolarization(txRcv.first,
+                                                         txRcv.second)));
+    }
+    return information.release();
+}
+
+// What the resampler needs from the input's metadata
+struct InputGeometry
+{
+    explicit InputGeometry(const six::Data& inputData)
+    {
+        if (inputData.getDataType() == six::DataType::COMPLEX)
+        {
+            const six::sicd::ComplexData& sicd =
+                    static_cast<const six::sicd::ComplexData&>(inputData);
+            const std::auto_ptr<scene::SceneGeometry> geometry(
+                    six::sicd::Utilities::getSceneGeometry(&sicd));
+            projModel.reset(six::sicd::Utilities::getProjectionModel(
+                    &sicd, geometry.get()));
+
+            // The image grid is in meters from the SCP, which is relative
+            // to the full image rather than this one
+            spacing = types::RowCol<double>(sicd.grid->row->sampleSpacing,
+                                            sicd.grid->col->sampleSpacing);
+            reference = types::RowCol<double>(
+                    static_cast<double>(sicd.imageData->scpPixel.row) -
+                            static_cast<double>(sicd.imageData->firstRow),
+                    static_cast<double>(sicd.imageData->scpPixel.col) -
+                            static_cast<double>(sicd.imageData->firstCol));
+            referenceHeight = sicd.geoData->scp.llh.getAlt();
+            arpPoly = sicd.position->arpPoly;
+        }
+        else
+        {
+            const six::sidd::DerivedData& sidd =
+                    static_cast<const six::sidd::DerivedData&>(inputData);
+            projModel.reset(
+                    six::sidd::Utilities::getProjectionModel(&sidd).release());
+
+            // getProjectionModel() only succeeds for measurable projections
+            const six::sidd::MeasurableProjection& projection =
+                    static_cast<const six::sidd::MeasurableProjection&>(
+                            *sidd.measurement->projection);
+            spacing = projection.sampleSpacing;
+            reference = projection.referencePoint.rowCol;
+            referenceHeight = scene::Utilities::ecefToLatLon(
+                    projection.referencePoint.ecef).getAlt();
+            arpPoly = sidd.measurement->arpPoly;
+        }
+    }
+
+    std::auto_ptr<const scene::ProjectionModel> projModel;
+    types::RowCol<double> spacing;
+    types::RowCol<double> reference;
+    double referenceHeight;
+    six::PolyXYZ arpPoly;
+};
+
+// Part of the input image that a strip of output needs
+struct InputWindow
+{
+    types::RowCol<size_t> offset;
+    types::RowCol<size_t> dims;
+    std::vector<float> pixels;
+};
+
+// A block of a strip.  Its input locations are stored contiguously,
+// starting at 'mapOffset' in the strip's buffer.
+struct Tile
+{
+    types::RowCol<size_t> offset;
+    types::RowCol<size_t> dims;
+    size_t mapOffset;
+
+    // Bounds of the input locations that land in the input image
+    bool isValid;
+    types::RowCol<double> minInput;
+    types::RowCol<double> maxInput;
+};
+
+struct StripContext
+{
+    StripContext(const six::ortho::OrthoResampler& resampler,
+                 const six::ortho::InterpolationKernel& kernel,
+                 const types::RowCol<size_t>& inputDims,
+                 size_t startRow,
+                 size_t numCols,
+                 float* output) :
+        resampler(resampler),
+        kernel(kernel),
+        inputDims(inputDims),
+        startRow(startRow),
+        numCols(numCols),
+        output(output)
+    {
+    }
+
+    bool isInInput(const types::RowCol<double>& pixel) const
+    {
+        // Anything within half a pixel of the edge is still in it.  NaNs
+        // fail these comparisons too.
+        return pixel.row >= -0.5 && pixel.row <= inputDims.row - 0.5 &&
+               pixel.col >= -0.5 && pixel.col <= inputDims.col - 0.5;
+    }
+
+    const six::ortho::OrthoResampler& resampler;
+    const six::ortho::InterpolationKernel& kernel;
+    const types::RowCol<size_t> inputDims;
+    const size_t startRow;
+    const size_t numCols;
+    float* const output;
+
+    std::vector<Tile> tiles;
+    std::vector<types::RowCol<double> > inputPixels;
+    InputWindow window;
+};
+
+void mapTile(StripContext& context, Tile& tile)
+{
+    types::RowCol<double>* const inputPixels =
+            &context.inputPixels[tile.mapOffset];
+    context.resampler.mapToInput(tile.offset, tile.dims, inputPixels);
+
+    tile.isValid = false;
+    tile.minInput = types::RowCol<double>(std::numeric_limits<double>::max(),
+                                          std::numeric_limits<double>::max());
+    tile.maxInput = types::RowCol<double>(-std::numeric_limits<double>::max(),
+                                          -std::numeric_limits<double>::max());
+    for (size_t ii = 0; ii < tile.dims.area(); ++ii)
+    {
+        const types::RowCol<double>& pixel(inputPixels[ii]);
+        if (context.isInInput(pixel))
+        {
+            tile.isValid = true;
+            tile.minInput.row = std::min(tile.minInput.row, pixel.row);
+            tile.minInput.col = std::min(tile.minInput.col, pixel.col);
+            tile.maxInput.row = std::max(tile.maxInput.row, pixel.row);
+            tile.maxInput.col = std::max(tile.maxInput.col, pixel.col);
+        }
+    }
+}
+
+inline sys::SSize_T clamp(sys::SSize_T value, sys::SSize_T size)
+{
+    return std::min(std::max(value, static_cast<sys::SSize_T>(0)), size - 1);
+}
+
+void resampleTile(const StripContext& context, const Tile& tile)
+{
+    const six::ortho::InterpolationKernel& kernel(context.kernel);
+    const InputWindow& window(context.window);
+    const sys::SSize_T numTaps = static_cast<sys::SSize_T>(kernel.getNumTaps());
+    const sys::SSize_T windowRows = static_cast<sys::SSize_T>(window.dims.row);
+    const sys::SSize_T windowCols = static_cast<sys::SSize_T>(window.dims.col);
+    const types::RowCol<double>* inputPixels =
+            &context.inputPixels[tile.mapOffset];
+
+    for (size_t row = 0; row < tile.dims.row; ++row)
+    {
+        float* const output = context.output +
+                (tile.offset.row - context.startRow + row) * context.numCols +
+                tile.offset.col;
+
+        for (size_t col = 0; col < tile.dims.col; ++col, ++inputPixels)
+        {
+            const types::RowCol<double>& pixel(*inputPixels);
+            if (!context.isInInput(pixel))
+            {
+                output[col] = 0.0f;
+                continue;
+            }
+
+            sys::SSize_T firstRow;
+            sys::SSize_T firstCol;
+            const float* const rowWeights =
+                    kernel.getWeights(pixel.row, firstRow);
+            const float* const colWeights =
+                    kernel.getWeights(pixel.col, firstCol);
+            firstRow -= static_cast<sys::SSize_T>(window.offset.row);
+            firstCol -= static_cast<sys::SSize_T>(window.offset.col);
+
+            double sum(0.0);
+            if (firstRow >= 0 && firstRow + numTaps <= windowRows &&
+                firstCol >= 0 && firstCol + numTaps <= windowCols)
+            {
+                const float* input =
+                        &window.pixels[firstRow * windowCols + firstCol];
+                for (sys::SSize_T ii = 0; ii < numTaps;
+                     ++ii, input += windowCols)
+                {
+                    double rowSum(0.0);
+                    for (sys::SSize_T jj = 0; jj < numTaps; ++jj)
+                    {
+                        rowSum += colWeights[jj] * input[jj];
+                    }
+                    sum += rowWeights[ii] * rowSum;
+                }
+            }
+            else
+            {
+                // The window stops at the edges of the input image, so
+                // taps past them repeat the edge
+                for (sys::SSize_T ii = 0; ii < numTaps; ++ii)
+                {
+                    const float* const input = &window.pixels[
+                            clamp(firstRow + ii, windowRows) * windowCols];
+                    double rowSum(0.0);
+                    for (sys::SSize_T jj = 0; jj < numTaps; ++jj)
+                    {
+                        rowSum += colWeights[jj] *
+                                input[clamp(firstCol + jj, windowCols)];
+                    }
+                    sum += rowWeights[ii] * rowSum;
+                }
+            }
+            output[col] = static_cast<float>(sum);
+        }
+    }
+}
+
+class TileRunnable : public sys::Runnable
+{
+public:
+    TileRunnable(StripContext& context,
+                 bool resample,
+                 size_t startTile,
+                 size_t numTiles) :
+        mContext(context),
+        mResample(resample),
+        mStartTile(startTile),
+        mNumTiles(numTiles)
+    {
+    }
+
+    virtual void run()
+    {
+        for (size_t ii = mStartTile; ii < mStartTile + mNumTiles; ++ii)
+        {
+            if (mResample)
+            {
+                resampleTile(mContext, mContext.tiles[ii]);
+            }
+            else
+            {
+                mapTile(mContext, mContext.tiles[ii]);
+            }
+        }
+    }
+
+private:
+    StripContext& mContext;
+    const bool mResample;
+    const size_t mStartTile;
+    const size_t mNumTiles;
+};
+
+// Maps (resample = false) or resamples (resample = true) every tile of a
+// strip
+void runTiles(StripContext& context, bool resample, size_t numThreads)
+{
+    const size_t numTiles = context.tiles.size();
+    numThreads = std::min(numThreads, numTiles);
+    if (numThreads <= 1)
+    {
+        TileRunnable(context, resample, 0, numTiles).run();
+    }
+    else
+    {
+        mt::ThreadGroup threads;
+        const mt::ThreadPlanner planner(numTiles, numThreads);
+
+        size_t threadNum(0);
+        size_t startTile(0);
+        size_t numTilesThisThread(0);
+        while (planner.getThreadInfo(threadNum++,
+                                     startTile,
+                                     numTilesThisThread))
+        {
+            std::auto_ptr<sys::Runnable> runnable(new TileRunnable(
+                    context, resample, startTile, numTilesThisThread));
+            threads.createThread(runnable);
+        }
+
+        threads.joinAll();
+    }
+}
+
+/*
+ *  Hands NITFWriteControl the output a strip at a time, converted to the
+ *  output pixel type.  The next strip is only resampled once the last one
+ *  has been read.
+ */
+class StripInputStream : public io::InputStream
+{
+public:
+    StripInputStream(six::ortho::OrthoResampler& resampler,
+                     six::PixelType pixelType,
+                     double scale,
+                     size_t rowsPerStrip) :
+        mResampler(resampler),
+        mPixelType(pixelType),
+        mScale(scale),
+        mDims(resampler.getOutputGrid().getDims()),
+        mRowsPerStrip(rowsPerStrip),
+        mNextRow(0),
+        mPosition(0)
+    {
+    }
+
+    virtual sys::SSize_T read(sys::byte* buffer, sys::Size_T len)
+    {
+        size_t numRead(0);
+        while (numRead < len)
+        {
+            if (mPosition == mBytes.size())
+            {
+                if (mNextRow == mDims.row)
+                {
+                    break;
+                }
+                resampleNextStrip();
+            }
+
+            const size_t numBytes =
+                    std::min(len - numRead, mBytes.size() - mPosition);
+            ::memcpy(buffer + numRead, &mBytes[mPosition], numBytes);
+            numRead += numBytes;
+            mPosition += numBytes;
+        }
+
+        if (numRead == 0 && len > 0)
+        {
+            return io::InputStream::IS_EOF;
+        }
+        return static_cast<sys::SSize_T>(numRead);
+    }
+
+private:
+    template <typename T>
+    void convert()
+    {
+        const double maxValue = std::numeric_limits<T>::max();
+        mBytes.resize(mPixels.size() * sizeof(T));
+        T* const output = reinterpret_cast<T*>(&mBytes[0]);
+        for (size_t ii = 0; ii < mPixels.size(); ++ii)
+        {
+            const double value = mPixels[ii] * mScale + 0.5;
+            output[ii] = static_cast<T>(
+                    value <= 0.0 ? 0.0 : std::min(value, maxValue));
+        }
+    }
+
+    void resampleNextStrip()
+    {
+        const size_t numRows = std::min(mRowsPerStrip, mDims.row - mNextRow);
+        mPixels.resize(numRows * mDims.col);
+        mResampler.resample(mNextRow, numRows, &mPixels[0]);
+        mNextRow += numRows;
+
+        if (mPixelType == six::PixelType::MONO8I)
+        {
+            convert<sys::Uint8_T>();
+        }
+        else
+        {
+            convert<sys::Uint16_T>();
+        }
+        mPosition = 0;
+    }
+
+private:
+    six::ortho::OrthoResampler& mResampler;
+    const six::PixelType mPixelType;
+    const double mScale;
+    const types::RowCol<size_t> mDims;
+    const size_t mRowsPerStrip;
+    size_t mNextRow;
+    std::vector<float> mPixels;
+    std::vector<sys::ubyte> mBytes;
+    size_t mPosition;
+};
+}
+
+namespace six
+{
+namespace ortho
+{
+const size_t OrthoResampler::DEFAULT_TILE_SIZE = 256;
+const size_t OrthoResampler::DEFAULT_POLY_ORDER = 3;
+
+OrthoResampler::OrthoResampler(const Data& inputData,
+                               InputImage& inputImage,
+                               const OutputGrid& outputGrid,
+                               const InterpolationKernel& kernel,
+                               const HeightModel& heightModel,
+                               size_t numThreads) :
+    mInputData(inputData.clone()),
+    mInputImage(inputImage),
+    mInputDims(inputImage.getDims()),
+    mOutputGrid(outputGrid),
+    mGridTransform(outputGrid.getGridTransform()),
+    mSurfaceTransform(*mGridTransform, heightModel),
+    mKernel(kernel),
+    mNumThreads(std::max<size_t>(numThreads, 1)),
+    mProjectionMethod(POLYNOMIAL),
+    mPolyOrder(DEFAULT_POLY_ORDER),
+    mTileSize(DEFAULT_TILE_SIZE)
+{
+    if (mInputDims.row != inputData.getNumRows() ||
+        mInputDims.col != inputData.getNumCols())
+    {
+        throw except::Exception(Ctxt(
+                "Input image is " + str::toString(mInputDims.row) + " x " +
+                str::toString(mInputDims.col) + " but its metadata says " +
+                str::toString(inputData.getNumRows()) + " x " +
+                str::toString(inputData.getNumCols())));
+    }
+
+    InputGeometry geometry(inputData);
+    mProjModel = geometry.projModel;
+    mInputSpacing = geometry.spacing;
+    mInputReference = geometry.reference;
+    mArpPoly = geometry.arpPoly;
+}
+
+void OrthoResampler::setProjectionMethod(ProjectionMethod method,
+                                         size_t polyOrder)
+{
+    mProjectionMethod = method;
+    mPolyOrder = polyOrder;
+}
+
+void OrthoResampler::setTileSize(size_t tileSize)
+{
+    if (tileSize < 2)
+    {
+        throw except::Exception(Ctxt("Tiles must be at least 2 x 2"));
+    }
+    mTileSize = tileSize;
+}
+
+double OrthoResampler::getReferenceHeight(const Data& inputData)
+{
+    return InputGeometry(inputData).referenceHeight;
+}
+
+LatLonCorners OrthoResampler::getInputFootprint(const Data& inputData,
+                                                const HeightModel& heightModel)
+{
+    const InputGeometry geometry(inputData);
+    const double lastRow = std::max<double>(inputData.getNumRows(), 1) - 1.0;
+    const double lastCol = std::max<double>(inputData.getNumCols(), 1) - 1.0;
+
+    LatLonCorners corners;
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const types::RowCol<double> pixel(
+                ii == LatLonCorners::LOWER_RIGHT ||
+                ii == LatLonCorners::LOWER_LEFT ? lastRow : 0.0,
+                ii == LatLonCorners::UPPER_RIGHT ||
+                ii == LatLonCorners::LOWER_RIGHT ? lastCol : 0.0);
+        const types::RowCol<double> imageGridPoint(
+                (pixel.row - geometry.reference.row) * geometry.spacing.row,
+                (pixel.col - geometry.reference.col) * geometry.spacing.col);
+
+        // Projecting to a constant height moves the point, which changes
+        // the height under it, so go around a few times
+        LatLonAlt lla(0.0, 0.0, geometry.referenceHeight);
+        for (size_t iter = 0; iter < 3; ++iter)
+        {
+            lla = scene::Utilities::ecefToLatLon(
+                    geometry.projModel->imageToScene(imageGridPoint,
+                                                     lla.getAlt()));
+            lla.setAlt(heightModel.getHeight(lla.getLat(), lla.getLon()));
+        }
+        corners.getCorner(ii) = LatLon(lla.getLat(), lla.getLon());
+    }
+    return corners;
+}
+
+void OrthoResampler::mapToInput(const types::RowCol<size_t>& start,
+                                const types::RowCol<size_t>& dims,
+                                types::RowCol<double>* inputPixels) const
+{
+    if (mProjectionMethod == EXACT)
+    {
+        mapExact(start, dims, inputPixels);
+    }
+    else
+    {
+        mapPolynomial(start, dims, inputPixels);
+    }
+}
+
+void OrthoResampler::mapExact(const types::RowCol<size_t>& start,
+                              const types::RowCol<size_t>& dims,
+                              types::RowCol<double>* inputPixels) const
+{
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col, ++inputPixels)
+        {
+            const scene::Vector3 groundPoint =
+                    mSurfaceTransform.rowColToECEF(
+                            static_cast<double>(start.row + row),
+                            static_cast<double>(start.col + col));
+            *inputPixels =
+                    toInputPixel(mProjModel->sceneToImage(groundPoint));
+        }
+    }
+}
+
+void OrthoResampler::mapPolynomial(const types::RowCol<size_t>& start,
+                                   const types::RowCol<size_t>& dims,
+                                   types::RowCol<double>* inputPixels) const
+{
+    // Blocks at the bottom and right of the grid can be a single row or col.
+    // The polynomials are fit over at least a whole tile so that the
+    // samples still span both directions.
+    const types::RowCol<size_t> fitDims(std::max(dims.row, mTileSize),
+                                        std::max(dims.col, mTileSize));
+    const scene::ProjectionPolynomialFitter fitter(
+            *mProjModel,
+            mSurfaceTransform,
+            types::RowCol<double>(static_cast<double>(start.row),
+                                  static_cast<double>(start.col)),
+            fitDims,
+            std::max(scene::ProjectionPolynomialFitter::DEFAULTS_POINTS_1D,
+                     mPolyOrder + 2));
+
+    const math::linear::Matrix2D<types::RowCol<double> >& sceneCoordinates =
+            fitter.getSceneCoordinates();
+    math::linear::Matrix2D<double> inputRows(sceneCoordinates.rows(),
+                                             sceneCoordinates.cols());
+    math::linear::Matrix2D<double> inputCols(sceneCoordinates.rows(),
+                                             sceneCoordinates.cols());
+    for (size_t ii = 0; ii < sceneCoordinates.rows(); ++ii)
+    {
+        for (size_t jj = 0; jj < sceneCoordinates.cols(); ++jj)
+        {
+            const types::RowCol<double> inputPixel =
+                    toInputPixel(sceneCoordinates(ii, jj));
+            inputRows(ii, jj) = inputPixel.row;
+            inputCols(ii, jj) = inputPixel.col;
+        }
+    }
+
+    // The row and col polynomials share their sample locations
+    const scene::PolyFitSolver solver(fitter.getOutputPlaneRows(),
+                                      fitter.getOutputPlaneCols(),
+                                      mPolyOrder, mPolyOrder);
+    const types::RowCol<double> origin(0.0, 0.0);
+    const types::RowCol<double> spacing(1.0, 1.0);
+    std::vector<double> rows(dims.area());
+    std::vector<double> cols(dims.area());
+    scene::PolyLatticeEvaluator<double>(
+            solver.fit(inputRows), origin, spacing, dims).evaluate(&rows[0]);
+    scene::PolyLatticeEvaluator<double>(
+            solver.fit(inputCols), origin, spacing, dims).evaluate(&cols[0]);
+
+    for (size_t ii = 0; ii < dims.area(); ++ii)
+    {
+        inputPixels[ii] = types::RowCol<double>(rows[ii], cols[ii]);
+    }
+}
+
+void OrthoResampler::resample(size_t startRow, size_t numRows, float* output)
+{
+    const types::RowCol<size_t>& dims(mOutputGrid.getDims());
+    if (startRow + numRows > dims.row)
+    {
+        throw except::Exception(Ctxt(
+                "Requested rows extend past the output grid"));
+    }
+
+    for (size_t row = 0; row < numRows; row += mTileSize)
+    {
+        const size_t numRowsThisStrip = std::min(mTileSize, numRows - row);
+        resampleStrip(startRow + row, numRowsThisStrip,
+                      output + row * dims.col);
+    }
+}
+
+void OrthoResampler::resampleStrip(size_t startRow,
+                                   size_t numRows,
+                                   float* output)
+{
+    const size_t numCols = mOutputGrid.getDims().col;
+    StripContext context(*this, mKernel, mInputDims, startRow, numCols,
+                         output);
+    for (size_t col = 0; col < numCols; col += mTileSize)
+    {
+        Tile tile;
+        tile.offset = types::RowCol<size_t>(startRow, col);
+        tile.dims = types::RowCol<size_t>(numRows,
+                                          std::min(mTileSize, numCols - col));
+        tile.mapOffset = numRows * col;
+        context.tiles.push_back(tile);
+    }
+    context.inputPixels.resize(numRows * numCols);
+
+    runTiles(context, false, mNumThreads);
+
+    // Read everything the strip's tiles need at once
+    bool isValid(false);
+    types::RowCol<double> minInput(std::numeric_limits<double>::max(),
+                                   std::numeric_limits<double>::max());
+    types::RowCol<double> maxInput(-std::numeric_limits<double>::max(),
+                                   -std::numeric_limits<double>::max());
+    for (size_t ii = 0; ii < context.tiles.size(); ++ii)
+    {
+        const Tile& tile(context.tiles[ii]);
+        if (tile.isValid)
+        {
+            isValid = true;
+            minInput.row = std::min(minInput.row, tile.minInput.row);
+            minInput.col = std::min(minInput.col, tile.minInput.col);
+            maxInput.row = std::max(maxInput.row, tile.maxInput.row);
+            maxInput.col = std::max(maxInput.col, tile.maxInput.col);
+        }
+    }
+
+    if (!isValid)
+    {
+        std::fill(output, output + numRows * numCols, 0.0f);
+        return;
+    }
+
+    const double margin = static_cast<double>(mKernel.getMargin());
+    const types::RowCol<double> first(
+            std::max(std::floor(minInput.row) - margin, 0.0),
+            std::max(std::floor(minInput.col) - margin, 0.0));
+    const types::RowCol<double> last(
+            std::min(std::ceil(maxInput.row) + margin, mInputDims.row - 1.0),
+            std::min(std::ceil(maxInput.col) + margin, mInputDims.col - 1.0));
+
+    InputWindow& window(context.window);
+    window.offset = types::RowCol<size_t>(static_cast<size_t>(first.row),
+                                          static_cast<size_t>(first.col));
+    window.dims = types::RowCol<size_t>(
+            static_cast<size_t>(last.row) - window.offset.row + 1,
+            static_cast<size_t>(last.col) - window.offset.col + 1);
+    window.pixels.resize(window.dims.area());
+    mInputImage.read(window.offset, window.dims, &window.pixels[0]);
+
+    runTiles(context, true, mNumThreads);
+}
+
+std::auto_ptr<sidd::DerivedData>
+OrthoResampler::createDerivedData(PixelType pixelType) const
+{
+    if (pixelType != PixelType::MONO8I && pixelType != PixelType::MONO16I)
+    {
+        throw except::Exception(Ctxt(
+                "Can't write " + pixelType.toString() + " pixels"));
+    }
+
+    sidd::DerivedDataBuilder builder;
+    builder.addDisplay(pixelType);
+    builder.addGeographicAndTarget(RegionType::GEOGRAPHIC_INFO);
+    builder.addMeasurement(mOutputGrid.getProjectionType());
+    builder.addExploitationFeatures(1);
+    std::auto_ptr<sidd::DerivedData> data(builder.steal());
+
+    const types::RowCol<size_t>& dims(mOutputGrid.getDims());
+    data->setNumRows(dims.row);
+    data->setNumCols(dims.col);
+
+    // Measurement
+    sidd::Measurement& measurement(*data->measurement);
+    measurement.pixelFootprint = RowColInt(dims.row, dims.col);
+    measurement.arpPoly = mArpPoly;
+
+    sidd::MeasurableProjection& projection =
+            static_cast<sidd::MeasurableProjection&>(*measurement.projection);
+    projection.referencePoint.ecef = mOutputGrid.getReferencePoint();
+    projection.referencePoint.rowCol = mOutputGrid.getReferencePixel();
+    projection.sampleSpacing = mOutputGrid.getSampleSpacing();
+    if (mOutputGrid.getProjectionType() == ProjectionType::PLANE)
+    {
+        sidd::PlaneProjection& plane =
+                static_cast<sidd::PlaneProjection&>(projection);
+        plane.productPlane.rowUnitVector = mOutputGrid.getRowUnitVector();
+        plane.productPlane.colUnitVector = mOutputGrid.getColUnitVector();
+    }
+
+    // The time COA polynomial is in meters (or arc seconds) from the
+    // reference point, as the SIDD projection models expect
+    const scene::ProjectionPolynomialFitter fitter(
+            *mProjModel, mSurfaceTransform, types::RowCol<double>(0.0, 0.0),
+            dims,
+            std::max(scene::ProjectionPolynomialFitter::DEFAULTS_POINTS_1D,
+                     mPolyOrder + 2),
+            mNumThreads);
+    fitter.fitTimeCOAPolynomial(mOutputGrid.getReferencePixel(),
+                                mOutputGrid.getSampleSpacing(),
+                                mPolyOrder, mPolyOrder,
+                                projection.timeCOAPoly);
+
+    // GeographicAndTarget
+    data->setImageCorners(mOutputGrid.getCorners());
+
+    // ExploitationFeatures
+    sidd::Collection& collection(
+            *data->exploitationFeatures->collections[0]);
+    types::RgAz<double> resolution(0.0, 0.0);
+    if (mInputData->getDataType() == DataType::COMPLEX)
+    {
+        const sicd::ComplexData& sicd =
+                static_cast<const sicd::ComplexData&>(*mInputData);
+        collection.information.reset(createInformation(sicd));
+        collection.identifier = sicd.collectionInformation->coreName;
+
+        data->productCreation->productName =
+                sicd.collectionInformation->coreName;
+        data->productCreation->classification.classification =
+                toDerivedClassification(sicd.getClassification().getLevel());
+    }
+    else
+    {
+        const sidd::DerivedData& sidd =
+                static_cast<const sidd::DerivedData&>(*mInputData);
+        const sidd::Collection& parent(
+                *sidd.exploitationFeatures->collections[0]);
+        collection.information.reset(parent.information->clone());
+        collection.identifier = parent.identifier;
+
+        data->productCreation->productName =
+                sidd.productCreation->productName;
+        data->productCreation->classification =
+                sidd.productCreation->classification;
+    }
+    resolution = collection.information->resolution;
+
+    // Geometry is recomputed at the new reference point
+    sidd::Utilities::setCollectionValues(projection.timeCOAPoly, mArpPoly,
+                                         projection.referencePoint,
+                                         &mOutputGrid.getRowUnitVector(),
+                                         &mOutputGrid.getColUnitVector(),
+                                         &collection);
+    sidd::Utilities::setProductValues(projection.timeCOAPoly, mArpPoly,
+                                      projection.referencePoint,
+                                      &mOutputGrid.getRowUnitVector(),
+                                      &mOutputGrid.getColUnitVector(),
+                                      resolution,
+                                      &data->exploitationFeatures->product);
+
+    // ProductCreation
+    sidd::ProcessorInformation& processor(
+            *data->productCreation->processorInformation);
+    processor.application = "six.ortho";
+    processor.processingDateTime = DateTime();
+    processor.profile = "Orthorectified";
+    data->productCreation->productClass = "Orthorectified";
+
+    // Display
+    const MagnificationMethod magnification =
+            mKernel.getType() == InterpolationKernel::NEAREST ?
+                    MagnificationMethod::NEAREST_NEIGHBOR :
+            mKernel.getType() == InterpolationKernel::BILINEAR ?
+                    MagnificationMethod::BILINEAR :
+                    MagnificationMethod::LAGRANGE;
+    data->display->magnificationMethod = magnification;
+    data->display->decimationMethod =
+            mKernel.getType() == InterpolationKernel::NEAREST ?
+                    DecimationMethod::NEAREST_NEIGHBOR :
+            mKernel.getType() == InterpolationKernel::BILINEAR ?
+                    DecimationMethod::BILINEAR :
+                    DecimationMethod::LAGRANGE;
+
+    return data;
+}
+
+void OrthoResampler::save(std::auto_ptr<sidd::DerivedData> data,
+                          double scale,
+                          NITFWriteControl& writer,
+                          const std::string& pathname,
+                          const std::vector<std::string>& schemaPaths)
+{
+    const types::RowCol<size_t>& dims(mOutputGrid.getDims());
+    if (data->getNumRows() != dims.row || data->getNumCols() != dims.col)
+    {
+        throw except::Exception(Ctxt(
+                "SIDD dimensions don't match the output grid"));
+    }
+
+    const PixelType pixelType = data->getPixelType();
+    if (pixelType != PixelType::MONO8I && pixelType != PixelType::MONO16I)
+    {
+        throw except::Exception(Ctxt(
+                "Can't write " + pixelType.toString() + " pixels"));
+    }
+
+    mem::SharedPtr<Container> container(new Container(DataType::DERIVED));
+    container->addData(std::auto_ptr<Data>(data));
+    writer.initialize(container);
+
+    StripInputStream stream(*this, pixelType, scale, mTileSize);
+    writer.save(SourceList(1, &stream), pathname, schemaPaths);
+}
+}
+}
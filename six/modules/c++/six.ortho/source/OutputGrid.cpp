@@ -0,0 +1,227 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <except/Exception.h>
+#include <scene/Utilities.h>
+#include <six/ortho/OutputGrid.h>
+
+namespace
+{
+// Local north and east at a latitude and longitude
+void getNorthEast(double lat, double lon,
+                  six::Vector3& north, six::Vector3& east)
+{
+    const double latRad = lat * M_PI / 180.0;
+    const double lonRad = lon * M_PI / 180.0;
+
+    north[0] = -std::sin(latRad) * std::cos(lonRad);
+    north[1] = -std::sin(latRad) * std::sin(lonRad);
+    north[2] = std::cos(latRad);
+
+    east[0] = -std::sin(lonRad);
+    east[1] = std::cos(lonRad);
+    east[2] = 0.0;
+}
+
+void checkSpacing(const types::RowCol<double>& sampleSpacing)
+{
+    if (!(sampleSpacing.row > 0.0 && sampleSpacing.col > 0.0))
+    {
+        throw except::Exception(Ctxt("Sample spacing must be positive"));
+    }
+}
+
+// Number of samples needed to span 'extent'
+size_t getNumSamples(double extent, double spacing)
+{
+    return static_cast<size_t>(std::ceil(extent / spacing - 1.0e-9)) + 1;
+}
+}
+
+namespace six
+{
+namespace ortho
+{
+OutputGrid::OutputGrid(const types::RowCol<size_t>& dims,
+                       const types::RowCol<double>& sampleSpacing,
+                       const types::RowCol<double>& referencePixel,
+                       const Vector3& referencePoint,
+                       const Vector3& rowUnitVector,
+                       const Vector3& colUnitVector) :
+    mProjectionType(ProjectionType::PLANE),
+    mDims(dims),
+    mSampleSpacing(sampleSpacing),
+    mReferencePixel(referencePixel),
+    mReferencePoint(referencePoint),
+    mRowUnitVector(rowUnitVector),
+    mColUnitVector(colUnitVector)
+{
+    checkSpacing(mSampleSpacing);
+}
+
+OutputGrid::OutputGrid(const types::RowCol<size_t>& dims,
+                       const types::RowCol<double>& sampleSpacing,
+                       const types::RowCol<double>& referencePixel,
+                       const LatLonAlt& referencePoint) :
+    mProjectionType(ProjectionType::GEOGRAPHIC),
+    mDims(dims),
+    mSampleSpacing(sampleSpacing),
+    mReferencePixel(referencePixel),
+    mReferencePoint(scene::Utilities::latLonToECEF(referencePoint))
+{
+    checkSpacing(mSampleSpacing);
+
+    Vector3 north;
+    getNorthEast(referencePoint.getLat(), referencePoint.getLon(),
+                 north, mColUnitVector);
+    mRowUnitVector = north * -1.0;
+}
+
+OutputGrid OutputGrid::planar(const LatLonCorners& footprint,
+                              double height,
+                              const types::RowCol<double>& sampleSpacing)
+{
+    checkSpacing(sampleSpacing);
+
+    double lat(0.0);
+    double lon(0.0);
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        lat += footprint.getCorner(ii).getLat();
+        lon += footprint.getCorner(ii).getLon();
+    }
+    lat /= LatLonCorners::NUM_CORNERS;
+    lon /= LatLonCorners::NUM_CORNERS;
+
+    const Vector3 referencePoint =
+            scene::Utilities::latLonToECEF(LatLonAlt(lat, lon, height));
+    Vector3 north;
+    Vector3 east;
+    getNorthEast(lat, lon, north, east);
+    const Vector3 south = north * -1.0;
+
+    types::RowCol<double> minOffset(std::numeric_limits<double>::max(),
+                                    std::numeric_limits<double>::max());
+    types::RowCol<double> maxOffset(-std::numeric_limits<double>::max(),
+                                    -std::numeric_limits<double>::max());
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const LatLon& corner(footprint.getCorner(ii));
+        const Vector3 offset = scene::Utilities::latLonToECEF(
+                LatLonAlt(corner.getLat(), corner.getLon(), height)) -
+                referencePoint;
+
+        const double row = offset.dot(south);
+        const double col = offset.dot(east);
+        minOffset.row = std::min(minOffset.row, row);
+        minOffset.col = std::min(minOffset.col, col);
+        maxOffset.row = std::max(maxOffset.row, row);
+        maxOffset.col = std::max(maxOffset.col, col);
+    }
+
+    const types::RowCol<size_t> dims(
+            getNumSamples(maxOffset.row - minOffset.row, sampleSpacing.row),
+            getNumSamples(maxOffset.col - minOffset.col, sampleSpacing.col));
+    const types::RowCol<double> referencePixel(
+            -minOffset.row / sampleSpacing.row,
+            -minOffset.col / sampleSpacing.col);
+
+    return OutputGrid(dims, sampleSpacing, referencePixel, referencePoint,
+                      south, east);
+}
+
+OutputGrid OutputGrid::geographic(const LatLonCorners& footprint,
+                                  double height,
+                                  const types::RowCol<double>& sampleSpacing)
+{
+    checkSpacing(sampleSpacing);
+
+    double minLat(std::numeric_limits<double>::max());
+    double minLon(std::numeric_limits<double>::max());
+    double maxLat(-std::numeric_limits<double>::max());
+    double maxLon(-std::numeric_limits<double>::max());
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const LatLon& corner(footprint.getCorner(ii));
+        minLat = std::min(minLat, corner.getLat());
+        minLon = std::min(minLon, corner.getLon());
+        maxLat = std::max(maxLat, corner.getLat());
+        maxLon = std::max(maxLon, corner.getLon());
+    }
+
+    const LatLonAlt referencePoint((minLat + maxLat) / 2.0,
+                                   (minLon + maxLon) / 2.0,
+                                   height);
+    const types::RowCol<size_t> dims(
+            getNumSamples((maxLat - minLat) * 3600.0, sampleSpacing.row),
+            getNumSamples((maxLon - minLon) * 3600.0, sampleSpacing.col));
+    const types::RowCol<double> referencePixel(
+            (maxLat - referencePoint.getLat()) * 3600.0 / sampleSpacing.row,
+            (referencePoint.getLon() - minLon) * 3600.0 / sampleSpacing.col);
+
+    return OutputGrid(dims, sampleSpacing, referencePixel, referencePoint);
+}
+
+std::auto_ptr<scene::GridECEFTransform> OutputGrid::getGridTransform() const
+{
+    std::auto_ptr<scene::GridECEFTransform> transform;
+    if (mProjectionType == ProjectionType::PLANE)
+    {
+        transform.reset(new scene::PlanarGridECEFTransform(
+                mSampleSpacing, mReferencePixel,
+                mRowUnitVector, mColUnitVector, mReferencePoint));
+    }
+    else
+    {
+        transform.reset(new scene::GeographicGridECEFTransform(
+                mSampleSpacing, mReferencePixel,
+                scene::Utilities::ecefToLatLon(mReferencePoint)));
+    }
+    return transform;
+}
+
+LatLonCorners OutputGrid::getCorners() const
+{
+    const std::auto_ptr<scene::GridECEFTransform> transform(
+            getGridTransform());
+    const double lastRow = mDims.row == 0 ? 0.0 : mDims.row - 1.0;
+    const double lastCol = mDims.col == 0 ? 0.0 : mDims.col - 1.0;
+
+    LatLonCorners corners;
+    for (size_t ii = 0; ii < LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const types::RowCol<double> pixel(
+                ii == LatLonCorners::LOWER_RIGHT ||
+                ii == LatLonCorners::LOWER_LEFT ? lastRow : 0.0,
+                ii == LatLonCorners::UPPER_RIGHT ||
+                ii == LatLonCorners::LOWER_RIGHT ? lastCol : 0.0);
+        const LatLonAlt lla =
+                scene::Utilities::ecefToLatLon(transform->rowColToECEF(pixel));
+        corners.getCorner(ii) = LatLon(lla.getLat(), lla.getLon());
+    }
+    return corners;
+}
+}
+}
@@ -0,0 +1,167 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <cli/ArgumentParser.h>
+#include <except/Exception.h>
+#include <sys/OS.h>
+#include <six/NITFReadControl.h>
+#include <six/NITFWriteControl.h>
+#include <six/XMLControlFactory.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <six/sidd/DerivedXMLControl.h>
+#include <import/six/ortho.h>
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        cli::ArgumentParser parser;
+        parser.setDescription(
+                "Orthorectifies a SICD or SIDD onto a north-up ground plane "
+                "or a geographic grid covering its footprint, and writes the "
+                "result as a SIDD.");
+        parser.addArgument("-g --grid", "Output grid", cli::STORE, "grid",
+                           "GRID")->addChoice("plane")->addChoice(
+                                   "geographic")->setDefault("plane");
+        parser.addArgument("-s --spacing",
+                           "Output sample spacing, in meters for a plane or "
+                           "arc seconds for a geographic grid",
+                           cli::STORE, "spacing", "SPACING")->setDefault(1.0);
+        parser.addArgument("--height",
+                           "Height of the ground above the ellipsoid, in "
+                           "meters.  Defaults to the height of the input's "
+                           "reference point.", cli::STORE, "height",
+                           "METERS");
+        parser.addArgument("-k --kernel", "Interpolation kernel",
+                           cli::STORE, "kernel", "KERNEL")->addChoice(
+                                   "nearest")->addChoice("bilinear")->
+                                   addChoice("sinc")->setDefault("bilinear");
+        parser.addArgument("--exact",
+                           "Project every pixel exactly rather than through "
+                           "per-tile polynomials", cli::STORE_TRUE, "exact");
+        parser.addArgument("--tile-size", "Output tile size, in pixels",
+                           cli::STORE, "tileSize", "PIXELS")->setDefault(
+                                   six::ortho::OrthoResampler::
+                                           DEFAULT_TILE_SIZE);
+        parser.addArgument("-t --threads", "Number of threads to use",
+                           cli::STORE, "threads", "NUM")->setDefault(
+                                   sys::OS().getNumCPUs());
+        parser.addArgument("-p --pixel-type", "Output pixel type",
+                           cli::STORE, "pixelType", "TYPE")->addChoice(
+                                   "MONO8I")->addChoice("MONO16I")->
+                                   setDefault("MONO8I");
+        parser.addArgument("--scale",
+                           "Amount to multiply the pixels by before they "
+                           "are rounded to the output pixel type",
+                           cli::STORE, "scale", "SCALE")->setDefault(1.0);
+        parser.addArgument("--schema", "Schema directory to validate with",
+                           cli::STORE, "schema", "DIR");
+        parser.addArgument("input", "Input SICD or SIDD", cli::STORE,
+                           "input", "INPUT", 1, 1);
+        parser.addArgument("output", "Output SIDD", cli::STORE, "output",
+                           "OUTPUT", 1, 1);
+
+        const std::auto_ptr<cli::Results>
+            options(parser.parse(argc, (const char**) argv));
+
+        std::vector<std::string> schemaPaths;
+        if (options->hasValue("schema"))
+        {
+            schemaPaths.push_back(options->get<std::string>("schema"));
+        }
+
+        six::XMLControlRegistry xmlRegistry;
+        xmlRegistry.addCreator(
+                six::DataType::COMPLEX,
+                new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+        xmlRegistry.addCreator(
+                six::DataType::DERIVED,
+                new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
+
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&xmlRegistry);
+        reader.load(options->get<std::string>("input"), schemaPaths);
+        const six::Data& inputData(*reader.getContainer()->getData(0));
+
+        const double height = options->hasValue("height") ?
+                options->get<double>("height") :
+                six::ortho::OrthoResampler::getReferenceHeight(inputData);
+        const six::ortho::ConstantHeightModel heightModel(height);
+
+        const six::LatLonCorners footprint =
+                six::ortho::OrthoResampler::getInputFootprint(inputData,
+                                                              heightModel);
+        const double spacing = options->get<double>("spacing");
+        const six::ortho::OutputGrid grid =
+                options->get<std::string>("grid") == "plane" ?
+                six::ortho::OutputGrid::planar(
+                        footprint, height,
+                        types::RowCol<double>(spacing, spacing)) :
+                six::ortho::OutputGrid::geographic(
+                        footprint, height,
+                        types::RowCol<double>(spacing, spacing));
+
+        six::ortho::NITFInputImage inputImage(reader);
+        const six::ortho::InterpolationKernel kernel(
+                six::ortho::InterpolationKernel::toType(
+                        options->get<std::string>("kernel")));
+        six::ortho::OrthoResampler resampler(
+                inputData, inputImage, grid, kernel, heightModel,
+                std::max<size_t>(options->get<size_t>("threads"), 1));
+        resampler.setTileSize(options->get<size_t>("tileSize"));
+        if (options->get<bool>("exact"))
+        {
+            resampler.setProjectionMethod(six::ortho::OrthoResampler::EXACT);
+        }
+
+        const six::PixelType pixelType(
+                options->get<std::string>("pixelType"));
+        six::NITFWriteControl writer;
+        writer.setXMLControlRegistry(&xmlRegistry);
+        resampler.save(resampler.createDerivedData(pixelType),
+                       options->get<double>("scale"),
+                       writer,
+                       options->get<std::string>("output"),
+                       schemaPaths);
+
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
@@ -0,0 +1,523 @@
+/* =========================================================================
+ * This file is part of six.ortho-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.ortho-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <except/Exception.h>
+#include <math/linear/VectorN.h>
+#include <mem/ScopedArray.h>
+#include <sys/OS.h>
+#include <scene/Utilities.h>
+#include <six/NITFReadControl.h>
+#include <six/NITFWriteControl.h>
+#include <six/sidd/DerivedDataBuilder.h>
+#include <six/sidd/DerivedXMLControl.h>
+#include <six/sidd/Utilities.h>
+#include <import/six/ortho.h>
+
+namespace
+{
+const types::RowCol<size_t> INPUT_DIMS(200, 160);
+
+six::Vector3 normalize(const six::Vector3& vec)
+{
+    return vec / vec.norm();
+}
+
+// The input is linear in its pixels so that bilinear interpolation is exact
+double inputValue(double row, double col)
+{
+    return 10.0 + 0.5 * row + 0.25 * col;
+}
+
+// An airborne collect looking broadside at the scene, imaged in the slant
+// plane with 1 meter pixels
+std::auto_ptr<six::sidd::DerivedData> createInput()
+{
+    const six::Vector3 scp = scene::Utilities::latLonToECEF(
+            six::LatLonAlt(35.0, -110.0, 0.0));
+    const six::Vector3 up = normalize(scp);
+    std::vector<double> zAxis(3, 0.0);
+    zAxis[2] = 1.0;
+    const six::Vector3 east =
+            normalize(math::linear::cross(six::Vector3(zAxis), up));
+    const six::Vector3 north = math::linear::cross(up, east);
+
+    six::sidd::DerivedDataBuilder builder;
+    builder.addDisplay(six::PixelType::MONO8I);
+    builder.addGeographicAndTarget(six::RegionType::GEOGRAPHIC_INFO);
+    builder.addMeasurement(six::ProjectionType::PLANE);
+    builder.addExploitationFeatures(1);
+    std::auto_ptr<six::sidd::DerivedData> data(builder.steal());
+    data->setNumRows(INPUT_DIMS.row);
+    data->setNumCols(INPUT_DIMS.col);
+
+    // Flying north at 150 m/s, 10 km west of the scene and 8 km up
+    six::PolyXYZ& arpPoly(data->measurement->arpPoly);
+    arpPoly = six::PolyXYZ(1);
+    arpPoly[0] = scp + up * 8000.0 - east * 10000.0;
+    arpPoly[1] = north * 150.0;
+
+    six::sidd::PlaneProjection& projection =
+            static_cast<six::sidd::PlaneProjection&>(
+                    *data->measurement->projection);
+    projection.referencePoint.ecef = scp;
+    projection.referencePoint.rowCol = six::RowColDouble(100.0, 80.0);
+    projection.sampleSpacing = six::RowColDouble(1.0, 1.0);
+    projection.productPlane.rowUnitVector = normalize(scp - arpPoly[0]);
+    projection.productPlane.colUnitVector = north;
+
+    // Time COA is in meters from the SCP along the col direction
+    projection.timeCOAPoly = six::Poly2D(1, 1);
+    projection.timeCOAPoly[0][1] = 1.0 / 150.0;
+
+    data->productCreation->productName = "Slant";
+    data->productCreation->classification.classification = "U";
+
+    six::sidd::Information& information(
+            *data->exploitationFeatures->collections[0]->information);
+    information.sensorName = "Sensor";
+    information.radarMode = six::RadarModeType::SPOTLIGHT;
+    information.collectionDateTime = six::DateTime();
+    information.collectionDuration = 2.0;
+    information.resolution.rg = 1.2;
+    information.resolution.az = 1.2;
+    return data;
+}
+
+// A north-up 1 meter grid around the scene that's bigger than the input
+six::ortho::OutputGrid createPlanarGrid(const six::sidd::DerivedData& input)
+{
+    const six::Vector3& scp(input.measurement->projection->referencePoint.ecef);
+    const six::Vector3 up = normalize(scp);
+    std::vector<double> zAxis(3, 0.0);
+    zAxis[2] = 1.0;
+    const six::Vector3 east =
+            normalize(math::linear::cross(six::Vector3(zAxis), up));
+    const six::Vector3 south = math::linear::cross(up, east) * -1.0;
+
+    return six::ortho::OutputGrid(types::RowCol<size_t>(200, 160),
+                                  types::RowCol<double>(1.0, 1.0),
+                                  types::RowCol<double>(100.0, 80.0),
+                                  scp, south, east);
+}
+
+// Gently sloping terrain
+class SlopedHeightModel : public six::ortho::HeightModel
+{
+public:
+    virtual double getHeight(double lat, double lon) const
+    {
+        return 20.0 + 2000.0 * (lat - 35.0) - 1000.0 * (lon + 110.0);
+    }
+};
+
+struct TestInput
+{
+    TestInput() :
+        data(createInput()),
+        pixels(INPUT_DIMS.area()),
+        image(&pixels[0], INPUT_DIMS)
+    {
+        for (size_t row = 0; row < INPUT_DIMS.row; ++row)
+        {
+            for (size_t col = 0; col < INPUT_DIMS.col; ++col)
+            {
+                pixels[row * INPUT_DIMS.col + col] =
+                        static_cast<float>(inputValue(row, col));
+            }
+        }
+    }
+
+    const std::auto_ptr<six::sidd::DerivedData> data;
+    std::vector<float> pixels;
+    six::ortho::BufferInputImage image;
+};
+
+double maxDifference(const six::ortho::OrthoResampler& resampler,
+                     const six::ortho::OrthoResampler& expected)
+{
+    const types::RowCol<size_t>& dims(resampler.getOutputGrid().getDims());
+    const types::RowCol<size_t> start(0, 0);
+    std::vector<types::RowCol<double> > pixels(dims.area());
+    std::vector<types::RowCol<double> > expectedPixels(dims.area());
+    resampler.mapToInput(start, dims, &pixels[0]);
+    expected.mapToInput(start, dims, &expectedPixels[0]);
+
+    double difference(0.0);
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        difference = std::max(difference, std::max(
+                std::abs(pixels[ii].row - expectedPixels[ii].row),
+                std::abs(pixels[ii].col - expectedPixels[ii].col)));
+    }
+    return difference;
+}
+
+TEST_CASE(testKernels)
+{
+    typedef six::ortho::InterpolationKernel Kernel;
+    const Kernel nearest(Kernel::NEAREST);
+    const Kernel bilinear(Kernel::BILINEAR);
+    const Kernel sinc(Kernel::SINC);
+    TEST_ASSERT_EQ(nearest.getNumTaps(), 1);
+    TEST_ASSERT_EQ(bilinear.getNumTaps(), 2);
+    TEST_ASSERT_EQ(sinc.getNumTaps(), Kernel::DEFAULT_SINC_TAPS);
+
+    sys::SSize_T first;
+    TEST_ASSERT_EQ(nearest.getWeights(4.4, first)[0], 1.0f);
+    TEST_ASSERT_EQ(first, 4);
+    nearest.getWeights(4.6, first);
+    TEST_ASSERT_EQ(first, 5);
+    nearest.getWeights(-0.4, first);
+    TEST_ASSERT_EQ(first, 0);
+
+    const float* weights = bilinear.getWeights(7.25, first);
+    TEST_ASSERT_EQ(first, 7);
+    TEST_ASSERT_ALMOST_EQ_EPS(weights[0], 0.75, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(weights[1], 0.25, 1e-6);
+
+    // Sinc passes integer positions straight through
+    weights = sinc.getWeights(12.0, first);
+    TEST_ASSERT_EQ(first, 12 - static_cast<sys::SSize_T>(
+            (Kernel::DEFAULT_SINC_TAPS - 1) / 2));
+    for (size_t ii = 0; ii < sinc.getNumTaps(); ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(weights[ii],
+                                  static_cast<sys::SSize_T>(ii) ==
+                                          12 - first ? 1.0 : 0.0,
+                                  1e-6);
+    }
+
+    // Every phase is normalized
+    for (double position = -1.0; position < 1.0; position += 0.0371)
+    {
+        weights = sinc.getWeights(position, first);
+        double sum(0.0);
+        for (size_t ii = 0; ii < sinc.getNumTaps(); ++ii)
+        {
+            sum += weights[ii];
+        }
+        TEST_ASSERT_ALMOST_EQ_EPS(sum, 1.0, 1e-5);
+    }
+
+    TEST_ASSERT_EQ(Kernel::toType("bilinear"), Kernel::BILINEAR);
+    TEST_EXCEPTION(Kernel::toType("cubic"));
+    TEST_EXCEPTION(Kernel(Kernel::SINC, 7));
+}
+
+TEST_CASE(testMapping)
+{
+    TestInput input;
+    const six::ortho::OutputGrid grid(createPlanarGrid(*input.data));
+    const six::ortho::InterpolationKernel kernel(
+            six::ortho::InterpolationKernel::BILINEAR);
+
+    for (size_t useDem = 0; useDem < 2; ++useDem)
+    {
+        const six::ortho::ConstantHeightModel flat;
+        const SlopedHeightModel sloped;
+        const six::ortho::HeightModel& heightModel(
+                useDem ? static_cast<const six::ortho::HeightModel&>(sloped) :
+                         flat);
+
+        six::ortho::OrthoResampler exact(*input.data, input.image, grid,
+                                         kernel, heightModel);
+        exact.setProjectionMethod(six::ortho::OrthoResampler::EXACT);
+        six::ortho::OrthoResampler polynomial(*input.data, input.image, grid,
+                                              kernel, heightModel, 3);
+        polynomial.setTileSize(64);
+        TEST_ASSERT_LESSER(maxDifference(polynomial, exact), 1e-3);
+
+        // On flat ground the reference points line up
+        if (!useDem)
+        {
+            types::RowCol<double> pixel;
+            exact.mapToInput(types::RowCol<size_t>(100, 80),
+                             types::RowCol<size_t>(1, 1), &pixel);
+            TEST_ASSERT_ALMOST_EQ_EPS(pixel.row, 100.0, 1e-6);
+            TEST_ASSERT_ALMOST_EQ_EPS(pixel.col, 80.0, 1e-6);
+        }
+    }
+
+    // Same for a geographic grid over the same area
+    const six::ortho::OutputGrid geographic(six::ortho::OutputGrid::geographic(
+            grid.getCorners(), 0.0, types::RowCol<double>(0.03, 0.04)));
+    TEST_ASSERT_EQ(geographic.getProjectionType(),
+                   six::ProjectionType::GEOGRAPHIC);
+    const six::ortho::ConstantHeightModel flat;
+    six::ortho::OrthoResampler exact(*input.data, input.image, geographic,
+                                     kernel, flat);
+    exact.setProjectionMethod(six::ortho::OrthoResampler::EXACT);
+    const six::ortho::OrthoResampler polynomial(*input.data, input.image,
+                                                geographic, kernel, flat);
+    TEST_ASSERT_LESSER(maxDifference(polynomial, exact), 1e-3);
+
+    // The footprint's corners project back to the input's corners
+    const six::LatLonCorners footprint =
+            six::ortho::OrthoResampler::getInputFootprint(*input.data, flat);
+    const std::auto_ptr<scene::ProjectionModel> projModel(
+            six::sidd::Utilities::getProjectionModel(input.data.get()));
+    for (size_t ii = 0; ii < six::LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        const six::LatLon& corner(footprint.getCorner(ii));
+        const types::RowCol<double> imagePoint = projModel->sceneToImage(
+                scene::Utilities::latLonToECEF(six::LatLonAlt(
+                        corner.getLat(), corner.getLon(), 0.0)));
+        const bool isLastRow = ii == six::LatLonCorners::LOWER_RIGHT ||
+                ii == six::LatLonCorners::LOWER_LEFT;
+        const bool isLastCol = ii == six::LatLonCorners::UPPER_RIGHT ||
+                ii == six::LatLonCorners::LOWER_RIGHT;
+        TEST_ASSERT_ALMOST_EQ_EPS(imagePoint.row + 100.0,
+                                  isLastRow ? INPUT_DIMS.row - 1.0 : 0.0,
+                                  1e-3);
+        TEST_ASSERT_ALMOST_EQ_EPS(imagePoint.col + 80.0,
+                                  isLastCol ? INPUT_DIMS.col - 1.0 : 0.0,
+                                  1e-3);
+    }
+    TEST_ASSERT_ALMOST_EQ_EPS(six::ortho::OrthoResampler::getReferenceHeight(
+            *input.data), 0.0, 1e-6);
+
+    // The image has to match its metadata
+    six::ortho::BufferInputImage tooSmall(&input.pixels[0],
+                                          types::RowCol<size_t>(10, 10));
+    TEST_EXCEPTION(six::ortho::OrthoResampler(*input.data, tooSmall, grid,
+                                              kernel, flat));
+}
+
+TEST_CASE(testResample)
+{
+    typedef six::ortho::InterpolationKernel Kernel;
+    TestInput input;
+    const six::ortho::OutputGrid grid(createPlanarGrid(*input.data));
+    const types::RowCol<size_t>& dims(grid.getDims());
+    const six::ortho::ConstantHeightModel flat(5.0);
+
+    six::ortho::OrthoResampler exact(*input.data, input.image, grid,
+                                     Kernel(Kernel::NEAREST), flat);
+    exact.setProjectionMethod(six::ortho::OrthoResampler::EXACT);
+    std::vector<types::RowCol<double> > inputPixels(dims.area());
+    exact.mapToInput(types::RowCol<size_t>(0, 0), dims, &inputPixels[0]);
+
+    const Kernel::Type types[] = {Kernel::NEAREST, Kernel::BILINEAR,
+                                  Kernel::SINC};
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        const Kernel kernel(types[ii]);
+
+        // Tiles that don't divide the grid, and more threads than needed
+        six::ortho::OrthoResampler resampler(*input.data, input.image, grid,
+                                             kernel, flat, 3);
+        resampler.setTileSize(37);
+        std::vector<float> output(dims.area());
+        resampler.resample(0, dims.row, &output[0]);
+
+        // Strips are independent of how they're requested
+        six::ortho::OrthoResampler serial(*input.data, input.image, grid,
+                                          kernel, flat);
+        serial.setTileSize(37);
+        std::vector<float> serialOutput(dims.area());
+        serial.resample(0, 50, &serialOutput[0]);
+        serial.resample(50, dims.row - 50, &serialOutput[50 * dims.col]);
+        TEST_ASSERT(output == serialOutput);
+
+        size_t numValid(0);
+        for (size_t jj = 0; jj < output.size(); ++jj)
+        {
+            const types::RowCol<double>& pixel(inputPixels[jj]);
+            if (pixel.row < -0.5 || pixel.row > INPUT_DIMS.row - 0.5 ||
+                pixel.col < -0.5 || pixel.col > INPUT_DIMS.col - 0.5)
+            {
+                TEST_ASSERT_EQ(output[jj], 0.0f);
+                continue;
+            }
+
+            // Stay clear of the edges, where the kernels run off the image
+            if (pixel.row < 4.0 || pixel.row > INPUT_DIMS.row - 5.0 ||
+                pixel.col < 4.0 || pixel.col > INPUT_DIMS.col - 5.0)
+            {
+                continue;
+            }
+            ++numValid;
+
+            if (types[ii] == Kernel::NEAREST)
+            {
+                TEST_ASSERT_ALMOST_EQ_EPS(
+                        output[jj],
+                        inputValue(std::floor(pixel.row + 0.5),
+                                   std::floor(pixel.col + 0.5)),
+                        1e-3);
+            }
+            else
+            {
+                // Windowed sinc only approximates a ramp
+                const double tolerance =
+                        types[ii] == Kernel::BILINEAR ? 1e-2 : 0.1;
+                TEST_ASSERT_ALMOST_EQ_EPS(
+                        output[jj], inputValue(pixel.row, pixel.col),
+                        tolerance);
+            }
+        }
+
+        // The grid is bigger than the input, but most of it is covered
+        TEST_ASSERT_GREATER(numValid, dims.area() / 2);
+        TEST_ASSERT_LESSER(numValid, dims.area());
+    }
+
+    std::vector<float> output(dims.area());
+    TEST_EXCEPTION(exact.resample(1, dims.row, &output[0]));
+}
+
+TEST_CASE(testSave)
+{
+    typedef six::ortho::InterpolationKernel Kernel;
+    TestInput input;
+    const six::ortho::OutputGrid grid(createPlanarGrid(*input.data));
+    const types::RowCol<size_t>& dims(grid.getDims());
+    const six::ortho::ConstantHeightModel flat;
+    six::ortho::OrthoResampler resampler(*input.data, input.image, grid,
+                                         Kernel(Kernel::BILINEAR), flat, 2);
+    resampler.setTileSize(64);
+
+    std::auto_ptr<six::sidd::DerivedData> data(
+            resampler.createDerivedData(six::PixelType::MONO16I));
+    TEST_EXCEPTION(resampler.createDerivedData(six::PixelType::RGB24I));
+    TEST_ASSERT_EQ(data->getNumRows(), dims.row);
+    TEST_ASSERT_EQ(data->getNumCols(), dims.col);
+    TEST_ASSERT_EQ(data->productCreation->productName, "Slant");
+    TEST_ASSERT_EQ(data->exploitationFeatures->collections[0]->
+                           information->sensorName, "Sensor");
+    TEST_ASSERT(data->exploitationFeatures->collections[0]->geometry.get());
+    TEST_ASSERT_EQ(data->display->magnificationMethod,
+                   six::MagnificationMethod::BILINEAR);
+
+    // The new projection agrees with the output grid
+    {
+        const std::auto_ptr<scene::ProjectionModel> projModel(
+                six::sidd::Utilities::getProjectionModel(data.get()));
+        const std::auto_ptr<scene::GridECEFTransform> transform(
+                grid.getGridTransform());
+        for (size_t row = 0; row < dims.row; row += 33)
+        {
+            for (size_t col = 0; col < dims.col; col += 27)
+            {
+                const six::Vector3 ground =
+                        transform->rowColToECEF(row, col);
+                const types::RowCol<double> imagePoint =
+                        projModel->sceneToImage(ground);
+                TEST_ASSERT_ALMOST_EQ_EPS(imagePoint.row, row - 100.0, 1e-2);
+                TEST_ASSERT_ALMOST_EQ_EPS(imagePoint.col, col - 80.0, 1e-2);
+            }
+        }
+    }
+
+    std::vector<float> expected(dims.area());
+    resampler.resample(0, dims.row, &expected[0]);
+
+    const std::string pathname("test_ortho_resampler.nitf");
+    six::XMLControlRegistry xmlRegistry;
+    xmlRegistry.addCreator(
+            six::DataType::DERIVED,
+            new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
+    {
+        six::NITFWriteControl writer;
+        writer.setXMLControlRegistry(&xmlRegistry);
+        resampler.save(data, 100.0, writer, pathname);
+    }
+
+    six::NITFReadControl reader;
+    reader.setXMLControlRegistry(&xmlRegistry);
+    reader.load(pathname);
+    const six::sidd::DerivedData& readData =
+            static_cast<const six::sidd::DerivedData&>(
+                    *reader.getContainer()->getData(0));
+    TEST_ASSERT_EQ(readData.getNumRows(), dims.row);
+    TEST_ASSERT_EQ(readData.getNumCols(), dims.col);
+    TEST_ASSERT_EQ(readData.measurement->pixelFootprint.row,
+                   static_cast<sys::SSize_T>(dims.row));
+    TEST_ASSERT_EQ(readData.measurement->projection->projectionType,
+                   six::ProjectionType::PLANE);
+    TEST_ASSERT_ALMOST_EQ_EPS(
+            (readData.measurement->projection->referencePoint.ecef -
+             grid.getReferencePoint()).norm(), 0.0, 1e-6);
+
+    const six::LatLonCorners corners(grid.getCorners());
+    const six::LatLonCorners& footprint(
+            readData.geographicAndTarget->geographicCoverage.footprint);
+    for (size_t ii = 0; ii < six::LatLonCorners::NUM_CORNERS; ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(footprint.getCorner(ii).getLat(),
+                                  corners.getCorner(ii).getLat(), 1e-9);
+        TEST_ASSERT_ALMOST_EQ_EPS(footprint.getCorner(ii).getLon(),
+                                  corners.getCorner(ii).getLon(), 1e-9);
+    }
+
+    six::Region region;
+    const mem::ScopedArray<six::UByte> buffer(reader.interleaved(region, 0));
+    const sys::Uint16_T* const pixels =
+            reinterpret_cast<const sys::Uint16_T*>(buffer.get());
+    for (size_t ii = 0; ii < expected.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(pixels[ii], static_cast<sys::Uint16_T>(
+                expected[ii] * 100.0 + 0.5));
+    }
+
+    try
+    {
+        sys::OS().remove(pathname);
+    }
+    catch (...)
+    {
+    }
+}
+}
+
+int main(int, char**)
+{
+    try
+    {
+        TEST_CHECK(testKernels);
+        TEST_CHECK(testMapping);
+        TEST_CHECK(testResample);
+        TEST_CHECK(testSave);
+        return 0;
+    }
+    catch (const except::Exception& e)
+    {
+        std::cerr << "Caught exception: " << e.getMessage() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
@@ -41,6 +41,9 @@
 #include "six/sicd/RadarCollection.h"
 #include "six/sicd/RgAzComp.h"
 #include "six/sicd/SCPCOA.h"
+#include "six/sicd/SpectralProcessor.h"
+#include "six/sicd/SpectralSplitter.h"
+#include "six/sicd/SpectralWeighter.h"
 #include "six/sicd/Utilities.h"
 
 #endif
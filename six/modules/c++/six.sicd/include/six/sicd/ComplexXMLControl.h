@@ -63,6 +63,16 @@ protected:
      */
     virtual xml::lite::Document* toXMLImpl(const Data* data);
 
+    /*!
+     *  Writes a ComplexData object out as XML without building a DOM.
+     *  The output is the same as printing the DOM from the other
+     *  toXMLImpl().
+     *
+     *  \param data       A ComplexData object
+     *  \param xmlStream  Stream to write the XML to
+     */
+    virtual void toXMLImpl(const Data* data, io::OutputStream& xmlStream);
+
     /*!
      *  Function takes a DOM Document* node and creates a new-allocated
      *  ComplexData* populated by the DOM.  
@@ -0,0 +1,154 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_COMPLEX_XML_WRITER_H__
+#define __SIX_COMPLEX_XML_WRITER_H__
+
+#include <memory>
+#include <string>
+
+#include <six/XMLStreamWriter.h>
+#include <six/SICommonXMLWriter.h>
+#include <six/sicd/ComplexData.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ *  \class ComplexXMLWriter
+ *  \brief Streams SICD XML without building a DOM
+ *
+ *  Produces the same bytes as the ComplexXMLParser for the same version
+ *  followed by xml::lite::Element::print(), and throws for the same
+ *  problems in the data.  Where the parsers split the version differences
+ *  across a class per version, they're all handled here.
+ *
+ *  Supports SICD 0.4.0, 0.4.1, 0.5.0, 1.0.0, 1.0.1, 1.1.0 and 1.2.0.
+ */
+class ComplexXMLWriter
+{
+public:
+    /*!
+     *  \param version  SICD version to write (e.g. "1.1.0")
+     *  \param writer   Where the XML goes
+     */
+    ComplexXMLWriter(const std::string& version, six::XMLStreamWriter& writer);
+
+    //! Writes the whole SICD XML for data.  Doesn't flush the writer.
+    void write(const ComplexData& data);
+
+private:
+    enum Version
+    {
+        VERSION_040,
+        VERSION_041,
+        VERSION_050,
+        VERSION_100,
+        VERSION_101
+    };
+
+    static Version toVersion(const std::string& version);
+
+    bool is04x() const
+    {
+        return mVersion == VERSION_040 || mVersion == VERSION_041;
+    }
+
+    bool is10x() const
+    {
+        return mVersion == VERSION_100 || mVersion == VERSION_101;
+    }
+
+    six::SICommonXMLWriter& common()
+    {
+        return *mCommon;
+    }
+
+    void writeIndexedDouble(const std::string& name,
+                            double value,
+                            size_t index);
+
+    void writeFFTSign(const std::string& name, six::FFTSign sign);
+
+    void writeLatLonFootprint(const std::string& name,
+                              const std::string& cornerName,
+                              const LatLonCorners& corners);
+
+    void writeLatLonAltFootprint(const std::string& name,
+                                 const std::string& cornerName,
+                                 const LatLonAltCorners& corners);
+
+    void writeCollectionInformation(const CollectionInformation& collInfo);
+    void writeImageCreation(const ImageCreation& imageCreation);
+    void writeImageData(const ImageData& imageData);
+    void writeGeoData(const GeoData& geoData);
+    void writeGeoInfo(const GeoInfo& geoInfo);
+    void writeGeoInfoGeometry(const GeoInfo& geoInfo);
+    void writeGrid(const Grid& grid);
+    void writeDirectionParameters(const std::string& name,
+                                  const DirectionParameters& params);
+    void writeWeightType(const WeightType& weightType);
+    void writeTimeline(const Timeline& timeline);
+    void writePosition(const Position& position);
+    void writeRadarCollection(const RadarCollection& radar);
+    void writeTxFrequency(const RadarCollection& radar);
+    void writeTxSequence(const RadarCollection& radar);
+    void writeWaveform(const RadarCollection& radar);
+    void writeRcvChannels(const RadarCollection& radar);
+    void writeArea(const RadarCollection& radar);
+    void writeAreaDirectionParameters(const std::string& name,
+                                      const std::string& spacingName,
+                                      const std::string& numName,
+                                      const std::string& firstName,
+                                      const AreaDirectionParameters& adp);
+    void writeImageFormation(const ImageFormation& imageFormation,
+                             const RadarCollection& radarCollection);
+    void writeRcvChanProc(const RcvChannelProcessed* rcvChanProc);
+    void writeProcessing(const Processing& processing);
+    void writeDistortion(const Distortion* distortion);
+    void writeSCPCOA(const SCPCOA& scpcoa);
+    void writeAntenna(const Antenna& antenna);
+    void writeAntennaParameters(const std::string& name,
+                                const AntennaParameters& params);
+    void writeMatchInformation(const MatchInformation& matchInfo);
+    void writeImageFormationAlgo(const PFA* pfa,
+                                 const RMA* rma,
+                                 const RgAzComp* rgAzComp);
+    void writePFA(const PFA& pfa);
+    void writeRMA(const RMA& rma);
+    void writeRMAT(const RMAT& rmat);
+    void writeRMCR(const RMCR& rmcr);
+    void writeINCA(const INCA& inca);
+    void writeRgAzComp(const RgAzComp& rgAzComp);
+
+    // Throws the same error XMLParser::require() does if nothing was written
+    static void require(bool written, const std::string& name);
+
+    const Version mVersion;
+    const std::string mVersionString;
+    six::XMLStreamWriter& mWriter;
+    std::auto_ptr<six::SICommonXMLWriter> mCommon;
+};
+}
+}
+
+#endif
@@ -72,6 +72,21 @@ private:
     double mBeta;
 
 };
+
+/*!
+ *   \class Taylor
+ *   \brief Taylor window with 'nbar' nearly constant level sidelobes
+ *   'sidelobeLevel' dB below the peak, normalized to a peak of 1
+ */
+class Taylor : public Functor
+{
+public:
+    Taylor(size_t nbar, double sidelobeLevel);
+    virtual std::vector<double> operator()(size_t n) const;
+private:
+    size_t mNbar;
+    double mSidelobeLevel;
+};
 }
 }
 #endif
@@ -147,9 +147,17 @@ struct DirectionParameters
     void fillDerivedFields(const ImageData& imageData);
     void fillDerivedFields(const RgAzComp& rgAzComp, double offset = 0);
 
-private:
+    /*!
+     *  \return The window described by weightType, or NULL if there's
+     *  no weightType or it isn't one we know how to build
+     */
     std::auto_ptr<Functor> calculateWeightFunction() const;
 
+    //! Number of samples in weights when they're filled in from weightType
+    static const size_t DEFAULT_WEIGHT_SIZE;
+
+private:
+
     bool validateWeights(const Functor& weightFunction,
             logging::Logger& log) const;
 
@@ -170,7 +178,10 @@ private:
             const ImageData& imageData) const;
 
     static const double WGT_TOL;
-    static const size_t DEFAULT_WEIGHT_SIZE;
+
+    //! Number of samples per dimension used when searching the valid data
+    //  of the image for the extent of DeltaKCOAPoly
+    static const size_t DELTAK_LATTICE_SIZE;
     static const char BOUNDS_ERROR_MESSAGE[];
 
 };
@@ -84,7 +84,11 @@ public:
 private:
     const scene::SceneGeometry mGeom;
     const scene::ProjectionModel& mProjection;
-    const six::sicd::ComplexData mSicdData;
+
+    //! Only what's needed to turn a pixel into an image point, so that
+    //! constructing one of these doesn't copy all of the SICD metadata
+    const types::RowCol<double> mOffset;
+    const types::RowCol<double> mSampleSpacing;
     scene::Vector3 mGroundPlaneNormal;
 };
 
@@ -0,0 +1,197 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_SPECTRAL_PROCESSOR_H__
+#define __SIX_SICD_SPECTRAL_PROCESSOR_H__
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <types/RowCol.h>
+#include <six/NITFReadControl.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/SICDWriteControl.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ *  \class SpectralProcessor
+ *  \brief Base class for filtering a SICD's spatial frequency support
+ *
+ *  Provides what the spectral filters have in common: the applied
+ *  weighting in each direction, reading and writing strips of complex
+ *  float or complex short pixels as complex floats, a limit on how much
+ *  of the image is in memory at once, and splitting work up between
+ *  threads.
+ */
+class SpectralProcessor
+{
+public:
+    static const size_t DEFAULT_MAX_MEMORY;
+
+    virtual ~SpectralProcessor();
+
+    size_t getMaxMemory() const
+    {
+        return mMaxMemory;
+    }
+
+    //! Largest strip, in bytes, that streaming keeps in memory
+    void setMaxMemory(size_t maxMemory)
+    {
+        mMaxMemory = maxMemory;
+    }
+
+    /*!
+     *  \return Half-power width of the impulse response, in meters, of
+     *  'weights' spread evenly over 'bandwidth' cycles/meter.  Empty
+     *  weights are uniform.
+     */
+    static double computeImpulseResponseWidth(
+            const std::vector<double>& weights, double bandwidth);
+
+protected:
+    /*
+     *  \param data Metadata for the SICD to process
+     *  \param numThreads Number of threads to use
+     *  \param name Name of the processing for error messages
+     */
+    SpectralProcessor(const ComplexData& data,
+                      size_t numThreads,
+                      const std::string& name);
+
+    // Linearly interpolates weights, normalized to a peak of 1, at a
+    // position in [0, 1]
+    class Window
+    {
+    public:
+        Window(const std::vector<double>& weights);
+
+        double operator()(double position) const;
+
+    private:
+        const std::vector<double> mWeights;
+        double mPeak;
+    };
+
+    //! 1 for a POS FFT sign, -1 for NEG
+    static int getSign(const DirectionParameters& direction);
+
+    //! Samples of the window 'direction' has, or nothing if it's uniform
+    static std::vector<double> getWeights(const DirectionParameters& direction);
+
+    //! Samples of 'weightType', or nothing if it's uniform
+    static std::vector<double> getWeights(const WeightType& weightType);
+
+    /*
+     *  Throws unless 'direction' has a positive sample spacing and impulse
+     *  response bandwidth
+     */
+    void checkSupport(const DirectionParameters& direction) const;
+
+    //! Throws unless the SICD's pixels are complex float or complex short
+    void checkPixelType() const;
+
+    /*
+     *  Spatial frequency offset from DeltaKCOAPoly at the SCP of each of
+     *  'size' spectral samples, wrapped to within half a cycle per sample
+     */
+    static std::vector<double> getOffsets(const DirectionParameters& direction,
+                                          size_t size);
+
+    //! Reads an AOI of the SICD as complex floats
+    void readStrip(NITFReadControl& reader,
+                   const types::RowCol<size_t>& offset,
+                   const types::RowCol<size_t>& dims,
+                   std::complex<float>* strip) const;
+
+    /*
+     *  Writes an AOI of complex floats in the SICD's pixel type.  Complex
+     *  shorts are rounded and clamped.  The strip is scratch space
+     *  afterwards.
+     */
+    void writeStrip(SICDWriteControl& writer,
+                    const types::RowCol<size_t>& offset,
+                    const types::RowCol<size_t>& dims,
+                    std::complex<float>* strip) const;
+
+    /*
+     *  Runs RunnableT(context, start, count) over [0, numItems), split up
+     *  between threads.  A single runnable is run on this thread.
+     */
+    template <typename RunnableT, typename ContextT>
+    void runInParallel(const ContextT& context, size_t numItems) const
+    {
+        std::vector<sys::Runnable*> runnables;
+        try
+        {
+            const mt::ThreadPlanner planner(numItems,
+                                            std::min(mNumThreads, numItems));
+
+            size_t threadNum(0);
+            size_t startItem(0);
+            size_t numItemsThisThread(0);
+            while (planner.getThreadInfo(threadNum++,
+                                         startItem,
+                                         numItemsThisThread))
+            {
+                runnables.push_back(
+                        new RunnableT(context, startItem, numItemsThisThread));
+            }
+        }
+        catch (...)
+        {
+            for (size_t ii = 0; ii < runnables.size(); ++ii)
+            {
+                delete runnables[ii];
+            }
+            throw;
+        }
+
+        if (runnables.size() == 1)
+        {
+            const std::auto_ptr<sys::Runnable> runnable(runnables[0]);
+            runnable->run();
+            return;
+        }
+
+        mt::ThreadGroup threads;
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            threads.createThread(runnables[ii]);
+        }
+        threads.joinAll();
+    }
+
+    const std::auto_ptr<ComplexData> mData;
+    const size_t mNumThreads;
+    const std::string mName;
+    size_t mMaxMemory;
+};
+}
+}
+
+#endif
@@ -0,0 +1,159 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_SPECTRAL_SPLITTER_H__
+#define __SIX_SICD_SPECTRAL_SPLITTER_H__
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <six/NITFReadControl.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/SpectralProcessor.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ *  \class SpectralSplitter
+ *  \brief Splits a SICD into sub-aperture or sub-band images
+ *
+ *  The ImpRespBW support of the Col (sub-aperture) or Row (sub-band)
+ *  direction, centered on DeltaKCOAPoly at the SCP, is cut into
+ *  overlapping windows of equal width, in order of increasing spatial
+ *  frequency.  Each row (sub-aperture) or column (sub-band) is transformed
+ *  to spatial frequency once, and each output is the inverse transform of
+ *  its window of that spectrum.  The spectrum isn't moved, so each output
+ *  has the same pixel grid and KCtr as the input, and its DeltaKCOAPoly is
+ *  offset to the center of its window.  Whatever weighting was applied
+ *  stays applied.
+ *
+ *  Sub-apertures also get the part of the collection they came from.  Its
+ *  times come from the PFA polar angle polynomial when there is one, and
+ *  are otherwise taken to be linear in spatial frequency over the
+ *  processed time.  SCPCOA is rederived at the middle of that time, and
+ *  the IPP sets and processed time are trimmed to it.  Sub-bands get the
+ *  matching part of the processed transmit frequencies.
+ *
+ *  SICDs are streamed a strip at a time.  The strip and every output's
+ *  part of it need to fit in getMaxMemory() bytes.  The FFTs in each strip
+ *  are split up between threads.
+ */
+class SpectralSplitter : public SpectralProcessor
+{
+public:
+    //! Which direction's support is split
+    enum Split
+    {
+        SUB_APERTURE, //!< Col
+        SUB_BAND      //!< Row
+    };
+
+    /*!
+     *  \param data Metadata for the SICD to split
+     *  \param split Which direction to split
+     *  \param numOutputs Number of images to split it into
+     *  \param overlap Fraction, in [0, 1), of each window that overlaps the
+     *  next one
+     *  \param numThreads Number of threads to use
+     */
+    SpectralSplitter(const ComplexData& data,
+                     Split split,
+                     size_t numOutputs,
+                     double overlap,
+                     size_t numThreads);
+
+    size_t getNumOutputs() const
+    {
+        return mNumOutputs;
+    }
+
+    /*!
+     *  Splits an image in memory
+     *
+     *  \param image The SICD's pixels, row major.  They're scratch space
+     *  afterwards.
+     *  \param outputs getNumOutputs() images the size of 'image'
+     */
+    void split(std::complex<float>* image,
+               const std::vector<std::complex<float>*>& outputs) const;
+
+    /*!
+     *  Splits a SICD a strip at a time.  Complex float and complex short
+     *  pixels are supported.  Complex shorts are rounded and clamped.
+     *
+     *  \param reader Reader that's already loaded the SICD this was
+     *  constructed with
+     *  \param schemaPaths Schema paths to use for writing
+     *  \param outPathnames getNumOutputs() output SICD pathnames
+     */
+    void split(NITFReadControl& reader,
+               const std::vector<std::string>& schemaPaths,
+               const std::vector<std::string>& outPathnames) const;
+
+    /*!
+     *  \return Metadata for 0 based output 'output'.  The split direction's
+     *  support, weighting and IPR width are its window's, and the
+     *  collection times or frequencies are the part it came from.
+     */
+    std::auto_ptr<ComplexData> createComplexData(size_t output) const;
+
+private:
+    const DirectionParameters& getDirection() const;
+
+    // Fraction of the support, in [0, 1], that 'output' starts at
+    double getStart(size_t output) const;
+
+    // Seconds since collect start that 'position' in [0, 1] of the Col
+    // support was collected
+    double getTime(double position) const;
+
+    // Each output's window of 'size' spectral samples, scaled by 1 / size
+    // for the round trip through the FFT
+    std::vector<std::vector<float> > getFilters(size_t size) const;
+
+    // Splits a strip of whole rows (sub-aperture) or whole columns
+    // (sub-band).  'strip' is scratch space afterwards.
+    void splitStrip(const std::vector<std::vector<float> >& filters,
+                    std::complex<float>* strip,
+                    const types::RowCol<size_t>& dims,
+                    const std::vector<std::complex<float>*>& outputs) const;
+
+    void updateSubaperture(double start, ComplexData& data) const;
+
+    void updateSubband(double start, ComplexData& data) const;
+
+private:
+    const Split mSplit;
+    const size_t mNumOutputs;
+
+    // Fractions of the support each window covers, and between the
+    // starts of adjacent windows
+    double mWidth;
+    double mStep;
+};
+}
+}
+
+#endif
@@ -0,0 +1,145 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_SICD_SPECTRAL_WEIGHTER_H__
+#define __SIX_SICD_SPECTRAL_WEIGHTER_H__
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <six/NITFReadControl.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/SpectralProcessor.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ *  \class SpectralWeighter
+ *  \brief Changes the aperture weighting of a SICD
+ *
+ *  The weighting along each direction is a separable window over that
+ *  direction's ImpRespBW support, centered on DeltaKCOAPoly at the SCP.
+ *  Each row (for Col weighting) and column (for Row weighting) is
+ *  transformed to spatial frequency, multiplied by the new window divided
+ *  by the applied one, and transformed back.  Spectrum outside the support
+ *  is zeroed.  Deweighting is reweighting to UNIFORM.
+ *
+ *  The applied weighting comes from the Grid's WgtFunct if it has one,
+ *  and otherwise from its WgtType.  Windows are never divided by less than
+ *  MIN_WEIGHT of their peak, so deweighting a window that goes to 0 at
+ *  the edges stays bounded.
+ *
+ *  SICDs are streamed a strip at a time: first strips of rows have their
+ *  Col weighting changed into a scratch file, then strips of columns have
+ *  their Row weighting changed and are written out.  Only the strips need
+ *  to fit in getMaxMemory() bytes.  The FFTs in each strip are split up
+ *  between threads.
+ */
+class SpectralWeighter : public SpectralProcessor
+{
+public:
+    static const double MIN_WEIGHT;
+
+    /*!
+     *  \param data Metadata for the SICD to reweight.  Its weighting is
+     *  kept unless it's changed.
+     *  \param numThreads Number of threads to use
+     */
+    SpectralWeighter(const ComplexData& data, size_t numThreads);
+
+    //! Applies 'weightType' along the Row direction
+    void setRowWeighting(const WeightType& weightType);
+
+    //! Applies 'weightType' along the Col direction
+    void setColWeighting(const WeightType& weightType);
+
+    //! Removes the weighting in both directions
+    void deweight();
+
+    /*!
+     *  Reweights an image in memory
+     *
+     *  \param image The SICD's pixels, row major
+     */
+    void apply(std::complex<float>* image) const;
+
+    /*!
+     *  Reweights a SICD a strip at a time.  Complex float and complex short
+     *  pixels are supported.  Complex shorts are rounded and clamped.
+     *
+     *  \param reader Reader that's already loaded the SICD this was
+     *  constructed with
+     *  \param schemaPaths Schema paths to use for writing
+     *  \param outPathname Reweighted SICD pathname
+     */
+    void apply(NITFReadControl& reader,
+               const std::vector<std::string>& schemaPaths,
+               const std::string& outPathname) const;
+
+    /*!
+     *  \return Metadata for the reweighted SICD.  WgtType, WgtFunct and
+     *  ImpRespWid reflect the new weighting.
+     */
+    std::auto_ptr<ComplexData> createComplexData() const;
+
+    const std::string& getScratchDirectory() const
+    {
+        return mScratchDirectory;
+    }
+
+    //! Directory for streaming's scratch file
+    void setScratchDirectory(const std::string& scratchDirectory)
+    {
+        mScratchDirectory = scratchDirectory;
+    }
+
+private:
+    // Multiplies each of 'size' spectral samples of 'direction', scaled
+    // by 1 / size for the round trip through the FFT
+    std::vector<float> getFilter(const DirectionParameters& direction,
+                                 const WeightType& weightType,
+                                 size_t size) const;
+
+    // Reweights 'numRows' rows, each filter.size() long, in Col
+    void applyCol(const std::vector<float>& filter,
+                  std::complex<float>* rows,
+                  size_t numRows) const;
+
+    // Reweights 'numCols' columns, each filter.size() long, in Row
+    void applyRow(const std::vector<float>& filter,
+                  std::complex<float>* cols,
+                  size_t numCols) const;
+
+private:
+    // NULL if the direction's weighting isn't changing
+    std::auto_ptr<WeightType> mRowWeighting;
+    std::auto_ptr<WeightType> mColWeighting;
+    std::string mScratchDirectory;
+};
+}
+}
+
+#endif
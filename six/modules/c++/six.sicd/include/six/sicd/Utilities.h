@@ -32,6 +32,7 @@
 #include <six/sicd/ComplexData.h>
 
 #include <six/NITFReadControl.h>
+#include <six/ValidDataMask.h>
 
 namespace six
 {
@@ -57,6 +58,14 @@ public:
             const scene::ProjectionModel& projection,
             std::vector<types::RowCol<double> >& validData);
 
+    /*
+     * Rasterizes the polygon from getValidDataPolygon() into per-row spans
+     * of valid pixels.  If there is no polygon, the whole image is valid.
+     */
+    static std::auto_ptr<ValidDataMask> getValidDataMask(
+            const ComplexData& sicdData,
+            const scene::ProjectionModel& projection);
+
 
     /*
      * Given a SICD path name and a list of schema, this function reads
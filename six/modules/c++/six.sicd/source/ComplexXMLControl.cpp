@@ -27,6 +27,7 @@
 #include <six/sicd/ComplexXMLParser050.h>
 #include <six/sicd/ComplexXMLParser100.h>
 #include <six/sicd/ComplexXMLParser101.h>
+#include <six/sicd/ComplexXMLWriter.h>
 
 namespace six
 {
@@ -53,6 +54,20 @@ xml::lite::Document* ComplexXMLControl::toXMLImpl(const Data* data)
     return getParser(data->getVersion())->toXML(sicd);
 }
 
+void ComplexXMLControl::toXMLImpl(const Data* data,
+                                  io::OutputStream& xmlStream)
+{
+    if (data->getDataType() != DataType::COMPLEX)
+    {
+        throw except::Exception(Ctxt("Data must be SICD"));
+    }
+
+    six::XMLStreamWriter writer(xmlStream);
+    ComplexXMLWriter(data->getVersion(), writer).write(
+            *reinterpret_cast<const ComplexData*>(data));
+    writer.flush();
+}
+
 std::auto_ptr<ComplexXMLParser>
 ComplexXMLControl::getParser(const std::string& version) const
 {
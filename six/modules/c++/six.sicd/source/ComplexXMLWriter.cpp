@@ -0,0 +1,1468 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <except/Exception.h>
+#include <str/Format.h>
+#include <six/Utilities.h>
+#include <six/SICommonXMLWriter01x.h>
+#include <six/SICommonXMLWriter10x.h>
+#include <six/sicd/ComplexXMLWriter.h>
+
+namespace
+{
+const std::string NO_PREFIX;
+
+// Matches the SICommonXMLParser050 that ComplexXMLParser050 uses, which
+// differs from 0.1.x in that the radiometric noise level has a type
+class SICommonXMLWriter050 : public six::SICommonXMLWriter01x
+{
+public:
+    SICommonXMLWriter050(six::XMLStreamWriter& writer) :
+        six::SICommonXMLWriter01x(writer, false, NO_PREFIX)
+    {
+    }
+
+    virtual void writeRadiometry(const six::Radiometric& radiometric);
+};
+
+void SICommonXMLWriter050::writeRadiometry(
+        const six::Radiometric& radiometric)
+{
+    mWriter.startElement("Radiometric");
+
+    if (!radiometric.noiseLevel.noisePoly.empty())
+    {
+        writePoly2D("NoisePoly", radiometric.noiseLevel.noisePoly);
+    }
+
+    if (!radiometric.noiseLevel.noiseType.empty())
+    {
+        writeString("NoiseLevelType", radiometric.noiseLevel.noiseType);
+    }
+
+    if (!radiometric.rcsSFPoly.empty())
+    {
+        writePoly2D("RCSSFPoly", radiometric.rcsSFPoly);
+    }
+
+    if (!radiometric.betaZeroSFPoly.empty())
+    {
+        writePoly2D("BetaZeroSFPoly", radiometric.betaZeroSFPoly);
+    }
+
+    if (!radiometric.sigmaZeroSFPoly.empty())
+    {
+        writePoly2D("SigmaZeroSFPoly", radiometric.sigmaZeroSFPoly);
+    }
+
+    if (radiometric.sigmaZeroSFIncidenceMap != six::AppliedType::NOT_SET)
+    {
+        writeString("SigmaZeroSFIncidenceMap",
+                    six::toString<six::AppliedType>(
+                            radiometric.sigmaZeroSFIncidenceMap));
+    }
+
+    if (!radiometric.gammaZeroSFPoly.empty())
+    {
+        writePoly2D("GammaZeroSFPoly", radiometric.gammaZeroSFPoly);
+    }
+
+    if (radiometric.gammaZeroSFIncidenceMap != six::AppliedType::NOT_SET)
+    {
+        writeString("GammaZeroSFIncidenceMap",
+                    six::toString<six::AppliedType>(
+                            radiometric.gammaZeroSFIncidenceMap));
+    }
+
+    mWriter.endElement();
+}
+}
+
+namespace six
+{
+namespace sicd
+{
+ComplexXMLWriter::ComplexXMLWriter(const std::string& version,
+                                   six::XMLStreamWriter& writer) :
+    mVersion(toVersion(version)),
+    mVersionString(version),
+    mWriter(writer)
+{
+    switch (mVersion)
+    {
+    case VERSION_040:
+    case VERSION_041:
+        mCommon.reset(new six::SICommonXMLWriter01x(writer, true, NO_PREFIX));
+        break;
+    case VERSION_050:
+        mCommon.reset(new SICommonXMLWriter050(writer));
+        break;
+    default:
+        mCommon.reset(new six::SICommonXMLWriter10x(writer, false, NO_PREFIX));
+        break;
+    }
+}
+
+ComplexXMLWriter::Version
+ComplexXMLWriter::toVersion(const std::string& version)
+{
+    // Same versions, and same parser for each, as ComplexXMLControl
+    if (version == "0.4.0")
+    {
+        return VERSION_040;
+    }
+    if (version == "0.4.1")
+    {
+        return VERSION_041;
+    }
+    if (version == "0.5.0")
+    {
+        return VERSION_050;
+    }
+    if (version == "1.0.0")
+    {
+        return VERSION_100;
+    }
+    if (version == "1.0.1" || version == "1.1.0" || version == "1.2.0")
+    {
+        return VERSION_101;
+    }
+
+    throw except::Exception(Ctxt("Unsupported SICD Version: " + version));
+}
+
+void ComplexXMLWriter::require(bool written, const std::string& name)
+{
+    if (!written)
+    {
+        throw except::Exception(Ctxt(
+                "Required field [" + name + "] is undefined or null"));
+    }
+}
+
+void ComplexXMLWriter::write(const ComplexData& data)
+{
+    mWriter.startElement("SICD");
+    mWriter.attribute("xmlns", "urn:SICD:" + mVersionString);
+
+    writeCollectionInformation(*data.collectionInformation);
+    if (data.imageCreation.get())
+    {
+        writeImageCreation(*data.imageCreation);
+    }
+    writeImageData(*data.imageData);
+    writeGeoData(*data.geoData);
+    writeGrid(*data.grid);
+    writeTimeline(*data.timeline);
+    writePosition(*data.position);
+    writeRadarCollection(*data.radarCollection);
+    writeImageFormation(*data.imageFormation, *data.radarCollection);
+    writeSCPCOA(*data.scpcoa);
+    if (data.radiometric.get())
+    {
+        common().writeRadiometry(*data.radiometric);
+    }
+    if (data.antenna.get())
+    {
+        writeAntenna(*data.antenna);
+    }
+    if (data.errorStatistics.get())
+    {
+        common().writeErrorStatistics(*data.errorStatistics);
+    }
+    if (data.matchInformation.get() && !data.matchInformation->types.empty())
+    {
+        writeMatchInformation(*data.matchInformation);
+    }
+    writeImageFormationAlgo(data.pfa.get(), data.rma.get(),
+                            data.rgAzComp.get());
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeIndexedDouble(const std::string& name,
+                                          double value,
+                                          size_t index)
+{
+    common().startTypedElement(name, NO_PREFIX, "xs:double");
+    mWriter.attribute("index", index);
+    mWriter.characters(value);
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeFFTSign(const std::string& name,
+                                    six::FFTSign sign)
+{
+    common().startTypedElement(name, NO_PREFIX, "xs:int");
+    mWriter.characters(std::string(sign == FFTSign::NEG ? "-1" : "+1"));
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeLatLonFootprint(const std::string& name,
+                                            const std::string& cornerName,
+                                            const LatLonCorners& corners)
+{
+    // Corners go in clockwise order
+    mWriter.startElement(name);
+    common().writeLatLon(cornerName, corners.upperLeft, "1:FRFC");
+    common().writeLatLon(cornerName, corners.upperRight, "2:FRLC");
+    common().writeLatLon(cornerName, corners.lowerRight, "3:LRLC");
+    common().writeLatLon(cornerName, corners.lowerLeft, "4:LRFC");
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeLatLonAltFootprint(
+        const std::string& name,
+        const std::string& cornerName,
+        const LatLonAltCorners& corners)
+{
+    mWriter.startElement(name);
+    common().writeLatLonAlt(cornerName, corners.upperLeft, "1");
+    common().writeLatLonAlt(cornerName, corners.upperRight, "2");
+    common().writeLatLonAlt(cornerName, corners.lowerRight, "3");
+    common().writeLatLonAlt(cornerName, corners.lowerLeft, "4");
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeCollectionInformation(
+        const CollectionInformation& collInfo)
+{
+    mWriter.startElement("CollectionInfo");
+
+    common().writeString("CollectorName", collInfo.collectorName);
+    if (!collInfo.illuminatorName.empty())
+    {
+        common().writeString("IlluminatorName", collInfo.illuminatorName);
+    }
+    common().writeString("CoreName", collInfo.coreName);
+    if (!Init::isUndefined(collInfo.collectType))
+    {
+        common().writeString("CollectType",
+                             six::toString<six::CollectType>(
+                                     collInfo.collectType));
+    }
+
+    mWriter.startElement("RadarMode");
+    common().writeString("ModeType", six::toString(collInfo.radarMode));
+    if (!collInfo.radarModeID.empty())
+    {
+        common().writeString("ModeID", collInfo.radarModeID);
+    }
+    mWriter.endElement();
+
+    common().writeString("Classification", collInfo.classification.level);
+
+    for (size_t ii = 0; ii < collInfo.countryCodes.size(); ++ii)
+    {
+        common().writeString("CountryCode", collInfo.countryCodes[ii]);
+    }
+    common().writeParameters("Parameter", collInfo.parameters);
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeImageCreation(const ImageCreation& imageCreation)
+{
+    mWriter.startElement("ImageCreation");
+    if (!imageCreation.application.empty())
+    {
+        common().writeString("Application", imageCreation.application);
+    }
+    if (!Init::isUndefined(imageCreation.dateTime))
+    {
+        common().writeDateTime("DateTime", imageCreation.dateTime);
+    }
+    if (!imageCreation.site.empty())
+    {
+        common().writeString("Site", imageCreation.site);
+    }
+    if (!imageCreation.profile.empty())
+    {
+        common().writeString("Profile", imageCreation.profile);
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeImageData(const ImageData& imageData)
+{
+    mWriter.startElement("ImageData");
+
+    common().writeString("PixelType", six::toString(imageData.pixelType));
+    if (imageData.amplitudeTable.get())
+    {
+        const AmplitudeTable& ampTable = *imageData.amplitudeTable;
+        mWriter.startElement("AmpTable");
+        mWriter.attribute("size", ampTable.numEntries);
+        for (size_t ii = 0; ii < ampTable.numEntries; ++ii)
+        {
+            writeIndexedDouble("Amplitude",
+                               *reinterpret_cast<const double*>(ampTable[ii]),
+                               ii);
+        }
+        mWriter.endElement();
+    }
+    common().writeInt("NumRows", static_cast<int>(imageData.numRows));
+    common().writeInt("NumCols", static_cast<int>(imageData.numCols));
+    common().writeInt("FirstRow", static_cast<int>(imageData.firstRow));
+    common().writeInt("FirstCol", static_cast<int>(imageData.firstCol));
+
+    common().writeRowCol("FullImage", "NumRows", "NumCols",
+                         imageData.fullImage);
+    common().writeRowCol("SCPPixel", imageData.scpPixel);
+
+    const size_t numVertices = imageData.validData.size();
+    if (numVertices >= 3)
+    {
+        mWriter.startElement("ValidData");
+        mWriter.attribute("size", numVertices);
+        for (size_t ii = 0; ii < numVertices; ++ii)
+        {
+            common().writeRowCol("Vertex", imageData.validData[ii],
+                                 str::toString(ii + 1));
+        }
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeGeoData(const GeoData& geoData)
+{
+    mWriter.startElement("GeoData");
+
+    common().writeString("EarthModel", six::toString(geoData.earthModel));
+
+    mWriter.startElement("SCP");
+    common().writeVector3D("ECF", geoData.scp.ecf);
+    common().writeLatLonAlt("LLH", geoData.scp.llh);
+    mWriter.endElement();
+
+    writeLatLonFootprint("ImageCorners", "ICP", geoData.imageCorners);
+
+    const size_t numVertices = geoData.validData.size();
+    if (numVertices >= 3)
+    {
+        mWriter.startElement("ValidData");
+        mWriter.attribute("size", numVertices);
+        for (size_t ii = 0; ii < numVertices; ++ii)
+        {
+            common().writeLatLon("Vertex", geoData.validData[ii],
+                                 str::toString(ii + 1));
+        }
+        mWriter.endElement();
+    }
+
+    for (size_t ii = 0; ii < geoData.geoInfos.size(); ++ii)
+    {
+        writeGeoInfo(*geoData.geoInfos[ii]);
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeGeoInfo(const GeoInfo& geoInfo)
+{
+    mWriter.startElement("GeoInfo");
+    if (!geoInfo.name.empty())
+    {
+        mWriter.attribute("name", geoInfo.name);
+    }
+
+    // The order of the nested GeoInfos, the description and the geometry
+    // changed from version to version
+    if (is04x() || mVersion == VERSION_050)
+    {
+        for (size_t ii = 0; ii < geoInfo.geoInfos.size(); ++ii)
+        {
+            writeGeoInfo(*geoInfo.geoInfos[ii]);
+        }
+        common().writeParameters("Desc", geoInfo.desc);
+        writeGeoInfoGeometry(geoInfo);
+    }
+    else if (mVersion == VERSION_100)
+    {
+        common().writeParameters("Desc", geoInfo.desc);
+        for (size_t ii = 0; ii < geoInfo.geoInfos.size(); ++ii)
+        {
+            writeGeoInfo(*geoInfo.geoInfos[ii]);
+        }
+        writeGeoInfoGeometry(geoInfo);
+    }
+    else
+    {
+        common().writeParameters("Desc", geoInfo.desc);
+        writeGeoInfoGeometry(geoInfo);
+        for (size_t ii = 0; ii < geoInfo.geoInfos.size(); ++ii)
+        {
+            writeGeoInfo(*geoInfo.geoInfos[ii]);
+        }
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeGeoInfoGeometry(const GeoInfo& geoInfo)
+{
+    const size_t numLatLons = geoInfo.geometryLatLon.size();
+    if (numLatLons == 1)
+    {
+        common().writeLatLon("Point", geoInfo.geometryLatLon[0]);
+    }
+    else if (numLatLons >= 2)
+    {
+        mWriter.startElement(numLatLons == 2 ? "Line" : "Polygon");
+        mWriter.attribute("size", numLatLons);
+        const std::string vertexName(numLatLons == 2 ? "Endpoint" : "Vertex");
+        for (size_t ii = 0; ii < numLatLons; ++ii)
+        {
+            common().writeLatLon(vertexName, geoInfo.geometryLatLon[ii],
+                                 str::toString(ii + 1));
+        }
+        mWriter.endElement();
+    }
+}
+
+void ComplexXMLWriter::writeGrid(const Grid& grid)
+{
+    mWriter.startElement("Grid");
+
+    common().writeString("ImagePlane", six::toString(grid.imagePlane));
+    common().writeString("Type", six::toString(grid.type));
+    common().writePoly2D("TimeCOAPoly", grid.timeCOAPoly);
+
+    writeDirectionParameters("Row", *grid.row);
+    writeDirectionParameters("Col", *grid.col);
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeDirectionParameters(
+        const std::string& name,
+        const DirectionParameters& params)
+{
+    mWriter.startElement(name);
+
+    common().writeVector3D("UVectECF", params.unitVector);
+    common().writeDouble("SS", params.sampleSpacing);
+    common().writeDouble("ImpRespWid", params.impulseResponseWidth);
+    writeFFTSign("Sgn", params.sign);
+    common().writeDouble("ImpRespBW", params.impulseResponseBandwidth);
+    common().writeDouble("KCtr", params.kCenter);
+    common().writeDouble("DeltaK1", params.deltaK1);
+    common().writeDouble("DeltaK2", params.deltaK2);
+
+    if (!Init::isUndefined(params.deltaKCOAPoly))
+    {
+        common().writePoly2D("DeltaKCOAPoly", params.deltaKCOAPoly);
+    }
+
+    if (params.weightType.get())
+    {
+        writeWeightType(*params.weightType);
+    }
+
+    const size_t numWeights = params.weights.size();
+    if (numWeights > 0)
+    {
+        mWriter.startElement("WgtFunct");
+        mWriter.attribute("size", numWeights);
+        for (size_t ii = 0; ii < numWeights; ++ii)
+        {
+            writeIndexedDouble("Wgt", params.weights[ii], ii + 1);
+        }
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeWeightType(const WeightType& weightType)
+{
+    if (is04x())
+    {
+        common().writeString("WgtType", weightType.windowName);
+    }
+    else
+    {
+        mWriter.startElement("WgtType");
+        common().writeString("WindowName", weightType.windowName);
+        common().writeParameters("Parameter", weightType.parameters);
+        mWriter.endElement();
+    }
+}
+
+void ComplexXMLWriter::writeTimeline(const Timeline& timeline)
+{
+    mWriter.startElement("Timeline");
+
+    common().writeDateTime("CollectStart", timeline.collectStart);
+    common().writeDouble("CollectDuration", timeline.collectDuration);
+
+    if (timeline.interPulsePeriod.get())
+    {
+        const std::vector<TimelineSet>& sets(timeline.interPulsePeriod->sets);
+        mWriter.startElement("IPP");
+        mWriter.attribute("size", sets.size());
+        for (size_t ii = 0; ii < sets.size(); ++ii)
+        {
+            const TimelineSet& timelineSet(sets[ii]);
+            mWriter.startElement("Set");
+            mWriter.attribute("index", ii + 1);
+            common().writeDouble("TStart", timelineSet.tStart);
+            common().writeDouble("TEnd", timelineSet.tEnd);
+            common().writeInt("IPPStart", timelineSet.interPulsePeriodStart);
+            common().writeInt("IPPEnd", timelineSet.interPulsePeriodEnd);
+            common().writePoly1D("IPPPoly", timelineSet.interPulsePeriodPoly);
+            mWriter.endElement();
+        }
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writePosition(const Position& position)
+{
+    mWriter.startElement("Position");
+
+    common().writePolyXYZ("ARPPoly", position.arpPoly);
+    if (!Init::isUndefined(position.grpPoly))
+    {
+        common().writePolyXYZ("GRPPoly", position.grpPoly);
+    }
+    if (!Init::isUndefined(position.txAPCPoly))
+    {
+        common().writePolyXYZ("TxAPCPoly", position.txAPCPoly);
+    }
+    if (position.rcvAPC.get() && !position.rcvAPC->rcvAPCPolys.empty())
+    {
+        const size_t numPolys = position.rcvAPC->rcvAPCPolys.size();
+        mWriter.startElement("RcvAPC");
+        mWriter.attribute("size", numPolys);
+        for (size_t ii = 0; ii < numPolys; ++ii)
+        {
+            common().writePolyXYZ("RcvAPCPoly",
+                                  position.rcvAPC->rcvAPCPolys[ii],
+                                  str::toString(ii + 1));
+        }
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRadarCollection(const RadarCollection& radar)
+{
+    mWriter.startElement("RadarCollection");
+
+    if (is10x())
+    {
+        writeTxFrequency(radar);
+        if (!Init::isUndefined(radar.refFrequencyIndex))
+        {
+            common().writeInt("RefFreqIndex", radar.refFrequencyIndex);
+        }
+        writeWaveform(radar);
+        common().writeString("TxPolarization",
+                             six::toString(radar.txPolarization));
+        writeTxSequence(radar);
+    }
+    else
+    {
+        if (!Init::isUndefined(radar.refFrequencyIndex))
+        {
+            common().writeInt("RefFreqIndex", radar.refFrequencyIndex);
+        }
+        writeTxFrequency(radar);
+        if (radar.txPolarization != PolarizationSequenceType::NOT_SET)
+        {
+            // In SICD 0.4, this is not allowed to contain UNKNOWN or SEQUENCE
+            common().writeString("TxPolarization",
+                                 six::toString(PolarizationType(
+                                         radar.txPolarization.value)));
+        }
+        if (!Init::isUndefined(radar.polarizationHVAnglePoly))
+        {
+            common().writePoly1D("PolarizationHVAnglePoly",
+                                 radar.polarizationHVAnglePoly);
+        }
+        writeTxSequence(radar);
+        writeWaveform(radar);
+    }
+
+    writeRcvChannels(radar);
+    writeArea(radar);
+    common().writeParameters("Parameter", radar.parameters);
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeTxFrequency(const RadarCollection& radar)
+{
+    mWriter.startElement("TxFrequency");
+    common().writeDouble("Min", radar.txFrequencyMin);
+    common().writeDouble("Max", radar.txFrequencyMax);
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeTxSequence(const RadarCollection& radar)
+{
+    if (radar.txSequence.empty())
+    {
+        return;
+    }
+
+    mWriter.startElement("TxSequence");
+    mWriter.attribute("size", radar.txSequence.size());
+    for (size_t ii = 0; ii < radar.txSequence.size(); ++ii)
+    {
+        const TxStep& tx(*radar.txSequence[ii]);
+        mWriter.startElement("TxStep");
+        mWriter.attribute("index", ii + 1);
+        if (!Init::isUndefined(tx.waveformIndex))
+        {
+            common().writeInt("WFIndex", tx.waveformIndex);
+        }
+        if (tx.txPolarization != PolarizationType::NOT_SET)
+        {
+            common().writeString("TxPolarization",
+                                 six::toString(tx.txPolarization));
+        }
+        mWriter.endElement();
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeWaveform(const RadarCollection& radar)
+{
+    if (radar.waveform.empty())
+    {
+        return;
+    }
+
+    mWriter.startElement("Waveform");
+    mWriter.attribute("size", radar.waveform.size());
+    for (size_t ii = 0; ii < radar.waveform.size(); ++ii)
+    {
+        const WaveformParameters& wf(*radar.waveform[ii]);
+        mWriter.startElement("WFParameters");
+        mWriter.attribute("index", ii + 1);
+
+        if (!Init::isUndefined(wf.txPulseLength))
+        {
+            common().writeDouble("TxPulseLength", wf.txPulseLength);
+        }
+        if (!Init::isUndefined(wf.txRFBandwidth))
+        {
+            common().writeDouble("TxRFBandwidth", wf.txRFBandwidth);
+        }
+        if (!Init::isUndefined(wf.txFrequencyStart))
+        {
+            common().writeDouble("TxFreqStart", wf.txFrequencyStart);
+        }
+        if (!Init::isUndefined(wf.txFMRate))
+        {
+            common().writeDouble("TxFMRate", wf.txFMRate);
+        }
+        if (wf.rcvDemodType != DemodType::NOT_SET)
+        {
+            common().writeString("RcvDemodType",
+                                 six::toString(wf.rcvDemodType));
+        }
+        if (!Init::isUndefined(wf.rcvWindowLength))
+        {
+            common().writeDouble("RcvWindowLength", wf.rcvWindowLength);
+        }
+        if (!Init::isUndefined(wf.adcSampleRate))
+        {
+            common().writeDouble("ADCSampleRate", wf.adcSampleRate);
+        }
+        if (!Init::isUndefined(wf.rcvIFBandwidth))
+        {
+            common().writeDouble("RcvIFBandwidth", wf.rcvIFBandwidth);
+        }
+        if (!Init::isUndefined(wf.rcvFrequencyStart))
+        {
+            common().writeDouble("RcvFreqStart", wf.rcvFrequencyStart);
+        }
+        if (!Init::isUndefined(wf.rcvFMRate))
+        {
+            common().writeDouble("RcvFMRate", wf.rcvFMRate);
+        }
+
+        mWriter.endElement();
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRcvChannels(const RadarCollection& radar)
+{
+    const size_t numChannels = radar.rcvChannels.size();
+    mWriter.startElement("RcvChannels");
+    mWriter.attribute("size", numChannels);
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        const ChannelParameters& cp(*radar.rcvChannels[ii]);
+        mWriter.startElement("ChanParameters");
+        mWriter.attribute("index", ii + 1);
+
+        if (is10x())
+        {
+            //! required in 1.0
+            common().writeString("TxRcvPolarization",
+                                 six::toString<DualPolarizationType>(
+                                         cp.txRcvPolarization));
+            if (!Init::isUndefined(cp.rcvAPCIndex))
+            {
+                common().writeInt("RcvAPCIndex", cp.rcvAPCIndex);
+            }
+        }
+        else
+        {
+            if (!Init::isUndefined(cp.rcvAPCIndex))
+            {
+                common().writeInt("RcvAPCIndex", cp.rcvAPCIndex);
+            }
+            if (cp.txRcvPolarization != DualPolarizationType::NOT_SET)
+            {
+                common().writeString("TxRcvPolarization",
+                                     six::toString<DualPolarizationType>(
+                                             cp.txRcvPolarization));
+            }
+        }
+
+        mWriter.endElement();
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeArea(const RadarCollection& radar)
+{
+    const Area* const area = radar.area.get();
+    if (area == NULL)
+    {
+        return;
+    }
+
+    mWriter.startElement("Area");
+
+    bool haveACPCorners = true;
+    for (size_t ii = 0; ii < LatLonAltCorners::NUM_CORNERS; ++ii)
+    {
+        if (Init::isUndefined(area->acpCorners.getCorner(ii)))
+        {
+            haveACPCorners = false;
+            break;
+        }
+    }
+    if (haveACPCorners)
+    {
+        writeLatLonAltFootprint("Corner", "ACP", area->acpCorners);
+    }
+
+    const AreaPlane* const plane = area->plane.get();
+    if (plane)
+    {
+        mWriter.startElement("Plane");
+
+        const ReferencePoint& refPt(plane->referencePoint);
+        mWriter.startElement("RefPt");
+        if (!refPt.name.empty())
+        {
+            mWriter.attribute("name", refPt.name);
+        }
+        common().writeVector3D("ECF", refPt.ecef);
+        common().writeDouble("Line", refPt.rowCol.row);
+        common().writeDouble("Sample", refPt.rowCol.col);
+        mWriter.endElement();
+
+        writeAreaDirectionParameters("XDir", "LineSpacing", "NumLines",
+                                     "FirstLine", *plane->xDirection);
+        writeAreaDirectionParameters("YDir", "SampleSpacing", "NumSamples",
+                                     "FirstSample", *plane->yDirection);
+
+        if (!plane->segmentList.empty())
+        {
+            mWriter.startElement("SegmentList");
+            mWriter.attribute("size", plane->segmentList.size());
+            for (size_t ii = 0; ii < plane->segmentList.size(); ++ii)
+            {
+                const Segment& segment(*plane->segmentList[ii]);
+                mWriter.startElement("Segment");
+                mWriter.attribute("index", ii + 1);
+                common().writeInt("StartLine", segment.startLine);
+                common().writeInt("StartSample", segment.startSample);
+                common().writeInt("EndLine", segment.endLine);
+                common().writeInt("EndSample", segment.endSample);
+                common().writeString("Identifier", segment.identifier);
+                mWriter.endElement();
+            }
+            mWriter.endElement();
+        }
+
+        if (!Init::isUndefined(plane->orientation))
+        {
+            common().writeString("Orientation",
+                                 six::toString<OrientationType>(
+                                         plane->orientation));
+        }
+
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeAreaDirectionParameters(
+        const std::string& name,
+        const std::string& spacingName,
+        const std::string& numName,
+        const std::string& firstName,
+        const AreaDirectionParameters& adp)
+{
+    mWriter.startElement(name);
+    common().writeVector3D("UVectECF", adp.unitVector);
+    common().writeDouble(spacingName, adp.spacing);
+    common().writeInt(numName, static_cast<int>(adp.elements));
+    common().writeInt(firstName, static_cast<int>(adp.first));
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeImageFormation(
+        const ImageFormation& imageFormation,
+        const RadarCollection& radarCollection)
+{
+    mWriter.startElement("ImageFormation");
+
+    const bool needSegmentIdentifier =
+            radarCollection.area.get() != NULL &&
+            radarCollection.area->plane.get() != NULL &&
+            !radarCollection.area->plane->segmentList.empty() &&
+            imageFormation.segmentIdentifier.empty();
+
+    if (is10x())
+    {
+        writeRcvChanProc(imageFormation.rcvChannelProcessed.get());
+        common().writeString("TxRcvPolarizationProc",
+                             six::toString(
+                                     imageFormation.txRcvPolarizationProc));
+        common().writeDouble("TStartProc", imageFormation.tStartProc);
+        common().writeDouble("TEndProc", imageFormation.tEndProc);
+
+        mWriter.startElement("TxFrequencyProc");
+        common().writeDouble("MinProc", imageFormation.txFrequencyProcMin);
+        common().writeDouble("MaxProc", imageFormation.txFrequencyProcMax);
+        mWriter.endElement();
+    }
+
+    if (needSegmentIdentifier)
+    {
+        throw except::Exception(Ctxt(
+            "ImageFormation.SegmentIdentifier must be included when a "
+            "RadarCollection.Area.Plane.SegmentList is included."));
+    }
+
+    if (!imageFormation.segmentIdentifier.empty())
+    {
+        common().writeString("SegmentIdentifier",
+                             imageFormation.segmentIdentifier);
+    }
+
+    if (!is10x())
+    {
+        writeRcvChanProc(imageFormation.rcvChannelProcessed.get());
+        if (imageFormation.txRcvPolarizationProc !=
+                DualPolarizationType::NOT_SET)
+        {
+            common().writeString("TxRcvPolarizationProc",
+                                 six::toString(
+                                        imageFormation.txRcvPolarizationProc));
+        }
+    }
+
+    common().writeString("ImageFormAlgo",
+                         six::toString(
+                                 imageFormation.imageFormationAlgorithm));
+
+    if (!is10x())
+    {
+        common().writeDouble("TStartProc", imageFormation.tStartProc);
+        common().writeDouble("TEndProc", imageFormation.tEndProc);
+
+        mWriter.startElement("TxFrequencyProc");
+        common().writeDouble("MinProc", imageFormation.txFrequencyProcMin);
+        common().writeDouble("MaxProc", imageFormation.txFrequencyProcMax);
+        mWriter.endElement();
+    }
+
+    common().writeString("STBeamComp",
+                         six::toString(
+                                 imageFormation.slowTimeBeamCompensation));
+    common().writeString("ImageBeamComp",
+                         six::toString(imageFormation.imageBeamCompensation));
+    common().writeString("AzAutofocus",
+                         six::toString(imageFormation.azimuthAutofocus));
+    common().writeString("RgAutofocus",
+                         six::toString(imageFormation.rangeAutofocus));
+
+    for (size_t ii = 0; ii < imageFormation.processing.size(); ++ii)
+    {
+        writeProcessing(imageFormation.processing[ii]);
+    }
+
+    const PolarizationCalibration* const polCal =
+            imageFormation.polarizationCalibration.get();
+    if (polCal)
+    {
+        mWriter.startElement("PolarizationCalibration");
+        if (is10x())
+        {
+            require(common().writeBooleanType(
+                            "DistortCorrectionApplied",
+                            polCal->distortionCorrectionApplied),
+                    "DistortCorrectionApplied");
+        }
+        else
+        {
+            require(common().writeBooleanType(
+                            "HVAngleCompApplied",
+                            polCal->hvAngleCompensationApplied),
+                    "HVAngleCompApplied");
+            require(common().writeBooleanType(
+                            "DistortionCorrectionApplied",
+                            polCal->distortionCorrectionApplied),
+                    "DistortionCorrectionApplied");
+        }
+        writeDistortion(polCal->distortion.get());
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRcvChanProc(
+        const RcvChannelProcessed* rcvChanProc)
+{
+    if (!rcvChanProc)
+    {
+        throw except::Exception(Ctxt(FmtX(
+            "[RcvChanProc] is a manditory field in ImageFormation in %s",
+            is10x() ? "1.0" : "0.4")));
+    }
+
+    mWriter.startElement("RcvChanProc");
+    common().writeInt("NumChanProc",
+                      static_cast<int>(rcvChanProc->numChannelsProcessed));
+    if (!Init::isUndefined(rcvChanProc->prfScaleFactor))
+    {
+        common().writeDouble("PRFScaleFactor", rcvChanProc->prfScaleFactor);
+    }
+    for (size_t ii = 0; ii < rcvChanProc->channelIndex.size(); ++ii)
+    {
+        common().writeInt("ChanIndex", rcvChanProc->channelIndex[ii]);
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeProcessing(const Processing& processing)
+{
+    mWriter.startElement("Processing");
+    common().writeString("Type", processing.type);
+    require(common().writeBooleanType("Applied", processing.applied),
+            "Applied");
+    common().writeParameters("Parameter", processing.parameters);
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeDistortion(const Distortion* distortion)
+{
+    if (!distortion)
+    {
+        throw except::Exception(Ctxt(FmtX(
+            "[Distortion] is a maditory field of ImageFormation in %s",
+            is10x() ? "1.0" : "0.4")));
+    }
+
+    mWriter.startElement("Distortion");
+
+    common().writeDateTime("CalibrationDate", distortion->calibrationDate);
+    common().writeDouble("A", distortion->a);
+    common().writeComplex("F1", distortion->f1);
+    common().writeComplex("Q1", distortion->q1);
+    common().writeComplex("Q2", distortion->q2);
+    common().writeComplex("F2", distortion->f2);
+    common().writeComplex("Q3", distortion->q3);
+    common().writeComplex("Q4", distortion->q4);
+
+    if (!Init::isUndefined(distortion->gainErrorA))
+    {
+        common().writeDouble("GainErrorA", distortion->gainErrorA);
+    }
+    if (!Init::isUndefined(distortion->gainErrorF1))
+    {
+        common().writeDouble("GainErrorF1", distortion->gainErrorF1);
+    }
+    if (!Init::isUndefined(distortion->gainErrorF2))
+    {
+        common().writeDouble("GainErrorF2", distortion->gainErrorF2);
+    }
+    if (!Init::isUndefined(distortion->phaseErrorF1))
+    {
+        common().writeDouble("PhaseErrorF1", distortion->phaseErrorF1);
+    }
+    if (!Init::isUndefined(distortion->phaseErrorF2))
+    {
+        common().writeDouble("PhaseErrorF2", distortion->phaseErrorF2);
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeSCPCOA(const SCPCOA& scpcoa)
+{
+    mWriter.startElement("SCPCOA");
+
+    common().writeDouble("SCPTime", scpcoa.scpTime);
+    common().writeVector3D("ARPPos", scpcoa.arpPos);
+    common().writeVector3D("ARPVel", scpcoa.arpVel);
+    common().writeVector3D("ARPAcc", scpcoa.arpAcc);
+    common().writeString("SideOfTrack", six::toString(scpcoa.sideOfTrack));
+    common().writeDouble("SlantRange", scpcoa.slantRange);
+    common().writeDouble("GroundRange", scpcoa.groundRange);
+    common().writeDouble("DopplerConeAng", scpcoa.dopplerConeAngle);
+    common().writeDouble("GrazeAng", scpcoa.grazeAngle);
+    common().writeDouble("IncidenceAng", scpcoa.incidenceAngle);
+    common().writeDouble("TwistAng", scpcoa.twistAngle);
+    common().writeDouble("SlopeAng", scpcoa.slopeAngle);
+
+    if (is10x())
+    {
+        //! Added in 1.0.0
+        common().writeDouble("AzimAng", scpcoa.azimAngle);
+        common().writeDouble("LayoverAng", scpcoa.layoverAngle);
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeAntenna(const Antenna& antenna)
+{
+    mWriter.startElement("Antenna");
+    if (antenna.tx.get())
+    {
+        writeAntennaParameters("Tx", *antenna.tx);
+    }
+    if (antenna.rcv.get())
+    {
+        writeAntennaParameters("Rcv", *antenna.rcv);
+    }
+    if (antenna.twoWay.get())
+    {
+        writeAntennaParameters("TwoWay", *antenna.twoWay);
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeAntennaParameters(
+        const std::string& name,
+        const AntennaParameters& params)
+{
+    mWriter.startElement(name);
+
+    common().writePolyXYZ("XAxisPoly", params.xAxisPoly);
+    common().writePolyXYZ("YAxisPoly", params.yAxisPoly);
+    common().writeDouble("FreqZero", params.frequencyZero);
+
+    if (params.electricalBoresight.get())
+    {
+        mWriter.startElement("EB");
+        common().writePoly1D("DCXPoly", params.electricalBoresight->dcxPoly);
+        common().writePoly1D("DCYPoly", params.electricalBoresight->dcyPoly);
+        mWriter.endElement();
+    }
+
+    //! HPBW was deprecated and Array made mandatory in 1.0.0
+    if (!is10x() && params.halfPowerBeamwidths.get())
+    {
+        mWriter.startElement("HPBW");
+        common().writeDouble("DCX", params.halfPowerBeamwidths->dcx);
+        common().writeDouble("DCY", params.halfPowerBeamwidths->dcy);
+        mWriter.endElement();
+    }
+
+    if (params.array.get())
+    {
+        mWriter.startElement("Array");
+        common().writePoly2D("GainPoly", params.array->gainPoly);
+        common().writePoly2D("PhasePoly", params.array->phasePoly);
+        mWriter.endElement();
+    }
+    else if (is10x())
+    {
+        throw except::Exception(Ctxt(FmtX(
+            "[Array] is a mandatory field in AntennaParams of [%s] in 1.0",
+            name.c_str())));
+    }
+
+    if (params.element.get())
+    {
+        mWriter.startElement("Elem");
+        common().writePoly2D("GainPoly", params.element->gainPoly);
+        common().writePoly2D("PhasePoly", params.element->phasePoly);
+        mWriter.endElement();
+    }
+    if (!params.gainBSPoly.empty())
+    {
+        common().writePoly1D("GainBSPoly", params.gainBSPoly);
+    }
+
+    common().writeBooleanType("EBFreqShift",
+                              params.electricalBoresightFrequencyShift);
+    common().writeBooleanType("MLFreqDilation",
+                              params.mainlobeFrequencyDilation);
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeMatchInformation(const MatchInformation& matchInfo)
+{
+    mWriter.startElement("MatchInfo");
+
+    if (is10x())
+    {
+        common().writeInt("NumMatchTypes",
+                          static_cast<int>(matchInfo.types.size()));
+        for (size_t ii = 0; ii < matchInfo.types.size(); ++ii)
+        {
+            const MatchType& mt(*matchInfo.types[ii]);
+            mWriter.startElement("MatchType");
+            mWriter.attribute("index", ii + 1);
+
+            common().writeString("TypeID", mt.typeID);
+            common().writeInt("CurrentIndex", mt.currentIndex);
+            common().writeInt("NumMatchCollections",
+                              static_cast<int>(mt.matchCollects.size()));
+            for (size_t jj = 0; jj < mt.matchCollects.size(); ++jj)
+            {
+                const MatchCollect& collect(mt.matchCollects[jj]);
+                mWriter.startElement("MatchCollection");
+                mWriter.attribute("index", jj + 1);
+                common().writeString("CoreName", collect.coreName);
+                common().writeInt("MatchIndex", collect.matchIndex);
+                common().writeParameters("Parameter", collect.parameters);
+                mWriter.endElement();
+            }
+
+            mWriter.endElement();
+        }
+    }
+    else
+    {
+        if (mVersion == VERSION_050)
+        {
+            mWriter.attribute("size", matchInfo.types.size());
+        }
+
+        for (size_t ii = 0; ii < matchInfo.types.size(); ++ii)
+        {
+            const MatchType& mt(*matchInfo.types[ii]);
+            mWriter.startElement("Collect");
+            mWriter.attribute("index", ii + 1);
+
+            common().writeString("CollectorName", mt.collectorName);
+            if (!mt.illuminatorName.empty())
+            {
+                common().writeString("IlluminatorName", mt.illuminatorName);
+            }
+            common().writeString("CoreName", mt.matchCollects[0].coreName);
+            for (size_t jj = 0; jj < mt.matchType.size(); ++jj)
+            {
+                common().writeString("MatchType", mt.matchType[jj]);
+            }
+            common().writeParameters("Parameter",
+                                     mt.matchCollects[0].parameters);
+
+            mWriter.endElement();
+        }
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeImageFormationAlgo(const PFA* pfa,
+                                               const RMA* rma,
+                                               const RgAzComp* rgAzComp)
+{
+    if (is10x())
+    {
+        if (pfa && !rma && !rgAzComp)
+        {
+            writePFA(*pfa);
+        }
+        else if (!pfa && rma && !rgAzComp)
+        {
+            writeRMA(*rma);
+        }
+        else if (!pfa && !rma && rgAzComp)
+        {
+            writeRgAzComp(*rgAzComp);
+        }
+        else if (pfa || rma || rgAzComp)
+        {
+            throw except::Exception(Ctxt(
+                "Only one PFA, RMA, or RgAzComp can be defined in SICD 1.0"));
+        }
+        return;
+    }
+
+    if (mVersion == VERSION_050)
+    {
+        if (rgAzComp)
+        {
+            throw except::Exception(Ctxt(
+                "RGAZCOMP exists in SICD 0.5 but library does not support "
+                "it"));
+        }
+        if (pfa && rma)
+        {
+            throw except::Exception(Ctxt(
+                "Only one PFA or RMA can be defined in SICD 0.5"));
+        }
+    }
+    else
+    {
+        //! 0.4.1 (but not 0.4.0) allows there to be no algorithm
+        if (mVersion == VERSION_041 && !pfa && !rma && !rgAzComp)
+        {
+            return;
+        }
+        if (rgAzComp)
+        {
+            throw except::Exception(Ctxt(
+                "RgAzComp cannot be defined in SICD 0.4"));
+        }
+        if ((pfa == NULL && rma == NULL) || (pfa && rma))
+        {
+            throw except::Exception(Ctxt(
+                "Only one PFA or RMA can be defined in SICD 0.4"));
+        }
+    }
+
+    if (pfa)
+    {
+        writePFA(*pfa);
+    }
+    else if (rma)
+    {
+        writeRMA(*rma);
+    }
+}
+
+void ComplexXMLWriter::writePFA(const PFA& pfa)
+{
+    mWriter.startElement("PFA");
+
+    common().writeVector3D("FPN", pfa.focusPlaneNormal);
+    common().writeVector3D("IPN", pfa.imagePlaneNormal);
+    common().writeDouble("PolarAngRefTime", pfa.polarAngleRefTime);
+    common().writePoly1D("PolarAngPoly", pfa.polarAnglePoly);
+    common().writePoly1D("SpatialFreqSFPoly",
+                         pfa.spatialFrequencyScaleFactorPoly);
+    common().writeDouble("Krg1", pfa.krg1);
+    common().writeDouble("Krg2", pfa.krg2);
+    common().writeDouble("Kaz1", pfa.kaz1);
+    common().writeDouble("Kaz2", pfa.kaz2);
+    if (pfa.slowTimeDeskew.get())
+    {
+        mWriter.startElement("STDeskew");
+        require(common().writeBooleanType("Applied",
+                                          pfa.slowTimeDeskew->applied),
+                "Applied");
+        common().writePoly2D("STDSPhasePoly",
+                             pfa.slowTimeDeskew->slowTimeDeskewPhasePoly);
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRMA(const RMA& rma)
+{
+    mWriter.startElement("RMA");
+
+    common().writeString("RMAlgoType",
+                         six::toString<six::RMAlgoType>(rma.algoType));
+
+    const RMAT* const rmat = rma.rmat.get();
+    const RMCR* const rmcr = rma.rmcr.get();
+    const INCA* const inca = rma.inca.get();
+    if (is10x())
+    {
+        if (rmat && !rmcr && !inca)
+        {
+            writeRMAT(*rmat);
+        }
+        else if (!rmat && rmcr && !inca)
+        {
+            writeRMCR(*rmcr);
+        }
+        else if (!rmat && !rmcr && inca)
+        {
+            writeINCA(*inca);
+        }
+        else
+        {
+            throw except::Exception(Ctxt(
+                "One of RMAT, RMCR or INCA must be defined in SICD 1.0."));
+        }
+    }
+    else
+    {
+        if (rmcr)
+        {
+            throw except::Exception(Ctxt(
+                "RMCR cannot be defined in SICD 0.4"));
+        }
+        else if (rmat && !inca)
+        {
+            writeRMAT(*rmat);
+        }
+        else if (!rmat && inca)
+        {
+            writeINCA(*inca);
+        }
+        else
+        {
+            throw except::Exception(Ctxt(
+                "RMAT or INCA must be defined in SICD 0.4"));
+        }
+    }
+
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRMAT(const RMAT& rmat)
+{
+    common().writeString("ImageType", "RMAT");
+
+    mWriter.startElement("RMAT");
+    if (mVersion == VERSION_040)
+    {
+        common().writeDouble("RMRefTime", rmat.refTime);
+        common().writeVector3D("RMPosRef", rmat.refPos);
+        common().writeVector3D("RMVelRef", rmat.refVel);
+        common().writePoly2D("CosDCACOAPoly", rmat.cosDCACOAPoly);
+    }
+    else if (!is10x())
+    {
+        common().writeDouble("RefTime", rmat.refTime);
+        common().writeVector3D("PosRef", rmat.refPos);
+        common().writeVector3D("UnitVelRef", rmat.refVel);
+        common().writePoly1D("DistRLPoly", rmat.distRefLinePoly);
+        common().writePoly2D("CosDCACOAPoly", rmat.cosDCACOAPoly);
+    }
+    else
+    {
+        common().writeVector3D("PosRef", rmat.refPos);
+        common().writeVector3D("VelRef", rmat.refVel);
+        common().writeDouble("DopConeAngRef", rmat.dopConeAngleRef);
+    }
+
+    if (!is10x())
+    {
+        common().writeDouble("Kx1", rmat.kx1);
+        common().writeDouble("Kx2", rmat.kx2);
+        common().writeDouble("Ky1", rmat.ky1);
+        common().writeDouble("Ky2", rmat.ky2);
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRMCR(const RMCR& rmcr)
+{
+    common().writeString("ImageType", "RMCR");
+
+    mWriter.startElement("RMCR");
+    common().writeVector3D("PosRef", rmcr.refPos);
+    common().writeVector3D("VelRef", rmcr.refVel);
+    common().writeDouble("DopConeAngRef", rmcr.dopConeAngleRef);
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeINCA(const INCA& inca)
+{
+    common().writeString("ImageType", "INCA");
+
+    mWriter.startElement("INCA");
+    common().writePoly1D("TimeCAPoly", inca.timeCAPoly);
+    common().writeDouble("R_CA_SCP", inca.rangeCA);
+    common().writeDouble("FreqZero", inca.freqZero);
+
+    const Poly2D& dRateSFPoly(inca.dopplerRateScaleFactorPoly);
+    if (mVersion == VERSION_040)
+    {
+        //! Poly1D in 0.4.0
+        if (dRateSFPoly.orderX() != 0 && dRateSFPoly.orderY() != 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Verify the poly is stored in 1D form"));
+        }
+
+        six::Poly1D oneDPoly;
+        if (dRateSFPoly.orderX() != 0)
+        {
+            oneDPoly = six::Poly1D(dRateSFPoly.orderX());
+            for (size_t ii = 0; ii <= oneDPoly.order(); ++ii)
+            {
+                oneDPoly[ii] = dRateSFPoly[ii][0];
+            }
+        }
+        else
+        {
+            oneDPoly = dRateSFPoly[0];
+        }
+        common().writePoly1D("DRateSFPoly", oneDPoly);
+    }
+    else
+    {
+        common().writePoly2D("DRateSFPoly", dRateSFPoly);
+    }
+
+    if (!inca.dopplerCentroidPoly.empty())
+    {
+        common().writePoly2D("DopCentroidPoly", inca.dopplerCentroidPoly);
+    }
+    if (!Init::isUndefined(inca.dopplerCentroidCOA))
+    {
+        common().writeBooleanType("DopCentroidCOA", inca.dopplerCentroidCOA);
+    }
+    mWriter.endElement();
+}
+
+void ComplexXMLWriter::writeRgAzComp(const RgAzComp& rgAzComp)
+{
+    mWriter.startElement("RgAzComp");
+    common().writeDouble("AzSF", rgAzComp.azSF);
+    common().writePoly1D("KazPoly", rgAzComp.kazPoly);
+    mWriter.endElement();
+}
+}
+}
@@ -70,9 +70,9 @@ void cropSICD(six::NITFReadControl& reader,
         throw except::Exception(Ctxt("AOI must be non-empty"));
     }
 
-    // Read in the AOI
+    // Read in the AOI; the buffer only needs to hold the chip
     const size_t numBytesPerPixel(data.getNumBytesPerPixel());
-    const size_t numBytes(origDims.row * origDims.col * numBytesPerPixel);
+    const size_t numBytes(aoiDims.area() * numBytesPerPixel);
     const mem::ScopedArray<sys::ubyte> buffer(new sys::ubyte[numBytes]);
 
     six::Region region;
@@ -20,6 +20,7 @@
 *
 */
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -38,19 +39,16 @@ RaisedCos::RaisedCos(double coef) :
 
 std::vector<double> RaisedCos::operator()(size_t n) const
 {
-    std::vector<double> ret;
-    ret.resize(static_cast<size_t>(std::ceil(n / 2.0)));
-    for (size_t ii = 0; ii < ret.size(); ++ii)
+    if (n < 2)
     {
-        ret[ii] = mCoef - (1 - mCoef) * std::cos(2 * M_PI * ii / (n - 1));
+        return std::vector<double>(n, 1.0);
     }
-    if (n % 2 == 0)
-    {
-        std::reverse_copy(ret.begin(), ret.end(), std::back_inserter(ret));
-    }
-    else
+
+    // The cosine is symmetric, so this is too
+    std::vector<double> ret(n);
+    for (size_t ii = 0; ii < n; ++ii)
     {
-        std::copy(ret.begin(), ret.end() - 1, std::back_inserter(ret));
+        ret[ii] = mCoef - (1 - mCoef) * std::cos(2 * M_PI * ii / (n - 1));
     }
     return ret;
 }
@@ -79,5 +77,53 @@ std::vector<double> Kaiser::operator()(size_t L) const
 
     return ret;
 }
+
+Taylor::Taylor(size_t nbar, double sidelobeLevel) :
+    mNbar(std::max<size_t>(nbar, 1)),
+    mSidelobeLevel(std::abs(sidelobeLevel))
+{
+}
+
+std::vector<double> Taylor::operator()(size_t n) const
+{
+    const double ratio = std::pow(10.0, mSidelobeLevel / 20.0);
+    const double a = std::log(ratio + std::sqrt(ratio * ratio - 1)) / M_PI;
+    const double nbar = static_cast<double>(mNbar);
+    const double sigma2 = nbar * nbar / (a * a + (nbar - 0.5) * (nbar - 0.5));
+
+    // Cosine series coefficients
+    std::vector<double> coefs(mNbar, 0.0);
+    double peak = 1;
+    for (size_t m = 1; m < mNbar; ++m)
+    {
+        const double m2 = static_cast<double>(m * m);
+        double numerator = 1;
+        double denominator = 1;
+        for (size_t ii = 1; ii < mNbar; ++ii)
+        {
+            numerator *= 1 - m2 / (sigma2 * (a * a + (ii - 0.5) * (ii - 0.5)));
+            if (ii != m)
+            {
+                denominator *= 1 - m2 / static_cast<double>(ii * ii);
+            }
+        }
+        coefs[m] = ((m % 2 == 1) ? 1 : -1) * numerator / (2 * denominator);
+        peak += 2 * coefs[m];
+    }
+
+    std::vector<double> ret(n);
+    for (size_t ii = 0; ii < n; ++ii)
+    {
+        const double x = (n > 1) ? static_cast<double>(ii) / (n - 1) - 0.5 :
+                0.0;
+        double value = 1;
+        for (size_t m = 1; m < mNbar; ++m)
+        {
+            value += 2 * coefs[m] * std::cos(2 * M_PI * m * x);
+        }
+        ret[ii] = value / peak;
+    }
+    return ret;
+}
 }
 }
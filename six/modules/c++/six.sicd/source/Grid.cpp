@@ -19,6 +19,8 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
+
 #include "six/sicd/CollectionInformation.h"
 #include "six/sicd/GeoData.h"
 #include "six/sicd/Grid.h"
@@ -30,12 +32,15 @@
 #include "six/sicd/RMA.h"
 #include "six/sicd/Utilities.h"
 #include <math/Utilities.h>
+#include <scene/PolyLatticeEvaluator.h>
+#include <six/ValidDataMask.h>
 
 using namespace six;
 using namespace six::sicd;
 
 const double DirectionParameters::WGT_TOL = 1e-3;
 const size_t DirectionParameters::DEFAULT_WEIGHT_SIZE = 512;
+const size_t DirectionParameters::DELTAK_LATTICE_SIZE = 10;
 const char DirectionParameters::BOUNDS_ERROR_MESSAGE[] =
         "Violation of spatial frequency extent bounds";
 
@@ -86,27 +91,78 @@ bool DirectionParameters::operator==(const DirectionParameters& rhs) const
 std::pair<double, double> DirectionParameters::calculateDeltaKs(
         const ImageData& imageData) const
 {
-    //Here, we assume the min and max of DeltaKCOAPoly must be
-    // on the vertices of the image, since it is smooth and monotonic in most cases--
-    // although in actuality this is not always the case.  To be totally generic, 
-    // we would have to search for an interior min and max as well
+    // DeltaKCOAPoly is smooth and monotonic in most cases, so its min and
+    // max are usually on the vertices of the valid data polygon (or the
+    // corners of the image if there isn't one).  To catch an interior min
+    // or max, it's also sampled on a coarse lattice over the image, keeping
+    // only the samples inside the valid data, so the same region is
+    // searched whether or not ValidData is filled in.
     double derivedDeltaK1 = 0;
     double derivedDeltaK2 = 0;
 
-    std::vector<RowColInt> vertices = calculateImageVertices(imageData);
-
     if (!Init::isUndefined(deltaKCOAPoly))
     {
         derivedDeltaK1 = std::numeric_limits<double>::infinity();
         derivedDeltaK2 = -std::numeric_limits<double>::infinity();
 
-        for (size_t ii = 0; ii < vertices.size(); ++ii)
+        const bool haveDims = !Init::isUndefined(imageData.numRows) &&
+                !Init::isUndefined(imageData.numCols) &&
+                imageData.numRows > 0 && imageData.numCols > 0;
+
+        // Without a polygon, the lattice's corners are the image's
+        if (!imageData.validData.empty() || !haveDims)
+        {
+            const std::vector<RowColInt> vertices =
+                    calculateImageVertices(imageData);
+            for (size_t ii = 0; ii < vertices.size(); ++ii)
+            {
+                double currentDeltaK = deltaKCOAPoly.atY(
+                        static_cast<double>(vertices[ii].col))(
+                        static_cast<double>(vertices[ii].row));
+                derivedDeltaK1 = std::min(currentDeltaK, derivedDeltaK1);
+                derivedDeltaK2 = std::max(currentDeltaK, derivedDeltaK2);
+            }
+        }
+
+        if (haveDims)
         {
-            double currentDeltaK = deltaKCOAPoly.atY(
-                    static_cast<double>(vertices[ii].col))(
-                    static_cast<double>(vertices[ii].row));
-            derivedDeltaK1 = std::min(currentDeltaK, derivedDeltaK1);
-            derivedDeltaK2 = std::max(currentDeltaK, derivedDeltaK2);
+            const types::RowCol<size_t> imageDims(imageData.numRows,
+                                                  imageData.numCols);
+            const ValidDataMask mask(imageData.validData, imageDims);
+
+            const types::RowCol<size_t> dims(
+                    std::min<size_t>(DELTAK_LATTICE_SIZE, imageDims.row),
+                    std::min<size_t>(DELTAK_LATTICE_SIZE, imageDims.col));
+            const types::RowCol<double> spacing(
+                    dims.row > 1 ? static_cast<double>(imageDims.row - 1) /
+                            (dims.row - 1) : 0.0,
+                    dims.col > 1 ? static_cast<double>(imageDims.col - 1) /
+                            (dims.col - 1) : 0.0);
+
+            std::vector<double> deltaKs(dims.area());
+            scene::evaluateLattice(deltaKCOAPoly,
+                                   types::RowCol<double>(0.0, 0.0),
+                                   spacing,
+                                   dims,
+                                   &deltaKs[0]);
+
+            for (size_t row = 0, idx = 0; row < dims.row; ++row)
+            {
+                const size_t pixelRow =
+                        static_cast<size_t>(row * spacing.row + 0.5);
+                for (size_t col = 0; col < dims.col; ++col, ++idx)
+                {
+                    const size_t pixelCol =
+                            static_cast<size_t>(col * spacing.col + 0.5);
+                    if (mask.isValid(pixelRow, pixelCol))
+                    {
+                        derivedDeltaK1 = std::min(deltaKs[idx],
+                                                  derivedDeltaK1);
+                        derivedDeltaK2 = std::max(deltaKs[idx],
+                                                  derivedDeltaK2);
+                    }
+                }
+            }
         }
     }
 
@@ -161,6 +217,17 @@ DirectionParameters::calculateWeightFunction() const
         else if (windowName == "KAISER")
         {
             weightFunction.reset(new Kaiser(weightType->parameters[0]));
+        }
+        else if (windowName == "TAYLOR" &&
+                 weightType->parameters.containsParameter("NBAR") &&
+                 weightType->parameters.containsParameter("SLL"))
+        {
+            const double nbar =
+                    weightType->parameters.findParameter("NBAR");
+            const double sidelobeLevel =
+                    weightType->parameters.findParameter("SLL");
+            weightFunction.reset(new Taylor(
+                    static_cast<size_t>(nbar + 0.5), sidelobeLevel));
         }
     }
 
@@ -199,10 +266,8 @@ void DirectionParameters::fillDerivedFields(const ImageData& imageData)
         Init::isUndefined(deltaK1) &&
         Init::isUndefined(deltaK2))
     {
-        // Here, we assume the min and max of DeltaKCOAPoly must be on the vertices
-        // of the image, since it is smooth and monotonic in most cases--although in
-        // actuality this is not always the case. To be totally generic, we would 
-        // have to search for an interior min and max as well.
+        // See calculateDeltaKs() for how the extent of DeltaKCOAPoly over
+        // the valid data is found
         std::pair<double, double> deltas = calculateDeltaKs(imageData);
         deltaK1 = deltas.first;
         deltaK2 = deltas.second;
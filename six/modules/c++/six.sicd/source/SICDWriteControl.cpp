@@ -20,6 +20,7 @@
  *
  */
 
+#include <six/Profiler.h>
 #include <six/sicd/SICDWriteControl.h>
 
 namespace six
@@ -181,6 +182,8 @@ void SICDWriteControl::save(void* imageData,
                             const types::RowCol<size_t>& dims,
                             bool restoreData)
 {
+    SIX_PROFILE_SCOPE("SICDWriteControl::save");
+
     if (mContainer.get() == NULL)
     {
         throw except::Exception(Ctxt(
@@ -190,6 +193,7 @@ void SICDWriteControl::save(void* imageData,
     // The first time through we'll write out all the headers
     if (!mHaveWrittenHeaders)
     {
+        SIX_PROFILE_SCOPE("SICDWriteControl::save/writeHeaders");
         writeHeaders();
         mHaveWrittenHeaders = true;
     }
@@ -199,10 +203,13 @@ void SICDWriteControl::save(void* imageData,
     const size_t numBytesPerPixel = data->getNumBytesPerPixel() / NUM_BANDS;
     const size_t numPixelsTotal = dims.area() * NUM_BANDS;
     const bool doByteSwap = shouldByteSwap();
+    SIX_PROFILE_BYTES("SICDWriteControl::save",
+                      numPixelsTotal * numBytesPerPixel);
 
     // Byte swap if needed
     if (doByteSwap)
     {
+        SIX_PROFILE_SCOPE("SICDWriteControl::save/byteSwap");
         sys::byteSwap(imageData,
                       static_cast<unsigned short>(numBytesPerPixel),
                       numPixelsTotal);
@@ -275,6 +282,7 @@ void SICDWriteControl::save(void* imageData,
     // Byte swap back if needed
     if (doByteSwap && restoreData)
     {
+        SIX_PROFILE_SCOPE("SICDWriteControl::save/byteSwap");
         sys::byteSwap(imageData,
                       static_cast<unsigned short>(numBytesPerPixel),
                       numPixelsTotal);
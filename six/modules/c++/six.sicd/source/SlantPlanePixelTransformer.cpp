@@ -40,7 +40,12 @@ SlantPlanePixelTransformer::SlantPlanePixelTransformer(
     const scene::ProjectionModel& projection) :
     mGeom(geom),
     mProjection(projection),
-    mSicdData(*reinterpret_cast<six::sicd::ComplexData*>(data.clone())),
+    mOffset(types::RowCol<double>(data.imageData->scpPixel) -
+            types::RowCol<double>(
+                    static_cast<double>(data.imageData->firstRow),
+                    static_cast<double>(data.imageData->firstCol))),
+    mSampleSpacing(data.grid->row->sampleSpacing,
+                   data.grid->col->sampleSpacing),
     mGroundPlaneNormal(mGeom.getReferencePosition())
 {
     mGroundPlaneNormal.normalize();
@@ -50,7 +55,10 @@ scene::Vector3 SlantPlanePixelTransformer::toECEF(
     const types::RowCol<size_t>& pixel) const
 {
     //! convert slant pixel to meters from scene center
-    const types::RowCol<double> imagePt(mSicdData.pixelToImagePoint(pixel));
+    //! (same as ComplexData::pixelToImagePoint())
+    const types::RowCol<double> imagePt(
+            (pixel.row - mOffset.row) * mSampleSpacing.row,
+            (pixel.col - mOffset.col) * mSampleSpacing.col);
 
     //! project into ground plane -- ecef coords
     double timeCOA(0.0);
@@ -0,0 +1,252 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <except/Exception.h>
+#include <six/FFT.h>
+#include <six/Profiler.h>
+#include <six/sicd/SpectralProcessor.h>
+
+namespace
+{
+short toShort(float value)
+{
+    const float rounded = std::floor(value + 0.5f);
+    return static_cast<short>(std::max<float>(
+            std::min<float>(rounded, std::numeric_limits<short>::max()),
+            std::numeric_limits<short>::min()));
+}
+}
+
+namespace six
+{
+namespace sicd
+{
+const size_t SpectralProcessor::DEFAULT_MAX_MEMORY = 256 * 1024 * 1024;
+
+SpectralProcessor::SpectralProcessor(const ComplexData& data,
+                                     size_t numThreads,
+                                     const std::string& name) :
+    mData(static_cast<ComplexData*>(data.clone())),
+    mNumThreads(std::max<size_t>(numThreads, 1)),
+    mName(name),
+    mMaxMemory(DEFAULT_MAX_MEMORY)
+{
+}
+
+SpectralProcessor::~SpectralProcessor()
+{
+}
+
+SpectralProcessor::Window::Window(const std::vector<double>& weights) :
+    mWeights(weights),
+    mPeak(1.0)
+{
+    if (!mWeights.empty())
+    {
+        mPeak = *std::max_element(mWeights.begin(), mWeights.end());
+        if (!(mPeak > 0.0))
+        {
+            throw except::Exception(Ctxt("Weights must be positive"));
+        }
+    }
+}
+
+double SpectralProcessor::Window::operator()(double position) const
+{
+    if (mWeights.size() < 2)
+    {
+        return 1.0;
+    }
+
+    const double index = position * (mWeights.size() - 1);
+    const size_t lower = std::min(static_cast<size_t>(index),
+                                  mWeights.size() - 2);
+    const double fraction = index - lower;
+    return (mWeights[lower] * (1.0 - fraction) +
+            mWeights[lower + 1] * fraction) / mPeak;
+}
+
+int SpectralProcessor::getSign(const DirectionParameters& direction)
+{
+    return (direction.sign == FFTSign::POS) ? 1 : -1;
+}
+
+std::vector<double>
+SpectralProcessor::getWeights(const DirectionParameters& direction)
+{
+    if (!direction.weights.empty())
+    {
+        return direction.weights;
+    }
+
+    const std::auto_ptr<Functor> function =
+            direction.calculateWeightFunction();
+    if (function.get())
+    {
+        return (*function)(DirectionParameters::DEFAULT_WEIGHT_SIZE);
+    }
+
+    if (direction.weightType.get())
+    {
+        throw except::Exception(Ctxt(
+                "Unsupported weighting: " +
+                direction.weightType->windowName));
+    }
+    return std::vector<double>();
+}
+
+std::vector<double> SpectralProcessor::getWeights(const WeightType& weightType)
+{
+    DirectionParameters direction;
+    direction.weightType.reset(new WeightType(weightType));
+    return getWeights(direction);
+}
+
+void SpectralProcessor::checkSupport(const DirectionParameters& direction) const
+{
+    const double sampleSpacing = direction.sampleSpacing;
+    const double bandwidth = direction.impulseResponseBandwidth;
+    if (Init::isUndefined(sampleSpacing) || !(sampleSpacing > 0.0) ||
+        Init::isUndefined(bandwidth) || !(bandwidth > 0.0))
+    {
+        throw except::Exception(Ctxt(
+                mName + " requires positive sample spacings and "
+                "impulse response bandwidths"));
+    }
+}
+
+void SpectralProcessor::checkPixelType() const
+{
+    const PixelType pixelType = mData->getPixelType();
+    if (pixelType != PixelType::RE32F_IM32F &&
+        pixelType != PixelType::RE16I_IM16I)
+    {
+        throw except::Exception(Ctxt(
+                mName + " requires complex float or complex short pixels"));
+    }
+}
+
+std::vector<double>
+SpectralProcessor::getOffsets(const DirectionParameters& direction,
+                              size_t size)
+{
+    const double sampleSpacing = direction.sampleSpacing;
+    const double center = Init::isUndefined(direction.deltaKCOAPoly) ?
+            0.0 : direction.deltaKCOAPoly(0.0, 0.0);
+
+    // Spectral sample ii is at ii / (size * sampleSpacing), which wraps
+    // every 1 / sampleSpacing
+    std::vector<double> offsets(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        double offset = static_cast<double>(ii) / (size * sampleSpacing) -
+                center;
+        offset -= std::floor(offset * sampleSpacing + 0.5) / sampleSpacing;
+        offsets[ii] = offset;
+    }
+    return offsets;
+}
+
+void SpectralProcessor::readStrip(NITFReadControl& reader,
+                                  const types::RowCol<size_t>& offset,
+                                  const types::RowCol<size_t>& dims,
+                                  std::complex<float>* strip) const
+{
+    SIX_PROFILE_SCOPE("SpectralProcessor::readStrip");
+
+    std::vector<std::complex<short> > shorts;
+    Region region;
+    region.setStartRow(offset.row);
+    region.setStartCol(offset.col);
+    region.setNumRows(dims.row);
+    region.setNumCols(dims.col);
+    if (mData->getPixelType() == PixelType::RE32F_IM32F)
+    {
+        region.setBuffer(reinterpret_cast<UByte*>(strip));
+    }
+    else
+    {
+        shorts.resize(dims.area());
+        region.setBuffer(reinterpret_cast<UByte*>(&shorts[0]));
+    }
+    reader.interleaved(region, 0);
+
+    for (size_t ii = 0; ii < shorts.size(); ++ii)
+    {
+        strip[ii] = std::complex<float>(shorts[ii].real(), shorts[ii].imag());
+    }
+}
+
+void SpectralProcessor::writeStrip(SICDWriteControl& writer,
+                                   const types::RowCol<size_t>& offset,
+                                   const types::RowCol<size_t>& dims,
+                                   std::complex<float>* strip) const
+{
+    SIX_PROFILE_SCOPE("SpectralProcessor::writeStrip");
+
+    if (mData->getPixelType() == PixelType::RE32F_IM32F)
+    {
+        writer.save(strip, offset, dims, false);
+        return;
+    }
+
+    std::vector<std::complex<short> > shorts(dims.area());
+    for (size_t ii = 0; ii < shorts.size(); ++ii)
+    {
+        shorts[ii] = std::complex<short>(toShort(strip[ii].real()),
+                                         toShort(strip[ii].imag()));
+    }
+    writer.save(&shorts[0], offset, dims, false);
+}
+
+double SpectralProcessor::computeImpulseResponseWidth(
+        const std::vector<double>& weights, double bandwidth)
+{
+    const std::vector<double> samples = weights.empty() ?
+            std::vector<double>(DirectionParameters::DEFAULT_WEIGHT_SIZE,
+                                1.0) :
+            weights;
+
+    // Zero pad enough that linear interpolation finds the half power point
+    const six::FFT fft(16 * six::FFT::nextPowerOfTwo(samples.size()));
+    std::vector<std::complex<float> > response(fft.getSize());
+    std::copy(samples.begin(), samples.end(), response.begin());
+    fft.forward(&response[0]);
+
+    const double half = std::abs(response[0]) / std::sqrt(2.0);
+    size_t ii = 1;
+    while (ii < response.size() / 2 && std::abs(response[ii]) > half)
+    {
+        ++ii;
+    }
+    const double above = std::abs(response[ii - 1]);
+    const double below = std::abs(response[ii]);
+    const double halfWidth = (ii - 1) + (above - half) / (above - below);
+
+    // Each weight covers bandwidth / samples.size() cycles/meter
+    return 2.0 * halfWidth * samples.size() / (fft.getSize() * bandwidth);
+}
+}
+}
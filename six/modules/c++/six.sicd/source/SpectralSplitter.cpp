@@ -0,0 +1,621 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <mem/SharedPtr.h>
+#include <six/FFT.h>
+#include <six/Profiler.h>
+#include <six/sicd/SpectralSplitter.h>
+
+namespace
+{
+// Columns that are gathered together for their FFTs
+const size_t COLUMNS_PER_GATHER = 16;
+
+// IPP indices this close to a whole pulse are that pulse
+const double IPP_TOLERANCE = 1e-6;
+
+struct SplitContext
+{
+    // Lines are rows of the strip (sub-aperture) or columns (sub-band)
+    bool rows;
+    size_t numLines;
+    std::complex<float>* strip;
+
+    // Each line's spectrum, one after the other
+    std::complex<float>* spectrum;
+    const std::vector<std::vector<float> >* filters;
+    const std::vector<std::complex<float>*>* outputs;
+    const six::FFT* fft;
+    int sign;
+};
+
+// Transforms lines of the strip into the spectrum.  Rows are transformed
+// in place.  Columns are gathered a few at a time so each row of the strip
+// is read a cache line at a time.
+class ForwardRunnable : public sys::Runnable
+{
+public:
+    ForwardRunnable(const SplitContext& context,
+                    size_t startLine,
+                    size_t numLines) :
+        mContext(context),
+        mStartLine(startLine),
+        mNumLines(numLines)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t size = mContext.fft->getSize();
+        const size_t endLine = mStartLine + mNumLines;
+        if (mContext.rows)
+        {
+            for (size_t line = mStartLine; line < endLine; ++line)
+            {
+                mContext.fft->transform(mContext.spectrum + line * size,
+                                        -mContext.sign);
+            }
+            return;
+        }
+
+        for (size_t startCol = mStartLine;
+             startCol < endLine;
+             startCol += COLUMNS_PER_GATHER)
+        {
+            const size_t numCols = std::min(COLUMNS_PER_GATHER,
+                                            endLine - startCol);
+            std::complex<float>* const spectrum =
+                    mContext.spectrum + startCol * size;
+            for (size_t row = 0; row < size; ++row)
+            {
+                const std::complex<float>* const input =
+                        mContext.strip + row * mContext.numLines + startCol;
+                for (size_t ii = 0; ii < numCols; ++ii)
+                {
+                    spectrum[ii * size + row] = input[ii];
+                }
+            }
+
+            for (size_t ii = 0; ii < numCols; ++ii)
+            {
+                mContext.fft->transform(spectrum + ii * size,
+                                        -mContext.sign);
+            }
+        }
+    }
+
+private:
+    const SplitContext& mContext;
+    const size_t mStartLine;
+    const size_t mNumLines;
+};
+
+// Filters and inverse transforms items output * numLines + line of the
+// spectrum into the outputs.  Columns are scattered a few at a time.
+class InverseRunnable : public sys::Runnable
+{
+public:
+    InverseRunnable(const SplitContext& context,
+                    size_t startItem,
+                    size_t numItems) :
+        mContext(context),
+        mStartItem(startItem),
+        mNumItems(numItems)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t size = mContext.fft->getSize();
+        const size_t numLines = mContext.numLines;
+        const size_t gather = mContext.rows ? 1 : COLUMNS_PER_GATHER;
+        std::vector<std::complex<float> > columns;
+        if (!mContext.rows)
+        {
+            columns.resize(gather * size);
+        }
+
+        size_t item = mStartItem;
+        while (item < mStartItem + mNumItems)
+        {
+            const size_t output = item / numLines;
+            const size_t startLine = item % numLines;
+            const size_t count = std::min(
+                    std::min(gather, numLines - startLine),
+                    mStartItem + mNumItems - item);
+            const float* const filter = &(*mContext.filters)[output][0];
+            std::complex<float>* const image = (*mContext.outputs)[output];
+            std::complex<float>* const lines = mContext.rows ?
+                    image + startLine * size : &columns[0];
+
+            for (size_t ii = 0; ii < count; ++ii)
+            {
+                const std::complex<float>* const spectrum =
+                        mContext.spectrum + (startLine + ii) * size;
+                std::complex<float>* const line = lines + ii * size;
+                for (size_t jj = 0; jj < size; ++jj)
+                {
+                    line[jj] = spectrum[jj] * filter[jj];
+                }
+                mContext.fft->transform(line, mContext.sign);
+            }
+
+            if (!mContext.rows)
+            {
+                for (size_t row = 0; row < size; ++row)
+                {
+                    std::complex<float>* const out =
+                            image + row * numLines + startLine;
+                    for (size_t ii = 0; ii < count; ++ii)
+                    {
+                        out[ii] = columns[ii * size + row];
+                    }
+                }
+            }
+            item += count;
+        }
+    }
+
+private:
+    const SplitContext& mContext;
+    const size_t mStartItem;
+    const size_t mNumItems;
+};
+
+// Narrows PFA's [k1, k2] to [kLower, kUpper]
+void clampSupport(double kLower, double kUpper, double& k1, double& k2)
+{
+    if (!six::Init::isUndefined(k1) && !six::Init::isUndefined(k2))
+    {
+        k1 = std::max(k1, kLower);
+        k2 = std::min(k2, kUpper);
+    }
+}
+
+// Finds the time in [tStart, tEnd] that monotonic 'poly' is 'value' at,
+// clamped to the ends
+double solve(const six::Poly1D& poly, double value, double tStart, double tEnd)
+{
+    double lower = tStart;
+    double upper = tEnd;
+    const bool increasing = poly(tEnd) >= poly(tStart);
+    if ((poly(lower) >= value) == increasing)
+    {
+        return lower;
+    }
+    if ((poly(upper) <= value) == increasing)
+    {
+        return upper;
+    }
+
+    for (size_t ii = 0; ii < 64; ++ii)
+    {
+        const double middle = (lower + upper) / 2;
+        if ((poly(middle) < value) == increasing)
+        {
+            lower = middle;
+        }
+        else
+        {
+            upper = middle;
+        }
+    }
+    return (lower + upper) / 2;
+}
+}
+
+namespace six
+{
+namespace sicd
+{
+SpectralSplitter::SpectralSplitter(const ComplexData& data,
+                                   Split split,
+                                   size_t numOutputs,
+                                   double overlap,
+                                   size_t numThreads) :
+    SpectralProcessor(data, numThreads, "Splitting"),
+    mSplit(split),
+    mNumOutputs(numOutputs)
+{
+    if (mNumOutputs == 0)
+    {
+        throw except::Exception(Ctxt("Need at least one output"));
+    }
+    if (!(overlap >= 0.0 && overlap < 1.0))
+    {
+        std::ostringstream oss;
+        oss << "Overlap " << overlap << " isn't in [0, 1)";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+    checkSupport(getDirection());
+
+    mWidth = 1.0 / (mNumOutputs - (mNumOutputs - 1) * overlap);
+    mStep = mWidth * (1.0 - overlap);
+}
+
+const DirectionParameters& SpectralSplitter::getDirection() const
+{
+    return (mSplit == SUB_APERTURE) ? *mData->grid->col : *mData->grid->row;
+}
+
+double SpectralSplitter::getStart(size_t output) const
+{
+    return output * mStep;
+}
+
+std::vector<std::vector<float> >
+SpectralSplitter::getFilters(size_t size) const
+{
+    const DirectionParameters& direction = getDirection();
+    const std::vector<double> offsets = getOffsets(direction, size);
+    const float scale = 1.0f / size;
+
+    // Windows are half open so ones that don't overlap add up to the
+    // whole support
+    std::vector<std::vector<float> > filters(
+            mNumOutputs, std::vector<float>(size, 0.0f));
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        const double position =
+                offsets[ii] / direction.impulseResponseBandwidth + 0.5;
+        for (size_t output = 0; output < mNumOutputs; ++output)
+        {
+            const double start = getStart(output);
+            const double end = (output + 1 == mNumOutputs) ?
+                    1.0 : start + mWidth;
+            if (position >= start &&
+                (position < end || (position == end && end == 1.0)))
+            {
+                filters[output][ii] = scale;
+            }
+        }
+    }
+    return filters;
+}
+
+void SpectralSplitter::splitStrip(
+        const std::vector<std::vector<float> >& filters,
+        std::complex<float>* strip,
+        const types::RowCol<size_t>& dims,
+        const std::vector<std::complex<float>*>& outputs) const
+{
+    SIX_PROFILE_SCOPE("SpectralSplitter::splitStrip");
+
+    const bool rows = (mSplit == SUB_APERTURE);
+    const six::FFT fft(rows ? dims.col : dims.row);
+
+    // Rows are transformed in place, but columns need somewhere to go
+    std::vector<std::complex<float> > columns(rows ? 0 : dims.area());
+
+    SplitContext context;
+    context.rows = rows;
+    context.numLines = rows ? dims.row : dims.col;
+    context.strip = strip;
+    context.spectrum = rows ? strip : &columns[0];
+    context.filters = &filters;
+    context.outputs = &outputs;
+    context.fft = &fft;
+    context.sign = getSign(getDirection());
+
+    // Every output shares the one forward transform
+    runInParallel<ForwardRunnable>(context, context.numLines);
+    runInParallel<InverseRunnable>(context, context.numLines * mNumOutputs);
+}
+
+void SpectralSplitter::split(
+        std::complex<float>* image,
+        const std::vector<std::complex<float>*>& outputs) const
+{
+    SIX_PROFILE_SCOPE("SpectralSplitter::split");
+
+    if (outputs.size() != mNumOutputs)
+    {
+        std::ostringstream oss;
+        oss << "Expected " << mNumOutputs << " outputs but got "
+            << outputs.size();
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    const types::RowCol<size_t> dims(mData->getNumRows(),
+                                     mData->getNumCols());
+    splitStrip(getFilters((mSplit == SUB_APERTURE) ? dims.col : dims.row),
+               image, dims, outputs);
+}
+
+void SpectralSplitter::split(NITFReadControl& reader,
+                             const std::vector<std::string>& schemaPaths,
+                             const std::vector<std::string>& outPathnames) const
+{
+    SIX_PROFILE_SCOPE("SpectralSplitter::splitStreaming");
+
+    checkPixelType();
+    if (outPathnames.size() != mNumOutputs)
+    {
+        std::ostringstream oss;
+        oss << "Expected " << mNumOutputs << " output pathnames but got "
+            << outPathnames.size();
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    const bool rows = (mSplit == SUB_APERTURE);
+    const size_t numRows = mData->getNumRows();
+    const size_t numCols = mData->getNumCols();
+    const size_t size = rows ? numCols : numRows;
+    const size_t numLines = rows ? numRows : numCols;
+
+    // The strip, every output's part of it, and a spectrum for columns
+    const size_t numBuffers = mNumOutputs + (rows ? 1 : 2);
+    const size_t linesPerStrip = std::min(
+            numLines,
+            mMaxMemory / (numBuffers * size * sizeof(std::complex<float>)));
+    if (linesPerStrip == 0)
+    {
+        std::ostringstream oss;
+        oss << "A strip of one " << (rows ? "row" : "column") << " for "
+            << mNumOutputs << " outputs won't fit in " << mMaxMemory
+            << " bytes";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    std::vector<mem::SharedPtr<SICDWriteControl> > writers;
+    for (size_t ii = 0; ii < mNumOutputs; ++ii)
+    {
+        const std::auto_ptr<ComplexData> data = createComplexData(ii);
+        writers.push_back(mem::SharedPtr<SICDWriteControl>(
+                new SICDWriteControl(outPathnames[ii], schemaPaths)));
+        writers.back()->initialize(*data);
+    }
+
+    const std::vector<std::vector<float> > filters = getFilters(size);
+    std::vector<std::complex<float> > strip(linesPerStrip * size);
+    std::vector<std::vector<std::complex<float> > > outputBuffers(
+            mNumOutputs, std::vector<std::complex<float> >(strip.size()));
+    std::vector<std::complex<float>*> outputs(mNumOutputs);
+    for (size_t ii = 0; ii < mNumOutputs; ++ii)
+    {
+        outputs[ii] = &outputBuffers[ii][0];
+    }
+
+    for (size_t startLine = 0; startLine < numLines; startLine += linesPerStrip)
+    {
+        const size_t numLinesThisStrip =
+                std::min(linesPerStrip, numLines - startLine);
+        const types::RowCol<size_t> offset = rows ?
+                types::RowCol<size_t>(startLine, 0) :
+                types::RowCol<size_t>(0, startLine);
+        const types::RowCol<size_t> dims = rows ?
+                types::RowCol<size_t>(numLinesThisStrip, numCols) :
+                types::RowCol<size_t>(numRows, numLinesThisStrip);
+
+        readStrip(reader, offset, dims, &strip[0]);
+        splitStrip(filters, &strip[0], dims, outputs);
+        for (size_t ii = 0; ii < mNumOutputs; ++ii)
+        {
+            writeStrip(*writers[ii], offset, dims, outputs[ii]);
+        }
+    }
+
+    for (size_t ii = 0; ii < mNumOutputs; ++ii)
+    {
+        writers[ii]->close();
+    }
+}
+
+double SpectralSplitter::getTime(double position) const
+{
+    double tStart = 0.0;
+    double tEnd = mData->timeline->collectDuration;
+    const ImageFormation* const imageFormation = mData->imageFormation.get();
+    if (imageFormation &&
+        !Init::isUndefined(imageFormation->tStartProc) &&
+        !Init::isUndefined(imageFormation->tEndProc))
+    {
+        tStart = imageFormation->tStartProc;
+        tEnd = imageFormation->tEndProc;
+    }
+    if (Init::isUndefined(tEnd))
+    {
+        throw except::Exception(Ctxt(
+                "Sub-apertures require the processed or collection times"));
+    }
+
+    // Polar angle is the angle of (Krg, Kaz)
+    const PFA* const pfa = mData->pfa.get();
+    const DirectionParameters& row = *mData->grid->row;
+    if (pfa && !Init::isUndefined(pfa->polarAnglePoly) &&
+        !Init::isUndefined(row.kCenter) && row.kCenter > 0.0)
+    {
+        const DirectionParameters& col = *mData->grid->col;
+        const double center = Init::isUndefined(col.deltaKCOAPoly) ?
+                0.0 : col.deltaKCOAPoly(0.0, 0.0);
+        const double kCenter = Init::isUndefined(col.kCenter) ?
+                0.0 : col.kCenter;
+        const double kaz = kCenter + center +
+                (position - 0.5) * col.impulseResponseBandwidth;
+        return solve(pfa->polarAnglePoly, std::atan(kaz / row.kCenter),
+                     tStart, tEnd);
+    }
+
+    return tStart + position * (tEnd - tStart);
+}
+
+void SpectralSplitter::updateSubaperture(double start, ComplexData& data) const
+{
+    const double tLower = getTime(start);
+    const double tUpper = getTime(start + mWidth);
+    const double tStart = std::min(tLower, tUpper);
+    const double tEnd = std::max(tLower, tUpper);
+    const double midTime = getTime(start + mWidth / 2);
+
+    if (data.imageFormation.get())
+    {
+        data.imageFormation->tStartProc = tStart;
+        data.imageFormation->tEndProc = tEnd;
+    }
+
+    // Keep the parts of the IPP sets in the sub-aperture
+    if (data.timeline->interPulsePeriod.get())
+    {
+        std::vector<TimelineSet>& sets = data.timeline->interPulsePeriod->sets;
+        std::vector<TimelineSet> trimmed;
+        for (size_t ii = 0; ii < sets.size(); ++ii)
+        {
+            TimelineSet set = sets[ii];
+            if (set.tEnd <= tStart || set.tStart >= tEnd)
+            {
+                continue;
+            }
+            set.tStart = std::max(set.tStart, tStart);
+            set.tEnd = std::min(set.tEnd, tEnd);
+            if (!Init::isUndefined(set.interPulsePeriodPoly))
+            {
+                set.interPulsePeriodStart = static_cast<int>(std::ceil(
+                        set.interPulsePeriodPoly(set.tStart) - IPP_TOLERANCE));
+                set.interPulsePeriodEnd = static_cast<int>(std::floor(
+                        set.interPulsePeriodPoly(set.tEnd) + IPP_TOLERANCE));
+            }
+            trimmed.push_back(set);
+        }
+        sets.swap(trimmed);
+    }
+
+    // Center of aperture moves to the middle of the sub-aperture
+    Poly2D& timeCOAPoly = data.grid->timeCOAPoly;
+    if (!Init::isUndefined(timeCOAPoly))
+    {
+        timeCOAPoly[0][0] += midTime - timeCOAPoly(0.0, 0.0);
+    }
+
+    if (data.scpcoa.get())
+    {
+        if (data.position.get() &&
+            !Init::isUndefined(data.position->arpPoly))
+        {
+            const SideOfTrackType sideOfTrack = data.scpcoa->sideOfTrack;
+            *data.scpcoa = SCPCOA();
+            data.scpcoa->scpTime = midTime;
+            data.scpcoa->sideOfTrack = sideOfTrack;
+            data.scpcoa->fillDerivedFields(*data.geoData, *data.grid,
+                                           *data.position);
+        }
+        else
+        {
+            data.scpcoa->scpTime = midTime;
+        }
+    }
+}
+
+void SpectralSplitter::updateSubband(double start, ComplexData& data) const
+{
+    ImageFormation* const imageFormation = data.imageFormation.get();
+    if (imageFormation &&
+        !Init::isUndefined(imageFormation->txFrequencyProcMin) &&
+        !Init::isUndefined(imageFormation->txFrequencyProcMax))
+    {
+        const double fMin = imageFormation->txFrequencyProcMin;
+        const double span = imageFormation->txFrequencyProcMax - fMin;
+        imageFormation->txFrequencyProcMin = fMin + start * span;
+        imageFormation->txFrequencyProcMax = fMin + (start + mWidth) * span;
+    }
+}
+
+std::auto_ptr<ComplexData>
+SpectralSplitter::createComplexData(size_t output) const
+{
+    if (output >= mNumOutputs)
+    {
+        std::ostringstream oss;
+        oss << "Invalid output " << output << " of " << mNumOutputs;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    std::auto_ptr<ComplexData> data(
+            static_cast<ComplexData*>(mData->clone()));
+    DirectionParameters& direction = (mSplit == SUB_APERTURE) ?
+            *data->grid->col : *data->grid->row;
+
+    const double start = getStart(output);
+    const double bandwidth = direction.impulseResponseBandwidth;
+    const double kCenter = Init::isUndefined(direction.kCenter) ?
+            0.0 : direction.kCenter;
+    const double center = Init::isUndefined(direction.deltaKCOAPoly) ?
+            0.0 : direction.deltaKCOAPoly(0.0, 0.0);
+    const double kLower = kCenter + center + (start - 0.5) * bandwidth;
+    const double kUpper = kLower + mWidth * bandwidth;
+
+    // The support shrinks to the window, and so does the weighting
+    const std::vector<double> weights = getWeights(direction);
+    if (!weights.empty())
+    {
+        const Window window(weights);
+        direction.weights.resize(DirectionParameters::DEFAULT_WEIGHT_SIZE);
+        for (size_t ii = 0; ii < direction.weights.size(); ++ii)
+        {
+            direction.weights[ii] = window(
+                    start + mWidth * ii / (direction.weights.size() - 1));
+        }
+        direction.weightType.reset(new WeightType());
+        direction.weightType->windowName = "UNKNOWN";
+    }
+    direction.impulseResponseBandwidth = mWidth * bandwidth;
+    direction.impulseResponseWidth = computeImpulseResponseWidth(
+            direction.weights, direction.impulseResponseBandwidth);
+
+    if (Init::isUndefined(direction.deltaKCOAPoly))
+    {
+        direction.deltaKCOAPoly = Poly2D(0, 0);
+        direction.deltaKCOAPoly[0][0] = 0.0;
+    }
+    direction.deltaKCOAPoly[0][0] += (kLower + kUpper) / 2 - kCenter - center;
+    if (!Init::isUndefined(direction.deltaK1))
+    {
+        direction.deltaK1 += start * bandwidth;
+    }
+    if (!Init::isUndefined(direction.deltaK2))
+    {
+        direction.deltaK2 -= (1.0 - start - mWidth) * bandwidth;
+    }
+
+    if (mSplit == SUB_APERTURE)
+    {
+        if (data->pfa.get())
+        {
+            clampSupport(kLower, kUpper, data->pfa->kaz1, data->pfa->kaz2);
+        }
+        updateSubaperture(start, *data);
+    }
+    else
+    {
+        if (data->pfa.get())
+        {
+            clampSupport(kLower, kUpper, data->pfa->krg1, data->pfa->krg2);
+        }
+        updateSubband(start, *data);
+    }
+    return data;
+}
+}
+}
@@ -0,0 +1,386 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <io/TempFile.h>
+#include <sys/File.h>
+#include <six/FFT.h>
+#include <six/Profiler.h>
+#include <six/sicd/SpectralWeighter.h>
+
+namespace
+{
+// Columns that are gathered together for their FFTs
+const size_t COLUMNS_PER_GATHER = 16;
+
+struct FilterContext
+{
+    std::complex<float>* data;
+    const float* filter;
+    const six::FFT* fft;
+    int sign;
+    size_t stride;
+};
+
+// Filters rows that are stride apart
+class RowFilterRunnable : public sys::Runnable
+{
+public:
+    RowFilterRunnable(const FilterContext& context,
+                      size_t startRow,
+                      size_t numRows) :
+        mContext(context),
+        mStartRow(startRow),
+        mNumRows(numRows)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t size = mContext.fft->getSize();
+        for (size_t row = mStartRow; row < mStartRow + mNumRows; ++row)
+        {
+            std::complex<float>* const data =
+                    mContext.data + row * mContext.stride;
+            mContext.fft->transform(data, -mContext.sign);
+            for (size_t ii = 0; ii < size; ++ii)
+            {
+                data[ii] *= mContext.filter[ii];
+            }
+            mContext.fft->transform(data, mContext.sign);
+        }
+    }
+
+private:
+    const FilterContext& mContext;
+    const size_t mStartRow;
+    const size_t mNumRows;
+};
+
+// Filters columns whose rows are stride apart.  A few columns at a time
+// are gathered so each row is read a cache line at a time.
+class ColFilterRunnable : public sys::Runnable
+{
+public:
+    ColFilterRunnable(const FilterContext& context,
+                      size_t startCol,
+                      size_t numCols) :
+        mContext(context),
+        mStartCol(startCol),
+        mNumCols(numCols)
+    {
+    }
+
+    virtual void run()
+    {
+        const size_t size = mContext.fft->getSize();
+        const size_t stride = mContext.stride;
+        std::vector<std::complex<float> > columns(COLUMNS_PER_GATHER * size);
+
+        for (size_t startCol = mStartCol;
+             startCol < mStartCol + mNumCols;
+             startCol += COLUMNS_PER_GATHER)
+        {
+            const size_t numCols = std::min(COLUMNS_PER_GATHER,
+                                            mStartCol + mNumCols - startCol);
+            for (size_t row = 0; row < size; ++row)
+            {
+                const std::complex<float>* const input =
+                        mContext.data + row * stride + startCol;
+                for (size_t ii = 0; ii < numCols; ++ii)
+                {
+                    columns[ii * size + row] = input[ii];
+                }
+            }
+
+            for (size_t ii = 0; ii < numCols; ++ii)
+            {
+                std::complex<float>* const column = &columns[ii * size];
+                mContext.fft->transform(column, -mContext.sign);
+                for (size_t jj = 0; jj < size; ++jj)
+                {
+                    column[jj] *= mContext.filter[jj];
+                }
+                mContext.fft->transform(column, mContext.sign);
+            }
+
+            for (size_t row = 0; row < size; ++row)
+            {
+                std::complex<float>* const output =
+                        mContext.data + row * stride + startCol;
+                for (size_t ii = 0; ii < numCols; ++ii)
+                {
+                    output[ii] = columns[ii * size + row];
+                }
+            }
+        }
+    }
+
+private:
+    const FilterContext& mContext;
+    const size_t mStartCol;
+    const size_t mNumCols;
+};
+}
+
+namespace six
+{
+namespace sicd
+{
+const double SpectralWeighter::MIN_WEIGHT = 0.01;
+
+SpectralWeighter::SpectralWeighter(const ComplexData& data,
+                                   size_t numThreads) :
+    SpectralProcessor(data, numThreads, "Reweighting"),
+    mScratchDirectory(".")
+{
+}
+
+void SpectralWeighter::setRowWeighting(const WeightType& weightType)
+{
+    mRowWeighting.reset(new WeightType(weightType));
+}
+
+void SpectralWeighter::setColWeighting(const WeightType& weightType)
+{
+    mColWeighting.reset(new WeightType(weightType));
+}
+
+void SpectralWeighter::deweight()
+{
+    WeightType uniform;
+    uniform.windowName = "UNIFORM";
+    setRowWeighting(uniform);
+    setColWeighting(uniform);
+}
+
+std::vector<float>
+SpectralWeighter::getFilter(const DirectionParameters& direction,
+                            const WeightType& weightType,
+                            size_t size) const
+{
+    checkSupport(direction);
+
+    const Window applied(getWeights(direction));
+    const Window target(getWeights(weightType));
+    const double bandwidth = direction.impulseResponseBandwidth;
+    const std::vector<double> offsets = getOffsets(direction, size);
+
+    std::vector<float> filter(size, 0.0f);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        const double position = offsets[ii] / bandwidth + 0.5;
+        if (position >= 0.0 && position <= 1.0)
+        {
+            filter[ii] = static_cast<float>(
+                    target(position) /
+                    std::max(applied(position), MIN_WEIGHT) / size);
+        }
+    }
+    return filter;
+}
+
+void SpectralWeighter::applyCol(const std::vector<float>& filter,
+                                std::complex<float>* rows,
+                                size_t numRows) const
+{
+    SIX_PROFILE_SCOPE("SpectralWeighter::applyCol");
+
+    const six::FFT fft(filter.size());
+    FilterContext context;
+    context.data = rows;
+    context.filter = &filter[0];
+    context.fft = &fft;
+    context.sign = getSign(*mData->grid->col);
+    context.stride = filter.size();
+    runInParallel<RowFilterRunnable>(context, numRows);
+}
+
+void SpectralWeighter::applyRow(const std::vector<float>& filter,
+                                std::complex<float>* cols,
+                                size_t numCols) const
+{
+    SIX_PROFILE_SCOPE("SpectralWeighter::applyRow");
+
+    const six::FFT fft(filter.size());
+    FilterContext context;
+    context.data = cols;
+    context.filter = &filter[0];
+    context.fft = &fft;
+    context.sign = getSign(*mData->grid->row);
+    context.stride = numCols;
+    runInParallel<ColFilterRunnable>(context, numCols);
+}
+
+void SpectralWeighter::apply(std::complex<float>* image) const
+{
+    SIX_PROFILE_SCOPE("SpectralWeighter::apply");
+
+    const size_t numRows = mData->getNumRows();
+    const size_t numCols = mData->getNumCols();
+    if (mColWeighting.get())
+    {
+        applyCol(getFilter(*mData->grid->col, *mColWeighting, numCols),
+                 image, numRows);
+    }
+    if (mRowWeighting.get())
+    {
+        applyRow(getFilter(*mData->grid->row, *mRowWeighting, numRows),
+                 image, numCols);
+    }
+}
+
+void SpectralWeighter::apply(NITFReadControl& reader,
+                             const std::vector<std::string>& schemaPaths,
+                             const std::string& outPathname) const
+{
+    SIX_PROFILE_SCOPE("SpectralWeighter::applyStreaming");
+
+    checkPixelType();
+
+    const size_t numRows = mData->getNumRows();
+    const size_t numCols = mData->getNumCols();
+    const size_t elementSize = sizeof(std::complex<float>);
+    const types::RowCol<size_t> dims(numRows, numCols);
+
+    const std::auto_ptr<ComplexData> data = createComplexData();
+    SICDWriteControl writer(outPathname, schemaPaths);
+    writer.initialize(*data);
+
+    if (dims.area() * elementSize <= mMaxMemory)
+    {
+        std::vector<std::complex<float> > image(dims.area());
+        readStrip(reader, types::RowCol<size_t>(0, 0), dims, &image[0]);
+        apply(&image[0]);
+        writeStrip(writer, types::RowCol<size_t>(0, 0), dims, &image[0]);
+        writer.close();
+        return;
+    }
+
+    const size_t rowsPerStrip = mMaxMemory / (numCols * elementSize);
+    const size_t colsPerStrip = mMaxMemory / (numRows * elementSize);
+    if (rowsPerStrip == 0 || colsPerStrip == 0)
+    {
+        std::ostringstream oss;
+        oss << "A strip of one row or column won't fit in " << mMaxMemory
+            << " bytes";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    // The file has to close before the temp file removes it
+    const io::TempFile tempFile(mScratchDirectory);
+    sys::File scratch(tempFile.pathname(), sys::File::READ_AND_WRITE,
+                      sys::File::CREATE | sys::File::TRUNCATE);
+
+    // Strips of rows go through Col into the scratch file
+    std::vector<float> filter;
+    if (mColWeighting.get())
+    {
+        filter = getFilter(*mData->grid->col, *mColWeighting, numCols);
+    }
+    std::vector<std::complex<float> > strip(rowsPerStrip * numCols);
+    for (size_t startRow = 0; startRow < numRows; startRow += rowsPerStrip)
+    {
+        const types::RowCol<size_t> stripDims(
+                std::min(rowsPerStrip, numRows - startRow), numCols);
+        readStrip(reader, types::RowCol<size_t>(startRow, 0),
+                  stripDims, &strip[0]);
+        if (!filter.empty())
+        {
+            applyCol(filter, &strip[0], stripDims.row);
+        }
+
+        const size_t numBytes = stripDims.area() * elementSize;
+        SIX_PROFILE_BYTES("SpectralWeighter::scratch/write", numBytes);
+        scratch.seekTo(static_cast<sys::Off_T>(startRow) * numCols *
+                               elementSize,
+                       sys::File::FROM_START);
+        scratch.writeFrom(reinterpret_cast<const char*>(&strip[0]),
+                          numBytes);
+    }
+
+    // Strips of columns come back out of it through Row
+    filter.clear();
+    if (mRowWeighting.get())
+    {
+        filter = getFilter(*mData->grid->row, *mRowWeighting, numRows);
+    }
+    strip.resize(numRows * colsPerStrip);
+    for (size_t startCol = 0; startCol < numCols; startCol += colsPerStrip)
+    {
+        const types::RowCol<size_t> stripDims(
+                numRows, std::min(colsPerStrip, numCols - startCol));
+        const size_t numBytes = stripDims.col * elementSize;
+        SIX_PROFILE_BYTES("SpectralWeighter::scratch/read",
+                          numBytes * numRows);
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            scratch.seekTo((static_cast<sys::Off_T>(row) * numCols +
+                            startCol) * elementSize,
+                           sys::File::FROM_START);
+            scratch.readInto(
+                    reinterpret_cast<char*>(&strip[row * stripDims.col]),
+                    numBytes);
+        }
+
+        if (!filter.empty())
+        {
+            applyRow(filter, &strip[0], stripDims.col);
+        }
+        writeStrip(writer, types::RowCol<size_t>(0, startCol),
+                   stripDims, &strip[0]);
+    }
+
+    scratch.close();
+    writer.close();
+}
+
+std::auto_ptr<ComplexData> SpectralWeighter::createComplexData() const
+{
+    std::auto_ptr<ComplexData> data(
+            static_cast<ComplexData*>(mData->clone()));
+
+    DirectionParameters* const directions[] = {
+        data->grid->row.get(), data->grid->col.get()
+    };
+    const WeightType* const weightings[] = {
+        mRowWeighting.get(), mColWeighting.get()
+    };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        if (weightings[ii])
+        {
+            DirectionParameters& direction = *directions[ii];
+            direction.weightType.reset(new WeightType(*weightings[ii]));
+            direction.weights = getWeights(*weightings[ii]);
+            direction.impulseResponseWidth = computeImpulseResponseWidth(
+                    direction.weights, direction.impulseResponseBandwidth);
+        }
+    }
+    return data;
+}
+}
+}
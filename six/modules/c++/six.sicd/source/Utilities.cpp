@@ -53,58 +53,6 @@ six::Region buildRegion(const types::RowCol<size_t>& offset,
     retv.setBuffer(reinterpret_cast<six::UByte*>(buffer));
     return retv;
 }
-
-// Reads in ~32 MB of rows at a time, converts to complex<float>, and keeps
-// going until reads everything
-void readAndConvertSICD(six::NITFReadControl& reader,
-                        size_t imageNumber,
-                        const types::RowCol<size_t>& offset,
-                        const types::RowCol<size_t>& extent,
-                        std::complex<float>* buffer)
-{
-
-
-    // One for the real component, one for imaginary of each pixel
-    const size_t elementsPerRow = extent.col * 2;
-
-    // Get at least 32MB per read
-    const size_t rowsAtATime =
-            (32000000 / (elementsPerRow * sizeof(short))) + 1;
-
-    // Allocate temp buffer
-    std::vector<short> tempVector(elementsPerRow * rowsAtATime);
-    short* const tempBuffer = &tempVector[0];
-
-    const size_t endRow = offset.row + extent.row;
-
-    for (size_t row = offset.row, rowsToRead = rowsAtATime;
-         row < endRow;
-         row += rowsToRead)
-    {
-
-        // If we would read beyond the input buffer, don't
-        if (row + rowsToRead > endRow)
-        {
-            rowsToRead = endRow - row;
-        }
-
-        // Read into the temp buffer
-        types::RowCol<size_t> swathOffset(row, offset.col);
-        types::RowCol<size_t> swathExtent(rowsToRead, extent.col);
-        six::Region region = buildRegion(swathOffset, swathExtent, tempBuffer);
-        reader.interleaved(region, imageNumber);
-
-        // Take each Int16 out of the temp buffer and put it into the real
-        // buffer as a Float32
-        float* const bufferPtr = reinterpret_cast<float*>(buffer) +
-                ((row - offset.row) * elementsPerRow);
-
-        for (size_t index = 0; index < elementsPerRow * rowsToRead; index++)
-        {
-            bufferPtr[index] = tempBuffer[index];
-        }
-    }
-}
 }
 
 namespace six
@@ -233,14 +181,15 @@ void Utilities::getValidDataPolygon(
 
         const types::RowCol<double> lastOPPixel(opOffset + opDims - 1);
 
+        // Keep these in perimeter order so the result is a simple polygon
         std::vector<types::RowCol<double> > opCorners(4);
         opCorners[0] = opOffset;
         opCorners[1] = types::RowCol<double>(static_cast<double>(opOffset.row),
 				static_cast<double>(lastOPPixel.col));
-        opCorners[2] = types::RowCol<double>(
+        opCorners[2] = lastOPPixel;
+        opCorners[3] = types::RowCol<double>(
 				static_cast<double>(lastOPPixel.row),
 				static_cast<double>(opOffset.col));
-        opCorners[3] = lastOPPixel;
 
         const six::sicd::AreaPlane& areaPlane =
                 *sicdData.radarCollection->area->plane;
@@ -315,6 +264,19 @@ void Utilities::getValidDataPolygon(
     //       isn't going to tell us anything new...
 }
 
+std::auto_ptr<ValidDataMask> Utilities::getValidDataMask(
+        const ComplexData& sicdData,
+        const scene::ProjectionModel& projection)
+{
+    std::vector<types::RowCol<double> > validData;
+    getValidDataPolygon(sicdData, projection, validData);
+
+    return std::auto_ptr<ValidDataMask>(new ValidDataMask(
+            validData,
+            types::RowCol<size_t>(sicdData.getNumRows(),
+                                  sicdData.getNumCols())));
+}
+
 void Utilities::readSicd(const std::string& sicdPathname,
              const std::vector<std::string>& schemaPaths,
              std::auto_ptr<ComplexData>& complexData,
@@ -396,18 +358,11 @@ void Utilities::getWidebandData(NITFReadControl& reader,
                     + std::string(" byte buffer was expected")));
     }
 
-    if (pixelType == PixelType::RE32F_IM32F)
+    if (pixelType == PixelType::RE32F_IM32F ||
+        pixelType == PixelType::RE16I_IM16I)
     {
         six::Region region = buildRegion(offset, extent, buffer);
-        reader.interleaved(region, imageNumber);
-    }
-    else if (pixelType == PixelType::RE16I_IM16I)
-    {
-        readAndConvertSICD(reader,
-                           imageNumber,
-                           offset,
-                           extent,
-                           buffer);
+        reader.interleavedComplex(region, imageNumber, buffer);
     }
     else
     {
@@ -473,6 +428,8 @@ void Utilities::getWidebandData(
                                    six::sicd::ComplexXMLControl>());
     six::NITFReadControl reader;
     reader.setXMLControlRegistry(&xmlRegistry);
+    reader.getOptions().setParameter(six::NITFReadControl::OPT_MEMORY_MAP,
+                                     1);
     reader.load(sicdPathname);
 
     getWidebandData(reader, complexData, offset, extent, buffer);
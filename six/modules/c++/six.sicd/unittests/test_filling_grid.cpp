@@ -19,6 +19,9 @@
 *
 */
 
+#include <algorithm>
+#include <limits>
+
 #include <import/six/sicd.h>
 #include "TestCase.h"
 
@@ -64,6 +67,119 @@ TEST_CASE(DerivedDeltaKsWithImageData)
     TEST_ASSERT_ALMOST_EQ(row.deltaK2, 0.1);
 }
 
+TEST_CASE(DerivedDeltaKsFullImage)
+{
+    six::sicd::ImageData imageData;
+    imageData.numRows = 11;
+    imageData.numCols = 21;
+    six::sicd::DirectionParameters row;
+    row.impulseResponseBandwidth = 0.1;
+    row.sampleSpacing = 1;
+    row.deltaKCOAPoly = six::Poly2D(1, 1);
+    row.deltaKCOAPoly[1][0] = 0.01;
+    row.deltaKCOAPoly[0][1] = 0.01;
+    row.fillDerivedFields(imageData);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK1, -0.05);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK2, 0.35);
+}
+
+TEST_CASE(DerivedDeltaKsFullImageMatchesCorners)
+{
+    // When the extrema of DeltaKCOAPoly lie on the image corners, the
+    // lattice search has to reproduce the old corner-only results
+    six::sicd::ImageData imageData;
+    imageData.numRows = 101;
+    imageData.numCols = 57;
+    six::sicd::DirectionParameters row;
+    row.impulseResponseBandwidth = 0.1;
+    row.sampleSpacing = 1;
+    row.deltaKCOAPoly = six::Poly2D(1, 1);
+    row.deltaKCOAPoly[0][0] = 0.02;
+    row.deltaKCOAPoly[1][0] = -0.001;
+    row.deltaKCOAPoly[0][1] = 0.002;
+    row.deltaKCOAPoly[1][1] = 0.00001;
+
+    const double corners[][2] = { {0, 0}, {0, 56}, {100, 56}, {100, 0} };
+    double minDeltaK = std::numeric_limits<double>::infinity();
+    double maxDeltaK = -std::numeric_limits<double>::infinity();
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        const double deltaK =
+                row.deltaKCOAPoly.atY(corners[ii][1])(corners[ii][0]);
+        minDeltaK = std::min(minDeltaK, deltaK);
+        maxDeltaK = std::max(maxDeltaK, deltaK);
+    }
+
+    row.fillDerivedFields(imageData);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK1, minDeltaK - 0.05);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK2, maxDeltaK + 0.05);
+}
+
+TEST_CASE(DerivedDeltaKsFullImageInteriorExtremum)
+{
+    // DeltaKCOAPoly peaks mid-image.  Evaluating only the corners gave
+    // [-0.05, 0.05]; the lattice now finds the interior maximum as well.
+    six::sicd::ImageData imageData;
+    imageData.numRows = 11;
+    imageData.numCols = 21;
+    six::sicd::DirectionParameters row;
+    row.impulseResponseBandwidth = 0.1;
+    row.sampleSpacing = 1;
+    row.deltaKCOAPoly = six::Poly2D(2, 0);
+    row.deltaKCOAPoly[1][0] = 0.01;
+    row.deltaKCOAPoly[2][0] = -0.001;
+    row.fillDerivedFields(imageData);
+
+    // The lattice samples rows at multiples of 10/9, so the closest it
+    // gets to the true peak at row 5 is row 40/9
+    const double peakRow = 40.0 / 9.0;
+    const double peak = 0.01 * peakRow - 0.001 * peakRow * peakRow;
+    TEST_ASSERT_ALMOST_EQ(row.deltaK1, -0.05);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK2, peak + 0.05);
+    TEST_ASSERT_GREATER(row.deltaK2, 0.05);
+}
+
+TEST_CASE(DerivedDeltaKsValidDataInterior)
+{
+    // Same DeltaKCOAPoly as above.  A valid data polygon covering the whole
+    // image gives the same answer as no polygon at all.
+    six::sicd::ImageData imageData;
+    imageData.numRows = 11;
+    imageData.numCols = 21;
+    six::sicd::DirectionParameters row;
+    row.impulseResponseBandwidth = 0.1;
+    row.sampleSpacing = 1;
+    row.deltaKCOAPoly = six::Poly2D(2, 0);
+    row.deltaKCOAPoly[1][0] = 0.01;
+    row.deltaKCOAPoly[2][0] = -0.001;
+
+    row.fillDerivedFields(imageData);
+    const double fullImageDeltaK1 = row.deltaK1;
+    const double fullImageDeltaK2 = row.deltaK2;
+
+    imageData.validData.push_back(six::RowColInt(0, 0));
+    imageData.validData.push_back(six::RowColInt(0, 20));
+    imageData.validData.push_back(six::RowColInt(10, 20));
+    imageData.validData.push_back(six::RowColInt(10, 0));
+    row.deltaK1 = six::Init::undefined<double>();
+    row.deltaK2 = six::Init::undefined<double>();
+    row.fillDerivedFields(imageData);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK1, fullImageDeltaK1);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK2, fullImageDeltaK2);
+
+    // Only rows 0-2 are valid.  The lattice rows there are 0, 10/9 and
+    // 20/9, and the last of those beats the polygon's vertices at row 2.
+    imageData.validData[2] = six::RowColInt(2, 20);
+    imageData.validData[3] = six::RowColInt(2, 0);
+    row.deltaK1 = six::Init::undefined<double>();
+    row.deltaK2 = six::Init::undefined<double>();
+    row.fillDerivedFields(imageData);
+    const double sampleRow = 20.0 / 9.0;
+    TEST_ASSERT_ALMOST_EQ(row.deltaK1, -0.05);
+    TEST_ASSERT_ALMOST_EQ(row.deltaK2, 0.01 * sampleRow -
+            0.001 * sampleRow * sampleRow + 0.05);
+}
+
 TEST_CASE(IdentityWeightFunction)
 {
     six::sicd::DirectionParameters row;
@@ -325,6 +441,10 @@ int main(int, char**)
 {
     TEST_CHECK(DerivedDeltaKsNoImageData);
     TEST_CHECK(DerivedDeltaKsWithImageData);
+    TEST_CHECK(DerivedDeltaKsFullImage);
+    TEST_CHECK(DerivedDeltaKsFullImageMatchesCorners);
+    TEST_CHECK(DerivedDeltaKsFullImageInteriorExtremum);
+    TEST_CHECK(DerivedDeltaKsValidDataInterior);
     TEST_CHECK(IdentityWeightFunction);
     TEST_CHECK(HammingWindow);
     TEST_CHECK(KaiserWindow);
@@ -0,0 +1,352 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <mem/ScopedArray.h>
+#include <mem/SharedPtr.h>
+#include <sys/OS.h>
+#include <six/MemoryMappedIO.h>
+#include <six/NITFReadControl.h>
+#include <six/NITFWriteControl.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <scene/Utilities.h>
+
+namespace
+{
+const size_t NUM_ROWS = 123;
+const size_t NUM_COLS = 97;
+
+// Create dummy SICD data
+std::auto_ptr<six::Data> createData(six::PixelType pixelType)
+{
+    six::sicd::ComplexData* data(new six::sicd::ComplexData());
+    std::auto_ptr<six::Data> scopedData(data);
+    data->setPixelType(pixelType);
+    data->setNumRows(NUM_ROWS);
+    data->setNumCols(NUM_COLS);
+    data->setName("corename");
+    data->setSource("sensorname");
+    data->collectionInformation->classification.level = "UNCLASSIFIED";
+    data->setCreationTime(six::DateTime());
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.3, -83.8);
+    corners.upperRight = six::LatLon(42.3, -83.7);
+    corners.lowerRight = six::LatLon(42.2, -83.7);
+    corners.lowerLeft = six::LatLon(42.2, -83.8);
+    data->setImageCorners(corners);
+    data->collectionInformation->radarMode = six::RadarModeType::SPOTLIGHT;
+    data->scpcoa->sideOfTrack = six::SideOfTrackType::LEFT;
+    data->geoData->scp.llh = six::LatLonAlt(42.2708, -83.7264);
+    data->geoData->scp.ecf =
+            scene::Utilities::latLonToECEF(data->geoData->scp.llh);
+    data->grid->timeCOAPoly = six::Poly2D(0, 0);
+    data->grid->timeCOAPoly[0][0] = 15605743.142846;
+    data->position->arpPoly = six::PolyXYZ(0);
+    data->position->arpPoly[0] = 0.0;
+
+    data->radarCollection->txFrequencyMin = 0.0;
+    data->radarCollection->txFrequencyMax = 0.0;
+    data->radarCollection->txPolarization = six::PolarizationType::OTHER;
+    mem::ScopedCloneablePtr<six::sicd::ChannelParameters>
+            rcvChannel(new six::sicd::ChannelParameters());
+    rcvChannel->txRcvPolarization = six::DualPolarizationType::OTHER;
+    data->radarCollection->rcvChannels.push_back(rcvChannel);
+
+    data->grid->row->sign = six::FFTSign::POS;
+    data->grid->row->unitVector = 0.0;
+    data->grid->row->sampleSpacing = 0;
+    data->grid->row->impulseResponseWidth = 0;
+    data->grid->row->impulseResponseBandwidth = 0;
+    data->grid->row->kCenter = 0;
+    data->grid->row->deltaK1 = 0;
+    data->grid->row->deltaK2 = 0;
+    data->grid->col->sign = six::FFTSign::POS;
+    data->grid->col->unitVector = 0.0;
+    data->grid->col->sampleSpacing = 0;
+    data->grid->col->impulseResponseWidth = 0;
+    data->grid->col->impulseResponseBandwidth = 0;
+    data->grid->col->kCenter = 0;
+    data->grid->col->deltaK1 = 0;
+    data->grid->col->deltaK2 = 0;
+
+    data->imageFormation->rcvChannelProcessed->numChannelsProcessed = 1;
+    data->imageFormation->rcvChannelProcessed->channelIndex.push_back(0);
+
+    data->pfa.reset(new six::sicd::PFA());
+    data->pfa->spatialFrequencyScaleFactorPoly = six::Poly1D(0);
+    data->pfa->spatialFrequencyScaleFactorPoly[0] = 42;
+    data->pfa->polarAnglePoly = six::Poly1D(0);
+    data->pfa->polarAnglePoly[0] = 42;
+
+    data->timeline->collectStart = six::DateTime();
+    data->timeline->collectDuration = 1.0;
+    data->imageFormation->txRcvPolarizationProc =
+            six::DualPolarizationType::OTHER;
+    data->imageFormation->tStartProc = 0;
+    data->imageFormation->tEndProc = 0;
+
+    data->scpcoa->scpTime = 15605743.142846;
+    data->scpcoa->slantRange = 0.0;
+    data->scpcoa->groundRange = 0.0;
+    data->scpcoa->dopplerConeAngle = 0.0;
+    data->scpcoa->grazeAngle = 0.0;
+    data->scpcoa->incidenceAngle = 0.0;
+    data->scpcoa->twistAngle = 0.0;
+    data->scpcoa->slopeAngle = 0.0;
+    data->scpcoa->azimAngle = 0.0;
+    data->scpcoa->layoverAngle = 0.0;
+    data->scpcoa->arpPos = 0.0;
+    data->scpcoa->arpVel = 0.0;
+    data->scpcoa->arpAcc = 0.0;
+
+    data->pfa->focusPlaneNormal = 0.0;
+    data->pfa->imagePlaneNormal = 0.0;
+    data->pfa->polarAngleRefTime = 0.0;
+    data->pfa->krg1 = 0;
+    data->pfa->krg2 = 0;
+    data->pfa->kaz1 = 0;
+    data->pfa->kaz2 = 0;
+
+    data->imageFormation->txFrequencyProcMin = 0;
+    data->imageFormation->txFrequencyProcMax = 0;
+
+    return scopedData;
+}
+
+// Writes a SICD whose components count up from -1000
+struct TestHelper
+{
+    // Segments are split every 'maxILOCRows' rows if it's positive
+    TestHelper(six::PixelType pixelType, size_t maxILOCRows = 0,
+               bool directIO = false) :
+        mPathname("test_read_sicd_mapped.nitf"),
+        mPixelType(pixelType),
+        mComponents(NUM_ROWS * NUM_COLS * 2)
+    {
+        mXmlRegistry.addCreator(
+                six::DataType::COMPLEX,
+                new six::XMLControlCreatorT<
+                        six::sicd::ComplexXMLControl>());
+
+        for (size_t ii = 0; ii < mComponents.size(); ++ii)
+        {
+            mComponents[ii] = static_cast<float>(ii % 30011) - 1000.0f;
+        }
+
+        mem::SharedPtr<six::Container> container(new six::Container(
+                six::DataType::COMPLEX));
+        container->addData(createData(pixelType));
+
+        six::NITFWriteControl writer;
+        if (maxILOCRows > 0)
+        {
+            writer.getOptions().setParameter(
+                    six::NITFWriteControl::OPT_MAX_ILOC_ROWS, maxILOCRows);
+        }
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_DIRECT_IO, directIO ? 1 : 0);
+        writer.setXMLControlRegistry(&mXmlRegistry);
+        writer.initialize(container);
+
+        if (pixelType == six::PixelType::RE16I_IM16I)
+        {
+            std::vector<sys::Int16_T> image(mComponents.begin(),
+                                            mComponents.end());
+            std::vector<six::UByte*> buffers(
+                    1, reinterpret_cast<six::UByte*>(&image[0]));
+            writer.save(buffers, mPathname);
+        }
+        else
+        {
+            std::vector<float> image(mComponents);
+            std::vector<six::UByte*> buffers(
+                    1, reinterpret_cast<six::UByte*>(&image[0]));
+            writer.save(buffers, mPathname);
+        }
+    }
+
+    ~TestHelper()
+    {
+        try
+        {
+            sys::OS().remove(mPathname);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    // The window of components a region covers
+    std::vector<float> getComponents(const six::Region& region) const
+    {
+        std::vector<float> components;
+        const size_t numRows = static_cast<size_t>(region.getNumRows());
+        for (size_t row = 0; row < numRows; ++row)
+        {
+            const size_t start = ((region.getStartRow() + row) * NUM_COLS +
+                                  region.getStartCol()) * 2;
+            components.insert(components.end(),
+                              mComponents.begin() + start,
+                              mComponents.begin() + start +
+                                      region.getNumCols() * 2);
+        }
+        return components;
+    }
+
+    // Checks interleaved(), interleavedConcurrent() and interleavedComplex()
+    // over the whole image and a window that straddles segments
+    bool read(six::NITFReadControl& reader) const
+    {
+        six::Region regions[2];
+        regions[0].setNumRows(NUM_ROWS);
+        regions[0].setNumCols(NUM_COLS);
+        regions[1].setStartRow(31);
+        regions[1].setNumRows(70);
+        regions[1].setStartCol(5);
+        regions[1].setNumCols(80);
+
+        for (size_t ii = 0; ii < 2; ++ii)
+        {
+            const std::vector<float> expected = getComponents(regions[ii]);
+
+            six::Region region(regions[ii]);
+            const mem::ScopedArray<six::UByte> image(
+                    reader.interleaved(region, 0));
+            six::Region concurrentRegion(regions[ii]);
+            const mem::ScopedArray<six::UByte> concurrentImage(
+                    reader.interleavedConcurrent(concurrentRegion, 0));
+            if (!matches(image.get(), expected) ||
+                !matches(concurrentImage.get(), expected))
+            {
+                return false;
+            }
+
+            std::vector<std::complex<float> > complexImage(
+                    expected.size() / 2);
+            six::Region complexRegion(regions[ii]);
+            reader.interleavedComplex(complexRegion, 0, &complexImage[0]);
+            if (!std::equal(expected.begin(), expected.end(),
+                            reinterpret_cast<float*>(&complexImage[0])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool matches(const six::UByte* image,
+                 const std::vector<float>& expected) const
+    {
+        if (mPixelType == six::PixelType::RE16I_IM16I)
+        {
+            const std::vector<sys::Int16_T> components(expected.begin(),
+                                                       expected.end());
+            return std::equal(components.begin(), components.end(),
+                              reinterpret_cast<const sys::Int16_T*>(image));
+        }
+        return std::equal(expected.begin(), expected.end(),
+                          reinterpret_cast<const float*>(image));
+    }
+
+    const std::string mPathname;
+    const six::PixelType mPixelType;
+    six::XMLControlRegistry mXmlRegistry;
+    std::vector<float> mComponents;
+};
+
+bool readFile(const TestHelper& testHelper, bool memoryMap,
+              bool directIO = false)
+{
+    six::NITFReadControl reader;
+    reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+    reader.getOptions().setParameter(six::NITFReadControl::OPT_MEMORY_MAP,
+                                     memoryMap ? 1 : 0);
+    reader.getOptions().setParameter(six::NITFReadControl::OPT_DIRECT_IO,
+                                     directIO ? 1 : 0);
+    reader.load(testHelper.mPathname);
+    return testHelper.read(reader);
+}
+
+TEST_CASE(testFloatPixels)
+{
+    TestHelper testHelper(six::PixelType::RE32F_IM32F, 40);
+    TEST_ASSERT(readFile(testHelper, false));
+    TEST_ASSERT(readFile(testHelper, true));
+}
+
+TEST_CASE(testInt16Pixels)
+{
+    TestHelper testHelper(six::PixelType::RE16I_IM16I, 40);
+    TEST_ASSERT(readFile(testHelper, false));
+    TEST_ASSERT(readFile(testHelper, true));
+}
+
+TEST_CASE(testOneSegment)
+{
+    TestHelper testHelper(six::PixelType::RE16I_IM16I);
+    TEST_ASSERT(readFile(testHelper, true));
+}
+
+TEST_CASE(testLoadMemoryMappedIO)
+{
+    TestHelper testHelper(six::PixelType::RE16I_IM16I, 50);
+
+    mem::SharedPtr<nitf::IOInterface> io(
+            new six::MemoryMappedIO(testHelper.mPathname));
+    six::NITFReadControl reader;
+    reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+    reader.load(io);
+    TEST_ASSERT(testHelper.read(reader));
+}
+
+TEST_CASE(testDirectIO)
+{
+    TestHelper testHelper(six::PixelType::RE16I_IM16I, 40, true);
+    TEST_ASSERT(readFile(testHelper, false));
+    TEST_ASSERT(readFile(testHelper, false, true));
+
+    // The mapping wins when both are asked for
+    TEST_ASSERT(readFile(testHelper, true, true));
+}
+
+TEST_CASE(testMissingFile)
+{
+    TEST_EXCEPTION(six::MemoryMappedIO("test_read_sicd_mapped_missing.nitf"));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testFloatPixels);
+    TEST_CHECK(testInt16Pixels);
+    TEST_CHECK(testOneSegment);
+    TEST_CHECK(testLoadMemoryMappedIO);
+    TEST_CHECK(testDirectIO);
+    TEST_CHECK(testMissingFile);
+    return 0;
+}
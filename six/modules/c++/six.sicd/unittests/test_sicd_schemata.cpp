@@ -2488,6 +2488,17 @@ bool cmpRoundTripXMLs(std::string xmlText, std::string xmlPath = "",
             if (verbose) diffXMLs("Input    ", xmlText,  "Parsed   ", postRTxml,  debugLineCnt);
             return false;
         }
+
+        // streaming the XML straight out has to give the same bytes as
+        // printing the DOM
+        oss.reset();
+        xmlControl->toXML(data, std::vector<std::string>(), oss);
+        const std::string streamedXML(oss.stream().str());
+        if (streamedXML != postRTxml)
+        {
+            if (verbose) diffXMLs("DOM      ", postRTxml, "Streamed ", streamedXML, debugLineCnt);
+            return false;
+        }
     }
     catch (except::Exception& /*ex*/)
     {
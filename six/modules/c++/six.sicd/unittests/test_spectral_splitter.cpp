@@ -0,0 +1,504 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <vector>
+
+#include <sys/OS.h>
+#include <scene/Utilities.h>
+#include <import/six.h>
+#include <import/six/sicd.h>
+#include <six/sicd/SICDWriteControl.h>
+#include "TestCase.h"
+
+namespace
+{
+static const std::string INPUT_PATHNAME("test_spectral_splitter_in.nitf");
+static const std::string OUTPUT_PATHNAME("test_spectral_splitter_out");
+static const size_t NUM_ROWS(60);
+static const size_t NUM_COLS(48);
+
+typedef std::vector<std::complex<float> > Image;
+
+void setDirection(double sampleSpacing,
+                  double bandwidth,
+                  six::sicd::DirectionParameters& direction)
+{
+    direction.sign = six::FFTSign::NEG;
+    direction.unitVector = 0.0;
+    direction.sampleSpacing = sampleSpacing;
+    direction.impulseResponseBandwidth = bandwidth;
+    direction.impulseResponseWidth = 0.886 / bandwidth;
+    direction.kCenter = 0.0;
+    direction.deltaK1 = -bandwidth / 2;
+    direction.deltaK2 = bandwidth / 2;
+    direction.weightType.reset(new six::sicd::WeightType());
+    direction.weightType->windowName = "UNIFORM";
+}
+
+// Enough metadata to write a SICD
+std::auto_ptr<six::sicd::ComplexData> createData(six::PixelType pixelType)
+{
+    std::auto_ptr<six::sicd::ComplexData> data(new six::sicd::ComplexData());
+    data->setPixelType(pixelType);
+    data->setNumRows(NUM_ROWS);
+    data->setNumCols(NUM_COLS);
+    data->setName("corename");
+    data->setSource("sensorname");
+    data->collectionInformation->classification.level = "UNCLASSIFIED";
+    data->collectionInformation->radarMode = six::RadarModeType::SPOTLIGHT;
+    data->setCreationTime(six::DateTime());
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.3, -83.8);
+    corners.upperRight = six::LatLon(42.3, -83.7);
+    corners.lowerRight = six::LatLon(42.2, -83.7);
+    corners.lowerLeft = six::LatLon(42.2, -83.8);
+    data->setImageCorners(corners);
+    data->scpcoa->sideOfTrack = six::SideOfTrackType::LEFT;
+    data->geoData->scp.llh = six::LatLonAlt(42.2708, -83.7264);
+    data->geoData->scp.ecf =
+            scene::Utilities::latLonToECEF(data->geoData->scp.llh);
+    data->grid->timeCOAPoly = six::Poly2D(0, 0);
+    data->grid->timeCOAPoly[0][0] = 1.0;
+
+    // Flying north at 7 km/s, 700 km up, over the SCP at t = 1
+    const six::Vector3& scp = data->geoData->scp.ecf;
+    const six::Vector3 up = scp.unit();
+    six::Vector3 pole(0.0);
+    pole[2] = 1.0;
+    const six::Vector3 velocity = (pole - up * up.dot(pole)).unit() * 7000.0;
+    data->position->arpPoly = six::PolyXYZ(1);
+    data->position->arpPoly[0] = scp + up * 700000.0 - velocity;
+    data->position->arpPoly[1] = velocity;
+
+    data->radarCollection->txFrequencyMin = 9.0e9;
+    data->radarCollection->txFrequencyMax = 10.0e9;
+    data->radarCollection->txPolarization = six::PolarizationType::OTHER;
+    mem::ScopedCloneablePtr<six::sicd::ChannelParameters>
+            rcvChannel(new six::sicd::ChannelParameters());
+    rcvChannel->txRcvPolarization = six::DualPolarizationType::OTHER;
+    data->radarCollection->rcvChannels.push_back(rcvChannel);
+
+    // Both directions are oversampled by 1.25
+    setDirection(0.5, 1.6, *data->grid->row);
+    setDirection(0.8, 1.0, *data->grid->col);
+
+    data->imageFormation->rcvChannelProcessed->numChannelsProcessed = 1;
+    data->imageFormation->rcvChannelProcessed->channelIndex.push_back(0);
+    data->imageFormation->txRcvPolarizationProc =
+            six::DualPolarizationType::OTHER;
+    data->imageFormation->tStartProc = 0.0;
+    data->imageFormation->tEndProc = 2.0;
+    data->imageFormation->txFrequencyProcMin = 9.0e9;
+    data->imageFormation->txFrequencyProcMax = 10.0e9;
+    data->timeline->collectStart = six::DateTime();
+    data->timeline->collectDuration = 2.0;
+
+    data->scpcoa->scpTime = 1.0;
+    data->scpcoa->slantRange = 0.0;
+    data->scpcoa->groundRange = 0.0;
+    data->scpcoa->dopplerConeAngle = 0.0;
+    data->scpcoa->grazeAngle = 0.0;
+    data->scpcoa->incidenceAngle = 0.0;
+    data->scpcoa->twistAngle = 0.0;
+    data->scpcoa->slopeAngle = 0.0;
+    data->scpcoa->azimAngle = 0.0;
+    data->scpcoa->layoverAngle = 0.0;
+    data->scpcoa->arpPos = 0.0;
+    data->scpcoa->arpVel = 0.0;
+    data->scpcoa->arpAcc = 0.0;
+    return data;
+}
+
+// Random pixels band limited to the supports
+Image createImage(const six::sicd::ComplexData& data)
+{
+    std::srand(42);
+    Image image(NUM_ROWS * NUM_COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = std::complex<float>(
+                static_cast<float>(std::rand() % 2001) - 1000.0f,
+                static_cast<float>(std::rand() % 2001) - 1000.0f);
+    }
+
+    six::sicd::SpectralWeighter limiter(data, 1);
+    limiter.deweight();
+    limiter.apply(&image[0]);
+    return image;
+}
+
+double getMaxDifference(const Image& lhs, const Image& rhs)
+{
+    double maxDifference(0.0);
+    for (size_t ii = 0; ii < lhs.size(); ++ii)
+    {
+        maxDifference = std::max<double>(maxDifference,
+                                         std::abs(lhs[ii] - rhs[ii]));
+    }
+    return maxDifference;
+}
+
+std::vector<std::complex<float>*> getPointers(std::vector<Image>& images)
+{
+    std::vector<std::complex<float>*> pointers;
+    for (size_t ii = 0; ii < images.size(); ++ii)
+    {
+        pointers.push_back(&images[ii][0]);
+    }
+    return pointers;
+}
+
+TEST_CASE(testPartition)
+{
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+    const Image image = createImage(*data);
+
+    // Windows that don't overlap add back up to the image
+    const six::sicd::SpectralSplitter::Split splits[] = {
+        six::sicd::SpectralSplitter::SUB_APERTURE,
+        six::sicd::SpectralSplitter::SUB_BAND
+    };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        const six::sicd::SpectralSplitter splitter(*data, splits[ii], 3,
+                                                   0.0, 4);
+        std::vector<Image> outputs(3, Image(image.size()));
+        Image scratch(image);
+        splitter.split(&scratch[0], getPointers(outputs));
+
+        Image sum(image.size());
+        for (size_t jj = 0; jj < outputs.size(); ++jj)
+        {
+            TEST_ASSERT(getMaxDifference(outputs[jj], image) > 100.0);
+            for (size_t kk = 0; kk < sum.size(); ++kk)
+            {
+                sum[kk] += outputs[jj][kk];
+            }
+        }
+        TEST_ASSERT(getMaxDifference(sum, image) < 0.05);
+    }
+}
+
+TEST_CASE(testSubapertureMetadata)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+    data->grid->col->weightType->windowName = "HAMMING";
+    data->timeline->interPulsePeriod.reset(
+            new six::sicd::InterPulsePeriod());
+    six::sicd::TimelineSet set;
+    set.tStart = 0.0;
+    set.tEnd = 2.0;
+    set.interPulsePeriodStart = 0;
+    set.interPulsePeriodEnd = 2000;
+    set.interPulsePeriodPoly = six::Poly1D(1);
+    set.interPulsePeriodPoly[0] = 0.0;
+    set.interPulsePeriodPoly[1] = 1000.0;
+    data->timeline->interPulsePeriod->sets.push_back(set);
+
+    // Windows are 0.4 of the support, 0.2 apart
+    const six::sicd::SpectralSplitter splitter(
+            *data, six::sicd::SpectralSplitter::SUB_APERTURE, 4, 0.5, 1);
+    TEST_ASSERT_EQ(splitter.getNumOutputs(), 4);
+    TEST_EXCEPTION(splitter.createComplexData(4));
+
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        const std::auto_ptr<six::sicd::ComplexData> output =
+                splitter.createComplexData(ii);
+        const six::sicd::DirectionParameters& col = *output->grid->col;
+        const double start = 0.2 * ii;
+        TEST_ASSERT_ALMOST_EQ_EPS(col.impulseResponseBandwidth, 0.4, 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(col.deltaKCOAPoly(0.0, 0.0),
+                                  start + 0.2 - 0.5, 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(col.deltaK1, start - 0.5, 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(col.deltaK2, start - 0.1, 1e-12);
+        TEST_ASSERT_EQ(col.weightType->windowName, "UNKNOWN");
+        TEST_ASSERT_EQ(col.weights.size(), 512);
+        TEST_ASSERT(col.impulseResponseWidth >
+                    2.0 * data->grid->col->impulseResponseWidth);
+
+        // Row doesn't change
+        TEST_ASSERT(*output->grid->row == *data->grid->row);
+
+        // With no PFA, time is linear in Kaz
+        const double tStart = 2.0 * start;
+        const double midTime = tStart + 0.4;
+        TEST_ASSERT_ALMOST_EQ_EPS(output->imageFormation->tStartProc,
+                                  tStart, 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(output->imageFormation->tEndProc,
+                                  tStart + 0.8, 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(output->grid->timeCOAPoly(0.0, 0.0),
+                                  midTime, 1e-12);
+        TEST_ASSERT_ALMOST_EQ_EPS(output->scpcoa->scpTime, midTime, 1e-12);
+        const six::Vector3 arpPos = output->position->arpPoly(midTime);
+        TEST_ASSERT_ALMOST_EQ_EPS((output->scpcoa->arpPos - arpPos).norm(),
+                                  0.0, 1e-6);
+        TEST_ASSERT_EQ(output->scpcoa->sideOfTrack,
+                       six::SideOfTrackType::LEFT);
+        TEST_ASSERT(output->scpcoa->grazeAngle > 0.0);
+
+        const std::vector<six::sicd::TimelineSet>& sets =
+                output->timeline->interPulsePeriod->sets;
+        TEST_ASSERT_EQ(sets.size(), 1);
+        TEST_ASSERT_ALMOST_EQ_EPS(sets[0].tStart, tStart, 1e-12);
+        TEST_ASSERT_EQ(sets[0].interPulsePeriodStart,
+                       static_cast<int>(std::ceil(tStart * 1000 - 1e-6)));
+        TEST_ASSERT_EQ(sets[0].interPulsePeriodEnd,
+                       static_cast<int>(std::floor((tStart + 0.8) * 1000 +
+                                                   1e-6)));
+    }
+
+    // The last window's weighting is the far 0.4 of the Hamming window
+    const std::auto_ptr<six::sicd::ComplexData> last =
+            splitter.createComplexData(3);
+    const double pi = 3.14159265358979;
+    TEST_ASSERT_ALMOST_EQ_EPS(last->grid->col->weights.front(),
+                              0.54 + 0.46 * std::cos(0.2 * pi), 1e-4);
+    TEST_ASSERT_ALMOST_EQ_EPS(last->grid->col->weights.back(), 0.08, 1e-4);
+}
+
+TEST_CASE(testPolarAngleTimes)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+    data->grid->row->kCenter = 5.0;
+    data->pfa.reset(new six::sicd::PFA());
+    data->pfa->polarAnglePoly = six::Poly1D(1);
+    data->pfa->polarAnglePoly[0] = -0.1;
+    data->pfa->polarAnglePoly[1] = 0.1;
+
+    // Kaz of [-0.5, 0] is polar angle [atan(-0.1), 0]
+    const six::sicd::SpectralSplitter splitter(
+            *data, six::sicd::SpectralSplitter::SUB_APERTURE, 2, 0.0, 1);
+    const std::auto_ptr<six::sicd::ComplexData> first =
+            splitter.createComplexData(0);
+    TEST_ASSERT_ALMOST_EQ_EPS(first->imageFormation->tStartProc,
+                              1.0 + std::atan(-0.1) / 0.1, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(first->imageFormation->tEndProc, 1.0, 1e-9);
+    TEST_ASSERT_ALMOST_EQ_EPS(first->scpcoa->scpTime,
+                              1.0 + std::atan(-0.05) / 0.1, 1e-9);
+}
+
+TEST_CASE(testSubbandMetadata)
+{
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+    const six::sicd::SpectralSplitter splitter(
+            *data, six::sicd::SpectralSplitter::SUB_BAND, 2, 0.0, 1);
+    const std::auto_ptr<six::sicd::ComplexData> second =
+            splitter.createComplexData(1);
+    TEST_ASSERT_ALMOST_EQ_EPS(second->grid->row->impulseResponseBandwidth,
+                              0.8, 1e-12);
+    TEST_ASSERT_ALMOST_EQ_EPS(second->grid->row->deltaKCOAPoly(0.0, 0.0),
+                              0.4, 1e-12);
+    TEST_ASSERT(second->grid->row->weights.empty());
+    TEST_ASSERT_ALMOST_EQ_EPS(second->grid->row->impulseResponseWidth,
+                              0.886 / 0.8, 0.005);
+    TEST_ASSERT_ALMOST_EQ_EPS(second->imageFormation->txFrequencyProcMin,
+                              9.5e9, 1.0);
+    TEST_ASSERT_ALMOST_EQ_EPS(second->imageFormation->txFrequencyProcMax,
+                              10.0e9, 1.0);
+    TEST_ASSERT(*second->grid->col == *data->grid->col);
+    TEST_ASSERT(*second->scpcoa == *data->scpcoa);
+}
+
+TEST_CASE(testStreaming)
+{
+    const six::PixelType pixelTypes[] = {
+        six::PixelType::RE32F_IM32F, six::PixelType::RE16I_IM16I
+    };
+    const six::sicd::SpectralSplitter::Split splits[] = {
+        six::sicd::SpectralSplitter::SUB_APERTURE,
+        six::sicd::SpectralSplitter::SUB_BAND
+    };
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        const six::PixelType pixelType = pixelTypes[ii / 2];
+        const six::sicd::SpectralSplitter::Split split = splits[ii % 2];
+        const std::auto_ptr<six::sicd::ComplexData> data =
+                createData(pixelType);
+        const Image image = createImage(*data);
+        {
+            six::sicd::SICDWriteControl writer(INPUT_PATHNAME,
+                                               std::vector<std::string>());
+            writer.initialize(*data);
+            if (pixelType == six::PixelType::RE32F_IM32F)
+            {
+                Image buffer(image);
+                writer.save(&buffer[0], types::RowCol<size_t>(0, 0),
+                            types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+            }
+            else
+            {
+                std::vector<std::complex<short> > buffer(NUM_ROWS * NUM_COLS);
+                for (size_t jj = 0; jj < buffer.size(); ++jj)
+                {
+                    buffer[jj] = std::complex<short>(
+                            static_cast<short>(image[jj].real()),
+                            static_cast<short>(image[jj].imag()));
+                }
+                writer.save(&buffer[0], types::RowCol<size_t>(0, 0),
+                            types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+            }
+            writer.close();
+        }
+
+        six::NITFReadControl reader;
+        reader.load(INPUT_PATHNAME);
+        const six::sicd::ComplexData& inData =
+                dynamic_cast<const six::sicd::ComplexData&>(
+                        *reader.getContainer()->getData(0));
+
+        six::sicd::SpectralSplitter splitter(inData, split, 3, 0.25, 2);
+        Image input(NUM_ROWS * NUM_COLS);
+        {
+            six::Region region;
+            region.setNumRows(NUM_ROWS);
+            region.setNumCols(NUM_COLS);
+            const mem::ScopedArray<six::UByte> buffer(
+                    reader.interleaved(region, 0));
+            for (size_t jj = 0; jj < input.size(); ++jj)
+            {
+                input[jj] = (pixelType == six::PixelType::RE32F_IM32F) ?
+                        reinterpret_cast<std::complex<float>*>(
+                                buffer.get())[jj] :
+                        std::complex<float>(
+                                reinterpret_cast<std::complex<short>*>(
+                                        buffer.get())[jj].real(),
+                                reinterpret_cast<std::complex<short>*>(
+                                        buffer.get())[jj].imag());
+            }
+        }
+        std::vector<Image> expected(3, Image(input.size()));
+        splitter.split(&input[0], getPointers(expected));
+
+        // Small enough for strips of 7 lines, with a spectrum for columns
+        const size_t size = (split == six::sicd::SpectralSplitter::SUB_BAND) ?
+                NUM_ROWS : NUM_COLS;
+        const size_t numBuffers =
+                (split == six::sicd::SpectralSplitter::SUB_BAND) ? 5 : 4;
+        splitter.setMaxMemory(numBuffers * size * 7 * 8 + 100);
+
+        std::vector<std::string> pathnames;
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            pathnames.push_back(OUTPUT_PATHNAME + str::toString(jj) +
+                                ".nitf");
+        }
+        splitter.split(reader, std::vector<std::string>(), pathnames);
+
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            six::NITFReadControl outReader;
+            outReader.load(pathnames[jj]);
+            const six::sicd::ComplexData& outData =
+                    dynamic_cast<const six::sicd::ComplexData&>(
+                            *outReader.getContainer()->getData(0));
+            TEST_ASSERT_EQ(outData.getPixelType(), pixelType);
+            const std::auto_ptr<six::sicd::ComplexData> expectedData =
+                    splitter.createComplexData(jj);
+            const six::sicd::DirectionParameters* const directions[] = {
+                outData.grid->row.get(), outData.grid->col.get()
+            };
+            const six::sicd::DirectionParameters* const expectedDirections[] =
+            {
+                expectedData->grid->row.get(), expectedData->grid->col.get()
+            };
+            for (size_t kk = 0; kk < 2; ++kk)
+            {
+                TEST_ASSERT_ALMOST_EQ_EPS(
+                        directions[kk]->impulseResponseBandwidth,
+                        expectedDirections[kk]->impulseResponseBandwidth,
+                        1e-9);
+                TEST_ASSERT_ALMOST_EQ_EPS(
+                        directions[kk]->deltaKCOAPoly(0.0, 0.0),
+                        expectedDirections[kk]->deltaKCOAPoly(0.0, 0.0),
+                        1e-9);
+            }
+
+            six::Region region;
+            region.setNumRows(NUM_ROWS);
+            region.setNumCols(NUM_COLS);
+            const mem::ScopedArray<six::UByte> buffer(
+                    outReader.interleaved(region, 0));
+            for (size_t kk = 0; kk < input.size(); ++kk)
+            {
+                if (pixelType == six::PixelType::RE32F_IM32F)
+                {
+                    const std::complex<float> actual =
+                            reinterpret_cast<std::complex<float>*>(
+                                    buffer.get())[kk];
+                    TEST_ASSERT_EQ(actual, expected[jj][kk]);
+                }
+                else
+                {
+                    const std::complex<short> actual =
+                            reinterpret_cast<std::complex<short>*>(
+                                    buffer.get())[kk];
+                    TEST_ASSERT(std::abs(actual.real() -
+                                         expected[jj][kk].real()) <= 0.5f);
+                    TEST_ASSERT(std::abs(actual.imag() -
+                                         expected[jj][kk].imag()) <= 0.5f);
+                }
+            }
+            sys::OS().remove(pathnames[jj]);
+        }
+    }
+
+    sys::OS().remove(INPUT_PATHNAME);
+}
+
+TEST_CASE(testThrows)
+{
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+    TEST_EXCEPTION(six::sicd::SpectralSplitter(
+            *data, six::sicd::SpectralSplitter::SUB_BAND, 0, 0.0, 1));
+    TEST_EXCEPTION(six::sicd::SpectralSplitter(
+            *data, six::sicd::SpectralSplitter::SUB_BAND, 2, 1.0, 1));
+
+    const six::sicd::SpectralSplitter splitter(
+            *data, six::sicd::SpectralSplitter::SUB_BAND, 2, 0.0, 1);
+    Image image(NUM_ROWS * NUM_COLS);
+    std::vector<Image> outputs(1, image);
+    TEST_EXCEPTION(splitter.split(&image[0], getPointers(outputs)));
+}
+}
+
+int main(int, char**)
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    TEST_CHECK(testPartition);
+    TEST_CHECK(testSubapertureMetadata);
+    TEST_CHECK(testPolarAngleTimes);
+    TEST_CHECK(testSubbandMetadata);
+    TEST_CHECK(testStreaming);
+    TEST_CHECK(testThrows);
+    return 0;
+}
@@ -0,0 +1,385 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <vector>
+
+#include <sys/OS.h>
+#include <scene/Utilities.h>
+#include <import/six.h>
+#include <import/six/sicd.h>
+#include <six/sicd/SICDWriteControl.h>
+#include "TestCase.h"
+
+namespace
+{
+static const std::string INPUT_PATHNAME("test_spectral_weighter_in.nitf");
+static const std::string OUTPUT_PATHNAME("test_spectral_weighter_out.nitf");
+static const size_t NUM_ROWS(60);
+static const size_t NUM_COLS(48);
+
+void setDirection(double sampleSpacing,
+                  double bandwidth,
+                  six::sicd::DirectionParameters& direction)
+{
+    direction.sign = six::FFTSign::NEG;
+    direction.unitVector = 0.0;
+    direction.sampleSpacing = sampleSpacing;
+    direction.impulseResponseBandwidth = bandwidth;
+    direction.impulseResponseWidth = 0.886 / bandwidth;
+    direction.kCenter = 0.0;
+    direction.deltaK1 = -0.5 / sampleSpacing;
+    direction.deltaK2 = 0.5 / sampleSpacing;
+    direction.weightType.reset(new six::sicd::WeightType());
+    direction.weightType->windowName = "UNIFORM";
+}
+
+six::sicd::WeightType makeWeightType(const std::string& windowName)
+{
+    six::sicd::WeightType weightType;
+    weightType.windowName = windowName;
+    return weightType;
+}
+
+// Enough metadata to write a SICD
+std::auto_ptr<six::sicd::ComplexData> createData(six::PixelType pixelType)
+{
+    std::auto_ptr<six::sicd::ComplexData> data(new six::sicd::ComplexData());
+    data->setPixelType(pixelType);
+    data->setNumRows(NUM_ROWS);
+    data->setNumCols(NUM_COLS);
+    data->setName("corename");
+    data->setSource("sensorname");
+    data->collectionInformation->classification.level = "UNCLASSIFIED";
+    data->collectionInformation->radarMode = six::RadarModeType::SPOTLIGHT;
+    data->setCreationTime(six::DateTime());
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.3, -83.8);
+    corners.upperRight = six::LatLon(42.3, -83.7);
+    corners.lowerRight = six::LatLon(42.2, -83.7);
+    corners.lowerLeft = six::LatLon(42.2, -83.8);
+    data->setImageCorners(corners);
+    data->scpcoa->sideOfTrack = six::SideOfTrackType::LEFT;
+    data->geoData->scp.llh = six::LatLonAlt(42.2708, -83.7264);
+    data->geoData->scp.ecf =
+            scene::Utilities::latLonToECEF(data->geoData->scp.llh);
+    data->grid->timeCOAPoly = six::Poly2D(0, 0);
+    data->grid->timeCOAPoly[0][0] = 1.0;
+    data->position->arpPoly = six::PolyXYZ(0);
+    data->position->arpPoly[0] = 0.0;
+
+    data->radarCollection->txFrequencyMin = 0.0;
+    data->radarCollection->txFrequencyMax = 0.0;
+    data->radarCollection->txPolarization = six::PolarizationType::OTHER;
+    mem::ScopedCloneablePtr<six::sicd::ChannelParameters>
+            rcvChannel(new six::sicd::ChannelParameters());
+    rcvChannel->txRcvPolarization = six::DualPolarizationType::OTHER;
+    data->radarCollection->rcvChannels.push_back(rcvChannel);
+
+    // Both directions are oversampled by 1.25
+    setDirection(0.5, 1.6, *data->grid->row);
+    setDirection(0.8, 1.0, *data->grid->col);
+
+    data->imageFormation->rcvChannelProcessed->numChannelsProcessed = 1;
+    data->imageFormation->rcvChannelProcessed->channelIndex.push_back(0);
+    data->imageFormation->txRcvPolarizationProc =
+            six::DualPolarizationType::OTHER;
+    data->imageFormation->tStartProc = 0;
+    data->imageFormation->tEndProc = 0;
+    data->imageFormation->txFrequencyProcMin = 0;
+    data->imageFormation->txFrequencyProcMax = 0;
+    data->timeline->collectStart = six::DateTime();
+    data->timeline->collectDuration = 1.0;
+
+    data->scpcoa->scpTime = 1.0;
+    data->scpcoa->slantRange = 0.0;
+    data->scpcoa->groundRange = 0.0;
+    data->scpcoa->dopplerConeAngle = 0.0;
+    data->scpcoa->grazeAngle = 0.0;
+    data->scpcoa->incidenceAngle = 0.0;
+    data->scpcoa->twistAngle = 0.0;
+    data->scpcoa->slopeAngle = 0.0;
+    data->scpcoa->azimAngle = 0.0;
+    data->scpcoa->layoverAngle = 0.0;
+    data->scpcoa->arpPos = 0.0;
+    data->scpcoa->arpVel = 0.0;
+    data->scpcoa->arpAcc = 0.0;
+    return data;
+}
+
+std::vector<std::complex<float> > createImage()
+{
+    std::srand(42);
+    std::vector<std::complex<float> > image(NUM_ROWS * NUM_COLS);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = std::complex<float>(
+                static_cast<float>(std::rand() % 2001) - 1000.0f,
+                static_cast<float>(std::rand() % 2001) - 1000.0f);
+    }
+    return image;
+}
+
+double getMaxDifference(const std::vector<std::complex<float> >& lhs,
+                        const std::vector<std::complex<float> >& rhs)
+{
+    double maxDifference(0.0);
+    for (size_t ii = 0; ii < lhs.size(); ++ii)
+    {
+        maxDifference = std::max<double>(maxDifference,
+                                         std::abs(lhs[ii] - rhs[ii]));
+    }
+    return maxDifference;
+}
+
+TEST_CASE(testRaisedCos)
+{
+    const size_t sizes[] = {5, 512};
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        const std::vector<double> weights = six::sicd::RaisedCos(0.54)(
+                sizes[ii]);
+        TEST_ASSERT_EQ(weights.size(), sizes[ii]);
+        for (size_t jj = 0; jj < weights.size(); ++jj)
+        {
+            TEST_ASSERT_ALMOST_EQ_EPS(weights[jj],
+                                      weights[weights.size() - 1 - jj],
+                                      1e-12);
+        }
+        TEST_ASSERT_ALMOST_EQ_EPS(weights.back(), 0.08, 1e-12);
+    }
+}
+
+TEST_CASE(testTaylor)
+{
+    const std::vector<double> weights = six::sicd::Taylor(4, 30.0)(65);
+    TEST_ASSERT_EQ(weights.size(), 65);
+    TEST_ASSERT_ALMOST_EQ_EPS(weights[32], 1.0, 1e-12);
+    for (size_t ii = 0; ii < 32; ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(weights[ii], weights[64 - ii], 1e-12);
+        TEST_ASSERT(weights[ii] <= weights[ii + 1]);
+    }
+    TEST_ASSERT(weights[0] > 0.0 && weights[0] < 0.5);
+
+    // It's described by NBAR and SLL
+    six::sicd::DirectionParameters direction;
+    direction.weightType.reset(new six::sicd::WeightType(
+            makeWeightType("TAYLOR")));
+    TEST_ASSERT(direction.calculateWeightFunction().get() == NULL);
+    direction.weightType->parameters.push_back(six::Parameter());
+    direction.weightType->parameters[0].setName("NBAR");
+    direction.weightType->parameters[0].setValue(4);
+    direction.weightType->parameters.push_back(six::Parameter());
+    direction.weightType->parameters[1].setName("SLL");
+    direction.weightType->parameters[1].setValue(-30);
+    const std::vector<double> described =
+            (*direction.calculateWeightFunction())(65);
+    for (size_t ii = 0; ii < weights.size(); ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(described[ii], weights[ii], 1e-12);
+    }
+}
+
+TEST_CASE(testImpulseResponseWidth)
+{
+    const double uniform = six::sicd::SpectralWeighter::
+            computeImpulseResponseWidth(std::vector<double>(), 2.0);
+    TEST_ASSERT_ALMOST_EQ_EPS(uniform, 0.886 / 2.0, 0.005);
+
+    // Hamming widens the mainlobe by about half
+    const double hamming = six::sicd::SpectralWeighter::
+            computeImpulseResponseWidth(six::sicd::RaisedCos(0.54)(512),
+                                        2.0);
+    TEST_ASSERT(hamming / uniform > 1.4 && hamming / uniform < 1.55);
+}
+
+TEST_CASE(testRoundTrip)
+{
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+
+    // Changing uniform to uniform just band limits the image
+    std::vector<std::complex<float> > limited = createImage();
+    six::sicd::SpectralWeighter limiter(*data, 1);
+    limiter.deweight();
+    limiter.apply(&limited[0]);
+
+    std::vector<std::complex<float> > weighted(limited);
+    six::sicd::SpectralWeighter weighter(*data, 3);
+    weighter.setRowWeighting(makeWeightType("HAMMING"));
+    weighter.setColWeighting(makeWeightType("HANNING"));
+    weighter.apply(&weighted[0]);
+    TEST_ASSERT(getMaxDifference(weighted, limited) > 100.0);
+
+    const std::auto_ptr<six::sicd::ComplexData> weightedData =
+            weighter.createComplexData();
+    const six::sicd::DirectionParameters& row = *weightedData->grid->row;
+    TEST_ASSERT_EQ(row.weightType->windowName, "HAMMING");
+    TEST_ASSERT_EQ(row.weights.size(), 512);
+    TEST_ASSERT(row.impulseResponseWidth >
+                1.4 * data->grid->row->impulseResponseWidth);
+    TEST_ASSERT_EQ(weightedData->grid->col->weightType->windowName,
+                   "HANNING");
+
+    // Deweighting undoes it.  Hanning goes to 0 at the edges, so only undo
+    // Hamming.
+    six::sicd::SpectralWeighter hammingOnly(*data, 1);
+    hammingOnly.setRowWeighting(makeWeightType("HAMMING"));
+    std::vector<std::complex<float> > expected(limited);
+    hammingOnly.apply(&expected[0]);
+    const std::auto_ptr<six::sicd::ComplexData> hammingData =
+            hammingOnly.createComplexData();
+    six::sicd::SpectralWeighter undo(*hammingData, 1);
+    undo.setRowWeighting(makeWeightType("UNIFORM"));
+    undo.apply(&expected[0]);
+    TEST_ASSERT(getMaxDifference(expected, limited) < 0.05);
+
+    const std::auto_ptr<six::sicd::ComplexData> deweightedData =
+            undo.createComplexData();
+    TEST_ASSERT(deweightedData->grid->row->weights.empty());
+    TEST_ASSERT_ALMOST_EQ_EPS(deweightedData->grid->row->impulseResponseWidth,
+                              data->grid->row->impulseResponseWidth, 0.005);
+}
+
+TEST_CASE(testStreaming)
+{
+    const six::PixelType pixelTypes[] = {
+        six::PixelType::RE32F_IM32F, six::PixelType::RE16I_IM16I
+    };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        const std::auto_ptr<six::sicd::ComplexData> data =
+                createData(pixelTypes[ii]);
+        const std::vector<std::complex<float> > image = createImage();
+        {
+            six::sicd::SICDWriteControl writer(INPUT_PATHNAME,
+                                               std::vector<std::string>());
+            writer.initialize(*data);
+            if (ii == 0)
+            {
+                std::vector<std::complex<float> > buffer(image);
+                writer.save(&buffer[0], types::RowCol<size_t>(0, 0),
+                            types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+            }
+            else
+            {
+                std::vector<std::complex<short> > buffer(NUM_ROWS * NUM_COLS);
+                for (size_t jj = 0; jj < buffer.size(); ++jj)
+                {
+                    buffer[jj] = std::complex<short>(
+                            static_cast<short>(image[jj].real()),
+                            static_cast<short>(image[jj].imag()));
+                }
+                writer.save(&buffer[0], types::RowCol<size_t>(0, 0),
+                            types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+            }
+            writer.close();
+        }
+
+        std::vector<std::complex<float> > expected(image);
+        six::sicd::SpectralWeighter weighter(*data, 2);
+        weighter.setRowWeighting(makeWeightType("HAMMING"));
+        weighter.setColWeighting(makeWeightType("HANNING"));
+        weighter.apply(&expected[0]);
+
+        // Small enough for strips of 7 rows, then 5 columns
+        six::NITFReadControl reader;
+        reader.load(INPUT_PATHNAME);
+        weighter.setMaxMemory(NUM_COLS * 7 * 8 + 100);
+        TEST_ASSERT_EQ(weighter.getMaxMemory() / (NUM_ROWS * 8), 5);
+        weighter.apply(reader, std::vector<std::string>(), OUTPUT_PATHNAME);
+
+        six::NITFReadControl outReader;
+        outReader.load(OUTPUT_PATHNAME);
+        const six::sicd::ComplexData& outData =
+                dynamic_cast<const six::sicd::ComplexData&>(
+                        *outReader.getContainer()->getData(0));
+        TEST_ASSERT_EQ(outData.getPixelType(), pixelTypes[ii]);
+        TEST_ASSERT_EQ(outData.grid->row->weightType->windowName,
+                       "HAMMING");
+        TEST_ASSERT_EQ(outData.grid->col->weights.size(), 512);
+
+        six::Region region;
+        region.setNumRows(NUM_ROWS);
+        region.setNumCols(NUM_COLS);
+        const mem::ScopedArray<six::UByte> buffer(
+                outReader.interleaved(region, 0));
+        for (size_t jj = 0; jj < expected.size(); ++jj)
+        {
+            if (ii == 0)
+            {
+                const std::complex<float> actual =
+                        reinterpret_cast<std::complex<float>*>(
+                                buffer.get())[jj];
+                TEST_ASSERT_EQ(actual, expected[jj]);
+            }
+            else
+            {
+                const std::complex<short> actual =
+                        reinterpret_cast<std::complex<short>*>(
+                                buffer.get())[jj];
+                TEST_ASSERT(std::abs(actual.real() -
+                                     expected[jj].real()) <= 0.5f);
+                TEST_ASSERT(std::abs(actual.imag() -
+                                     expected[jj].imag()) <= 0.5f);
+            }
+        }
+    }
+
+    sys::OS().remove(INPUT_PATHNAME);
+    sys::OS().remove(OUTPUT_PATHNAME);
+}
+
+TEST_CASE(testThrows)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+    std::vector<std::complex<float> > image = createImage();
+
+    six::sicd::SpectralWeighter unsupported(*data, 1);
+    unsupported.setRowWeighting(makeWeightType("SOMETHING"));
+    TEST_EXCEPTION(unsupported.apply(&image[0]));
+
+    data->grid->col->weightType->windowName = "UNKNOWN";
+    six::sicd::SpectralWeighter unknown(*data, 1);
+    unknown.deweight();
+    TEST_EXCEPTION(unknown.apply(&image[0]));
+}
+}
+
+int main(int, char**)
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    TEST_CHECK(testRaisedCos);
+    TEST_CHECK(testTaylor);
+    TEST_CHECK(testImpulseResponseWidth);
+    TEST_CHECK(testRoundTrip);
+    TEST_CHECK(testStreaming);
+    TEST_CHECK(testThrows);
+    return 0;
+}
@@ -48,6 +48,12 @@ protected:
      *  Returns a new allocated DOM document, created from the DerivedData*
      */
     virtual xml::lite::Document* toXMLImpl(const Data* data);
+
+    /*!
+     *  Writes the DerivedData* out as XML without building a DOM.  The
+     *  output is the same as printing the DOM from the other toXMLImpl().
+     */
+    virtual void toXMLImpl(const Data* data, io::OutputStream& xmlStream);
     /*!
      *  Returns a new allocated DerivedData*, created from the DOM Document*
      *
@@ -0,0 +1,105 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_DERIVED_XML_WRITER_H__
+#define __SIX_DERIVED_XML_WRITER_H__
+
+#include <string>
+
+#include <six/XMLStreamWriter.h>
+#include <six/SICommonXMLWriter01x.h>
+#include <six/sidd/DerivedData.h>
+
+namespace six
+{
+namespace sidd
+{
+/*!
+ *  \class DerivedXMLWriter
+ *  \brief Streams SIDD XML without building a DOM
+ *
+ *  Produces the same bytes as DerivedXMLParser::toXML() followed by
+ *  xml::lite::Element::print(), and throws for the same problems in the
+ *  data.
+ */
+class DerivedXMLWriter
+{
+public:
+    /*!
+     *  \param version  SIDD version to write (e.g. "1.0.0")
+     *  \param writer   Where the XML goes
+     */
+    DerivedXMLWriter(const std::string& version, six::XMLStreamWriter& writer);
+
+    //! Writes the whole SIDD XML for data.  Doesn't flush the writer.
+    void write(const DerivedData& data);
+
+private:
+    void writeProductCreation(const ProductCreation& productCreation);
+    void writeProcessorInformation(
+            const ProcessorInformation& processorInformation);
+    void writeClassification(const DerivedClassification& classification);
+    void writeDisplay(const Display& display);
+    void writeLUT(const std::string& name, const LUT& lut);
+    void writeGeographicAndTarget(
+            const GeographicAndTarget& geographicAndTarget);
+    void writeGeographicCoverage(const std::string& name,
+                                 const GeographicCoverage& geoCoverage);
+    void writeFootprint(const std::string& name,
+                        const std::string& cornerName,
+                        const LatLonCorners& corners);
+    void writeMeasurement(const Measurement& measurement);
+    void writeExploitationFeatures(
+            const ExploitationFeatures& exploitationFeatures);
+    void writeCollection(const Collection& collection);
+    void writeProductProcessing(const ProductProcessing& productProcessing);
+    void writeProcessingModule(const ProcessingModule& procMod);
+    void writeDownstreamReprocessing(
+            const DownstreamReprocessing& downstreamReproc);
+    void writeAnnotation(const Annotation& annotation);
+    void writeSFADatum(const std::string& name, const SFADatum& datum);
+    void writeSFAPrimeMeridian(const SFAPrimeMeridian& primeMeridian);
+    void writeGeographicCoordinateSystem(
+            const SFAGeographicCoordinateSystem& coordSys);
+    void writeSFAGeometry(const SFAGeometry& geometry);
+    void writeSFAPoint(const std::string& name, const SFAPoint& point);
+    void writeSFALine(const std::string& name, const SFALineString& line);
+    void writeSFAPolygonRings(const SFAPolygon& polygon);
+
+    // Writes an ism attribute if the value is non-empty
+    void writeAttributeIfNonEmpty(const std::string& name,
+                                  const std::string& value);
+
+    // Writes an ism attribute holding the trimmed, non-empty values
+    // separated by spaces.  Nothing's written for an empty list unless
+    // setIfEmpty is true.
+    void writeAttributeList(const std::string& name,
+                            const std::vector<std::string>& values,
+                            bool setIfEmpty = false);
+
+    const std::string mVersion;
+    six::XMLStreamWriter& mWriter;
+    six::SICommonXMLWriter01x mCommon;
+};
+}
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include <six/sidd/DerivedXMLControl.h>
 #include <six/sidd/DerivedData.h>
 #include <six/sidd/DerivedXMLParser.h>
+#include <six/sidd/DerivedXMLWriter.h>
 
 namespace six
 {
@@ -49,6 +50,20 @@ xml::lite::Document* DerivedXMLControl::toXMLImpl(const Data* data)
     DerivedXMLParser parser(data->getVersion(), mLog, false);
     return parser.toXML(reinterpret_cast<const DerivedData*>(data));
 }
+
+void DerivedXMLControl::toXMLImpl(const Data* data,
+                                  io::OutputStream& xmlStream)
+{
+    if (data->getDataType() != DataType::DERIVED)
+    {
+        throw except::Exception(Ctxt("Data must be SIDD"));
+    }
+
+    six::XMLStreamWriter writer(xmlStream);
+    DerivedXMLWriter(data->getVersion(), writer).write(
+            *reinterpret_cast<const DerivedData*>(data));
+    writer.flush();
+}
 }
 }
 
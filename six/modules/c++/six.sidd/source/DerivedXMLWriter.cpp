@@ -0,0 +1,1104 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sstream>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <str/Format.h>
+#include <str/Manip.h>
+#include <six/Utilities.h>
+#include <six/sidd/DerivedXMLWriter.h>
+
+namespace
+{
+const std::string NO_PREFIX;
+const std::string SI_PREFIX("si:");
+const std::string SFA_PREFIX("sfa:");
+const std::string ISM_PREFIX("ism:");
+}
+
+namespace six
+{
+namespace sidd
+{
+DerivedXMLWriter::DerivedXMLWriter(const std::string& version,
+                                   six::XMLStreamWriter& writer) :
+    mVersion(version),
+    mWriter(writer),
+    mCommon(writer, false, SI_PREFIX)
+{
+}
+
+void DerivedXMLWriter::write(const DerivedData& data)
+{
+    // Namespace declarations go in the order DerivedXMLParser sets them
+    mWriter.startElement("SIDD");
+    mWriter.attribute("xmlns", "urn:SIDD:" + mVersion);
+    mWriter.attribute("xmlns:si", "urn:SICommon:0.1");
+    mWriter.attribute("xmlns:sfa", "urn:SFA:1.2.0");
+    mWriter.attribute("xmlns:ism", "urn:us:gov:ic:ism");
+
+    writeProductCreation(*data.productCreation);
+    writeDisplay(*data.display);
+    writeGeographicAndTarget(*data.geographicAndTarget);
+    writeMeasurement(*data.measurement);
+    writeExploitationFeatures(*data.exploitationFeatures);
+
+    // optional
+    if (data.productProcessing.get())
+    {
+        writeProductProcessing(*data.productProcessing);
+    }
+    // optional
+    if (data.downstreamReprocessing.get())
+    {
+        writeDownstreamReprocessing(*data.downstreamReprocessing);
+    }
+    // optional
+    if (data.errorStatistics.get())
+    {
+        mCommon.writeErrorStatistics(*data.errorStatistics);
+    }
+    // optional
+    if (data.radiometric.get())
+    {
+        mCommon.writeRadiometry(*data.radiometric);
+    }
+    // optional
+    if (!data.annotations.empty())
+    {
+        mWriter.startElement("Annotations");
+        for (size_t ii = 0; ii < data.annotations.size(); ++ii)
+        {
+            writeAnnotation(*data.annotations[ii]);
+        }
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeAttributeIfNonEmpty(const std::string& name,
+                                                const std::string& value)
+{
+    if (!value.empty())
+    {
+        mWriter.attribute(name, value, ISM_PREFIX);
+    }
+}
+
+void DerivedXMLWriter::writeAttributeList(
+        const std::string& name,
+        const std::vector<std::string>& values,
+        bool setIfEmpty)
+{
+    std::string value;
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        std::string thisValue(values[ii]);
+        str::trim(thisValue);
+        if (!thisValue.empty())
+        {
+            if (!value.empty())
+            {
+                value += " ";
+            }
+
+            value += thisValue;
+        }
+    }
+
+    if (!value.empty() || setIfEmpty)
+    {
+        mWriter.attribute(name, value, ISM_PREFIX);
+    }
+}
+
+void DerivedXMLWriter::writeProductCreation(
+        const ProductCreation& productCreation)
+{
+    mWriter.startElement("ProductCreation");
+
+    writeProcessorInformation(*productCreation.processorInformation);
+    writeClassification(productCreation.classification);
+
+    mCommon.writeString("ProductName", productCreation.productName);
+    mCommon.writeString("ProductClass", productCreation.productClass);
+
+    // optional
+    if (productCreation.productType != Init::undefined<std::string>())
+    {
+        mCommon.writeString("ProductType", productCreation.productType);
+    }
+
+    // optional to unbounded
+    mCommon.writeParameters("ProductCreationExtension",
+                            productCreation.productCreationExtensions);
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeProcessorInformation(
+        const ProcessorInformation& processorInformation)
+{
+    mWriter.startElement("ProcessorInformation");
+
+    mCommon.writeString("Application", processorInformation.application);
+    mCommon.writeDateTime("ProcessingDateTime",
+                          processorInformation.processingDateTime);
+    mCommon.writeString("Site", processorInformation.site);
+
+    // optional
+    if (processorInformation.profile != Init::undefined<std::string>())
+    {
+        mCommon.writeString("Profile", processorInformation.profile);
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeClassification(
+        const DerivedClassification& classification)
+{
+    mWriter.startElement("Classification");
+
+    // Attributes have to precede the SecurityExtension children here, which
+    // is also where the DOM prints them
+    //! from ism:ISMRootNodeAttributeGroup
+    mWriter.attribute("DESVersion", six::toString(classification.desVersion),
+                      ISM_PREFIX);
+
+    //! from ism:ResourceNodeAttributeGroup
+    mWriter.attribute("resourceElement", "true", ISM_PREFIX);
+    mWriter.attribute("createDate",
+                      classification.createDate.format("%Y-%m-%d"),
+                      ISM_PREFIX);
+    // optional
+    writeAttributeList("compliesWith", classification.compliesWith);
+
+    //! from ism:SecurityAttributesGroup
+    //  -- referenced in ism::ResourceNodeAttributeGroup
+    mWriter.attribute("classification", classification.classification,
+                      ISM_PREFIX);
+    writeAttributeList("ownerProducer", classification.ownerProducer, true);
+    // optional
+    writeAttributeList("SCIcontrols", classification.sciControls);
+    writeAttributeList("SARIdentifier", classification.sarIdentifier);
+    writeAttributeList("disseminationControls",
+                       classification.disseminationControls);
+    writeAttributeList("FGIsourceOpen", classification.fgiSourceOpen);
+    writeAttributeList("FGIsourceProtected",
+                       classification.fgiSourceProtected);
+    writeAttributeList("releasableTo", classification.releasableTo);
+    writeAttributeList("nonICmarkings", classification.nonICMarkings);
+    writeAttributeIfNonEmpty("classifiedBy", classification.classifiedBy);
+    writeAttributeIfNonEmpty("compilationReason",
+                             classification.compilationReason);
+    writeAttributeIfNonEmpty("derivativelyClassifiedBy",
+                             classification.derivativelyClassifiedBy);
+    writeAttributeIfNonEmpty("classificationReason",
+                             classification.classificationReason);
+    writeAttributeList("nonUSControls", classification.nonUSControls);
+    writeAttributeIfNonEmpty("derivedFrom", classification.derivedFrom);
+    if (classification.declassDate.get())
+    {
+        writeAttributeIfNonEmpty(
+                "declassDate",
+                classification.declassDate->format("%Y-%m-%d"));
+    }
+    writeAttributeIfNonEmpty("declassEvent", classification.declassEvent);
+    writeAttributeIfNonEmpty("declassException",
+                             classification.declassException);
+    writeAttributeIfNonEmpty("typeOfExemptedSource",
+                             classification.exemptedSourceType);
+    if (classification.exemptedSourceDate.get())
+    {
+        writeAttributeIfNonEmpty(
+                "dateOfExemptedSource",
+                classification.exemptedSourceDate->format("%Y-%m-%d"));
+    }
+
+    mCommon.writeParameters("SecurityExtension",
+                            classification.securityExtensions);
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeDisplay(const Display& display)
+{
+    mWriter.startElement("Display");
+
+    mCommon.writeString("PixelType", six::toString(display.pixelType));
+
+    // optional
+    if (display.remapInformation.get())
+    {
+        mWriter.startElement("RemapInformation");
+
+        if (display.remapInformation->displayType == DisplayType::COLOR)
+        {
+            mWriter.startElement("ColorDisplayRemap");
+            if (display.remapInformation->remapLUT.get())
+            {
+                writeLUT("RemapLUT", *display.remapInformation->remapLUT);
+            }
+            mWriter.endElement();
+        }
+        else if (display.remapInformation->displayType == DisplayType::MONO)
+        {
+            mWriter.startElement("MonochromeDisplayRemap");
+            // As with the parser, trust the displayType
+            const MonochromeDisplayRemap& mdr =
+                    static_cast<const MonochromeDisplayRemap&>(
+                            *display.remapInformation);
+            mCommon.writeString("RemapType", mdr.remapType);
+            if (mdr.remapLUT.get())
+            {
+                writeLUT("RemapLUT", *mdr.remapLUT);
+            }
+            mCommon.writeParameters("RemapParameter", mdr.remapParameters);
+            mWriter.endElement();
+        }
+
+        mWriter.endElement();
+    }
+
+    // optional
+    if (display.magnificationMethod != MagnificationMethod::NOT_SET)
+    {
+        mCommon.writeString("MagnificationMethod",
+                            six::toString(display.magnificationMethod));
+    }
+
+    // optional
+    if (display.decimationMethod != DecimationMethod::NOT_SET)
+    {
+        mCommon.writeString("DecimationMethod",
+                            six::toString(display.decimationMethod));
+    }
+
+    // optional
+    if (display.histogramOverrides.get())
+    {
+        mWriter.startElement("DRAHistogramOverrides");
+        mCommon.writeInt("ClipMin", display.histogramOverrides->clipMin);
+        mCommon.writeInt("ClipMax", display.histogramOverrides->clipMax);
+        mWriter.endElement();
+    }
+
+    // optional
+    if (display.monitorCompensationApplied.get())
+    {
+        mWriter.startElement("MonitorCompensationApplied");
+        mCommon.writeDouble("Gamma", display.monitorCompensationApplied->gamma);
+        mCommon.writeDouble("XMin", display.monitorCompensationApplied->xMin);
+        mWriter.endElement();
+    }
+
+    // optional to unbounded
+    mCommon.writeParameters("DisplayExtension", display.displayExtensions);
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeLUT(const std::string& name, const LUT& lut)
+{
+    if (lut.elementSize != 2 && lut.elementSize != 3)
+    {
+        throw except::Exception(Ctxt(FmtX("Invalid element size [%d]",
+                                          lut.elementSize)));
+    }
+
+    mWriter.startElement(name);
+    mWriter.attribute("size", lut.numEntries);
+
+    std::ostringstream oss;
+    for (size_t ii = 0; ii < lut.numEntries; ++ii)
+    {
+        if (lut.elementSize == 2)
+        {
+            oss << *reinterpret_cast<const short*>(lut[ii]);
+        }
+        else
+        {
+            oss << static_cast<unsigned int>(lut[ii][0]) << ','
+                << static_cast<unsigned int>(lut[ii][1]) << ','
+                << static_cast<unsigned int>(lut[ii][2]);
+        }
+        if (ii != lut.numEntries - 1)
+        {
+            oss << ' ';
+        }
+    }
+    mWriter.characters(oss.str());
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeGeographicAndTarget(
+        const GeographicAndTarget& geographicAndTarget)
+{
+    mWriter.startElement("GeographicAndTarget");
+
+    writeGeographicCoverage("GeographicCoverage",
+                            geographicAndTarget.geographicCoverage);
+
+    // optional to unbounded
+    for (size_t ii = 0; ii < geographicAndTarget.targetInformation.size();
+         ++ii)
+    {
+        const TargetInformation& ti =
+                *geographicAndTarget.targetInformation[ii];
+        mWriter.startElement("TargetInformation");
+
+        // 1 to unbounded
+        mCommon.writeParameters("Identifier", ti.identifiers);
+
+        // optional
+        if (ti.footprint.get())
+        {
+            writeFootprint("Footprint", "Vertex", *ti.footprint);
+        }
+
+        // optional to unbounded
+        mCommon.writeParameters("TargetInformationExtension",
+                                ti.targetInformationExtensions);
+
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeGeographicCoverage(
+        const std::string& name,
+        const GeographicCoverage& geoCoverage)
+{
+    mWriter.startElement(name);
+
+    // optional to unbounded
+    mCommon.writeParameters("GeoregionIdentifier",
+                            geoCoverage.georegionIdentifiers);
+    writeFootprint("Footprint", "Vertex", geoCoverage.footprint);
+
+    if (geoCoverage.geographicInformation.get())
+    {
+        const GeographicInformation& geoInfo =
+                *geoCoverage.geographicInformation;
+        mWriter.startElement("GeographicInfo");
+
+        // optional to unbounded
+        for (size_t ii = 0; ii < geoInfo.countryCodes.size(); ++ii)
+        {
+            mCommon.writeString("CountryCode", geoInfo.countryCodes[ii]);
+        }
+
+        // optional
+        std::string secInfo(geoInfo.securityInformation);
+        str::trim(secInfo);
+        if (!secInfo.empty())
+        {
+            mCommon.writeString("SecurityInfo", secInfo);
+        }
+
+        // optional to unbounded
+        mCommon.writeParameters("GeographicInfoExtension",
+                                geoInfo.geographicInformationExtensions);
+
+        mWriter.endElement();
+    }
+    else
+    {
+        for (size_t ii = 0; ii < geoCoverage.subRegion.size(); ++ii)
+        {
+            writeGeographicCoverage("SubRegion", *geoCoverage.subRegion[ii]);
+        }
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeFootprint(const std::string& name,
+                                      const std::string& cornerName,
+                                      const LatLonCorners& corners)
+{
+    mWriter.startElement(name);
+    mWriter.attribute("size", LatLonCorners::NUM_CORNERS);
+
+    // Corners go out in CW order with 1-based indices
+    for (size_t corner = 0; corner < LatLonCorners::NUM_CORNERS; ++corner)
+    {
+        mCommon.writeLatLon(cornerName, corners.getCorner(corner),
+                            str::toString(corner + 1));
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeMeasurement(const Measurement& measurement)
+{
+    const Projection& projection = *measurement.projection;
+
+    // The parser names the projection element once the ReferencePoint is
+    // in, but it has to be known up front here
+    std::string projectionName;
+    switch (projection.projectionType)
+    {
+    case ProjectionType::POLYNOMIAL:
+        projectionName = "PolynomialProjection";
+        break;
+    case ProjectionType::GEOGRAPHIC:
+        projectionName = "GeographicProjection";
+        break;
+    case ProjectionType::PLANE:
+        projectionName = "PlaneProjection";
+        break;
+    case ProjectionType::CYLINDRICAL:
+        projectionName = "CylindricalProjection";
+        break;
+    default:
+        throw except::Exception(Ctxt("Unknown projection type!"));
+    }
+
+    mWriter.startElement("Measurement");
+    mWriter.startElement(projectionName);
+
+    // ReferencePoint is present in all of the ProjectionTypes
+    mWriter.startElement("ReferencePoint");
+    if (projection.referencePoint.name != Init::undefined<std::string>())
+    {
+        mWriter.attribute("name", projection.referencePoint.name);
+    }
+    mCommon.writeVector3D("ECEF", SI_PREFIX, projection.referencePoint.ecef);
+    mCommon.writeRowCol("Point", SI_PREFIX, projection.referencePoint.rowCol);
+    mWriter.endElement();
+
+    switch (projection.projectionType)
+    {
+    case ProjectionType::POLYNOMIAL:
+    {
+        const PolynomialProjection& polyProj =
+                static_cast<const PolynomialProjection&>(projection);
+
+        mCommon.writePoly2D("RowColToLat", polyProj.rowColToLat);
+        mCommon.writePoly2D("RowColToLon", polyProj.rowColToLon);
+
+        // optional
+        if (polyProj.rowColToAlt != Init::undefined<Poly2D>())
+        {
+            mCommon.writePoly2D("RowColToAlt", polyProj.rowColToAlt);
+        }
+
+        mCommon.writePoly2D("LatLonToRow", polyProj.latLonToRow);
+        mCommon.writePoly2D("LatLonToCol", polyProj.latLonToCol);
+    }
+        break;
+
+    case ProjectionType::GEOGRAPHIC:
+    {
+        const GeographicProjection& geographicProj =
+                static_cast<const GeographicProjection&>(projection);
+
+        mCommon.writeRowCol("SampleSpacing", geographicProj.sampleSpacing);
+        mCommon.writePoly2D("TimeCOAPoly", geographicProj.timeCOAPoly);
+    }
+        break;
+
+    case ProjectionType::PLANE:
+    {
+        const PlaneProjection& planeProj =
+                static_cast<const PlaneProjection&>(projection);
+
+        mCommon.writeRowCol("SampleSpacing", planeProj.sampleSpacing);
+        mCommon.writePoly2D("TimeCOAPoly", planeProj.timeCOAPoly);
+
+        mWriter.startElement("ProductPlane");
+        mCommon.writeVector3D("RowUnitVector",
+                              planeProj.productPlane.rowUnitVector);
+        mCommon.writeVector3D("ColUnitVector",
+                              planeProj.productPlane.colUnitVector);
+        mWriter.endElement();
+    }
+        break;
+
+    default:
+    {
+        const CylindricalProjection& cylindricalProj =
+                static_cast<const CylindricalProjection&>(projection);
+
+        mCommon.writeRowCol("SampleSpacing", cylindricalProj.sampleSpacing);
+        mCommon.writePoly2D("TimeCOAPoly", cylindricalProj.timeCOAPoly);
+        mCommon.writeVector3D("StripmapDirection",
+                              cylindricalProj.stripmapDirection);
+        // optional
+        if (cylindricalProj.curvatureRadius != Init::undefined<double>())
+        {
+            mCommon.writeDouble("CurvatureRadius",
+                                cylindricalProj.curvatureRadius);
+        }
+    }
+        break;
+    }
+
+    mWriter.endElement();
+
+    mCommon.writeRowCol("PixelFootprint", measurement.pixelFootprint);
+    mCommon.writePolyXYZ("ARPPoly", measurement.arpPoly);
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeExploitationFeatures(
+        const ExploitationFeatures& exploitationFeatures)
+{
+    if (exploitationFeatures.collections.size() < 1)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "ExploitationFeatures must have at least [1] Collection, " \
+                "only [%d] found", exploitationFeatures.collections.size())));
+    }
+
+    mWriter.startElement("ExploitationFeatures");
+
+    // 1 to unbounded
+    for (size_t ii = 0; ii < exploitationFeatures.collections.size(); ++ii)
+    {
+        writeCollection(*exploitationFeatures.collections[ii]);
+    }
+
+    const Product& product = exploitationFeatures.product;
+    mWriter.startElement("Product");
+    mCommon.writeRowCol("Resolution", product.resolution);
+    // optional
+    if (product.north != Init::undefined<double>())
+    {
+        mCommon.writeDouble("North", product.north);
+    }
+    // optional to unbounded
+    mCommon.writeParameters("Extension", product.extensions);
+    mWriter.endElement();
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeCollection(const Collection& collection)
+{
+    mWriter.startElement("Collection");
+    mWriter.attribute("identifier", collection.identifier);
+
+    const Information& information = *collection.information;
+    mWriter.startElement("Information");
+
+    mCommon.writeString("SensorName", information.sensorName);
+    mWriter.startElement("RadarMode");
+    mCommon.writeString("ModeType", SI_PREFIX,
+                        six::toString(information.radarMode));
+    // optional
+    if (information.radarModeID != Init::undefined<std::string>())
+    {
+        mCommon.writeString("ModeID", SI_PREFIX, information.radarModeID);
+    }
+    mWriter.endElement();
+    mCommon.writeDateTime("CollectionDateTime",
+                          information.collectionDateTime);
+    // optional
+    if (information.localDateTime != Init::undefined<std::string>())
+    {
+        mCommon.writeDateTime("LocalDateTime", information.localDateTime);
+    }
+    mCommon.writeDouble("CollectionDuration",
+                        information.collectionDuration);
+    // optional
+    if (!Init::isUndefined(information.resolution))
+    {
+        mCommon.writeRangeAzimuth("Resolution", information.resolution);
+    }
+    // optional
+    if (information.inputROI.get())
+    {
+        mWriter.startElement("InputROI");
+        mCommon.writeRowCol("Size", information.inputROI->size);
+        mCommon.writeRowCol("UpperLeft", information.inputROI->upperLeft);
+        mWriter.endElement();
+    }
+    // optional to unbounded
+    for (size_t ii = 0; ii < information.polarization.size(); ++ii)
+    {
+        const TxRcvPolarization& pol = *information.polarization[ii];
+        mWriter.startElement("Polarization");
+
+        mCommon.writeString("TxPolarization",
+                            six::toString(pol.txPolarization));
+        mCommon.writeString("RcvPolarization",
+                            six::toString(pol.rcvPolarization));
+        // optional
+        if (!Init::isUndefined(pol.rcvPolarizationOffset))
+        {
+            mCommon.writeDouble("RcvPolarizationOffset",
+                                pol.rcvPolarizationOffset);
+        }
+        // optional
+        if (!Init::isUndefined(pol.processed))
+        {
+            mCommon.writeString("Processed", six::toString(pol.processed));
+        }
+
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+
+    // optional
+    const Geometry* geom = collection.geometry.get();
+    if (geom)
+    {
+        mWriter.startElement("Geometry");
+
+        // optional
+        if (geom->azimuth != Init::undefined<double>())
+        {
+            mCommon.writeDouble("Azimuth", geom->azimuth);
+        }
+        if (geom->slope != Init::undefined<double>())
+        {
+            mCommon.writeDouble("Slope", geom->slope);
+        }
+        if (geom->squint != Init::undefined<double>())
+        {
+            mCommon.writeDouble("Squint", geom->squint);
+        }
+        if (geom->graze != Init::undefined<double>())
+        {
+            mCommon.writeDouble("Graze", geom->graze);
+        }
+        if (geom->tilt != Init::undefined<double>())
+        {
+            mCommon.writeDouble("Tilt", geom->tilt);
+        }
+        // optional to unbounded
+        mCommon.writeParameters("Extension", geom->extensions);
+
+        mWriter.endElement();
+    }
+
+    // optional
+    const Phenomenology* phenom = collection.phenomenology.get();
+    if (phenom)
+    {
+        mWriter.startElement("Phenomenology");
+
+        // optional
+        if (phenom->shadow != Init::undefined<AngleMagnitude>())
+        {
+            mWriter.startElement("Shadow");
+            mCommon.writeDouble("Angle", SI_PREFIX, phenom->shadow.angle);
+            mCommon.writeDouble("Magnitude", SI_PREFIX,
+                                phenom->shadow.magnitude);
+            mWriter.endElement();
+        }
+        // optional
+        if (phenom->layover != Init::undefined<AngleMagnitude>())
+        {
+            mWriter.startElement("Layover");
+            mCommon.writeDouble("Angle", SI_PREFIX, phenom->layover.angle);
+            mCommon.writeDouble("Magnitude", SI_PREFIX,
+                                phenom->layover.magnitude);
+            mWriter.endElement();
+        }
+        // optional
+        if (phenom->multiPath != Init::undefined<double>())
+        {
+            mCommon.writeDouble("MultiPath", phenom->multiPath);
+        }
+        // optional
+        if (phenom->groundTrack != Init::undefined<double>())
+        {
+            mCommon.writeDouble("GroundTrack", phenom->groundTrack);
+        }
+        // optional to unbounded
+        mCommon.writeParameters("Extension", phenom->extensions);
+
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeProductProcessing(
+        const ProductProcessing& productProcessing)
+{
+    if (productProcessing.processingModules.size() < 1)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "There must be at least [1] ProcessingModule in "\
+                "ProductProcessing, [%d] found",
+                productProcessing.processingModules.size())));
+    }
+
+    mWriter.startElement("ProductProcessing");
+
+    // one to unbounded
+    for (size_t ii = 0; ii < productProcessing.processingModules.size();
+         ++ii)
+    {
+        writeProcessingModule(*productProcessing.processingModules[ii]);
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeProcessingModule(const ProcessingModule& procMod)
+{
+    mWriter.startElement("ProcessingModule");
+
+    mCommon.writeParameter("ModuleName", procMod.moduleName);
+
+    // optional choice
+    if (!procMod.processingModules.empty())
+    {
+        // one to unbounded
+        for (size_t ii = 0; ii < procMod.processingModules.size(); ++ii)
+        {
+            writeProcessingModule(*procMod.processingModules[ii]);
+        }
+    }
+    else if (!procMod.moduleParameters.empty())
+    {
+        mCommon.writeParameters("ModuleParameter", procMod.moduleParameters);
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeDownstreamReprocessing(
+        const DownstreamReprocessing& downstreamReproc)
+{
+    mWriter.startElement("DownstreamReprocessing");
+
+    // optional
+    const GeometricChip* geoChip = downstreamReproc.geometricChip.get();
+    if (geoChip)
+    {
+        mWriter.startElement("GeometricChip");
+        mCommon.writeRowCol("ChipSize", geoChip->chipSize);
+        mCommon.writeRowCol("OriginalUpperLeftCoordinate",
+                            geoChip->originalUpperLeftCoordinate);
+        mCommon.writeRowCol("OriginalUpperRightCoordinate",
+                            geoChip->originalUpperRightCoordinate);
+        mCommon.writeRowCol("OriginalLowerLeftCoordinate",
+                            geoChip->originalLowerLeftCoordinate);
+        mCommon.writeRowCol("OriginalLowerRightCoordinate",
+                            geoChip->originalLowerRightCoordinate);
+        mWriter.endElement();
+    }
+
+    // optional to unbounded
+    for (size_t ii = 0; ii < downstreamReproc.processingEvents.size(); ++ii)
+    {
+        const ProcessingEvent& procEvent =
+                *downstreamReproc.processingEvents[ii];
+        mWriter.startElement("ProcessingEvent");
+
+        mCommon.writeString("ApplicationName", procEvent.applicationName);
+        mCommon.writeDateTime("AppliedDateTime", procEvent.appliedDateTime);
+        // optional
+        if (!procEvent.interpolationMethod.empty())
+        {
+            mCommon.writeString("InterpolationMethod",
+                                procEvent.interpolationMethod);
+        }
+        // optional to unbounded
+        mCommon.writeParameters("Descriptor", procEvent.descriptor);
+
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeSFADatum(const std::string& name,
+                                     const SFADatum& datum)
+{
+    mWriter.startElement(name, SFA_PREFIX);
+    mWriter.startElement("Spheroid", SFA_PREFIX);
+    mCommon.writeString("SpheriodName", SFA_PREFIX, datum.spheroid.name);
+    mCommon.writeDouble("SemiMajorAxis", SFA_PREFIX,
+                        datum.spheroid.semiMajorAxis);
+    mCommon.writeDouble("InverseFlattening", SFA_PREFIX,
+                        datum.spheroid.inverseFlattening);
+    mWriter.endElement();
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeSFAPrimeMeridian(
+        const SFAPrimeMeridian& primeMeridian)
+{
+    mWriter.startElement("PrimeMeridian", SFA_PREFIX);
+    mCommon.writeString("Name", SFA_PREFIX, primeMeridian.name);
+    mCommon.writeDouble("Longitude", SFA_PREFIX, primeMeridian.longitude);
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeGeographicCoordinateSystem(
+        const SFAGeographicCoordinateSystem& coordSys)
+{
+    mWriter.startElement("GeographicCoordinateSystem", SFA_PREFIX);
+    mCommon.writeString("Csname", SFA_PREFIX, coordSys.csName);
+    writeSFADatum("Datum", coordSys.datum);
+    writeSFAPrimeMeridian(coordSys.primeMeridian);
+    mCommon.writeString("AngularUnit", SFA_PREFIX, coordSys.angularUnit);
+    mCommon.writeString("LinearUnit", SFA_PREFIX, coordSys.linearUnit);
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeAnnotation(const Annotation& annotation)
+{
+    mWriter.startElement("Annotation");
+
+    mCommon.writeString("Identifier", annotation.identifier);
+
+    // optional
+    if (annotation.spatialReferenceSystem.get())
+    {
+        const SFAReferenceSystem& refSys = *annotation.spatialReferenceSystem;
+        const SFACoordinateSystem& coordSys = *refSys.coordinateSystem;
+        const std::string type = coordSys.getType();
+
+        mWriter.startElement("SpatialReferenceSystem");
+
+        if (type == SFAProjectedCoordinateSystem::TYPE_NAME)
+        {
+            const SFAProjectedCoordinateSystem& projected =
+                    static_cast<const SFAProjectedCoordinateSystem&>(coordSys);
+
+            mWriter.startElement("ProjectedCoordinateSystem", SFA_PREFIX);
+            mCommon.writeString("Csname", SFA_PREFIX, projected.csName);
+            writeGeographicCoordinateSystem(
+                    *projected.geographicCoordinateSystem);
+
+            mWriter.startElement("Projection", SFA_PREFIX);
+            mCommon.writeString("ProjectionName", SFA_PREFIX,
+                                projected.projection.name);
+            mWriter.endElement();
+
+            // optional
+            if (!projected.parameter.name.empty())
+            {
+                mWriter.startElement("Parameter", SFA_PREFIX);
+                mCommon.writeString("ParameterName", SFA_PREFIX,
+                                    projected.parameter.name);
+                mCommon.writeDouble("Value", SFA_PREFIX,
+                                    projected.parameter.value);
+                mWriter.endElement();
+            }
+
+            mCommon.writeString("LinearUnit", SFA_PREFIX,
+                                projected.linearUnit);
+            mWriter.endElement();
+        }
+        else if (type == SFAGeographicCoordinateSystem::TYPE_NAME)
+        {
+            writeGeographicCoordinateSystem(
+                    static_cast<const SFAGeographicCoordinateSystem&>(
+                            coordSys));
+        }
+        else if (type == SFAGeocentricCoordinateSystem::TYPE_NAME)
+        {
+            const SFAGeocentricCoordinateSystem& geocentric =
+                    static_cast<const SFAGeocentricCoordinateSystem&>(
+                            coordSys);
+
+            mWriter.startElement("GeocentricCoordinateSystem", SFA_PREFIX);
+            mCommon.writeString("Csname", SFA_PREFIX, geocentric.csName);
+            writeSFADatum("Datum", geocentric.datum);
+            writeSFAPrimeMeridian(geocentric.primeMeridian);
+            mCommon.writeString("LinearUnit", SFA_PREFIX,
+                                geocentric.linearUnit);
+            mWriter.endElement();
+        }
+
+        // one to unbounded
+        for (size_t ii = 0; ii < refSys.axisNames.size(); ++ii)
+        {
+            mCommon.writeString("AxisName", SFA_PREFIX, refSys.axisNames[ii]);
+        }
+
+        mWriter.endElement();
+    }
+
+    // one to unbounded
+    for (size_t ii = 0; ii < annotation.objects.size(); ++ii)
+    {
+        mWriter.startElement("Object");
+        writeSFAGeometry(*annotation.objects[ii]);
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeSFAPoint(const std::string& name,
+                                     const SFAPoint& point)
+{
+    mWriter.startElement(name, name == "Vertex" ? SFA_PREFIX : NO_PREFIX);
+
+    mCommon.writeDouble("X", SFA_PREFIX, point.x);
+    mCommon.writeDouble("Y", SFA_PREFIX, point.y);
+    // optional
+    if (!Init::isUndefined(point.z))
+    {
+        mCommon.writeDouble("Z", SFA_PREFIX, point.z);
+    }
+    // optional
+    if (!Init::isUndefined(point.m))
+    {
+        mCommon.writeDouble("M", SFA_PREFIX, point.m);
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeSFALine(const std::string& name,
+                                    const SFALineString& line)
+{
+    if (line.vertices.size() < 2)
+    {
+        throw except::Exception(Ctxt(FmtX(
+                "Must be at least two Vertices in LineString. Only [%d] " \
+                "found", line.vertices.size())));
+    }
+
+    mWriter.startElement(name, name == "Ring" ? SFA_PREFIX : NO_PREFIX);
+
+    // two to unbounded
+    for (size_t ii = 0; ii < line.vertices.size(); ++ii)
+    {
+        writeSFAPoint("Vertex", *line.vertices[ii]);
+    }
+
+    mWriter.endElement();
+}
+
+void DerivedXMLWriter::writeSFAPolygonRings(const SFAPolygon& polygon)
+{
+    for (size_t ii = 0; ii < polygon.rings.size(); ++ii)
+    {
+        writeSFALine("Ring", *polygon.rings[ii]);
+    }
+}
+
+void DerivedXMLWriter::writeSFAGeometry(const SFAGeometry& geometry)
+{
+    const std::string geoType = geometry.getType();
+    if (geoType == SFAPoint::TYPE_NAME)
+    {
+        writeSFAPoint("Point", static_cast<const SFAPoint&>(geometry));
+    }
+    // Line, LinearRing, and LineString all derive from LineString
+    else if (geoType == SFALine::TYPE_NAME ||
+             geoType == SFALinearRing::TYPE_NAME ||
+             geoType == SFALineString::TYPE_NAME)
+    {
+        writeSFALine(geoType, static_cast<const SFALineString&>(geometry));
+    }
+    else if (geoType == SFAPolygon::TYPE_NAME)
+    {
+        mWriter.startElement("Polygon");
+        // one to unbounded
+        writeSFAPolygonRings(static_cast<const SFAPolygon&>(geometry));
+        mWriter.endElement();
+    }
+    else if (geoType == SFAPolyhedralSurface::TYPE_NAME)
+    {
+        const SFAPolyhedralSurface& surface =
+                static_cast<const SFAPolyhedralSurface&>(geometry);
+
+        mWriter.startElement("PolyhedralSurface");
+        for (size_t ii = 0; ii < surface.patches.size(); ++ii)
+        {
+            mWriter.startElement("Patch", SFA_PREFIX);
+            writeSFAPolygonRings(*surface.patches[ii]);
+            mWriter.endElement();
+        }
+        mWriter.endElement();
+    }
+    else if (geoType == SFAMultiPolygon::TYPE_NAME)
+    {
+        const SFAMultiPolygon& multiPolygon =
+                static_cast<const SFAMultiPolygon&>(geometry);
+
+        mWriter.startElement("MultiPolygon");
+        // optional to unbounded
+        for (size_t ii = 0; ii < multiPolygon.elements.size(); ++ii)
+        {
+            mWriter.startElement("Element", SFA_PREFIX);
+            writeSFAPolygonRings(*multiPolygon.elements[ii]);
+            mWriter.endElement();
+        }
+        mWriter.endElement();
+    }
+    else if (geoType == SFAMultiLineString::TYPE_NAME)
+    {
+        const SFAMultiLineString& multiLine =
+                static_cast<const SFAMultiLineString&>(geometry);
+
+        mWriter.startElement("MultiLineString");
+        // optional to unbounded
+        for (size_t ii = 0; ii < multiLine.elements.size(); ++ii)
+        {
+            const SFALineString& line = *multiLine.elements[ii];
+            mWriter.startElement("Element", SFA_PREFIX);
+            for (size_t jj = 0; jj < line.vertices.size(); ++jj)
+            {
+                writeSFAPoint("Vertex", *line.vertices[jj]);
+            }
+            mWriter.endElement();
+        }
+        mWriter.endElement();
+    }
+    else if (geoType == SFAMultiPoint::TYPE_NAME)
+    {
+        const SFAMultiPoint& multiPoint =
+                static_cast<const SFAMultiPoint&>(geometry);
+        if (multiPoint.vertices.size() < 2)
+        {
+            throw except::Exception(Ctxt(FmtX(
+                    "Must be at least two Vertices in LineString. Only [%d] " \
+                    "found", multiPoint.vertices.size())));
+        }
+
+        mWriter.startElement("MultiPoint");
+        // two to unbounded
+        for (size_t ii = 0; ii < multiPoint.vertices.size(); ++ii)
+        {
+            writeSFAPoint("Vertex", *multiPoint.vertices[ii]);
+        }
+        mWriter.endElement();
+    }
+    else
+    {
+        throw except::InvalidArgumentException(Ctxt(FmtX(
+                "Invalid geo type: [%s]", geoType.c_str())));
+    }
+}
+}
+}
@@ -342,7 +342,10 @@ void Utilities::setCollectionValues(Vector3 arpVel, Vector3 arpPos,
         Vector3 refPos, const Vector3* row, const Vector3* col,
         Collection* collection)
 {
-    const scene::SceneGeometry sceneGeom(arpVel, arpPos, refPos, *row, *col);
+    // The product plane is also the output plane that the ground track
+    // angle is measured in
+    const scene::SceneGeometry sceneGeom(arpVel, arpPos, refPos, *row, *col,
+                                         *row, *col);
 
     if (collection->geometry.get() == NULL)
     {
@@ -0,0 +1,242 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <except/Exception.h>
+#include <io/ByteStream.h>
+#include <mem/ScopedArray.h>
+#include <sys/OS.h>
+#include <six/sidd/DerivedXMLControl.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/DerivedDataBuilder.h>
+#include <six/J2KWriteHandler.h>
+#include <six/NITFReadControl.h>
+#include <six/NITFWriteControl.h>
+
+/*
+ *  Round trips a J2K compressed SIDD through the tiled encoder: the image is
+ *  written once by the NITRO plugin and once by J2KWriteHandler, both are
+ *  decoded through NITRO, and the pixels have to match each other and the
+ *  original (the compression is lossless).  This only runs when SIX is built
+ *  with J2K support.
+ */
+namespace
+{
+// Power of two blocks so the image can be split into tiles, with a partial
+// block on the right and bottom edges
+const size_t NUM_ROWS = 200;
+const size_t NUM_COLS = 150;
+const size_t BLOCK_SIZE = 64;
+
+std::auto_ptr<six::Data>
+mockupDerivedData(const types::RowCol<size_t>& dims)
+{
+    six::sidd::DerivedDataBuilder siddBuilder;
+    siddBuilder.addDisplay(six::PixelType::MONO8I);
+    siddBuilder.addGeographicAndTarget(six::RegionType::GEOGRAPHIC_INFO);
+    siddBuilder.addMeasurement(six::ProjectionType::PLANE).
+            addExploitationFeatures(1);
+
+    six::sidd::DerivedData* siddData = siddBuilder.steal();
+    std::auto_ptr<six::Data> siddDataScoped(siddData);
+
+    siddData->setNumRows(dims.row);
+    siddData->setNumCols(dims.col);
+
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.3, -83.8);
+    corners.upperRight = six::LatLon(42.3, -83.7);
+    corners.lowerRight = six::LatLon(42.2, -83.7);
+    corners.lowerLeft = six::LatLon(42.2, -83.8);
+    siddData->setImageCorners(corners);
+
+    siddData->productCreation->productName = "ProductName";
+    siddData->productCreation->productClass = "Classy";
+    siddData->productCreation->classification.classification = "U";
+    siddData->productCreation->processorInformation->application =
+            "ProcessorName";
+    siddData->productCreation->processorInformation->profile = "Profile";
+    siddData->productCreation->processorInformation->site = "Ypsilanti, MI";
+
+    // We know this is PGD so this is safe
+    six::sidd::PlaneProjection* const planeProjection =
+        reinterpret_cast<six::sidd::PlaneProjection*>(
+                siddData->measurement->projection.get());
+
+    planeProjection->timeCOAPoly = six::Poly2D(0, 0);
+    planeProjection->timeCOAPoly[0][0] = 1;
+    siddData->measurement->arpPoly = six::PolyXYZ(0);
+    siddData->measurement->arpPoly[0] = six::Vector3(0.0);
+    planeProjection->productPlane.rowUnitVector = six::Vector3(0.0);
+    planeProjection->productPlane.colUnitVector = six::Vector3(0.0);
+
+    six::sidd::Collection* const parent =
+            siddData->exploitationFeatures->collections[0].get();
+    parent->information->resolution.rg = 0;
+    parent->information->resolution.az = 0;
+    parent->information->collectionDuration = 0;
+    parent->information->collectionDateTime = six::DateTime();
+    parent->information->radarMode = six::RadarModeType::SPOTLIGHT;
+    siddData->exploitationFeatures->product.resolution.row = 0;
+    siddData->exploitationFeatures->product.resolution.col = 0;
+
+    return siddDataScoped;
+}
+
+struct TestHelper
+{
+    TestHelper() :
+        mPathname("test_j2k_write_tiled.nitf"),
+        mImage(NUM_ROWS * NUM_COLS)
+    {
+        mXmlRegistry.addCreator(
+                six::DataType::DERIVED,
+                new six::XMLControlCreatorT<
+                        six::sidd::DerivedXMLControl>());
+
+        // Smooth enough to compress but not trivially
+        for (size_t row = 0, idx = 0; row < NUM_ROWS; ++row)
+        {
+            for (size_t col = 0; col < NUM_COLS; ++col, ++idx)
+            {
+                mImage[idx] = static_cast<six::UByte>(
+                        (row / 4 + col / 8 + (row * col) % 7) % 256);
+            }
+        }
+    }
+
+    ~TestHelper()
+    {
+        try
+        {
+            sys::OS().remove(mPathname);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void write(bool useStream, size_t numThreads)
+    {
+        mem::SharedPtr<six::Container> container(new six::Container(
+                six::DataType::DERIVED));
+        container->addData(mockupDerivedData(
+                types::RowCol<size_t>(NUM_ROWS, NUM_COLS)));
+
+        six::NITFWriteControl writer;
+        six::Options& options(writer.getOptions());
+        options.setParameter(six::NITFWriteControl::OPT_J2K_COMPRESSION,
+                             1.0);
+        options.setParameter(six::NITFWriteControl::OPT_NUM_ROWS_PER_BLOCK,
+                             BLOCK_SIZE);
+        options.setParameter(six::NITFWriteControl::OPT_NUM_COLS_PER_BLOCK,
+                             BLOCK_SIZE);
+        options.setParameter(six::NITFWriteControl::OPT_NUM_J2K_THREADS,
+                             numThreads);
+        writer.setXMLControlRegistry(&mXmlRegistry);
+        writer.initialize(container);
+
+        if (useStream)
+        {
+            io::ByteStream stream;
+            stream.write(reinterpret_cast<const sys::byte*>(&mImage[0]),
+                         mImage.size());
+            stream.seek(0, io::Seekable::START);
+            std::vector<io::InputStream*> streams(1, &stream);
+            writer.save(streams, mPathname);
+        }
+        else
+        {
+            std::vector<six::UByte*> buffers(1, &mImage[0]);
+            writer.save(buffers, mPathname);
+        }
+    }
+
+    std::vector<six::UByte> read()
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&mXmlRegistry);
+        reader.load(mPathname);
+
+        six::Region region;
+        const mem::ScopedArray<six::UByte> image(
+                reader.interleaved(region, 0));
+        return std::vector<six::UByte>(image.get(),
+                                       image.get() + mImage.size());
+    }
+
+    const std::string mPathname;
+    six::XMLControlRegistry mXmlRegistry;
+    std::vector<six::UByte> mImage;
+};
+
+TEST_CASE(testRoundTrip)
+{
+    TestHelper testHelper;
+
+    testHelper.write(false, 1);
+    const std::vector<six::UByte> serial(testHelper.read());
+    TEST_ASSERT(serial == testHelper.mImage);
+
+    for (size_t useStream = 0; useStream < 2; ++useStream)
+    {
+        testHelper.write(useStream != 0, 3);
+        const std::vector<six::UByte> tiled(testHelper.read());
+        TEST_ASSERT(tiled == serial);
+    }
+}
+}
+
+int main(int, char**)
+{
+    try
+    {
+        if (!six::J2KWriteHandler::isAvailable())
+        {
+            std::cout << "SIX was built without J2K support, skipping\n";
+            return 0;
+        }
+
+        TEST_CHECK(testRoundTrip);
+        return 0;
+    }
+    catch (const except::Exception& e)
+    {
+        std::cerr << "Caught exception: " << e.getMessage() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
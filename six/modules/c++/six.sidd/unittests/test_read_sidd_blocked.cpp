@@ -0,0 +1,553 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <except/Exception.h>
+#include <io/FileInputStream.h>
+#include <mem/ScopedArray.h>
+#include <mt/ThreadGroup.h>
+#include <sys/OS.h>
+#include <import/nitf.hpp>
+#include <six/sidd/DerivedXMLControl.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/DerivedDataBuilder.h>
+#include <six/NITFReadControl.h>
+#include <six/NITFWriteControl.h>
+
+namespace
+{
+const size_t NUM_ROWS = 123;
+const size_t NUM_COLS = 97;
+const size_t BLOCK_SIZE = 16;
+
+std::auto_ptr<six::Data>
+mockupDerivedData(const types::RowCol<size_t>& dims)
+{
+    six::sidd::DerivedDataBuilder siddBuilder;
+    siddBuilder.addDisplay(six::PixelType::MONO8I);
+    siddBuilder.addGeographicAndTarget(six::RegionType::GEOGRAPHIC_INFO);
+    siddBuilder.addMeasurement(six::ProjectionType::PLANE).
+            addExploitationFeatures(1);
+
+    six::sidd::DerivedData* siddData = siddBuilder.steal();
+    std::auto_ptr<six::Data> siddDataScoped(siddData);
+
+    siddData->setNumRows(dims.row);
+    siddData->setNumCols(dims.col);
+
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.3, -83.8);
+    corners.upperRight = six::LatLon(42.3, -83.7);
+    corners.lowerRight = six::LatLon(42.2, -83.7);
+    corners.lowerLeft = six::LatLon(42.2, -83.8);
+    siddData->setImageCorners(corners);
+
+    siddData->productCreation->productName = "ProductName";
+    siddData->productCreation->productClass = "Classy";
+    siddData->productCreation->classification.classification = "U";
+    siddData->productCreation->processorInformation->application =
+            "ProcessorName";
+    siddData->productCreation->processorInformation->profile = "Profile";
+    siddData->productCreation->processorInformation->site = "Ypsilanti, MI";
+
+    siddData->display->decimationMethod =
+            six::DecimationMethod::BRIGHTEST_PIXEL;
+    siddData->display->magnificationMethod =
+            six::MagnificationMethod::NEAREST_NEIGHBOR;
+
+    // We know this is PGD so this is safe
+    six::sidd::PlaneProjection* const planeProjection =
+        reinterpret_cast<six::sidd::PlaneProjection*>(
+                siddData->measurement->projection.get());
+
+    planeProjection->timeCOAPoly = six::Poly2D(0, 0);
+    planeProjection->timeCOAPoly[0][0] = 1;
+    siddData->measurement->arpPoly = six::PolyXYZ(0);
+    siddData->measurement->arpPoly[0] = six::Vector3(0.0);
+    planeProjection->productPlane.rowUnitVector = six::Vector3(0.0);
+    planeProjection->productPlane.colUnitVector = six::Vector3(0.0);
+
+    six::sidd::Collection* const parent =
+            siddData->exploitationFeatures->collections[0].get();
+    parent->information->resolution.rg = 0;
+    parent->information->resolution.az = 0;
+    parent->information->collectionDuration = 0;
+    parent->information->collectionDateTime = six::DateTime();
+    parent->information->radarMode = six::RadarModeType::SPOTLIGHT;
+    siddData->exploitationFeatures->product.resolution.row = 0;
+    siddData->exploitationFeatures->product.resolution.col = 0;
+
+    return siddDataScoped;
+}
+
+struct TestHelper
+{
+    // Segments are split every 'maxILOCRows' rows if it's positive
+    TestHelper(size_t maxILOCRows = 0) :
+        mPathname("test_read_sidd_blocked.nitf"),
+        mImage(NUM_ROWS * NUM_COLS)
+    {
+        mXmlRegistry.addCreator(
+                six::DataType::DERIVED,
+                new six::XMLControlCreatorT<
+                        six::sidd::DerivedXMLControl>());
+
+        for (size_t ii = 0; ii < mImage.size(); ++ii)
+        {
+            mImage[ii] = static_cast<six::UByte>(ii * 7 + ii / NUM_COLS);
+        }
+
+        mem::SharedPtr<six::Container> container(new six::Container(
+                six::DataType::DERIVED));
+        container->addData(mockupDerivedData(
+                types::RowCol<size_t>(NUM_ROWS, NUM_COLS)));
+
+        six::NITFWriteControl writer;
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_NUM_ROWS_PER_BLOCK,
+                BLOCK_SIZE);
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_NUM_COLS_PER_BLOCK,
+                BLOCK_SIZE);
+        if (maxILOCRows > 0)
+        {
+            writer.getOptions().setParameter(
+                    six::NITFWriteControl::OPT_MAX_ILOC_ROWS, maxILOCRows);
+        }
+        writer.setXMLControlRegistry(&mXmlRegistry);
+        writer.initialize(container);
+
+        std::vector<six::UByte*> buffers(1, &mImage[0]);
+        writer.save(buffers, mPathname);
+    }
+
+    ~TestHelper()
+    {
+        try
+        {
+            sys::OS().remove(mPathname);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    // Reads the image in strips that straddle block boundaries
+    bool readStrips(six::NITFReadControl& reader) const
+    {
+        const size_t stripRows = 5;
+        const size_t startCol = 3;
+        const size_t numCols = NUM_COLS - 10;
+
+        std::vector<six::UByte> strip(stripRows * numCols);
+        for (size_t row = 0; row < NUM_ROWS; row += stripRows)
+        {
+            const size_t numRows = std::min(stripRows, NUM_ROWS - row);
+
+            six::Region region;
+            region.setStartRow(row);
+            region.setNumRows(numRows);
+            region.setStartCol(startCol);
+            region.setNumCols(numCols);
+            region.setBuffer(&strip[0]);
+            reader.interleaved(region, 0);
+
+            for (size_t ii = 0; ii < numRows; ++ii)
+            {
+                for (size_t jj = 0; jj < numCols; ++jj)
+                {
+                    if (strip[ii * numCols + jj] !=
+                        mImage[(row + ii) * NUM_COLS + startCol + jj])
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Straightforward decimation of a window of the image to check against
+    std::vector<six::UByte> decimate(const six::Region& region) const
+    {
+        const size_t rowFactor = region.getRowDecimation();
+        const size_t colFactor = region.getColDecimation();
+        const size_t endRow = region.getStartRow() + region.getNumRows();
+        const size_t endCol = region.getStartCol() + region.getNumCols();
+
+        std::vector<six::UByte> output;
+        for (size_t row = region.getStartRow(); row < endRow;
+             row += rowFactor)
+        {
+            for (size_t col = region.getStartCol(); col < endCol;
+                 col += colFactor)
+            {
+                six::UByte value = mImage[row * NUM_COLS + col];
+                if (region.getDecimationType() == six::Region::MAX)
+                {
+                    for (size_t ii = row;
+                         ii < std::min(row + rowFactor, endRow);
+                         ++ii)
+                    {
+                        for (size_t jj = col;
+                             jj < std::min(col + colFactor, endCol);
+                             ++jj)
+                        {
+                            value = std::max(value,
+                                             mImage[ii * NUM_COLS + jj]);
+                        }
+                    }
+                }
+                output.push_back(value);
+            }
+        }
+        return output;
+    }
+
+    bool readDecimated(six::NITFReadControl& reader,
+                       six::Region::DecimationType type) const
+    {
+        const size_t factors[][2] = { { 2, 2 }, { 3, 5 }, { 7, 1 } };
+        for (size_t ii = 0; ii < sizeof(factors) / sizeof(factors[0]); ++ii)
+        {
+            // The whole image, and a window that doesn't line up with
+            // blocks or segments
+            six::Region regions[2];
+            regions[1].setStartRow(9);
+            regions[1].setNumRows(NUM_ROWS - 20);
+            regions[1].setStartCol(5);
+            regions[1].setNumCols(NUM_COLS - 11);
+            for (size_t jj = 0; jj < 2; ++jj)
+            {
+                six::Region& region(regions[jj]);
+                region.setDecimation(factors[ii][0], factors[ii][1], type);
+                const mem::ScopedArray<six::UByte> image(
+                        reader.interleaved(region, 0));
+
+                const std::vector<six::UByte> expected = decimate(region);
+                if (!std::equal(expected.begin(), expected.end(),
+                                image.get()))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    const std::string mPathname;
+    six::XMLControlRegistry mXmlRegistry;
+    std::vector<six::UByte> mImage;
+};
+
+// Reads chips all over the image at the same time as other threads
+class ReadChipsRunnable : public sys::Runnable
+{
+public:
+    ReadChipsRunnable(const TestHelper& testHelper,
+                      six::NITFReadControl& reader,
+                      size_t seed,
+                      bool& passed) :
+        mTestHelper(testHelper),
+        mReader(reader),
+        mState(seed),
+        mPassed(passed)
+    {
+    }
+
+    virtual void run()
+    {
+        mPassed = true;
+        for (size_t ii = 0; ii < 50; ++ii)
+        {
+            const size_t numRows = 1 + next() % 50;
+            const size_t numCols = 1 + next() % 40;
+            const size_t startRow = next() % (NUM_ROWS - numRows + 1);
+            const size_t startCol = next() % (NUM_COLS - numCols + 1);
+
+            six::Region region;
+            region.setStartRow(startRow);
+            region.setNumRows(numRows);
+            region.setStartCol(startCol);
+            region.setNumCols(numCols);
+            const mem::ScopedArray<six::UByte> chip(
+                    mReader.interleavedConcurrent(region, 0));
+
+            for (size_t row = 0; row < numRows; ++row)
+            {
+                if (!std::equal(chip.get() + row * numCols,
+                                chip.get() + (row + 1) * numCols,
+                                &mTestHelper.mImage[(startRow + row) *
+                                                    NUM_COLS + startCol]))
+                {
+                    mPassed = false;
+                }
+            }
+        }
+    }
+
+private:
+    size_t next()
+    {
+        mState = mState * 1103515245 + 12345;
+        return (mState / 65536) % 32768;
+    }
+
+    const TestHelper& mTestHelper;
+    six::NITFReadControl& mReader;
+    size_t mState;
+    bool& mPassed;
+};
+
+TEST_CASE(testReadControlOptions)
+{
+    TestHelper testHelper;
+
+    // Without caching
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.load(testHelper.mPathname);
+        TEST_ASSERT(testHelper.readStrips(reader));
+    }
+
+    // Cache a row of blocks
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.getOptions().setParameter(
+                six::NITFReadControl::OPT_BLOCK_CACHE_BLOCKS,
+                (NUM_COLS + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        reader.load(testHelper.mPathname);
+        TEST_ASSERT(testHelper.readStrips(reader));
+    }
+
+    // A byte budget smaller than a row of blocks still reads correctly
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.getOptions().setParameter(
+                six::NITFReadControl::OPT_BLOCK_CACHE_BLOCKS, 100);
+        reader.getOptions().setParameter(
+                six::NITFReadControl::OPT_BLOCK_CACHE_BYTES,
+                BLOCK_SIZE * BLOCK_SIZE * 2);
+        reader.load(testHelper.mPathname);
+        TEST_ASSERT(testHelper.readStrips(reader));
+    }
+}
+
+TEST_CASE(testParallelRead)
+{
+    TestHelper testHelper;
+
+    // Strips only hit a few blocks at a time
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.getOptions().setParameter(
+                six::NITFReadControl::OPT_NUM_DECODE_THREADS, 3);
+        reader.load(testHelper.mPathname);
+        TEST_ASSERT(testHelper.readStrips(reader));
+    }
+
+    // The whole image, with a thread per CPU
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.getOptions().setParameter(
+                six::NITFReadControl::OPT_NUM_DECODE_THREADS, 0);
+        reader.load(testHelper.mPathname);
+
+        six::Region region;
+        const mem::ScopedArray<six::UByte> image(
+                reader.interleaved(region, 0));
+        TEST_ASSERT(std::equal(testHelper.mImage.begin(),
+                               testHelper.mImage.end(),
+                               image.get()));
+    }
+}
+
+TEST_CASE(testDecimatedRead)
+{
+    // Split into a few segments
+    TestHelper testHelper(40);
+
+    for (size_t numThreads = 1; numThreads <= 3; numThreads += 2)
+    {
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.getOptions().setParameter(
+                six::NITFReadControl::OPT_NUM_DECODE_THREADS, numThreads);
+        reader.load(testHelper.mPathname);
+
+        TEST_ASSERT(testHelper.readDecimated(reader,
+                                             six::Region::PIXEL_SKIP));
+        TEST_ASSERT(testHelper.readDecimated(reader, six::Region::MAX));
+
+        // Sum of squares is only for complex data
+        six::Region region;
+        region.setDecimation(2, 2, six::Region::SUM_SQUARES);
+        TEST_EXCEPTION(reader.interleaved(region, 0));
+    }
+}
+
+TEST_CASE(testConcurrentRead)
+{
+    // Split into a few segments
+    TestHelper testHelper(40);
+    const size_t numThreads = 4;
+
+    // Positional reads of the file, then serialized reads of a stream
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        io::FileInputStream stream(testHelper.mPathname);
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        if (ii == 0)
+        {
+            reader.load(testHelper.mPathname);
+        }
+        else
+        {
+            reader.load(stream, std::vector<std::string>());
+        }
+
+        // Twice, so the second time reuses the pooled readers
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            bool passed[numThreads];
+            mt::ThreadGroup threads;
+            for (size_t jj = 0; jj < numThreads; ++jj)
+            {
+                threads.createThread(new ReadChipsRunnable(
+                        testHelper, reader, jj * 10 + pass, passed[jj]));
+            }
+            threads.joinAll();
+
+            for (size_t jj = 0; jj < numThreads; ++jj)
+            {
+                TEST_ASSERT(passed[jj]);
+            }
+        }
+
+        // Ordinary reads still work afterwards
+        TEST_ASSERT(testHelper.readStrips(reader));
+
+        six::Region region;
+        region.setDecimation(2, 2, six::Region::PIXEL_SKIP);
+        TEST_EXCEPTION(reader.interleavedConcurrent(region, 0));
+        six::Region outside;
+        outside.setStartRow(NUM_ROWS);
+        outside.setNumRows(1);
+        TEST_EXCEPTION(reader.interleavedConcurrent(outside, 0));
+        TEST_EXCEPTION(reader.interleavedConcurrent(region, 1));
+    }
+}
+
+TEST_CASE(testImageReaderStats)
+{
+    TestHelper testHelper;
+
+    nitf::IOHandle handle(testHelper.mPathname);
+    nitf::Reader reader;
+    reader.read(handle);
+
+    const nitf::Uint32 blocksPerRow =
+            (NUM_COLS + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+    imageReader.setReadCaching();
+    imageReader.setBlockCacheSize(blocksPerRow);
+
+    // Every block is read once, every other strip comes from the cache
+    std::vector<nitf::Uint8> strip(NUM_COLS);
+    nitf::Uint32 bandList(0);
+    nitf::SubWindow sw;
+    sw.setStartCol(0);
+    sw.setNumCols(NUM_COLS);
+    sw.setNumRows(1);
+    sw.setNumBands(1);
+    sw.setBandList(&bandList);
+    for (nitf::Uint32 row = 0; row < NUM_ROWS; ++row)
+    {
+        sw.setStartRow(row);
+        nitf::Uint8* bufferPtr = &strip[0];
+        int padded;
+        imageReader.read(sw, &bufferPtr, &padded);
+        TEST_ASSERT(std::equal(strip.begin(), strip.end(),
+                               &testHelper.mImage[row * NUM_COLS]));
+    }
+
+    nitf::Uint32 numBlocks;
+    nitf::Uint64 numBytes;
+    nitf::Uint64 hits;
+    nitf::Uint64 misses;
+    imageReader.getBlockCacheStats(&numBlocks, &numBytes, &hits, &misses);
+
+    const nitf::Uint64 blocksPerCol =
+            (NUM_ROWS + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    TEST_ASSERT_EQ(numBlocks, blocksPerRow);
+    TEST_ASSERT_EQ(misses, blocksPerRow * blocksPerCol);
+    TEST_ASSERT_EQ(hits + misses, blocksPerRow * NUM_ROWS);
+
+    // Shrinking the cache drops the least recently used blocks
+    imageReader.setBlockCacheSize(100, numBytes / 2);
+    imageReader.getBlockCacheStats(&numBlocks, &numBytes, NULL, NULL);
+    TEST_ASSERT(numBlocks < blocksPerRow);
+    TEST_ASSERT(numBlocks > 0);
+
+    TEST_EXCEPTION(imageReader.setBlockCacheSize(0));
+}
+}
+
+int main(int, char**)
+{
+    try
+    {
+        TEST_CHECK(testReadControlOptions);
+        TEST_CHECK(testParallelRead);
+        TEST_CHECK(testDecimatedRead);
+        TEST_CHECK(testConcurrentRead);
+        TEST_CHECK(testImageReaderStats);
+        return 0;
+    }
+    catch (const except::Exception& e)
+    {
+        std::cerr << "Caught exception: " << e.getMessage() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
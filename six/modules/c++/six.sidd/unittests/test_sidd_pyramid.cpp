@@ -0,0 +1,427 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six.sidd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "TestCase.h"
+
+#include <except/Exception.h>
+#include <io/ByteStream.h>
+#include <mem/ScopedArray.h>
+#include <sys/OS.h>
+#include <six/sidd/DerivedXMLControl.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/DerivedDataBuilder.h>
+#include <six/NITFReadControl.h>
+#include <six/NITFWriteControl.h>
+#include <six/PyramidBuilder.h>
+
+namespace
+{
+const size_t NUM_ROWS = 75;
+const size_t NUM_COLS = 53;
+const size_t NUM_LEVELS = 3;
+
+std::auto_ptr<six::Data>
+mockupDerivedData(const types::RowCol<size_t>& dims)
+{
+    six::sidd::DerivedDataBuilder siddBuilder;
+    siddBuilder.addDisplay(six::PixelType::MONO8I);
+    siddBuilder.addGeographicAndTarget(six::RegionType::GEOGRAPHIC_INFO);
+    siddBuilder.addMeasurement(six::ProjectionType::PLANE).
+            addExploitationFeatures(1);
+
+    six::sidd::DerivedData* siddData = siddBuilder.steal();
+    std::auto_ptr<six::Data> siddDataScoped(siddData);
+
+    siddData->setNumRows(dims.row);
+    siddData->setNumCols(dims.col);
+
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.3, -83.8);
+    corners.upperRight = six::LatLon(42.3, -83.7);
+    corners.lowerRight = six::LatLon(42.2, -83.7);
+    corners.lowerLeft = six::LatLon(42.2, -83.8);
+    siddData->setImageCorners(corners);
+
+    siddData->productCreation->productName = "ProductName";
+    siddData->productCreation->productClass = "Classy";
+    siddData->productCreation->classification.classification = "U";
+    siddData->productCreation->processorInformation->application =
+            "ProcessorName";
+    siddData->productCreation->processorInformation->profile = "Profile";
+    siddData->productCreation->processorInformation->site = "Ypsilanti, MI";
+
+    siddData->display->decimationMethod =
+            six::DecimationMethod::BRIGHTEST_PIXEL;
+    siddData->display->magnificationMethod =
+            six::MagnificationMethod::NEAREST_NEIGHBOR;
+
+    // We know this is PGD so this is safe
+    six::sidd::PlaneProjection* const planeProjection =
+        reinterpret_cast<six::sidd::PlaneProjection*>(
+                siddData->measurement->projection.get());
+
+    planeProjection->timeCOAPoly = six::Poly2D(0, 0);
+    planeProjection->timeCOAPoly[0][0] = 1;
+    siddData->measurement->arpPoly = six::PolyXYZ(0);
+    siddData->measurement->arpPoly[0] = six::Vector3(0.0);
+    planeProjection->productPlane.rowUnitVector = six::Vector3(0.0);
+    planeProjection->productPlane.colUnitVector = six::Vector3(0.0);
+
+    six::sidd::Collection* const parent =
+            siddData->exploitationFeatures->collections[0].get();
+    parent->information->resolution.rg = 0;
+    parent->information->resolution.az = 0;
+    parent->information->collectionDuration = 0;
+    parent->information->collectionDateTime = six::DateTime();
+    parent->information->radarMode = six::RadarModeType::SPOTLIGHT;
+    siddData->exploitationFeatures->product.resolution.row = 0;
+    siddData->exploitationFeatures->product.resolution.col = 0;
+
+    return siddDataScoped;
+}
+
+// Straightforward decimation by 2 to check the builder against
+template <typename T>
+std::vector<T> decimate(const std::vector<T>& image,
+                        const types::RowCol<size_t>& dims,
+                        bool brightest)
+{
+    const types::RowCol<size_t> outDims((dims.row + 1) / 2,
+                                        (dims.col + 1) / 2);
+    std::vector<T> output(outDims.area());
+    for (size_t row = 0; row < outDims.row; ++row)
+    {
+        for (size_t col = 0; col < outDims.col; ++col)
+        {
+            T value = image[row * 2 * dims.col + col * 2];
+            if (brightest)
+            {
+                for (size_t ii = row * 2;
+                     ii < std::min(row * 2 + 2, dims.row);
+                     ++ii)
+                {
+                    for (size_t jj = col * 2;
+                         jj < std::min(col * 2 + 2, dims.col);
+                         ++jj)
+                    {
+                        value = std::max(value, image[ii * dims.col + jj]);
+                    }
+                }
+            }
+            output[row * outDims.col + col] = value;
+        }
+    }
+    return output;
+}
+
+template <typename T>
+bool checkBuilder(bool brightest, size_t chunkSize, size_t maxMemory)
+{
+    const types::RowCol<size_t> dims(NUM_ROWS, NUM_COLS);
+    std::vector<T> image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<T>(ii * 7919 + ii / 13);
+    }
+
+    six::PyramidBuilder builder(
+            dims, sizeof(T), NUM_LEVELS,
+            brightest ? six::DecimationMethod::BRIGHTEST_PIXEL :
+                        six::DecimationMethod::NEAREST_NEIGHBOR,
+            maxMemory);
+    if (builder.isScratchFileUsed() != (maxMemory == 0))
+    {
+        return false;
+    }
+
+    // Feed it in chunks that don't line up with rows
+    const six::UByte* const bytes =
+            reinterpret_cast<const six::UByte*>(&image[0]);
+    const size_t numBytes = image.size() * sizeof(T);
+    for (size_t offset = 0; offset < numBytes; offset += chunkSize)
+    {
+        if (builder.isComplete())
+        {
+            return false;
+        }
+        builder.addBytes(bytes + offset,
+                         std::min(chunkSize, numBytes - offset));
+    }
+    if (!builder.isComplete() || builder.getNumLevels() != NUM_LEVELS)
+    {
+        return false;
+    }
+
+    std::vector<T> expected(image);
+    types::RowCol<size_t> expectedDims(dims);
+    for (size_t level = 1; level <= NUM_LEVELS; ++level)
+    {
+        expected = decimate(expected, expectedDims, brightest);
+        expectedDims.row = (expectedDims.row + 1) / 2;
+        expectedDims.col = (expectedDims.col + 1) / 2;
+
+        if (builder.getLevelDims(level) != expectedDims)
+        {
+            return false;
+        }
+
+        std::vector<T> levelPixels(expectedDims.area());
+        builder.readLevel(level, 0, levelPixels.size() * sizeof(T),
+                          reinterpret_cast<six::UByte*>(&levelPixels[0]));
+        if (levelPixels != expected)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct TestHelper
+{
+    TestHelper() :
+        mPathname("test_sidd_pyramid.nitf"),
+        mImage(NUM_ROWS * NUM_COLS)
+    {
+        mXmlRegistry.addCreator(
+                six::DataType::DERIVED,
+                new six::XMLControlCreatorT<
+                        six::sidd::DerivedXMLControl>());
+
+        for (size_t ii = 0; ii < mImage.size(); ++ii)
+        {
+            mImage[ii] = static_cast<six::UByte>(ii * 7 + ii / NUM_COLS);
+        }
+    }
+
+    ~TestHelper()
+    {
+        try
+        {
+            sys::OS().remove(mPathname);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void write(bool useStream, size_t numLevels, size_t maxMemory)
+    {
+        mem::SharedPtr<six::Container> container(new six::Container(
+                six::DataType::DERIVED));
+        container->addData(mockupDerivedData(
+                types::RowCol<size_t>(NUM_ROWS, NUM_COLS)));
+
+        six::NITFWriteControl writer;
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_NUM_PYRAMID_LEVELS, numLevels);
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_PYRAMID_METHOD,
+                std::string("BRIGHTEST_PIXEL"));
+        writer.getOptions().setParameter(
+                six::NITFWriteControl::OPT_PYRAMID_MAX_MEMORY, maxMemory);
+        writer.setXMLControlRegistry(&mXmlRegistry);
+        writer.initialize(container);
+
+        if (useStream)
+        {
+            io::ByteStream stream;
+            stream.write(reinterpret_cast<const sys::byte*>(&mImage[0]),
+                         mImage.size());
+            stream.seek(0, io::Seekable::START);
+            std::vector<io::InputStream*> streams(1, &stream);
+            writer.save(streams, mPathname);
+        }
+        else
+        {
+            std::vector<six::UByte*> buffers(1, &mImage[0]);
+            writer.save(buffers, mPathname);
+        }
+    }
+
+    const std::string mPathname;
+    six::XMLControlRegistry mXmlRegistry;
+    std::vector<six::UByte> mImage;
+};
+
+TEST_CASE(testBuilder)
+{
+    const size_t maxMemory = six::PyramidBuilder::DEFAULT_MAX_MEMORY;
+    TEST_ASSERT(checkBuilder<sys::Uint8_T>(false, 1, maxMemory));
+    TEST_ASSERT(checkBuilder<sys::Uint8_T>(true, 17, maxMemory));
+    TEST_ASSERT(checkBuilder<sys::Uint16_T>(false, 1000000, maxMemory));
+    TEST_ASSERT(checkBuilder<sys::Uint16_T>(true, 101, maxMemory));
+
+    // Same again through a scratch file
+    TEST_ASSERT(checkBuilder<sys::Uint8_T>(false, 1, 0));
+    TEST_ASSERT(checkBuilder<sys::Uint8_T>(true, 17, 0));
+    TEST_ASSERT(checkBuilder<sys::Uint16_T>(false, 1000000, 0));
+    TEST_ASSERT(checkBuilder<sys::Uint16_T>(true, 101, 0));
+
+    // Levels stop at a single pixel
+    const types::RowCol<size_t> dims(5, 2);
+    TEST_ASSERT_EQ(six::PyramidBuilder::getMaxNumLevels(dims), 3);
+    six::PyramidBuilder builder(dims, 1, 10,
+                                six::DecimationMethod::NEAREST_NEIGHBOR);
+    TEST_ASSERT_EQ(builder.getNumLevels(), 3);
+    TEST_ASSERT_EQ(builder.getLevelDims(3).row, 1);
+    TEST_ASSERT_EQ(builder.getLevelDims(3).col, 1);
+
+    // Nothing's there until it's been built
+    six::UByte pixel;
+    TEST_EXCEPTION(builder.readLevel(3, 0, 1, &pixel));
+    TEST_EXCEPTION(builder.readLevel(4, 0, 0, &pixel));
+
+    const std::vector<six::UByte> tooMuch(dims.area() + 1);
+    TEST_EXCEPTION(builder.addRows(&tooMuch[0], dims.row + 1));
+    TEST_EXCEPTION(six::PyramidBuilder(dims, 3, 1,
+            six::DecimationMethod::NEAREST_NEIGHBOR));
+    TEST_EXCEPTION(six::PyramidBuilder(dims, 1, 1,
+            six::DecimationMethod::BILINEAR));
+}
+
+TEST_CASE(testReadLevels)
+{
+    TestHelper testHelper;
+
+    const types::RowCol<size_t> dims(NUM_ROWS, NUM_COLS);
+    std::vector<six::UByte> expected(testHelper.mImage);
+    std::vector<std::vector<six::UByte> > levels;
+    types::RowCol<size_t> levelDims(dims);
+    for (size_t level = 1; level <= NUM_LEVELS; ++level)
+    {
+        expected = decimate(expected, levelDims, true);
+        levels.push_back(expected);
+        levelDims = six::PyramidBuilder::getLevelDims(dims, level);
+    }
+
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        // With and without a scratch file for the levels
+        const bool useStream = (ii % 2 != 0);
+        const size_t maxMemory =
+                (ii < 2) ? six::PyramidBuilder::DEFAULT_MAX_MEMORY : 0;
+        testHelper.write(useStream, NUM_LEVELS, maxMemory);
+
+        six::NITFReadControl reader;
+        reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+        reader.load(testHelper.mPathname);
+        TEST_ASSERT_EQ(reader.getNumPyramidLevels(0), NUM_LEVELS);
+
+        // Every segment has its own IID
+        nitf::Record record = reader.getRecord();
+        std::set<std::string> iids;
+        for (nitf::Uint32 seg = 0; seg < record.getNumImages(); ++seg)
+        {
+            nitf::ImageSegment segment = record.getImages()[seg];
+            iids.insert(segment.getSubheader().getImageId().toString());
+        }
+        TEST_ASSERT_EQ(iids.size(), NUM_LEVELS + 1);
+
+        // The full resolution image is unaffected
+        {
+            six::Region region;
+            const mem::ScopedArray<six::UByte> image(
+                    reader.interleaved(region, 0, 0));
+            TEST_ASSERT(std::equal(testHelper.mImage.begin(),
+                                   testHelper.mImage.end(),
+                                   image.get()));
+        }
+
+        for (size_t level = 1; level <= NUM_LEVELS; ++level)
+        {
+            levelDims = reader.getPyramidLevelDims(0, level);
+            TEST_ASSERT(levelDims ==
+                        six::PyramidBuilder::getLevelDims(dims, level));
+
+            six::Region region;
+            const mem::ScopedArray<six::UByte> image(
+                    reader.interleaved(region, 0, level));
+            TEST_ASSERT(std::equal(levels[level - 1].begin(),
+                                   levels[level - 1].end(),
+                                   image.get()));
+        }
+
+        // A window out of the middle of level 1
+        levelDims = reader.getPyramidLevelDims(0, 1);
+        six::Region region;
+        region.setStartRow(5);
+        region.setNumRows(7);
+        region.setStartCol(3);
+        region.setNumCols(11);
+        const mem::ScopedArray<six::UByte> window(
+                reader.interleaved(region, 0, 1));
+        for (size_t row = 0; row < 7; ++row)
+        {
+            TEST_ASSERT(std::equal(
+                    &window[row * 11], &window[row * 11] + 11,
+                    &levels[0][(row + 5) * levelDims.col + 3]));
+        }
+
+        TEST_EXCEPTION(reader.interleaved(region, 0, NUM_LEVELS + 1));
+
+        // Decimating a level by 2 with max gives the next level down
+        six::Region decimated;
+        decimated.setDecimation(2, 2, six::Region::MAX);
+        const mem::ScopedArray<six::UByte> level2(
+                reader.interleaved(decimated, 0, 1));
+        TEST_ASSERT(std::equal(levels[1].begin(), levels[1].end(),
+                               level2.get()));
+    }
+
+    // No levels by default
+    testHelper.write(false, 0, six::PyramidBuilder::DEFAULT_MAX_MEMORY);
+    six::NITFReadControl reader;
+    reader.setXMLControlRegistry(&testHelper.mXmlRegistry);
+    reader.load(testHelper.mPathname);
+    TEST_ASSERT_EQ(reader.getNumPyramidLevels(0), 0);
+}
+}
+
+int main(int, char**)
+{
+    try
+    {
+        TEST_CHECK(testBuilder);
+        TEST_CHECK(testReadLevels);
+        return 0;
+    }
+    catch (const except::Exception& e)
+    {
+        std::cerr << "Caught exception: " << e.getMessage() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Caught exception: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
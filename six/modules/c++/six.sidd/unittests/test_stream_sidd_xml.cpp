@@ -0,0 +1,380 @@
+/* =========================================================================
+ * This file is part of six.sidd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TestCase.h"
+#include <except/Exception.h>
+#include <io/StringStream.h>
+#include <six/sidd/DerivedData.h>
+#include <six/sidd/DerivedDataBuilder.h>
+#include <six/sidd/DerivedXMLControl.h>
+
+namespace
+{
+six::Poly2D makePoly2D(double offset)
+{
+    six::Poly2D poly(1, 1);
+    poly[0][0] = offset;
+    poly[0][1] = offset + 0.5;
+    poly[1][0] = -offset;
+    poly[1][1] = 1.0e-7;
+    return poly;
+}
+
+six::Parameter makeParameter(const std::string& name,
+                             const std::string& value)
+{
+    six::Parameter parameter(value);
+    parameter.setName(name);
+    return parameter;
+}
+
+six::LatLonCorners makeCorners()
+{
+    six::LatLonCorners corners;
+    corners.upperLeft = six::LatLon(42.29, -83.76);
+    corners.upperRight = six::LatLon(42.29, -83.70);
+    corners.lowerRight = six::LatLon(42.25, -83.70);
+    corners.lowerLeft = six::LatLon(42.25, -83.76);
+    return corners;
+}
+
+mem::ScopedCopyablePtr<six::sidd::SFAPoint>
+makePoint(double x, double y)
+{
+    return mem::ScopedCopyablePtr<six::sidd::SFAPoint>(
+            new six::sidd::SFAPoint(x, y));
+}
+
+template <typename LineT>
+LineT* makeLine(double start)
+{
+    LineT* line = new LineT();
+    line->vertices.push_back(makePoint(start, start + 1));
+    line->vertices.push_back(makePoint(start + 2, start + 3));
+    return line;
+}
+
+six::sidd::SFAPolygon* makePolygon()
+{
+    six::sidd::SFAPolygon* polygon = new six::sidd::SFAPolygon();
+    polygon->rings.push_back(mem::ScopedCopyablePtr<six::sidd::SFALinearRing>(
+            makeLine<six::sidd::SFALinearRing>(10)));
+    return polygon;
+}
+
+six::sidd::SFAGeographicCoordinateSystem* makeGeographicSystem()
+{
+    six::sidd::SFAGeographicCoordinateSystem* system =
+            new six::sidd::SFAGeographicCoordinateSystem();
+    system->csName = "WGS 84";
+    system->datum.spheroid.name = "WGS_1984";
+    system->datum.spheroid.semiMajorAxis = 6378137.0;
+    system->datum.spheroid.inverseFlattening = 298.257223563;
+    system->primeMeridian.name = "Greenwich";
+    system->primeMeridian.longitude = 0.0;
+    system->angularUnit = "Degree";
+    system->linearUnit = "Meter";
+    return system;
+}
+
+// Fills in everything the XML needs, plus a good share of what's optional
+std::auto_ptr<six::sidd::DerivedData>
+mockupDerivedData(six::ProjectionType projectionType)
+{
+    six::sidd::DerivedDataBuilder builder;
+    builder.addDisplay(six::PixelType::MONO8LU);
+    builder.addGeographicAndTarget(six::RegionType::GEOGRAPHIC_INFO);
+    builder.addMeasurement(projectionType).addExploitationFeatures(1);
+    builder.addProductProcessing().addDownstreamReprocessing();
+    std::auto_ptr<six::sidd::DerivedData> data(builder.steal());
+
+    six::sidd::ProductCreation& creation = *data->productCreation;
+    creation.productName = "ProductName";
+    creation.productClass = "Classy";
+    creation.productType = "Type";
+    creation.processorInformation->application = "ProcessorName";
+    creation.processorInformation->site = "Ypsilanti, MI";
+    creation.classification.classification = "U";
+    creation.classification.ownerProducer.push_back(" USA ");
+    creation.classification.ownerProducer.push_back("");
+    creation.classification.ownerProducer.push_back("CAN");
+    creation.classification.releasableTo.push_back("USA");
+    creation.classification.derivedFrom = "Source";
+    creation.classification.declassDate.reset(new six::DateTime());
+    creation.classification.securityExtensions.push_back(
+            makeParameter("Extension", "Value"));
+    creation.productCreationExtensions.push_back(
+            makeParameter("Creation", "Extension"));
+
+    six::sidd::Display& display = *data->display;
+    six::LUT* lut = new six::LUT(4, 2);
+    for (size_t ii = 0; ii < 4 * 2; ++ii)
+    {
+        lut->getTable()[ii] = static_cast<unsigned char>(ii * 37);
+    }
+    six::sidd::MonochromeDisplayRemap* remap =
+            new six::sidd::MonochromeDisplayRemap("Remap", lut);
+    remap->remapParameters.push_back(makeParameter("Gain", "2"));
+    display.remapInformation.reset(remap);
+    display.magnificationMethod = six::MagnificationMethod::NEAREST_NEIGHBOR;
+    display.decimationMethod = six::DecimationMethod::BRIGHTEST_PIXEL;
+    display.histogramOverrides.reset(new six::sidd::DRAHistogramOverrides());
+    display.histogramOverrides->clipMin = 1;
+    display.histogramOverrides->clipMax = 254;
+
+    six::sidd::GeographicAndTarget& geoTarget = *data->geographicAndTarget;
+    geoTarget.geographicCoverage.footprint = makeCorners();
+    geoTarget.geographicCoverage.georegionIdentifiers.push_back(
+            makeParameter("Region", "Ann Arbor"));
+    six::sidd::GeographicInformation& geoInfo =
+            *geoTarget.geographicCoverage.geographicInformation;
+    geoInfo.countryCodes.push_back("US");
+    geoInfo.securityInformation = "  Unclassified ";
+    mem::ScopedCopyablePtr<six::sidd::TargetInformation> target(
+            new six::sidd::TargetInformation());
+    target->identifiers.push_back(makeParameter("Name", "Target"));
+    target->footprint.reset(new six::LatLonCorners(makeCorners()));
+    geoTarget.targetInformation.push_back(target);
+
+    six::sidd::Measurement& measurement = *data->measurement;
+    measurement.projection->referencePoint =
+            six::ReferencePoint(1.0e6, 2.0e6, 3.0e6, 512.5, 256.25);
+    measurement.projection->referencePoint.name = "Center";
+    measurement.pixelFootprint = six::RowColInt(1024, 512);
+    measurement.arpPoly = six::PolyXYZ(1);
+    measurement.arpPoly[0] = six::Vector3(7.0e6);
+    measurement.arpPoly[1] = six::Vector3(-12.75);
+    if (projectionType == six::ProjectionType::POLYNOMIAL)
+    {
+        six::sidd::PolynomialProjection& projection =
+                static_cast<six::sidd::PolynomialProjection&>(
+                        *measurement.projection);
+        projection.rowColToLat = makePoly2D(42.0);
+        projection.rowColToLon = makePoly2D(-83.0);
+        projection.rowColToAlt = makePoly2D(200.0);
+        projection.latLonToRow = makePoly2D(1.0);
+        projection.latLonToCol = makePoly2D(2.0);
+    }
+    else
+    {
+        six::sidd::MeasurableProjection& projection =
+                static_cast<six::sidd::MeasurableProjection&>(
+                        *measurement.projection);
+        projection.sampleSpacing = six::RowColDouble(0.5, 0.75);
+        projection.timeCOAPoly = makePoly2D(3.0);
+
+        if (projectionType == six::ProjectionType::PLANE)
+        {
+            six::sidd::PlaneProjection& plane =
+                    static_cast<six::sidd::PlaneProjection&>(projection);
+            plane.productPlane.rowUnitVector = six::Vector3(1.0);
+            plane.productPlane.colUnitVector = six::Vector3(-1.0);
+        }
+        else if (projectionType == six::ProjectionType::CYLINDRICAL)
+        {
+            six::sidd::CylindricalProjection& cylindrical =
+                    static_cast<six::sidd::CylindricalProjection&>(
+                            projection);
+            cylindrical.stripmapDirection = six::Vector3(0.25);
+            cylindrical.curvatureRadius = 6.4e6;
+        }
+    }
+
+    six::sidd::Collection& collection =
+            *data->exploitationFeatures->collections[0];
+    collection.identifier = "Collection";
+    six::sidd::Information& information = *collection.information;
+    information.sensorName = "Sensor";
+    information.radarMode = six::RadarModeType::SPOTLIGHT;
+    information.radarModeID = "Mode";
+    information.collectionDuration = 1.5;
+    information.resolution.rg = 0.3;
+    information.resolution.az = 0.4;
+    information.inputROI.reset(new six::sidd::InputROI(100, 200, 3, 4));
+    information.polarization.push_back(
+            mem::ScopedCloneablePtr<six::sidd::TxRcvPolarization>(
+                    new six::sidd::TxRcvPolarization(
+                            six::PolarizationType::V,
+                            six::PolarizationType::H, 0.125)));
+    collection.geometry.reset(new six::sidd::Geometry());
+    collection.geometry->azimuth = 12.5;
+    collection.geometry->graze = 30.0;
+    collection.phenomenology.reset(new six::sidd::Phenomenology());
+    collection.phenomenology->shadow = six::AngleMagnitude(45.0, 2.0);
+    collection.phenomenology->multiPath = 10.0;
+    data->exploitationFeatures->product.resolution =
+            six::RowColDouble(0.5, 0.5);
+    data->exploitationFeatures->product.north = 91.0;
+
+    mem::ScopedCloneablePtr<six::sidd::ProcessingModule> module(
+            new six::sidd::ProcessingModule());
+    module->moduleName = makeParameter("Name", "Module");
+    module->moduleParameters.push_back(makeParameter("Parameter", "1"));
+    data->productProcessing->processingModules.push_back(module);
+
+    six::sidd::DownstreamReprocessing& reprocessing =
+            *data->downstreamReprocessing;
+    reprocessing.geometricChip.reset(new six::sidd::GeometricChip());
+    reprocessing.geometricChip->chipSize = six::RowColInt(100, 200);
+    reprocessing.geometricChip->originalUpperLeftCoordinate =
+            six::RowColDouble(0, 0);
+    reprocessing.geometricChip->originalUpperRightCoordinate =
+            six::RowColDouble(0, 199);
+    reprocessing.geometricChip->originalLowerLeftCoordinate =
+            six::RowColDouble(99, 0);
+    reprocessing.geometricChip->originalLowerRightCoordinate =
+            six::RowColDouble(99, 199);
+    mem::ScopedCopyablePtr<six::sidd::ProcessingEvent> event(
+            new six::sidd::ProcessingEvent());
+    event->applicationName = "Chipper";
+    event->interpolationMethod = "Nearest";
+    reprocessing.processingEvents.push_back(event);
+
+    return data;
+}
+
+void addAnnotations(six::sidd::DerivedData& data)
+{
+    mem::ScopedCopyablePtr<six::sidd::Annotation> projected(
+            new six::sidd::Annotation());
+    projected->identifier = "Projected";
+    projected->spatialReferenceSystem.reset(
+            new six::sidd::SFAReferenceSystem());
+    six::sidd::SFAProjectedCoordinateSystem* projectedSystem =
+            new six::sidd::SFAProjectedCoordinateSystem();
+    projectedSystem->csName = "UTM";
+    projectedSystem->geographicCoordinateSystem.reset(makeGeographicSystem());
+    projectedSystem->projection.name = "Transverse_Mercator";
+    projectedSystem->parameter.name = "Scale_Factor";
+    projectedSystem->parameter.value = 0.9996;
+    projectedSystem->linearUnit = "Meter";
+    projected->spatialReferenceSystem->coordinateSystem.reset(
+            projectedSystem);
+    projected->spatialReferenceSystem->axisNames.push_back("X");
+    projected->spatialReferenceSystem->axisNames.push_back("Y");
+    projected->objects.push_back(mem::ScopedCloneablePtr<
+            six::sidd::SFAGeometry>(new six::sidd::SFAPoint(1, 2, 3, 4)));
+    projected->objects.push_back(mem::ScopedCloneablePtr<
+            six::sidd::SFAGeometry>(makeLine<six::sidd::SFALine>(5)));
+    projected->objects.push_back(mem::ScopedCloneablePtr<
+            six::sidd::SFAGeometry>(makePolygon()));
+    data.annotations.push_back(projected);
+
+    mem::ScopedCopyablePtr<six::sidd::Annotation> geographic(
+            new six::sidd::Annotation());
+    geographic->identifier = "Geographic";
+    geographic->spatialReferenceSystem.reset(
+            new six::sidd::SFAReferenceSystem());
+    geographic->spatialReferenceSystem->coordinateSystem.reset(
+            makeGeographicSystem());
+    geographic->spatialReferenceSystem->axisNames.push_back("Lat");
+    six::sidd::SFAPolyhedralSurface* surface =
+            new six::sidd::SFAPolyhedralSurface();
+    surface->patches.push_back(
+            mem::ScopedCloneablePtr<six::sidd::SFAPolygon>(makePolygon()));
+    geographic->objects.push_back(
+            mem::ScopedCloneablePtr<six::sidd::SFAGeometry>(surface));
+    six::sidd::SFAMultiLineString* multiLine =
+            new six::sidd::SFAMultiLineString();
+    multiLine->elements.push_back(
+            mem::ScopedCloneablePtr<six::sidd::SFALineString>(
+                    makeLine<six::sidd::SFALineString>(20)));
+    geographic->objects.push_back(
+            mem::ScopedCloneablePtr<six::sidd::SFAGeometry>(multiLine));
+    six::sidd::SFAMultiPoint* multiPoint = new six::sidd::SFAMultiPoint();
+    multiPoint->vertices.push_back(makePoint(1, 1));
+    multiPoint->vertices.push_back(makePoint(2, 2));
+    geographic->objects.push_back(
+            mem::ScopedCloneablePtr<six::sidd::SFAGeometry>(multiPoint));
+    data.annotations.push_back(geographic);
+}
+
+std::string toDOMString(const six::Data& data)
+{
+    six::sidd::DerivedXMLControl control;
+    const std::auto_ptr<xml::lite::Document> doc(
+            control.toXML(&data, std::vector<std::string>()));
+    io::StringStream oss;
+    doc->getRootElement()->print(oss);
+    return oss.stream().str();
+}
+
+std::string toStreamedString(const six::Data& data)
+{
+    six::sidd::DerivedXMLControl control;
+    io::StringStream oss;
+    control.toXML(&data, std::vector<std::string>(), oss);
+    return oss.stream().str();
+}
+}
+
+TEST_CASE(streamMatchesDOMForEachProjection)
+{
+    const six::ProjectionType types[] =
+    {
+        six::ProjectionType::POLYNOMIAL,
+        six::ProjectionType::GEOGRAPHIC,
+        six::ProjectionType::PLANE,
+        six::ProjectionType::CYLINDRICAL
+    };
+
+    for (size_t ii = 0; ii < sizeof(types) / sizeof(types[0]); ++ii)
+    {
+        const std::auto_ptr<six::sidd::DerivedData> data(
+                mockupDerivedData(types[ii]));
+        const std::string dom = toDOMString(*data);
+        TEST_ASSERT_EQ(toStreamedString(*data), dom);
+    }
+}
+
+TEST_CASE(streamMatchesDOMWithAnnotations)
+{
+    const std::auto_ptr<six::sidd::DerivedData> data(
+            mockupDerivedData(six::ProjectionType::PLANE));
+    addAnnotations(*data);
+
+    const std::string dom = toDOMString(*data);
+    TEST_ASSERT(dom.find("<sfa:PolyhedralSurface") == std::string::npos);
+    TEST_ASSERT(dom.find("<sfa:Patch>") != std::string::npos);
+    TEST_ASSERT_EQ(toStreamedString(*data), dom);
+}
+
+TEST_CASE(streamThrowsLikeDOM)
+{
+    const std::auto_ptr<six::sidd::DerivedData> data(
+            mockupDerivedData(six::ProjectionType::GEOGRAPHIC));
+    data->exploitationFeatures->collections.clear();
+
+    TEST_EXCEPTION(toDOMString(*data));
+    TEST_EXCEPTION(toStreamedString(*data));
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(streamMatchesDOMForEachProjection);
+    TEST_CHECK(streamMatchesDOMWithAnnotations);
+    TEST_CHECK(streamThrowsLikeDOM);
+    return 0;
+}
@@ -27,6 +27,7 @@
 #include "six/Data.h"
 #include "six/Enums.h"
 #include "six/ErrorStatistics.h"
+#include "six/FFT.h"
 #include "six/NITFImageInfo.h"
 #include "six/NITFImageInputStream.h"
 #include "six/NITFSegmentInfo.h"
@@ -36,7 +37,11 @@
 #include "six/Init.h"
 #include "six/Types.h"
 #include "six/Utilities.h"
+#include "six/ValidDataMask.h"
+#include "six/ValidDataReader.h"
+#include "six/ValidDataStatistics.h"
 #include "six/Parameter.h"
+#include "six/Profiler.h"
 #include "six/Radiometric.h"
 #include "six/Region.h"
 #include "six/ReadControl.h"
@@ -93,11 +93,15 @@ public:
  *  \class MemoryWriteHandler
  *  \brief Overloaded NITF write handler from memory buffer
  *
- *  This is used to write an image buffer from memory.  Each row is read
- *  one at a time and transferred into the write handle.  It makes use
- *  of NITRO's low-level WriteHandler API, which assumes that you will handle
- *  the heavy lifting.  This is not typically used, since the ImageWriter
- *  is more general, but in the case of pixel interleaved data, the 
+ *  This is used to write an image buffer from memory.  Rows are written
+ *  in chunks of about chunkSize bytes.  When there's no byte swapping to
+ *  do, each chunk goes straight from the caller's buffer into the write
+ *  handle.  Otherwise it's copied into one of two scratch buffers and
+ *  swapped (in parallel across numThreads threads), and the next chunk is
+ *  prepared in the other buffer while this one is being written.  It makes
+ *  use of NITRO's low-level WriteHandler API, which assumes that you will
+ *  handle the heavy lifting.  This is not typically used, since the
+ *  ImageWriter is more general, but in the case of pixel interleaved data, the
  *  WriteHandler is the most efficient method of data transfer into a NITF.
  *
  *  This class can handle both SIDD and SICD data.  In the current state
@@ -116,21 +120,28 @@ public:
 class MemoryWriteHandler: public nitf::WriteHandler
 {
 public:
+    //! Number of bytes written at a time (rounded to whole rows)
+    static const size_t DEFAULT_CHUNK_SIZE;
+
     MemoryWriteHandler(const NITFSegmentInfo& info, 
                        const UByte* buffer,
                        size_t firstRow,
                        size_t numCols,
                        size_t numChannels,
                        size_t pixelSize,
-                       bool doByteSwap);
+                       bool doByteSwap,
+                       size_t numThreads = 1,
+                       size_t chunkSize = DEFAULT_CHUNK_SIZE);
 };
 
 /*!
  *  \class StreamWriteHandler
  *  \brief Derived implementation for nitf::WriteHandler
  *
- *  This is used to write an image buffer from a file source.  Each row is read
- *  one at a time and transferred into the write handle.
+ *  This is used to write an image buffer from a file source.  Rows are read
+ *  in chunks of about chunkSize bytes, swapped if need be, and written out
+ *  of two alternating scratch buffers, so the next chunk is read and
+ *  swapped while the current one is written.
  *
  *  This class can handle both SIDD and SICD data.  In the current state
  *  of SIDD, data is always 1 or 3 channels and the size of the channel
@@ -144,12 +155,17 @@ public:
 class StreamWriteHandler: public nitf::WriteHandler
 {
 public:
+    //! Number of bytes written at a time (rounded to whole rows)
+    static const size_t DEFAULT_CHUNK_SIZE;
+
     StreamWriteHandler(const NITFSegmentInfo& info,
                        io::InputStream* is,
                        size_t numCols,
                        size_t numChannels,
                        size_t pixelSize,
-                       bool doByteSwap);
+                       bool doByteSwap,
+                       size_t numThreads = 1,
+                       size_t chunkSize = DEFAULT_CHUNK_SIZE);
 };
 
 }
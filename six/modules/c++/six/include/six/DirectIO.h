@@ -0,0 +1,197 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_DIRECT_IO_H__
+#define __SIX_DIRECT_IO_H__
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/ConditionVar.h>
+#include <sys/Mutex.h>
+#include <mt/ThreadGroup.h>
+#include <nitf/CustomIO.hpp>
+
+namespace six
+{
+/*!
+ *  \class DirectIO
+ *  \brief IOInterface that bypasses the page cache and keeps several reads
+ *  or writes in flight
+ *
+ *  The file is opened for direct I/O (O_DIRECT, or FILE_FLAG_NO_BUFFERING
+ *  on Windows) and accessed a chunk at a time through aligned buffers.
+ *  Worker threads do the positional reads and writes, so a full chunk is
+ *  written while the next one is filled, and reading a chunk starts reads
+ *  of the ones after it.  Up to 'queueDepth' chunks are in flight at once.
+ *
+ *  Writes may go anywhere in the file (NITRO seeks back to fill in
+ *  lengths).  Chunks that were already written are read back before
+ *  they're changed.  The file is trimmed to its size when it's closed.
+ *
+ *  If the file system doesn't support direct I/O, the file is opened
+ *  normally and everything else works the same.  Only one thread may use
+ *  a DirectIO at a time.
+ *
+ *  This class is not copyable.
+ */
+class DirectIO : public nitf::CustomIO
+{
+public:
+    //! Alignment of file offsets, sizes and buffers
+    static const size_t ALIGNMENT;
+
+    static const size_t DEFAULT_CHUNK_SIZE;
+    static const size_t DEFAULT_QUEUE_DEPTH;
+
+    /*!
+     *  Opens a file
+     *
+     *  \param pathname The file to open
+     *  \param accessMode NITF_ACCESS_READONLY to read an existing file, or
+     *  NITF_ACCESS_WRITEONLY to create (or truncate) one
+     *  \param chunkSize Bytes read or written at a time.  It's rounded up
+     *  to a multiple of ALIGNMENT.
+     *  \param queueDepth Chunks that can be in flight at once
+     *
+     *  \throws except::Exception if the file can't be opened
+     */
+    DirectIO(const std::string& pathname,
+             int accessMode,
+             size_t chunkSize = DEFAULT_CHUNK_SIZE,
+             size_t queueDepth = DEFAULT_QUEUE_DEPTH);
+
+    //! Closes the file if it's open.  Call close() to see any errors.
+    ~DirectIO();
+
+    //! \return Whether the file bypasses the page cache
+    bool isDirect() const
+    {
+        return mDirect;
+    }
+
+private:
+    // Unimplemented - DirectIO is not copyable
+    DirectIO(const DirectIO& other);
+    DirectIO& operator=(const DirectIO& other);
+
+    // A buffer holding one chunk of the file
+    struct Chunk
+    {
+        enum State
+        {
+            FREE,       // Not holding anything
+            READY,      // Matches the file
+            FILLING,    // Being written to, and not yet in the file
+            READING,    // Waiting on a worker to read it
+            WRITING     // Waiting on a worker to write it
+        };
+
+        Chunk();
+
+        sys::ubyte* buffer;
+        sys::Uint64_T index;
+        size_t numBytes;
+        State state;
+        sys::Uint64_T lastUsed;
+    };
+
+    class Worker;
+
+    // Does queued reads and writes until told to stop
+    void work();
+
+    // Does one queued read or write
+    void transfer(Chunk& chunk);
+
+    // Throws the first error a worker ran into.  Must hold mMutex.
+    void checkError() const;
+
+    // \return Chunk 'index' ready for use.  Must hold mMutex.
+    Chunk* getChunk(sys::Uint64_T index);
+
+    /*!
+     *  \return A free chunk, or else the least recently used chunk before
+     *  'evictBefore' that can be reused, or NULL if there isn't one.  Must
+     *  hold mMutex.
+     */
+    Chunk* findFreeChunk(sys::Uint64_T evictBefore);
+
+    // Hands a chunk to the workers.  Must hold mMutex.
+    void submit(Chunk& chunk, Chunk::State state);
+
+    // Starts reading the chunks after 'index'.  Must hold mMutex.
+    void readAhead(sys::Uint64_T index);
+
+    // Waits for the workers to finish everything.  Must hold mMutex.
+    void waitForAll();
+
+    void readImpl(void* buffer, size_t size);
+
+    void writeImpl(const void* buffer, size_t size);
+
+    bool canSeekImpl() const;
+
+    nitf::Off seekImpl(nitf::Off offset, int whence);
+
+    nitf::Off tellImpl() const;
+
+    nitf::Off getSizeImpl() const;
+
+    int getModeImpl() const;
+
+    void closeImpl();
+
+private:
+    const std::string mPathname;
+    const bool mWrite;
+    const size_t mChunkSize;
+    sys::Handle_T mHandle;
+    bool mDirect;
+    bool mOpen;
+
+    nitf::Off mOffset;
+    sys::Uint64_T mSize;
+
+    // How far the file has been written out
+    sys::Uint64_T mWrittenSize;
+
+    std::vector<Chunk> mChunks;
+
+    // The chunk being written to, if any
+    Chunk* mCurrent;
+    sys::Uint64_T mNumUses;
+
+    // Everything below is shared with the workers, and guarded by mMutex
+    sys::Mutex mMutex;
+    sys::ConditionVar mRequestQueued;
+    sys::ConditionVar mRequestDone;
+    std::deque<Chunk*> mRequests;
+    size_t mNumInFlight;
+    bool mStop;
+    std::string mError;
+    mt::ThreadGroup mWorkers;
+};
+}
+
+#endif
@@ -0,0 +1,113 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_FFT_H__
+#define __SIX_FFT_H__
+
+#include <complex>
+#include <vector>
+
+#include <sys/Conf.h>
+
+namespace six
+{
+/*!
+ *  \class FFT
+ *  \brief One dimensional complex FFT of a fixed size
+ *
+ *  Twiddle factors are computed once at construction.  Power of two sizes
+ *  use an iterative radix-2 transform.  Any other size goes through
+ *  Bluestein's algorithm on top of a radix-2 transform of at least twice
+ *  the size, so it's exact but roughly four times slower.
+ *
+ *  The transforms are const and keep any scratch space on the stack of the
+ *  caller, so one FFT can be shared between threads.
+ */
+class FFT
+{
+public:
+    //! \param size Number of samples in each transform
+    explicit FFT(size_t size);
+
+    size_t getSize() const
+    {
+        return mSize;
+    }
+
+    /*!
+     *  In place forward transform,
+     *  X[k] = sum(x[n] * exp(-j * 2 * pi * n * k / N))
+     */
+    void forward(std::complex<float>* data) const;
+
+    /*!
+     *  In place inverse transform,
+     *  x[n] = sum(X[k] * exp(j * 2 * pi * n * k / N))
+     *  This is not scaled by 1 / N.
+     */
+    void inverse(std::complex<float>* data) const;
+
+    /*!
+     *  Forward transform if 'sign' is negative, inverse if it's positive,
+     *  matching the sign of the exponent
+     */
+    void transform(std::complex<float>* data, int sign) const
+    {
+        if (sign < 0)
+        {
+            forward(data);
+        }
+        else
+        {
+            inverse(data);
+        }
+    }
+
+    static bool isPowerOfTwo(size_t size)
+    {
+        return (size != 0 && (size & (size - 1)) == 0);
+    }
+
+    //! \return The smallest power of two that's >= 'size'
+    static size_t nextPowerOfTwo(size_t size);
+
+private:
+    // Forward radix-2 transform of mRadix2Size samples
+    void radix2(std::complex<float>* data) const;
+
+    void bluestein(std::complex<float>* data) const;
+
+private:
+    const size_t mSize;
+    size_t mRadix2Size;
+
+    // exp(-j * 2 * pi * k / mRadix2Size) for k < mRadix2Size / 2
+    std::vector<std::complex<float> > mTwiddles;
+    std::vector<size_t> mBitReverse;
+
+    // Bluestein only: the chirp exp(-j * pi * n^2 / mSize) and the
+    // transform of its conjugate, wrapped around to mRadix2Size samples
+    std::vector<std::complex<float> > mChirp;
+    std::vector<std::complex<float> > mChirpFilter;
+};
+}
+
+#endif
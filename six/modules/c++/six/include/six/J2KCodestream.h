@@ -0,0 +1,123 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_J2K_CODESTREAM_H__
+#define __SIX_J2K_CODESTREAM_H__
+
+#include <vector>
+
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+
+namespace six
+{
+/*!
+ *  \class J2KCodestream
+ *  \brief Splices independently encoded JPEG 2000 tiles into one codestream
+ *
+ *  Wraps (without copying) the bytes of a codestream that was encoded as a
+ *  standalone image holding a single tile.  The tile-parts of such a
+ *  codestream can be renumbered and appended to the main header of another
+ *  one, whose SIZ marker is rewritten to describe the full image.  This is
+ *  how tiles that were encoded in parallel get assembled in order.
+ *
+ *  The result is only identical to what encoding the full image would
+ *  produce if each tile lines up with the code-block and precinct grids at
+ *  every resolution level (see isTileAligned()).  Codestreams with TLM, PLM
+ *  or PPM markers aren't supported since those index across tiles.
+ */
+class J2KCodestream
+{
+public:
+    /*!
+     *  \param data The codestream, from SOC through EOC
+     *  \param numBytes Size of 'data' in bytes
+     *
+     *  \throws except::Exception if the codestream can't be parsed
+     */
+    J2KCodestream(sys::ubyte* data, size_t numBytes);
+
+    //! \return The main header, from SOC up to the first SOT
+    const sys::ubyte* getMainHeader() const
+    {
+        return mData;
+    }
+
+    size_t getMainHeaderSize() const
+    {
+        return mMainHeaderSize;
+    }
+
+    //! \return All the tile-parts, from the first SOT up to EOC
+    const sys::ubyte* getTileParts() const
+    {
+        return mData + mMainHeaderSize;
+    }
+
+    size_t getTilePartsSize() const
+    {
+        return mTilePartsSize;
+    }
+
+    size_t getNumTileParts() const
+    {
+        return mTilePartOffsets.size();
+    }
+
+    //! Renumbers every tile-part to belong to tile 'tileIndex'
+    void setTileIndex(size_t tileIndex);
+
+    /*!
+     *  Rewrites the SIZ marker to describe a full image tiled from the
+     *  origin
+     *
+     *  \param imageDims Dimensions of the full image
+     *  \param tileDims Nominal tile dimensions
+     */
+    void setImageSize(const types::RowCol<size_t>& imageDims,
+                      const types::RowCol<size_t>& tileDims);
+
+    /*!
+     *  \param tileDims Nominal tile dimensions
+     *  \param numResolutions Number of resolution levels
+     *
+     *  \return True if a tile encoded on its own has the same code-blocks
+     *  and precincts as when encoded in place, assuming 64x64 code-blocks
+     *  and the default (maximum) precinct size.  In practice this means
+     *  power of two tile sizes.
+     */
+    static bool isTileAligned(const types::RowCol<size_t>& tileDims,
+                              size_t numResolutions);
+
+    //! The end of codestream (EOC) marker
+    static const sys::ubyte END_OF_CODESTREAM[2];
+
+private:
+    sys::ubyte* const mData;
+    const size_t mNumBytes;
+    size_t mMainHeaderSize;
+    size_t mSIZOffset;
+    size_t mTilePartsSize;
+    std::vector<size_t> mTilePartOffsets;
+};
+}
+
+#endif
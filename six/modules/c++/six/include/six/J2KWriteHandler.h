@@ -0,0 +1,104 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_J2K_WRITE_HANDLER_H__
+#define __SIX_J2K_WRITE_HANDLER_H__
+
+#include <map>
+#include <string>
+
+#include <import/io.h>
+#include <import/nitf.hpp>
+#include "six/Types.h"
+
+namespace six
+{
+/*!
+ *  \class J2KWriteHandler
+ *  \brief Writes a JPEG 2000 (C8) compressed image segment, encoding its
+ *  tiles on multiple threads
+ *
+ *  NITRO's J2K compression plugin encodes the whole segment serially.
+ *  Instead, this encodes each block of the segment as its own single tile
+ *  codestream through j2k::Writer and splices the tiles together in order
+ *  (see J2KCodestream).  The image is processed one band of tile rows at a
+ *  time, so only the compressed tiles of one band are held at once.  When
+ *  the pixels come from an InputStream, only one band of them is read in at
+ *  a time as well.
+ *
+ *  Only single band, 8 or 16 bit integer segments whose blocks line up with
+ *  the JPEG 2000 code-block grid are supported; use canWrite() to check.
+ *  COMRAT is updated in the subheader the same way the plugin does it.
+ */
+class J2KWriteHandler: public nitf::WriteHandler
+{
+public:
+    /*!
+     *  Encodes an image that's in memory
+     *
+     *  \param subheader Subheader of the image segment being written
+     *  \param buffer The image, which must stay around until it's written
+     *  \param numThreads Number of threads to encode with
+     *  \param options Writer options, as in the keys from
+     *  nitf/WriterOptions.h
+     */
+    J2KWriteHandler(nitf::ImageSubheader subheader,
+                    const UByte* buffer,
+                    size_t numThreads,
+                    const std::map<std::string, void*>& options);
+
+    /*!
+     *  Encodes an image that's streamed in row by row
+     *
+     *  \param subheader Subheader of the image segment being written
+     *  \param is Stream to read the image from, positioned at the first row
+     *  \param numThreads Number of threads to encode with
+     *  \param options Writer options, as in the keys from
+     *  nitf/WriterOptions.h
+     */
+    J2KWriteHandler(nitf::ImageSubheader subheader,
+                    io::InputStream* is,
+                    size_t numThreads,
+                    const std::map<std::string, void*>& options);
+
+    //! \return True if SIX was built with J2K support
+    static bool isAvailable();
+
+    /*!
+     *  \param subheader Subheader of a C8 image segment
+     *  \param options Writer options
+     *
+     *  \return True if the segment can be written by this handler and
+     *  has more than one block to encode
+     */
+    static bool canWrite(nitf::ImageSubheader subheader,
+                         const std::map<std::string, void*>& options);
+
+private:
+    void initialize(nitf::ImageSubheader subheader,
+                    const UByte* buffer,
+                    io::InputStream* is,
+                    size_t numThreads,
+                    const std::map<std::string, void*>& options);
+};
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_MAPPED_FILE_H__
+#define __SIX_MAPPED_FILE_H__
+
+#include <string>
+
+#include <sys/Conf.h>
+
+namespace six
+{
+/*!
+ *  \class MappedFile
+ *  \brief A whole file mapped read-only into memory
+ *
+ *  The mapping stays valid for the life of the object.  Empty files aren't
+ *  mapped, so getData() is NULL for them.
+ *
+ *  This class is not copyable.
+ */
+class MappedFile
+{
+public:
+    /*!
+     *  Maps a file
+     *
+     *  \param pathname The file to map
+     *
+     *  \throws except::Exception if it can't be opened or mapped
+     */
+    explicit MappedFile(const std::string& pathname);
+
+    ~MappedFile();
+
+    //! \return The start of the mapping
+    const sys::ubyte* getData() const
+    {
+        return mData;
+    }
+
+    //! \return The number of bytes in the file
+    size_t getNumBytes() const
+    {
+        return mSize;
+    }
+
+private:
+    // Unimplemented - MappedFile is not copyable
+    MappedFile(const MappedFile& other);
+    MappedFile& operator=(const MappedFile& other);
+
+    void unmap();
+
+private:
+    const sys::ubyte* mData;
+    size_t mSize;
+
+#if defined(WIN32) || defined(_WIN32)
+    HANDLE mFile;
+    HANDLE mMapping;
+#endif
+};
+}
+
+#endif
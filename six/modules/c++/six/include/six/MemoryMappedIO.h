@@ -0,0 +1,99 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_MEMORY_MAPPED_IO_H__
+#define __SIX_MEMORY_MAPPED_IO_H__
+
+#include <string>
+
+#include <sys/Conf.h>
+#include <nitf/CustomIO.hpp>
+#include <six/MappedFile.h>
+
+namespace six
+{
+/*!
+ *  \class MemoryMappedIO
+ *  \brief Read-only IOInterface over a memory mapped file
+ *
+ *  Reads are copies out of the mapping, so there are no syscalls once the
+ *  file is open.  NITFReadControl recognizes it and, for image segments
+ *  that are stored uncompressed and unblocked, reads pixels straight out
+ *  of the mapping rather than going through NITRO.  The mapping stays
+ *  valid for the life of the object.
+ *
+ *  This class is not copyable.
+ */
+class MemoryMappedIO : public nitf::CustomIO
+{
+public:
+    /*!
+     *  Maps a file
+     *
+     *  \param pathname The file to map
+     *
+     *  \throws except::Exception if it can't be opened or mapped
+     */
+    MemoryMappedIO(const std::string& pathname);
+
+    //! \return The start of the mapping
+    const sys::ubyte* getData() const
+    {
+        return mData;
+    }
+
+    //! \return The number of bytes in the file
+    size_t getNumBytes() const
+    {
+        return mSize;
+    }
+
+private:
+    // Unimplemented - MemoryMappedIO is not copyable
+    MemoryMappedIO(const MemoryMappedIO& other);
+    MemoryMappedIO& operator=(const MemoryMappedIO& other);
+
+    void readImpl(void* buffer, size_t size);
+
+    void writeImpl(const void* buffer, size_t size);
+
+    bool canSeekImpl() const;
+
+    nitf::Off seekImpl(nitf::Off offset, int whence);
+
+    nitf::Off tellImpl() const;
+
+    nitf::Off getSizeImpl() const;
+
+    int getModeImpl() const;
+
+    void closeImpl();
+
+private:
+    const std::string mPathname;
+    const MappedFile mFile;
+    const sys::ubyte* const mData;
+    const size_t mSize;
+    nitf::Off mOffset;
+};
+}
+
+#endif
@@ -149,6 +149,20 @@ public:
         startIndex = index;
     }
 
+    /*!
+     *  The NITF image segment of each reduced resolution level of the
+     *  image, starting with the one decimated by 2
+     */
+    std::vector<size_t> getPyramidLevels() const
+    {
+        return pyramidLevels;
+    }
+
+    void addPyramidLevel(size_t imageSegment)
+    {
+        pyramidLevels.push_back(imageSegment);
+    }
+
     //! Number of bytes in the product
     sys::Uint64_T getProductSize() const
     {
@@ -295,6 +309,9 @@ private:
      *  Note that the number of segments has a hard limit of 999
      */
     std::vector<NITFSegmentInfo> imageSegments;
+
+    //! Image segments of the reduced resolution levels, if any
+    std::vector<size_t> pyramidLevels;
 };
 
 //------------------------------------------------------------------------------
@@ -22,11 +22,16 @@
 #ifndef __SIX_NITF_READ_CONTROL_H__
 #define __SIX_NITF_READ_CONTROL_H__
 
+#include <complex>
 #include <map>
+#include <memory>
+#include <sys/File.h>
+#include <sys/Mutex.h>
 #include "six/NITFImageInfo.h"
 #include "six/ReadControl.h"
 #include "six/ReadControlFactory.h"
 #include "six/Adapters.h"
+#include "six/MemoryMappedIO.h"
 #include <io/SeekableStreams.h>
 #include <import/nitf.hpp>
 #include <nitf/IOStreamReader.hpp>
@@ -55,6 +60,51 @@ public:
     //!  Constructor
     NITFReadControl();
 
+    /*!
+     *  Keys for sizing the NITRO block cache used by interleaved().  One
+     *  image reader per image segment is kept open between calls.  If
+     *  OPT_BLOCK_CACHE_BLOCKS is set when a segment is first read, its
+     *  reader caches up to that many blocks (and at most
+     *  OPT_BLOCK_CACHE_BYTES bytes of blocks, if set).  Reading a blocked
+     *  image in windows that aren't aligned to the blocking then only reads
+     *  and decompresses each block once.
+     */
+    static const char OPT_BLOCK_CACHE_BLOCKS[];
+    static const char OPT_BLOCK_CACHE_BYTES[];
+
+    /*!
+     *  Number of threads interleaved() uses to read blocked image segments.
+     *  The blocks that intersect the region are split up among the
+     *  threads, each of which reads and decompresses its blocks through its
+     *  own reader and copies them into place.  This is mostly of use for
+     *  J2K or JPEG compressed SIDDs, where decompression dominates.  Use 0
+     *  for one thread per CPU.  The default is 1.
+     */
+    static const char OPT_NUM_DECODE_THREADS[];
+
+    /*!
+     *  If nonzero when a file is loaded by pathname, the file is memory
+     *  mapped through a MemoryMappedIO (if it can't be, it's read as
+     *  usual).  Image segments of a mapped file that are stored
+     *  uncompressed and unblocked are contiguous big-endian pixels, so
+     *  interleaved(), interleavedConcurrent() and interleavedComplex() read
+     *  them straight out of the mapping, swapping bytes on the way into the
+     *  caller's buffer, rather than through NITRO.  The same goes for files
+     *  loaded through a MemoryMappedIO.  The default is 0.
+     */
+    static const char OPT_MEMORY_MAP[];
+
+    /*!
+     *  If nonzero when a file is loaded by pathname, the file is read
+     *  through a DirectIO, bypassing the page cache and reading up to
+     *  OPT_DIRECT_IO_QUEUE_DEPTH chunks ahead (the default depth is
+     *  DirectIO::DEFAULT_QUEUE_DEPTH).  OPT_MEMORY_MAP takes precedence.
+     *  interleavedConcurrent() still reads the file through the page
+     *  cache.  The default is 0.
+     */
+    static const char OPT_DIRECT_IO[];
+    static const char OPT_DIRECT_IO_QUEUE_DEPTH[];
+
     //!  Destructor
     virtual ~NITFReadControl()
     {
@@ -134,8 +184,71 @@ public:
     void load(mem::SharedPtr<nitf::IOInterface> ioInterface,
               const std::vector<std::string>& schemaPaths);
 
+    /*!
+     *  Reads a region of an image.  If the region is decimated, only the
+     *  rows that feed the output are read, and the output rows are split
+     *  up between OPT_NUM_DECODE_THREADS threads.
+     */
     virtual UByte* interleaved(Region& region, size_t imageNumber);
 
+    /*!
+     *  Reads a region out of one of the reduced resolution levels written
+     *  via NITFWriteControl::OPT_NUM_PYRAMID_LEVELS.  The region is in the
+     *  level's pixels, and may be decimated further.
+     *
+     *  \param region Region to read
+     *  \param imageNumber Image to read
+     *  \param level Level to read, where 0 is full resolution, 1 is
+     *  decimated by 2, and so on
+     *
+     *  \return The region's buffer
+     */
+    UByte* interleaved(Region& region, size_t imageNumber, size_t level);
+
+    /*!
+     *  Reads a region of an image, and may be called from any number of
+     *  threads at once.  Each call borrows a NITRO reader, with its own
+     *  image reader per segment, from a pool that grows to the number of
+     *  calls that have been in flight at once.  Readers of a file loaded by
+     *  pathname all read its one descriptor with positional reads.
+     *  Otherwise their reads of the loaded IOInterface are serialized.
+     *
+     *  Decimated regions aren't supported.  As with interleaved(), the
+     *  buffer is allocated with new[] if the region doesn't have one.
+     *  Nothing else may be called on this object while these reads are
+     *  going on.
+     *
+     *  \param region Region to read
+     *  \param imageNumber Image to read
+     *
+     *  \return The region's buffer
+     */
+    UByte* interleavedConcurrent(Region& region, size_t imageNumber);
+
+    /*!
+     *  Reads a region of a complex (RE32F_IM32F or RE16I_IM16I) image as
+     *  complex<float>s, promoting 16-bit integer components.  Segments
+     *  that can be read out of a memory mapping (see OPT_MEMORY_MAP) are
+     *  swapped and promoted in one pass into 'buffer'.  Others are read
+     *  through NITRO a swath of rows at a time and then promoted.
+     *
+     *  Decimated regions aren't supported.
+     *
+     *  \param region Region to read.  Its buffer isn't used.
+     *  \param imageNumber Image to read
+     *  \param buffer Receives the region's pixels
+     */
+    void interleavedComplex(Region& region,
+                            size_t imageNumber,
+                            std::complex<float>* buffer);
+
+    //! \return The number of reduced resolution levels of an image
+    size_t getNumPyramidLevels(size_t imageNumber) const;
+
+    //! \return The dimensions of a level of an image (0 is full resolution)
+    types::RowCol<size_t> getPyramidLevelDims(size_t imageNumber,
+                                              size_t level) const;
+
     virtual std::string getFileType() const
     {
         return "NITF";
@@ -164,6 +277,9 @@ protected:
 
     std::map<std::string, void*> mCompressionOptions;
 
+    //! Image readers kept open for block caching, keyed by image segment
+    std::map<size_t, nitf::ImageReader> mImageReaders;
+
     /*!
      *  This function grabs the IID out of the NITF file.
      *  If the data is Complex, it follows the following convention.
@@ -209,6 +325,65 @@ private:
     NITFReadControl& operator=(const NITFReadControl& other);
 
 private:
+    //! \return The image segment's reader, which is opened the first time
+    nitf::ImageReader getImageReader(size_t imageSeg);
+
+    //! Fills in missing sizes, and throws if it's outside the image
+    void checkRegion(Region& region, size_t imageNumber) const;
+
+    // A reader one thread can use on its own, for interleavedConcurrent()
+    // and the threads of multithreaded reads
+    struct ConcurrentReader;
+
+    //! \return A reader from the pool, or a new one if they're all in use
+    ConcurrentReader* acquireConcurrentReader();
+
+    //! Returns a reader to the pool
+    void releaseConcurrentReader(ConcurrentReader* reader);
+
+    /*!
+     *  Reads the sub-window of an image segment a block at a time on
+     *  'numThreads' threads
+     */
+    void readBlocks(size_t imageSeg,
+                    nitf::SubWindow& subWindow,
+                    size_t numBytesPerPixel,
+                    size_t numThreads,
+                    nitf::Uint8* buffer);
+
+    //! \return The number of threads from OPT_NUM_DECODE_THREADS
+    size_t getNumDecodeThreads() const;
+
+    //! Finds the image segments that can be read out of the mapping
+    void findMappedSegments();
+
+    /*!
+     *  Reads the sub-window of an image segment out of the mapping, if it
+     *  can be read that way
+     *
+     *  \return Whether it was read
+     */
+    bool readMapped(size_t imageSeg,
+                    const nitf::SubWindow& subWindow,
+                    size_t numBytesPerPixel,
+                    nitf::Uint8* buffer) const;
+
+    //! Reads the sub-window of an image segment into 'buffer'
+    void readSegment(size_t imageSeg,
+                     nitf::SubWindow& subWindow,
+                     size_t numBytesPerPixel,
+                     size_t numThreads,
+                     nitf::Uint8* buffer);
+
+    /*!
+     *  Reads a decimated region of an image or one of its pyramid levels.
+     *  The region must already be validated against the level's size.
+     */
+    UByte* readDecimated(Region& region, size_t imageNumber, size_t level);
+
+    //! \return The image segment of a pyramid level of an image
+    size_t getPyramidLevelSegment(size_t imageNumber, size_t level) const;
+
     std::auto_ptr<Legend> findLegend(size_t productNum);
 
     void readLegendPixelData(nitf::ImageSubheader& subheader,
@@ -224,11 +399,57 @@ private:
         return (iCat == "LEG");
     }
 
+    static
+    bool isPyramidLevel(nitf::ImageSubheader& subheader)
+    {
+        // Reduced resolution levels have an IMAG of "/2", "/4", etc.
+        std::string iMag = subheader.getImageMagnification().toString();
+        str::trim(iMag);
+
+        return (!iMag.empty() && iMag[0] == '/');
+    }
+
     // We need this for one of the load overloadings
     // to prevent data from being deleted prematurely
     // The issue occurs from the explicit destructor of
     // IOControl
     mem::SharedPtr<nitf::IOInterface> mInterface;
+
+    // The file, if it was loaded by pathname and isn't mapped.  Concurrent
+    // readers use it for positional reads, so it's opened by the first one.
+    std::string mFilePathname;
+    std::auto_ptr<sys::File> mFile;
+
+    // mInterface if it's memory mapped
+    const MemoryMappedIO* mMappedIO;
+
+    // Where an image segment's pixels are in the mapping
+    struct MappedSegment
+    {
+        MappedSegment() :
+            pixels(NULL),
+            numCols(0),
+            numBytesPerPixel(0),
+            elementSize(0)
+        {
+        }
+
+        // NULL if the segment has to be read through NITRO
+        const sys::ubyte* pixels;
+        size_t numCols;
+        size_t numBytesPerPixel;
+        size_t elementSize;
+    };
+
+    // Indexed by image segment
+    std::vector<MappedSegment> mMappedSegments;
+
+    // Serializes concurrent readers' access to mInterface
+    sys::Mutex mInterfaceMutex;
+
+    // Readers that aren't in use
+    std::vector<ConcurrentReader*> mConcurrentReaders;
+    sys::Mutex mConcurrentReadersMutex;
 };
 
 
@@ -23,6 +23,7 @@
 #define __SIX_NITF_WRITE_CONTROL_H__
 
 #include <map>
+#include <memory>
 
 #include <mem/SharedPtr.h>
 #include "six/Types.h"
@@ -30,6 +31,7 @@
 #include "six/WriteControl.h"
 #include "six/NITFImageInfo.h"
 #include "six/Adapters.h"
+#include "six/PyramidBuilder.h"
 
 namespace six
 {
@@ -69,6 +71,64 @@ public:
     static const char OPT_NUM_ROWS_PER_BLOCK[];
     static const char OPT_NUM_COLS_PER_BLOCK[];
 
+    /*!
+     *  Number of threads used to encode J2K compressed image segments.
+     *  When it's more than 1, the blocks of the segment are encoded as
+     *  separate tiles in parallel a band of tile rows at a time and then
+     *  spliced together (see J2KWriteHandler).  Segments that can't be
+     *  split up that way are encoded serially by the NITRO plugin as
+     *  before, as is everything when SIX is built without J2K support.
+     *  Use 0 for one thread per CPU.  The default is 1.
+     */
+    static const char OPT_NUM_J2K_THREADS[];
+
+    /*!
+     *  Number of threads used to byte swap uncompressed image data as it's
+     *  written (see MemoryWriteHandler and StreamWriteHandler).  Use 0 for
+     *  one thread per CPU.  The default is 1.
+     */
+    static const char OPT_NUM_BYTE_SWAP_THREADS[];
+
+    /*!
+     *  Number of reduced resolution levels (an R-set) to write for each
+     *  SIDD image.  Each level is the one before it decimated by 2 in each
+     *  direction.  They're written as uncompressed image segments following
+     *  the image (and its legend, if any), attached to its first segment
+     *  and with IMAG set to "/2", "/4", etc.  Their IIDs carry on the
+     *  image's segment numbering, like a legend's.  All the levels are
+     *  built in the same pass over the image as it's written and held
+     *  until then, in memory or a scratch file (see
+     *  OPT_PYRAMID_MAX_MEMORY).  Levels that would be smaller than a pixel
+     *  are dropped.  The default is 0.
+     */
+    static const char OPT_NUM_PYRAMID_LEVELS[];
+
+    /*!
+     *  How the pyramid levels are decimated: "NEAREST_NEIGHBOR" (the
+     *  default) or "BRIGHTEST_PIXEL".  Images with a LUT always use
+     *  NEAREST_NEIGHBOR.
+     */
+    static const char OPT_PYRAMID_METHOD[];
+
+    /*!
+     *  Largest set of pyramid levels for an image, in bytes, that is held
+     *  in memory until it's written.  Bigger ones go to a scratch file in
+     *  OPT_PYRAMID_SCRATCH_DIRECTORY (the current directory by default).
+     *  The default is PyramidBuilder::DEFAULT_MAX_MEMORY.
+     */
+    static const char OPT_PYRAMID_MAX_MEMORY[];
+    static const char OPT_PYRAMID_SCRATCH_DIRECTORY[];
+
+    /*!
+     *  If nonzero, saving to a pathname writes through a DirectIO rather
+     *  than a nitf::BufferedWriter.  The page cache is bypassed, and up to
+     *  OPT_DIRECT_IO_QUEUE_DEPTH chunks of OPT_BUFFER_SIZE bytes are
+     *  written at once (the default depth is DirectIO::DEFAULT_QUEUE_DEPTH).
+     *  The default is 0.
+     */
+    static const char OPT_DIRECT_IO[];
+    static const char OPT_DIRECT_IO_QUEUE_DEPTH[];
+
     //!  Buffered IO
     static const size_t DEFAULT_BUFFER_SIZE;
 
@@ -359,6 +419,35 @@ protected:
 
     bool shouldByteSwap() const;
 
+    //! \return The IOInterface save() writes 'pathname' through
+    std::auto_ptr<nitf::IOInterface>
+    openOutputFile(const std::string& pathname) const;
+
+    /*!
+     *  \return The number of threads to encode 'subheader' with via
+     *  J2KWriteHandler, or 0 if it should go through the NITRO plugin
+     */
+    size_t getNumJ2KThreads(nitf::ImageSubheader subheader) const;
+
+    //! \return The number of threads to byte swap image data with
+    size_t getNumByteSwapThreads() const;
+
+    //! \return A builder for the pyramid levels of 'info'
+    std::auto_ptr<PyramidBuilder>
+    createPyramidBuilder(const NITFImageInfo& info) const;
+
+    /*!
+     *  Writes the pyramid levels of 'info' out of 'builder', which must be
+     *  complete by the time the levels' image segments are written.  The
+     *  streams the levels are read from are added to 'levelStreams', which
+     *  has to stick around until then too.
+     */
+    void setPyramidWriteHandlers(
+            const NITFImageInfo& info,
+            PyramidBuilder& builder,
+            bool doByteSwap,
+            std::vector<mem::SharedPtr<io::InputStream> >& levelStreams);
+
 private:
     static
     std::string getDesTypeID(const six::Data& data);
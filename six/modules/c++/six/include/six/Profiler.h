@@ -0,0 +1,215 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_PROFILER_H__
+#define __SIX_PROFILER_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/AtomicCounter.h>
+#include <sys/Conf.h>
+#include <sys/Mutex.h>
+#include <sys/StopWatch.h>
+#include <mt/Singleton.h>
+#include <logging/Logger.h>
+
+namespace six
+{
+/*!
+ *  \struct ProfileStats
+ *  \brief Accumulated timing and byte counts for one named stage
+ */
+struct ProfileStats
+{
+    ProfileStats();
+
+    //! Folds in another set of stats for the same stage
+    void merge(const ProfileStats& other);
+
+    std::string name;
+    size_t numCalls;
+    double totalSeconds;
+    double minSeconds;
+    double maxSeconds;
+    sys::Uint64_T numBytes;
+};
+
+/*!
+ *  \class Profiler
+ *  \brief Collects per-stage timers and byte counters from the read and
+ *  write controls
+ *
+ *  Each thread accumulates into its own set of counters, found through
+ *  thread-local storage, so threads only contend when a thread is seen for
+ *  the first time, when it exits, or when the stats are queried.  When a
+ *  thread exits, its counters are folded into the totals and dropped.
+ *  Stage names are expected to be string literals (they're keyed by pointer
+ *  on the hot path and only compared by value when queried).
+ *
+ *  Instrumentation goes through the SIX_PROFILE_* macros below, which compile
+ *  to nothing when SIX_DISABLE_PROFILING is defined.  At runtime, profiling
+ *  is off until it's turned on via setEnabled().
+ */
+class Profiler
+{
+public:
+    Profiler();
+
+    ~Profiler();
+
+    //! Safe to call while instrumented threads are running
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const
+    {
+        return mEnabled.get() != 0;
+    }
+
+    //! Adds one call of 'name' that took 'seconds'
+    void addTime(const char* name, double seconds);
+
+    //! Adds 'numBytes' to the byte count of 'name'
+    void addBytes(const char* name, sys::Uint64_T numBytes);
+
+    //! \return Stats for each stage summed over all threads, sorted by name
+    std::vector<ProfileStats> getStats() const;
+
+    /*!
+     *  \return Stats for each stage keyed by thread ID.  Only threads that
+     *  are still running are included; getStats() includes the rest.
+     */
+    std::map<long, std::vector<ProfileStats> > getStatsByThread() const;
+
+    //! Clears all the counters
+    void reset();
+
+    //! \return A table of the stats summed over all threads
+    std::string toString() const;
+
+    //! Writes toString() to the log at INFO
+    void dump(logging::Logger& log) const;
+
+private:
+    struct NameLess
+    {
+        bool operator()(const char* lhs, const char* rhs) const;
+    };
+
+    typedef std::map<const char*, ProfileStats> StatsMap;
+    typedef std::map<const char*, ProfileStats, NameLess> MergedStatsMap;
+
+    struct ThreadStats
+    {
+        Profiler* profiler;
+        long threadID;
+        sys::Mutex mutex;
+        StatsMap stats;
+    };
+
+    typedef std::vector<ThreadStats*> ThreadList;
+
+    //! Platform-specific thread-local storage slot
+    struct ThreadKey;
+
+    ThreadStats& getThreadStats();
+
+    //! Called on thread exit to fold the thread's stats into mExitedStats
+    static void releaseThreadStats(void* threadStats);
+
+    static void addStats(const StatsMap& stats, MergedStatsMap& all);
+
+private:
+    // Noncopyable
+    Profiler(const Profiler& );
+    const Profiler& operator=(const Profiler& );
+
+private:
+    //! 1 when enabled.  Atomic, since it's read on every instrumented call.
+    sys::AtomicCounter mEnabled;
+    ThreadKey* mThreadKey;
+    mutable sys::Mutex mMutex;
+    ThreadList mThreads;
+    MergedStatsMap mExitedStats;
+};
+
+typedef mt::Singleton<Profiler, true> ProfilerSingleton;
+
+/*!
+ *  \class ScopedTimer
+ *  \brief Adds the time from construction to destruction to a stage
+ */
+class ScopedTimer
+{
+public:
+    ScopedTimer(const char* name) :
+        mName(ProfilerSingleton::getInstance().isEnabled() ? name : NULL)
+    {
+        if (mName)
+        {
+            mStopWatch.start();
+        }
+    }
+
+    ~ScopedTimer()
+    {
+        if (mName)
+        {
+            ProfilerSingleton::getInstance().addTime(
+                    mName, mStopWatch.stop() / 1000.0);
+        }
+    }
+
+private:
+    const char* const mName;
+    sys::RealTimeStopWatch mStopWatch;
+};
+}
+
+#define SIX_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SIX_PROFILE_CONCAT(a, b) SIX_PROFILE_CONCAT_IMPL(a, b)
+
+#ifndef SIX_DISABLE_PROFILING
+/*!
+ *  Times the rest of the enclosing scope as the stage 'name'
+ */
+#define SIX_PROFILE_SCOPE(name) \
+    const six::ScopedTimer SIX_PROFILE_CONCAT(sixScopedTimer, __LINE__)(name)
+
+/*!
+ *  Adds 'numBytes' to the byte count of the stage 'name'
+ */
+#define SIX_PROFILE_BYTES(name, numBytes) \
+    do \
+    { \
+        six::Profiler& sixProfiler(six::ProfilerSingleton::getInstance()); \
+        if (sixProfiler.isEnabled()) \
+        { \
+            sixProfiler.addBytes(name, numBytes); \
+        } \
+    } while (0)
+#else
+#define SIX_PROFILE_SCOPE(name)
+#define SIX_PROFILE_BYTES(name, numBytes) do {} while (0)
+#endif
+
+#endif
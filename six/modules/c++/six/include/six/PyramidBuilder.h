@@ -0,0 +1,257 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_PYRAMID_BUILDER_H__
+#define __SIX_PYRAMID_BUILDER_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <io/InputStream.h>
+#include <io/TempFile.h>
+#include <sys/File.h>
+#include <types/RowCol.h>
+#include <import/nitf.hpp>
+#include <six/Types.h>
+
+namespace six
+{
+/*!
+ *  \class PyramidBuilder
+ *  \brief Builds a reduced resolution pyramid (an R-set) from an image as
+ *  its rows stream by
+ *
+ *  Level 1 is the image decimated by 2 in each direction, level 2 is level 1
+ *  decimated by 2, and so on.  Every level is computed in the same pass: as
+ *  each pair of full resolution rows arrives, a row of level 1 is produced,
+ *  which in turn completes rows of level 2 and so on.  The levels (about a
+ *  third of the size of the image) are kept in memory unless they'd need
+ *  more than maxMemory bytes, in which case each row goes to a scratch file
+ *  as it's done.  Beyond that, only a pair of rows of each level and of the
+ *  full resolution image are held onto.
+ *
+ *  Decimation is done with NITRO's down samplers.  NEAREST_NEIGHBOR uses
+ *  nitf::PixelSkip and BRIGHTEST_PIXEL uses nitf::MaxDownSample.  Only
+ *  single band integer pixels of 1 or 2 bytes are supported.
+ */
+class PyramidBuilder
+{
+public:
+    //! Largest set of levels, in bytes, that is kept in memory by default
+    static const size_t DEFAULT_MAX_MEMORY;
+
+    /*!
+     *  \param dims Full resolution dimensions of the image
+     *  \param numBytesPerPixel Bytes per pixel (1 or 2)
+     *  \param numLevels Number of levels to build (not counting the full
+     *  resolution image).  This is clamped to getMaxNumLevels().
+     *  \param method NEAREST_NEIGHBOR or BRIGHTEST_PIXEL
+     *  \param maxMemory Largest set of levels, in bytes, that is kept in
+     *  memory.  Anything bigger goes to a scratch file.
+     *  \param scratchDirectory Directory for the scratch file
+     */
+    PyramidBuilder(const types::RowCol<size_t>& dims,
+                   size_t numBytesPerPixel,
+                   size_t numLevels,
+                   DecimationMethod method,
+                   size_t maxMemory = DEFAULT_MAX_MEMORY,
+                   const std::string& scratchDirectory = ".");
+
+    //! \return The dimensions of 'level' of an image of size 'dims'
+    static types::RowCol<size_t>
+    getLevelDims(const types::RowCol<size_t>& dims, size_t level);
+
+    //! \return The number of levels until the image is down to one pixel
+    static size_t getMaxNumLevels(const types::RowCol<size_t>& dims);
+
+    /*!
+     *  Adds full resolution rows, which must arrive in order
+     *
+     *  \param rows Rows to add
+     *  \param numRows Number of rows
+     */
+    void addRows(const UByte* rows, size_t numRows);
+
+    /*!
+     *  Adds full resolution pixels, which must arrive in order but needn't
+     *  fall on row boundaries.  This is what lets a stream be decimated as
+     *  it's read.
+     *
+     *  \param data Pixels to add
+     *  \param numBytes Number of bytes
+     */
+    void addBytes(const UByte* data, size_t numBytes);
+
+    //! \return True once every full resolution row has been added
+    bool isComplete() const
+    {
+        return mNumRowsAdded == mDims.row;
+    }
+
+    size_t getNumLevels() const
+    {
+        return mLevels.size();
+    }
+
+    //! \param level 1-based level
+    types::RowCol<size_t> getLevelDims(size_t level) const
+    {
+        return getLevelDims(mDims, level);
+    }
+
+    //! \return True if the levels went to a scratch file
+    bool isScratchFileUsed() const
+    {
+        return mFile.get() != NULL;
+    }
+
+    //! \param level 1-based level
+    //! \return Size of the level in bytes
+    size_t getLevelSize(size_t level) const;
+
+    /*!
+     *  Reads pixels of a level.  They can only be read once their rows have
+     *  been produced, which for all of them is once isComplete() is true.
+     *
+     *  \param level 1-based level
+     *  \param offset Byte offset into the level
+     *  \param numBytes Number of bytes to read
+     *  \param buffer Buffer to read into
+     */
+    void readLevel(size_t level,
+                   size_t offset,
+                   size_t numBytes,
+                   UByte* buffer);
+
+private:
+    struct Level
+    {
+        types::RowCol<size_t> dims;
+        size_t rowSize;
+
+        // Where the level starts in mMemory or the scratch file
+        sys::Uint64_T offset;
+
+        // The last pair of rows produced, which make the next level's row
+        std::vector<UByte> window;
+        size_t numRowsDone;
+    };
+
+    // Throws if 'level' isn't a 1-based level we have
+    void checkLevel(size_t level) const;
+
+    // Decimates one or two rows of an image 'numCols' wide into 'output'
+    void decimateRow(const UByte* input,
+                     size_t numInputRows,
+                     size_t numCols,
+                     UByte* output);
+
+    // Produces the next row of 'level' from one or two rows of the level
+    // above it ('numInputCols' wide), and so on down the levels
+    void addLevelRow(size_t level,
+                     const UByte* input,
+                     size_t numInputRows,
+                     size_t numInputCols);
+
+private:
+    const types::RowCol<size_t> mDims;
+    const size_t mNumBytesPerPixel;
+    const size_t mRowSize;
+    std::auto_ptr<nitf::DownSampler> mDownSampler;
+
+    // Full resolution bytes waiting on the rest of their row pair
+    std::vector<UByte> mPending;
+    size_t mNumRowsAdded;
+
+    // mLevels[ii] is level ii + 1
+    std::vector<Level> mLevels;
+
+    // Every level back to back, in one or the other.  The file has to
+    // close before the temp file removes it.
+    std::vector<UByte> mMemory;
+    std::auto_ptr<io::TempFile> mTempFile;
+    std::auto_ptr<sys::File> mFile;
+};
+
+/*!
+ *  \class PyramidInputStream
+ *  \brief Passes everything read from a stream on to a PyramidBuilder
+ *
+ *  This is used to build a pyramid while the full resolution image is being
+ *  written from an io::InputStream.
+ */
+class PyramidInputStream : public io::InputStream
+{
+public:
+    PyramidInputStream(io::InputStream& source, PyramidBuilder& builder) :
+        mSource(source),
+        mBuilder(builder)
+    {
+    }
+
+    virtual sys::Off_T available()
+    {
+        return mSource.available();
+    }
+
+    virtual sys::SSize_T read(sys::byte* b, sys::Size_T len);
+
+private:
+    io::InputStream& mSource;
+    PyramidBuilder& mBuilder;
+};
+
+/*!
+ *  \class PyramidLevelInputStream
+ *  \brief Reads a level of a PyramidBuilder from start to end
+ *
+ *  This is used to write the level once the builder is complete, wherever
+ *  the builder is keeping it.
+ */
+class PyramidLevelInputStream : public io::InputStream
+{
+public:
+    //! \param level 1-based level
+    PyramidLevelInputStream(PyramidBuilder& builder, size_t level) :
+        mBuilder(builder),
+        mLevel(level),
+        mNumBytes(builder.getLevelSize(level)),
+        mOffset(0)
+    {
+    }
+
+    virtual sys::Off_T available()
+    {
+        return static_cast<sys::Off_T>(mNumBytes - mOffset);
+    }
+
+    virtual sys::SSize_T read(sys::byte* b, sys::Size_T len);
+
+private:
+    PyramidBuilder& mBuilder;
+    const size_t mLevel;
+    const size_t mNumBytes;
+    size_t mOffset;
+};
+}
+
+#endif
@@ -42,19 +42,46 @@ namespace six
  *
  *  Returned data is always component-interleaved.
  *
+ *  A region can also be decimated, in which case the start and size are
+ *  still given in full resolution pixels but each rowDecimation x
+ *  colDecimation window of them is reduced to one pixel, so the buffer
+ *  holds ceil(numRows / rowDecimation) x ceil(numCols / colDecimation)
+ *  pixels.
  *
  */
 class Region
 {
+public:
+    /*!
+     *  How a window of pixels is reduced to one when decimating
+     *
+     *  PIXEL_SKIP keeps the upper left pixel of each window, so only the
+     *  rows that are kept are read.  MAX keeps the largest value of each
+     *  band in the window.  SUM_SQUARES is for complex data, keeping the
+     *  sample in the window with the largest magnitude (I^2 + Q^2).
+     */
+    enum DecimationType
+    {
+        PIXEL_SKIP,
+        MAX,
+        SUM_SQUARES
+    };
+
+private:
     UByte* mBuffer;
     sys::SSize_T startRow;
     sys::SSize_T numRows;
     sys::SSize_T startCol;
     sys::SSize_T numCols;
+    size_t rowDecimation;
+    size_t colDecimation;
+    DecimationType decimationType;
+
 public:
     //!  Constructor.  Sets params for full window size, and buffer is NULL
     Region() :
-        mBuffer(NULL), startRow(0), numRows(-1), startCol(0), numCols(-1)
+        mBuffer(NULL), startRow(0), numRows(-1), startCol(0), numCols(-1),
+        rowDecimation(1), colDecimation(1), decimationType(PIXEL_SKIP)
     {
     }
 
@@ -141,6 +168,40 @@ public:
         return numCols;
     }
 
+    /*!
+     *  Decimate the region by 'rowFactor' in rows and 'colFactor' in
+     *  columns.  Factors of 1 (the default) read at full resolution.
+     */
+    void setDecimation(size_t rowFactor,
+                       size_t colFactor,
+                       DecimationType type = PIXEL_SKIP)
+    {
+        rowDecimation = rowFactor;
+        colDecimation = colFactor;
+        decimationType = type;
+    }
+
+    size_t getRowDecimation() const
+    {
+        return rowDecimation;
+    }
+
+    size_t getColDecimation() const
+    {
+        return colDecimation;
+    }
+
+    DecimationType getDecimationType() const
+    {
+        return decimationType;
+    }
+
+    //! \return True if the region is decimated in either direction
+    bool isDecimated() const
+    {
+        return (rowDecimation != 1 || colDecimation != 1);
+    }
+
     /*!
      *  Get the buffer.  Before a read has been done, this may be NULL,
      *  depending on if the user has initialized the buffer using the
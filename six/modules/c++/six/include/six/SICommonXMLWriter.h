@@ -0,0 +1,199 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SI_COMMON_XML_WRITER_H__
+#define __SIX_SI_COMMON_XML_WRITER_H__
+
+#include <string>
+
+#include <six/Types.h>
+#include <six/Parameter.h>
+#include <six/ParameterCollection.h>
+#include <six/ErrorStatistics.h>
+#include <six/Radiometric.h>
+#include <six/XMLStreamWriter.h>
+
+namespace six
+{
+/*!
+ *  \class SICommonXMLWriter
+ *  \brief Streaming counterpart of SICommonXMLParser's XML creation
+ *
+ *  Each write method emits exactly what the SICommonXMLParser (or
+ *  XMLParser) create method of the same name adds to the DOM, so the
+ *  product writers built on top of this produce the same bytes as the
+ *  parsers' toXML() followed by print().
+ *
+ *  Namespaces are given as the prefix the DOM ends up printing once the
+ *  root's namespace prefixes are set: empty for the default namespace,
+ *  getSICommonPrefix() for SI Common.
+ */
+class SICommonXMLWriter
+{
+public:
+    /*!
+     *  \param writer              Where the XML goes
+     *  \param addClassAttributes  Whether typed elements get the
+     *                             'class="xs:..."' attributes that SICD 0.4
+     *                             calls for
+     *  \param siCommonPrefix      Prefix for SI Common elements, including
+     *                             the colon (or empty)
+     */
+    SICommonXMLWriter(XMLStreamWriter& writer,
+                      bool addClassAttributes,
+                      const std::string& siCommonPrefix);
+
+    virtual ~SICommonXMLWriter();
+
+    XMLStreamWriter& getWriter() const
+    {
+        return mWriter;
+    }
+
+    const std::string& getSICommonPrefix() const
+    {
+        return mSICommonPrefix;
+    }
+
+    void startElement(const std::string& name,
+                      const std::string& prefix = std::string())
+    {
+        mWriter.startElement(name, prefix);
+    }
+
+    void endElement()
+    {
+        mWriter.endElement();
+    }
+
+    /*!
+     *  Starts an element the way the typed create methods do, adding the
+     *  class attribute for type (e.g. "xs:double") if called for.  Further
+     *  attributes and the character data are up to the caller.
+     */
+    void startTypedElement(const std::string& name,
+                           const std::string& prefix,
+                           const std::string& type);
+
+    void writeString(const std::string& name, const std::string& value);
+    void writeString(const std::string& name, const std::string& prefix,
+                     const std::string& value);
+
+    void writeInt(const std::string& name, int value);
+    void writeInt(const std::string& name, const std::string& prefix,
+                  int value);
+
+    void writeDouble(const std::string& name, double value);
+    void writeDouble(const std::string& name, const std::string& prefix,
+                     double value);
+
+    //! Writes nothing for NOT_SET, returning whether anything was written
+    bool writeBooleanType(const std::string& name, BooleanType value);
+    bool writeBooleanType(const std::string& name, const std::string& prefix,
+                          BooleanType value);
+
+    void writeDateTime(const std::string& name, const DateTime& value);
+    void writeDateTime(const std::string& name, const std::string& value);
+
+    void writeComplex(const std::string& name, std::complex<double> value);
+
+    void writeVector3D(const std::string& name, const Vector3& value);
+    void writeVector3D(const std::string& name, const std::string& prefix,
+                       const Vector3& value);
+
+    void writeRowCol(const std::string& name, const std::string& prefix,
+                     const std::string& rowName, const std::string& colName,
+                     const RowColInt& value);
+    void writeRowCol(const std::string& name, const std::string& rowName,
+                     const std::string& colName, const RowColInt& value);
+    void writeRowCol(const std::string& name, const std::string& prefix,
+                     const RowColInt& value);
+    void writeRowCol(const std::string& name, const RowColInt& value);
+
+    void writeRowCol(const std::string& name, const std::string& prefix,
+                     const std::string& rowName, const std::string& colName,
+                     const RowColDouble& value);
+    void writeRowCol(const std::string& name, const std::string& rowName,
+                     const std::string& colName, const RowColDouble& value);
+    void writeRowCol(const std::string& name, const std::string& prefix,
+                     const RowColDouble& value);
+    void writeRowCol(const std::string& name, const RowColDouble& value);
+
+    void writeRowCol(const std::string& name, const RowColLatLon& value);
+
+    //! Writes a vertex, which carries an index attribute
+    void writeRowCol(const std::string& name, const RowColInt& value,
+                     const std::string& index);
+
+    void writeRangeAzimuth(const std::string& name,
+                           const types::RgAz<double>& value);
+
+    void writeLatLon(const std::string& name, const LatLon& value);
+    void writeLatLonAlt(const std::string& name, const LatLonAlt& value);
+
+    //! Writes a footprint corner, which carries an index attribute
+    void writeLatLon(const std::string& name, const LatLon& value,
+                     const std::string& index);
+    void writeLatLonAlt(const std::string& name, const LatLonAlt& value,
+                        const std::string& index);
+
+    void writePoly1D(const std::string& name, const Poly1D& value);
+    void writePoly1D(const std::string& name, const std::string& prefix,
+                     const Poly1D& value);
+
+    void writePoly2D(const std::string& name, const Poly2D& value);
+    void writePoly2D(const std::string& name, const std::string& prefix,
+                     const Poly2D& value);
+
+    void writePolyXYZ(const std::string& name, const PolyXYZ& value);
+    void writePolyXYZ(const std::string& name, const PolyXYZ& value,
+                      const std::string& index);
+
+    void writeParameter(const std::string& name, const Parameter& value);
+    void writeParameter(const std::string& name, const std::string& prefix,
+                        const Parameter& value);
+
+    void writeParameters(const std::string& name,
+                         const ParameterCollection& values);
+    void writeParameters(const std::string& name, const std::string& prefix,
+                         const ParameterCollection& values);
+
+    //! Writes nothing unless both of the terms are defined
+    void writeDecorrType(const std::string& name, const std::string& prefix,
+                         const DecorrType& value);
+
+    void writeErrorStatistics(const ErrorStatistics& errorStatistics);
+
+    virtual void writeRadiometry(const Radiometric& radiometric) = 0;
+
+protected:
+    virtual void writeCompositeSCP(const ErrorStatistics& errorStatistics) = 0;
+
+    void writeLatLonFields(const LatLon& value);
+    void writePolyXYZFields(const PolyXYZ& value);
+
+    XMLStreamWriter& mWriter;
+    const bool mAddClassAttributes;
+    const std::string mSICommonPrefix;
+};
+}
+
+#endif
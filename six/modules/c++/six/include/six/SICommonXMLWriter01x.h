@@ -0,0 +1,44 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SI_COMMON_XML_WRITER_01X_H__
+#define __SIX_SI_COMMON_XML_WRITER_01X_H__
+
+#include <six/SICommonXMLWriter.h>
+
+namespace six
+{
+//! Streaming counterpart of SICommonXMLParser01x
+class SICommonXMLWriter01x : public SICommonXMLWriter
+{
+public:
+    SICommonXMLWriter01x(XMLStreamWriter& writer,
+                         bool addClassAttributes,
+                         const std::string& siCommonPrefix);
+
+    virtual void writeRadiometry(const Radiometric& radiometric);
+
+protected:
+    virtual void writeCompositeSCP(const ErrorStatistics& errorStatistics);
+};
+}
+
+#endif
@@ -0,0 +1,90 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SHARED_IO_VIEW_H__
+#define __SIX_SHARED_IO_VIEW_H__
+
+#include <sys/File.h>
+#include <sys/Mutex.h>
+#include <nitf/CustomIO.hpp>
+
+namespace six
+{
+/*!
+ *  \class SharedIOView
+ *  \brief Read-only view of an IOInterface that is shared between threads
+ *
+ *  Each view keeps its own file position, and every read seeks the shared
+ *  IOInterface and reads from it while holding the mutex.  This lets
+ *  several NITRO readers (and their decompressors) work out of the same
+ *  file at once.  Nothing else may use the shared IOInterface while views
+ *  of it are in use, and it must outlive them.
+ *
+ *  Views of a sys::File instead use positional reads of its descriptor,
+ *  so they don't need a mutex and never wait on each other.
+ */
+class SharedIOView : public nitf::CustomIO
+{
+public:
+    /*!
+     *  \param io The IOInterface to share
+     *  \param mutex Serializes access to 'io'.  The same mutex must be
+     *  used for every view of 'io'.
+     */
+    SharedIOView(nitf::IOInterface& io, sys::Mutex& mutex);
+
+    /*!
+     *  \param file The file to share.  It must be open for reading and
+     *  outlive the view.
+     */
+    SharedIOView(sys::File& file);
+
+private:
+    void readImpl(void* buffer, size_t size);
+
+    // Reads from the file at the view's position
+    void readAt(void* buffer, size_t size);
+
+    void writeImpl(const void* buffer, size_t size);
+
+    bool canSeekImpl() const;
+
+    nitf::Off seekImpl(nitf::Off offset, int whence);
+
+    nitf::Off tellImpl() const;
+
+    nitf::Off getSizeImpl() const;
+
+    int getModeImpl() const;
+
+    void closeImpl();
+
+private:
+    // Either an IOInterface and its mutex, or a file
+    nitf::IOInterface* const mIO;
+    sys::Mutex* const mMutex;
+    sys::File* const mFile;
+    nitf::Off mSize;
+    nitf::Off mOffset;
+};
+}
+
+#endif
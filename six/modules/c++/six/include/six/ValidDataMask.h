@@ -0,0 +1,161 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_VALID_DATA_MASK_H__
+#define __SIX_VALID_DATA_MASK_H__
+
+#include <vector>
+
+#include "six/Types.h"
+
+namespace six
+{
+/*!
+ *  \class ValidDataMask
+ *  \brief Scanline rasterization of a valid data polygon
+ *
+ *  Converts a valid data polygon (in row/col pixel space, as found in
+ *  ImageData::validData or provided by sicd::Utilities::getValidDataPolygon)
+ *  into a compact list of [start, end) column spans for each row.  Pixels
+ *  on the polygon boundary are considered valid.  The vertices may be in
+ *  either clockwise or counterclockwise order; the even-odd rule is used to
+ *  decide what's inside.
+ */
+class ValidDataMask
+{
+public:
+    //! A run of valid pixels [start, end) within a single row
+    struct Span
+    {
+        Span() :
+            start(0),
+            end(0)
+        {
+        }
+
+        Span(size_t startCol, size_t endCol) :
+            start(startCol),
+            end(endCol)
+        {
+        }
+
+        size_t length() const
+        {
+            return end - start;
+        }
+
+        size_t start;
+        size_t end;
+    };
+
+    /*!
+     *  Rasterizes 'polygon' over an image of size 'dims'.  Anything outside
+     *  of the image is clipped.
+     *
+     *  \param polygon Vertices of the valid data polygon in row/col pixels.
+     *  If this is empty, the entire image is considered valid.
+     *  \param dims Number of rows/cols in the image
+     */
+    ValidDataMask(const std::vector<RowColDouble>& polygon,
+                  const types::RowCol<size_t>& dims);
+
+    //! Same as above but with integer vertices
+    ValidDataMask(const std::vector<RowColInt>& polygon,
+                  const types::RowCol<size_t>& dims);
+
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
+    //! \return The number of valid spans in 'row'
+    size_t getNumSpans(size_t row) const
+    {
+        return mRowOffsets[row + 1] - mRowOffsets[row];
+    }
+
+    //! \return The valid spans in 'row', sorted by start column
+    const Span* getSpans(size_t row) const
+    {
+        return mSpans.empty() ? NULL : &mSpans[0] + mRowOffsets[row];
+    }
+
+    //! \return True if there are any valid pixels in 'row'
+    bool isRowValid(size_t row) const
+    {
+        return getNumSpans(row) != 0;
+    }
+
+    //! \return True if the pixel at (row, col) is valid
+    bool isValid(size_t row, size_t col) const;
+
+    //! \return The total number of valid pixels in the image
+    size_t getNumValidPixels() const
+    {
+        return mNumValidPixels;
+    }
+
+    /*!
+     *  Computes the column extent of the valid data in a block of rows,
+     *  clipped to [startCol, startCol + numCols)
+     *
+     *  \param startRow First row of the block
+     *  \param numRows Number of rows in the block
+     *  \param startCol First column of interest
+     *  \param numCols Number of columns of interest
+     *  \param firstValidRow [output] First row of the block with valid data
+     *  \param lastValidRow [output] Last row of the block with valid data
+     *  \param colSpan [output] Union of the valid columns in the block
+     *
+     *  \return False if no pixels in the block are valid
+     */
+    bool getBlockExtent(size_t startRow,
+                        size_t numRows,
+                        size_t startCol,
+                        size_t numCols,
+                        size_t& firstValidRow,
+                        size_t& lastValidRow,
+                        Span& colSpan) const;
+
+    /*!
+     *  Fills a byte mask for a window of the image with 1 for valid pixels
+     *  and 0 for invalid ones
+     *
+     *  \param offset Upper-left pixel of the window
+     *  \param extent Number of rows/cols in the window
+     *  \param mask [output] Row-major buffer of extent.area() bytes
+     */
+    void getMask(const types::RowCol<size_t>& offset,
+                 const types::RowCol<size_t>& extent,
+                 UByte* mask) const;
+
+private:
+    void rasterize(const std::vector<RowColDouble>& polygon);
+
+private:
+    const types::RowCol<size_t> mDims;
+    std::vector<size_t> mRowOffsets;
+    std::vector<Span> mSpans;
+    size_t mNumValidPixels;
+};
+}
+
+#endif
@@ -0,0 +1,94 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_VALID_DATA_READER_H__
+#define __SIX_VALID_DATA_READER_H__
+
+#include <vector>
+
+#include "six/NITFReadControl.h"
+#include "six/Region.h"
+#include "six/ValidDataMask.h"
+
+namespace six
+{
+/*!
+ *  \class ValidDataReader
+ *  \brief Reads a region of an image, skipping pixels outside of the valid
+ *  data polygon
+ *
+ *  The region is processed in blocks of rows.  For each block, only the
+ *  bounding window of its valid spans is read through NITFReadControl;
+ *  rows and columns outside of that window are never read.  Every invalid
+ *  pixel in the output is set to a constant fill value.
+ */
+class ValidDataReader
+{
+public:
+    static const size_t DEFAULT_BLOCK_ROWS;
+
+    /*!
+     *  \param reader Loaded reader
+     *  \param mask Valid data mask.  Its dimensions must match the image.
+     *  \param imageNumber Image to read
+     *  \param blockRows Number of rows to process at a time.  Smaller blocks
+     *  track the polygon more closely at the cost of more reads.
+     */
+    ValidDataReader(NITFReadControl& reader,
+                    const ValidDataMask& mask,
+                    size_t imageNumber = 0,
+                    size_t blockRows = DEFAULT_BLOCK_ROWS);
+
+    /*!
+     *  Reads 'region' the same way NITFReadControl::interleaved() does,
+     *  except that invalid pixels are filled rather than read
+     *
+     *  \param region Region to read.  If its buffer is NULL, one is
+     *  allocated that the caller must delete[].
+     *  \param fillValue Bytes for a single pixel to use as the fill value.
+     *  If NULL, invalid pixels are zeroed.
+     *
+     *  \return The buffer holding the region
+     */
+    UByte* interleaved(Region& region, const UByte* fillValue = NULL);
+
+    //! \return The number of pixels actually read from the file so far
+    size_t getNumPixelsRead() const
+    {
+        return mNumPixelsRead;
+    }
+
+private:
+    void fill(UByte* output, size_t numPixels) const;
+
+private:
+    NITFReadControl& mReader;
+    const ValidDataMask& mMask;
+    const size_t mImageNumber;
+    const size_t mBlockRows;
+    const size_t mNumBytesPerPixel;
+    std::vector<UByte> mFillValue;
+    std::vector<UByte> mScratch;
+    size_t mNumPixelsRead;
+};
+}
+
+#endif
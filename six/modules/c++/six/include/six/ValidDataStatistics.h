@@ -0,0 +1,385 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_VALID_DATA_STATISTICS_H__
+#define __SIX_VALID_DATA_STATISTICS_H__
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <sys/Runnable.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include "six/ValidDataMask.h"
+
+namespace six
+{
+/*!
+ *  \struct ValidDataStatistics
+ *  \brief Statistics computed over only the valid pixels of an image
+ *
+ *  For complex pixels, statistics are of the magnitude.  NaN and infinite
+ *  values are left out of the statistics and only counted.
+ */
+struct ValidDataStatistics
+{
+    ValidDataStatistics() :
+        numValidPixels(0),
+        numNonFinitePixels(0),
+        mean(0.0),
+        min(0.0),
+        max(0.0),
+        binWidth(0.0)
+    {
+    }
+
+    /*!
+     *  Estimates a percentile from the histogram by interpolating within
+     *  the bin that contains it, so it's accurate to within binWidth.
+     *
+     *  \param percent Percentile in [0, 100]
+     */
+    double getPercentile(double percent) const;
+
+    //! Number of valid pixels with finite values
+    size_t numValidPixels;
+
+    //! Number of valid pixels that were NaN or infinite
+    size_t numNonFinitePixels;
+
+    double mean;
+    double min;
+    double max;
+
+    //! Evenly spaced bins over [min, max]
+    std::vector<size_t> histogram;
+    double binWidth;
+};
+
+inline double toStatisticValue(double value)
+{
+    return value;
+}
+
+template <typename T>
+inline double toStatisticValue(T value)
+{
+    return static_cast<double>(value);
+}
+
+template <typename T>
+inline double toStatisticValue(const std::complex<T>& value)
+{
+    return std::abs(std::complex<double>(value.real(), value.imag()));
+}
+
+namespace detail
+{
+inline bool isFinite(double value)
+{
+    // NaN compares unequal to itself
+    return value == value &&
+            std::abs(value) <= std::numeric_limits<double>::max();
+}
+
+template <typename PixelT>
+class ValidDataStatisticsRunnable : public sys::Runnable
+{
+public:
+    ValidDataStatisticsRunnable(const PixelT* image,
+                                const types::RowCol<size_t>& offset,
+                                const types::RowCol<size_t>& extent,
+                                const ValidDataMask& mask,
+                                size_t startRow,
+                                size_t numRows) :
+        mImage(image),
+        mOffset(offset),
+        mExtent(extent),
+        mMask(mask),
+        mStartRow(startRow),
+        mNumRows(numRows),
+        mHistogramPass(false),
+        mNumValidPixels(0),
+        mNumNonFinitePixels(0),
+        mSum(0.0),
+        mMin(std::numeric_limits<double>::max()),
+        mMax(-std::numeric_limits<double>::max()),
+        mHistMin(0.0),
+        mHistScale(0.0)
+    {
+    }
+
+    //! Switches this runnable to filling in a histogram on the next run()
+    void setHistogram(double min, double binWidth, size_t numBins)
+    {
+        mHistogramPass = true;
+        mHistMin = min;
+        mHistScale = (binWidth > 0.0) ? 1.0 / binWidth : 0.0;
+        mHistogram.assign(numBins, 0);
+    }
+
+    virtual void run()
+    {
+        const size_t endCol = mOffset.col + mExtent.col;
+        for (size_t row = mStartRow; row < mStartRow + mNumRows; ++row)
+        {
+            const size_t imageRow = mOffset.row + row;
+            const PixelT* const rowInput = mImage + row * mExtent.col;
+            const ValidDataMask::Span* const spans = mMask.getSpans(imageRow);
+            for (size_t ii = 0, numSpans = mMask.getNumSpans(imageRow);
+                 ii < numSpans;
+                 ++ii)
+            {
+                const size_t start = std::max(spans[ii].start, mOffset.col);
+                const size_t end = std::min(spans[ii].end, endCol);
+                for (size_t col = start; col < end; ++col)
+                {
+                    const double value =
+                            toStatisticValue(rowInput[col - mOffset.col]);
+                    if (!isFinite(value))
+                    {
+                        if (!mHistogramPass)
+                        {
+                            ++mNumNonFinitePixels;
+                        }
+                    }
+                    else if (mHistogramPass)
+                    {
+                        const size_t bin = std::min(
+                                static_cast<size_t>(
+                                        (value - mHistMin) * mHistScale),
+                                mHistogram.size() - 1);
+                        ++mHistogram[bin];
+                    }
+                    else
+                    {
+                        ++mNumValidPixels;
+                        mSum += value;
+                        mMin = std::min(mMin, value);
+                        mMax = std::max(mMax, value);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t getNumValidPixels() const
+    {
+        return mNumValidPixels;
+    }
+
+    size_t getNumNonFinitePixels() const
+    {
+        return mNumNonFinitePixels;
+    }
+
+    double getSum() const
+    {
+        return mSum;
+    }
+
+    double getMin() const
+    {
+        return mMin;
+    }
+
+    double getMax() const
+    {
+        return mMax;
+    }
+
+    const std::vector<size_t>& getHistogram() const
+    {
+        return mHistogram;
+    }
+
+private:
+    const PixelT* const mImage;
+    const types::RowCol<size_t> mOffset;
+    const types::RowCol<size_t> mExtent;
+    const ValidDataMask& mMask;
+    const size_t mStartRow;
+    const size_t mNumRows;
+    bool mHistogramPass;
+    size_t mNumValidPixels;
+    size_t mNumNonFinitePixels;
+    double mSum;
+    double mMin;
+    double mMax;
+    double mHistMin;
+    double mHistScale;
+    std::vector<size_t> mHistogram;
+};
+
+template <typename RunnableT>
+void runAll(std::vector<RunnableT*>& runnables)
+{
+    if (runnables.size() == 1)
+    {
+        runnables[0]->run();
+        return;
+    }
+
+    // The thread group takes ownership of what it runs, so wrap our
+    // runnables rather than handing them over
+    class Forwarder : public sys::Runnable
+    {
+    public:
+        Forwarder(sys::Runnable& runnable) :
+            mRunnable(runnable)
+        {
+        }
+
+        virtual void run()
+        {
+            mRunnable.run();
+        }
+
+    private:
+        sys::Runnable& mRunnable;
+    };
+
+    mt::ThreadGroup threads;
+    for (size_t ii = 0; ii < runnables.size(); ++ii)
+    {
+        std::auto_ptr<sys::Runnable> forwarder(
+                new Forwarder(*runnables[ii]));
+        threads.createThread(forwarder);
+    }
+    threads.joinAll();
+}
+}
+
+/*!
+ *  Computes statistics over the valid pixels of a window of an image
+ *
+ *  \param image Row-major window of pixels, as read by
+ *  NITFReadControl::interleaved() or ValidDataReader
+ *  \param offset Upper-left pixel of the window within the full image
+ *  \param extent Number of rows/cols in the window
+ *  \param mask Valid data mask for the full image
+ *  \param numBins Number of histogram bins.  If this is zero, no
+ *  histogram is computed.
+ *  \param numThreads Number of threads to use
+ *
+ *  \return The statistics
+ */
+template <typename PixelT>
+ValidDataStatistics computeValidDataStatistics(
+        const PixelT* image,
+        const types::RowCol<size_t>& offset,
+        const types::RowCol<size_t>& extent,
+        const ValidDataMask& mask,
+        size_t numBins = 256,
+        size_t numThreads = 1)
+{
+    typedef detail::ValidDataStatisticsRunnable<PixelT> RunnableT;
+
+    // Divide the rows up among threads
+    std::vector<RunnableT*> runnables;
+    const mt::ThreadPlanner planner(extent.row, std::max<size_t>(numThreads,
+                                                                 1));
+    size_t threadNum(0);
+    size_t startRow(0);
+    size_t numRowsThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startRow, numRowsThisThread))
+    {
+        runnables.push_back(new RunnableT(image, offset, extent, mask,
+                                          startRow, numRowsThisThread));
+    }
+
+    ValidDataStatistics stats;
+    try
+    {
+        // First pass gets the count, mean, and range
+        if (!runnables.empty())
+        {
+            detail::runAll(runnables);
+        }
+
+        double sum(0.0);
+        stats.min = std::numeric_limits<double>::max();
+        stats.max = -std::numeric_limits<double>::max();
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            stats.numValidPixels += runnables[ii]->getNumValidPixels();
+            stats.numNonFinitePixels +=
+                    runnables[ii]->getNumNonFinitePixels();
+            sum += runnables[ii]->getSum();
+            stats.min = std::min(stats.min, runnables[ii]->getMin());
+            stats.max = std::max(stats.max, runnables[ii]->getMax());
+        }
+
+        if (stats.numValidPixels == 0)
+        {
+            stats.min = stats.max = 0.0;
+        }
+        else
+        {
+            stats.mean = sum / stats.numValidPixels;
+        }
+
+        if (stats.numValidPixels != 0 && numBins != 0)
+        {
+            // Second pass fills in the histogram
+            stats.binWidth = (stats.max - stats.min) / numBins;
+            for (size_t ii = 0; ii < runnables.size(); ++ii)
+            {
+                runnables[ii]->setHistogram(stats.min, stats.binWidth,
+                                            numBins);
+            }
+            detail::runAll(runnables);
+
+            stats.histogram.assign(numBins, 0);
+            for (size_t ii = 0; ii < runnables.size(); ++ii)
+            {
+                const std::vector<size_t>& histogram =
+                        runnables[ii]->getHistogram();
+                for (size_t bin = 0; bin < numBins; ++bin)
+                {
+                    stats.histogram[bin] += histogram[bin];
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            delete runnables[ii];
+        }
+        throw;
+    }
+
+    for (size_t ii = 0; ii < runnables.size(); ++ii)
+    {
+        delete runnables[ii];
+    }
+
+    return stats;
+}
+}
+
+#endif
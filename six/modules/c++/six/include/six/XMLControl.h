@@ -22,6 +22,7 @@
 #ifndef __SIX_XML_CONTROL_H__
 #define __SIX_XML_CONTROL_H__
 
+#include <io/OutputStream.h>
 #include <xml/lite/Document.h>
 #include <xml/lite/Validator.h>
 #include <logging/Logger.h>
@@ -51,6 +52,10 @@ namespace six
  *
  *  They can also be used to interact with an XML model or a stub XML
  *  file as well.
+ *
+ *  Validators for each set of schema paths are compiled once and reused
+ *  by every XMLControl in the process, so schema changes on disk aren't
+ *  seen until the process restarts.
  */
 class XMLControl
 {
@@ -73,6 +78,19 @@ public:
     xml::lite::Document* toXML(const Data* data,
                                const std::vector<std::string>& schemaPaths);
 
+    /*!
+     *  Write the Data model out as XML, the same as printing the root of
+     *  the DOM the other toXML() returns.  If there are schemas to validate
+     *  against, the XML is validated before anything is written to xmlStream.
+     *
+     *  \param data         Data structure
+     *  \param schemaPaths  Directories or files of schema locations
+     *  \param xmlStream    Stream to write the XML to
+     */
+    void toXML(const Data* data,
+               const std::vector<std::string>& schemaPaths,
+               io::OutputStream& xmlStream);
+
     /*!
      *  Convert a document from a DOM into a Data model
      *  \param doc          XML Document
@@ -106,6 +124,14 @@ protected:
      */
     virtual xml::lite::Document* toXMLImpl(const Data* data) = 0;
 
+    /*!
+     *  Write the Data model out as XML.  By default, this prints the DOM
+     *  from toXMLImpl(); implementors can override it to skip the DOM.
+     *  \param data       the Data model
+     *  \param xmlStream  Stream to write the XML to
+     */
+    virtual void toXMLImpl(const Data* data, io::OutputStream& xmlStream);
+
     static
     std::string getDefaultURI(const Data& data);
 
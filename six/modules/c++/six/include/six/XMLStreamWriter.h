@@ -0,0 +1,134 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_XML_STREAM_WRITER_H__
+#define __SIX_XML_STREAM_WRITER_H__
+
+#include <string>
+#include <vector>
+
+#include <io/OutputStream.h>
+
+namespace six
+{
+/*!
+ *  \class XMLStreamWriter
+ *  \brief Writes XML straight to an output stream without building a DOM
+ *
+ *  The output matches what xml::lite::Element::print() produces for the
+ *  same tree: no declaration, no whitespace between elements, attributes
+ *  in the order they're written, and elements with neither character data
+ *  nor children closed as "<name/>".  As with the DOM, nothing is escaped.
+ *
+ *  Character data has to come before an element's children and attributes
+ *  before either.  Output is staged in a buffer that's handed to the
+ *  stream each time it fills up, so callers must flush() once they're done.
+ *  If an exception is thrown part way through, whatever was already
+ *  flushed stays in the stream.
+ */
+class XMLStreamWriter
+{
+public:
+    static const size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    /*!
+     *  \param stream      Stream to write to.  Must outlive the writer.
+     *  \param bufferSize  Bytes to stage before writing to the stream
+     */
+    XMLStreamWriter(io::OutputStream& stream,
+                    size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    //! Opens an element, qualified by prefix (e.g. "si:") if non-empty
+    void startElement(const std::string& name,
+                      const std::string& prefix = std::string());
+
+    //! Adds an attribute to the element that was just started
+    void attribute(const std::string& name,
+                   const std::string& value,
+                   const std::string& prefix = std::string());
+
+    void attribute(const std::string& name, size_t value);
+
+    //! Sets the character data of the element that was just started
+    void characters(const std::string& text);
+
+    //! Writes a double the same way six::toString<double>() does
+    void characters(double value);
+
+    //! Writes an int the same way six::toString<int>() does
+    void characters(int value);
+
+    //! Closes the innermost open element
+    void endElement();
+
+    //! Writes out everything that's buffered
+    void flush();
+
+    /*!
+     *  Formats a double in scientific notation with 15 digits after the
+     *  decimal point and the exponent's '+' sign dropped, which is what
+     *  six::toString<double>() produces.  Throws if the value is undefined.
+     *
+     *  \param value   Value to format
+     *  \param buffer  At least 32 bytes
+     *  \return The number of characters written, not counting the null
+     */
+    static size_t formatDouble(double value, char* buffer);
+
+private:
+    void closeStartTag()
+    {
+        if (mStartTagOpen)
+        {
+            mBuffer += '>';
+            mStartTagOpen = false;
+        }
+    }
+
+    void checkStartTagOpen(const char* what) const;
+
+    void append(const char* str, size_t length)
+    {
+        mBuffer.append(str, length);
+    }
+
+    void flushIfFull()
+    {
+        if (mBuffer.size() >= mBufferSize)
+        {
+            flush();
+        }
+    }
+
+private:
+    io::OutputStream& mStream;
+    const size_t mBufferSize;
+    std::string mBuffer;
+
+    // Qualified names of the open elements.  Entries past mDepth are kept
+    // around so their capacity gets reused.
+    std::vector<std::string> mOpenElements;
+    size_t mDepth;
+    bool mStartTagOpen;
+};
+}
+
+#endif
@@ -19,7 +19,21 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <except/Exception.h>
+#include <sys/Conf.h>
+#include <sys/ConditionVar.h>
+#include <sys/Mutex.h>
+#include <sys/Runnable.h>
+#include <mt/CriticalSection.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
 #include "six/Adapters.h"
+#include "six/Profiler.h"
 
 using namespace six;
 
@@ -34,6 +48,344 @@ NITF_BOOL __six_MemoryWriteHandler_write(NITF_DATA * data,
         nitf_IOInterface* io, nitf_Error * error);
 }
 
+const size_t MemoryWriteHandler::DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+const size_t StreamWriteHandler::DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+
+namespace
+{
+void writeBytes(nitf_IOInterface* io, const UByte* data, size_t size)
+{
+    nitf_Error error;
+    if (!nitf_IOInterface_write(io, reinterpret_cast<const char*>(data),
+                                size, &error))
+    {
+        throw nitf::NITFException(&error);
+    }
+}
+
+void readBytes(io::InputStream& is, UByte* buffer, size_t numBytes)
+{
+    size_t numBytesRead(0);
+    while (numBytesRead < numBytes)
+    {
+        const sys::SSize_T bytesThisRead =
+                is.read(reinterpret_cast<sys::byte*>(buffer + numBytesRead),
+                        numBytes - numBytesRead);
+        if (bytesThisRead == io::InputStream::IS_EOF || bytesThisRead <= 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Input stream ended before the image segment did"));
+        }
+        numBytesRead += bytesThisRead;
+    }
+}
+
+/*
+ *  Shared state for writing one image segment a chunk of whole rows at a
+ *  time.  There are two scratch buffers: a set of workers, created once per
+ *  write, fills and swaps the next chunk in one while the caller writes the
+ *  other.  The first worker reads each chunk, since a stream has to be read
+ *  in order, and then every worker swaps its own share of it.
+ */
+class ChunkPipeline
+{
+public:
+    ChunkPipeline(const UByte* buffer,
+                  io::InputStream* inputStream,
+                  size_t numBytes,
+                  size_t numBytesPerChunk,
+                  size_t elemSize,
+                  bool doByteSwap,
+                  size_t numWorkers) :
+        mBuffer(buffer),
+        mInputStream(inputStream),
+        mNumBytes(numBytes),
+        mNumBytesPerChunk(numBytesPerChunk),
+        mNumChunks((numBytes + numBytesPerChunk - 1) / numBytesPerChunk),
+        mElemSize(elemSize),
+        mDoByteSwap(doByteSwap),
+        mNumWorkers(std::max<size_t>(numWorkers, 1)),
+        mChunkFilled(&mMutex),
+        mChunkWritten(&mMutex),
+        mNumRead(0),
+        mNumFilled(0),
+        mNumWritten(0),
+        mAborted(false)
+    {
+        mNumSwapsDone[0] = mNumSwapsDone[1] = 0;
+        mScratch[0].resize(std::min(mNumBytesPerChunk, mNumBytes));
+        mScratch[1].resize(mScratch[0].size());
+    }
+
+    size_t getNumChunks() const
+    {
+        return mNumChunks;
+    }
+
+    size_t getNumWorkers() const
+    {
+        return mNumWorkers;
+    }
+
+    //! Runs worker 'worker' of the set over every chunk
+    void fill(size_t worker)
+    {
+        try
+        {
+            for (size_t chunk = 0; chunk < mNumChunks; ++chunk)
+            {
+                if (!fillChunk(worker, chunk))
+                {
+                    return;
+                }
+            }
+        }
+        catch (...)
+        {
+            abort();
+            throw;
+        }
+    }
+
+    /*!
+     *  Blocks until 'chunk' is ready to write and returns it, or returns
+     *  NULL if a worker failed
+     */
+    const UByte* waitForChunk(size_t chunk)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        while (mNumFilled <= chunk && !mAborted)
+        {
+            mChunkFilled.wait();
+        }
+        return mAborted ? NULL : &mScratch[chunk % 2][0];
+    }
+
+    //! Hands the scratch buffer that 'chunk' was in back to the workers
+    void chunkWritten(size_t chunk)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mNumWritten = chunk + 1;
+        mChunkWritten.broadcast();
+    }
+
+    //! Stops the workers at the next chunk boundary
+    void abort()
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mAborted = true;
+        mChunkFilled.broadcast();
+        mChunkWritten.broadcast();
+    }
+
+    size_t getChunkSize(size_t chunk) const
+    {
+        const size_t offset = chunk * mNumBytesPerChunk;
+        return std::min(mNumBytesPerChunk, mNumBytes - offset);
+    }
+
+private:
+    bool fillChunk(size_t worker, size_t chunk)
+    {
+        UByte* const scratch = &mScratch[chunk % 2][0];
+        const size_t numBytes = getChunkSize(chunk);
+
+        if (worker == 0)
+        {
+            // Wait for the chunk that was in this buffer to be written
+            {
+                mt::CriticalSection<sys::Mutex> lock(&mMutex);
+                while (mNumWritten + 2 <= chunk && !mAborted)
+                {
+                    mChunkWritten.wait();
+                }
+                if (mAborted)
+                {
+                    return false;
+                }
+            }
+
+            if (mBuffer)
+            {
+                memcpy(scratch, mBuffer + chunk * mNumBytesPerChunk,
+                       numBytes);
+            }
+            else
+            {
+                readBytes(*mInputStream, scratch, numBytes);
+            }
+
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            mNumRead = chunk + 1;
+            mChunkFilled.broadcast();
+        }
+        else
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            while (mNumRead <= chunk && !mAborted)
+            {
+                mChunkFilled.wait();
+            }
+            if (mAborted)
+            {
+                return false;
+            }
+        }
+
+        if (mDoByteSwap)
+        {
+            const size_t numElements = numBytes / mElemSize;
+            const mt::ThreadPlanner planner(numElements, mNumWorkers);
+            size_t startElement(0);
+            size_t numElementsThisWorker(0);
+            if (planner.getThreadInfo(worker, startElement,
+                                      numElementsThisWorker))
+            {
+                sys::byteSwap(scratch + startElement * mElemSize,
+                              static_cast<unsigned short>(mElemSize),
+                              numElementsThisWorker);
+            }
+        }
+
+        // The last worker done with the chunk lets the caller write it.
+        // The first worker may already be on the next chunk, so the count
+        // is kept per buffer.
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        if (++mNumSwapsDone[chunk % 2] == mNumWorkers)
+        {
+            mNumSwapsDone[chunk % 2] = 0;
+            mNumFilled = chunk + 1;
+            mChunkFilled.broadcast();
+        }
+        return !mAborted;
+    }
+
+private:
+    const UByte* const mBuffer;
+    io::InputStream* const mInputStream;
+    const size_t mNumBytes;
+    const size_t mNumBytesPerChunk;
+    const size_t mNumChunks;
+    const size_t mElemSize;
+    const bool mDoByteSwap;
+    const size_t mNumWorkers;
+    std::vector<UByte> mScratch[2];
+
+    sys::Mutex mMutex;
+    sys::ConditionVar mChunkFilled;
+    sys::ConditionVar mChunkWritten;
+    size_t mNumRead;
+    size_t mNumFilled;
+    size_t mNumWritten;
+    size_t mNumSwapsDone[2];
+    bool mAborted;
+};
+
+class ChunkWorkerRunnable : public sys::Runnable
+{
+public:
+    ChunkWorkerRunnable(ChunkPipeline& pipeline, size_t worker) :
+        mPipeline(pipeline),
+        mWorker(worker)
+    {
+    }
+
+    virtual void run()
+    {
+        mPipeline.fill(mWorker);
+    }
+
+private:
+    ChunkPipeline& mPipeline;
+    const size_t mWorker;
+};
+
+/*
+ *  Writes 'numRows' rows of the image, which come either from 'buffer' or
+ *  (if it's NULL) from 'inputStream', a chunk of whole rows at a time.
+ *  Rows in memory that don't need swapping are written straight from the
+ *  caller's buffer.  Otherwise the chunks go through a ChunkPipeline whose
+ *  workers live for the whole write.
+ */
+void writeChunks(const UByte* buffer,
+                 io::InputStream* inputStream,
+                 size_t numRows,
+                 size_t rowSize,
+                 size_t elemSize,
+                 bool doByteSwap,
+                 size_t numThreads,
+                 size_t chunkSize,
+                 nitf_IOInterface* io)
+{
+    const size_t numBytes = numRows * rowSize;
+    const size_t numBytesPerChunk =
+            std::max<size_t>(chunkSize / rowSize, 1) * rowSize;
+
+    if (buffer && !doByteSwap)
+    {
+        for (size_t offset = 0; offset < numBytes; offset += numBytesPerChunk)
+        {
+            writeBytes(io, buffer + offset,
+                       std::min(numBytesPerChunk, numBytes - offset));
+        }
+        return;
+    }
+
+    if (numBytes == 0)
+    {
+        return;
+    }
+
+    // Only swapping is split across the workers, so one is enough without it
+    ChunkPipeline pipeline(buffer, inputStream, numBytes, numBytesPerChunk,
+                           elemSize, doByteSwap, doByteSwap ? numThreads : 1);
+
+    // Declared after the pipeline, so it's joined before the pipeline goes
+    mt::ThreadGroup workers;
+    try
+    {
+        for (size_t worker = 0; worker < pipeline.getNumWorkers(); ++worker)
+        {
+            workers.createThread(new ChunkWorkerRunnable(pipeline, worker));
+        }
+
+        for (size_t chunk = 0; chunk < pipeline.getNumChunks(); ++chunk)
+        {
+            const UByte* const data = pipeline.waitForChunk(chunk);
+            if (!data)
+            {
+                // Throws whatever the worker threw
+                workers.joinAll();
+                throw except::Exception(Ctxt("Filling a chunk failed"));
+            }
+            writeBytes(io, data, pipeline.getChunkSize(chunk));
+            pipeline.chunkWritten(chunk);
+        }
+    }
+    catch (...)
+    {
+        pipeline.abort();
+        try
+        {
+            workers.joinAll();
+        }
+        catch (...)
+        {
+            // Keep the first error
+        }
+        throw;
+    }
+    workers.joinAll();
+}
+
+NITF_BOOL handleException(const std::string& message, nitf_Error* error)
+{
+    nitf_Error_init(error, message.c_str(), NITF_CTXT,
+                    NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
+}
+
 typedef struct _MemoryWriteHandlerImpl
 {
     const UByte* buffer;
@@ -43,6 +395,8 @@ typedef struct _MemoryWriteHandlerImpl
     size_t numChannels;
     size_t pixelSize;
     int doByteSwap;
+    size_t numThreads;
+    size_t chunkSize;
 } MemoryWriteHandlerImpl;
 
 extern "C" void __six_MemoryWriteHandler_destruct(NITF_DATA * data)
@@ -55,41 +409,40 @@ extern "C" void __six_MemoryWriteHandler_destruct(NITF_DATA * data)
 extern "C" NITF_BOOL __six_MemoryWriteHandler_write(NITF_DATA * data,
         nitf_IOInterface* io, nitf_Error * error)
 {
-    size_t rowSize;
-    sys::Uint64_T off;
-    UByte* rowCopy;
-    unsigned int i;
+    SIX_PROFILE_SCOPE("MemoryWriteHandler::write");
 
     MemoryWriteHandlerImpl *impl = (MemoryWriteHandlerImpl *) data;
 
-    rowSize = impl->pixelSize * impl->numCols;
-    off = impl->firstRow * rowSize;
-    rowCopy = new UByte[rowSize];
+    const size_t rowSize = impl->pixelSize * impl->numCols;
+    SIX_PROFILE_BYTES("MemoryWriteHandler::write", rowSize * impl->numRows);
 
-    for (i = 0; i < impl->numRows; i++)
+    try
     {
-
-        memcpy(rowCopy, (const sys::byte*) &impl->buffer[off], rowSize);
-
-        if (impl->doByteSwap)
-            sys::byteSwap((sys::byte*) rowCopy, impl->pixelSize
-                    / impl->numChannels, impl->numCols * impl->numChannels);
-        // And write it back
-        if (!nitf_IOInterface_write(io, (const sys::byte*) rowCopy, rowSize,
-                                    error))
-            goto CATCH_ERROR;
-        off += rowSize;
+        writeChunks(impl->buffer + impl->firstRow * rowSize, NULL,
+                    impl->numRows, rowSize,
+                    impl->pixelSize / impl->numChannels,
+                    impl->doByteSwap != 0, impl->numThreads,
+                    impl->chunkSize, io);
+        return NITF_SUCCESS;
+    }
+    catch (const except::Throwable& ex)
+    {
+        return handleException(ex.getMessage(), error);
+    }
+    catch (const std::exception& ex)
+    {
+        return handleException(ex.what(), error);
+    }
+    catch (...)
+    {
+        return handleException("Unknown error writing image data", error);
     }
-    delete[] rowCopy;
-    return NITF_SUCCESS;
-
-    CATCH_ERROR: delete[] rowCopy;
-    return NITF_FAILURE;
 }
 
 MemoryWriteHandler::MemoryWriteHandler(const NITFSegmentInfo& info,
         const UByte* buffer, size_t firstRow, size_t numCols,
-        size_t numChannels, size_t pixelSize, bool doByteSwap)
+        size_t numChannels, size_t pixelSize, bool doByteSwap,
+        size_t numThreads, size_t chunkSize)
 {
     // Dont do it if we only have a byte!
     if (pixelSize / numChannels == 1)
@@ -111,6 +464,8 @@ MemoryWriteHandler::MemoryWriteHandler(const NITFSegmentInfo& info,
     impl->numChannels = numChannels;
     impl->pixelSize = pixelSize;
     impl->doByteSwap = doByteSwap;
+    impl->numThreads = numThreads;
+    impl->chunkSize = chunkSize;
 
     nitf_SegmentWriter *segmentWriter =
             (nitf_SegmentWriter *) NITF_MALLOC(sizeof(nitf_SegmentWriter));
@@ -136,6 +491,8 @@ typedef struct _StreamWriteHandlerImpl
     size_t numChannels;
     size_t pixelSize;
     int doByteSwap;
+    size_t numThreads;
+    size_t chunkSize;
 } StreamWriteHandlerImpl;
 
 extern "C" void __six_StreamWriteHandler_destruct(NITF_DATA * data)
@@ -148,39 +505,39 @@ extern "C" void __six_StreamWriteHandler_destruct(NITF_DATA * data)
 extern "C" NITF_BOOL __six_StreamWriteHandler_write(NITF_DATA * data,
         nitf_IOInterface* io, nitf_Error * error)
 {
-    size_t rowSize;
-    UByte* rowCopy;
-    unsigned int i;
+    SIX_PROFILE_SCOPE("StreamWriteHandler::write");
 
     StreamWriteHandlerImpl *impl = (StreamWriteHandlerImpl *) data;
 
-    rowSize = impl->pixelSize * impl->numCols;
-    rowCopy = new UByte[rowSize];
+    const size_t rowSize = impl->pixelSize * impl->numCols;
+    SIX_PROFILE_BYTES("StreamWriteHandler::write", rowSize * impl->numRows);
 
-    for (i = 0; i < impl->numRows; i++)
+    try
     {
-
-        impl->inputStream->read((sys::byte*) rowCopy, rowSize);
-
-        if (impl->doByteSwap)
-            sys::byteSwap((sys::byte*) rowCopy, impl->pixelSize
-                    / impl->numChannels, impl->numCols * impl->numChannels);
-
-        // And write it back
-        if (!nitf_IOInterface_write(io, (const sys::byte*) rowCopy, rowSize,
-                                    error))
-            goto CATCH_ERROR;
+        writeChunks(NULL, impl->inputStream, impl->numRows, rowSize,
+                    impl->pixelSize / impl->numChannels,
+                    impl->doByteSwap != 0, impl->numThreads,
+                    impl->chunkSize, io);
+        return NITF_SUCCESS;
+    }
+    catch (const except::Throwable& ex)
+    {
+        return handleException(ex.getMessage(), error);
+    }
+    catch (const std::exception& ex)
+    {
+        return handleException(ex.what(), error);
+    }
+    catch (...)
+    {
+        return handleException("Unknown error writing image data", error);
     }
-    delete[] rowCopy;
-    return NITF_SUCCESS;
-
-    CATCH_ERROR: delete[] rowCopy;
-    return NITF_FAILURE;
 }
 
 StreamWriteHandler::StreamWriteHandler(const NITFSegmentInfo& info,
         io::InputStream* is, size_t numCols, size_t numChannels,
-        size_t pixelSize, bool doByteSwap)
+        size_t pixelSize, bool doByteSwap, size_t numThreads,
+        size_t chunkSize)
 {
     // Don't do it if we only have a byte!
     if ((pixelSize / numChannels) == 1)
@@ -203,6 +560,8 @@ StreamWriteHandler::StreamWriteHandler(const NITFSegmentInfo& info,
     impl->numChannels = numChannels;
     impl->pixelSize = pixelSize;
     impl->doByteSwap = doByteSwap;
+    impl->numThreads = numThreads;
+    impl->chunkSize = chunkSize;
 
     nitf_SegmentWriter *segmentWriter =
             (nitf_SegmentWriter *) NITF_MALLOC(sizeof(nitf_SegmentWriter));
@@ -215,5 +574,3 @@ StreamWriteHandler::StreamWriteHandler(const NITFSegmentInfo& info,
     setNative( segmentWriter);
     setManaged(false);
 }
-
-
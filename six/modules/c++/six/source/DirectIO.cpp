@@ -0,0 +1,789 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <stdlib.h>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <limits>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <mt/CriticalSection.h>
+#include <sys/Runnable.h>
+#include <six/DirectIO.h>
+
+namespace
+{
+size_t roundUp(size_t numBytes, size_t alignment)
+{
+    return (numBytes + alignment - 1) / alignment * alignment;
+}
+
+#if defined(WIN32) || defined(_WIN32)
+const sys::Handle_T INVALID_FILE = INVALID_HANDLE_VALUE;
+
+sys::Handle_T openFile(const std::string& pathname, bool write, bool direct)
+{
+    return ::CreateFileA(pathname.c_str(),
+                         write ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                         FILE_SHARE_READ,
+                         NULL,
+                         write ? CREATE_ALWAYS : OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL |
+                                 (direct ? FILE_FLAG_NO_BUFFERING : 0),
+                         NULL);
+}
+
+void closeFile(sys::Handle_T handle)
+{
+    ::CloseHandle(handle);
+}
+
+sys::Uint64_T getFileSize(sys::Handle_T handle)
+{
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(handle, &size))
+    {
+        throw except::Exception(Ctxt("Unable to get the file size"));
+    }
+    return static_cast<sys::Uint64_T>(size.QuadPart);
+}
+
+void truncateFile(sys::Handle_T handle, sys::Uint64_T size)
+{
+    LARGE_INTEGER offset;
+    offset.QuadPart = static_cast<LONGLONG>(size);
+    if (!::SetFilePointerEx(handle, offset, NULL, FILE_BEGIN) ||
+        !::SetEndOfFile(handle))
+    {
+        throw except::Exception(Ctxt("Unable to set the file size to " +
+                                     str::toString(size)));
+    }
+}
+
+// Returns fewer than 'size' bytes only at the end of the file
+size_t readAt(sys::Handle_T handle,
+              void* buffer,
+              size_t size,
+              sys::Uint64_T offset)
+{
+    char* bufferPtr = static_cast<char*>(buffer);
+    size_t numRead = 0;
+    while (numRead < size)
+    {
+        OVERLAPPED overlapped;
+        ::memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD bytesRead(0);
+        const DWORD bytesToRead = static_cast<DWORD>(
+                std::min<size_t>(size - numRead, 0x40000000));
+        if (!::ReadFile(handle, bufferPtr, bytesToRead, &bytesRead,
+                        &overlapped))
+        {
+            if (::GetLastError() == ERROR_HANDLE_EOF)
+            {
+                break;
+            }
+            throw except::Exception(Ctxt(
+                    "Read at offset " + str::toString(offset) + " failed"));
+        }
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        bufferPtr += bytesRead;
+        offset += bytesRead;
+        numRead += bytesRead;
+    }
+    return numRead;
+}
+
+void writeAt(sys::Handle_T handle,
+             const void* buffer,
+             size_t size,
+             sys::Uint64_T offset)
+{
+    const char* bufferPtr = static_cast<const char*>(buffer);
+    while (size > 0)
+    {
+        OVERLAPPED overlapped;
+        ::memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD bytesWritten(0);
+        const DWORD bytesToWrite = static_cast<DWORD>(
+                std::min<size_t>(size, 0x40000000));
+        if (!::WriteFile(handle, bufferPtr, bytesToWrite, &bytesWritten,
+                         &overlapped) || bytesWritten == 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Write at offset " + str::toString(offset) + " failed"));
+        }
+        bufferPtr += bytesWritten;
+        offset += bytesWritten;
+        size -= bytesWritten;
+    }
+}
+
+sys::ubyte* allocateAligned(size_t numBytes, size_t alignment)
+{
+    return static_cast<sys::ubyte*>(::_aligned_malloc(numBytes, alignment));
+}
+
+void freeAligned(sys::ubyte* buffer)
+{
+    ::_aligned_free(buffer);
+}
+#else
+const sys::Handle_T INVALID_FILE = -1;
+
+sys::Handle_T openFile(const std::string& pathname, bool write, bool direct)
+{
+    // Writes read chunks back in before changing them
+    int flags = write ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY;
+#ifdef O_DIRECT
+    if (direct)
+    {
+        flags |= O_DIRECT;
+    }
+#endif
+
+    const int fd = ::open(pathname.c_str(), flags, 0666);
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+    if (fd >= 0 && direct && ::fcntl(fd, F_NOCACHE, 1) != 0)
+    {
+        ::close(fd);
+        return INVALID_FILE;
+    }
+#elif !defined(O_DIRECT)
+    if (fd >= 0 && direct)
+    {
+        ::close(fd);
+        return INVALID_FILE;
+    }
+#endif
+    return fd;
+}
+
+void closeFile(sys::Handle_T handle)
+{
+    ::close(handle);
+}
+
+sys::Uint64_T getFileSize(sys::Handle_T handle)
+{
+    struct stat status;
+    if (::fstat(handle, &status) != 0)
+    {
+        throw except::Exception(Ctxt("Unable to stat the file"));
+    }
+    return static_cast<sys::Uint64_T>(status.st_size);
+}
+
+void truncateFile(sys::Handle_T handle, sys::Uint64_T size)
+{
+    if (::ftruncate(handle, static_cast<off_t>(size)) != 0)
+    {
+        throw except::Exception(Ctxt("Unable to set the file size to " +
+                                     str::toString(size)));
+    }
+}
+
+// Returns fewer than 'size' bytes only at the end of the file
+size_t readAt(sys::Handle_T handle,
+              void* buffer,
+              size_t size,
+              sys::Uint64_T offset)
+{
+    char* bufferPtr = static_cast<char*>(buffer);
+    size_t numRead = 0;
+    while (numRead < size)
+    {
+        const ssize_t bytesRead = ::pread(handle, bufferPtr, size - numRead,
+                                          static_cast<off_t>(offset));
+        if (bytesRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw except::Exception(Ctxt(
+                    "Read at offset " + str::toString(offset) + " failed"));
+        }
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        bufferPtr += bytesRead;
+        offset += bytesRead;
+        numRead += bytesRead;
+    }
+    return numRead;
+}
+
+void writeAt(sys::Handle_T handle,
+             const void* buffer,
+             size_t size,
+             sys::Uint64_T offset)
+{
+    const char* bufferPtr = static_cast<const char*>(buffer);
+    while (size > 0)
+    {
+        const ssize_t bytesWritten = ::pwrite(handle, bufferPtr, size,
+                                              static_cast<off_t>(offset));
+        if (bytesWritten <= 0)
+        {
+            if (bytesWritten < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            throw except::Exception(Ctxt(
+                    "Write at offset " + str::toString(offset) + " failed"));
+        }
+        bufferPtr += bytesWritten;
+        offset += bytesWritten;
+        size -= bytesWritten;
+    }
+}
+
+sys::ubyte* allocateAligned(size_t numBytes, size_t alignment)
+{
+    void* buffer = NULL;
+    if (::posix_memalign(&buffer, alignment, numBytes) != 0)
+    {
+        return NULL;
+    }
+    return static_cast<sys::ubyte*>(buffer);
+}
+
+void freeAligned(sys::ubyte* buffer)
+{
+    ::free(buffer);
+}
+#endif
+}
+
+namespace six
+{
+const size_t DirectIO::ALIGNMENT = 4096;
+const size_t DirectIO::DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024;
+const size_t DirectIO::DEFAULT_QUEUE_DEPTH = 4;
+
+DirectIO::Chunk::Chunk() :
+    buffer(NULL),
+    index(0),
+    numBytes(0),
+    state(FREE),
+    lastUsed(0)
+{
+}
+
+class DirectIO::Worker : public sys::Runnable
+{
+public:
+    Worker(DirectIO& io) :
+        mIO(io)
+    {
+    }
+
+    virtual void run()
+    {
+        mIO.work();
+    }
+
+private:
+    DirectIO& mIO;
+};
+
+DirectIO::DirectIO(const std::string& pathname,
+                   int accessMode,
+                   size_t chunkSize,
+                   size_t queueDepth) :
+    mPathname(pathname),
+    mWrite(accessMode == NITF_ACCESS_WRITEONLY),
+    mChunkSize(roundUp(std::max<size_t>(chunkSize, 1), ALIGNMENT)),
+    mHandle(INVALID_FILE),
+    mDirect(true),
+    mOpen(false),
+    mOffset(0),
+    mSize(0),
+    mWrittenSize(0),
+    mChunks(std::max<size_t>(queueDepth, 1) + 1),
+    mCurrent(NULL),
+    mNumUses(0),
+    mRequestQueued(&mMutex),
+    mRequestDone(&mMutex),
+    mNumInFlight(0),
+    mStop(false)
+{
+    if (accessMode != NITF_ACCESS_READONLY &&
+        accessMode != NITF_ACCESS_WRITEONLY)
+    {
+        throw except::Exception(Ctxt(
+                "DirectIO files are either read or written, not both"));
+    }
+
+    // Not every file system can do direct I/O
+    mHandle = openFile(pathname, mWrite, true);
+    if (mHandle == INVALID_FILE)
+    {
+        mDirect = false;
+        mHandle = openFile(pathname, mWrite, false);
+    }
+    if (mHandle == INVALID_FILE)
+    {
+        throw except::Exception(Ctxt("Unable to open " + pathname));
+    }
+
+    try
+    {
+        if (!mWrite)
+        {
+            mSize = getFileSize(mHandle);
+            mWrittenSize = mSize;
+        }
+
+        for (size_t ii = 0; ii < mChunks.size(); ++ii)
+        {
+            mChunks[ii].buffer = allocateAligned(mChunkSize, ALIGNMENT);
+            if (mChunks[ii].buffer == NULL)
+            {
+                throw except::Exception(Ctxt(
+                        "Unable to allocate " + str::toString(mChunkSize) +
+                        " bytes"));
+            }
+        }
+    }
+    catch (...)
+    {
+        for (size_t ii = 0; ii < mChunks.size(); ++ii)
+        {
+            freeAligned(mChunks[ii].buffer);
+        }
+        closeFile(mHandle);
+        throw;
+    }
+
+    mOpen = true;
+    for (size_t ii = 0; ii + 1 < mChunks.size(); ++ii)
+    {
+        mWorkers.createThread(new Worker(*this));
+    }
+}
+
+DirectIO::~DirectIO()
+{
+    try
+    {
+        closeImpl();
+    }
+    catch (...)
+    {
+    }
+
+    for (size_t ii = 0; ii < mChunks.size(); ++ii)
+    {
+        freeAligned(mChunks[ii].buffer);
+    }
+}
+
+void DirectIO::work()
+{
+    while (true)
+    {
+        Chunk* chunk;
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            while (mRequests.empty() && !mStop)
+            {
+                mRequestQueued.wait();
+            }
+            if (mRequests.empty())
+            {
+                return;
+            }
+            chunk = mRequests.front();
+            mRequests.pop_front();
+        }
+
+        std::string error;
+        try
+        {
+            transfer(*chunk);
+        }
+        catch (const except::Exception& ex)
+        {
+            error = ex.getMessage();
+        }
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        if (error.empty())
+        {
+            chunk->state = Chunk::READY;
+        }
+        else
+        {
+            chunk->state = Chunk::FREE;
+            if (mError.empty())
+            {
+                mError = error;
+            }
+        }
+        --mNumInFlight;
+        mRequestDone.broadcast();
+    }
+}
+
+void DirectIO::transfer(Chunk& chunk)
+{
+    const sys::Uint64_T offset =
+            static_cast<sys::Uint64_T>(chunk.index) * mChunkSize;
+    const size_t numBytes = roundUp(chunk.numBytes, ALIGNMENT);
+    if (chunk.state == Chunk::WRITING)
+    {
+        writeAt(mHandle, chunk.buffer, numBytes, offset);
+    }
+    else if (readAt(mHandle, chunk.buffer, numBytes, offset) <
+             chunk.numBytes)
+    {
+        throw except::Exception(Ctxt(
+                "Unexpected end of file at offset " + str::toString(offset)));
+    }
+}
+
+void DirectIO::checkError() const
+{
+    if (!mError.empty())
+    {
+        throw except::Exception(Ctxt(mPathname + ": " + mError));
+    }
+}
+
+DirectIO::Chunk* DirectIO::getChunk(sys::Uint64_T index)
+{
+    while (true)
+    {
+        checkError();
+
+        Chunk* chunk = NULL;
+        for (size_t ii = 0; ii < mChunks.size(); ++ii)
+        {
+            if (mChunks[ii].state != Chunk::FREE &&
+                mChunks[ii].index == index)
+            {
+                chunk = &mChunks[ii];
+                break;
+            }
+        }
+
+        if (chunk)
+        {
+            if (chunk->state == Chunk::READY ||
+                chunk->state == Chunk::FILLING)
+            {
+                chunk->lastUsed = ++mNumUses;
+                return chunk;
+            }
+
+            // It's being read or written
+            mRequestDone.wait();
+            continue;
+        }
+
+        chunk = findFreeChunk(std::numeric_limits<sys::Uint64_T>::max());
+        if (!chunk)
+        {
+            mRequestDone.wait();
+            continue;
+        }
+
+        // Anything that's already in the file has to be read first
+        chunk->index = index;
+        const sys::Uint64_T offset = index * mChunkSize;
+        if (offset < mWrittenSize)
+        {
+            chunk->numBytes = static_cast<size_t>(std::min<sys::Uint64_T>(
+                    mChunkSize, mWrittenSize - offset));
+            submit(*chunk, Chunk::READING);
+            continue;
+        }
+
+        chunk->numBytes = 0;
+        chunk->state = Chunk::READY;
+        chunk->lastUsed = ++mNumUses;
+        return chunk;
+    }
+}
+
+DirectIO::Chunk* DirectIO::findFreeChunk(sys::Uint64_T evictBefore)
+{
+    Chunk* leastRecent = NULL;
+    for (size_t ii = 0; ii < mChunks.size(); ++ii)
+    {
+        Chunk& chunk(mChunks[ii]);
+        if (chunk.state == Chunk::FREE)
+        {
+            return &chunk;
+        }
+        if (chunk.state == Chunk::READY && chunk.index < evictBefore &&
+            (!leastRecent || chunk.lastUsed < leastRecent->lastUsed))
+        {
+            leastRecent = &chunk;
+        }
+    }
+    return leastRecent;
+}
+
+void DirectIO::submit(Chunk& chunk, Chunk::State state)
+{
+    if (state == Chunk::WRITING)
+    {
+        // The write is padded out to the alignment, and trimmed off when
+        // the file's closed
+        ::memset(chunk.buffer + chunk.numBytes, 0,
+                 roundUp(chunk.numBytes, ALIGNMENT) - chunk.numBytes);
+        mWrittenSize = std::max<sys::Uint64_T>(
+                mWrittenSize, chunk.index * mChunkSize + chunk.numBytes);
+    }
+
+    chunk.state = state;
+    mRequests.push_back(&chunk);
+    ++mNumInFlight;
+    mRequestQueued.signal();
+}
+
+void DirectIO::readAhead(sys::Uint64_T index)
+{
+    const sys::Uint64_T numChunks = (mSize + mChunkSize - 1) / mChunkSize;
+    const sys::Uint64_T lastChunk =
+            std::min<sys::Uint64_T>(numChunks, index + mChunks.size());
+    for (sys::Uint64_T next = index + 1; next < lastChunk; ++next)
+    {
+        bool found = false;
+        for (size_t ii = 0; ii < mChunks.size() && !found; ++ii)
+        {
+            found = (mChunks[ii].state != Chunk::FREE &&
+                     mChunks[ii].index == next);
+        }
+        if (found)
+        {
+            continue;
+        }
+
+        // Don't throw out anything that's still ahead of the reader
+        Chunk* const chunk = findFreeChunk(index);
+        if (!chunk)
+        {
+            break;
+        }
+        chunk->index = next;
+        chunk->numBytes = static_cast<size_t>(std::min<sys::Uint64_T>(
+                mChunkSize, mSize - next * mChunkSize));
+        submit(*chunk, Chunk::READING);
+    }
+}
+
+void DirectIO::waitForAll()
+{
+    while (mNumInFlight > 0)
+    {
+        mRequestDone.wait();
+    }
+}
+
+void DirectIO::readImpl(void* buffer, size_t size)
+{
+    if (mWrite)
+    {
+        throw except::Exception(Ctxt(mPathname + " is open for writing"));
+    }
+    if (mOffset < 0 || static_cast<sys::Uint64_T>(mOffset) + size > mSize)
+    {
+        throw except::Exception(Ctxt(
+                "Read of " + str::toString(size) + " bytes at offset " +
+                str::toString(mOffset) + " is past the end of " +
+                mPathname));
+    }
+
+    sys::ubyte* output = static_cast<sys::ubyte*>(buffer);
+    while (size > 0)
+    {
+        const sys::Uint64_T index = mOffset / mChunkSize;
+        const size_t chunkOffset = static_cast<size_t>(mOffset % mChunkSize);
+
+        const Chunk* chunk;
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            chunk = getChunk(index);
+            readAhead(index);
+        }
+
+        const size_t numBytes =
+                std::min(size, chunk->numBytes - chunkOffset);
+        ::memcpy(output, chunk->buffer + chunkOffset, numBytes);
+        output += numBytes;
+        mOffset += static_cast<nitf::Off>(numBytes);
+        size -= numBytes;
+    }
+}
+
+void DirectIO::writeImpl(const void* buffer, size_t size)
+{
+    if (!mWrite)
+    {
+        throw except::Exception(Ctxt(mPathname + " is open for reading"));
+    }
+    if (mOffset < 0)
+    {
+        throw except::Exception(Ctxt("Can't write before the start of " +
+                                     mPathname));
+    }
+
+    const sys::ubyte* input = static_cast<const sys::ubyte*>(buffer);
+    while (size > 0)
+    {
+        const sys::Uint64_T index = mOffset / mChunkSize;
+        const size_t chunkOffset = static_cast<size_t>(mOffset % mChunkSize);
+
+        if (!mCurrent || mCurrent->index != index)
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            if (mCurrent)
+            {
+                submit(*mCurrent, Chunk::WRITING);
+                mCurrent = NULL;
+            }
+            mCurrent = getChunk(index);
+            mCurrent->state = Chunk::FILLING;
+        }
+
+        // Anything skipped over is zeros
+        if (chunkOffset > mCurrent->numBytes)
+        {
+            ::memset(mCurrent->buffer + mCurrent->numBytes, 0,
+                     chunkOffset - mCurrent->numBytes);
+        }
+
+        const size_t numBytes = std::min(size, mChunkSize - chunkOffset);
+        ::memcpy(mCurrent->buffer + chunkOffset, input, numBytes);
+        mCurrent->numBytes = std::max(mCurrent->numBytes,
+                                      chunkOffset + numBytes);
+        input += numBytes;
+        mOffset += static_cast<nitf::Off>(numBytes);
+        mSize = std::max<sys::Uint64_T>(mSize, mOffset);
+        size -= numBytes;
+    }
+}
+
+bool DirectIO::canSeekImpl() const
+{
+    return true;
+}
+
+nitf::Off DirectIO::seekImpl(nitf::Off offset, int whence)
+{
+    switch (whence)
+    {
+    case NITF_SEEK_SET:
+        mOffset = offset;
+        break;
+    case NITF_SEEK_CUR:
+        mOffset += offset;
+        break;
+    case NITF_SEEK_END:
+        mOffset = static_cast<nitf::Off>(mSize) + offset;
+        break;
+    default:
+        throw except::Exception(
+                Ctxt("Unknown whence value when seeking DirectIO: " +
+                     str::toString(whence)));
+    }
+
+    return mOffset;
+}
+
+nitf::Off DirectIO::tellImpl() const
+{
+    return mOffset;
+}
+
+nitf::Off DirectIO::getSizeImpl() const
+{
+    return static_cast<nitf::Off>(mSize);
+}
+
+int DirectIO::getModeImpl() const
+{
+    return mWrite ? NITF_ACCESS_WRITEONLY : NITF_ACCESS_READONLY;
+}
+
+void DirectIO::closeImpl()
+{
+    if (!mOpen)
+    {
+        return;
+    }
+    mOpen = false;
+
+    std::string error;
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        if (mCurrent)
+        {
+            submit(*mCurrent, Chunk::WRITING);
+            mCurrent = NULL;
+        }
+        waitForAll();
+        error = mError;
+
+        mStop = true;
+        mRequestQueued.broadcast();
+    }
+    mWorkers.joinAll();
+
+    if (mWrite && error.empty())
+    {
+        try
+        {
+            truncateFile(mHandle, mSize);
+        }
+        catch (const except::Exception& ex)
+        {
+            error = ex.getMessage();
+        }
+    }
+    closeFile(mHandle);
+
+    if (!error.empty())
+    {
+        throw except::Exception(Ctxt(mPathname + ": " + error));
+    }
+}
+}
@@ -0,0 +1,189 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+
+#include <except/Exception.h>
+#include "six/FFT.h"
+
+namespace six
+{
+FFT::FFT(size_t size) :
+    mSize(size),
+    mRadix2Size(size)
+{
+    if (mSize == 0)
+    {
+        throw except::Exception(Ctxt("FFT size must be positive"));
+    }
+
+    // Bluestein's convolution needs 2N - 1 samples to not wrap around
+    if (!isPowerOfTwo(mSize))
+    {
+        mRadix2Size = nextPowerOfTwo(2 * mSize - 1);
+    }
+
+    mTwiddles.resize(mRadix2Size / 2);
+    for (size_t ii = 0; ii < mTwiddles.size(); ++ii)
+    {
+        const double angle = -2.0 * M_PI *
+                static_cast<double>(ii) / static_cast<double>(mRadix2Size);
+        mTwiddles[ii] = std::complex<float>(
+                static_cast<float>(std::cos(angle)),
+                static_cast<float>(std::sin(angle)));
+    }
+
+    size_t numBits = 0;
+    while ((static_cast<size_t>(1) << numBits) < mRadix2Size)
+    {
+        ++numBits;
+    }
+    mBitReverse.resize(mRadix2Size);
+    for (size_t ii = 0; ii < mRadix2Size; ++ii)
+    {
+        size_t reversed = 0;
+        for (size_t bit = 0; bit < numBits; ++bit)
+        {
+            if (ii & (static_cast<size_t>(1) << bit))
+            {
+                reversed |= static_cast<size_t>(1) << (numBits - 1 - bit);
+            }
+        }
+        mBitReverse[ii] = reversed;
+    }
+
+    if (mRadix2Size != mSize)
+    {
+        // n^2 mod 2N keeps the angle small so it doesn't lose precision
+        mChirp.resize(mSize);
+        for (size_t ii = 0; ii < mSize; ++ii)
+        {
+            const size_t nSquared = (ii * ii) % (2 * mSize);
+            const double angle = -M_PI *
+                    static_cast<double>(nSquared) /
+                    static_cast<double>(mSize);
+            mChirp[ii] = std::complex<float>(
+                    static_cast<float>(std::cos(angle)),
+                    static_cast<float>(std::sin(angle)));
+        }
+
+        mChirpFilter.assign(mRadix2Size, std::complex<float>(0.0f, 0.0f));
+        mChirpFilter[0] = std::conj(mChirp[0]);
+        for (size_t ii = 1; ii < mSize; ++ii)
+        {
+            mChirpFilter[ii] = std::conj(mChirp[ii]);
+            mChirpFilter[mRadix2Size - ii] = std::conj(mChirp[ii]);
+        }
+        radix2(&mChirpFilter[0]);
+    }
+}
+
+size_t FFT::nextPowerOfTwo(size_t size)
+{
+    size_t powerOfTwo = 1;
+    while (powerOfTwo < size)
+    {
+        powerOfTwo <<= 1;
+    }
+    return powerOfTwo;
+}
+
+void FFT::forward(std::complex<float>* data) const
+{
+    if (mRadix2Size == mSize)
+    {
+        radix2(data);
+    }
+    else
+    {
+        bluestein(data);
+    }
+}
+
+void FFT::inverse(std::complex<float>* data) const
+{
+    // The inverse is the conjugate of the forward transform of the conjugate
+    for (size_t ii = 0; ii < mSize; ++ii)
+    {
+        data[ii] = std::conj(data[ii]);
+    }
+    forward(data);
+    for (size_t ii = 0; ii < mSize; ++ii)
+    {
+        data[ii] = std::conj(data[ii]);
+    }
+}
+
+void FFT::radix2(std::complex<float>* data) const
+{
+    for (size_t ii = 0; ii < mRadix2Size; ++ii)
+    {
+        const size_t jj = mBitReverse[ii];
+        if (ii < jj)
+        {
+            std::swap(data[ii], data[jj]);
+        }
+    }
+
+    for (size_t length = 2; length <= mRadix2Size; length <<= 1)
+    {
+        const size_t half = length / 2;
+        const size_t twiddleStride = mRadix2Size / length;
+        for (size_t start = 0; start < mRadix2Size; start += length)
+        {
+            std::complex<float>* const lower = data + start;
+            std::complex<float>* const upper = lower + half;
+            for (size_t ii = 0; ii < half; ++ii)
+            {
+                const std::complex<float> product =
+                        upper[ii] * mTwiddles[ii * twiddleStride];
+                upper[ii] = lower[ii] - product;
+                lower[ii] += product;
+            }
+        }
+    }
+}
+
+void FFT::bluestein(std::complex<float>* data) const
+{
+    // X[k] = chirp[k] * sum(x[n] * chirp[n] * conj(chirp[k - n])), which is
+    // a convolution that can be done with power of two transforms
+    std::vector<std::complex<float> > scratch(mRadix2Size,
+                                              std::complex<float>(0.0f, 0.0f));
+    for (size_t ii = 0; ii < mSize; ++ii)
+    {
+        scratch[ii] = data[ii] * mChirp[ii];
+    }
+
+    radix2(&scratch[0]);
+    for (size_t ii = 0; ii < mRadix2Size; ++ii)
+    {
+        scratch[ii] = std::conj(scratch[ii] * mChirpFilter[ii]);
+    }
+    radix2(&scratch[0]);
+
+    const float scale = 1.0f / static_cast<float>(mRadix2Size);
+    for (size_t ii = 0; ii < mSize; ++ii)
+    {
+        data[ii] = std::conj(scratch[ii]) * mChirp[ii] * scale;
+    }
+}
+}
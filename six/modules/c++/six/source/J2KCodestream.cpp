@@ -0,0 +1,261 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sstream>
+
+#include <except/Exception.h>
+#include <six/J2KCodestream.h>
+
+namespace
+{
+const sys::Uint16_T SOC = 0xFF4F;
+const sys::Uint16_T SIZ = 0xFF51;
+const sys::Uint16_T TLM = 0xFF55;
+const sys::Uint16_T PLM = 0xFF57;
+const sys::Uint16_T PPM = 0xFF60;
+const sys::Uint16_T SOT = 0xFF90;
+const sys::Uint16_T EOC = 0xFFD9;
+
+// Size of the SOT marker segment, including the marker
+const size_t SOT_SIZE = 12;
+
+// Offsets within the SIZ and SOT marker segments, from the marker
+const size_t SIZ_XSIZ = 6;
+const size_t SIZ_YSIZ = 10;
+const size_t SIZ_XOSIZ = 14;
+const size_t SIZ_YOSIZ = 18;
+const size_t SIZ_XTSIZ = 22;
+const size_t SIZ_YTSIZ = 26;
+const size_t SIZ_XTOSIZ = 30;
+const size_t SIZ_YTOSIZ = 34;
+const size_t SIZ_SIZE = SIZ_YTOSIZ + 4;
+const size_t SOT_ISOT = 4;
+const size_t SOT_PSOT = 6;
+
+// Code-block and (default) precinct sizes
+const size_t CODE_BLOCK_SIZE = 64;
+const size_t PRECINCT_SIZE = 32768;
+
+// Everything in a codestream is big endian
+sys::Uint16_T getUint16(const sys::ubyte* data)
+{
+    return static_cast<sys::Uint16_T>((data[0] << 8) | data[1]);
+}
+
+sys::Uint32_T getUint32(const sys::ubyte* data)
+{
+    return (static_cast<sys::Uint32_T>(data[0]) << 24) |
+           (static_cast<sys::Uint32_T>(data[1]) << 16) |
+           (static_cast<sys::Uint32_T>(data[2]) << 8) |
+           static_cast<sys::Uint32_T>(data[3]);
+}
+
+void setUint16(sys::Uint16_T value, sys::ubyte* data)
+{
+    data[0] = static_cast<sys::ubyte>(value >> 8);
+    data[1] = static_cast<sys::ubyte>(value);
+}
+
+void setUint32(sys::Uint32_T value, sys::ubyte* data)
+{
+    data[0] = static_cast<sys::ubyte>(value >> 24);
+    data[1] = static_cast<sys::ubyte>(value >> 16);
+    data[2] = static_cast<sys::ubyte>(value >> 8);
+    data[3] = static_cast<sys::ubyte>(value);
+}
+
+bool isAligned(size_t size, size_t gridSize)
+{
+    return (size % gridSize == 0) || (gridSize % size == 0);
+}
+
+bool isTileSizeAligned(size_t tileSize, size_t numResolutions)
+{
+    // Each decomposition level halves the tile, and the code-block and
+    // precinct grids are anchored at the origin of every level.  So each
+    // level must either be a whole number of grid cells or evenly divide
+    // one, or else a tile encoded at the origin would be partitioned
+    // differently than it is in place.
+    for (size_t level = 0; level < numResolutions; ++level)
+    {
+        const size_t scale = static_cast<size_t>(1) << level;
+        if (tileSize % scale != 0)
+        {
+            return false;
+        }
+
+        const size_t levelSize = tileSize / scale;
+        if (!isAligned(levelSize, CODE_BLOCK_SIZE) ||
+            !isAligned(levelSize, PRECINCT_SIZE))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+namespace six
+{
+const sys::ubyte J2KCodestream::END_OF_CODESTREAM[2] = {0xFF, 0xD9};
+
+J2KCodestream::J2KCodestream(sys::ubyte* data, size_t numBytes) :
+    mData(data),
+    mNumBytes(numBytes),
+    mMainHeaderSize(0),
+    mSIZOffset(0),
+    mTilePartsSize(0)
+{
+    if (mNumBytes < 2 || getUint16(mData) != SOC)
+    {
+        throw except::Exception(Ctxt("Codestream doesn't start with SOC"));
+    }
+
+    // Walk the main header's marker segments up to the first tile-part
+    size_t pos = 2;
+    while (true)
+    {
+        if (pos + 4 > mNumBytes)
+        {
+            throw except::Exception(Ctxt("Truncated codestream main header"));
+        }
+
+        const sys::Uint16_T marker = getUint16(mData + pos);
+        if (marker == SOT)
+        {
+            break;
+        }
+        else if (marker == TLM || marker == PLM || marker == PPM)
+        {
+            std::ostringstream ostr;
+            ostr << "Codestreams with marker 0x" << std::hex << marker
+                 << " can't be spliced";
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+        else if ((marker & 0xFF00) != 0xFF00)
+        {
+            std::ostringstream ostr;
+            ostr << "Expected a marker at offset " << pos;
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+        else if (marker == SIZ)
+        {
+            mSIZOffset = pos;
+        }
+
+        pos += 2 + getUint16(mData + pos + 2);
+    }
+    mMainHeaderSize = pos;
+
+    if (mSIZOffset == 0 || mSIZOffset + SIZ_SIZE > mMainHeaderSize)
+    {
+        throw except::Exception(Ctxt("Codestream has no valid SIZ marker"));
+    }
+
+    // Then the tile-parts up to EOC
+    while (true)
+    {
+        if (pos + 2 > mNumBytes)
+        {
+            throw except::Exception(Ctxt("Codestream doesn't end with EOC"));
+        }
+
+        const sys::Uint16_T marker = getUint16(mData + pos);
+        if (marker == EOC)
+        {
+            break;
+        }
+        else if (marker != SOT || pos + SOT_SIZE > mNumBytes)
+        {
+            std::ostringstream ostr;
+            ostr << "Expected a tile-part at offset " << pos;
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+
+        size_t tilePartSize = getUint32(mData + pos + SOT_PSOT);
+        if (tilePartSize == 0)
+        {
+            // The last tile-part is allowed to leave its length out and run
+            // up to EOC.  It won't be last anymore once it's spliced.
+            if (mNumBytes < pos + SOT_SIZE + 2 ||
+                getUint16(mData + mNumBytes - 2) != EOC)
+            {
+                throw except::Exception(Ctxt(
+                        "Codestream doesn't end with EOC"));
+            }
+            tilePartSize = mNumBytes - 2 - pos;
+            setUint32(static_cast<sys::Uint32_T>(tilePartSize),
+                      mData + pos + SOT_PSOT);
+        }
+
+        if (tilePartSize < SOT_SIZE || pos + tilePartSize + 2 > mNumBytes)
+        {
+            std::ostringstream ostr;
+            ostr << "Invalid length for the tile-part at offset " << pos;
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+
+        mTilePartOffsets.push_back(pos);
+        pos += tilePartSize;
+    }
+    mTilePartsSize = pos - mMainHeaderSize;
+}
+
+void J2KCodestream::setTileIndex(size_t tileIndex)
+{
+    if (tileIndex > 65534)
+    {
+        std::ostringstream ostr;
+        ostr << "Tile index " << tileIndex << " is out of range";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    for (size_t ii = 0; ii < mTilePartOffsets.size(); ++ii)
+    {
+        setUint16(static_cast<sys::Uint16_T>(tileIndex),
+                  mData + mTilePartOffsets[ii] + SOT_ISOT);
+    }
+}
+
+void J2KCodestream::setImageSize(const types::RowCol<size_t>& imageDims,
+                                 const types::RowCol<size_t>& tileDims)
+{
+    sys::ubyte* const siz = mData + mSIZOffset;
+    if (getUint32(siz + SIZ_XOSIZ) != 0 || getUint32(siz + SIZ_YOSIZ) != 0 ||
+        getUint32(siz + SIZ_XTOSIZ) != 0 || getUint32(siz + SIZ_YTOSIZ) != 0)
+    {
+        throw except::Exception(Ctxt(
+                "Codestreams with image or tile offsets can't be spliced"));
+    }
+
+    setUint32(static_cast<sys::Uint32_T>(imageDims.col), siz + SIZ_XSIZ);
+    setUint32(static_cast<sys::Uint32_T>(imageDims.row), siz + SIZ_YSIZ);
+    setUint32(static_cast<sys::Uint32_T>(tileDims.col), siz + SIZ_XTSIZ);
+    setUint32(static_cast<sys::Uint32_T>(tileDims.row), siz + SIZ_YTSIZ);
+}
+
+bool J2KCodestream::isTileAligned(const types::RowCol<size_t>& tileDims,
+                                  size_t numResolutions)
+{
+    return isTileSizeAligned(tileDims.row, numResolutions) &&
+           isTileSizeAligned(tileDims.col, numResolutions);
+}
+}
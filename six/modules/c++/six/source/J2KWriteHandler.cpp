@@ -0,0 +1,599 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <except/Exception.h>
+#include <str/Manip.h>
+#include <sys/Conf.h>
+#include <sys/Runnable.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <nitf/WriterOptions.h>
+#include "six/J2KCodestream.h"
+#include "six/J2KWriteHandler.h"
+#include "six/Profiler.h"
+
+#ifdef HAVE_J2K_H
+#include <j2k/Component.h>
+#include <j2k/Container.h>
+#include <j2k/Writer.h>
+#endif
+
+using namespace six;
+
+extern "C"
+{
+void __six_J2KWriteHandler_destruct(NITF_DATA * data);
+NITF_BOOL __six_J2KWriteHandler_write(NITF_DATA * data,
+        nitf_IOInterface* io, nitf_Error * error);
+}
+
+typedef struct _J2KWriteHandlerImpl
+{
+    const UByte* buffer;
+    io::InputStream* inputStream;
+    size_t numRows;
+    size_t numCols;
+    size_t numRowsPerTile;
+    size_t numColsPerTile;
+    size_t numBytesPerPixel;
+    size_t numBits;
+    int isSigned;
+    size_t numThreads;
+    double compressionRatio;
+    nitf::Uint32 numResolutions;
+    nitf_Field* comratField;
+} J2KWriteHandlerImpl;
+
+namespace
+{
+// OpenJPEG's own default, which it lowers for small tiles
+const size_t DEFAULT_NUM_RESOLUTIONS = 6;
+
+size_t getNumTiles(size_t numPixels, size_t numPixelsPerTile)
+{
+    return (numPixels + numPixelsPerTile - 1) / numPixelsPerTile;
+}
+
+// A block size of 0 means the image isn't blocked in that direction
+types::RowCol<size_t> getTileDims(nitf::ImageSubheader& subheader)
+{
+    types::RowCol<size_t> tileDims(
+            static_cast<nitf::Uint32>(subheader.getNumPixelsPerVertBlock()),
+            static_cast<nitf::Uint32>(subheader.getNumPixelsPerHorizBlock()));
+    if (tileDims.row == 0)
+    {
+        tileDims.row = static_cast<nitf::Uint32>(subheader.getNumRows());
+    }
+    if (tileDims.col == 0)
+    {
+        tileDims.col = static_cast<nitf::Uint32>(subheader.getNumCols());
+    }
+    return tileDims;
+}
+
+template <typename T>
+const T* findOption(const std::map<std::string, void*>& options,
+                    const std::string& key)
+{
+    const std::map<std::string, void*>::const_iterator iter =
+            options.find(key);
+    return (iter == options.end()) ? NULL :
+            static_cast<const T*>(iter->second);
+}
+
+// Matches what the OpenJPEG writer picks when it isn't told
+size_t getNumResolutions(const types::RowCol<size_t>& tileDims,
+                         const std::map<std::string, void*>& options)
+{
+    const nitf::Uint32* const numResolutions =
+            findOption<nitf::Uint32>(options, C8_NUM_RESOLUTIONS_KEY);
+    if (numResolutions && *numResolutions > 0)
+    {
+        return *numResolutions;
+    }
+
+    size_t log2MinDim = 0;
+    for (size_t minDim = std::min(tileDims.row, tileDims.col);
+         minDim > 1;
+         minDim >>= 1)
+    {
+        ++log2MinDim;
+    }
+    return std::min(DEFAULT_NUM_RESOLUTIONS, log2MinDim);
+}
+
+#ifdef HAVE_J2K_H
+void writeBytes(nitf_IOInterface* io, const sys::ubyte* data, size_t size)
+{
+    nitf_Error error;
+    if (!nitf_IOInterface_write(io, reinterpret_cast<const char*>(data),
+                                size, &error))
+    {
+        throw nitf::NITFException(&error);
+    }
+}
+
+void readBand(io::InputStream& is, UByte* buffer, size_t numBytes)
+{
+    size_t numBytesRead(0);
+    while (numBytesRead < numBytes)
+    {
+        const sys::SSize_T bytesThisRead =
+                is.read(reinterpret_cast<sys::byte*>(buffer) + numBytesRead,
+                        numBytes - numBytesRead);
+        if (bytesThisRead == io::InputStream::IS_EOF || bytesThisRead <= 0)
+        {
+            throw except::Exception(Ctxt(
+                    "EOF reached while reading image to compress"));
+        }
+        numBytesRead += bytesThisRead;
+    }
+}
+
+// Room for the codestream headers on top of the tile, same as the
+// OpenJPEG writer leaves with the local NITRO patch in
+// externals/nitro/patches
+const size_t HEADER_ROOM = 16384;
+
+/*
+ *  Owns the J2K objects for a single tile.  The container owns its
+ *  components once it's constructed.
+ */
+class TileEncoder
+{
+public:
+    TileEncoder() :
+        mContainer(NULL),
+        mWriter(NULL),
+        mIO(NULL)
+    {
+    }
+
+    ~TileEncoder()
+    {
+        if (mIO)
+        {
+            nrt_IOInterface_destruct(&mIO);
+        }
+        if (mWriter)
+        {
+            j2k_Writer_destruct(&mWriter);
+        }
+        if (mContainer)
+        {
+            j2k_Container_destruct(&mContainer);
+        }
+    }
+
+    void encode(const J2KWriteHandlerImpl& impl,
+                const types::RowCol<size_t>& dims,
+                const UByte* tile,
+                size_t tileSize,
+                std::vector<sys::ubyte>& encoded)
+    {
+        nrt_Error error;
+        j2k_Component** const components = static_cast<j2k_Component**>(
+                J2K_MALLOC(sizeof(j2k_Component*)));
+        if (!components)
+        {
+            throw except::Exception(Ctxt("Out of memory"));
+        }
+
+        components[0] = j2k_Component_construct(
+                static_cast<nrt_Uint32>(dims.col),
+                static_cast<nrt_Uint32>(dims.row),
+                static_cast<nrt_Uint32>(impl.numBits),
+                impl.isSigned ? NRT_TRUE : NRT_FALSE,
+                0, 0, 1, 1, &error);
+        if (!components[0])
+        {
+            J2K_FREE(components);
+            throw nitf::NITFException(&error);
+        }
+
+        // One tile, whose nominal size is the segment's block size
+        mContainer = j2k_Container_construct(
+                static_cast<nrt_Uint32>(dims.col),
+                static_cast<nrt_Uint32>(dims.row),
+                1,
+                components,
+                static_cast<nrt_Uint32>(impl.numColsPerTile),
+                static_cast<nrt_Uint32>(impl.numRowsPerTile),
+                J2K_TYPE_MONO,
+                &error);
+        if (!mContainer)
+        {
+            j2k_Component_destruct(&components[0]);
+            J2K_FREE(components);
+            throw nitf::NITFException(&error);
+        }
+
+        j2k_WriterOptions options;
+        memset(&options, 0, sizeof(j2k_WriterOptions));
+        options.compressionRatio = impl.compressionRatio;
+        options.numResolutions = impl.numResolutions;
+
+        mWriter = j2k_Writer_construct(mContainer, &options, &error);
+        if (!mWriter ||
+            !j2k_Writer_setTile(mWriter, 0, 0, tile,
+                                static_cast<nrt_Uint32>(tileSize), &error))
+        {
+            throw nitf::NITFException(&error);
+        }
+
+        const size_t rawSize = dims.area() * impl.numBytesPerPixel;
+        encoded.resize(rawSize + rawSize / 8 + HEADER_ROOM);
+        mIO = nrt_BufferAdapter_construct(
+                reinterpret_cast<char*>(&encoded[0]), encoded.size(),
+                NRT_FALSE, &error);
+        if (!mIO || !j2k_Writer_write(mWriter, mIO, &error))
+        {
+            throw nitf::NITFException(&error);
+        }
+
+        const nrt_Off encodedSize = nrt_IOInterface_tell(mIO, &error);
+        if (!NRT_IO_SUCCESS(encodedSize))
+        {
+            throw nitf::NITFException(&error);
+        }
+        encoded.resize(static_cast<size_t>(encodedSize));
+    }
+
+private:
+    j2k_Container* mContainer;
+    j2k_Writer* mWriter;
+    nrt_IOInterface* mIO;
+};
+
+/*
+ *  Encodes a range of the tiles in a band of tile rows, each one as its
+ *  own codestream
+ */
+class EncodeTilesRunnable : public sys::Runnable
+{
+public:
+    EncodeTilesRunnable(const J2KWriteHandlerImpl& impl,
+                        const UByte* band,
+                        size_t numBandRows,
+                        size_t startTile,
+                        size_t numTiles,
+                        std::vector<std::vector<sys::ubyte> >& encoded) :
+        mImpl(impl),
+        mBand(band),
+        mNumBandRows(numBandRows),
+        mStartTile(startTile),
+        mNumTiles(numTiles),
+        mEncoded(encoded)
+    {
+    }
+
+    virtual void run()
+    {
+        SIX_PROFILE_SCOPE("J2KWriteHandler::write/encodeTiles");
+
+        const size_t numTileCols =
+                getNumTiles(mImpl.numCols, mImpl.numColsPerTile);
+        const size_t nbpp = mImpl.numBytesPerPixel;
+        const size_t rowSize = mImpl.numCols * nbpp;
+        const size_t tileRowSize = mImpl.numColsPerTile * nbpp;
+        const bool doByteSwap = nbpp > 1 && !sys::isBigEndianSystem();
+
+        std::vector<UByte> tile;
+        for (size_t ii = mStartTile; ii < mStartTile + mNumTiles; ++ii)
+        {
+            const size_t firstRow = (ii / numTileCols) * mImpl.numRowsPerTile;
+            const size_t firstCol = (ii % numTileCols) * mImpl.numColsPerTile;
+            const types::RowCol<size_t> dims(
+                    std::min(mImpl.numRowsPerTile, mNumBandRows - firstRow),
+                    std::min(mImpl.numColsPerTile, mImpl.numCols - firstCol));
+
+            // Partial tiles keep the nominal row stride, which is what
+            // j2k_Writer_setTile() expects
+            tile.resize(tileRowSize * dims.row);
+            for (size_t row = 0; row < dims.row; ++row)
+            {
+                memcpy(&tile[row * tileRowSize],
+                       mBand + (firstRow + row) * rowSize + firstCol * nbpp,
+                       dims.col * nbpp);
+            }
+
+            // The compressor sees the pixels the same way the ImageWriter
+            // hands them to it, which is big endian
+            if (doByteSwap)
+            {
+                sys::byteSwap(&tile[0], static_cast<unsigned short>(nbpp),
+                              tile.size() / nbpp);
+            }
+
+            TileEncoder encoder;
+            encoder.encode(mImpl, dims, &tile[0], tile.size(), mEncoded[ii]);
+            SIX_PROFILE_BYTES("J2KWriteHandler::write/encodeTiles",
+                              dims.area() * nbpp);
+        }
+    }
+
+private:
+    const J2KWriteHandlerImpl& mImpl;
+    const UByte* const mBand;
+    const size_t mNumBandRows;
+    const size_t mStartTile;
+    const size_t mNumTiles;
+    std::vector<std::vector<sys::ubyte> >& mEncoded;
+};
+
+void encodeTiles(const J2KWriteHandlerImpl& impl,
+                 const UByte* band,
+                 size_t numBandRows,
+                 std::vector<std::vector<sys::ubyte> >& encoded)
+{
+    const size_t numThreads = std::min(impl.numThreads, encoded.size());
+    if (numThreads <= 1)
+    {
+        EncodeTilesRunnable(impl, band, numBandRows, 0, encoded.size(),
+                            encoded).run();
+        return;
+    }
+
+    mt::ThreadGroup threads;
+    const mt::ThreadPlanner planner(encoded.size(), numThreads);
+
+    size_t threadNum(0);
+    size_t startTile(0);
+    size_t numTilesThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startTile, numTilesThisThread))
+    {
+        threads.createThread(new EncodeTilesRunnable(
+                impl, band, numBandRows, startTile, numTilesThisThread,
+                encoded));
+    }
+    threads.joinAll();
+}
+
+void writeJ2K(const J2KWriteHandlerImpl& impl, nitf_IOInterface* io)
+{
+    const types::RowCol<size_t> imageDims(impl.numRows, impl.numCols);
+    const types::RowCol<size_t> tileDims(impl.numRowsPerTile,
+                                         impl.numColsPerTile);
+    const size_t numTileRows = getNumTiles(impl.numRows, impl.numRowsPerTile);
+    const size_t numTileCols = getNumTiles(impl.numCols, impl.numColsPerTile);
+    const size_t rowSize = impl.numCols * impl.numBytesPerPixel;
+
+    // Work a band of whole tile rows at a time, with enough tiles in it to
+    // keep every thread busy
+    const size_t numTileRowsPerBand = std::max<size_t>(
+            1, getNumTiles(impl.numThreads, numTileCols));
+
+    std::vector<UByte> bandBuffer;
+    std::vector<std::vector<sys::ubyte> > encoded;
+    size_t numEncodedBytes(0);
+    for (size_t tileRow = 0; tileRow < numTileRows;
+         tileRow += numTileRowsPerBand)
+    {
+        const size_t firstRow = tileRow * impl.numRowsPerTile;
+        const size_t numBandRows = std::min(
+                numTileRowsPerBand * impl.numRowsPerTile,
+                impl.numRows - firstRow);
+
+        const UByte* band;
+        if (impl.buffer)
+        {
+            band = impl.buffer + firstRow * rowSize;
+        }
+        else
+        {
+            SIX_PROFILE_SCOPE("J2KWriteHandler::write/read");
+            bandBuffer.resize(numBandRows * rowSize);
+            readBand(*impl.inputStream, &bandBuffer[0], bandBuffer.size());
+            band = &bandBuffer[0];
+        }
+
+        encoded.resize(getNumTiles(numBandRows, impl.numRowsPerTile) *
+                       numTileCols);
+        encodeTiles(impl, band, numBandRows, encoded);
+
+        // Splice them in order.  The first tile brings the main header.
+        SIX_PROFILE_SCOPE("J2KWriteHandler::write/splice");
+        for (size_t ii = 0; ii < encoded.size(); ++ii)
+        {
+            J2KCodestream codestream(&encoded[ii][0], encoded[ii].size());
+            codestream.setTileIndex(tileRow * numTileCols + ii);
+            if (tileRow == 0 && ii == 0)
+            {
+                codestream.setImageSize(imageDims, tileDims);
+                writeBytes(io, codestream.getMainHeader(),
+                           codestream.getMainHeaderSize());
+                numEncodedBytes += codestream.getMainHeaderSize();
+            }
+            writeBytes(io, codestream.getTileParts(),
+                       codestream.getTilePartsSize());
+            numEncodedBytes += codestream.getTilePartsSize();
+        }
+    }
+    writeBytes(io, J2KCodestream::END_OF_CODESTREAM,
+               sizeof(J2KCodestream::END_OF_CODESTREAM));
+    numEncodedBytes += sizeof(J2KCodestream::END_OF_CODESTREAM);
+
+    // Same as the plugin: Nxyz, the achieved bit rate for lossless
+    const size_t numRawBytes = imageDims.area() * impl.numBytesPerPixel;
+    const double comrat = static_cast<double>(numEncodedBytes) *
+            impl.numBits / numRawBytes;
+    NITF_SNPRINTF(impl.comratField->raw, impl.comratField->length + 1,
+                  "N%03d", static_cast<int>(comrat * 10.0 + 0.5));
+    SIX_PROFILE_BYTES("J2KWriteHandler::write", numRawBytes);
+}
+#else
+void writeJ2K(const J2KWriteHandlerImpl& , nitf_IOInterface* )
+{
+    throw except::Exception(Ctxt("SIX was built without J2K support"));
+}
+#endif
+}
+
+extern "C" void __six_J2KWriteHandler_destruct(NITF_DATA * data)
+{
+    J2KWriteHandlerImpl *impl = (J2KWriteHandlerImpl *) data;
+    if (impl)
+        NITF_FREE(impl);
+}
+
+extern "C" NITF_BOOL __six_J2KWriteHandler_write(NITF_DATA * data,
+        nitf_IOInterface* io, nitf_Error * error)
+{
+    SIX_PROFILE_SCOPE("J2KWriteHandler::write");
+
+    try
+    {
+        writeJ2K(*(J2KWriteHandlerImpl *) data, io);
+        return NITF_SUCCESS;
+    }
+    catch (const except::Exception& ex)
+    {
+        nitf_Error_init(error, ex.getMessage().c_str(), NITF_CTXT,
+                        NITF_ERR_COMPRESSION);
+    }
+    catch (const std::exception& ex)
+    {
+        nitf_Error_init(error, ex.what(), NITF_CTXT, NITF_ERR_COMPRESSION);
+    }
+    return NITF_FAILURE;
+}
+
+J2KWriteHandler::J2KWriteHandler(nitf::ImageSubheader subheader,
+        const UByte* buffer, size_t numThreads,
+        const std::map<std::string, void*>& options)
+{
+    initialize(subheader, buffer, NULL, numThreads, options);
+}
+
+J2KWriteHandler::J2KWriteHandler(nitf::ImageSubheader subheader,
+        io::InputStream* is, size_t numThreads,
+        const std::map<std::string, void*>& options)
+{
+    initialize(subheader, NULL, is, numThreads, options);
+}
+
+void J2KWriteHandler::initialize(nitf::ImageSubheader subheader,
+        const UByte* buffer, io::InputStream* is, size_t numThreads,
+        const std::map<std::string, void*>& options)
+{
+    if (!canWrite(subheader, options))
+    {
+        throw except::Exception(Ctxt(
+                "Image segment can't be written with J2KWriteHandler"));
+    }
+
+    static nitf_IWriteHandler iWriteHandler =
+            { &__six_J2KWriteHandler_write,
+              &__six_J2KWriteHandler_destruct };
+
+    const types::RowCol<size_t> tileDims(getTileDims(subheader));
+    std::string pvtype = subheader.getPixelValueType().toString();
+    str::trim(pvtype);
+
+    J2KWriteHandlerImpl *impl =
+            (J2KWriteHandlerImpl *) NITF_MALLOC(sizeof(J2KWriteHandlerImpl));
+    if (!impl)
+        throw nitf::NITFException(Ctxt("Out of memory"));
+    impl->buffer = buffer;
+    impl->inputStream = is;
+    impl->numRows = static_cast<nitf::Uint32>(subheader.getNumRows());
+    impl->numCols = static_cast<nitf::Uint32>(subheader.getNumCols());
+    impl->numRowsPerTile = tileDims.row;
+    impl->numColsPerTile = tileDims.col;
+    impl->numBytesPerPixel =
+            static_cast<nitf::Uint32>(subheader.getNumBitsPerPixel()) / 8;
+    impl->numBits =
+            static_cast<nitf::Uint32>(subheader.getActualBitsPerPixel());
+    impl->isSigned = (pvtype == "SI");
+    impl->numThreads = std::max<size_t>(numThreads, 1);
+
+    const double* const compressionRatio =
+            findOption<double>(options, C8_COMPRESSION_RATIO_KEY);
+    impl->compressionRatio = compressionRatio ? *compressionRatio : 0.0;
+    impl->numResolutions =
+            static_cast<nitf::Uint32>(getNumResolutions(tileDims, options));
+    impl->comratField = subheader.getCompressionRate().getNativeOrThrow();
+
+    nitf_SegmentWriter *segmentWriter =
+            (nitf_SegmentWriter *) NITF_MALLOC(sizeof(nitf_SegmentWriter));
+    if (!segmentWriter)
+    {
+        NITF_FREE(impl);
+        throw nitf::NITFException(Ctxt("Out of memory"));
+    }
+    segmentWriter->data = impl;
+    segmentWriter->iface = &iWriteHandler;
+
+    setNative(segmentWriter);
+    setManaged(false);
+}
+
+bool J2KWriteHandler::isAvailable()
+{
+#ifdef HAVE_J2K_H
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool J2KWriteHandler::canWrite(nitf::ImageSubheader subheader,
+                               const std::map<std::string, void*>& options)
+{
+    if (!isAvailable())
+    {
+        return false;
+    }
+
+    std::string ic = subheader.getImageCompression().toString();
+    std::string imode = subheader.getImageMode().toString();
+    std::string pvtype = subheader.getPixelValueType().toString();
+    str::trim(ic);
+    str::trim(imode);
+    str::trim(pvtype);
+
+    const nitf::Uint32 nbpp =
+            static_cast<nitf::Uint32>(subheader.getNumBitsPerPixel());
+    const nitf::Uint32 abpp =
+            static_cast<nitf::Uint32>(subheader.getActualBitsPerPixel());
+    if (ic != "C8" || imode != "B" || subheader.getBandCount() != 1 ||
+        (pvtype != "INT" && pvtype != "SI") ||
+        (nbpp != 8 && nbpp != 16) || abpp == 0 || abpp > nbpp)
+    {
+        return false;
+    }
+
+    const types::RowCol<size_t> tileDims(getTileDims(subheader));
+    const size_t numTiles =
+            getNumTiles(static_cast<nitf::Uint32>(subheader.getNumRows()),
+                        tileDims.row) *
+            getNumTiles(static_cast<nitf::Uint32>(subheader.getNumCols()),
+                        tileDims.col);
+
+    return numTiles > 1 &&
+           J2KCodestream::isTileAligned(tileDims,
+                                        getNumResolutions(tileDims, options));
+}
@@ -0,0 +1,140 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#if !defined(WIN32) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <except/Exception.h>
+#include <six/MappedFile.h>
+
+namespace six
+{
+#if defined(WIN32) || defined(_WIN32)
+MappedFile::MappedFile(const std::string& pathname) :
+    mData(NULL),
+    mSize(0),
+    mFile(INVALID_HANDLE_VALUE),
+    mMapping(NULL)
+{
+    mFile = ::CreateFileA(pathname.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                          NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        throw except::Exception(Ctxt("Unable to open " + pathname));
+    }
+
+    LARGE_INTEGER size;
+    if (!::GetFileSizeEx(mFile, &size))
+    {
+        unmap();
+        throw except::Exception(Ctxt("Unable to get the size of " +
+                                     pathname));
+    }
+    mSize = static_cast<size_t>(size.QuadPart);
+
+    // Empty files can't be mapped, and there's nothing to read anyway
+    if (mSize > 0)
+    {
+        mMapping = ::CreateFileMapping(mFile, NULL, PAGE_READONLY, 0, 0,
+                                       NULL);
+        const void* const data = (mMapping == NULL) ? NULL :
+                ::MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+        if (data == NULL)
+        {
+            unmap();
+            throw except::Exception(Ctxt("Unable to map " + pathname));
+        }
+        mData = static_cast<const sys::ubyte*>(data);
+    }
+}
+
+void MappedFile::unmap()
+{
+    if (mData)
+    {
+        ::UnmapViewOfFile(mData);
+        mData = NULL;
+    }
+    if (mMapping != NULL)
+    {
+        ::CloseHandle(mMapping);
+        mMapping = NULL;
+    }
+    if (mFile != INVALID_HANDLE_VALUE)
+    {
+        ::CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+    }
+}
+#else
+MappedFile::MappedFile(const std::string& pathname) :
+    mData(NULL),
+    mSize(0)
+{
+    const int fd = ::open(pathname.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw except::Exception(Ctxt("Unable to open " + pathname));
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        throw except::Exception(Ctxt("Unable to stat " + pathname));
+    }
+
+    // Empty files can't be mapped, and there's nothing to read anyway
+    mSize = static_cast<size_t>(status.st_size);
+    if (mSize > 0)
+    {
+        void* const data = ::mmap(NULL, mSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            throw except::Exception(Ctxt("Unable to map " + pathname));
+        }
+        mData = static_cast<const sys::ubyte*>(data);
+    }
+
+    // The mapping keeps the file alive
+    ::close(fd);
+}
+
+void MappedFile::unmap()
+{
+    if (mData)
+    {
+        ::munmap(const_cast<sys::ubyte*>(mData), mSize);
+        mData = NULL;
+    }
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+}
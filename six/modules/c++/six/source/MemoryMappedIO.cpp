@@ -0,0 +1,106 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <six/MemoryMappedIO.h>
+
+namespace six
+{
+MemoryMappedIO::MemoryMappedIO(const std::string& pathname) :
+    mPathname(pathname),
+    mFile(pathname),
+    mData(mFile.getData()),
+    mSize(mFile.getNumBytes()),
+    mOffset(0)
+{
+}
+
+void MemoryMappedIO::readImpl(void* buffer, size_t size)
+{
+    if (mOffset < 0 || static_cast<size_t>(mOffset) > mSize ||
+        size > mSize - static_cast<size_t>(mOffset))
+    {
+        throw except::Exception(Ctxt(
+                "Read of " + str::toString(size) + " bytes at offset " +
+                str::toString(mOffset) + " is past the end of " +
+                mPathname));
+    }
+
+    ::memcpy(buffer, mData + mOffset, size);
+    mOffset += static_cast<nitf::Off>(size);
+}
+
+void MemoryMappedIO::writeImpl(const void* , size_t )
+{
+    throw except::Exception(
+            Ctxt("MemoryMappedIO cannot perform writes. "
+                 "It is a read-only handle."));
+}
+
+bool MemoryMappedIO::canSeekImpl() const
+{
+    return true;
+}
+
+nitf::Off MemoryMappedIO::seekImpl(nitf::Off offset, int whence)
+{
+    switch (whence)
+    {
+    case NITF_SEEK_SET:
+        mOffset = offset;
+        break;
+    case NITF_SEEK_CUR:
+        mOffset += offset;
+        break;
+    case NITF_SEEK_END:
+        mOffset = static_cast<nitf::Off>(mSize) + offset;
+        break;
+    default:
+        throw except::Exception(
+                Ctxt("Unknown whence value when seeking MemoryMappedIO: " +
+                     str::toString(whence)));
+    }
+
+    return mOffset;
+}
+
+nitf::Off MemoryMappedIO::tellImpl() const
+{
+    return mOffset;
+}
+
+nitf::Off MemoryMappedIO::getSizeImpl() const
+{
+    return static_cast<nitf::Off>(mSize);
+}
+
+int MemoryMappedIO::getModeImpl() const
+{
+    return NITF_ACCESS_READONLY;
+}
+
+void MemoryMappedIO::closeImpl()
+{
+}
+}
@@ -20,14 +20,457 @@
  *
  */
 
+#include <string.h>
+
+#include <map>
+#include <memory>
 #include <sstream>
 
+#include <sys/OS.h>
+#include <mt/CriticalSection.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+#include <six/DirectIO.h>
 #include <six/NITFReadControl.h>
+#include <six/Profiler.h>
+#include <six/SharedIOView.h>
 #include <six/XMLControlFactory.h>
 #include <six/Utilities.h>
 
 namespace
 {
+// Image data in a NITF is big-endian
+inline sys::Uint16_T swapBytes(sys::Uint16_T value)
+{
+    return static_cast<sys::Uint16_T>((value >> 8) | (value << 8));
+}
+
+inline sys::Uint32_T swapBytes(sys::Uint32_T value)
+{
+    return (value >> 24) | ((value >> 8) & 0x0000FF00) |
+            ((value << 8) & 0x00FF0000) | (value << 24);
+}
+
+inline sys::Uint64_T swapBytes(sys::Uint64_T value)
+{
+    return (static_cast<sys::Uint64_T>(
+                    swapBytes(static_cast<sys::Uint32_T>(value))) << 32) |
+            swapBytes(static_cast<sys::Uint32_T>(value >> 32));
+}
+
+template <typename UintT>
+void copySwapped(const sys::ubyte* input,
+                 size_t numElements,
+                 sys::ubyte* output)
+{
+    for (size_t ii = 0; ii < numElements; ++ii)
+    {
+        UintT value;
+        ::memcpy(&value, input + ii * sizeof(UintT), sizeof(UintT));
+        value = swapBytes(value);
+        ::memcpy(output + ii * sizeof(UintT), &value, sizeof(UintT));
+    }
+}
+
+// Copies big-endian elements, putting them in native byte order
+void copyBigEndian(const sys::ubyte* input,
+                   size_t elementSize,
+                   size_t numElements,
+                   sys::ubyte* output)
+{
+    if (elementSize == 1 || sys::isBigEndianSystem())
+    {
+        ::memcpy(output, input, elementSize * numElements);
+        return;
+    }
+
+    switch (elementSize)
+    {
+    case 2:
+        copySwapped<sys::Uint16_T>(input, numElements, output);
+        break;
+    case 4:
+        copySwapped<sys::Uint32_T>(input, numElements, output);
+        break;
+    case 8:
+        copySwapped<sys::Uint64_T>(input, numElements, output);
+        break;
+    default:
+        throw except::Exception(Ctxt(
+                "Can't swap " + str::toString(elementSize) +
+                " byte elements"));
+    }
+}
+
+// Promotes big-endian 16-bit integers to floats in one pass
+void promoteInt16(const sys::ubyte* input,
+                  size_t numElements,
+                  bool swap,
+                  float* output)
+{
+    // Separate loops so there's no branch inside them
+    sys::Uint16_T value;
+    if (swap)
+    {
+        for (size_t ii = 0; ii < numElements; ++ii)
+        {
+            ::memcpy(&value, input + ii * sizeof(value), sizeof(value));
+            output[ii] = static_cast<sys::Int16_T>(swapBytes(value));
+        }
+    }
+    else
+    {
+        for (size_t ii = 0; ii < numElements; ++ii)
+        {
+            ::memcpy(&value, input + ii * sizeof(value), sizeof(value));
+            output[ii] = static_cast<sys::Int16_T>(value);
+        }
+    }
+}
+
+// The part of a sub-window that falls in one block, in segment coordinates
+struct BlockWindow
+{
+    size_t startRow;
+    size_t numRows;
+    size_t startCol;
+    size_t numCols;
+};
+
+class ReadBlocksRunnable : public sys::Runnable
+{
+public:
+    ReadBlocksRunnable(nitf::ImageReader imageReader,
+                       const BlockWindow* blocks,
+                       size_t numBlocks,
+                       const types::RowCol<size_t>& outputOffset,
+                       size_t outputNumCols,
+                       size_t numBytesPerPixel,
+                       nitf::Uint8* output) :
+        mImageReader(imageReader),
+        mBlocks(blocks),
+        mNumBlocks(numBlocks),
+        mOutputOffset(outputOffset),
+        mOutputNumCols(outputNumCols),
+        mNumBytesPerPixel(numBytesPerPixel),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        SIX_PROFILE_SCOPE("NITFReadControl::interleaved/readBlocks");
+
+        nitf::Uint32 bandList(0);
+        nitf::SubWindow sw;
+        sw.setNumBands(1);
+        sw.setBandList(&bandList);
+
+        const size_t outputRowSize = mOutputNumCols * mNumBytesPerPixel;
+        std::vector<nitf::Uint8> blockBuffer;
+        for (size_t ii = 0; ii < mNumBlocks; ++ii)
+        {
+            const BlockWindow& block(mBlocks[ii]);
+            sw.setStartRow(static_cast<nitf::Uint32>(block.startRow));
+            sw.setNumRows(static_cast<nitf::Uint32>(block.numRows));
+            sw.setStartCol(static_cast<nitf::Uint32>(block.startCol));
+            sw.setNumCols(static_cast<nitf::Uint32>(block.numCols));
+
+            const size_t rowSize = block.numCols * mNumBytesPerPixel;
+            blockBuffer.resize(block.numRows * rowSize);
+            nitf::Uint8* bufferPtr = &blockBuffer[0];
+            int padded;
+            mImageReader.read(sw, &bufferPtr, &padded);
+
+            // Scatter the rows into place
+            const nitf::Uint8* input = &blockBuffer[0];
+            nitf::Uint8* output = mOutput +
+                    (block.startRow - mOutputOffset.row) * outputRowSize +
+                    (block.startCol - mOutputOffset.col) * mNumBytesPerPixel;
+            for (size_t row = 0;
+                 row < block.numRows;
+                 ++row, input += rowSize, output += outputRowSize)
+            {
+                ::memcpy(output, input, rowSize);
+            }
+        }
+    }
+
+private:
+    nitf::ImageReader mImageReader;
+    const BlockWindow* const mBlocks;
+    const size_t mNumBlocks;
+    const types::RowCol<size_t> mOutputOffset;
+    const size_t mOutputNumCols;
+    const size_t mNumBytesPerPixel;
+    nitf::Uint8* const mOutput;
+};
+
+// Rows [firstRow, firstRow + numRows) of an image live in image segment
+// 'imageSeg'
+struct SegmentRows
+{
+    size_t imageSeg;
+    size_t firstRow;
+    size_t numRows;
+};
+
+// How a pixel splits into the bands the downsamplers work on
+struct DecimationLayout
+{
+    size_t numChannels;
+    size_t channelSize;
+    nitf::Uint32 pixelType;
+};
+
+DecimationLayout getDecimationLayout(six::PixelType pixelType,
+                                     six::Region::DecimationType type)
+{
+    DecimationLayout layout;
+    layout.pixelType = NITF_PIXEL_TYPE_INT;
+    switch (pixelType)
+    {
+    case six::PixelType::RE32F_IM32F:
+        layout.numChannels = 2;
+        layout.channelSize = 4;
+        layout.pixelType = NITF_PIXEL_TYPE_R;
+        break;
+    case six::PixelType::RE16I_IM16I:
+        layout.numChannels = 2;
+        layout.channelSize = 2;
+        layout.pixelType = NITF_PIXEL_TYPE_SI;
+        break;
+    case six::PixelType::AMP8I_PHS8I:
+        layout.numChannels = 2;
+        layout.channelSize = 1;
+        break;
+    case six::PixelType::MONO16I:
+        layout.numChannels = 1;
+        layout.channelSize = 2;
+        break;
+    case six::PixelType::RGB24I:
+        layout.numChannels = 3;
+        layout.channelSize = 1;
+        break;
+    case six::PixelType::MONO8I:
+    case six::PixelType::MONO8LU:
+    case six::PixelType::RGB8LU:
+        layout.numChannels = 1;
+        layout.channelSize = 1;
+        break;
+    default:
+        throw except::Exception(Ctxt(
+                "Unable to decimate pixel type " + pixelType.toString()));
+    }
+
+    // Only pixel skip makes sense for amplitude/phase pairs and lookup
+    // table indices
+    const bool isComplex =
+            (pixelType == six::PixelType::RE32F_IM32F ||
+             pixelType == six::PixelType::RE16I_IM16I);
+    const bool canCompare =
+            (pixelType == six::PixelType::MONO8I ||
+             pixelType == six::PixelType::MONO16I ||
+             pixelType == six::PixelType::RGB24I);
+    if (type == six::Region::MAX && !canCompare)
+    {
+        throw except::Exception(Ctxt(
+                "Max decimation isn't supported for pixel type " +
+                pixelType.toString() +
+                (isComplex ? ", use sum of squares" : "")));
+    }
+    if (type == six::Region::SUM_SQUARES && !isComplex)
+    {
+        throw except::Exception(Ctxt(
+                "Sum of squares decimation requires complex data, not " +
+                pixelType.toString()));
+    }
+
+    return layout;
+}
+
+std::auto_ptr<nitf::DownSampler>
+createDownSampler(const six::Region& region)
+{
+    const nitf::Uint32 rowSkip =
+            static_cast<nitf::Uint32>(region.getRowDecimation());
+    const nitf::Uint32 colSkip =
+            static_cast<nitf::Uint32>(region.getColDecimation());
+
+    std::auto_ptr<nitf::DownSampler> downSampler;
+    switch (region.getDecimationType())
+    {
+    case six::Region::PIXEL_SKIP:
+        downSampler.reset(new nitf::PixelSkip(rowSkip, colSkip));
+        break;
+    case six::Region::MAX:
+        downSampler.reset(new nitf::MaxDownSample(rowSkip, colSkip));
+        break;
+    case six::Region::SUM_SQUARES:
+        downSampler.reset(new nitf::SumSq2DownSample(rowSkip, colSkip));
+        break;
+    }
+    return downSampler;
+}
+
+// Decimates a range of output rows of a region.  Only the full resolution
+// rows that feed those output rows are read, one sample window at a time.
+// Each one has a downsampler of its own, since a nitf::DownSampler keeps
+// its error state in the object and so can't be shared between threads.
+class ReadDecimatedRunnable : public sys::Runnable
+{
+public:
+    ReadDecimatedRunnable(const std::map<size_t, nitf::ImageReader>&
+                                  imageReaders,
+                          const std::vector<SegmentRows>& segments,
+                          const six::Region& region,
+                          const DecimationLayout& layout,
+                          size_t startOutputRow,
+                          size_t numOutputRows,
+                          nitf::Uint8* output) :
+        mImageReaders(imageReaders),
+        mSegments(segments),
+        mRegion(region),
+        mLayout(layout),
+        mDownSampler(createDownSampler(region)),
+        mStartOutputRow(startOutputRow),
+        mNumOutputRows(numOutputRows),
+        mOutput(output)
+    {
+    }
+
+    virtual void run()
+    {
+        SIX_PROFILE_SCOPE("NITFReadControl::interleaved/readDecimated");
+
+        const size_t rowDecimation = mRegion.getRowDecimation();
+        const size_t colDecimation = mRegion.getColDecimation();
+        const size_t startRow = mRegion.getStartRow();
+        const size_t endRow = startRow + mRegion.getNumRows();
+        const size_t numCols = mRegion.getNumCols();
+        const size_t numOutputCols =
+                (numCols + colDecimation - 1) / colDecimation;
+        const size_t colsInLastWindow =
+                numCols - (numOutputCols - 1) * colDecimation;
+        const size_t numChannels = mLayout.numChannels;
+        const size_t channelSize = mLayout.channelSize;
+        const size_t pixelSize = numChannels * channelSize;
+        const size_t maxWindowRows =
+                (mRegion.getDecimationType() == six::Region::PIXEL_SKIP) ?
+                        1 : rowDecimation;
+
+        std::vector<nitf::Uint8> rows(maxWindowRows * numCols * pixelSize);
+        std::vector<nitf::Uint8> inputBands(rows.size());
+        std::vector<nitf::Uint8> outputBands(numOutputCols * pixelSize);
+        std::vector<NITF_DATA*> inputWindows(numChannels);
+        std::vector<NITF_DATA*> outputWindows(numChannels);
+
+        for (size_t outRow = mStartOutputRow;
+             outRow < mStartOutputRow + mNumOutputRows;
+             ++outRow)
+        {
+            const size_t firstRow = startRow + outRow * rowDecimation;
+            const size_t numWindowRows =
+                    std::min(maxWindowRows, endRow - firstRow);
+            readRows(firstRow, numWindowRows, numCols * pixelSize, &rows[0]);
+
+            // The downsamplers want each band in its own buffer
+            const size_t numPixels = numWindowRows * numCols;
+            const size_t bandSize = numPixels * channelSize;
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                const nitf::Uint8* in = &rows[channel * channelSize];
+                nitf::Uint8* out = &inputBands[channel * bandSize];
+                for (size_t ii = 0;
+                     ii < numPixels;
+                     ++ii, in += pixelSize, out += channelSize)
+                {
+                    ::memcpy(out, in, channelSize);
+                }
+                inputWindows[channel] = &inputBands[channel * bandSize];
+                outputWindows[channel] =
+                        &outputBands[channel * numOutputCols * channelSize];
+            }
+
+            mDownSampler->apply(
+                    &inputWindows[0],
+                    &outputWindows[0],
+                    static_cast<nitf::Uint32>(numChannels),
+                    1,
+                    static_cast<nitf::Uint32>(numOutputCols),
+                    static_cast<nitf::Uint32>(numCols),
+                    static_cast<nitf::Uint32>(numOutputCols),
+                    mLayout.pixelType,
+                    static_cast<nitf::Uint32>(channelSize),
+                    static_cast<nitf::Uint32>(numWindowRows),
+                    static_cast<nitf::Uint32>(colsInLastWindow));
+
+            nitf::Uint8* const outputRow =
+                    mOutput + outRow * numOutputCols * pixelSize;
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                const nitf::Uint8* in =
+                        &outputBands[channel * numOutputCols * channelSize];
+                nitf::Uint8* out = outputRow + channel * channelSize;
+                for (size_t ii = 0;
+                     ii < numOutputCols;
+                     ++ii, in += channelSize, out += pixelSize)
+                {
+                    ::memcpy(out, in, channelSize);
+                }
+            }
+        }
+    }
+
+private:
+    // Reads full resolution rows, which may span segments
+    void readRows(size_t firstRow,
+                  size_t numRows,
+                  size_t rowSize,
+                  nitf::Uint8* buffer)
+    {
+        nitf::Uint32 bandList(0);
+        nitf::SubWindow sw;
+        sw.setStartCol(static_cast<nitf::Uint32>(mRegion.getStartCol()));
+        sw.setNumCols(static_cast<nitf::Uint32>(mRegion.getNumCols()));
+        sw.setNumBands(1);
+        sw.setBandList(&bandList);
+
+        const size_t endRow = firstRow + numRows;
+        for (size_t ii = 0; ii < mSegments.size() && firstRow < endRow; ++ii)
+        {
+            const SegmentRows& segment(mSegments[ii]);
+            const size_t segEndRow = segment.firstRow + segment.numRows;
+            if (firstRow >= segEndRow)
+            {
+                continue;
+            }
+
+            const size_t numRowsSeg = std::min(endRow, segEndRow) - firstRow;
+            sw.setStartRow(static_cast<nitf::Uint32>(
+                    firstRow - segment.firstRow));
+            sw.setNumRows(static_cast<nitf::Uint32>(numRowsSeg));
+
+            int padded;
+            mImageReaders.find(segment.imageSeg)->second.read(
+                    sw, &buffer, &padded);
+            buffer += numRowsSeg * rowSize;
+            firstRow += numRowsSeg;
+        }
+    }
+
+private:
+    // Keyed by image segment, with one for each of mSegments
+    std::map<size_t, nitf::ImageReader> mImageReaders;
+    const std::vector<SegmentRows>& mSegments;
+    const six::Region& mRegion;
+    const DecimationLayout mLayout;
+    const std::auto_ptr<nitf::DownSampler> mDownSampler;
+    const size_t mStartOutputRow;
+    const size_t mNumOutputRows;
+    nitf::Uint8* const mOutput;
+};
+
 types::RowCol<size_t> parseILOC(const std::string& str)
 {
     // First 5 digits are the row
@@ -81,7 +524,16 @@ six::PixelType getPixelType(nitf::ImageSubheader& subheader)
 
 namespace six
 {
-NITFReadControl::NITFReadControl()
+const char NITFReadControl::OPT_BLOCK_CACHE_BLOCKS[] = "BlockCacheBlocks";
+const char NITFReadControl::OPT_BLOCK_CACHE_BYTES[] = "BlockCacheBytes";
+const char NITFReadControl::OPT_NUM_DECODE_THREADS[] = "NumDecodeThreads";
+const char NITFReadControl::OPT_MEMORY_MAP[] = "MemoryMap";
+const char NITFReadControl::OPT_DIRECT_IO[] = "DirectIO";
+const char NITFReadControl::OPT_DIRECT_IO_QUEUE_DEPTH[] =
+        "DirectIOQueueDepth";
+
+NITFReadControl::NITFReadControl() :
+    mMappedIO(NULL)
 {
     // Make sure that if we use XML_DATA_CONTENT that we've loaded it into the
     // singleton PluginRegistry
@@ -240,8 +692,43 @@ void NITFReadControl::validateSegment(nitf::ImageSubheader subheader,
 void NITFReadControl::load(const std::string& fromFile,
                            const std::vector<std::string>& schemaPaths)
 {
-    mem::SharedPtr<nitf::IOInterface> handle(new nitf::IOHandle(fromFile));
+    mem::SharedPtr<nitf::IOInterface> handle;
+    if (static_cast<sys::Uint32_T>(
+            mOptions.getParameter(OPT_MEMORY_MAP, Parameter(0))) != 0)
+    {
+        try
+        {
+            handle.reset(new MemoryMappedIO(fromFile));
+        }
+        catch (const except::Exception& ex)
+        {
+            mLog->warn(Ctxt("Reading " + fromFile + " without mapping it: " +
+                            ex.getMessage()));
+        }
+    }
+    if (!handle.get() &&
+        static_cast<sys::Uint32_T>(
+                mOptions.getParameter(OPT_DIRECT_IO, Parameter(0))) != 0)
+    {
+        const size_t queueDepth = static_cast<sys::Uint32_T>(
+                mOptions.getParameter(
+                        OPT_DIRECT_IO_QUEUE_DEPTH,
+                        Parameter(DirectIO::DEFAULT_QUEUE_DEPTH)));
+        handle.reset(new DirectIO(fromFile, NITF_ACCESS_READONLY,
+                                  DirectIO::DEFAULT_CHUNK_SIZE, queueDepth));
+    }
+    if (!handle.get())
+    {
+        handle.reset(new nitf::IOHandle(fromFile));
+    }
     load(handle, schemaPaths);
+
+    // Concurrent reads share a descriptor of their own, unless they can
+    // all read the mapping.  It's only opened if they're ever needed.
+    if (!mMappedIO)
+    {
+        mFilePathname = fromFile;
+    }
 }
 
 void NITFReadControl::load(io::SeekableInputStream& stream,
@@ -259,10 +746,19 @@ void NITFReadControl::load(mem::SharedPtr<nitf::IOInterface> ioInterface)
 void NITFReadControl::load(mem::SharedPtr<nitf::IOInterface> ioInterface,
                            const std::vector<std::string>& schemaPaths)
 {
+    SIX_PROFILE_SCOPE("NITFReadControl::load");
+
     reset();
     mInterface = ioInterface;
+    mMappedIO = dynamic_cast<const MemoryMappedIO*>(ioInterface.get());
+
+    // Every image reader is made with the same options
+    createCompressionOptions(mCompressionOptions);
 
-    mRecord = mReader.readIO(*ioInterface);
+    {
+        SIX_PROFILE_SCOPE("NITFReadControl::load/readNITF");
+        mRecord = mReader.readIO(*ioInterface);
+    }
     DataType dataType = getDataType(mRecord);
     mContainer.reset(new Container(dataType));
 
@@ -282,12 +778,18 @@ void NITFReadControl::load(mem::SharedPtr<nitf::IOInterface> ioInterface,
         }
 
         nitf::SegmentReader deReader = mReader.newDEReader(i);
+        SIX_PROFILE_BYTES("NITFReadControl::load/parseDES",
+                          deReader.getSize());
         SegmentInputStreamAdapter ioAdapter(deReader);
-        std::auto_ptr<Data> data(parseData(*mXMLRegistry,
-                                           ioAdapter,
-                                           dataType,
-                                           schemaPaths,
-                                           *mLog));
+        std::auto_ptr<Data> data;
+        {
+            SIX_PROFILE_SCOPE("NITFReadControl::load/parseDES");
+            data = parseData(*mXMLRegistry,
+                             ioAdapter,
+                             dataType,
+                             schemaPaths,
+                             *mLog);
+        }
         if (data.get() == NULL)
         {
             throw except::Exception(Ctxt("Unable to transform XML DES"));
@@ -380,6 +882,13 @@ void NITFReadControl::load(mem::SharedPtr<nitf::IOInterface> ioInterface,
 
         NITFImageInfo* const currentInfo = mInfos[imageAndSegment.first];
 
+        // Reduced resolution levels aren't part of the image itself
+        if (isPyramidLevel(subheader))
+        {
+            currentInfo->addPyramidLevel(nitfSegmentIdx);
+            continue;
+        }
+
         const size_t productSegmentIdx = imageAndSegment.second;
 
         // We have to enforce a number of rules, namely that the #
@@ -431,6 +940,105 @@ void NITFReadControl::load(mem::SharedPtr<nitf::IOInterface> ioInterface,
 
         currentInfo->addSegment(si);
     }
+
+    findMappedSegments();
+}
+
+void NITFReadControl::findMappedSegments()
+{
+    mMappedSegments.clear();
+    if (!mMappedIO)
+    {
+        return;
+    }
+
+    mMappedSegments.resize(mRecord.getNumImages());
+    nitf::List images = mRecord.getImages();
+    nitf::ListIterator imageIter = images.begin();
+    for (size_t imageSeg = 0; imageIter != images.end();
+         ++imageIter, ++imageSeg)
+    {
+        nitf::ImageSegment segment = (nitf::ImageSegment) *imageIter;
+        nitf::ImageSubheader subheader = segment.getSubheader();
+
+        std::string compression =
+                subheader.getImageCompression().toString();
+        str::trim(compression);
+        std::string imageMode = subheader.getImageMode().toString();
+        str::trim(imageMode);
+
+        const size_t numRows = static_cast<nitf::Uint32>(
+                subheader.getNumRows());
+        const size_t numCols = static_cast<nitf::Uint32>(
+                subheader.getNumCols());
+        const size_t numBands = subheader.getBandCount();
+        const size_t numBitsPerPixel = static_cast<nitf::Uint32>(
+                subheader.getNumBitsPerPixel());
+        const size_t numBlocks =
+                static_cast<size_t>(static_cast<nitf::Uint32>(
+                        subheader.getNumBlocksPerRow())) *
+                static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol());
+        const size_t numColsPerBlock = static_cast<nitf::Uint32>(
+                subheader.getNumPixelsPerHorizBlock());
+
+        // Rows of pixels, with their bands interleaved, one after the other
+        // with no padding in between
+        if (compression != "NC" || numBlocks != 1 ||
+            (numColsPerBlock != 0 && numColsPerBlock != numCols) ||
+            (numBands > 1 && imageMode != "P") ||
+            (numBitsPerPixel != 8 && numBitsPerPixel != 16 &&
+             numBitsPerPixel != 32 && numBitsPerPixel != 64))
+        {
+            continue;
+        }
+
+        const size_t elementSize = numBitsPerPixel / 8;
+        const sys::Uint64_T offset = segment.getImageOffset();
+        const sys::Uint64_T numBytes = static_cast<sys::Uint64_T>(numRows) *
+                numCols * numBands * elementSize;
+        if (offset + numBytes > segment.getImageEnd() ||
+            offset + numBytes > mMappedIO->getNumBytes())
+        {
+            continue;
+        }
+
+        MappedSegment& mapped(mMappedSegments[imageSeg]);
+        mapped.pixels = mMappedIO->getData() + offset;
+        mapped.numCols = numCols;
+        mapped.numBytesPerPixel = numBands * elementSize;
+        mapped.elementSize = elementSize;
+    }
+}
+
+bool NITFReadControl::readMapped(size_t imageSeg,
+                                 const nitf::SubWindow& subWindow,
+                                 size_t numBytesPerPixel,
+                                 nitf::Uint8* buffer) const
+{
+    if (imageSeg >= mMappedSegments.size() ||
+        mMappedSegments[imageSeg].pixels == NULL ||
+        mMappedSegments[imageSeg].numBytesPerPixel != numBytesPerPixel)
+    {
+        return false;
+    }
+
+    SIX_PROFILE_SCOPE("NITFReadControl::interleaved/readMapped");
+    const MappedSegment& segment(mMappedSegments[imageSeg]);
+    const size_t numRows = subWindow.getNumRows();
+    const size_t rowSize = subWindow.getNumCols() * numBytesPerPixel;
+    const size_t numElementsPerRow = rowSize / segment.elementSize;
+
+    const sys::ubyte* input = segment.pixels +
+            (static_cast<size_t>(subWindow.getStartRow()) * segment.numCols +
+             subWindow.getStartCol()) * numBytesPerPixel;
+    const size_t inputRowSize = segment.numCols * numBytesPerPixel;
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        copyBigEndian(input, segment.elementSize, numElementsPerRow,
+                      buffer + row * rowSize);
+        input += inputRowSize;
+    }
+    return true;
 }
 
 void NITFReadControl::addImageClassOptions(nitf::ImageSubheader& subheader,
@@ -592,19 +1200,10 @@ NITFReadControl::getIndices(nitf::ImageSubheader& subheader) const
 
 UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
 {
-    NITFImageInfo* thisImage = mInfos[imageNumber];
+    SIX_PROFILE_SCOPE("NITFReadControl::interleaved");
 
-    size_t numRowsTotal = thisImage->getData()->getNumRows();
-    size_t numColsTotal = thisImage->getData()->getNumCols();
-
-    if (region.getNumRows() == -1)
-    {
-        region.setNumRows(numRowsTotal);
-    }
-    if (region.getNumCols() == -1)
-    {
-        region.setNumCols(numColsTotal);
-    }
+    checkRegion(region, imageNumber);
+    NITFImageInfo* thisImage = mInfos[imageNumber];
 
     size_t numRowsReq = region.getNumRows();
     size_t numColsReq = region.getNumCols();
@@ -612,16 +1211,10 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
     size_t startRow = region.getStartRow();
     size_t startCol = region.getStartCol();
 
-    size_t extentRows = startRow + numRowsReq;
-    size_t extentCols = startCol + numColsReq;
-
-    if (extentRows > numRowsTotal || startRow > numRowsTotal)
-        throw except::Exception(Ctxt(FmtX("Too many rows requested [%d]",
-                                          numRowsReq)));
-
-    if (extentCols > numColsTotal || startCol > numColsTotal)
-        throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
-                                          numColsReq)));
+    if (region.isDecimated())
+    {
+        return readDecimated(region, imageNumber, 0);
+    }
 
     // Allocate one band
     nitf::Uint32 bandList(0);
@@ -636,6 +1229,7 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
         buffer = new nitf::Uint8[subWindowSize];
         region.setBuffer(buffer);
     }
+    SIX_PROFILE_BYTES("NITFReadControl::interleaved", subWindowSize);
 
     // Do segmenting here
     nitf::SubWindow sw;
@@ -678,7 +1272,8 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
 
     size_t nbpp = thisImage->getData()->getNumBytesPerPixel();
     size_t startIndex = thisImage->getStartIndex();
-    createCompressionOptions(mCompressionOptions);
+
+    const size_t numDecodeThreads = getNumDecodeThreads();
     for (; i < numIS && totalRead < subWindowSize; i++)
     {
         size_t numRowsReqSeg =
@@ -686,14 +1281,9 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
                         - sw.getStartRow());
 
         sw.setNumRows(static_cast<nitf::Uint32>(numRowsReqSeg));
-        nitf::ImageReader imageReader = mReader.newImageReader(
-                static_cast<int>(startIndex + i),
-                mCompressionOptions);
-
-        nitf::Uint8* bufferPtr = buffer + totalRead;
 
-        int padded;
-        imageReader.read(sw, &bufferPtr, &padded);
+        readSegment(startIndex + i, sw, nbpp, numDecodeThreads,
+                    buffer + totalRead);
         totalRead += numColsReq * nbpp * numRowsReqSeg;
         sw.setStartRow(0);
         numRowsLeft -= numRowsReqSeg;
@@ -702,6 +1292,773 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
     return buffer;
 }
 
+UByte* NITFReadControl::interleaved(Region& region,
+                                    size_t imageNumber,
+                                    size_t level)
+{
+    if (level == 0)
+    {
+        return interleaved(region, imageNumber);
+    }
+
+    SIX_PROFILE_SCOPE("NITFReadControl::interleaved/pyramid");
+
+    const size_t imageSeg = getPyramidLevelSegment(imageNumber, level);
+    const types::RowCol<size_t> dims =
+            getPyramidLevelDims(imageNumber, level);
+
+    if (region.getNumRows() == -1)
+    {
+        region.setNumRows(dims.row);
+    }
+    if (region.getNumCols() == -1)
+    {
+        region.setNumCols(dims.col);
+    }
+
+    const types::RowCol<size_t> start(region.getStartRow(),
+                                      region.getStartCol());
+    const types::RowCol<size_t> numReq(region.getNumRows(),
+                                       region.getNumCols());
+
+    if (start.row > dims.row || numReq.row > dims.row - start.row)
+    {
+        throw except::Exception(Ctxt(FmtX("Too many rows requested [%d]",
+                                          numReq.row)));
+    }
+
+    if (start.col > dims.col || numReq.col > dims.col - start.col)
+    {
+        throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
+                                          numReq.col)));
+    }
+
+    if (region.isDecimated())
+    {
+        return readDecimated(region, imageNumber, level);
+    }
+
+    const size_t nbpp = mInfos[imageNumber]->getData()->getNumBytesPerPixel();
+    const size_t subWindowSize = numReq.area() * nbpp;
+
+    nitf::Uint8* buffer = region.getBuffer();
+    if (buffer == NULL)
+    {
+        buffer = new nitf::Uint8[subWindowSize];
+        region.setBuffer(buffer);
+    }
+    SIX_PROFILE_BYTES("NITFReadControl::interleaved/pyramid", subWindowSize);
+
+    nitf::Uint32 bandList(0);
+    nitf::SubWindow sw;
+    sw.setStartRow(static_cast<nitf::Uint32>(start.row));
+    sw.setNumRows(static_cast<nitf::Uint32>(numReq.row));
+    sw.setStartCol(static_cast<nitf::Uint32>(start.col));
+    sw.setNumCols(static_cast<nitf::Uint32>(numReq.col));
+    sw.setNumBands(1);
+    sw.setBandList(&bandList);
+
+    readSegment(imageSeg, sw, nbpp, getNumDecodeThreads(), buffer);
+
+    return buffer;
+}
+
+size_t NITFReadControl::getNumPyramidLevels(size_t imageNumber) const
+{
+    if (imageNumber >= mInfos.size())
+    {
+        throw except::Exception(Ctxt(
+                "Image " + str::toString(imageNumber) + " is out of bounds"));
+    }
+
+    return mInfos[imageNumber]->getPyramidLevels().size();
+}
+
+size_t NITFReadControl::getPyramidLevelSegment(size_t imageNumber,
+                                               size_t level) const
+{
+    const size_t numLevels = getNumPyramidLevels(imageNumber);
+    if (level == 0 || level > numLevels)
+    {
+        std::ostringstream ostr;
+        ostr << "Invalid pyramid level " << level << ", image "
+             << imageNumber << " has " << numLevels;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    return mInfos[imageNumber]->getPyramidLevels()[level - 1];
+}
+
+types::RowCol<size_t>
+NITFReadControl::getPyramidLevelDims(size_t imageNumber, size_t level) const
+{
+    if (level == 0)
+    {
+        const Data* const data = mInfos.at(imageNumber)->getData();
+        return types::RowCol<size_t>(data->getNumRows(), data->getNumCols());
+    }
+
+    nitf::ImageSegment segment =
+            mRecord.getImages()[getPyramidLevelSegment(imageNumber, level)];
+    nitf::ImageSubheader subheader = segment.getSubheader();
+    return types::RowCol<size_t>(
+            static_cast<nitf::Uint32>(subheader.getNumRows()),
+            static_cast<nitf::Uint32>(subheader.getNumCols()));
+}
+
+struct NITFReadControl::ConcurrentReader
+{
+    ConcurrentReader(nitf::IOInterface& io, sys::Mutex& mutex) :
+        mIO(new SharedIOView(io, mutex)),
+        mRecord(mReader.readIO(*mIO))
+    {
+    }
+
+    ConcurrentReader(sys::File& file) :
+        mIO(new SharedIOView(file)),
+        mRecord(mReader.readIO(*mIO))
+    {
+    }
+
+    nitf::ImageReader& getImageReader(
+            size_t imageSeg,
+            const std::map<std::string, void*>& compressionOptions)
+    {
+        std::map<size_t, nitf::ImageReader>::iterator iter =
+                mImageReaders.find(imageSeg);
+        if (iter == mImageReaders.end())
+        {
+            iter = mImageReaders.insert(std::make_pair(
+                    imageSeg,
+                    mReader.newImageReader(static_cast<int>(imageSeg),
+                                           compressionOptions))).first;
+        }
+        return iter->second;
+    }
+
+private:
+    const std::auto_ptr<SharedIOView> mIO;
+    nitf::Reader mReader;
+    nitf::Record mRecord;
+    std::map<size_t, nitf::ImageReader> mImageReaders;
+};
+
+UByte* NITFReadControl::readDecimated(Region& region,
+                                      size_t imageNumber,
+                                      size_t level)
+{
+    SIX_PROFILE_SCOPE("NITFReadControl::interleaved/decimated");
+
+    if (region.getRowDecimation() == 0 || region.getColDecimation() == 0)
+    {
+        throw except::Exception(Ctxt("Decimation factors must be positive"));
+    }
+
+    const Data* const data = mInfos[imageNumber]->getData();
+    const DecimationLayout layout =
+            getDecimationLayout(data->getPixelType(),
+                                region.getDecimationType());
+
+    std::vector<SegmentRows> segments;
+    if (level == 0)
+    {
+        const std::vector<NITFSegmentInfo> imageSegments =
+                mInfos[imageNumber]->getImageSegments();
+        const size_t startIndex = mInfos[imageNumber]->getStartIndex();
+        for (size_t ii = 0; ii < imageSegments.size(); ++ii)
+        {
+            const SegmentRows segment = { startIndex + ii,
+                                          imageSegments[ii].firstRow,
+                                          imageSegments[ii].numRows };
+            segments.push_back(segment);
+        }
+    }
+    else
+    {
+        const SegmentRows segment =
+                { getPyramidLevelSegment(imageNumber, level),
+                  0,
+                  getPyramidLevelDims(imageNumber, level).row };
+        segments.push_back(segment);
+    }
+
+    const size_t numOutputRows =
+            (static_cast<size_t>(region.getNumRows()) +
+             region.getRowDecimation() - 1) / region.getRowDecimation();
+    const size_t numOutputCols =
+            (static_cast<size_t>(region.getNumCols()) +
+             region.getColDecimation() - 1) / region.getColDecimation();
+    const size_t outputSize =
+            numOutputRows * numOutputCols * data->getNumBytesPerPixel();
+
+    nitf::Uint8* buffer = region.getBuffer();
+    if (buffer == NULL)
+    {
+        buffer = new nitf::Uint8[outputSize];
+        region.setBuffer(buffer);
+    }
+    SIX_PROFILE_BYTES("NITFReadControl::interleaved/decimated", outputSize);
+
+    if (numOutputRows == 0 || numOutputCols == 0)
+    {
+        return buffer;
+    }
+
+    // Output rows are independent, so split them up between threads
+    const size_t numThreads =
+            std::min(getNumDecodeThreads(), numOutputRows);
+    if (numThreads <= 1)
+    {
+        std::map<size_t, nitf::ImageReader> imageReaders;
+        for (size_t ii = 0; ii < segments.size(); ++ii)
+        {
+            imageReaders.insert(std::make_pair(
+                    segments[ii].imageSeg,
+                    getImageReader(segments[ii].imageSeg)));
+        }
+
+        ReadDecimatedRunnable(imageReaders, segments, region, layout,
+                              0, numOutputRows, buffer).run();
+        return buffer;
+    }
+
+    // Each thread needs a reader of its own, so borrow them from the pool
+    std::vector<ConcurrentReader*> readers;
+    try
+    {
+        std::vector<sys::Runnable*> runnables;
+        try
+        {
+            const mt::ThreadPlanner planner(numOutputRows, numThreads);
+
+            size_t threadNum(0);
+            size_t startRow(0);
+            size_t numRowsThisThread(0);
+            while (planner.getThreadInfo(threadNum++,
+                                         startRow,
+                                         numRowsThisThread))
+            {
+                readers.push_back(acquireConcurrentReader());
+
+                std::map<size_t, nitf::ImageReader> imageReaders;
+                for (size_t ii = 0; ii < segments.size(); ++ii)
+                {
+                    imageReaders.insert(std::make_pair(
+                            segments[ii].imageSeg,
+                            readers.back()->getImageReader(
+                                    segments[ii].imageSeg,
+                                    mCompressionOptions)));
+                }
+
+                runnables.push_back(new ReadDecimatedRunnable(
+                        imageReaders,
+                        segments,
+                        region,
+                        layout,
+                        startRow,
+                        numRowsThisThread,
+                        buffer));
+            }
+        }
+        catch (...)
+        {
+            for (size_t ii = 0; ii < runnables.size(); ++ii)
+            {
+                delete runnables[ii];
+            }
+            throw;
+        }
+
+        mt::ThreadGroup threads;
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            threads.createThread(runnables[ii]);
+        }
+        threads.joinAll();
+    }
+    catch (...)
+    {
+        // They may be part way through a read, so don't reuse them
+        for (size_t ii = 0; ii < readers.size(); ++ii)
+        {
+            delete readers[ii];
+        }
+        throw;
+    }
+
+    for (size_t ii = 0; ii < readers.size(); ++ii)
+    {
+        releaseConcurrentReader(readers[ii]);
+    }
+    return buffer;
+}
+
+size_t NITFReadControl::getNumDecodeThreads() const
+{
+    size_t numDecodeThreads = static_cast<sys::Uint32_T>(
+            mOptions.getParameter(OPT_NUM_DECODE_THREADS, Parameter(1)));
+    if (numDecodeThreads == 0)
+    {
+        numDecodeThreads = sys::OS().getNumCPUs();
+    }
+    return numDecodeThreads;
+}
+
+void NITFReadControl::readSegment(size_t imageSeg,
+                                  nitf::SubWindow& subWindow,
+                                  size_t numBytesPerPixel,
+                                  size_t numThreads,
+                                  nitf::Uint8* buffer)
+{
+    if (readMapped(imageSeg, subWindow, numBytesPerPixel, buffer))
+    {
+        return;
+    }
+
+    if (numThreads > 1)
+    {
+        readBlocks(imageSeg, subWindow, numBytesPerPixel, numThreads, buffer);
+    }
+    else
+    {
+        nitf::ImageReader imageReader = getImageReader(imageSeg);
+
+        int padded;
+        SIX_PROFILE_SCOPE("NITFReadControl::interleaved/readSegment");
+        imageReader.read(subWindow, &buffer, &padded);
+    }
+}
+
+nitf::ImageReader NITFReadControl::getImageReader(size_t imageSeg)
+{
+    std::map<size_t, nitf::ImageReader>::iterator iter =
+            mImageReaders.find(imageSeg);
+    if (iter != mImageReaders.end())
+    {
+        return iter->second;
+    }
+
+    nitf::ImageReader imageReader = mReader.newImageReader(
+            static_cast<int>(imageSeg), mCompressionOptions);
+    if (mOptions.hasParameter(OPT_BLOCK_CACHE_BLOCKS))
+    {
+        const sys::Uint32_T maxBlocks =
+                mOptions.getParameter(OPT_BLOCK_CACHE_BLOCKS);
+        const sys::Uint64_T maxBytes =
+                mOptions.getParameter(OPT_BLOCK_CACHE_BYTES, Parameter(0));
+        imageReader.setBlockCacheSize(maxBlocks, maxBytes);
+
+        // Uncompressed images are normally read straight into the caller's
+        // buffer.  Only go through the cache when it's blocked, otherwise
+        // the block is the whole segment.
+        nitf::ImageSegment segment = mRecord.getImages()[imageSeg];
+        nitf::ImageSubheader subheader = segment.getSubheader();
+        const nitf::Uint32 numBlocks =
+                static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow()) *
+                static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol());
+        if (numBlocks > 1)
+        {
+            imageReader.setReadCaching();
+        }
+    }
+
+    mImageReaders.insert(std::make_pair(imageSeg, imageReader));
+    return imageReader;
+}
+
+void NITFReadControl::checkRegion(Region& region, size_t imageNumber) const
+{
+    if (imageNumber >= mInfos.size())
+    {
+        throw except::Exception(Ctxt(FmtX("Invalid image number [%d]",
+                                          imageNumber)));
+    }
+
+    const Data* const data = mInfos[imageNumber]->getData();
+    const size_t numRowsTotal = data->getNumRows();
+    const size_t numColsTotal = data->getNumCols();
+
+    if (region.getNumRows() == -1)
+    {
+        region.setNumRows(numRowsTotal);
+    }
+    if (region.getNumCols() == -1)
+    {
+        region.setNumCols(numColsTotal);
+    }
+
+    const size_t startRow = region.getStartRow();
+    const size_t startCol = region.getStartCol();
+    const size_t numRowsReq = region.getNumRows();
+    const size_t numColsReq = region.getNumCols();
+
+    if (startRow > numRowsTotal || numRowsReq > numRowsTotal - startRow)
+        throw except::Exception(Ctxt(FmtX("Too many rows requested [%d]",
+                                          numRowsReq)));
+
+    if (startCol > numColsTotal || numColsReq > numColsTotal - startCol)
+        throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
+                                          numColsReq)));
+}
+
+NITFReadControl::ConcurrentReader* NITFReadControl::acquireConcurrentReader()
+{
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mConcurrentReadersMutex);
+        if (!mConcurrentReaders.empty())
+        {
+            ConcurrentReader* const reader = mConcurrentReaders.back();
+            mConcurrentReaders.pop_back();
+            return reader;
+        }
+
+        if (!mFile.get() && !mFilePathname.empty())
+        {
+            mFile.reset(new sys::File(mFilePathname));
+        }
+    }
+
+    // Reading the record happens outside the lock so other calls can get
+    // on with their reads
+    SIX_PROFILE_SCOPE("NITFReadControl::interleavedConcurrent/newReader");
+    if (mFile.get())
+    {
+        return new ConcurrentReader(*mFile);
+    }
+    if (!mInterface.get())
+    {
+        throw except::Exception(Ctxt("Nothing has been loaded"));
+    }
+    return new ConcurrentReader(*mInterface, mInterfaceMutex);
+}
+
+void NITFReadControl::releaseConcurrentReader(ConcurrentReader* reader)
+{
+    mt::CriticalSection<sys::Mutex> lock(&mConcurrentReadersMutex);
+    mConcurrentReaders.push_back(reader);
+}
+
+UByte* NITFReadControl::interleavedConcurrent(Region& region,
+                                              size_t imageNumber)
+{
+    SIX_PROFILE_SCOPE("NITFReadControl::interleavedConcurrent");
+
+    checkRegion(region, imageNumber);
+    if (region.isDecimated())
+    {
+        throw except::Exception(Ctxt(
+                "Concurrent reads of decimated regions aren't supported"));
+    }
+
+    const NITFImageInfo& info = *mInfos[imageNumber];
+    const size_t startRow = region.getStartRow();
+    const size_t endRow = startRow + region.getNumRows();
+    const size_t numCols = region.getNumCols();
+    const size_t rowSize = numCols * info.getData()->getNumBytesPerPixel();
+
+    nitf::Uint8* buffer = region.getBuffer();
+    if (buffer == NULL)
+    {
+        buffer = new nitf::Uint8[region.getNumRows() * rowSize];
+        region.setBuffer(buffer);
+    }
+    SIX_PROFILE_BYTES("NITFReadControl::interleavedConcurrent",
+                      region.getNumRows() * rowSize);
+
+    nitf::Uint32 bandList(0);
+    nitf::SubWindow sw;
+    sw.setStartCol(static_cast<nitf::Uint32>(region.getStartCol()));
+    sw.setNumCols(static_cast<nitf::Uint32>(numCols));
+    sw.setNumBands(1);
+    sw.setBandList(&bandList);
+
+    // Only made if there's a segment that can't be read from the mapping
+    ConcurrentReader* reader = NULL;
+    try
+    {
+        const std::vector<NITFSegmentInfo> imageSegments =
+                info.getImageSegments();
+        nitf::Uint8* bufferPtr = buffer;
+        size_t row = startRow;
+        for (size_t ii = 0; ii < imageSegments.size() && row < endRow; ++ii)
+        {
+            const size_t segEndRow =
+                    imageSegments[ii].firstRow + imageSegments[ii].numRows;
+            if (row >= segEndRow)
+            {
+                continue;
+            }
+
+            const size_t numRowsSeg = std::min(endRow, segEndRow) - row;
+            sw.setStartRow(static_cast<nitf::Uint32>(
+                    row - imageSegments[ii].firstRow));
+            sw.setNumRows(static_cast<nitf::Uint32>(numRowsSeg));
+
+            const size_t imageSeg = info.getStartIndex() + ii;
+            if (!readMapped(imageSeg, sw,
+                            info.getData()->getNumBytesPerPixel(),
+                            bufferPtr))
+            {
+                if (reader == NULL)
+                {
+                    reader = acquireConcurrentReader();
+                }
+
+                int padded;
+                reader->getImageReader(imageSeg, mCompressionOptions).read(
+                        sw, &bufferPtr, &padded);
+            }
+            bufferPtr += numRowsSeg * rowSize;
+            row += numRowsSeg;
+        }
+    }
+    catch (...)
+    {
+        // It may be part way through a read, so don't reuse it
+        delete reader;
+        throw;
+    }
+
+    if (reader != NULL)
+    {
+        releaseConcurrentReader(reader);
+    }
+    return buffer;
+}
+
+void NITFReadControl::interleavedComplex(Region& region,
+                                         size_t imageNumber,
+                                         std::complex<float>* buffer)
+{
+    SIX_PROFILE_SCOPE("NITFReadControl::interleavedComplex");
+
+    checkRegion(region, imageNumber);
+    if (region.isDecimated())
+    {
+        throw except::Exception(Ctxt(
+                "Complex reads of decimated regions aren't supported"));
+    }
+
+    const NITFImageInfo& info = *mInfos[imageNumber];
+    const PixelType pixelType = info.getData()->getPixelType();
+    if (pixelType == PixelType::RE32F_IM32F)
+    {
+        // Already complex<float>s, so there's only swapping to do
+        Region floatRegion(region);
+        floatRegion.setBuffer(reinterpret_cast<UByte*>(buffer));
+        interleaved(floatRegion, imageNumber);
+        return;
+    }
+    if (pixelType != PixelType::RE16I_IM16I)
+    {
+        throw except::Exception(Ctxt(
+                "Can't read " + pixelType.toString() +
+                " pixels as complex<float>"));
+    }
+
+    const size_t startRow = region.getStartRow();
+    const size_t endRow = startRow + region.getNumRows();
+    const size_t startCol = region.getStartCol();
+    const size_t numCols = region.getNumCols();
+    const size_t numBytesPerPixel = 2 * sizeof(sys::Int16_T);
+
+    // One for the real component, one for imaginary of each pixel
+    const size_t elementsPerRow = numCols * 2;
+    SIX_PROFILE_BYTES("NITFReadControl::interleavedComplex",
+                      region.getNumRows() * elementsPerRow * sizeof(float));
+
+    nitf::Uint32 bandList(0);
+    nitf::SubWindow sw;
+    sw.setStartCol(static_cast<nitf::Uint32>(startCol));
+    sw.setNumCols(static_cast<nitf::Uint32>(numCols));
+    sw.setNumBands(1);
+    sw.setBandList(&bandList);
+
+    const bool swap = !sys::isBigEndianSystem();
+    const size_t numDecodeThreads = getNumDecodeThreads();
+    std::vector<sys::Int16_T> swath;
+    float* output = reinterpret_cast<float*>(buffer);
+
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    size_t row = startRow;
+    for (size_t ii = 0; ii < imageSegments.size() && row < endRow; ++ii)
+    {
+        const size_t segEndRow =
+                imageSegments[ii].firstRow + imageSegments[ii].numRows;
+        if (row >= segEndRow)
+        {
+            continue;
+        }
+
+        const size_t imageSeg = info.getStartIndex() + ii;
+        const size_t segStartRow = row - imageSegments[ii].firstRow;
+        const size_t numRowsSeg = std::min(endRow, segEndRow) - row;
+
+        if (imageSeg < mMappedSegments.size() &&
+            mMappedSegments[imageSeg].pixels != NULL &&
+            mMappedSegments[imageSeg].numBytesPerPixel == numBytesPerPixel)
+        {
+            // Swap and promote straight out of the mapping
+            const MappedSegment& segment(mMappedSegments[imageSeg]);
+            const size_t inputRowSize = segment.numCols * numBytesPerPixel;
+            const sys::ubyte* input = segment.pixels +
+                    segStartRow * inputRowSize + startCol * numBytesPerPixel;
+            for (size_t jj = 0; jj < numRowsSeg; ++jj)
+            {
+                promoteInt16(input, elementsPerRow, swap, output);
+                input += inputRowSize;
+                output += elementsPerRow;
+            }
+        }
+        else
+        {
+            // Read in ~32 MB of rows at a time and promote them
+            const size_t rowsAtATime = std::min(
+                    numRowsSeg,
+                    32000000 / (elementsPerRow * sizeof(sys::Int16_T)) + 1);
+            swath.resize(rowsAtATime * elementsPerRow);
+
+            for (size_t jj = 0; jj < numRowsSeg; jj += rowsAtATime)
+            {
+                const size_t rowsToRead =
+                        std::min(rowsAtATime, numRowsSeg - jj);
+                sw.setStartRow(static_cast<nitf::Uint32>(segStartRow + jj));
+                sw.setNumRows(static_cast<nitf::Uint32>(rowsToRead));
+                readSegment(imageSeg, sw, numBytesPerPixel, numDecodeThreads,
+                            reinterpret_cast<nitf::Uint8*>(&swath[0]));
+
+                const size_t numElements = rowsToRead * elementsPerRow;
+                for (size_t kk = 0; kk < numElements; ++kk)
+                {
+                    output[kk] = swath[kk];
+                }
+                output += numElements;
+            }
+        }
+        row += numRowsSeg;
+    }
+}
+
+void NITFReadControl::readBlocks(size_t imageSeg,
+                                 nitf::SubWindow& subWindow,
+                                 size_t numBytesPerPixel,
+                                 size_t numThreads,
+                                 nitf::Uint8* buffer)
+{
+    nitf::ImageSegment segment = mRecord.getImages()[imageSeg];
+    nitf::ImageSubheader subheader = segment.getSubheader();
+
+    // A block size of 0 means the image isn't blocked in that direction
+    size_t numRowsPerBlock = static_cast<nitf::Uint32>(
+            subheader.getNumPixelsPerVertBlock());
+    if (numRowsPerBlock == 0)
+    {
+        numRowsPerBlock = static_cast<nitf::Uint32>(subheader.getNumRows());
+    }
+    size_t numColsPerBlock = static_cast<nitf::Uint32>(
+            subheader.getNumPixelsPerHorizBlock());
+    if (numColsPerBlock == 0)
+    {
+        numColsPerBlock = static_cast<nitf::Uint32>(subheader.getNumCols());
+    }
+
+    const types::RowCol<size_t> start(subWindow.getStartRow(),
+                                      subWindow.getStartCol());
+    const types::RowCol<size_t> end(start.row + subWindow.getNumRows(),
+                                    start.col + subWindow.getNumCols());
+
+    std::vector<BlockWindow> blocks;
+    for (size_t row = start.row; row < end.row; )
+    {
+        const size_t blockEndRow = std::min(
+                (row / numRowsPerBlock + 1) * numRowsPerBlock, end.row);
+        for (size_t col = start.col; col < end.col; )
+        {
+            const size_t blockEndCol = std::min(
+                    (col / numColsPerBlock + 1) * numColsPerBlock, end.col);
+
+            const BlockWindow block =
+                    { row, blockEndRow - row, col, blockEndCol - col };
+            blocks.push_back(block);
+            col = blockEndCol;
+        }
+        row = blockEndRow;
+    }
+
+    numThreads = std::min(numThreads, blocks.size());
+    if (numThreads <= 1)
+    {
+        nitf::ImageReader imageReader = getImageReader(imageSeg);
+
+        int padded;
+        SIX_PROFILE_SCOPE("NITFReadControl::interleaved/readSegment");
+        imageReader.read(subWindow, &buffer, &padded);
+        return;
+    }
+
+    // Each thread needs a reader of its own, so borrow them from the pool.
+    // Get them all before starting any threads so a failure doesn't leave
+    // threads running.
+    std::vector<ConcurrentReader*> readers;
+    try
+    {
+        std::vector<sys::Runnable*> runnables;
+        try
+        {
+            const mt::ThreadPlanner planner(blocks.size(), numThreads);
+
+            size_t threadNum(0);
+            size_t startBlock(0);
+            size_t numBlocksThisThread(0);
+            while (planner.getThreadInfo(threadNum++,
+                                         startBlock,
+                                         numBlocksThisThread))
+            {
+                readers.push_back(acquireConcurrentReader());
+                runnables.push_back(new ReadBlocksRunnable(
+                        readers.back()->getImageReader(imageSeg,
+                                                       mCompressionOptions),
+                        &blocks[startBlock],
+                        numBlocksThisThread,
+                        start,
+                        subWindow.getNumCols(),
+                        numBytesPerPixel,
+                        buffer));
+            }
+        }
+        catch (...)
+        {
+            for (size_t ii = 0; ii < runnables.size(); ++ii)
+            {
+                delete runnables[ii];
+            }
+            throw;
+        }
+
+        mt::ThreadGroup threads;
+        for (size_t ii = 0; ii < runnables.size(); ++ii)
+        {
+            threads.createThread(runnables[ii]);
+        }
+        threads.joinAll();
+    }
+    catch (...)
+    {
+        // They may be part way through a read, so don't reuse them
+        for (size_t ii = 0; ii < readers.size(); ++ii)
+        {
+            delete readers[ii];
+        }
+        throw;
+    }
+
+    for (size_t ii = 0; ii < readers.size(); ++ii)
+    {
+        releaseConcurrentReader(readers[ii]);
+    }
+}
+
 std::auto_ptr<Legend> NITFReadControl::findLegend(size_t productNum)
 {
     std::auto_ptr<Legend> legend;
@@ -779,7 +2136,17 @@ void NITFReadControl::reset()
         delete mInfos[ii];
     }
     mInfos.clear();
+    mImageReaders.clear();
+    for (size_t ii = 0; ii < mConcurrentReaders.size(); ++ii)
+    {
+        delete mConcurrentReaders[ii];
+    }
+    mConcurrentReaders.clear();
+    mMappedSegments.clear();
+    mMappedIO = NULL;
     mInterface.reset();
+    mFile.reset();
+    mFilePathname.clear();
 }
 
 
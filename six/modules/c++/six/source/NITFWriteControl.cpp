@@ -23,7 +23,11 @@
 #include <sstream>
 
 #include <mem/ScopedArray.h>
+#include <sys/OS.h>
+#include <six/DirectIO.h>
+#include <six/J2KWriteHandler.h>
 #include <six/NITFWriteControl.h>
+#include <six/Profiler.h>
 #include <six/XMLControlFactory.h>
 
 namespace
@@ -90,6 +94,17 @@ const char NITFWriteControl::OPT_MAX_ILOC_ROWS[] = "MaxILOCRows";
 const char NITFWriteControl::OPT_J2K_COMPRESSION[] = "J2KCompression";
 const char NITFWriteControl::OPT_NUM_ROWS_PER_BLOCK[] = "NumRowsPerBlock";
 const char NITFWriteControl::OPT_NUM_COLS_PER_BLOCK[] = "NumColsPerBlock";
+const char NITFWriteControl::OPT_NUM_J2K_THREADS[] = "NumJ2KThreads";
+const char NITFWriteControl::OPT_NUM_BYTE_SWAP_THREADS[] =
+        "NumByteSwapThreads";
+const char NITFWriteControl::OPT_NUM_PYRAMID_LEVELS[] = "NumPyramidLevels";
+const char NITFWriteControl::OPT_PYRAMID_METHOD[] = "PyramidMethod";
+const char NITFWriteControl::OPT_PYRAMID_MAX_MEMORY[] = "PyramidMaxMemory";
+const char NITFWriteControl::OPT_PYRAMID_SCRATCH_DIRECTORY[] =
+        "PyramidScratchDirectory";
+const char NITFWriteControl::OPT_DIRECT_IO[] = "DirectIO";
+const char NITFWriteControl::OPT_DIRECT_IO_QUEUE_DEPTH[] =
+        "DirectIOQueueDepth";
 const size_t NITFWriteControl::DEFAULT_BUFFER_SIZE = 8 * 1024 * 1024;
 
 NITFWriteControl::NITFWriteControl()
@@ -352,6 +367,85 @@ void NITFWriteControl::initialize(mem::SharedPtr<Container> container)
 
             ++startIndex;
         }
+
+        // Optional reduced resolution levels
+        const types::RowCol<size_t> fullDims(info.getData()->getNumRows(),
+                                             numCols);
+        const size_t numPyramidLevels = std::min<size_t>(
+                static_cast<sys::Uint32_T>(mOptions.getParameter(
+                        OPT_NUM_PYRAMID_LEVELS, Parameter(0))),
+                PyramidBuilder::getMaxNumLevels(fullDims));
+        if (numPyramidLevels > 0 &&
+            (dataType == DataType::COMPLEX ||
+             info.getData()->getNumChannels() > 1))
+        {
+            throw except::Exception(Ctxt(
+                    "Pyramid levels are only supported for single band SIDDs"));
+        }
+
+        for (size_t level = 1; level <= numPyramidLevels; ++level)
+        {
+            const types::RowCol<size_t> levelDims =
+                    PyramidBuilder::getLevelDims(fullDims, level);
+            if (static_cast<sys::Uint64_T>(levelDims.area()) *
+                    info.getData()->getNumBytesPerPixel() > maxSize)
+            {
+                throw except::Exception(Ctxt(
+                        "Pyramid level " + str::toString(level) +
+                        " doesn't fit in a single image segment"));
+            }
+
+            nitf::ImageSegment imageSegment = mRecord.newImageSegment();
+            nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+            subheader.getImageTitle().set(fileTitle);
+            const DateTime collectionDT =
+                    info.getData()->getCollectionStartDateTime();
+            subheader.getImageDateAndTime().set(collectionDT);
+
+            // Levels are numbered after the image's segments and legend.
+            // IMAG and IALVL are what tie them to the image.
+            subheader.getImageId().set(getDerivedIID(
+                    numIS + (legend ? 1 : 0) + level - 1, ii));
+            subheader.getImageSource().set(imageSource);
+            subheader.getImageLocation().set(generateILOC(0, 0));
+            subheader.getTargetId().set(targetId);
+
+            std::vector<nitf::BandInfo> bandInfo = info.getBandInfo();
+            subheader.setPixelInformation(pvtype, nbpp, nbpp, "R", irep, "SAR",
+                                          bandInfo);
+
+            // Always a single block, since these are written a row at a
+            // time out of the builder
+            subheader.setBlocking(
+                    static_cast<nitf::Uint32>(levelDims.row),
+                    static_cast<nitf::Uint32>(levelDims.col),
+                    (levelDims.row > 8192) ?
+                            0 : static_cast<nitf::Uint32>(levelDims.row),
+                    (levelDims.col > 8192) ?
+                            0 : static_cast<nitf::Uint32>(levelDims.col),
+                    imode);
+
+            subheader.getImageSyncCode().set(0);
+            subheader.getImageAttachmentLevel().set(static_cast<nitf::Uint16>(
+                       info.getStartIndex() + 1));
+            subheader.getImageMagnification().set(
+                    "/" + str::toString(static_cast<size_t>(1) << level));
+
+            const LatLonCorners imageCorners =
+                    info.getData()->getImageCorners();
+            for (size_t kk = 0; kk < LatLonCorners::NUM_CORNERS; ++kk)
+            {
+                corners[kk][0] = imageCorners.getCorner(kk).getLat();
+                corners[kk][1] = imageCorners.getCorner(kk).getLon();
+            }
+            subheader.setCornersFromLatLons(NITF_CORNERS_GEO, corners);
+
+            setImageSecurity(info.getData()->getClassification(), subheader);
+
+            info.addPyramidLevel(startIndex);
+            ++startIndex;
+        }
     }
 
     for (size_t ii = 0; ii < mContainer->getNumData(); ++ii)
@@ -705,15 +799,35 @@ void NITFWriteControl::updateFileHeaderSecurity()
 void NITFWriteControl::save(const SourceList& imageData,
                             const std::string& outputFile,
                             const std::vector<std::string>& schemaPaths)
+{
+    const std::auto_ptr<nitf::IOInterface> io(openOutputFile(outputFile));
+    save(imageData, *io, schemaPaths);
+    io->close();
+}
+
+std::auto_ptr<nitf::IOInterface>
+NITFWriteControl::openOutputFile(const std::string& pathname) const
 {
     const size_t bufferSize =
             mOptions.getParameter(OPT_BUFFER_SIZE,
                                   Parameter(DEFAULT_BUFFER_SIZE));
 
-    nitf::BufferedWriter bufferedIO(outputFile, bufferSize);
-
-    save(imageData, bufferedIO, schemaPaths);
-    bufferedIO.close();
+    std::auto_ptr<nitf::IOInterface> io;
+    if (static_cast<sys::Uint32_T>(
+            mOptions.getParameter(OPT_DIRECT_IO, Parameter(0))) != 0)
+    {
+        const size_t queueDepth = static_cast<sys::Uint32_T>(
+                mOptions.getParameter(
+                        OPT_DIRECT_IO_QUEUE_DEPTH,
+                        Parameter(DirectIO::DEFAULT_QUEUE_DEPTH)));
+        io.reset(new DirectIO(pathname, NITF_ACCESS_WRITEONLY, bufferSize,
+                              queueDepth));
+    }
+    else
+    {
+        io.reset(new nitf::BufferedWriter(pathname, bufferSize));
+    }
+    return io;
 }
 
 bool NITFWriteControl::shouldByteSwap() const
@@ -739,11 +853,98 @@ bool NITFWriteControl::shouldByteSwap() const
     return doByteSwap;
 }
 
+size_t NITFWriteControl::getNumJ2KThreads(
+        nitf::ImageSubheader subheader) const
+{
+    size_t numThreads = static_cast<sys::Uint32_T>(
+            mOptions.getParameter(OPT_NUM_J2K_THREADS, Parameter(1)));
+    if (numThreads == 0)
+    {
+        numThreads = sys::OS().getNumCPUs();
+    }
+
+    if (numThreads <= 1 ||
+        !J2KWriteHandler::canWrite(subheader, mCompressionOptions))
+    {
+        return 0;
+    }
+    return numThreads;
+}
+
+size_t NITFWriteControl::getNumByteSwapThreads() const
+{
+    const size_t numThreads = static_cast<sys::Uint32_T>(
+            mOptions.getParameter(OPT_NUM_BYTE_SWAP_THREADS, Parameter(1)));
+    return (numThreads == 0) ? sys::OS().getNumCPUs() : numThreads;
+}
+
+std::auto_ptr<PyramidBuilder>
+NITFWriteControl::createPyramidBuilder(const NITFImageInfo& info) const
+{
+    const Data& data(*info.getData());
+
+    // Decimating LUT indices only makes sense by picking one of them
+    DecimationMethod method(DecimationMethod::NEAREST_NEIGHBOR);
+    if (mOptions.hasParameter(OPT_PYRAMID_METHOD) &&
+        data.getPixelType() != PixelType::MONO8LU &&
+        data.getPixelType() != PixelType::RGB8LU)
+    {
+        method = DecimationMethod(
+                mOptions.getParameter(OPT_PYRAMID_METHOD).str());
+    }
+
+    const size_t maxMemory = mOptions.getParameter(
+            OPT_PYRAMID_MAX_MEMORY,
+            Parameter(PyramidBuilder::DEFAULT_MAX_MEMORY));
+    const std::string scratchDirectory =
+            mOptions.hasParameter(OPT_PYRAMID_SCRATCH_DIRECTORY) ?
+                    mOptions.getParameter(OPT_PYRAMID_SCRATCH_DIRECTORY).str() :
+                    std::string(".");
+
+    return std::auto_ptr<PyramidBuilder>(new PyramidBuilder(
+            types::RowCol<size_t>(data.getNumRows(), data.getNumCols()),
+            data.getNumBytesPerPixel(),
+            info.getPyramidLevels().size(),
+            method,
+            maxMemory,
+            scratchDirectory));
+}
+
+void NITFWriteControl::setPyramidWriteHandlers(
+        const NITFImageInfo& info,
+        PyramidBuilder& builder,
+        bool doByteSwap,
+        std::vector<mem::SharedPtr<io::InputStream> >& levelStreams)
+{
+    const std::vector<size_t> pyramidLevels = info.getPyramidLevels();
+    for (size_t level = 1; level <= pyramidLevels.size(); ++level)
+    {
+        const types::RowCol<size_t> levelDims(builder.getLevelDims(level));
+
+        NITFSegmentInfo segmentInfo;
+        segmentInfo.firstRow = 0;
+        segmentInfo.rowOffset = 0;
+        segmentInfo.numRows = levelDims.row;
+
+        levelStreams.push_back(mem::SharedPtr<io::InputStream>(
+                new PyramidLevelInputStream(builder, level)));
+
+        mem::SharedPtr< ::nitf::WriteHandler> writeHandler(
+            new StreamWriteHandler(segmentInfo, levelStreams.back().get(),
+                                   levelDims.col, 1,
+                                   info.getData()->getNumBytesPerPixel(),
+                                   doByteSwap, getNumByteSwapThreads()));
+        mWriter.setImageWriteHandler(static_cast<int>(pyramidLevels[level - 1]),
+                                     writeHandler);
+    }
+}
+
 void NITFWriteControl::save(
         const SourceList& imageData,
         nitf::IOInterface& outputFile,
         const std::vector<std::string>& schemaPaths)
 {
+    SIX_PROFILE_SCOPE("NITFWriteControl::save");
 
     mWriter.prepareIO(outputFile, mRecord);
     const bool doByteSwap = shouldByteSwap();
@@ -758,12 +959,28 @@ void NITFWriteControl::save(
 
     size_t numImages = mInfos.size();
 
+    const double j2kCompression = (double)mOptions.getParameter(
+            OPT_J2K_COMPRESSION, Parameter(0));
+    const bool enableJ2K = (mContainer->getDataType() != DataType::COMPLEX) &&
+            (j2kCompression <= 1.0) && j2kCompression > 0.0001;
+    createCompressionOptions(mCompressionOptions);
+
+    // Images with pyramid levels are decimated as they're read.  These have
+    // to stick around until the write is done.
+    std::vector<mem::SharedPtr<PyramidBuilder> > pyramids;
+    std::vector<mem::SharedPtr<io::InputStream> > pyramidStreams;
+
     //! TODO: This section of code (unlike the memory section below)
-    //        does not account for blocked writing or J2K compression.
+    //        does not account for blocked writing or J2K compression,
+    //        other than what J2KWriteHandler can encode a band at a time.
     //        CODA ticket #443 will update support for this.
     for (size_t i = 0; i < numImages; ++i)
     {
         const NITFImageInfo& info = *mInfos[i];
+        SIX_PROFILE_BYTES("NITFWriteControl::save",
+                          info.getData()->getNumRows() *
+                          info.getData()->getNumCols() *
+                          info.getData()->getNumBytesPerPixel());
         std::vector < NITFSegmentInfo > imageSegments
                 = info.getImageSegments();
         size_t numIS = imageSegments.size();
@@ -771,13 +988,44 @@ void NITFWriteControl::save(
         size_t numCols = info.getData()->getNumCols();
         size_t numChannels = info.getData()->getNumChannels();
 
+        io::InputStream* source = imageData[i];
+        if (!info.getPyramidLevels().empty())
+        {
+            pyramids.push_back(mem::SharedPtr<PyramidBuilder>(
+                    createPyramidBuilder(info)));
+            pyramidStreams.push_back(mem::SharedPtr<io::InputStream>(
+                    new PyramidInputStream(*source, *pyramids.back())));
+            source = pyramidStreams.back().get();
+
+            setPyramidWriteHandlers(info, *pyramids.back(), doByteSwap,
+                                    pyramidStreams);
+        }
+
+        if (enableJ2K && numIS == 1)
+        {
+            const int index = static_cast<int>(info.getStartIndex());
+            nitf::ImageSegment imageSegment = mRecord.getImages()[index];
+            nitf::ImageSubheader subheader = imageSegment.getSubheader();
+
+            const size_t numJ2KThreads = getNumJ2KThreads(subheader);
+            if (numJ2KThreads > 0)
+            {
+                mem::SharedPtr< ::nitf::WriteHandler> writeHandler(
+                    new J2KWriteHandler(subheader, source,
+                                        numJ2KThreads, mCompressionOptions));
+                mWriter.setImageWriteHandler(index, writeHandler);
+                continue;
+            }
+        }
+
         for (size_t j = 0; j < numIS; ++j)
         {
             NITFSegmentInfo segmentInfo = imageSegments[j];
 
             mem::SharedPtr< ::nitf::WriteHandler> writeHandler(
-                new StreamWriteHandler (segmentInfo, imageData[i], numCols,
-                                        numChannels, pixelSize, doByteSwap));
+                new StreamWriteHandler (segmentInfo, source, numCols,
+                                        numChannels, pixelSize, doByteSwap,
+                                        getNumByteSwapThreads()));
 
             mWriter.setImageWriteHandler(
                     static_cast<int>(info.getStartIndex() + j),
@@ -793,13 +1041,9 @@ void NITFWriteControl::save(const BufferList& imageData,
                             const std::string& outputFile,
                             const std::vector<std::string>& schemaPaths)
 {
-    const size_t bufferSize =
-            mOptions.getParameter(OPT_BUFFER_SIZE,
-                                  Parameter(DEFAULT_BUFFER_SIZE));
-    nitf::BufferedWriter bufferedIO(outputFile, bufferSize);
-
-    save(imageData, bufferedIO, schemaPaths);
-    bufferedIO.close();
+    const std::auto_ptr<nitf::IOInterface> io(openOutputFile(outputFile));
+    save(imageData, *io, schemaPaths);
+    io->close();
 }
 
 void NITFWriteControl::save(
@@ -807,6 +1051,8 @@ void NITFWriteControl::save(
         nitf::IOInterface& outputFile,
         const std::vector<std::string>& schemaPaths)
 {
+    SIX_PROFILE_SCOPE("NITFWriteControl::save");
+
     mWriter.prepareIO(outputFile, mRecord);
     const bool doByteSwap = shouldByteSwap();
 
@@ -825,9 +1071,18 @@ void NITFWriteControl::save(
 
     size_t numImages = mInfos.size();
     createCompressionOptions(mCompressionOptions);
+
+    // These have to stick around until the write is done
+    std::vector<mem::SharedPtr<PyramidBuilder> > pyramids;
+    std::vector<mem::SharedPtr<io::InputStream> > pyramidStreams;
+
     for (size_t i = 0; i < numImages; ++i)
     {
         const NITFImageInfo& info = *mInfos[i];
+        SIX_PROFILE_BYTES("NITFWriteControl::save",
+                          info.getData()->getNumRows() *
+                          info.getData()->getNumCols() *
+                          info.getData()->getNumBytesPerPixel());
         std::vector < NITFSegmentInfo > imageSegments
                 = info.getImageSegments();
         const size_t numIS = imageSegments.size();
@@ -836,13 +1091,21 @@ void NITFWriteControl::save(
         const size_t numCols = info.getData()->getNumCols();
         const size_t numChannels = info.getData()->getNumChannels();
 
-        nitf::ImageSegment imageSegment = mRecord.getImages()[i];
-        nitf::ImageSubheader subheader = imageSegment.getSubheader();
+        // Other images, legends and pyramid levels may come before this
+        // image's segments
+        const int startIndex = static_cast<int>(info.getStartIndex());
+        nitf::ImageSegment startSegment = mRecord.getImages()[startIndex];
+        nitf::ImageSubheader subheader = startSegment.getSubheader();
 
         const bool isBlocking =
             static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow()) > 1 ||
             static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol()) > 1;
 
+        // Large J2K segments can be split into tiles that are encoded in
+        // parallel
+        const size_t numJ2KThreads = (enableJ2K && numIS == 1) ?
+                getNumJ2KThreads(subheader) : 0;
+
         // The SIDD spec requires that a J2K compressed SIDDs be only a
         // single image segment. However this functionality remains untested.
         if (isBlocking || (enableJ2K && numIS == 1) ||
@@ -855,26 +1118,39 @@ void NITFWriteControl::save(
                     "SICD does not support blocked or J2K compressed output"));
             }
 
-            for (size_t jj = 0; jj < numIS; ++jj)
+            if (numJ2KThreads > 0)
             {
-                // We will use the ImageWriter provided by NITRO so that we can
-                // take advantage of the built-in compression capabilities
-                nitf::ImageWriter iWriter =
-                    mWriter.newImageWriter(
-                            static_cast<int>(info.getStartIndex() + jj),
-                            mCompressionOptions);
-                iWriter.setWriteCaching(1);
-
-                nitf::ImageSource iSource;
-                const size_t bandSize = numCols * info.getData()->getNumRows();
-
-                for (size_t chan = 0; chan < numChannels; ++chan)
+                mem::SharedPtr< ::nitf::WriteHandler> writeHandler(
+                    new J2KWriteHandler(subheader,
+                                        imageData[i], numJ2KThreads,
+                                        mCompressionOptions));
+                mWriter.setImageWriteHandler(startIndex, writeHandler);
+            }
+            else
+            {
+                for (size_t jj = 0; jj < numIS; ++jj)
                 {
-                    nitf::MemorySource ms(imageData[i], bandSize,
-                                          bandSize * chan, pixelSize, 0);
-                    iSource.addBand(ms);
+                    // We will use the ImageWriter provided by NITRO so that
+                    // we can take advantage of the built-in compression
+                    // capabilities
+                    nitf::ImageWriter iWriter =
+                        mWriter.newImageWriter(
+                                static_cast<int>(info.getStartIndex() + jj),
+                                mCompressionOptions);
+                    iWriter.setWriteCaching(1);
+
+                    nitf::ImageSource iSource;
+                    const size_t bandSize =
+                            numCols * info.getData()->getNumRows();
+
+                    for (size_t chan = 0; chan < numChannels; ++chan)
+                    {
+                        nitf::MemorySource ms(imageData[i], bandSize,
+                                              bandSize * chan, pixelSize, 0);
+                        iSource.addBand(ms);
+                    }
+                    iWriter.attachSource(iSource);
                 }
-                iWriter.attachSource(iSource);
             }
         }
         else
@@ -888,7 +1164,8 @@ void NITFWriteControl::save(
                 mem::SharedPtr< ::nitf::WriteHandler> writeHandler(
                     new MemoryWriteHandler(segmentInfo, imageData[i],
                                            segmentInfo.firstRow, numCols,
-                                           numChannels, pixelSize, doByteSwap));
+                                           numChannels, pixelSize, doByteSwap,
+                                           getNumByteSwapThreads()));
                 // Could set start index here
                 mWriter.setImageWriteHandler(
                         static_cast<int>(info.getStartIndex() + jj),
@@ -925,6 +1202,17 @@ void NITFWriteControl::save(
             iWriter.setWriteCaching(1);
             iWriter.attachSource(iSource);
         }
+
+        if (!info.getPyramidLevels().empty())
+        {
+            pyramids.push_back(mem::SharedPtr<PyramidBuilder>(
+                    createPyramidBuilder(info)));
+            pyramids.back()->addRows(imageData[i],
+                                     info.getData()->getNumRows());
+
+            setPyramidWriteHandlers(info, *pyramids.back(), doByteSwap,
+                                    pyramidStreams);
+        }
     }
     addDataAndWrite(schemaPaths);
 }
@@ -943,7 +1231,11 @@ void NITFWriteControl::addDataAndWrite(
         const Data* data = mContainer->getData(ii);
         std::string& desStr(desStrs[ii]);
 
-        desStr = six::toValidXMLString(data, schemaPaths, mLog, mXMLRegistry);
+        {
+            SIX_PROFILE_SCOPE("NITFWriteControl::save/toXML");
+            desStr = six::toValidXMLString(data, schemaPaths, mLog,
+                                           mXMLRegistry);
+        }
         nitf::SegmentWriter deWriter = mWriter.newDEWriter(static_cast<int>(ii));
         nitf::SegmentMemorySource segSource(desStr.c_str(),
                                             desStr.length(),
@@ -958,6 +1250,8 @@ void NITFWriteControl::addDataAndWrite(
     {
         mWriter.setDEWriteHandler(deWriterIndex++, mSegmentWriters[ii]);
     }
+
+    SIX_PROFILE_SCOPE("NITFWriteControl::save/write");
     mWriter.write();
 }
 
@@ -0,0 +1,350 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <sys/Thread.h>
+#include <mt/CriticalSection.h>
+#include <six/Profiler.h>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace six
+{
+ProfileStats::ProfileStats() :
+    numCalls(0),
+    totalSeconds(0.0),
+    minSeconds(std::numeric_limits<double>::max()),
+    maxSeconds(0.0),
+    numBytes(0)
+{
+}
+
+void ProfileStats::merge(const ProfileStats& other)
+{
+    numCalls += other.numCalls;
+    totalSeconds += other.totalSeconds;
+    minSeconds = std::min(minSeconds, other.minSeconds);
+    maxSeconds = std::max(maxSeconds, other.maxSeconds);
+    numBytes += other.numBytes;
+}
+
+bool Profiler::NameLess::operator()(const char* lhs, const char* rhs) const
+{
+    return ::strcmp(lhs, rhs) < 0;
+}
+
+struct Profiler::ThreadKey
+{
+#if defined(WIN32) || defined(_WIN32)
+    // Fiber local storage is the only kind with a callback on thread exit
+    ThreadKey() :
+        key(::FlsAlloc(&ThreadKey::onThreadExit))
+    {
+        if (key == FLS_OUT_OF_INDEXES)
+        {
+            throw except::Exception(Ctxt(
+                    "Unable to allocate thread-local storage"));
+        }
+    }
+
+    ~ThreadKey()
+    {
+        ::FlsFree(key);
+    }
+
+    ThreadStats* get() const
+    {
+        return static_cast<ThreadStats*>(::FlsGetValue(key));
+    }
+
+    void set(ThreadStats* threadStats)
+    {
+        ::FlsSetValue(key, threadStats);
+    }
+
+    static VOID WINAPI onThreadExit(PVOID threadStats)
+    {
+        if (threadStats)
+        {
+            Profiler::releaseThreadStats(threadStats);
+        }
+    }
+
+    DWORD key;
+#else
+    ThreadKey()
+    {
+        if (::pthread_key_create(&key, &ThreadKey::onThreadExit) != 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Unable to allocate thread-local storage"));
+        }
+    }
+
+    ~ThreadKey()
+    {
+        ::pthread_key_delete(key);
+    }
+
+    ThreadStats* get() const
+    {
+        return static_cast<ThreadStats*>(::pthread_getspecific(key));
+    }
+
+    void set(ThreadStats* threadStats)
+    {
+        ::pthread_setspecific(key, threadStats);
+    }
+
+    static void onThreadExit(void* threadStats)
+    {
+        Profiler::releaseThreadStats(threadStats);
+    }
+
+    pthread_key_t key;
+#endif
+};
+
+Profiler::Profiler() :
+    mEnabled(0),
+    mThreadKey(new ThreadKey())
+{
+}
+
+Profiler::~Profiler()
+{
+    // Freeing the key first means no thread exit callback can run while
+    // we're tearing down the rest
+    delete mThreadKey;
+
+    for (size_t ii = 0; ii < mThreads.size(); ++ii)
+    {
+        delete mThreads[ii];
+    }
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    // The counter can only be stepped, so keep two callers from both
+    // stepping it the same way
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    if (enabled != isEnabled())
+    {
+        if (enabled)
+        {
+            mEnabled.increment();
+        }
+        else
+        {
+            mEnabled.decrement();
+        }
+    }
+}
+
+Profiler::ThreadStats& Profiler::getThreadStats()
+{
+    ThreadStats* threadStats = mThreadKey->get();
+    if (threadStats == NULL)
+    {
+        std::auto_ptr<ThreadStats> newStats(new ThreadStats());
+        newStats->profiler = this;
+        newStats->threadID = sys::getThreadID();
+
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            mThreads.push_back(newStats.get());
+        }
+
+        threadStats = newStats.release();
+        mThreadKey->set(threadStats);
+    }
+    return *threadStats;
+}
+
+void Profiler::releaseThreadStats(void* threadStatsPtr)
+{
+    ThreadStats* const threadStats =
+            static_cast<ThreadStats*>(threadStatsPtr);
+    Profiler& profiler(*threadStats->profiler);
+
+    {
+        mt::CriticalSection<sys::Mutex> lock(&profiler.mMutex);
+        addStats(threadStats->stats, profiler.mExitedStats);
+
+        const ThreadList::iterator iter = std::find(profiler.mThreads.begin(),
+                                                    profiler.mThreads.end(),
+                                                    threadStats);
+        if (iter != profiler.mThreads.end())
+        {
+            profiler.mThreads.erase(iter);
+        }
+    }
+
+    delete threadStats;
+}
+
+void Profiler::addTime(const char* name, double seconds)
+{
+    ThreadStats& threadStats(getThreadStats());
+
+    mt::CriticalSection<sys::Mutex> lock(&threadStats.mutex);
+    ProfileStats& stats(threadStats.stats[name]);
+    ++stats.numCalls;
+    stats.totalSeconds += seconds;
+    stats.minSeconds = std::min(stats.minSeconds, seconds);
+    stats.maxSeconds = std::max(stats.maxSeconds, seconds);
+}
+
+void Profiler::addBytes(const char* name, sys::Uint64_T numBytes)
+{
+    ThreadStats& threadStats(getThreadStats());
+
+    mt::CriticalSection<sys::Mutex> lock(&threadStats.mutex);
+    threadStats.stats[name].numBytes += numBytes;
+}
+
+void Profiler::addStats(const StatsMap& stats, MergedStatsMap& all)
+{
+    // The same literal can live at different addresses in different
+    // translation units, so this is where we merge by value
+    for (StatsMap::const_iterator iter = stats.begin();
+         iter != stats.end();
+         ++iter)
+    {
+        ProfileStats& merged(all[iter->first]);
+        merged.name = iter->first;
+        merged.merge(iter->second);
+    }
+}
+
+std::vector<ProfileStats> Profiler::getStats() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    MergedStatsMap all(mExitedStats);
+    for (size_t ii = 0; ii < mThreads.size(); ++ii)
+    {
+        mt::CriticalSection<sys::Mutex> threadLock(&mThreads[ii]->mutex);
+        addStats(mThreads[ii]->stats, all);
+    }
+
+    std::vector<ProfileStats> stats;
+    stats.reserve(all.size());
+    for (MergedStatsMap::const_iterator iter = all.begin();
+         iter != all.end();
+         ++iter)
+    {
+        stats.push_back(iter->second);
+    }
+    return stats;
+}
+
+std::map<long, std::vector<ProfileStats> > Profiler::getStatsByThread() const
+{
+    std::map<long, MergedStatsMap> allByThread;
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        for (size_t ii = 0; ii < mThreads.size(); ++ii)
+        {
+            mt::CriticalSection<sys::Mutex> threadLock(&mThreads[ii]->mutex);
+            addStats(mThreads[ii]->stats,
+                     allByThread[mThreads[ii]->threadID]);
+        }
+    }
+
+    std::map<long, std::vector<ProfileStats> > statsByThread;
+    for (std::map<long, MergedStatsMap>::const_iterator iter =
+                 allByThread.begin();
+         iter != allByThread.end();
+         ++iter)
+    {
+        std::vector<ProfileStats>& stats(statsByThread[iter->first]);
+        for (MergedStatsMap::const_iterator statsIter = iter->second.begin();
+             statsIter != iter->second.end();
+             ++statsIter)
+        {
+            stats.push_back(statsIter->second);
+        }
+    }
+    return statsByThread;
+}
+
+void Profiler::reset()
+{
+    // Keep the ThreadStats around since their threads may be about to use
+    // them
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    for (size_t ii = 0; ii < mThreads.size(); ++ii)
+    {
+        mt::CriticalSection<sys::Mutex> threadLock(&mThreads[ii]->mutex);
+        mThreads[ii]->stats.clear();
+    }
+    mExitedStats.clear();
+}
+
+std::string Profiler::toString() const
+{
+    const std::vector<ProfileStats> stats = getStats();
+
+    std::ostringstream ostr;
+    ostr << std::left << std::setw(40) << "Stage"
+         << std::right << std::setw(10) << "Calls"
+         << std::setw(14) << "Total (s)"
+         << std::setw(14) << "Mean (s)"
+         << std::setw(14) << "Min (s)"
+         << std::setw(14) << "Max (s)"
+         << std::setw(16) << "Bytes" << "\n";
+
+    ostr << std::fixed << std::setprecision(6);
+    for (size_t ii = 0; ii < stats.size(); ++ii)
+    {
+        const ProfileStats& stage(stats[ii]);
+        const bool haveTimes(stage.numCalls > 0);
+
+        ostr << std::left << std::setw(40) << stage.name
+             << std::right << std::setw(10) << stage.numCalls
+             << std::setw(14) << stage.totalSeconds
+             << std::setw(14)
+             << (haveTimes ? stage.totalSeconds / stage.numCalls : 0.0)
+             << std::setw(14) << (haveTimes ? stage.minSeconds : 0.0)
+             << std::setw(14) << stage.maxSeconds
+             << std::setw(16) << stage.numBytes << "\n";
+    }
+
+    return ostr.str();
+}
+
+void Profiler::dump(logging::Logger& log) const
+{
+    log.info("SIX profile:\n" + toString());
+}
+}
@@ -0,0 +1,319 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <six/Profiler.h>
+#include <six/PyramidBuilder.h>
+
+namespace six
+{
+const size_t PyramidBuilder::DEFAULT_MAX_MEMORY = 256 * 1024 * 1024;
+
+PyramidBuilder::PyramidBuilder(const types::RowCol<size_t>& dims,
+                               size_t numBytesPerPixel,
+                               size_t numLevels,
+                               DecimationMethod method,
+                               size_t maxMemory,
+                               const std::string& scratchDirectory) :
+    mDims(dims),
+    mNumBytesPerPixel(numBytesPerPixel),
+    mRowSize(dims.col * numBytesPerPixel),
+    mNumRowsAdded(0)
+{
+    if (mNumBytesPerPixel != 1 && mNumBytesPerPixel != 2)
+    {
+        throw except::Exception(Ctxt(
+                "Pyramids can only be built for 1 or 2 byte pixels, not " +
+                str::toString(mNumBytesPerPixel)));
+    }
+
+    switch (method)
+    {
+    case DecimationMethod::NEAREST_NEIGHBOR:
+        mDownSampler.reset(new nitf::PixelSkip(2, 2));
+        break;
+    case DecimationMethod::BRIGHTEST_PIXEL:
+        mDownSampler.reset(new nitf::MaxDownSample(2, 2));
+        break;
+    default:
+        throw except::Exception(Ctxt(
+                "Unsupported pyramid decimation method " + method.toString()));
+    }
+
+    numLevels = std::min(numLevels, getMaxNumLevels(mDims));
+    mLevels.resize(numLevels);
+    sys::Uint64_T numBytes(0);
+    for (size_t ii = 0; ii < numLevels; ++ii)
+    {
+        Level& level(mLevels[ii]);
+        level.dims = getLevelDims(ii + 1);
+        level.rowSize = level.dims.col * mNumBytesPerPixel;
+        level.offset = numBytes;
+        level.window.resize(2 * level.rowSize);
+        level.numRowsDone = 0;
+        numBytes += static_cast<sys::Uint64_T>(level.dims.row) *
+                level.rowSize;
+    }
+
+    if (numBytes <= maxMemory)
+    {
+        mMemory.resize(static_cast<size_t>(numBytes));
+    }
+    else
+    {
+        mTempFile.reset(new io::TempFile(scratchDirectory));
+        mFile.reset(new sys::File(
+                mTempFile->pathname(), sys::File::READ_AND_WRITE,
+                sys::File::CREATE | sys::File::TRUNCATE));
+    }
+
+    mPending.reserve(2 * mRowSize);
+}
+
+types::RowCol<size_t>
+PyramidBuilder::getLevelDims(const types::RowCol<size_t>& dims, size_t level)
+{
+    types::RowCol<size_t> levelDims(dims);
+    for (size_t ii = 0; ii < level; ++ii)
+    {
+        levelDims.row = (levelDims.row + 1) / 2;
+        levelDims.col = (levelDims.col + 1) / 2;
+    }
+    return levelDims;
+}
+
+size_t PyramidBuilder::getMaxNumLevels(const types::RowCol<size_t>& dims)
+{
+    types::RowCol<size_t> levelDims(dims);
+    size_t numLevels(0);
+    while (levelDims.row > 1 || levelDims.col > 1)
+    {
+        levelDims.row = (levelDims.row + 1) / 2;
+        levelDims.col = (levelDims.col + 1) / 2;
+        ++numLevels;
+    }
+    return numLevels;
+}
+
+void PyramidBuilder::checkLevel(size_t level) const
+{
+    if (level == 0 || level > mLevels.size())
+    {
+        std::ostringstream ostr;
+        ostr << "Invalid pyramid level " << level << ", only have "
+             << mLevels.size();
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+
+size_t PyramidBuilder::getLevelSize(size_t level) const
+{
+    checkLevel(level);
+    const Level& info(mLevels[level - 1]);
+    return info.dims.row * info.rowSize;
+}
+
+void PyramidBuilder::readLevel(size_t level,
+                               size_t offset,
+                               size_t numBytes,
+                               UByte* buffer)
+{
+    checkLevel(level);
+    const Level& info(mLevels[level - 1]);
+    if (offset + numBytes > info.numRowsDone * info.rowSize)
+    {
+        throw except::Exception(Ctxt(
+                "Pyramid level " + str::toString(level) +
+                " hasn't been built that far yet"));
+    }
+    if (numBytes == 0)
+    {
+        return;
+    }
+
+    if (mFile.get())
+    {
+        SIX_PROFILE_BYTES("PyramidBuilder::readLevel", numBytes);
+        mFile->seekTo(static_cast<sys::Off_T>(info.offset + offset),
+                      sys::File::FROM_START);
+        mFile->readInto(reinterpret_cast<char*>(buffer), numBytes);
+    }
+    else
+    {
+        memcpy(buffer, &mMemory[static_cast<size_t>(info.offset) + offset],
+               numBytes);
+    }
+}
+
+void PyramidBuilder::decimateRow(const UByte* input,
+                                 size_t numInputRows,
+                                 size_t numCols,
+                                 UByte* output)
+{
+    // NITRO always hands its down samplers a single row of windows, with
+    // the input rows 'numInputCols' apart, so we do the same
+    const nitf::Uint32 numOutputCols =
+            static_cast<nitf::Uint32>((numCols + 1) / 2);
+    NITF_DATA* inputWindow =
+            reinterpret_cast<NITF_DATA*>(const_cast<UByte*>(input));
+    NITF_DATA* outputWindow = reinterpret_cast<NITF_DATA*>(output);
+
+    mDownSampler->apply(&inputWindow,
+                        &outputWindow,
+                        1,
+                        1,
+                        numOutputCols,
+                        static_cast<nitf::Uint32>(numCols),
+                        numOutputCols,
+                        NITF_PIXEL_TYPE_INT,
+                        static_cast<nitf::Uint32>(mNumBytesPerPixel),
+                        static_cast<nitf::Uint32>(numInputRows),
+                        (numCols % 2) ? 1 : 2);
+}
+
+void PyramidBuilder::addLevelRow(size_t level,
+                                 const UByte* input,
+                                 size_t numInputRows,
+                                 size_t numInputCols)
+{
+    Level& output(mLevels[level - 1]);
+    UByte* const row =
+            &output.window[(output.numRowsDone % 2) * output.rowSize];
+    decimateRow(input, numInputRows, numInputCols, row);
+
+    const sys::Uint64_T rowOffset = output.offset +
+            static_cast<sys::Uint64_T>(output.numRowsDone) * output.rowSize;
+    if (mFile.get())
+    {
+        SIX_PROFILE_BYTES("PyramidBuilder::addBytes/write", output.rowSize);
+        mFile->seekTo(static_cast<sys::Off_T>(rowOffset),
+                      sys::File::FROM_START);
+        mFile->writeFrom(reinterpret_cast<const char*>(row), output.rowSize);
+    }
+    else
+    {
+        memcpy(&mMemory[static_cast<size_t>(rowOffset)], row,
+               output.rowSize);
+    }
+    ++output.numRowsDone;
+
+    // Each pair of rows makes a row of the next level, as does the last
+    // row of an odd sized level on its own (which is first in the window)
+    if (level < mLevels.size() &&
+        (output.numRowsDone % 2 == 0 ||
+         output.numRowsDone == output.dims.row))
+    {
+        addLevelRow(level + 1,
+                    &output.window[0],
+                    (output.numRowsDone % 2) ? 1 : 2,
+                    output.dims.col);
+    }
+}
+
+void PyramidBuilder::addRows(const UByte* rows, size_t numRows)
+{
+    addBytes(rows, numRows * mRowSize);
+}
+
+void PyramidBuilder::addBytes(const UByte* data, size_t numBytes)
+{
+    SIX_PROFILE_SCOPE("PyramidBuilder::addBytes");
+    SIX_PROFILE_BYTES("PyramidBuilder::addBytes", numBytes);
+
+    const sys::Uint64_T numBytesAdded =
+            static_cast<sys::Uint64_T>(mNumRowsAdded) * mRowSize +
+            mPending.size();
+    if (numBytesAdded + numBytes >
+            static_cast<sys::Uint64_T>(mDims.row) * mRowSize)
+    {
+        throw except::Exception(Ctxt(
+                "Added more pixels than there are in the image"));
+    }
+
+    while (numBytes > 0)
+    {
+        // Rows are consumed in pairs, other than the last row of an image
+        // with an odd number of rows
+        const size_t numWindowRows =
+                std::min<size_t>(2, mDims.row - mNumRowsAdded);
+        const size_t windowSize = numWindowRows * mRowSize;
+
+        if (mPending.empty() && numBytes >= windowSize)
+        {
+            if (!mLevels.empty())
+            {
+                addLevelRow(1, data, numWindowRows, mDims.col);
+            }
+            data += windowSize;
+            numBytes -= windowSize;
+        }
+        else
+        {
+            const size_t numToCopy =
+                    std::min(numBytes, windowSize - mPending.size());
+            mPending.insert(mPending.end(), data, data + numToCopy);
+            data += numToCopy;
+            numBytes -= numToCopy;
+
+            if (mPending.size() < windowSize)
+            {
+                break;
+            }
+            if (!mLevels.empty())
+            {
+                addLevelRow(1, &mPending[0], numWindowRows, mDims.col);
+            }
+            mPending.clear();
+        }
+        mNumRowsAdded += numWindowRows;
+    }
+}
+
+sys::SSize_T PyramidInputStream::read(sys::byte* b, sys::Size_T len)
+{
+    const sys::SSize_T numRead = mSource.read(b, len);
+    if (numRead > 0)
+    {
+        mBuilder.addBytes(reinterpret_cast<const UByte*>(b),
+                          static_cast<size_t>(numRead));
+    }
+    return numRead;
+}
+
+sys::SSize_T PyramidLevelInputStream::read(sys::byte* b, sys::Size_T len)
+{
+    if (mOffset == mNumBytes)
+    {
+        return io::InputStream::IS_EOF;
+    }
+
+    const size_t numBytes = std::min<size_t>(len, mNumBytes - mOffset);
+    mBuilder.readLevel(mLevel, mOffset, numBytes,
+                       reinterpret_cast<UByte*>(b));
+    mOffset += numBytes;
+    return static_cast<sys::SSize_T>(numBytes);
+}
+}
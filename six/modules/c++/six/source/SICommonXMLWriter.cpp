@@ -0,0 +1,570 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <six/Utilities.h>
+#include <six/SICommonXMLWriter.h>
+
+namespace
+{
+const std::string NO_PREFIX;
+const std::string CLASS("class");
+const std::string XS_STRING("xs:string");
+const std::string XS_INT("xs:int");
+const std::string XS_DOUBLE("xs:double");
+const std::string XS_BOOLEAN("xs:boolean");
+const std::string XS_DATE_TIME("xs:dateTime");
+}
+
+namespace six
+{
+SICommonXMLWriter::SICommonXMLWriter(XMLStreamWriter& writer,
+                                     bool addClassAttributes,
+                                     const std::string& siCommonPrefix) :
+    mWriter(writer),
+    mAddClassAttributes(addClassAttributes),
+    mSICommonPrefix(siCommonPrefix)
+{
+}
+
+SICommonXMLWriter::~SICommonXMLWriter()
+{
+}
+
+void SICommonXMLWriter::startTypedElement(const std::string& name,
+                                          const std::string& prefix,
+                                          const std::string& type)
+{
+    mWriter.startElement(name, prefix);
+    if (mAddClassAttributes)
+    {
+        mWriter.attribute(CLASS, type);
+    }
+}
+
+void SICommonXMLWriter::writeString(const std::string& name,
+                                    const std::string& value)
+{
+    writeString(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writeString(const std::string& name,
+                                    const std::string& prefix,
+                                    const std::string& value)
+{
+    startTypedElement(name, prefix, XS_STRING);
+    mWriter.characters(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeInt(const std::string& name, int value)
+{
+    writeInt(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writeInt(const std::string& name,
+                                 const std::string& prefix,
+                                 int value)
+{
+    startTypedElement(name, prefix, XS_INT);
+    mWriter.characters(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeDouble(const std::string& name, double value)
+{
+    writeDouble(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writeDouble(const std::string& name,
+                                    const std::string& prefix,
+                                    double value)
+{
+    startTypedElement(name, prefix, XS_DOUBLE);
+    mWriter.characters(value);
+    mWriter.endElement();
+}
+
+bool SICommonXMLWriter::writeBooleanType(const std::string& name,
+                                         BooleanType value)
+{
+    return writeBooleanType(name, NO_PREFIX, value);
+}
+
+bool SICommonXMLWriter::writeBooleanType(const std::string& name,
+                                         const std::string& prefix,
+                                         BooleanType value)
+{
+    if (value == BooleanType::NOT_SET)
+    {
+        return false;
+    }
+
+    startTypedElement(name, prefix, XS_BOOLEAN);
+    mWriter.characters(six::toString<BooleanType>(value));
+    mWriter.endElement();
+    return true;
+}
+
+void SICommonXMLWriter::writeDateTime(const std::string& name,
+                                      const DateTime& value)
+{
+    writeDateTime(name, six::toString<DateTime>(value));
+}
+
+void SICommonXMLWriter::writeDateTime(const std::string& name,
+                                      const std::string& value)
+{
+    startTypedElement(name, NO_PREFIX, XS_DATE_TIME);
+    mWriter.characters(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeComplex(const std::string& name,
+                                     std::complex<double> value)
+{
+    mWriter.startElement(name);
+    writeDouble("Real", mSICommonPrefix, value.real());
+    writeDouble("Imag", mSICommonPrefix, value.imag());
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeVector3D(const std::string& name,
+                                      const Vector3& value)
+{
+    writeVector3D(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writeVector3D(const std::string& name,
+                                      const std::string& prefix,
+                                      const Vector3& value)
+{
+    mWriter.startElement(name, prefix);
+    writeDouble("X", mSICommonPrefix, value[0]);
+    writeDouble("Y", mSICommonPrefix, value[1]);
+    writeDouble("Z", mSICommonPrefix, value[2]);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const std::string& prefix,
+                                    const std::string& rowName,
+                                    const std::string& colName,
+                                    const RowColInt& value)
+{
+    mWriter.startElement(name, prefix);
+    writeInt(rowName, mSICommonPrefix, static_cast<int>(value.row));
+    writeInt(colName, mSICommonPrefix, static_cast<int>(value.col));
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const std::string& rowName,
+                                    const std::string& colName,
+                                    const RowColInt& value)
+{
+    writeRowCol(name, NO_PREFIX, rowName, colName, value);
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const std::string& prefix,
+                                    const RowColInt& value)
+{
+    writeRowCol(name, prefix, "Row", "Col", value);
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const RowColInt& value)
+{
+    writeRowCol(name, NO_PREFIX, "Row", "Col", value);
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const std::string& prefix,
+                                    const std::string& rowName,
+                                    const std::string& colName,
+                                    const RowColDouble& value)
+{
+    mWriter.startElement(name, prefix);
+    writeDouble(rowName, mSICommonPrefix, value.row);
+    writeDouble(colName, mSICommonPrefix, value.col);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const std::string& rowName,
+                                    const std::string& colName,
+                                    const RowColDouble& value)
+{
+    writeRowCol(name, NO_PREFIX, rowName, colName, value);
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const std::string& prefix,
+                                    const RowColDouble& value)
+{
+    writeRowCol(name, prefix, "Row", "Col", value);
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const RowColDouble& value)
+{
+    writeRowCol(name, NO_PREFIX, "Row", "Col", value);
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const RowColLatLon& value)
+{
+    mWriter.startElement(name);
+    writeLatLon("Row", value.row);
+    writeLatLon("Col", value.col);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeRowCol(const std::string& name,
+                                    const RowColInt& value,
+                                    const std::string& index)
+{
+    mWriter.startElement(name);
+    mWriter.attribute("index", index);
+    writeInt("Row", mSICommonPrefix, static_cast<int>(value.row));
+    writeInt("Col", mSICommonPrefix, static_cast<int>(value.col));
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeRangeAzimuth(const std::string& name,
+                                          const types::RgAz<double>& value)
+{
+    mWriter.startElement(name);
+    writeDouble("Range", mSICommonPrefix, value.rg);
+    writeDouble("Azimuth", mSICommonPrefix, value.az);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeLatLonFields(const LatLon& value)
+{
+    writeDouble("Lat", mSICommonPrefix, value.getLat());
+    writeDouble("Lon", mSICommonPrefix, value.getLon());
+}
+
+void SICommonXMLWriter::writeLatLon(const std::string& name,
+                                    const LatLon& value)
+{
+    mWriter.startElement(name);
+    writeLatLonFields(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeLatLon(const std::string& name,
+                                    const LatLon& value,
+                                    const std::string& index)
+{
+    mWriter.startElement(name);
+    mWriter.attribute("index", index);
+    writeLatLonFields(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeLatLonAlt(const std::string& name,
+                                       const LatLonAlt& value)
+{
+    mWriter.startElement(name);
+    writeLatLonFields(value);
+    writeDouble("HAE", mSICommonPrefix, value.getAlt());
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeLatLonAlt(const std::string& name,
+                                       const LatLonAlt& value,
+                                       const std::string& index)
+{
+    mWriter.startElement(name);
+    mWriter.attribute("index", index);
+    writeLatLonFields(value);
+    writeDouble("HAE", mSICommonPrefix, value.getAlt());
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writePoly1D(const std::string& name,
+                                    const Poly1D& value)
+{
+    writePoly1D(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writePoly1D(const std::string& name,
+                                    const std::string& prefix,
+                                    const Poly1D& value)
+{
+    const size_t order = value.order();
+    mWriter.startElement(name, prefix);
+    mWriter.attribute("order1", order);
+
+    for (size_t ii = 0; ii <= order; ++ii)
+    {
+        startTypedElement("Coef", mSICommonPrefix, XS_DOUBLE);
+        mWriter.attribute("exponent1", ii);
+        mWriter.characters(value[ii]);
+        mWriter.endElement();
+    }
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writePoly2D(const std::string& name,
+                                    const Poly2D& value)
+{
+    writePoly2D(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writePoly2D(const std::string& name,
+                                    const std::string& prefix,
+                                    const Poly2D& value)
+{
+    const size_t orderX = value.orderX();
+    const size_t orderY = value.orderY();
+    mWriter.startElement(name, prefix);
+    mWriter.attribute("order1", orderX);
+    mWriter.attribute("order2", orderY);
+
+    for (size_t ii = 0; ii <= orderX; ++ii)
+    {
+        for (size_t jj = 0; jj <= orderY; ++jj)
+        {
+            startTypedElement("Coef", mSICommonPrefix, XS_DOUBLE);
+            mWriter.attribute("exponent1", ii);
+            mWriter.attribute("exponent2", jj);
+            mWriter.characters(value[ii][jj]);
+            mWriter.endElement();
+        }
+    }
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writePolyXYZ(const std::string& name,
+                                     const PolyXYZ& value)
+{
+    mWriter.startElement(name);
+    writePolyXYZFields(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writePolyXYZ(const std::string& name,
+                                     const PolyXYZ& value,
+                                     const std::string& index)
+{
+    mWriter.startElement(name);
+    mWriter.attribute("index", index);
+    writePolyXYZFields(value);
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writePolyXYZFields(const PolyXYZ& value)
+{
+    static const char* const AXES[] = { "X", "Y", "Z" };
+
+    // The DOM fills in X, Y and Z side by side, but each still ends up
+    // holding just its own coefficients
+    const size_t order = value.order();
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        mWriter.startElement(AXES[axis], mSICommonPrefix);
+        mWriter.attribute("order1", order);
+        for (size_t ii = 0; ii <= order; ++ii)
+        {
+            startTypedElement("Coef", mSICommonPrefix, XS_DOUBLE);
+            mWriter.attribute("exponent1", ii);
+            mWriter.characters(value[ii][axis]);
+            mWriter.endElement();
+        }
+        mWriter.endElement();
+    }
+}
+
+void SICommonXMLWriter::writeParameter(const std::string& name,
+                                       const Parameter& value)
+{
+    writeParameter(name, NO_PREFIX, value);
+}
+
+void SICommonXMLWriter::writeParameter(const std::string& name,
+                                       const std::string& prefix,
+                                       const Parameter& value)
+{
+    startTypedElement(name, prefix, XS_STRING);
+    mWriter.attribute("name", value.getName());
+    mWriter.characters(value.str());
+    mWriter.endElement();
+}
+
+void SICommonXMLWriter::writeParameters(const std::string& name,
+                                        const ParameterCollection& values)
+{
+    writeParameters(name, NO_PREFIX, values);
+}
+
+void SICommonXMLWriter::writeParameters(const std::string& name,
+                                        const std::string& prefix,
+                                        const ParameterCollection& values)
+{
+    for (ParameterCollection::ConstParameterCollectionIteratorT it =
+                 values.begin();
+         it != values.end();
+         ++it)
+    {
+        writeParameter(name, prefix, *it);
+    }
+}
+
+void SICommonXMLWriter::writeDecorrType(const std::string& name,
+                                        const std::string& prefix,
+                                        const DecorrType& value)
+{
+    if (!Init::isUndefined<double>(value.corrCoefZero) &&
+        !Init::isUndefined<double>(value.decorrRate))
+    {
+        mWriter.startElement(name, prefix);
+        writeDouble("CorrCoefZero", prefix, value.corrCoefZero);
+        writeDouble("DecorrRate", prefix, value.decorrRate);
+        mWriter.endElement();
+    }
+}
+
+void SICommonXMLWriter::writeErrorStatistics(
+        const ErrorStatistics& errorStatistics)
+{
+    const std::string& si(mSICommonPrefix);
+
+    mWriter.startElement("ErrorStatistics");
+
+    //! version specific implementation
+    writeCompositeSCP(errorStatistics);
+
+    const Components* const components = errorStatistics.components.get();
+    if (components)
+    {
+        mWriter.startElement("Components", si);
+
+        const PosVelError* const posVelError = components->posVelError.get();
+        const RadarSensor* const radarSensor = components->radarSensor.get();
+        const TropoError* const tropoError = components->tropoError.get();
+        const IonoError* const ionoError = components->ionoError.get();
+
+        if (posVelError)
+        {
+            mWriter.startElement("PosVelErr", si);
+            writeString("Frame", si, six::toString(posVelError->frame));
+            writeDouble("P1", si, posVelError->p1);
+            writeDouble("P2", si, posVelError->p2);
+            writeDouble("P3", si, posVelError->p3);
+            writeDouble("V1", si, posVelError->v1);
+            writeDouble("V2", si, posVelError->v2);
+            writeDouble("V3", si, posVelError->v3);
+
+            const CorrCoefs* const coefs = posVelError->corrCoefs.get();
+            if (coefs)
+            {
+                mWriter.startElement("CorrCoefs", si);
+                writeDouble("P1P2", si, coefs->p1p2);
+                writeDouble("P1P3", si, coefs->p1p3);
+                writeDouble("P1V1", si, coefs->p1v1);
+                writeDouble("P1V2", si, coefs->p1v2);
+                writeDouble("P1V3", si, coefs->p1v3);
+                writeDouble("P2P3", si, coefs->p2p3);
+                writeDouble("P2V1", si, coefs->p2v1);
+                writeDouble("P2V2", si, coefs->p2v2);
+                writeDouble("P2V3", si, coefs->p2v3);
+                writeDouble("P3V1", si, coefs->p3v1);
+                writeDouble("P3V2", si, coefs->p3v2);
+                writeDouble("P3V3", si, coefs->p3v3);
+                writeDouble("V1V2", si, coefs->v1v2);
+                writeDouble("V1V3", si, coefs->v1v3);
+                writeDouble("V2V3", si, coefs->v2v3);
+                mWriter.endElement();
+            }
+
+            writeDecorrType("PositionDecorr", si,
+                            posVelError->positionDecorr);
+            mWriter.endElement();
+        }
+        if (radarSensor)
+        {
+            mWriter.startElement("RadarSensor", si);
+            writeDouble("RangeBias", si, radarSensor->rangeBias);
+            if (!Init::isUndefined<double>(radarSensor->clockFreqSF))
+            {
+                writeDouble("ClockFreqSF", si, radarSensor->clockFreqSF);
+            }
+            if (!Init::isUndefined<double>(radarSensor->transmitFreqSF))
+            {
+                writeDouble("TransmitFreqSF", si,
+                            radarSensor->transmitFreqSF);
+            }
+            writeDecorrType("RangeBiasDecorr", si,
+                            radarSensor->rangeBiasDecorr);
+            mWriter.endElement();
+        }
+        if (tropoError)
+        {
+            mWriter.startElement("TropoError", si);
+            if (!Init::isUndefined<double>(tropoError->tropoRangeVertical))
+            {
+                writeDouble("TropoRangeVertical", si,
+                            tropoError->tropoRangeVertical);
+            }
+            if (!Init::isUndefined<double>(tropoError->tropoRangeSlant))
+            {
+                writeDouble("TropoRangeSlant", si,
+                            tropoError->tropoRangeSlant);
+            }
+            writeDecorrType("TropoRangeDecorr", si,
+                            tropoError->tropoRangeDecorr);
+            mWriter.endElement();
+        }
+        if (ionoError)
+        {
+            mWriter.startElement("IonoError", si);
+            if (!Init::isUndefined<double>(ionoError->ionoRangeVertical))
+            {
+                writeDouble("IonoRangeVertical", si,
+                            ionoError->ionoRangeVertical);
+            }
+            if (!Init::isUndefined<double>(ionoError->ionoRangeRateVertical))
+            {
+                writeDouble("IonoRangeRateVertical", si,
+                            ionoError->ionoRangeRateVertical);
+            }
+            writeDouble("IonoRgRgRateCC", si, ionoError->ionoRgRgRateCC);
+            writeDecorrType("IonoRangeVertDecorr", si,
+                            ionoError->ionoRangeVertDecorr);
+            mWriter.endElement();
+        }
+        mWriter.endElement();
+    }
+
+    if (!errorStatistics.additionalParameters.empty())
+    {
+        mWriter.startElement("AdditionalParms", si);
+        writeParameters("Parameter", si,
+                        errorStatistics.additionalParameters);
+        mWriter.endElement();
+    }
+
+    mWriter.endElement();
+}
+}
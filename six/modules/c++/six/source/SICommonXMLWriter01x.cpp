@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <six/Utilities.h>
+#include <six/SICommonXMLWriter01x.h>
+
+namespace six
+{
+SICommonXMLWriter01x::SICommonXMLWriter01x(XMLStreamWriter& writer,
+                                           bool addClassAttributes,
+                                           const std::string& siCommonPrefix) :
+    SICommonXMLWriter(writer, addClassAttributes, siCommonPrefix)
+{
+}
+
+void SICommonXMLWriter01x::writeCompositeSCP(
+        const ErrorStatistics& errorStatistics)
+{
+    const CompositeSCP* const compositeSCP =
+            errorStatistics.compositeSCP.get();
+    if (compositeSCP)
+    {
+        const std::string& si(mSICommonPrefix);
+        mWriter.startElement("CompositeSCP", si);
+        if (compositeSCP->scpType == CompositeSCP::RG_AZ)
+        {
+            mWriter.startElement("RgAzErr", si);
+            writeDouble("Rg", si, compositeSCP->xErr);
+            writeDouble("Az", si, compositeSCP->yErr);
+            writeDouble("RgAz", si, compositeSCP->xyErr);
+        }
+        else
+        {
+            mWriter.startElement("RowColErr", si);
+            writeDouble("Row", si, compositeSCP->xErr);
+            writeDouble("Col", si, compositeSCP->yErr);
+            writeDouble("RowCol", si, compositeSCP->xyErr);
+        }
+        mWriter.endElement();
+        mWriter.endElement();
+    }
+}
+
+void SICommonXMLWriter01x::writeRadiometry(const Radiometric& radiometric)
+{
+    const std::string& si(mSICommonPrefix);
+    mWriter.startElement("Radiometric");
+
+    if (!radiometric.noiseLevel.noisePoly.empty())
+    {
+        writePoly2D("NoisePoly", si, radiometric.noiseLevel.noisePoly);
+    }
+
+    if (!radiometric.rcsSFPoly.empty())
+    {
+        writePoly2D("RCSSFPoly", si, radiometric.rcsSFPoly);
+    }
+
+    if (!radiometric.betaZeroSFPoly.empty())
+    {
+        writePoly2D("BetaZeroSFPoly", si, radiometric.betaZeroSFPoly);
+    }
+
+    if (!radiometric.sigmaZeroSFPoly.empty())
+    {
+        writePoly2D("SigmaZeroSFPoly", si, radiometric.sigmaZeroSFPoly);
+    }
+
+    if (radiometric.sigmaZeroSFIncidenceMap != AppliedType::NOT_SET)
+    {
+        writeString("SigmaZeroSFIncidenceMap", si,
+                    six::toString<AppliedType>(
+                            radiometric.sigmaZeroSFIncidenceMap));
+    }
+
+    if (!radiometric.gammaZeroSFPoly.empty())
+    {
+        writePoly2D("GammaZeroSFPoly", si, radiometric.gammaZeroSFPoly);
+    }
+
+    if (radiometric.gammaZeroSFIncidenceMap != AppliedType::NOT_SET)
+    {
+        writeString("GammaZeroSFIncidenceMap", si,
+                    six::toString<AppliedType>(
+                            radiometric.gammaZeroSFIncidenceMap));
+    }
+
+    mWriter.endElement();
+}
+}
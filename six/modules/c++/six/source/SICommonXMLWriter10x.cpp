@@ -0,0 +1,85 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <six/SICommonXMLWriter10x.h>
+
+namespace six
+{
+SICommonXMLWriter10x::SICommonXMLWriter10x(XMLStreamWriter& writer,
+                                           bool addClassAttributes,
+                                           const std::string& siCommonPrefix) :
+    SICommonXMLWriter(writer, addClassAttributes, siCommonPrefix)
+{
+}
+
+void SICommonXMLWriter10x::writeCompositeSCP(
+        const ErrorStatistics& errorStatistics)
+{
+    const CompositeSCP* const compositeSCP =
+            errorStatistics.compositeSCP.get();
+    if (compositeSCP)
+    {
+        const std::string& si(mSICommonPrefix);
+        mWriter.startElement("CompositeSCP", si);
+        writeDouble("Rg", si, compositeSCP->xErr);
+        writeDouble("Az", si, compositeSCP->yErr);
+        writeDouble("RgAz", si, compositeSCP->xyErr);
+        mWriter.endElement();
+    }
+}
+
+void SICommonXMLWriter10x::writeRadiometry(const Radiometric& radiometric)
+{
+    const std::string& si(mSICommonPrefix);
+    mWriter.startElement("Radiometric");
+
+    if (!radiometric.noiseLevel.noiseType.empty() &&
+        !radiometric.noiseLevel.noisePoly.empty())
+    {
+        mWriter.startElement("NoiseLevel", si);
+        writeString("NoiseLevelType", si, radiometric.noiseLevel.noiseType);
+        writePoly2D("NoisePoly", si, radiometric.noiseLevel.noisePoly);
+        mWriter.endElement();
+    }
+
+    if (!radiometric.rcsSFPoly.empty())
+    {
+        writePoly2D("RCSSFPoly", si, radiometric.rcsSFPoly);
+    }
+
+    if (!radiometric.sigmaZeroSFPoly.empty())
+    {
+        writePoly2D("SigmaZeroSFPoly", si, radiometric.sigmaZeroSFPoly);
+    }
+
+    if (!radiometric.betaZeroSFPoly.empty())
+    {
+        writePoly2D("BetaZeroSFPoly", si, radiometric.betaZeroSFPoly);
+    }
+
+    if (!radiometric.gammaZeroSFPoly.empty())
+    {
+        writePoly2D("GammaZeroSFPoly", si, radiometric.gammaZeroSFPoly);
+    }
+
+    mWriter.endElement();
+}
+}
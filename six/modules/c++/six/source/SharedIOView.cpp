@@ -0,0 +1,164 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <mt/CriticalSection.h>
+#include <six/SharedIOView.h>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace six
+{
+SharedIOView::SharedIOView(nitf::IOInterface& io, sys::Mutex& mutex) :
+    mIO(&io),
+    mMutex(&mutex),
+    mFile(NULL),
+    mOffset(0)
+{
+    // Some IOInterfaces report the bytes left rather than the total size,
+    // so ask from the start of the file
+    mt::CriticalSection<sys::Mutex> lock(mMutex);
+    const nitf::Off origin = mIO->tell();
+    mIO->seek(0, NITF_SEEK_SET);
+    mSize = mIO->getSize();
+    mIO->seek(origin, NITF_SEEK_SET);
+}
+
+SharedIOView::SharedIOView(sys::File& file) :
+    mIO(NULL),
+    mMutex(NULL),
+    mFile(&file),
+    mSize(static_cast<nitf::Off>(file.length())),
+    mOffset(0)
+{
+}
+
+void SharedIOView::readImpl(void* buffer, size_t size)
+{
+    if (mFile)
+    {
+        readAt(buffer, size);
+    }
+    else
+    {
+        mt::CriticalSection<sys::Mutex> lock(mMutex);
+        mIO->seek(mOffset, NITF_SEEK_SET);
+        mIO->read(buffer, size);
+    }
+    mOffset += static_cast<nitf::Off>(size);
+}
+
+void SharedIOView::readAt(void* buffer, size_t size)
+{
+    char* bufferPtr = static_cast<char*>(buffer);
+    nitf::Off offset = mOffset;
+    while (size > 0)
+    {
+#if defined(WIN32) || defined(_WIN32)
+        // Reads with an offset don't move the file pointer other
+        // threads would see
+        OVERLAPPED overlapped;
+        ::memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD bytesRead(0);
+        const DWORD bytesToRead = static_cast<DWORD>(
+                std::min<size_t>(size, 0x40000000));
+        if (!::ReadFile(mFile->getHandle(), bufferPtr, bytesToRead,
+                        &bytesRead, &overlapped) || bytesRead == 0)
+#else
+        const ssize_t bytesRead = ::pread(mFile->getHandle(), bufferPtr,
+                                          size, offset);
+        if (bytesRead <= 0)
+#endif
+        {
+            throw except::Exception(Ctxt(
+                    "Positional read of " + str::toString(size) +
+                    " bytes at offset " + str::toString(offset) + " of " +
+                    mFile->getName() + " failed"));
+        }
+        bufferPtr += bytesRead;
+        offset += bytesRead;
+        size -= bytesRead;
+    }
+}
+
+void SharedIOView::writeImpl(const void* , size_t )
+{
+    throw except::Exception(
+            Ctxt("SharedIOView cannot perform writes. "
+                 "It is a read-only handle."));
+}
+
+bool SharedIOView::canSeekImpl() const
+{
+    return true;
+}
+
+nitf::Off SharedIOView::seekImpl(nitf::Off offset, int whence)
+{
+    switch (whence)
+    {
+    case NITF_SEEK_SET:
+        mOffset = offset;
+        break;
+    case NITF_SEEK_CUR:
+        mOffset += offset;
+        break;
+    case NITF_SEEK_END:
+        mOffset = mSize + offset;
+        break;
+    default:
+        throw except::Exception(
+                Ctxt("Unknown whence value when seeking SharedIOView: " +
+                     str::toString(whence)));
+    }
+
+    return mOffset;
+}
+
+nitf::Off SharedIOView::tellImpl() const
+{
+    return mOffset;
+}
+
+nitf::Off SharedIOView::getSizeImpl() const
+{
+    return mSize;
+}
+
+int SharedIOView::getModeImpl() const
+{
+    return NITF_ACCESS_READONLY;
+}
+
+void SharedIOView::closeImpl()
+{
+}
+}
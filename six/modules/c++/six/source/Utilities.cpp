@@ -28,6 +28,7 @@
 #include <math/Utilities.h>
 #include "six/Utilities.h"
 #include "six/XMLControl.h"
+#include "six/Profiler.h"
 
 namespace
 {
@@ -1044,6 +1045,7 @@ std::auto_ptr<Data> six::parseData(const XMLControlRegistry& xmlReg,
     xmlParser.preserveCharacterData(true);
     try
     {
+        SIX_PROFILE_SCOPE("six::parseData/parseXML");
         xmlParser.parse(xmlStream);
     }
     catch(const except::Throwable& ex)
@@ -0,0 +1,293 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include <except/Exception.h>
+#include "six/ValidDataMask.h"
+
+namespace
+{
+// Tolerance used when converting edge crossings to pixel columns so that
+// vertices lying exactly on a pixel don't get lost to round-off
+const double CROSSING_TOLERANCE = 1e-9;
+
+std::vector<six::RowColDouble>
+toDouble(const std::vector<six::RowColInt>& polygon)
+{
+    std::vector<six::RowColDouble> converted(polygon.size());
+    for (size_t ii = 0; ii < polygon.size(); ++ii)
+    {
+        converted[ii] = six::RowColDouble(
+                static_cast<double>(polygon[ii].row),
+                static_cast<double>(polygon[ii].col));
+    }
+    return converted;
+}
+}
+
+namespace six
+{
+ValidDataMask::ValidDataMask(const std::vector<RowColDouble>& polygon,
+                             const types::RowCol<size_t>& dims) :
+    mDims(dims),
+    mRowOffsets(dims.row + 1, 0),
+    mNumValidPixels(0)
+{
+    rasterize(polygon);
+}
+
+ValidDataMask::ValidDataMask(const std::vector<RowColInt>& polygon,
+                             const types::RowCol<size_t>& dims) :
+    mDims(dims),
+    mRowOffsets(dims.row + 1, 0),
+    mNumValidPixels(0)
+{
+    rasterize(toDouble(polygon));
+}
+
+void ValidDataMask::rasterize(const std::vector<RowColDouble>& polygon)
+{
+    mSpans.clear();
+
+    if (mDims.col == 0)
+    {
+        return;
+    }
+
+    if (polygon.empty())
+    {
+        // Everything is valid
+        mSpans.resize(mDims.row, Span(0, mDims.col));
+        for (size_t row = 0; row <= mDims.row; ++row)
+        {
+            mRowOffsets[row] = row;
+        }
+        mNumValidPixels = mDims.area();
+        return;
+    }
+
+    if (polygon.size() < 3)
+    {
+        throw except::Exception(Ctxt(
+                "Valid data polygon must have at least three vertices"));
+    }
+
+    std::vector<double> crossings;
+    std::vector<std::pair<double, double> > ranges;
+    std::vector<Span> rowSpans;
+    const double lastCol = static_cast<double>(mDims.col - 1);
+
+    for (size_t row = 0; row < mDims.row; ++row)
+    {
+        mRowOffsets[row] = mSpans.size();
+
+        // Find where this row crosses each edge.  Edges are treated as
+        // half-open in the row direction so that a vertex shared by two
+        // edges is only counted once.
+        const double y = static_cast<double>(row);
+        crossings.clear();
+        for (size_t ii = 0; ii < polygon.size(); ++ii)
+        {
+            const RowColDouble& v0(polygon[ii]);
+            const RowColDouble& v1(polygon[(ii + 1) % polygon.size()]);
+
+            if (v0.row == v1.row)
+            {
+                // Horizontal edges are covered by the adjacent edges
+                continue;
+            }
+
+            const double lowRow = std::min(v0.row, v1.row);
+            const double highRow = std::max(v0.row, v1.row);
+            if (y >= lowRow && y < highRow)
+            {
+                crossings.push_back(v0.col + (y - v0.row) *
+                        (v1.col - v0.col) / (v1.row - v0.row));
+            }
+        }
+
+        std::sort(crossings.begin(), crossings.end());
+
+        // Pair up the crossings using the even-odd rule
+        ranges.clear();
+        for (size_t ii = 0; ii + 1 < crossings.size(); ii += 2)
+        {
+            ranges.push_back(std::make_pair(crossings[ii],
+                                            crossings[ii + 1]));
+        }
+
+        // The half-open edges leave out the boundary where an edge ends
+        // on this row, e.g. a horizontal edge with the interior above it.
+        // Add every vertex and horizontal edge on this row back in so
+        // that the boundary is valid whichever side the interior is on.
+        for (size_t ii = 0; ii < polygon.size(); ++ii)
+        {
+            const RowColDouble& v0(polygon[ii]);
+            const RowColDouble& v1(polygon[(ii + 1) % polygon.size()]);
+            if (v0.row == y)
+            {
+                ranges.push_back(v1.row == y ?
+                        std::make_pair(std::min(v0.col, v1.col),
+                                       std::max(v0.col, v1.col)) :
+                        std::make_pair(v0.col, v0.col));
+            }
+        }
+
+        std::sort(ranges.begin(), ranges.end());
+
+        rowSpans.clear();
+        for (size_t ii = 0; ii < ranges.size(); ++ii)
+        {
+            const double first =
+                    std::ceil(ranges[ii].first - CROSSING_TOLERANCE);
+            const double last =
+                    std::floor(ranges[ii].second + CROSSING_TOLERANCE);
+
+            if (last < 0 || first > lastCol || last < first)
+            {
+                continue;
+            }
+
+            const size_t start =
+                    static_cast<size_t>(std::max(first, 0.0));
+            const size_t end =
+                    static_cast<size_t>(std::min(last, lastCol)) + 1;
+
+            // Merge with the previous span if they touch
+            if (!rowSpans.empty() && start <= rowSpans.back().end)
+            {
+                rowSpans.back().end = std::max(rowSpans.back().end, end);
+            }
+            else
+            {
+                rowSpans.push_back(Span(start, end));
+            }
+        }
+
+        for (size_t ii = 0; ii < rowSpans.size(); ++ii)
+        {
+            mNumValidPixels += rowSpans[ii].length();
+            mSpans.push_back(rowSpans[ii]);
+        }
+    }
+
+    mRowOffsets[mDims.row] = mSpans.size();
+}
+
+bool ValidDataMask::isValid(size_t row, size_t col) const
+{
+    if (row >= mDims.row || col >= mDims.col)
+    {
+        return false;
+    }
+
+    const Span* const spans = getSpans(row);
+    for (size_t ii = 0, numSpans = getNumSpans(row); ii < numSpans; ++ii)
+    {
+        if (col < spans[ii].start)
+        {
+            return false;
+        }
+        if (col < spans[ii].end)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ValidDataMask::getBlockExtent(size_t startRow,
+                                   size_t numRows,
+                                   size_t startCol,
+                                   size_t numCols,
+                                   size_t& firstValidRow,
+                                   size_t& lastValidRow,
+                                   Span& colSpan) const
+{
+    const size_t endRow = std::min(startRow + numRows, mDims.row);
+    const size_t endCol = startCol + numCols;
+
+    bool found = false;
+    for (size_t row = startRow; row < endRow; ++row)
+    {
+        const Span* const spans = getSpans(row);
+        for (size_t ii = 0, numSpans = getNumSpans(row); ii < numSpans; ++ii)
+        {
+            const size_t start = std::max(spans[ii].start, startCol);
+            const size_t end = std::min(spans[ii].end, endCol);
+            if (start >= end)
+            {
+                continue;
+            }
+
+            if (!found)
+            {
+                firstValidRow = row;
+                colSpan = Span(start, end);
+                found = true;
+            }
+            else
+            {
+                colSpan.start = std::min(colSpan.start, start);
+                colSpan.end = std::max(colSpan.end, end);
+            }
+            lastValidRow = row;
+        }
+    }
+
+    return found;
+}
+
+void ValidDataMask::getMask(const types::RowCol<size_t>& offset,
+                            const types::RowCol<size_t>& extent,
+                            UByte* mask) const
+{
+    if (offset.row + extent.row > mDims.row ||
+        offset.col + extent.col > mDims.col)
+    {
+        throw except::Exception(Ctxt("Mask window extends past the image"));
+    }
+
+    std::memset(mask, 0, extent.area());
+
+    const size_t endCol = offset.col + extent.col;
+    for (size_t row = 0; row < extent.row; ++row)
+    {
+        UByte* const rowMask = mask + row * extent.col;
+        const Span* const spans = getSpans(offset.row + row);
+        for (size_t ii = 0, numSpans = getNumSpans(offset.row + row);
+             ii < numSpans;
+             ++ii)
+        {
+            const size_t start = std::max(spans[ii].start, offset.col);
+            const size_t end = std::min(spans[ii].end, endCol);
+            if (start < end)
+            {
+                std::memset(rowMask + start - offset.col, 1, end - start);
+            }
+        }
+    }
+}
+}
@@ -0,0 +1,197 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cstring>
+
+#include <except/Exception.h>
+#include "six/ValidDataReader.h"
+
+namespace six
+{
+const size_t ValidDataReader::DEFAULT_BLOCK_ROWS = 64;
+
+ValidDataReader::ValidDataReader(NITFReadControl& reader,
+                                 const ValidDataMask& mask,
+                                 size_t imageNumber,
+                                 size_t blockRows) :
+    mReader(reader),
+    mMask(mask),
+    mImageNumber(imageNumber),
+    mBlockRows(std::max<size_t>(blockRows, 1)),
+    mNumBytesPerPixel(reader.getContainer()->getData(imageNumber)->
+            getNumBytesPerPixel()),
+    mFillValue(mNumBytesPerPixel, 0),
+    mNumPixelsRead(0)
+{
+    const Data* const data = reader.getContainer()->getData(imageNumber);
+    if (mask.getDims().row != data->getNumRows() ||
+        mask.getDims().col != data->getNumCols())
+    {
+        throw except::Exception(Ctxt(
+                "Valid data mask dimensions do not match the image"));
+    }
+}
+
+void ValidDataReader::fill(UByte* output, size_t numPixels) const
+{
+    if (numPixels == 0)
+    {
+        return;
+    }
+
+    // Fill the first pixel, then keep doubling what's been filled
+    std::memcpy(output, &mFillValue[0], mNumBytesPerPixel);
+    const size_t numBytes = numPixels * mNumBytesPerPixel;
+    for (size_t filled = mNumBytesPerPixel; filled < numBytes;)
+    {
+        const size_t toCopy = std::min(filled, numBytes - filled);
+        std::memcpy(output + filled, output, toCopy);
+        filled += toCopy;
+    }
+}
+
+UByte* ValidDataReader::interleaved(Region& region, const UByte* fillValue)
+{
+    const types::RowCol<size_t>& dims(mMask.getDims());
+
+    if (region.isDecimated())
+    {
+        throw except::Exception(Ctxt(
+                "Decimated regions aren't supported with a valid data mask"));
+    }
+
+    if (region.getNumRows() == -1)
+    {
+        region.setNumRows(dims.row);
+    }
+    if (region.getNumCols() == -1)
+    {
+        region.setNumCols(dims.col);
+    }
+
+    const types::RowCol<size_t> offset(region.getStartRow(),
+                                       region.getStartCol());
+    const types::RowCol<size_t> extent(region.getNumRows(),
+                                       region.getNumCols());
+
+    if (offset.row + extent.row > dims.row ||
+        offset.col + extent.col > dims.col)
+    {
+        throw except::Exception(Ctxt("Region extends past the image"));
+    }
+
+    if (fillValue)
+    {
+        std::copy(fillValue, fillValue + mNumBytesPerPixel,
+                  mFillValue.begin());
+    }
+    else
+    {
+        std::fill(mFillValue.begin(), mFillValue.end(), 0);
+    }
+
+    UByte* buffer = region.getBuffer();
+    if (buffer == NULL)
+    {
+        buffer = new UByte[extent.area() * mNumBytesPerPixel];
+        region.setBuffer(buffer);
+    }
+
+    const size_t outRowBytes = extent.col * mNumBytesPerPixel;
+    const size_t endCol = offset.col + extent.col;
+
+    for (size_t blockStart = 0; blockStart < extent.row;
+         blockStart += mBlockRows)
+    {
+        const size_t blockRows = std::min(mBlockRows,
+                                          extent.row - blockStart);
+        UByte* const blockOutput = buffer + blockStart * outRowBytes;
+
+        size_t firstValidRow(0);
+        size_t lastValidRow(0);
+        ValidDataMask::Span colSpan;
+        if (!mMask.getBlockExtent(offset.row + blockStart, blockRows,
+                                  offset.col, extent.col,
+                                  firstValidRow, lastValidRow, colSpan))
+        {
+            fill(blockOutput, blockRows * extent.col);
+            continue;
+        }
+
+        // Read just the bounding window of the valid data in this block
+        const size_t readRows = lastValidRow - firstValidRow + 1;
+        const size_t readCols = colSpan.length();
+        const size_t readRowBytes = readCols * mNumBytesPerPixel;
+        mScratch.resize(readRows * readRowBytes);
+
+        Region readRegion;
+        readRegion.setStartRow(firstValidRow);
+        readRegion.setNumRows(readRows);
+        readRegion.setStartCol(colSpan.start);
+        readRegion.setNumCols(readCols);
+        readRegion.setBuffer(&mScratch[0]);
+        mReader.interleaved(readRegion, mImageNumber);
+        mNumPixelsRead += readRows * readCols;
+
+        // Now copy over the valid spans and fill everything else
+        for (size_t row = 0; row < blockRows; ++row)
+        {
+            const size_t imageRow = offset.row + blockStart + row;
+            UByte* const rowOutput = blockOutput + row * outRowBytes;
+
+            if (imageRow < firstValidRow || imageRow > lastValidRow)
+            {
+                fill(rowOutput, extent.col);
+                continue;
+            }
+
+            const UByte* const rowInput =
+                    &mScratch[0] + (imageRow - firstValidRow) * readRowBytes;
+            const ValidDataMask::Span* const spans = mMask.getSpans(imageRow);
+            size_t col = offset.col;
+            for (size_t ii = 0, numSpans = mMask.getNumSpans(imageRow);
+                 ii < numSpans;
+                 ++ii)
+            {
+                const size_t start = std::max(spans[ii].start, offset.col);
+                const size_t end = std::min(spans[ii].end, endCol);
+                if (start >= end)
+                {
+                    continue;
+                }
+
+                fill(rowOutput + (col - offset.col) * mNumBytesPerPixel,
+                     start - col);
+                std::memcpy(
+                        rowOutput + (start - offset.col) * mNumBytesPerPixel,
+                        rowInput + (start - colSpan.start) * mNumBytesPerPixel,
+                        (end - start) * mNumBytesPerPixel);
+                col = end;
+            }
+            fill(rowOutput + (col - offset.col) * mNumBytesPerPixel,
+                 endCol - col);
+        }
+    }
+
+    return buffer;
+}
+}
@@ -0,0 +1,56 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <except/Exception.h>
+#include "six/ValidDataStatistics.h"
+
+namespace six
+{
+double ValidDataStatistics::getPercentile(double percent) const
+{
+    if (percent < 0.0 || percent > 100.0)
+    {
+        throw except::Exception(Ctxt("Percentile must be in [0, 100]"));
+    }
+
+    if (numValidPixels == 0 || histogram.empty())
+    {
+        return min;
+    }
+
+    // Find the bin where the running count crosses the target and
+    // interpolate within it
+    const double target = percent / 100.0 * numValidPixels;
+    double count(0.0);
+    for (size_t bin = 0; bin < histogram.size(); ++bin)
+    {
+        const double binCount = static_cast<double>(histogram[bin]);
+        if (binCount > 0.0 && count + binCount >= target)
+        {
+            const double fraction = (target - count) / binCount;
+            return std::min(min + (bin + fraction) * binWidth, max);
+        }
+        count += binCount;
+    }
+
+    return max;
+}
+}
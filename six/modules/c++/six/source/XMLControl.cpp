@@ -20,21 +20,90 @@
  *
  */
 
+#include <map>
+
+#include <io/StringStream.h>
 #include <logging/NullLogger.h>
+#include <mt/CriticalSection.h>
+#include <mt/Singleton.h>
+#include <sys/Mutex.h>
 #include <six/XMLControl.h>
+#include <six/Profiler.h>
 
-//! Validate the xml and log any errors
-//  NOTE: Errors are treated as detriments to valid processing
-//        and fail accordingly
-void validate(const xml::lite::Document* doc,
-              const std::vector<std::string>& schemaPaths,
-              logging::Logger* log)
+namespace
+{
+/*
+ *  Compiling the schemas costs far more than validating a document against
+ *  them, so validators are kept for reuse, keyed by the schema paths they
+ *  were built from.  Each one is only handed to one caller at a time, so
+ *  threads loading different files don't contend for one.
+ */
+class ValidatorPool
+{
+public:
+    ~ValidatorPool()
+    {
+        for (PoolMap::iterator iter = mPool.begin();
+             iter != mPool.end();
+             ++iter)
+        {
+            for (size_t ii = 0; ii < iter->second.size(); ++ii)
+            {
+                delete iter->second[ii];
+            }
+        }
+    }
+
+    std::auto_ptr<xml::lite::Validator>
+    acquire(const std::vector<std::string>& paths, logging::Logger* log)
+    {
+        {
+            mt::CriticalSection<sys::Mutex> lock(&mMutex);
+            std::vector<xml::lite::Validator*>& validators(mPool[paths]);
+            if (!validators.empty())
+            {
+                std::auto_ptr<xml::lite::Validator>
+                        validator(validators.back());
+                validators.pop_back();
+                return validator;
+            }
+        }
+
+        // Compile outside the lock so other paths aren't held up
+        return std::auto_ptr<xml::lite::Validator>(
+                new xml::lite::Validator(paths, log, true));
+    }
+
+    void release(const std::vector<std::string>& paths,
+                 std::auto_ptr<xml::lite::Validator> validator)
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        std::vector<xml::lite::Validator*>& validators(mPool[paths]);
+        validators.reserve(validators.size() + 1);
+        validators.push_back(validator.release());
+    }
+
+private:
+    typedef std::map<std::vector<std::string>,
+                     std::vector<xml::lite::Validator*> > PoolMap;
+
+    PoolMap mPool;
+    sys::Mutex mMutex;
+};
+
+typedef mt::Singleton<ValidatorPool, true> ValidatorPoolSingleton;
+}
+
+namespace
+{
+// Attempt to get the schema location from the environment if nothing is
+// specified
+std::vector<std::string>
+getSchemaPaths(const std::vector<std::string>& schemaPaths)
 {
-    // attempt to get the schema location from the 
-    // environment if nothing is specified
     std::vector<std::string> paths(schemaPaths);
     sys::OS os;
-    try 
+    try
     {
         if (paths.empty())
         {
@@ -50,44 +119,65 @@ void validate(const xml::lite::Document* doc,
     {
         // do nothing here
     }
+    return paths;
+}
 
-    // validate against any specified schemas
-    if (!paths.empty())
+//! Validate the xml against the schemas in paths and log any errors
+//  NOTE: Errors are treated as detriments to valid processing
+//        and fail accordingly
+void validate(const std::string& xml,
+              const std::string& uri,
+              const std::vector<std::string>& paths,
+              logging::Logger* log)
+{
+    if (uri.empty())
     {
-        xml::lite::Validator validator(paths, log, true);
+        throw six::DESValidationException(Ctxt(
+            "INVALID XML: URI is empty so document version cannot be "
+            "determined to use for validation"));
+    }
 
-        std::vector<xml::lite::ValidationInfo> errors;
+    std::vector<xml::lite::ValidationInfo> errors;
 
-        if (doc->getRootElement()->getUri().empty())
+    ValidatorPool& pool(ValidatorPoolSingleton::getInstance());
+    std::auto_ptr<xml::lite::Validator> validator(pool.acquire(paths, log));
+    validator->validate(xml, uri, errors);
+    pool.release(paths, validator);
+
+    // log any error found and throw
+    if (!errors.empty())
+    {
+        for (size_t i = 0; i < errors.size(); ++i)
         {
-            throw six::DESValidationException(Ctxt(
-                "INVALID XML: URI is empty so document version cannot be "
-                "determined to use for validation"));
+            log->critical(errors[i].toString());
         }
 
-        validator.validate(doc->getRootElement(), 
-                           doc->getRootElement()->getUri(), 
-                           errors);
-
-        // log any error found and throw
-        if (!errors.empty())
-        {
-            for (size_t i = 0; i < errors.size(); ++i)
-            {
-                log->critical(errors[i].toString());
-            }
+        //! this is a unique error thrown only in this location --
+        //  if the user wants a file written regardless of the consequences
+        //  they can catch this error, clear the vector and SIX_SCHEMA_PATH
+        //  and attempt to rewrite the file. Continuing in this manner is 
+        //  highly discouraged
+        throw six::DESValidationException(Ctxt(
+            "INVALID XML: Check both the XML being " \
+            "produced and the schemas available"));
+    }
+}
 
-            //! this is a unique error thrown only in this location --
-            //  if the user wants a file written regardless of the consequences
-            //  they can catch this error, clear the vector and SIX_SCHEMA_PATH
-            //  and attempt to rewrite the file. Continuing in this manner is 
-            //  highly discouraged
-            throw six::DESValidationException(Ctxt(
-                "INVALID XML: Check both the XML being " \
-                "produced and the schemas available"));
-        }
+void validate(const xml::lite::Document* doc,
+              const std::vector<std::string>& schemaPaths,
+              logging::Logger* log)
+{
+    // validate against any specified schemas
+    const std::vector<std::string> paths(getSchemaPaths(schemaPaths));
+    if (!paths.empty())
+    {
+        const xml::lite::Element* const root = doc->getRootElement();
+        io::StringStream xmlStream;
+        root->print(xmlStream);
+        validate(xmlStream.stream().str(), root->getUri(), paths, log);
     }
 }
+}
 
 namespace six
 {
@@ -170,15 +260,61 @@ xml::lite::Document* XMLControl::toXML(
         const Data* data,
         const std::vector<std::string>& schemaPaths)
 {
-    xml::lite::Document* doc = toXMLImpl(data);
-    validate(doc, schemaPaths, mLog);
+    xml::lite::Document* doc;
+    {
+        SIX_PROFILE_SCOPE("XMLControl::toXML");
+        doc = toXMLImpl(data);
+    }
+
+    {
+        SIX_PROFILE_SCOPE("XMLControl::validate");
+        validate(doc, schemaPaths, mLog);
+    }
     return doc;
 }
 
+void XMLControl::toXML(const Data* data,
+                       const std::vector<std::string>& schemaPaths,
+                       io::OutputStream& xmlStream)
+{
+    const std::vector<std::string> paths(getSchemaPaths(schemaPaths));
+    if (paths.empty())
+    {
+        SIX_PROFILE_SCOPE("XMLControl::toXML");
+        toXMLImpl(data, xmlStream);
+        return;
+    }
+
+    // Nothing can go out until it's known to be valid
+    io::StringStream xml;
+    {
+        SIX_PROFILE_SCOPE("XMLControl::toXML");
+        toXMLImpl(data, xml);
+    }
+
+    const std::string xmlString(xml.stream().str());
+    {
+        SIX_PROFILE_SCOPE("XMLControl::validate");
+        validate(xmlString, getDefaultURI(*data), paths, mLog);
+    }
+    xmlStream.write(xmlString);
+}
+
+void XMLControl::toXMLImpl(const Data* data, io::OutputStream& xmlStream)
+{
+    const std::auto_ptr<xml::lite::Document> doc(toXMLImpl(data));
+    doc->getRootElement()->print(xmlStream);
+}
+
 Data* XMLControl::fromXML(const xml::lite::Document* doc,
                           const std::vector<std::string>& schemaPaths)
 {
-    validate(doc, schemaPaths, mLog);
+    {
+        SIX_PROFILE_SCOPE("XMLControl::validate");
+        validate(doc, schemaPaths, mLog);
+    }
+
+    SIX_PROFILE_SCOPE("XMLControl::fromXML");
     Data* const data = fromXMLImpl(doc);
     data->setVersion(getVersionFromURI(doc));
     return data;
@@ -0,0 +1,210 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <except/Exception.h>
+#include <six/Init.h>
+#include <six/XMLStreamWriter.h>
+
+namespace
+{
+// Appends the decimal digits of value, same as str::toString<size_t>()
+void appendUnsigned(size_t value, std::string& str)
+{
+    char digits[24];
+    char* const end = digits + sizeof(digits);
+    char* begin = end;
+    do
+    {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    while (value != 0);
+
+    str.append(begin, end - begin);
+}
+}
+
+namespace six
+{
+XMLStreamWriter::XMLStreamWriter(io::OutputStream& stream,
+                                 size_t bufferSize) :
+    mStream(stream),
+    mBufferSize(bufferSize),
+    mDepth(0),
+    mStartTagOpen(false)
+{
+    // Leave room for whatever's appended after the last size check
+    mBuffer.reserve(bufferSize + 1024);
+}
+
+void XMLStreamWriter::startElement(const std::string& name,
+                                   const std::string& prefix)
+{
+    closeStartTag();
+
+    if (mDepth == mOpenElements.size())
+    {
+        mOpenElements.resize(mDepth + 1);
+    }
+    std::string& qname(mOpenElements[mDepth++]);
+    qname.assign(prefix).append(name);
+
+    mBuffer += '<';
+    mBuffer += qname;
+    mStartTagOpen = true;
+}
+
+void XMLStreamWriter::checkStartTagOpen(const char* what) const
+{
+    if (!mStartTagOpen)
+    {
+        throw except::Exception(Ctxt(
+                std::string("XML ") + what +
+                " must directly follow the start of its element"));
+    }
+}
+
+void XMLStreamWriter::attribute(const std::string& name,
+                                const std::string& value,
+                                const std::string& prefix)
+{
+    checkStartTagOpen("attributes");
+
+    mBuffer += ' ';
+    mBuffer += prefix;
+    mBuffer += name;
+    append("=\"", 2);
+    mBuffer += value;
+    mBuffer += '"';
+}
+
+void XMLStreamWriter::attribute(const std::string& name, size_t value)
+{
+    if (Init::isUndefined(value))
+    {
+        throw UninitializedValueException(
+                Ctxt("Attempted use of uninitialized value"));
+    }
+
+    checkStartTagOpen("attributes");
+
+    mBuffer += ' ';
+    mBuffer += name;
+    append("=\"", 2);
+    appendUnsigned(value, mBuffer);
+    mBuffer += '"';
+}
+
+void XMLStreamWriter::characters(const std::string& text)
+{
+    // The DOM treats empty character data as none at all
+    if (!text.empty())
+    {
+        checkStartTagOpen("character data");
+        closeStartTag();
+        mBuffer += text;
+    }
+}
+
+void XMLStreamWriter::characters(double value)
+{
+    char buffer[32];
+    const size_t length = formatDouble(value, buffer);
+
+    checkStartTagOpen("character data");
+    closeStartTag();
+    append(buffer, length);
+}
+
+void XMLStreamWriter::characters(int value)
+{
+    if (Init::isUndefined(value))
+    {
+        throw UninitializedValueException(
+                Ctxt("Attempted use of uninitialized value"));
+    }
+
+    char buffer[16];
+    const int length = sprintf(buffer, "%d", value);
+
+    checkStartTagOpen("character data");
+    closeStartTag();
+    append(buffer, length);
+}
+
+void XMLStreamWriter::endElement()
+{
+    if (mDepth == 0)
+    {
+        throw except::Exception(Ctxt("No XML element is open"));
+    }
+
+    const std::string& qname(mOpenElements[--mDepth]);
+    if (mStartTagOpen)
+    {
+        append("/>", 2);
+        mStartTagOpen = false;
+    }
+    else
+    {
+        append("</", 2);
+        mBuffer += qname;
+        mBuffer += '>';
+    }
+
+    flushIfFull();
+}
+
+void XMLStreamWriter::flush()
+{
+    if (!mBuffer.empty())
+    {
+        mStream.write(mBuffer);
+        mBuffer.clear();
+    }
+}
+
+size_t XMLStreamWriter::formatDouble(double value, char* buffer)
+{
+    if (Init::isUndefined(value))
+    {
+        throw UninitializedValueException(
+                Ctxt("Attempted use of uninitialized double value"));
+    }
+
+    // This is the conversion std::ostream does under std::scientific,
+    // std::uppercase and std::setprecision(15), minus the stringstream
+    size_t length = sprintf(buffer, "%.15E", value);
+
+    // Drop the first '+', which can only be the exponent's
+    char* const plus = static_cast<char*>(memchr(buffer, '+', length));
+    if (plus)
+    {
+        memmove(plus, plus + 1, buffer + length - plus);
+        --length;
+    }
+
+    return length;
+}
+}
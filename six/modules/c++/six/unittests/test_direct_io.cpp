@@ -0,0 +1,192 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <io/FileInputStream.h>
+#include <sys/OS.h>
+#include <six/DirectIO.h>
+#include "TestCase.h"
+
+namespace
+{
+// Small chunks so that the files span plenty of them
+const size_t CHUNK_SIZE = six::DirectIO::ALIGNMENT * 2;
+const size_t QUEUE_DEPTH = 2;
+const size_t FILE_SIZE = CHUNK_SIZE * 9 + 123;
+
+const char PATHNAME[] = "test_direct_io.bin";
+
+std::vector<sys::ubyte> makeData(size_t size)
+{
+    std::vector<sys::ubyte> data(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<sys::ubyte>(ii * 31 + ii / 251);
+    }
+    return data;
+}
+
+std::vector<sys::ubyte> readFile()
+{
+    io::FileInputStream inStream(PATHNAME);
+    std::vector<sys::ubyte> contents(
+            static_cast<size_t>(inStream.available()));
+    if (!contents.empty())
+    {
+        inStream.read(reinterpret_cast<sys::byte*>(&contents[0]),
+                      contents.size());
+    }
+    return contents;
+}
+
+void removeFile()
+{
+    try
+    {
+        sys::OS().remove(PATHNAME);
+    }
+    catch (...)
+    {
+    }
+}
+
+// Writes in odd sized pieces, then goes back and rewrites bits of it the
+// way NITRO fills in lengths
+void writeFile(const std::vector<sys::ubyte>& data)
+{
+    six::DirectIO io(PATHNAME, NITF_ACCESS_WRITEONLY, CHUNK_SIZE,
+                     QUEUE_DEPTH);
+    for (size_t offset = 0; offset < data.size(); )
+    {
+        const size_t size = std::min<size_t>(1 + offset % 3001,
+                                             data.size() - offset);
+        io.write(&data[offset], size);
+        offset += size;
+    }
+
+    const size_t patches[] = {10, CHUNK_SIZE - 2, CHUNK_SIZE * 5 + 7};
+    for (size_t ii = 0; ii < sizeof(patches) / sizeof(patches[0]); ++ii)
+    {
+        io.seek(patches[ii], NITF_SEEK_SET);
+        io.write(&data[patches[ii]], 5);
+    }
+    io.close();
+}
+
+TEST_CASE(testWrite)
+{
+    const std::vector<sys::ubyte> data = makeData(FILE_SIZE);
+    writeFile(data);
+    TEST_ASSERT(readFile() == data);
+    removeFile();
+}
+
+TEST_CASE(testWriteWithGap)
+{
+    // Anything skipped over reads back as zeros
+    const std::vector<sys::ubyte> data = makeData(100);
+    {
+        six::DirectIO io(PATHNAME, NITF_ACCESS_WRITEONLY, CHUNK_SIZE,
+                         QUEUE_DEPTH);
+        io.write(&data[0], data.size());
+        io.seek(CHUNK_SIZE * 3 + 50, NITF_SEEK_SET);
+        io.write(&data[0], data.size());
+        io.close();
+    }
+
+    const std::vector<sys::ubyte> contents = readFile();
+    TEST_ASSERT_EQ(contents.size(), CHUNK_SIZE * 3 + 150);
+    TEST_ASSERT(std::equal(data.begin(), data.end(), contents.begin()));
+    TEST_ASSERT(std::count(contents.begin() + 100,
+                           contents.begin() + CHUNK_SIZE * 3 + 50, 0) ==
+                static_cast<ptrdiff_t>(CHUNK_SIZE * 3 - 50));
+    TEST_ASSERT(std::equal(data.begin(), data.end(),
+                           contents.begin() + CHUNK_SIZE * 3 + 50));
+    removeFile();
+}
+
+TEST_CASE(testRead)
+{
+    const std::vector<sys::ubyte> data = makeData(FILE_SIZE);
+    writeFile(data);
+
+    six::DirectIO io(PATHNAME, NITF_ACCESS_READONLY, CHUNK_SIZE,
+                     QUEUE_DEPTH);
+    TEST_ASSERT_EQ(static_cast<size_t>(io.getSize()), data.size());
+
+    // All of it in one go, then in pieces out of order
+    std::vector<sys::ubyte> contents(data.size());
+    io.read(&contents[0], contents.size());
+    TEST_ASSERT(contents == data);
+
+    size_t state = 7;
+    for (size_t ii = 0; ii < 200; ++ii)
+    {
+        state = state * 1103515245 + 12345;
+        const size_t offset = (state / 65536) % data.size();
+        const size_t size = std::min<size_t>(1 + ii * 37 % 9000,
+                                             data.size() - offset);
+        io.seek(offset, NITF_SEEK_SET);
+        io.read(&contents[0], size);
+        TEST_ASSERT(std::equal(contents.begin(), contents.begin() + size,
+                               data.begin() + offset));
+    }
+
+    // Past the end
+    io.seek(data.size() - 10, NITF_SEEK_SET);
+    TEST_EXCEPTION(io.read(&contents[0], 11));
+    io.close();
+    removeFile();
+}
+
+TEST_CASE(testEmptyFile)
+{
+    {
+        six::DirectIO io(PATHNAME, NITF_ACCESS_WRITEONLY);
+        io.close();
+    }
+    TEST_ASSERT(readFile().empty());
+
+    six::DirectIO io(PATHNAME, NITF_ACCESS_READONLY);
+    TEST_ASSERT_EQ(io.getSize(), 0);
+    io.close();
+    removeFile();
+}
+
+TEST_CASE(testMissingFile)
+{
+    TEST_EXCEPTION(six::DirectIO("test_direct_io_missing.bin",
+                                 NITF_ACCESS_READONLY));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testWrite);
+    TEST_CHECK(testWriteWithGap);
+    TEST_CHECK(testRead);
+    TEST_CHECK(testEmptyFile);
+    TEST_CHECK(testMissingFile);
+    return 0;
+}
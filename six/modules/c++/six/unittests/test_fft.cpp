@@ -0,0 +1,138 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include <six/FFT.h>
+#include "TestCase.h"
+
+namespace
+{
+// Straightforward O(N^2) DFT to check against
+std::vector<std::complex<float> >
+dft(const std::vector<std::complex<float> >& input, int sign)
+{
+    const size_t size = input.size();
+    std::vector<std::complex<float> > output(size);
+    for (size_t kk = 0; kk < size; ++kk)
+    {
+        std::complex<double> sum(0.0, 0.0);
+        for (size_t nn = 0; nn < size; ++nn)
+        {
+            const double angle = sign * 2.0 * M_PI *
+                    static_cast<double>((nn * kk) % size) /
+                    static_cast<double>(size);
+            sum += std::complex<double>(input[nn]) *
+                    std::complex<double>(std::cos(angle), std::sin(angle));
+        }
+        output[kk] = std::complex<float>(sum);
+    }
+    return output;
+}
+
+std::vector<std::complex<float> > makeSignal(size_t size)
+{
+    std::vector<std::complex<float> > signal(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        signal[ii] = std::complex<float>(
+                static_cast<float>((ii * 7) % 13) - 6.0f,
+                static_cast<float>((ii * 5) % 11) - 5.0f);
+    }
+    return signal;
+}
+
+// Largest difference relative to the largest value
+double maxError(const std::vector<std::complex<float> >& lhs,
+                const std::vector<std::complex<float> >& rhs)
+{
+    double maxDiff = 0.0;
+    double maxValue = 0.0;
+    for (size_t ii = 0; ii < lhs.size(); ++ii)
+    {
+        maxDiff = std::max<double>(maxDiff, std::abs(lhs[ii] - rhs[ii]));
+        maxValue = std::max<double>(maxValue, std::abs(rhs[ii]));
+    }
+    return maxDiff / std::max(maxValue, 1.0);
+}
+}
+
+TEST_CASE(testAgainstDFT)
+{
+    // Powers of two and sizes that need Bluestein
+    const size_t sizes[] = { 1, 2, 8, 256, 3, 12, 97, 1000 };
+    for (size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ++ii)
+    {
+        const six::FFT fft(sizes[ii]);
+        const std::vector<std::complex<float> > signal =
+                makeSignal(sizes[ii]);
+
+        std::vector<std::complex<float> > transformed(signal);
+        fft.forward(&transformed[0]);
+        TEST_ASSERT(maxError(transformed, dft(signal, -1)) < 1e-5);
+
+        transformed = signal;
+        fft.inverse(&transformed[0]);
+        TEST_ASSERT(maxError(transformed, dft(signal, 1)) < 1e-5);
+
+        transformed = signal;
+        fft.transform(&transformed[0], 1);
+        TEST_ASSERT(maxError(transformed, dft(signal, 1)) < 1e-5);
+    }
+}
+
+TEST_CASE(testRoundTrip)
+{
+    const six::FFT fft(360);
+    const std::vector<std::complex<float> > signal = makeSignal(360);
+
+    std::vector<std::complex<float> > roundTrip(signal);
+    fft.forward(&roundTrip[0]);
+    fft.inverse(&roundTrip[0]);
+    for (size_t ii = 0; ii < roundTrip.size(); ++ii)
+    {
+        roundTrip[ii] /= 360.0f;
+    }
+    TEST_ASSERT(maxError(roundTrip, signal) < 1e-5);
+}
+
+TEST_CASE(testSizes)
+{
+    TEST_ASSERT(six::FFT::isPowerOfTwo(1));
+    TEST_ASSERT(six::FFT::isPowerOfTwo(64));
+    TEST_ASSERT(!six::FFT::isPowerOfTwo(0));
+    TEST_ASSERT(!six::FFT::isPowerOfTwo(96));
+    TEST_ASSERT_EQ(six::FFT::nextPowerOfTwo(1), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(six::FFT::nextPowerOfTwo(64), static_cast<size_t>(64));
+    TEST_ASSERT_EQ(six::FFT::nextPowerOfTwo(65), static_cast<size_t>(128));
+    TEST_EXCEPTION(six::FFT(0));
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testAgainstDFT);
+    TEST_CHECK(testRoundTrip);
+    TEST_CHECK(testSizes);
+    return 0;
+}
@@ -0,0 +1,196 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+
+#include <six/J2KCodestream.h>
+#include "TestCase.h"
+
+namespace
+{
+void append16(sys::Uint16_T value, std::vector<sys::ubyte>& data)
+{
+    data.push_back(static_cast<sys::ubyte>(value >> 8));
+    data.push_back(static_cast<sys::ubyte>(value));
+}
+
+void append32(sys::Uint32_T value, std::vector<sys::ubyte>& data)
+{
+    append16(static_cast<sys::Uint16_T>(value >> 16), data);
+    append16(static_cast<sys::Uint16_T>(value), data);
+}
+
+sys::Uint16_T get16(const sys::ubyte* data)
+{
+    return static_cast<sys::Uint16_T>((data[0] << 8) | data[1]);
+}
+
+sys::Uint32_T get32(const sys::ubyte* data)
+{
+    return (static_cast<sys::Uint32_T>(get16(data)) << 16) | get16(data + 2);
+}
+
+void appendTilePart(size_t numDataBytes,
+                    bool writeLength,
+                    std::vector<sys::ubyte>& data)
+{
+    append16(0xFF90, data);
+    append16(10, data);
+    append16(0, data);
+    append32(writeLength ?
+            static_cast<sys::Uint32_T>(14 + numDataBytes) : 0, data);
+    data.push_back(0);
+    data.push_back(1);
+    append16(0xFF93, data);
+    data.insert(data.end(), numDataBytes, 0x5A);
+}
+
+/*
+ *  A single tile codestream the way an encoder writes it, with only the
+ *  markers that matter here: SOC, SIZ for a 40x30 image with one 64x64
+ *  tile, a dummy COD, then two tile-parts, the last without a length
+ */
+std::vector<sys::ubyte> makeCodestream(sys::Uint16_T extraMarker = 0)
+{
+    std::vector<sys::ubyte> data;
+    append16(0xFF4F, data);
+
+    append16(0xFF51, data);
+    append16(41, data);
+    append16(0, data);
+    append32(30, data);
+    append32(40, data);
+    append32(0, data);
+    append32(0, data);
+    append32(64, data);
+    append32(64, data);
+    append32(0, data);
+    append32(0, data);
+    append16(1, data);
+    data.push_back(7);
+    data.push_back(1);
+    data.push_back(1);
+
+    append16(0xFF52, data);
+    append16(4, data);
+    append16(0, data);
+
+    if (extraMarker)
+    {
+        append16(extraMarker, data);
+        append16(2, data);
+    }
+
+    appendTilePart(20, true, data);
+    appendTilePart(7, false, data);
+    append16(0xFFD9, data);
+    return data;
+}
+}
+
+TEST_CASE(testParse)
+{
+    std::vector<sys::ubyte> data(makeCodestream());
+    const six::J2KCodestream codestream(&data[0], data.size());
+
+    // SOC (2) + SIZ (43) + COD (6)
+    TEST_ASSERT_EQ(codestream.getMainHeaderSize(), 51);
+    TEST_ASSERT_EQ(codestream.getNumTileParts(), 2);
+    TEST_ASSERT_EQ(codestream.getTilePartsSize(), 34 + 21);
+    TEST_ASSERT(codestream.getTileParts() + codestream.getTilePartsSize() ==
+                &data[data.size() - 2]);
+
+    // The open-ended tile-part gets a length since it won't be last
+    const sys::ubyte* const lastTilePart = codestream.getTileParts() + 34;
+    TEST_ASSERT_EQ(get16(lastTilePart), 0xFF90);
+    TEST_ASSERT_EQ(get32(lastTilePart + 6), 21);
+}
+
+TEST_CASE(testSplice)
+{
+    std::vector<sys::ubyte> data(makeCodestream());
+    six::J2KCodestream codestream(&data[0], data.size());
+
+    codestream.setTileIndex(1234);
+    TEST_ASSERT_EQ(get16(codestream.getTileParts() + 4), 1234);
+    TEST_ASSERT_EQ(get16(codestream.getTileParts() + 34 + 4), 1234);
+
+    codestream.setImageSize(types::RowCol<size_t>(1000, 2000),
+                            types::RowCol<size_t>(128, 256));
+    const sys::ubyte* const siz = codestream.getMainHeader() + 2;
+    TEST_ASSERT_EQ(get32(siz + 6), 2000);
+    TEST_ASSERT_EQ(get32(siz + 10), 1000);
+    TEST_ASSERT_EQ(get32(siz + 22), 256);
+    TEST_ASSERT_EQ(get32(siz + 26), 128);
+
+    // Nothing else moves
+    TEST_ASSERT_EQ(get32(siz + 14), 0);
+    TEST_ASSERT_EQ(get16(siz + 38), 1);
+}
+
+TEST_CASE(testInvalid)
+{
+    std::vector<sys::ubyte> data(makeCodestream());
+
+    // Indexes across tiles
+    std::vector<sys::ubyte> tlm(makeCodestream(0xFF55));
+    TEST_EXCEPTION(six::J2KCodestream(&tlm[0], tlm.size()));
+
+    // No EOC
+    TEST_EXCEPTION(six::J2KCodestream(&data[0], data.size() - 2));
+
+    // Tile-part runs past the end
+    std::vector<sys::ubyte> truncated(data.begin(), data.begin() + 70);
+    append16(0xFFD9, truncated);
+    TEST_EXCEPTION(six::J2KCodestream(&truncated[0], truncated.size()));
+
+    // Not a codestream
+    data[1] = 0x4E;
+    TEST_EXCEPTION(six::J2KCodestream(&data[0], data.size()));
+}
+
+TEST_CASE(testTileAlignment)
+{
+    // Powers of two always line up
+    TEST_ASSERT(six::J2KCodestream::isTileAligned(
+            types::RowCol<size_t>(1024, 1024), 6));
+    TEST_ASSERT(six::J2KCodestream::isTileAligned(
+            types::RowCol<size_t>(32, 65536), 6));
+
+    // Every 64th tile of 768 would straddle a precinct
+    TEST_ASSERT(!six::J2KCodestream::isTileAligned(
+            types::RowCol<size_t>(768, 1024), 1));
+
+    // Code-blocks straddle tiles
+    TEST_ASSERT(!six::J2KCodestream::isTileAligned(
+            types::RowCol<size_t>(1000, 1024), 1));
+    TEST_ASSERT(!six::J2KCodestream::isTileAligned(
+            types::RowCol<size_t>(1024, 96), 1));
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testParse);
+    TEST_CHECK(testSplice);
+    TEST_CHECK(testInvalid);
+    TEST_CHECK(testTileAlignment);
+    return 0;
+}
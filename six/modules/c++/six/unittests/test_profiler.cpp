@@ -0,0 +1,111 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <sys/Runnable.h>
+#include <mt/ThreadGroup.h>
+#include <six/Profiler.h>
+#include "TestCase.h"
+
+namespace
+{
+class ProfileRunnable : public sys::Runnable
+{
+public:
+    virtual void run()
+    {
+        for (size_t ii = 0; ii < 10; ++ii)
+        {
+            SIX_PROFILE_SCOPE("test/stage");
+            SIX_PROFILE_BYTES("test/stage", 100);
+        }
+    }
+};
+
+const six::ProfileStats* findStats(const std::vector<six::ProfileStats>& stats,
+                                   const std::string& name)
+{
+    for (size_t ii = 0; ii < stats.size(); ++ii)
+    {
+        if (stats[ii].name == name)
+        {
+            return &stats[ii];
+        }
+    }
+    return NULL;
+}
+}
+
+TEST_CASE(testThreads)
+{
+    six::Profiler& profiler(six::ProfilerSingleton::getInstance());
+    profiler.reset();
+    profiler.setEnabled(true);
+
+    mt::ThreadGroup threads;
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        threads.createThread(new ProfileRunnable());
+    }
+    threads.joinAll();
+    ProfileRunnable().run();
+
+    const std::vector<six::ProfileStats> stats = profiler.getStats();
+    const six::ProfileStats* const stage = findStats(stats, "test/stage");
+    TEST_ASSERT(stage != NULL);
+    TEST_ASSERT_EQ(stage->numCalls, static_cast<size_t>(40));
+    TEST_ASSERT_EQ(stage->numBytes, static_cast<sys::Uint64_T>(4000));
+    TEST_ASSERT(stage->minSeconds <= stage->maxSeconds);
+    TEST_ASSERT(stage->maxSeconds <= stage->totalSeconds);
+
+    // The worker threads have exited, so only this thread's stats are
+    // still broken out
+    const std::map<long, std::vector<six::ProfileStats> > byThread =
+            profiler.getStatsByThread();
+    TEST_ASSERT_EQ(byThread.size(), static_cast<size_t>(1));
+    const six::ProfileStats* const threadStage =
+            findStats(byThread.begin()->second, "test/stage");
+    TEST_ASSERT(threadStage != NULL);
+    TEST_ASSERT_EQ(threadStage->numCalls, static_cast<size_t>(10));
+
+    profiler.reset();
+    profiler.setEnabled(false);
+    TEST_ASSERT(findStats(profiler.getStats(), "test/stage") == NULL);
+}
+
+TEST_CASE(testDisabled)
+{
+    // Profiling is off by default
+    six::Profiler& profiler(six::ProfilerSingleton::getInstance());
+    profiler.reset();
+    TEST_ASSERT(!profiler.isEnabled());
+    ProfileRunnable().run();
+
+    TEST_ASSERT(profiler.getStats().empty());
+    TEST_ASSERT(profiler.toString().find("test/stage") == std::string::npos);
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testThreads);
+    TEST_CHECK(testDisabled);
+    return 0;
+}
@@ -0,0 +1,262 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#include <six/ValidDataMask.h>
+#include <six/ValidDataStatistics.h>
+#include "TestCase.h"
+
+TEST_CASE(testRectangle)
+{
+    std::vector<six::RowColInt> polygon(4);
+    polygon[0] = six::RowColInt(2, 3);
+    polygon[1] = six::RowColInt(2, 7);
+    polygon[2] = six::RowColInt(5, 7);
+    polygon[3] = six::RowColInt(5, 3);
+
+    const six::ValidDataMask mask(polygon, types::RowCol<size_t>(10, 10));
+    TEST_ASSERT_EQ(mask.getNumValidPixels(), static_cast<size_t>(4 * 5));
+    TEST_ASSERT(!mask.isRowValid(1));
+    TEST_ASSERT(!mask.isRowValid(6));
+
+    for (size_t row = 2; row <= 5; ++row)
+    {
+        TEST_ASSERT_EQ(mask.getNumSpans(row), static_cast<size_t>(1));
+        TEST_ASSERT_EQ(mask.getSpans(row)[0].start, static_cast<size_t>(3));
+        TEST_ASSERT_EQ(mask.getSpans(row)[0].end, static_cast<size_t>(8));
+    }
+
+    TEST_ASSERT(mask.isValid(2, 3));
+    TEST_ASSERT(mask.isValid(5, 7));
+    TEST_ASSERT(!mask.isValid(5, 8));
+    TEST_ASSERT(!mask.isValid(1, 5));
+}
+
+TEST_CASE(testTriangleAndClipping)
+{
+    // Counterclockwise triangle that extends past the right edge
+    std::vector<six::RowColDouble> polygon(3);
+    polygon[0] = six::RowColDouble(0, 0);
+    polygon[1] = six::RowColDouble(4, 0);
+    polygon[2] = six::RowColDouble(0, 8);
+
+    const six::ValidDataMask mask(polygon, types::RowCol<size_t>(5, 6));
+
+    // Row r covers columns [0, 8 - 2r]
+    TEST_ASSERT_EQ(mask.getSpans(0)[0].end, static_cast<size_t>(6));
+    TEST_ASSERT_EQ(mask.getSpans(1)[0].end, static_cast<size_t>(6));
+    TEST_ASSERT_EQ(mask.getSpans(2)[0].end, static_cast<size_t>(5));
+    TEST_ASSERT_EQ(mask.getSpans(3)[0].end, static_cast<size_t>(3));
+    TEST_ASSERT_EQ(mask.getSpans(4)[0].end, static_cast<size_t>(1));
+
+    std::vector<six::UByte> bytes(4 * 3);
+    mask.getMask(types::RowCol<size_t>(1, 2),
+                 types::RowCol<size_t>(4, 3),
+                 &bytes[0]);
+    const six::UByte expected[] = {1, 1, 1,
+                                   1, 1, 1,
+                                   1, 0, 0,
+                                   0, 0, 0};
+    TEST_ASSERT(std::equal(bytes.begin(), bytes.end(), expected));
+
+    size_t firstRow(0);
+    size_t lastRow(0);
+    six::ValidDataMask::Span span;
+    TEST_ASSERT(mask.getBlockExtent(2, 3, 1, 5, firstRow, lastRow, span));
+    TEST_ASSERT_EQ(firstRow, static_cast<size_t>(2));
+    TEST_ASSERT_EQ(lastRow, static_cast<size_t>(3));
+    TEST_ASSERT_EQ(span.start, static_cast<size_t>(1));
+    TEST_ASSERT_EQ(span.end, static_cast<size_t>(5));
+}
+
+TEST_CASE(testLShape)
+{
+    // The horizontal edge at row 5 is the bottom of the upper arm.  Its
+    // pixels are on the boundary, so they need to be valid just like
+    // those of the same edge when it's the top of the lower arm.
+    std::vector<six::RowColInt> polygon(6);
+    polygon[0] = six::RowColInt(0, 0);
+    polygon[1] = six::RowColInt(0, 10);
+    polygon[2] = six::RowColInt(5, 10);
+    polygon[3] = six::RowColInt(5, 5);
+    polygon[4] = six::RowColInt(10, 5);
+    polygon[5] = six::RowColInt(10, 0);
+
+    std::vector<six::RowColInt> flipped(polygon);
+    for (size_t ii = 0; ii < flipped.size(); ++ii)
+    {
+        flipped[ii].row = 10 - flipped[ii].row;
+    }
+
+    const types::RowCol<size_t> dims(12, 12);
+    const six::ValidDataMask mask(polygon, dims);
+    const six::ValidDataMask flippedMask(flipped, dims);
+
+    const size_t expectedNumValid = 5 * 11 + 11 + 5 * 6;
+    TEST_ASSERT_EQ(mask.getNumValidPixels(), expectedNumValid);
+    TEST_ASSERT_EQ(flippedMask.getNumValidPixels(), expectedNumValid);
+
+    for (size_t row = 0; row <= 10; ++row)
+    {
+        const size_t expectedEnd = (row <= 5) ? 11 : 6;
+        TEST_ASSERT_EQ(mask.getNumSpans(row), static_cast<size_t>(1));
+        TEST_ASSERT_EQ(mask.getSpans(row)[0].start, static_cast<size_t>(0));
+        TEST_ASSERT_EQ(mask.getSpans(row)[0].end, expectedEnd);
+
+        TEST_ASSERT_EQ(flippedMask.getNumSpans(10 - row),
+                       static_cast<size_t>(1));
+        TEST_ASSERT_EQ(flippedMask.getSpans(10 - row)[0].end, expectedEnd);
+    }
+    TEST_ASSERT(!mask.isRowValid(11));
+}
+
+TEST_CASE(testNotch)
+{
+    // A rectangle with a notch cut up into its bottom edge, so the top of
+    // the notch is a horizontal edge with the interior above it
+    std::vector<six::RowColInt> polygon(8);
+    polygon[0] = six::RowColInt(0, 0);
+    polygon[1] = six::RowColInt(0, 8);
+    polygon[2] = six::RowColInt(6, 8);
+    polygon[3] = six::RowColInt(6, 6);
+    polygon[4] = six::RowColInt(3, 6);
+    polygon[5] = six::RowColInt(3, 2);
+    polygon[6] = six::RowColInt(6, 2);
+    polygon[7] = six::RowColInt(6, 0);
+
+    const six::ValidDataMask mask(polygon, types::RowCol<size_t>(8, 10));
+    for (size_t row = 0; row <= 3; ++row)
+    {
+        TEST_ASSERT_EQ(mask.getNumSpans(row), static_cast<size_t>(1));
+        TEST_ASSERT_EQ(mask.getSpans(row)[0].end, static_cast<size_t>(9));
+    }
+    for (size_t row = 4; row <= 6; ++row)
+    {
+        TEST_ASSERT_EQ(mask.getNumSpans(row), static_cast<size_t>(2));
+        TEST_ASSERT_EQ(mask.getSpans(row)[0].end, static_cast<size_t>(3));
+        TEST_ASSERT_EQ(mask.getSpans(row)[1].start, static_cast<size_t>(6));
+    }
+    TEST_ASSERT_EQ(mask.getNumValidPixels(),
+                   static_cast<size_t>(4 * 9 + 3 * 6));
+}
+
+TEST_CASE(testEmptyPolygon)
+{
+    const six::ValidDataMask mask(std::vector<six::RowColInt>(),
+                                  types::RowCol<size_t>(3, 4));
+    TEST_ASSERT_EQ(mask.getNumValidPixels(), static_cast<size_t>(12));
+    TEST_ASSERT(mask.isValid(2, 3));
+}
+
+TEST_CASE(testStatistics)
+{
+    std::vector<six::RowColInt> polygon(4);
+    polygon[0] = six::RowColInt(0, 0);
+    polygon[1] = six::RowColInt(0, 4);
+    polygon[2] = six::RowColInt(4, 4);
+    polygon[3] = six::RowColInt(4, 0);
+
+    // Only the upper-left 5x5 is valid; fill the rest with junk
+    const types::RowCol<size_t> dims(8, 8);
+    const six::ValidDataMask mask(polygon, dims);
+    std::vector<std::complex<float> > image(dims.area(),
+                                            std::complex<float>(1000, 0));
+    for (size_t row = 0; row < 5; ++row)
+    {
+        for (size_t col = 0; col < 5; ++col)
+        {
+            image[row * dims.col + col] =
+                    std::complex<float>(0, static_cast<float>(row * 5 + col));
+        }
+    }
+
+    for (size_t numThreads = 1; numThreads <= 3; ++numThreads)
+    {
+        const six::ValidDataStatistics stats =
+                six::computeValidDataStatistics(
+                        &image[0], types::RowCol<size_t>(0, 0), dims, mask,
+                        24, numThreads);
+        TEST_ASSERT_EQ(stats.numValidPixels, static_cast<size_t>(25));
+        TEST_ASSERT_ALMOST_EQ(stats.mean, 12.0);
+        TEST_ASSERT_ALMOST_EQ(stats.min, 0.0);
+        TEST_ASSERT_ALMOST_EQ(stats.max, 24.0);
+        TEST_ASSERT_ALMOST_EQ(stats.getPercentile(0.0), 0.0);
+        TEST_ASSERT_ALMOST_EQ(stats.getPercentile(100.0), 24.0);
+        TEST_ASSERT_ALMOST_EQ_EPS(stats.getPercentile(50.0), 12.0,
+                                  stats.binWidth);
+    }
+
+    // Without a histogram the moments are still computed
+    const six::ValidDataStatistics noHistogram =
+            six::computeValidDataStatistics(
+                    &image[0], types::RowCol<size_t>(0, 0), dims, mask, 0);
+    TEST_ASSERT_EQ(noHistogram.numValidPixels, static_cast<size_t>(25));
+    TEST_ASSERT_ALMOST_EQ(noHistogram.mean, 12.0);
+    TEST_ASSERT_ALMOST_EQ(noHistogram.min, 0.0);
+    TEST_ASSERT_ALMOST_EQ(noHistogram.max, 24.0);
+    TEST_ASSERT(noHistogram.histogram.empty());
+}
+
+TEST_CASE(testNonFiniteStatistics)
+{
+    const types::RowCol<size_t> dims(2, 3);
+    const six::ValidDataMask mask(std::vector<six::RowColInt>(), dims);
+    std::vector<float> image(dims.area());
+    image[0] = 1.0f;
+    image[1] = std::numeric_limits<float>::quiet_NaN();
+    image[2] = 3.0f;
+    image[3] = std::numeric_limits<float>::infinity();
+    image[4] = -std::numeric_limits<float>::infinity();
+    image[5] = 5.0f;
+
+    const six::ValidDataStatistics stats =
+            six::computeValidDataStatistics(
+                    &image[0], types::RowCol<size_t>(0, 0), dims, mask, 4);
+    TEST_ASSERT_EQ(stats.numValidPixels, static_cast<size_t>(3));
+    TEST_ASSERT_EQ(stats.numNonFinitePixels, static_cast<size_t>(3));
+    TEST_ASSERT_ALMOST_EQ(stats.mean, 3.0);
+    TEST_ASSERT_ALMOST_EQ(stats.min, 1.0);
+    TEST_ASSERT_ALMOST_EQ(stats.max, 5.0);
+
+    size_t histogramCount(0);
+    for (size_t bin = 0; bin < stats.histogram.size(); ++bin)
+    {
+        histogramCount += stats.histogram[bin];
+    }
+    TEST_ASSERT_EQ(histogramCount, static_cast<size_t>(3));
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testRectangle);
+    TEST_CHECK(testTriangleAndClipping);
+    TEST_CHECK(testLShape);
+    TEST_CHECK(testNotch);
+    TEST_CHECK(testEmptyPolygon);
+    TEST_CHECK(testStatistics);
+    TEST_CHECK(testNonFiniteStatistics);
+    return 0;
+}
@@ -0,0 +1,159 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+
+#include <io/ByteStream.h>
+#include <nitf/MemoryIO.hpp>
+#include <six/Adapters.h>
+#include "TestCase.h"
+
+namespace
+{
+const size_t NUM_ROWS = 37;
+const size_t NUM_COLS = 11;
+const size_t FIRST_ROW = 5;
+
+// Complex short pixels, so the elements are 2 bytes
+const size_t NUM_CHANNELS = 2;
+const size_t PIXEL_SIZE = 4;
+
+std::vector<six::UByte> makeImage()
+{
+    std::vector<six::UByte> image(NUM_ROWS * NUM_COLS * PIXEL_SIZE);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = static_cast<six::UByte>(ii * 7 + ii / 251);
+    }
+    return image;
+}
+
+// What should land in the file for the segment starting at 'firstRow'
+std::vector<six::UByte> expected(const std::vector<six::UByte>& image,
+                                 size_t firstRow,
+                                 bool doByteSwap)
+{
+    std::vector<six::UByte> rows(image.begin() +
+                                         firstRow * NUM_COLS * PIXEL_SIZE,
+                                 image.end());
+    if (doByteSwap)
+    {
+        for (size_t ii = 0; ii < rows.size(); ii += 2)
+        {
+            std::swap(rows[ii], rows[ii + 1]);
+        }
+    }
+    return rows;
+}
+
+six::NITFSegmentInfo segmentInfo(size_t firstRow)
+{
+    six::NITFSegmentInfo info;
+    info.firstRow = firstRow;
+    info.rowOffset = firstRow;
+    info.numRows = NUM_ROWS - firstRow;
+    return info;
+}
+
+std::vector<six::UByte> write(nitf::WriteHandler& handler, size_t numBytes)
+{
+    std::vector<six::UByte> output(numBytes);
+    nitf::MemoryIO io(&output[0], output.size());
+    handler.write(io);
+    return output;
+}
+}
+
+TEST_CASE(testMemory)
+{
+    const std::vector<six::UByte> image(makeImage());
+    const size_t rowSize = NUM_COLS * PIXEL_SIZE;
+
+    // A chunk smaller than a row, one that isn't a whole number of rows,
+    // and one bigger than the segment
+    const size_t chunkSizes[] = { 1, rowSize * 3 + 5, 1024 * 1024 };
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        for (size_t numThreads = 1; numThreads <= 3; numThreads += 2)
+        {
+            for (int doByteSwap = 0; doByteSwap < 2; ++doByteSwap)
+            {
+                six::MemoryWriteHandler handler(
+                        segmentInfo(FIRST_ROW), &image[0], FIRST_ROW,
+                        NUM_COLS, NUM_CHANNELS, PIXEL_SIZE, doByteSwap != 0,
+                        numThreads, chunkSizes[ii]);
+
+                const std::vector<six::UByte> output =
+                        write(handler, (NUM_ROWS - FIRST_ROW) * rowSize);
+                TEST_ASSERT(output ==
+                            expected(image, FIRST_ROW, doByteSwap != 0));
+            }
+        }
+    }
+}
+
+TEST_CASE(testStream)
+{
+    const std::vector<six::UByte> image(makeImage());
+    const size_t rowSize = NUM_COLS * PIXEL_SIZE;
+
+    for (int doByteSwap = 0; doByteSwap < 2; ++doByteSwap)
+    {
+        io::ByteStream stream;
+        stream.write(reinterpret_cast<const sys::byte*>(&image[0]),
+                     image.size());
+        stream.seek(0, io::Seekable::START);
+
+        six::StreamWriteHandler handler(segmentInfo(0), &stream, NUM_COLS,
+                                        NUM_CHANNELS, PIXEL_SIZE,
+                                        doByteSwap != 0, 2, rowSize * 4);
+
+        const std::vector<six::UByte> output =
+                write(handler, NUM_ROWS * rowSize);
+        TEST_ASSERT(output == expected(image, 0, doByteSwap != 0));
+    }
+}
+
+TEST_CASE(testShortStream)
+{
+    const std::vector<six::UByte> image(makeImage());
+    const size_t rowSize = NUM_COLS * PIXEL_SIZE;
+
+    // The stream is missing the last row
+    io::ByteStream stream;
+    stream.write(reinterpret_cast<const sys::byte*>(&image[0]),
+                 image.size() - rowSize);
+    stream.seek(0, io::Seekable::START);
+
+    six::StreamWriteHandler handler(segmentInfo(0), &stream, NUM_COLS,
+                                    NUM_CHANNELS, PIXEL_SIZE, true, 1,
+                                    rowSize * 4);
+    TEST_EXCEPTION(write(handler, NUM_ROWS * rowSize));
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMemory);
+    TEST_CHECK(testStream);
+    TEST_CHECK(testShortStream);
+    return 0;
+}
@@ -0,0 +1,146 @@
+/* =========================================================================
+ * This file is part of the CSM SIX Plugin
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * The CSM SIX Plugin is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_CSM_MODEL_STATE_CACHE_H__
+#define __SIX_CSM_MODEL_STATE_CACHE_H__
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <sys/Mutex.h>
+#include <mem/SharedPtr.h>
+#include <mt/Singleton.h>
+#include <six/Data.h>
+
+namespace six
+{
+namespace CSM
+{
+/**
+ * @class ModelStateCache
+ *
+ * @brief Holds onto the Data parsed out of recently seen sensor model states
+ * so that constructing a model from the same state again skips the XML
+ * parse.
+ *
+ * Entries are keyed by a hash of the state string.  The full state is still
+ * compared on lookup so that a hash collision can never hand back the wrong
+ * Data.  When full, the least recently used entry is evicted.  All methods
+ * are thread-safe.
+ *
+ * Each entry also records the schema directories its state was validated
+ * against, and is only found by a lookup with the same directories.  That
+ * way a model that validates never picks up a state that was parsed by one
+ * that didn't.
+ *
+ * The cache holds DEFAULT_MAX_ENTRIES states unless the MAX_ENTRIES_ENV
+ * environment variable is set when it's first used.  Set it to 0 to disable
+ * caching, or call setMaxEntries() on ModelStateCacheSingleton.
+ */
+class ModelStateCache
+{
+public:
+    static const size_t DEFAULT_MAX_ENTRIES;
+
+    //! Environment variable that overrides DEFAULT_MAX_ENTRIES
+    static const char MAX_ENTRIES_ENV[];
+
+    ModelStateCache();
+
+    /**
+     * Looks up a state
+     *
+     * \param state The full sensor model state
+     * \param schemaPaths Schema directories the state must have been
+     * validated against
+     *
+     * \return A copy of the cached Data, or NULL if the state isn't cached
+     */
+    std::auto_ptr<six::Data> find(const std::string& state,
+                                  const std::vector<std::string>& schemaPaths);
+
+    /**
+     * Caches a copy of the Data parsed from a state
+     *
+     * \param state The full sensor model state
+     * \param schemaPaths Schema directories the state was validated against
+     * \param data The Data the state describes
+     */
+    void insert(const std::string& state,
+                const std::vector<std::string>& schemaPaths,
+                const six::Data& data);
+
+    /**
+     * Sets the maximum number of states to cache, evicting the least
+     * recently used ones as needed.  Use 0 to disable caching.
+     */
+    void setMaxEntries(size_t maxEntries);
+
+    size_t getMaxEntries() const;
+
+    size_t getNumEntries() const;
+
+    //! \return The number of find() calls that returned Data
+    size_t getNumHits() const;
+
+    //! \return The number of find() calls that returned NULL
+    size_t getNumMisses() const;
+
+    //! Removes all entries and resets the hit/miss counts
+    void clear();
+
+    //! 64-bit FNV-1a hash of a state
+    static sys::Uint64_T hash(const std::string& state);
+
+private:
+    struct Entry
+    {
+        std::string state;
+        std::vector<std::string> schemaPaths;
+        mem::SharedPtr<const six::Data> data;
+        sys::Uint64_T lastUsed;
+    };
+
+    typedef std::multimap<sys::Uint64_T, Entry> EntryMap;
+
+    EntryMap::iterator findEntry(const std::string& state,
+                                 const std::vector<std::string>& schemaPaths);
+
+    void evict(size_t maxEntries);
+
+private:
+    mutable sys::Mutex mMutex;
+    EntryMap mEntries;
+    size_t mMaxEntries;
+    sys::Uint64_T mClock;
+    size_t mNumHits;
+    size_t mNumMisses;
+};
+
+typedef mt::Singleton<ModelStateCache, true> ModelStateCacheSingleton;
+}
+}
+
+#endif
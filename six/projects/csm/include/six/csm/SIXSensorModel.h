@@ -24,6 +24,7 @@
 #define __SIX_CSM_SIX_SENSOR_MODEL_H__
 
 #include <memory>
+#include <vector>
 
 #include "RasterGM.h"
 #include "CorrelationModel.h"
@@ -600,6 +601,52 @@ public: // RasterGM methods
     double getCorrelationCoefficient(size_t cpGroupIndex,
                                      double deltaTime) const;
 
+public: // Batch methods
+    // These are not part of the CSM API.  They give the same results as
+    // calling the single point versions once per point, but do the setup
+    // and error handling once and can split the points up among threads.
+
+    /**
+     * Converts many ground points to image coordinates
+     *
+     * \param[in] groundPts Ground coordinates in meters
+     * \param[out] imagePts Image coordinates in pixels.  Resized to match
+     *     groundPts.
+     * \param[in] numThreads Number of threads to use
+     */
+    virtual void groundToImage(const std::vector<csm::EcefCoord>& groundPts,
+                               std::vector<csm::ImageCoord>& imagePts,
+                               size_t numThreads = 1) const;
+
+    /**
+     * Converts many image points to ground coordinates
+     *
+     * \param[in] imagePts Image line and sample in pixels
+     * \param[in] heights Height for each point in meters measured with
+     *     respect to the WGS-84 ellipsoid.  This may also contain a single
+     *     height to use for every point.
+     * \param[out] groundPts Ground coordinates in meters.  Resized to match
+     *     imagePts.
+     * \param[in] numThreads Number of threads to use
+     */
+    virtual void imageToGround(const std::vector<csm::ImageCoord>& imagePts,
+                               const std::vector<double>& heights,
+                               std::vector<csm::EcefCoord>& groundPts,
+                               size_t numThreads = 1) const;
+
+    /**
+     * Computes the ground partials for many points
+     *
+     * \param[in] groundPts Ground coordinates in meters
+     * \param[out] partials Six partials per point, laid out the same way as
+     *     computeGroundPartials() returns them for a single point
+     * \param[in] numThreads Number of threads to use
+     */
+    virtual void computeGroundPartials(
+            const std::vector<csm::EcefCoord>& groundPts,
+            std::vector<double>& partials,
+            size_t numThreads = 1) const;
+
 public:
     // All remaining public methods throw csm::Error's that they're not
     // implemented
@@ -683,6 +730,31 @@ protected:
     static
     DataType getDataType(const csm::Des& des);
 
+private:
+    struct Batch;
+    class BatchRunnable;
+
+    typedef void (SIXSensorModel::*BatchFunction)(const Batch& batch,
+                                                  size_t startPoint,
+                                                  size_t numPoints) const;
+
+    void runBatch(BatchFunction function,
+                  const Batch& batch,
+                  size_t numPoints,
+                  size_t numThreads) const;
+
+    void groundToImageBatch(const Batch& batch,
+                            size_t startPoint,
+                            size_t numPoints) const;
+
+    void imageToGroundBatch(const Batch& batch,
+                            size_t startPoint,
+                            size_t numPoints) const;
+
+    void computeGroundPartialsBatch(const Batch& batch,
+                                    size_t startPoint,
+                                    size_t numPoints) const;
+
 protected:
     const scene::ECEFToLLATransform mECEFToLLA;
     const csm::NoCorrelationModel mCorrelationModel;
@@ -0,0 +1,216 @@
+/* =========================================================================
+ * This file is part of the CSM SIX Plugin
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2016, MDA Information Systems LLC
+ *
+ * The CSM SIX Plugin is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include <str/Convert.h>
+#include <sys/OS.h>
+#include <six/csm/ModelStateCache.h>
+
+namespace six
+{
+namespace CSM
+{
+const size_t ModelStateCache::DEFAULT_MAX_ENTRIES = 32;
+const char ModelStateCache::MAX_ENTRIES_ENV[] =
+        "SIX_CSM_MODEL_STATE_CACHE_SIZE";
+
+ModelStateCache::ModelStateCache() :
+    mMaxEntries(DEFAULT_MAX_ENTRIES),
+    mClock(0),
+    mNumHits(0),
+    mNumMisses(0)
+{
+    std::string maxEntries;
+    if (sys::OS().getEnvIfSet(MAX_ENTRIES_ENV, maxEntries))
+    {
+        try
+        {
+            mMaxEntries = str::toType<size_t>(maxEntries);
+        }
+        catch (const except::Exception&)
+        {
+            // Stick with the default rather than failing model construction
+            // over a typo
+        }
+    }
+}
+
+sys::Uint64_T ModelStateCache::hash(const std::string& state)
+{
+    sys::Uint64_T value = 14695981039346656037ULL;
+    for (size_t ii = 0; ii < state.length(); ++ii)
+    {
+        value ^= static_cast<unsigned char>(state[ii]);
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+ModelStateCache::EntryMap::iterator
+ModelStateCache::findEntry(const std::string& state,
+                           const std::vector<std::string>& schemaPaths)
+{
+    const std::pair<EntryMap::iterator, EntryMap::iterator> range =
+            mEntries.equal_range(hash(state));
+    for (EntryMap::iterator iter = range.first; iter != range.second; ++iter)
+    {
+        if (iter->second.state == state &&
+            iter->second.schemaPaths == schemaPaths)
+        {
+            return iter;
+        }
+    }
+    return mEntries.end();
+}
+
+std::auto_ptr<six::Data>
+ModelStateCache::find(const std::string& state,
+                      const std::vector<std::string>& schemaPaths)
+{
+    mem::SharedPtr<const six::Data> data;
+
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+
+        const EntryMap::iterator iter = findEntry(state, schemaPaths);
+        if (iter != mEntries.end())
+        {
+            iter->second.lastUsed = ++mClock;
+            data = iter->second.data;
+            ++mNumHits;
+        }
+        else
+        {
+            ++mNumMisses;
+        }
+    }
+
+    // The cached copy is never modified, so it's safe to clone it outside
+    // of the lock
+    std::auto_ptr<six::Data> copy;
+    if (data.get())
+    {
+        copy.reset(data->clone());
+    }
+    return copy;
+}
+
+void ModelStateCache::insert(const std::string& state,
+                             const std::vector<std::string>& schemaPaths,
+                             const six::Data& data)
+{
+    // Don't bother cloning if caching is disabled
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        if (mMaxEntries == 0)
+        {
+            return;
+        }
+    }
+
+    // Clone before locking so we hold the lock as briefly as possible
+    const mem::SharedPtr<const six::Data> copy(data.clone());
+    const sys::Uint64_T key = hash(state);
+
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    if (mMaxEntries == 0)
+    {
+        return;
+    }
+
+    const EntryMap::iterator iter = findEntry(state, schemaPaths);
+    if (iter != mEntries.end())
+    {
+        iter->second.lastUsed = ++mClock;
+        return;
+    }
+
+    evict(mMaxEntries - 1);
+
+    Entry entry;
+    entry.state = state;
+    entry.schemaPaths = schemaPaths;
+    entry.data = copy;
+    entry.lastUsed = ++mClock;
+    mEntries.insert(EntryMap::value_type(key, entry));
+}
+
+void ModelStateCache::evict(size_t maxEntries)
+{
+    // There aren't many entries, so just search for the oldest one each time
+    while (mEntries.size() > maxEntries)
+    {
+        EntryMap::iterator oldest = mEntries.begin();
+        for (EntryMap::iterator iter = mEntries.begin();
+             iter != mEntries.end();
+             ++iter)
+        {
+            if (iter->second.lastUsed < oldest->second.lastUsed)
+            {
+                oldest = iter;
+            }
+        }
+        mEntries.erase(oldest);
+    }
+}
+
+void ModelStateCache::setMaxEntries(size_t maxEntries)
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mMaxEntries = maxEntries;
+    evict(mMaxEntries);
+}
+
+size_t ModelStateCache::getMaxEntries() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mMaxEntries;
+}
+
+size_t ModelStateCache::getNumEntries() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mEntries.size();
+}
+
+size_t ModelStateCache::getNumHits() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mNumHits;
+}
+
+size_t ModelStateCache::getNumMisses() const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mNumMisses;
+}
+
+void ModelStateCache::clear()
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mEntries.clear();
+    mNumHits = 0;
+    mNumMisses = 0;
+}
+}
+}
@@ -24,6 +24,7 @@
 #include <sys/OS.h>
 #include <sys/Path.h>
 #include <six/csm/SICDSensorModel.h>
+#include <six/csm/ModelStateCache.h>
 #include <io/StringStream.h>
 #include <logging/NullLogger.h>
 #include <six/XMLControlFactory.h>
@@ -107,6 +108,9 @@ void SICDSensorModel::initializeFromFile(const std::string& pathname)
         const std::string xmlStr = six::toXMLString(mData.get(), &xmlRegistry);
         mSensorModelState = NAME + std::string(" ") + xmlStr;
         reinitialize();
+        ModelStateCacheSingleton::getInstance().insert(mSensorModelState,
+                                                       mSchemaDirs,
+                                                       *mData);
     }
     catch (const except::Exception& ex)
     {
@@ -197,6 +201,9 @@ void SICDSensorModel::initializeFromISD(const csm::Nitf21Isd& isd)
         mData.reset(reinterpret_cast<six::sicd::ComplexData*>(control->fromXML(
                 sicdXML, mSchemaDirs)));
         reinitialize();
+        ModelStateCacheSingleton::getInstance().insert(mSensorModelState,
+                                                       mSchemaDirs,
+                                                       *mData);
     }
     catch (const except::Exception& ex)
     {
@@ -405,10 +412,24 @@ void SICDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
                            "SICDSensorModel::replaceModelStateImpl");
     }
 
-    const std::string sensorModelXML = sensorModelState.substr(idx + 1);
-
     try
     {
+        // Constructing models from the same state over and over is common, so
+        // skip the XML parse if we've seen this one before.  The cache only
+        // matches states validated against the same schemas we would use.
+        std::auto_ptr<six::Data> cachedData =
+                ModelStateCacheSingleton::getInstance().find(sensorModelState,
+                                                             mSchemaDirs);
+        if (cachedData.get())
+        {
+            mSensorModelState = sensorModelState;
+            mData.reset(reinterpret_cast<six::sicd::ComplexData*>(
+                    cachedData.release()));
+            reinitialize();
+            return;
+        }
+
+        const std::string sensorModelXML = sensorModelState.substr(idx + 1);
         io::StringStream stream;
         stream.write(sensorModelXML.c_str(), sensorModelXML.length());
 
@@ -429,6 +450,9 @@ void SICDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
         mData.reset(reinterpret_cast<six::sicd::ComplexData*>(control->fromXML(
                 domParser.getDocument(), mSchemaDirs)));
         reinitialize();
+        ModelStateCacheSingleton::getInstance().insert(mSensorModelState,
+                                                       mSchemaDirs,
+                                                       *mData);
     }
     catch (const except::Exception& ex)
     {
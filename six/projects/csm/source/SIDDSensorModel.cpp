@@ -24,6 +24,7 @@
 #include <sys/OS.h>
 #include <sys/Path.h>
 #include <six/csm/SIDDSensorModel.h>
+#include <six/csm/ModelStateCache.h>
 #include <io/StringStream.h>
 #include <logging/NullLogger.h>
 #include <six/XMLControlFactory.h>
@@ -140,6 +141,9 @@ void SIDDSensorModel::initializeFromFile(const std::string& pathname,
         const std::string xmlStr = six::toXMLString(mData.get(), &xmlRegistry);
         mSensorModelState = NAME + std::string(" ") + xmlStr;
         reinitialize();
+        ModelStateCacheSingleton::getInstance().insert(mSensorModelState,
+                                                       mSchemaDirs,
+                                                       *mData);
     }
     catch (const except::Exception& ex)
     {
@@ -228,6 +232,9 @@ void SIDDSensorModel::initializeFromISD(const csm::Nitf21Isd& isd,
         mData.reset(reinterpret_cast<six::sidd::DerivedData*>(control->fromXML(
                 siddXML, mSchemaDirs)));
         reinitialize();
+        ModelStateCacheSingleton::getInstance().insert(mSensorModelState,
+                                                       mSchemaDirs,
+                                                       *mData);
     }
     catch (const except::Exception& ex)
     {
@@ -410,10 +417,24 @@ void SIDDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
                            "SIDDSensorModel::replaceModelStateImpl");
     }
 
-    const std::string sensorModelXML = sensorModelState.substr(idx + 1);
-
     try
     {
+        // Constructing models from the same state over and over is common, so
+        // skip the XML parse if we've seen this one before.  The cache only
+        // matches states validated against the same schemas we would use.
+        std::auto_ptr<six::Data> cachedData =
+                ModelStateCacheSingleton::getInstance().find(sensorModelState,
+                                                             mSchemaDirs);
+        if (cachedData.get())
+        {
+            mSensorModelState = sensorModelState;
+            mData.reset(reinterpret_cast<six::sidd::DerivedData*>(
+                    cachedData.release()));
+            reinitialize();
+            return;
+        }
+
+        const std::string sensorModelXML = sensorModelState.substr(idx + 1);
         io::StringStream stream;
         stream.write(sensorModelXML.c_str(), sensorModelXML.length());
 
@@ -434,6 +455,9 @@ void SIDDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
         mData.reset(reinterpret_cast<six::sidd::DerivedData*>(control->fromXML(
                 domParser.getDocument(), mSchemaDirs)));
         reinitialize();
+        ModelStateCacheSingleton::getInstance().insert(mSensorModelState,
+                                                       mSchemaDirs,
+                                                       *mData);
     }
     catch (const except::Exception& ex)
     {
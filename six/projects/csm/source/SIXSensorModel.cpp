@@ -24,6 +24,9 @@
 #include <limits>
 
 #include "Error.h"
+#include <sys/Runnable.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
 #include <six/NITFReadControl.h>
 #include <six/csm/SIXSensorModel.h>
 
@@ -842,6 +845,237 @@ csm::EcefCoordCovar SIXSensorModel::imageToGround(
     }
 }
 
+struct SIXSensorModel::Batch
+{
+    Batch() :
+        groundPtsIn(NULL),
+        imagePtsIn(NULL),
+        heights(NULL),
+        numHeights(0),
+        imagePtsOut(NULL),
+        groundPtsOut(NULL),
+        partialsOut(NULL)
+    {
+    }
+
+    const csm::EcefCoord* groundPtsIn;
+    const csm::ImageCoord* imagePtsIn;
+    const double* heights;
+    size_t numHeights;
+    types::RowCol<double> sampleSpacing;
+
+    csm::ImageCoord* imagePtsOut;
+    csm::EcefCoord* groundPtsOut;
+    double* partialsOut;
+};
+
+class SIXSensorModel::BatchRunnable : public sys::Runnable
+{
+public:
+    BatchRunnable(const SIXSensorModel& model,
+                  BatchFunction function,
+                  const Batch& batch,
+                  size_t startPoint,
+                  size_t numPoints) :
+        mModel(model),
+        mFunction(function),
+        mBatch(batch),
+        mStartPoint(startPoint),
+        mNumPoints(numPoints)
+    {
+    }
+
+    virtual void run()
+    {
+        (mModel.*mFunction)(mBatch, mStartPoint, mNumPoints);
+    }
+
+private:
+    const SIXSensorModel& mModel;
+    const BatchFunction mFunction;
+    const Batch& mBatch;
+    const size_t mStartPoint;
+    const size_t mNumPoints;
+};
+
+void SIXSensorModel::runBatch(BatchFunction function,
+                              const Batch& batch,
+                              size_t numPoints,
+                              size_t numThreads) const
+{
+    if (numThreads <= 1)
+    {
+        (this->*function)(batch, 0, numPoints);
+    }
+    else
+    {
+        mt::ThreadGroup threads;
+        const mt::ThreadPlanner planner(numPoints, numThreads);
+
+        size_t threadNum(0);
+        size_t startPoint(0);
+        size_t numPointsThisThread(0);
+        while (planner.getThreadInfo(threadNum++,
+                                     startPoint,
+                                     numPointsThisThread))
+        {
+            std::auto_ptr<sys::Runnable> runnable(new BatchRunnable(
+                    *this, function, batch, startPoint, numPointsThisThread));
+            threads.createThread(runnable);
+        }
+
+        threads.joinAll();
+    }
+}
+
+void SIXSensorModel::groundToImageBatch(const Batch& batch,
+                                        size_t startPoint,
+                                        size_t numPoints) const
+{
+    for (size_t ii = startPoint; ii < startPoint + numPoints; ++ii)
+    {
+        const types::RowCol<double> imagePt =
+                mProjection->sceneToImage(toVector3(batch.groundPtsIn[ii]));
+        batch.imagePtsOut[ii] = toImageCoord(toPixel(imagePt));
+    }
+}
+
+void SIXSensorModel::imageToGroundBatch(const Batch& batch,
+                                        size_t startPoint,
+                                        size_t numPoints) const
+{
+    for (size_t ii = startPoint; ii < startPoint + numPoints; ++ii)
+    {
+        const double height =
+                batch.heights[(batch.numHeights == 1) ? 0 : ii];
+        batch.groundPtsOut[ii] = toEcefCoord(mProjection->imageToScene(
+                fromPixel(batch.imagePtsIn[ii]), height));
+    }
+}
+
+void SIXSensorModel::computeGroundPartialsBatch(const Batch& batch,
+                                                size_t startPoint,
+                                                size_t numPoints) const
+{
+    // sceneToImagePartials() return value is in m/m, we want pixels/m
+    const types::RowCol<double>& ss(batch.sampleSpacing);
+
+    for (size_t ii = startPoint; ii < startPoint + numPoints; ++ii)
+    {
+        const scene::Vector3 sceneGroundPt(toVector3(batch.groundPtsIn[ii]));
+        const math::linear::MatrixMxN<2, 3> groundPartials =
+                mProjection->sceneToImagePartials(
+                        sceneGroundPt,
+                        mProjection->sceneToImage(sceneGroundPt));
+
+        double* const partials = batch.partialsOut + ii * 6;
+        partials[0] = groundPartials[0][0] / ss.row;
+        partials[1] = groundPartials[0][1] / ss.row;
+        partials[2] = groundPartials[0][2] / ss.row;
+        partials[3] = groundPartials[1][0] / ss.col;
+        partials[4] = groundPartials[1][1] / ss.col;
+        partials[5] = groundPartials[1][2] / ss.col;
+    }
+}
+
+void SIXSensorModel::groundToImage(
+        const std::vector<csm::EcefCoord>& groundPts,
+        std::vector<csm::ImageCoord>& imagePts,
+        size_t numThreads) const
+{
+    imagePts.resize(groundPts.size());
+    if (groundPts.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        Batch batch;
+        batch.groundPtsIn = &groundPts[0];
+        batch.imagePtsOut = &imagePts[0];
+        runBatch(&SIXSensorModel::groundToImageBatch,
+                 batch,
+                 groundPts.size(),
+                 numThreads);
+    }
+    catch (const except::Exception& ex)
+    {
+        throw csm::Error(csm::Error::UNKNOWN_ERROR,
+                           ex.getMessage(),
+                           "SIXSensorModel::groundToImage");
+    }
+}
+
+void SIXSensorModel::imageToGround(
+        const std::vector<csm::ImageCoord>& imagePts,
+        const std::vector<double>& heights,
+        std::vector<csm::EcefCoord>& groundPts,
+        size_t numThreads) const
+{
+    if (heights.size() != 1 && heights.size() != imagePts.size())
+    {
+        throw csm::Error(csm::Error::INVALID_USE,
+                           "Expected 1 height or 1 height per point",
+                           "SIXSensorModel::imageToGround");
+    }
+
+    groundPts.resize(imagePts.size());
+    if (imagePts.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        Batch batch;
+        batch.imagePtsIn = &imagePts[0];
+        batch.heights = &heights[0];
+        batch.numHeights = heights.size();
+        batch.groundPtsOut = &groundPts[0];
+        runBatch(&SIXSensorModel::imageToGroundBatch,
+                 batch,
+                 imagePts.size(),
+                 numThreads);
+    }
+    catch (const except::Exception& ex)
+    {
+        throw csm::Error(csm::Error::UNKNOWN_ERROR,
+                           ex.getMessage(),
+                           "SIXSensorModel::imageToGround");
+    }
+}
+
+void SIXSensorModel::computeGroundPartials(
+        const std::vector<csm::EcefCoord>& groundPts,
+        std::vector<double>& partials,
+        size_t numThreads) const
+{
+    partials.resize(groundPts.size() * 6);
+    if (groundPts.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        Batch batch;
+        batch.groundPtsIn = &groundPts[0];
+        batch.sampleSpacing = getSampleSpacing();
+        batch.partialsOut = &partials[0];
+        runBatch(&SIXSensorModel::computeGroundPartialsBatch,
+                 batch,
+                 groundPts.size(),
+                 numThreads);
+    }
+    catch (const except::Exception& ex)
+    {
+        throw csm::Error(csm::Error::UNKNOWN_ERROR,
+                           ex.getMessage(),
+                           "SIXSensorModel::computeGroundPartials");
+    }
+}
+
 csm::EcefLocus SIXSensorModel::imageToRemoteImagingLocus(
         const csm::ImageCoord& ,
         double ,
@@ -19,6 +19,7 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
@@ -28,6 +29,7 @@
 #include <six/Utilities.h>
 #include <six/sicd/ComplexXMLControl.h>
 #include <six/sicd/Utilities.h>
+#include <six/csm/SIXSensorModel.h>
 #include "utilities.h"
 
 // CSM includes
@@ -70,7 +72,106 @@ public:
                 mComplexData.get(), mXmlRegistry));
     }
 
+    bool testModelState()
+    {
+        // Models constructed from the same state should be identical whether
+        // or not the state was already cached
+        std::auto_ptr<csm::RasterGM> model(constructModel());
+        const std::string state = model->getModelState();
+        std::auto_ptr<csm::RasterGM> stateModel(
+                reinterpret_cast<csm::RasterGM*>(
+                        mPlugin.constructModelFromState(state)));
+        std::auto_ptr<csm::RasterGM> cachedModel(
+                reinterpret_cast<csm::RasterGM*>(
+                        mPlugin.constructModelFromState(state)));
+
+        const six::SCP scp = mComplexData->geoData->scp;
+        const csm::EcefCoord groundPt(scp.ecf[0], scp.ecf[1], scp.ecf[2]);
+        const csm::ImageCoord imagePt = model->groundToImage(groundPt, 0);
+
+        const std::auto_ptr<csm::RasterGM>* models[] =
+                {&stateModel, &cachedModel};
+        for (size_t ii = 0; ii < 2; ++ii)
+        {
+            const csm::RasterGM& otherModel = **models[ii];
+            const csm::ImageCoord otherImagePt =
+                    otherModel.groundToImage(groundPt, 0);
+            if (otherModel.getModelState() != state ||
+                otherImagePt.line != imagePt.line ||
+                otherImagePt.samp != imagePt.samp)
+            {
+                std::cerr << "Model constructed from state differs\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool testBatch()
+    {
+        std::auto_ptr<csm::RasterGM> rasterModel(constructModel());
+        const six::CSM::SIXSensorModel& model =
+                static_cast<const six::CSM::SIXSensorModel&>(*rasterModel);
+
+        // Grid of points around the SCP
+        const six::RowColInt scpPixel = mComplexData->imageData->scpPixel;
+        const std::vector<double> heights(
+                1, mComplexData->geoData->scp.llh.getAlt());
+        std::vector<csm::ImageCoord> imagePts;
+        for (int row = -10; row <= 10; row += 5)
+        {
+            for (int col = -10; col <= 10; col += 5)
+            {
+                imagePts.push_back(csm::ImageCoord(
+                        scpPixel.row - mComplexData->imageData->firstRow + row,
+                        scpPixel.col - mComplexData->imageData->firstCol + col));
+            }
+        }
+
+        // The batch methods should match the single point versions exactly
+        for (size_t numThreads = 1; numThreads <= 3; numThreads += 2)
+        {
+            std::vector<csm::EcefCoord> groundPts;
+            std::vector<csm::ImageCoord> batchImagePts;
+            std::vector<double> partials;
+            model.imageToGround(imagePts, heights, groundPts, numThreads);
+            model.groundToImage(groundPts, batchImagePts, numThreads);
+            model.computeGroundPartials(groundPts, partials, numThreads);
+
+            for (size_t ii = 0; ii < imagePts.size(); ++ii)
+            {
+                const csm::EcefCoord groundPt =
+                        rasterModel->imageToGround(imagePts[ii], heights[0]);
+                const csm::ImageCoord imagePt =
+                        rasterModel->groundToImage(groundPts[ii]);
+                const std::vector<double> pointPartials =
+                        rasterModel->computeGroundPartials(groundPts[ii]);
+
+                if (groundPt.x != groundPts[ii].x ||
+                    groundPt.y != groundPts[ii].y ||
+                    groundPt.z != groundPts[ii].z ||
+                    imagePt.line != batchImagePts[ii].line ||
+                    imagePt.samp != batchImagePts[ii].samp ||
+                    !std::equal(pointPartials.begin(), pointPartials.end(),
+                                partials.begin() + ii * 6))
+                {
+                    std::cerr << "Batch results differ with " << numThreads
+                              << " threads\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
 private:
+    csm::RasterGM* constructModel() const
+    {
+        const csm::Isd isd(mSicdPathname);
+        return reinterpret_cast<csm::RasterGM*>(
+                mPlugin.constructModelFromISD(isd, MODEL_NAME));
+    }
+
     scene::Vector3 imageToGround(const csm::RasterGM& model,
             const six::RowColInt& scpPixel, double height, double offset)
     {
@@ -252,7 +353,8 @@ int main(int argc, char** argv)
         }
 
         Test test(sicdPathname, confDir, plugin);
-        const bool testPassed = test.testFileISD() && test.testNitfISD();
+        const bool testPassed = test.testFileISD() && test.testNitfISD() &&
+                test.testModelState() && test.testBatch();
 
         return testPassed ? 0 : 1;
     }